@@ -0,0 +1,659 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "codecbench"
+#include <utils/Log.h>
+
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include <binder/ProcessState.h>
+#include <media/stagefright/foundation/ABuffer.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/AHandler.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/AString.h>
+#include <media/stagefright/DataSource.h>
+#include <media/stagefright/MediaCodec.h>
+#include <media/stagefright/MediaCodecPool.h>
+#include <media/stagefright/MediaErrors.h>
+#include <media/stagefright/NuMediaExtractor.h>
+#include <utils/threads.h>
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-a] use audio\n"
+                    "\t\t[-n instances] number of decoders (4)\n"
+                    "\t\t[-s] one polling thread per decoder instead of "
+                    "callbacks\n"
+                    "\t\t[-f sessions] time to first frame of that many "
+                    "sessions in turn\n"
+                    "\t\t[-P] with -f, recycle the decoder through a "
+                    "MediaCodecPool\n"
+                    "\t\tfile\n",
+                    me);
+
+    exit(1);
+}
+
+namespace android {
+
+struct Sample {
+    sp<ABuffer> mData;
+    int64_t mTimeUs;
+};
+
+// What all decoders share: the access units of the track and the count of
+// decoders that have not finished yet.
+struct Input {
+    sp<AMessage> mFormat;
+    Vector<Sample> mSamples;
+
+    Mutex mLock;
+    Condition mCondition;
+    size_t mNumRunning;
+    bool mFailed;
+
+    void done(bool failed) {
+        Mutex::Autolock autoLock(mLock);
+        mFailed |= failed;
+        --mNumRunning;
+        mCondition.signal();
+    }
+};
+
+static status_t ReadInput(const char *path, bool useAudio, Input *input) {
+    sp<NuMediaExtractor> extractor = new NuMediaExtractor;
+    if (extractor->setDataSource(path) != OK) {
+        fprintf(stderr, "unable to instantiate extractor.\n");
+        return UNKNOWN_ERROR;
+    }
+
+    for (size_t i = 0; i < extractor->countTracks(); ++i) {
+        sp<AMessage> format;
+        CHECK_EQ(extractor->getTrackFormat(i, &format), (status_t)OK);
+
+        AString mime;
+        CHECK(format->findString("mime", &mime));
+
+        if (!strncasecmp(mime.c_str(), useAudio ? "audio/" : "video/", 6)) {
+            CHECK_EQ(extractor->selectTrack(i), (status_t)OK);
+            input->mFormat = format;
+            break;
+        }
+    }
+
+    if (input->mFormat == NULL) {
+        fprintf(stderr, "no %s track.\n", useAudio ? "audio" : "video");
+        return UNKNOWN_ERROR;
+    }
+
+    sp<ABuffer> scratch = new ABuffer(2 * 1024 * 1024);
+    while (extractor->readSampleData(scratch) == OK) {
+        Sample sample;
+        sample.mData = new ABuffer(scratch->size());
+        memcpy(sample.mData->data(), scratch->data(), scratch->size());
+        CHECK_EQ(extractor->getSampleTime(&sample.mTimeUs), (status_t)OK);
+        input->mSamples.push(sample);
+
+        extractor->advance();
+    }
+
+    return OK;
+}
+
+// Fills input buffer "index" with the next sample, or with EOS once all of
+// them have been queued. Returns false after EOS.
+static bool QueueNextSample(
+        const sp<MediaCodec> &codec, const Input &input,
+        const Vector<sp<ABuffer> > &buffers, size_t index, size_t *next) {
+    if (*next == input.mSamples.size()) {
+        CHECK_EQ(codec->queueInputBuffer(
+                    index, 0, 0, 0ll, MediaCodec::BUFFER_FLAG_EOS),
+                 (status_t)OK);
+        ++*next;
+        return false;
+    }
+
+    const Sample &sample = input.mSamples.itemAt(*next);
+    const sp<ABuffer> &buffer = buffers.itemAt(index);
+    CHECK_LE(sample.mData->size(), buffer->capacity());
+
+    memcpy(buffer->data(), sample.mData->data(), sample.mData->size());
+
+    CHECK_EQ(codec->queueInputBuffer(
+                index, 0, sample.mData->size(), sample.mTimeUs, 0),
+             (status_t)OK);
+    ++*next;
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Decoder driven from its own thread, which polls the codec the way
+// clients of the synchronous API do.
+struct SyncDecoder {
+    SyncDecoder(const sp<MediaCodec> &codec, Input *input)
+        : mCodec(codec),
+          mInput(input),
+          mNext(0),
+          mNumFrames(0) {
+    }
+
+    void start() {
+        CHECK_EQ(pthread_create(&mThread, NULL, ThreadWrapper, this), 0);
+    }
+
+    void join() {
+        pthread_join(mThread, NULL);
+    }
+
+    size_t numFrames() const {
+        return mNumFrames;
+    }
+
+private:
+    sp<MediaCodec> mCodec;
+    Input *mInput;
+    pthread_t mThread;
+    size_t mNext;
+    size_t mNumFrames;
+
+    static void *ThreadWrapper(void *me) {
+        static_cast<SyncDecoder *>(me)->threadEntry();
+        return NULL;
+    }
+
+    void threadEntry() {
+        static const int64_t kTimeout = 500ll;
+
+        Vector<sp<ABuffer> > inBuffers;
+        CHECK_EQ(mCodec->getInputBuffers(&inBuffers), (status_t)OK);
+
+        bool sawInputEOS = false;
+        for (;;) {
+            size_t index;
+            if (!sawInputEOS
+                    && mCodec->dequeueInputBuffer(&index, kTimeout) == OK) {
+                sawInputEOS = !QueueNextSample(
+                        mCodec, *mInput, inBuffers, index, &mNext);
+            }
+
+            size_t offset, size;
+            int64_t timeUs;
+            uint32_t flags;
+            status_t err = mCodec->dequeueOutputBuffer(
+                    &index, &offset, &size, &timeUs, &flags, kTimeout);
+
+            if (err == OK) {
+                if (size > 0) {
+                    ++mNumFrames;
+                }
+                CHECK_EQ(mCodec->releaseOutputBuffer(index), (status_t)OK);
+
+                if (flags & MediaCodec::BUFFER_FLAG_EOS) {
+                    break;
+                }
+            } else if (err != -EAGAIN
+                    && err != INFO_OUTPUT_BUFFERS_CHANGED
+                    && err != INFO_FORMAT_CHANGED) {
+                ALOGE("dequeueOutputBuffer returned %d", err);
+                mInput->done(true /* failed */);
+                return;
+            }
+        }
+
+        mInput->done(false /* failed */);
+    }
+
+    DISALLOW_EVIL_CONSTRUCTORS(SyncDecoder);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Decoder driven by MediaCodec's callbacks. All of them share a looper.
+struct AsyncDecoder : public AHandler {
+    enum {
+        kWhatCallback = 'cbak',
+    };
+
+    AsyncDecoder(Input *input)
+        : mInput(input),
+          mNext(0),
+          mNumFrames(0),
+          mDone(false) {
+    }
+
+    void setCodec(const sp<MediaCodec> &codec) {
+        mCodec = codec;
+    }
+
+    size_t numFrames() const {
+        return mNumFrames;
+    }
+
+protected:
+    virtual void onMessageReceived(const sp<AMessage> &msg) {
+        CHECK_EQ(msg->what(), (uint32_t)kWhatCallback);
+
+        if (mDone) {
+            return;
+        }
+
+        int32_t callbackID;
+        CHECK(msg->findInt32("callbackID", &callbackID));
+
+        switch (callbackID) {
+            case MediaCodec::CB_INPUT_AVAILABLE:
+            {
+                if (mInBuffers.isEmpty()) {
+                    CHECK_EQ(mCodec->getInputBuffers(&mInBuffers),
+                             (status_t)OK);
+                }
+
+                size_t index;
+                CHECK(msg->findSize("index", &index));
+
+                if (mNext <= mInput->mSamples.size()) {
+                    QueueNextSample(mCodec, *mInput, mInBuffers, index, &mNext);
+                }
+                break;
+            }
+
+            case MediaCodec::CB_OUTPUT_AVAILABLE:
+            {
+                size_t index, size;
+                int32_t flags;
+                CHECK(msg->findSize("index", &index));
+                CHECK(msg->findSize("size", &size));
+                CHECK(msg->findInt32("flags", &flags));
+
+                if (size > 0) {
+                    ++mNumFrames;
+                }
+                mCodec->releaseOutputBuffer(index);
+
+                if (flags & MediaCodec::BUFFER_FLAG_EOS) {
+                    mDone = true;
+                    mInput->done(false /* failed */);
+                }
+                break;
+            }
+
+            case MediaCodec::CB_OUTPUT_FORMAT_CHANGED:
+            {
+                sp<AMessage> format;
+                CHECK(msg->findMessage("format", &format));
+                ALOGV("output format changed: %s",
+                      format->debugString().c_str());
+                break;
+            }
+
+            case MediaCodec::CB_ERROR:
+            {
+                int32_t err;
+                CHECK(msg->findInt32("err", &err));
+                ALOGE("codec reported error %d", err);
+
+                mDone = true;
+                mInput->done(true /* failed */);
+                break;
+            }
+
+            default:
+                TRESPASS();
+        }
+    }
+
+private:
+    sp<MediaCodec> mCodec;
+    Input *mInput;
+    Vector<sp<ABuffer> > mInBuffers;
+    size_t mNext;
+    size_t mNumFrames;
+    bool mDone;
+
+    DISALLOW_EVIL_CONSTRUCTORS(AsyncDecoder);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// One session as a thumbnailer would run it: get a decoder, configure and
+// start it, decode up to the first frame and get rid of the decoder again.
+// Returns the time from asking for the decoder to holding the frame, or -1.
+static int64_t TimeToFirstFrameUs(
+        const sp<ALooper> &looper, const sp<MediaCodecPool> &pool,
+        const Input &input, const char *mime) {
+    static const int64_t kTimeout = 500ll;
+
+    int64_t startUs = ALooper::GetNowUs();
+
+    sp<MediaCodec> codec;
+    if (pool != NULL) {
+        codec = pool->acquireByType(mime, false /* encoder */);
+    } else {
+        codec = MediaCodec::CreateByType(looper, mime, false /* encoder */);
+    }
+
+    if (codec == NULL) {
+        fprintf(stderr, "unable to instantiate decoder.\n");
+        return -1;
+    }
+
+    Vector<sp<ABuffer> > inBuffers;
+    status_t err = codec->configure(
+            input.mFormat, NULL /* surface */, NULL /* crypto */,
+            0 /* flags */);
+    if (err == OK) {
+        err = codec->start();
+    }
+    if (err == OK) {
+        err = codec->getInputBuffers(&inBuffers);
+    }
+
+    size_t next = 0;
+    bool sawInputEOS = false;
+    while (err == OK) {
+        size_t index;
+        if (!sawInputEOS && codec->dequeueInputBuffer(&index, kTimeout) == OK) {
+            sawInputEOS = !QueueNextSample(
+                    codec, input, inBuffers, index, &next);
+        }
+
+        size_t offset, size;
+        int64_t timeUs;
+        uint32_t flags;
+        err = codec->dequeueOutputBuffer(
+                &index, &offset, &size, &timeUs, &flags, kTimeout);
+
+        if (err == OK) {
+            codec->releaseOutputBuffer(index);
+
+            if (size > 0) {
+                break;
+            }
+
+            if (flags & MediaCodec::BUFFER_FLAG_EOS) {
+                err = ERROR_END_OF_STREAM;
+            }
+        } else if (err == -EAGAIN
+                || err == INFO_OUTPUT_BUFFERS_CHANGED
+                || err == INFO_FORMAT_CHANGED) {
+            err = OK;
+        }
+    }
+
+    int64_t elapsedUs = ALooper::GetNowUs() - startUs;
+
+    if (pool != NULL) {
+        pool->recycle(codec);
+    } else {
+        codec->release();
+    }
+
+    if (err != OK) {
+        ALOGE("no frame decoded, err %d", err);
+        return -1;
+    }
+
+    return elapsedUs;
+}
+
+static int MeasureTimeToFirstFrame(
+        const Input &input, const char *mime, int numSessions, bool usePool) {
+    sp<ALooper> looper;
+    sp<MediaCodecPool> pool;
+
+    if (usePool) {
+        pool = new MediaCodecPool;
+        CHECK_EQ(pool->start(), (status_t)OK);
+    } else {
+        looper = new ALooper;
+        looper->setName("codecbench");
+        looper->start();
+    }
+
+    int64_t minUs = -1, maxUs = -1, sumUs = 0;
+    for (int i = 0; i < numSessions; ++i) {
+        int64_t elapsedUs = TimeToFirstFrameUs(looper, pool, input, mime);
+        if (elapsedUs < 0) {
+            return 1;
+        }
+
+        if (i == 0) {
+            printf("first session %.2f ms\n", elapsedUs / 1E3);
+        }
+
+        if (minUs < 0 || elapsedUs < minUs) {
+            minUs = elapsedUs;
+        }
+        if (elapsedUs > maxUs) {
+            maxUs = elapsedUs;
+        }
+        sumUs += elapsedUs;
+    }
+
+    printf("%d x %s, %s: time to first frame min %.2f ms, "
+           "avg %.2f ms, max %.2f ms\n",
+           numSessions, mime, usePool ? "pooled" : "not pooled",
+           minUs / 1E3, sumUs / 1E3 / numSessions, maxUs / 1E3);
+
+    if (pool != NULL) {
+        pool->stop();
+    }
+    if (looper != NULL) {
+        looper->stop();
+    }
+
+    return 0;
+}
+
+}  // namespace android
+
+static int64_t getCpuTimeUs() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ll
+        + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int main(int argc, char **argv) {
+    using namespace android;
+
+    const char *me = argv[0];
+
+    bool useAudio = false;
+    bool useSync = false;
+    int numInstances = 4;
+    int numSessions = 0;
+    bool usePool = false;
+
+    int res;
+    while ((res = getopt(argc, argv, "han:sf:P")) >= 0) {
+        switch (res) {
+            case 'a':
+            {
+                useAudio = true;
+                break;
+            }
+
+            case 'n':
+            {
+                numInstances = atoi(optarg);
+                if (numInstances < 1) {
+                    usage(me);
+                }
+                break;
+            }
+
+            case 's':
+            {
+                useSync = true;
+                break;
+            }
+
+            case 'f':
+            {
+                numSessions = atoi(optarg);
+                if (numSessions < 1) {
+                    usage(me);
+                }
+                break;
+            }
+
+            case 'P':
+            {
+                usePool = true;
+                break;
+            }
+
+            case '?':
+            case 'h':
+            default:
+            {
+                usage(me);
+            }
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc != 1) {
+        usage(me);
+    }
+
+    ProcessState::self()->startThreadPool();
+
+    DataSource::RegisterDefaultSniffers();
+
+    Input input;
+    input.mNumRunning = numInstances;
+    input.mFailed = false;
+    if (ReadInput(argv[0], useAudio, &input) != OK) {
+        return 1;
+    }
+
+    AString mime;
+    CHECK(input.mFormat->findString("mime", &mime));
+
+    if (numSessions > 0) {
+        return MeasureTimeToFirstFrame(
+                input, mime.c_str(), numSessions, usePool);
+    }
+
+    // Each codec has a looper of its own, as with one client per codec.
+    Vector<sp<ALooper> > codecLoopers;
+    Vector<sp<MediaCodec> > codecs;
+    for (int i = 0; i < numInstances; ++i) {
+        sp<ALooper> looper = new ALooper;
+        looper->setName("codecbench");
+        looper->start();
+        codecLoopers.push(looper);
+
+        sp<MediaCodec> codec = MediaCodec::CreateByType(
+                looper, mime.c_str(), false /* encoder */);
+        if (codec == NULL) {
+            fprintf(stderr, "unable to instantiate decoder %d.\n", i);
+            return 1;
+        }
+        codecs.push(codec);
+    }
+
+    sp<ALooper> callbackLooper;
+    Vector<sp<AsyncDecoder> > asyncDecoders;
+    Vector<SyncDecoder *> syncDecoders;
+
+    if (!useSync) {
+        callbackLooper = new ALooper;
+        callbackLooper->setName("codecbench callbacks");
+        callbackLooper->start();
+
+        for (int i = 0; i < numInstances; ++i) {
+            sp<AsyncDecoder> decoder = new AsyncDecoder(&input);
+            callbackLooper->registerHandler(decoder);
+            decoder->setCodec(codecs[i]);
+            asyncDecoders.push(decoder);
+
+            CHECK_EQ(codecs[i]->setCallback(
+                        new AMessage(AsyncDecoder::kWhatCallback,
+                                     decoder->id())),
+                     (status_t)OK);
+        }
+    }
+
+    for (int i = 0; i < numInstances; ++i) {
+        CHECK_EQ(codecs[i]->configure(
+                    input.mFormat, NULL /* surface */, NULL /* crypto */,
+                    0 /* flags */),
+                 (status_t)OK);
+    }
+
+    int64_t startCpuUs = getCpuTimeUs();
+    int64_t startUs = ALooper::GetNowUs();
+
+    for (int i = 0; i < numInstances; ++i) {
+        CHECK_EQ(codecs[i]->start(), (status_t)OK);
+
+        if (useSync) {
+            SyncDecoder *decoder = new SyncDecoder(codecs[i], &input);
+            syncDecoders.push(decoder);
+            decoder->start();
+        }
+    }
+
+    {
+        Mutex::Autolock autoLock(input.mLock);
+        while (input.mNumRunning > 0) {
+            input.mCondition.wait(input.mLock);
+        }
+    }
+
+    int64_t elapsedUs = ALooper::GetNowUs() - startUs;
+    int64_t cpuUs = getCpuTimeUs() - startCpuUs;
+
+    size_t numFrames = 0;
+    for (int i = 0; i < numInstances; ++i) {
+        if (useSync) {
+            syncDecoders[i]->join();
+            numFrames += syncDecoders[i]->numFrames();
+            delete syncDecoders[i];
+        } else {
+            numFrames += asyncDecoders[i]->numFrames();
+        }
+
+        CHECK_EQ(codecs[i]->release(), (status_t)OK);
+    }
+
+    printf("%d x %s, %s: %d client threads\n",
+           numInstances, mime.c_str(), useSync ? "polling" : "callbacks",
+           useSync ? numInstances : 1);
+    printf("%zu frames in %.2f secs, %.2f fps, cpu %.2f secs (%.0f%%)%s\n",
+           numFrames, elapsedUs / 1E6, numFrames * 1E6 / elapsedUs,
+           cpuUs / 1E6, 100.0 * cpuUs / elapsedUs,
+           input.mFailed ? ", FAILED" : "");
+
+    if (callbackLooper != NULL) {
+        callbackLooper->stop();
+    }
+    for (size_t i = 0; i < codecLoopers.size(); ++i) {
+        codecLoopers[i]->stop();
+    }
+
+    return input.mFailed ? 1 : 0;
+}
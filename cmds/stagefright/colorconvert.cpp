@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "colorconvert"
+#include <utils/Log.h>
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/ColorConverter.h>
+
+using namespace android;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-w width] [-h height] [-n iterations]"
+                    " [-t threads]\n", me);
+    fprintf(stderr, "       -w frame width, default 1920\n");
+    fprintf(stderr, "       -h frame height, default 1080\n");
+    fprintf(stderr, "       -n conversions per format, default 100\n");
+    fprintf(stderr, "       -t conversion threads, default 1\n");
+
+    exit(1);
+}
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+static const struct {
+    OMX_COLOR_FORMATTYPE mFormat;
+    const char *mName;
+} kSrcFormats[] = {
+    { OMX_COLOR_FormatYUV420Planar, "YUV420Planar" },
+    { OMX_COLOR_FormatCbYCrY, "CbYCrY" },
+    { OMX_QCOM_COLOR_FormatYVU420SemiPlanar, "QCOMYVU420SemiPlanar" },
+    { OMX_COLOR_FormatYUV420SemiPlanar, "YUV420SemiPlanar" },
+    { OMX_TI_COLOR_FormatYUV420PackedSemiPlanar,
+      "TIYUV420PackedSemiPlanar" },
+};
+
+static const struct {
+    OMX_COLOR_FORMATTYPE mFormat;
+    const char *mName;
+} kDstFormats[] = {
+    { OMX_COLOR_Format16bitRGB565, "RGB565" },
+    { OMX_COLOR_Format32BitRGBA8888, "RGBA8888" },
+};
+
+int main(int argc, char **argv) {
+    size_t width = 1920;
+    size_t height = 1080;
+    size_t numIterations = 100;
+    size_t numThreads = 1;
+
+    int res;
+    while ((res = getopt(argc, argv, "w:h:n:t:")) >= 0) {
+        if (res == '?') {
+            usage(argv[0]);
+        }
+
+        char *end;
+        long x = strtol(optarg, &end, 10);
+
+        if (*end != '\0' || end == optarg || x <= 0) {
+            usage(argv[0]);
+        }
+
+        switch (res) {
+            case 'w':
+                width = (x + 1) & ~1;
+                break;
+
+            case 'h':
+                height = (x + 1) & ~1;
+                break;
+
+            case 'n':
+                numIterations = x;
+                break;
+
+            case 't':
+                numThreads = x;
+                break;
+
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    // Large enough for every source format, CbYCrY needs the most.
+    size_t srcSize = width * height * 2;
+    uint8_t *src = new uint8_t[srcSize];
+    for (size_t i = 0; i < srcSize; ++i) {
+        src[i] = (uint8_t)(i * 7 + (i >> 11));
+    }
+
+    uint8_t *dst = new uint8_t[width * height * 4];
+
+    printf("%zux%zu, %zu iterations, %zu thread(s)\n",
+           width, height, numIterations, numThreads);
+
+    for (size_t i = 0; i < sizeof(kSrcFormats) / sizeof(kSrcFormats[0]); ++i) {
+        for (size_t j = 0;
+                j < sizeof(kDstFormats) / sizeof(kDstFormats[0]); ++j) {
+            ColorConverter converter(
+                    kSrcFormats[i].mFormat, kDstFormats[j].mFormat);
+            CHECK(converter.isValid());
+
+            converter.setNumThreads(numThreads);
+
+            int64_t startUs = getNowUs();
+
+            for (size_t k = 0; k < numIterations; ++k) {
+                CHECK_EQ(converter.convert(
+                            src, width, height,
+                            0, 0, width - 1, height - 1,
+                            dst, width, height,
+                            0, 0, width - 1, height - 1),
+                         (status_t)OK);
+            }
+
+            int64_t elapsedUs = getNowUs() - startUs;
+
+            printf("%-26s -> %-10s %8.2f Mpixels/s\n",
+                   kSrcFormats[i].mName,
+                   kDstFormats[j].mName,
+                   (double)width * height * numIterations
+                        / (elapsedUs > 0 ? elapsedUs : 1));
+        }
+    }
+
+    delete[] dst;
+    dst = NULL;
+
+    delete[] src;
+    src = NULL;
+
+    return 0;
+}
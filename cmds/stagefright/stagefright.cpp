@@ -871,7 +871,8 @@ int main(int argc, char **argv) {
 
             sp<IMemory> mem =
                     retriever->getFrameAtTime(-1,
-                                    MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC);
+                                    MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC,
+                                    VideoFrameOptions());
 
             if (mem != NULL) {
                 failed = false;
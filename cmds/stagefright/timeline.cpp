@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "timeline"
+#include <utils/Log.h>
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "include/StagefrightMetadataRetriever.h"
+
+#include <binder/ProcessState.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/MediaSource.h>
+
+using namespace android;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n frames] [-s size] <file> ...\n", me);
+    fprintf(stderr, "       -n frames per timeline, default 100\n");
+    fprintf(stderr, "       -s maximum frame width and height, default 96\n");
+
+    exit(1);
+}
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+static bool parsePositive(const char *s, long *x) {
+    char *end;
+    *x = strtol(s, &end, 10);
+
+    return *end == '\0' && end != s && *x > 0;
+}
+
+// Extracts the timeline of |path| once with a getFrameAtTime() call per
+// frame and once with getFramesAtTimes(), and prints both times.
+static void benchmarkFile(
+        const char *path, size_t numFrames,
+        const VideoFrameOptions &frameOptions) {
+    sp<StagefrightMetadataRetriever> retriever =
+        new StagefrightMetadataRetriever;
+
+    if (retriever->setDataSource(path, NULL) != OK) {
+        fprintf(stderr, "unable to open %s\n", path);
+        return;
+    }
+
+    const char *duration = retriever->extractMetadata(METADATA_KEY_DURATION);
+    if (duration == NULL) {
+        fprintf(stderr, "%s has no duration\n", path);
+        return;
+    }
+
+    int64_t durationUs = atoll(duration) * 1000ll;
+
+    Vector<int64_t> timesUs;
+    for (size_t i = 0; i < numFrames; ++i) {
+        timesUs.push(durationUs * i / numFrames);
+    }
+
+    int64_t startUs = getNowUs();
+
+    size_t numSingleFrames = 0;
+    for (size_t i = 0; i < timesUs.size(); ++i) {
+        VideoFrame *frame = retriever->getFrameAtTime(
+                timesUs[i], MediaSource::ReadOptions::SEEK_CLOSEST,
+                frameOptions);
+
+        if (frame != NULL) {
+            ++numSingleFrames;
+        }
+
+        delete frame;
+        frame = NULL;
+    }
+
+    int64_t singleUs = getNowUs() - startUs;
+
+    startUs = getNowUs();
+
+    Vector<VideoFrame *> frames;
+    retriever->getFramesAtTimes(
+            timesUs, MediaSource::ReadOptions::SEEK_CLOSEST,
+            frameOptions, &frames);
+
+    int64_t batchUs = getNowUs() - startUs;
+
+    size_t numBatchFrames = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i] != NULL) {
+            ++numBatchFrames;
+        }
+
+        delete frames[i];
+    }
+    frames.clear();
+
+    printf("%s: %zu frames, per frame %.2f s (%zu ok), "
+           "batch %.2f s (%zu ok)\n",
+           path, numFrames,
+           singleUs / 1E6, numSingleFrames,
+           batchUs / 1E6, numBatchFrames);
+}
+
+int main(int argc, char **argv) {
+    android::ProcessState::self()->startThreadPool();
+
+    size_t numFrames = 100;
+
+    VideoFrameOptions frameOptions;
+    frameOptions.mMaxWidth = 96;
+    frameOptions.mMaxHeight = 96;
+
+    int res;
+    while ((res = getopt(argc, argv, "n:s:")) >= 0) {
+        long x;
+
+        switch (res) {
+            case 'n':
+                if (!parsePositive(optarg, &x)) {
+                    usage(argv[0]);
+                }
+                numFrames = x;
+                break;
+
+            case 's':
+                if (!parsePositive(optarg, &x)) {
+                    usage(argv[0]);
+                }
+                frameOptions.mMaxWidth = x;
+                frameOptions.mMaxHeight = x;
+                break;
+
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        usage("timeline");
+    }
+
+    for (int i = 0; i < argc; ++i) {
+        benchmarkFile(argv[i], numFrames, frameOptions);
+    }
+
+    return 0;
+}
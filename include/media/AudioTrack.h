@@ -392,6 +392,13 @@ public:
      */
             status_t    getPosition(uint32_t *position);
 
+    /* Return the number of underruns AudioFlinger saw on this track since it was created.
+     * Read from the control block, without a binder call or taking a lock shared with
+     * AudioFlinger, so it can be polled from the callback thread.
+     * A new count starts when the track is re-created, e.g. after mediaserver died.
+     */
+            uint32_t    getUnderrunCount() const;
+
     /* Forces AudioTrack buffer full condition. When playing a static buffer, this method avoids
      * rewriting the buffer before restarting playback after a stop.
      * This method must be called with the AudioTrack in paused or stopped state.
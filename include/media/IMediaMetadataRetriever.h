@@ -23,9 +23,46 @@
 #include <binder/IMemory.h>
 #include <utils/KeyedVector.h>
 #include <utils/RefBase.h>
+#include <utils/Vector.h>
 
 namespace android {
 
+// Pixel formats of the frames returned by getFrameAtTime().
+enum {
+    VIDEO_FRAME_FORMAT_RGB565    = 0,
+    VIDEO_FRAME_FORMAT_RGBA8888  = 1,
+    VIDEO_FRAME_FORMAT_BGRA8888  = 2,
+};
+
+// Filters used when getFrameAtTime() downscales a frame.
+enum {
+    VIDEO_FRAME_SCALING_BOX      = 0,
+    VIDEO_FRAME_SCALING_BILINEAR = 1,
+};
+
+// Output format of getFrameAtTime(). By default frames are RGB565 at the
+// size of the video's crop rectangle. If mMaxWidth and mMaxHeight are
+// positive, the frame is downscaled while it is color converted so that it
+// fits into mMaxWidth x mMaxHeight, keeping its aspect ratio.
+struct VideoFrameOptions {
+    VideoFrameOptions()
+        : mFormat(VIDEO_FRAME_FORMAT_RGB565),
+          mMaxWidth(0),
+          mMaxHeight(0),
+          mScalingMode(VIDEO_FRAME_SCALING_BOX) {
+    }
+
+    bool isDefault() const {
+        return mFormat == VIDEO_FRAME_FORMAT_RGB565
+            && mMaxWidth <= 0 && mMaxHeight <= 0;
+    }
+
+    int32_t mFormat;
+    int32_t mMaxWidth;
+    int32_t mMaxHeight;
+    int32_t mScalingMode;
+};
+
 class IMediaMetadataRetriever: public IInterface
 {
 public:
@@ -37,7 +74,16 @@ public:
             const KeyedVector<String8, String8> *headers = NULL) = 0;
 
     virtual status_t        setDataSource(int fd, int64_t offset, int64_t length) = 0;
-    virtual sp<IMemory>     getFrameAtTime(int64_t timeUs, int option) = 0;
+    virtual sp<IMemory>     getFrameAtTime(
+            int64_t timeUs, int option,
+            const VideoFrameOptions &frameOptions) = 0;
+
+    // One frame for each of the ascending |timesUs|, decoded in a single
+    // pass. |frames| gets one entry per time, NULL where there is no frame.
+    virtual status_t        getFramesAtTimes(
+            const Vector<int64_t> &timesUs, int option,
+            const VideoFrameOptions &frameOptions,
+            Vector<sp<IMemory> > *frames) = 0;
     virtual sp<IMemory>     extractAlbumArt() = 0;
     virtual const char*     extractMetadata(int keyCode) = 0;
 };
@@ -33,6 +33,7 @@ class IMemory;
 class IOMXObserver;
 class IOMXRenderer;
 class Surface;
+struct OMXBufferRing;
 
 class IOMX : public IInterface {
 public:
@@ -130,6 +131,15 @@ public:
             node_id node,
             const char *parameter_name,
             OMX_INDEXTYPE *index) = 0;
+
+    // From now on the node also takes fillBuffer()/emptyBuffer() requests
+    // from the ring, and posts its messages there instead of calling the
+    // observer. The remote implementation sets one up for every node it
+    // allocates, so that buffers change hands without binder transactions;
+    // its fillBuffer()/emptyBuffer() then return before the node has seen
+    // the request, and a request that fails is reported as OMX_EventError.
+    virtual status_t setBufferRing(
+            node_id node, const sp<OMXBufferRing> &ring) = 0;
 };
 
 struct omx_message {
@@ -174,6 +184,11 @@ public:
     DECLARE_META_INTERFACE(OMXObserver);
 
     virtual void onMessage(const omx_message &msg) = 0;
+
+    // The messages of one node that were pending at the same time, in the
+    // order they were generated. Across processes they take a single
+    // transaction. By default they are handed to onMessage() one by one.
+    virtual void onMessages(const List<omx_message> &messages);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
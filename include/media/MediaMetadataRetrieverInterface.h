@@ -37,6 +37,33 @@ public:
 
     virtual status_t    setDataSource(int fd, int64_t offset, int64_t length) = 0;
     virtual VideoFrame* getFrameAtTime(int64_t timeUs, int option) = 0;
+
+    // Retrievers that only produce frames in the default format fail any
+    // other request rather than return a frame the caller cannot read.
+    virtual VideoFrame* getFrameAtTime(
+            int64_t timeUs, int option, const VideoFrameOptions &frameOptions) {
+        if (!frameOptions.isDefault()) {
+            return NULL;
+        }
+        return getFrameAtTime(timeUs, option);
+    }
+
+    // One frame for each of the ascending |timesUs|, the caller owns them.
+    // Retrievers that can decode all of them in one pass override this.
+    virtual status_t    getFramesAtTimes(
+            const Vector<int64_t> &timesUs, int option,
+            const VideoFrameOptions &frameOptions,
+            Vector<VideoFrame *> *frames) {
+        frames->clear();
+        bool found = false;
+        for (size_t i = 0; i < timesUs.size(); ++i) {
+            VideoFrame *frame = getFrameAtTime(timesUs[i], option, frameOptions);
+            frames->push(frame);
+            found = found || (frame != NULL);
+        }
+        return found ? OK : UNKNOWN_ERROR;
+    }
+
     virtual MediaAlbumArt* extractAlbumArt() = 0;
     virtual const char* extractMetadata(int keyCode) = 0;
 };
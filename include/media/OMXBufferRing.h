@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_OMX_BUFFER_RING_H_
+
+#define ANDROID_OMX_BUFFER_RING_H_
+
+#include <media/IOMX.h>
+#include <media/stagefright/foundation/ABase.h>
+#include <utils/RefBase.h>
+
+namespace android {
+
+class IMemory;
+
+// Carries the emptyBuffer()/fillBuffer() calls of a client to its node and
+// the messages of the node back, so that binder is only needed to set the
+// node up. Each direction is a single-reader / single-writer queue in
+// shared memory with an eventfd the reader blocks on.
+struct OMXBufferRing : public RefBase {
+    // An emptyBuffer() or fillBuffer() call.
+    struct Request {
+        enum {
+            EMPTY_BUFFER,
+            FILL_BUFFER,
+        };
+
+        int32_t type;
+        IOMX::buffer_id buffer;
+        OMX_U32 range_offset;
+        OMX_U32 range_length;
+        OMX_U32 flags;
+        OMX_TICKS timestamp;
+    };
+
+    enum {
+        // Powers of 2, larger than the number of buffers of a node.
+        kNumRequests = 64,
+        kNumMessages = 128,
+    };
+
+    // Allocates the shared memory and the eventfds.
+    static sp<OMXBufferRing> Create();
+
+    // Attaches to the memory of a ring made by Create() in another process
+    // and takes ownership of the eventfds.
+    OMXBufferRing(const sp<IMemory> &memory, int requestFd, int messageFd);
+
+    status_t initCheck() const;
+
+    sp<IMemory> memory() const { return mMemory; }
+    int requestFd() const { return mRequestFd; }
+    int messageFd() const { return mMessageFd; }
+
+    // Return false if the queue is full. The reader is not woken up until
+    // signalRequests()/signalMessages(), so that a batch costs one wakeup.
+    bool postRequest(const Request &request);
+    bool postMessage(const omx_message &msg);
+
+    // Return false if the queue is empty.
+    bool readRequest(Request *request);
+    bool readMessage(omx_message *msg);
+
+    void signalRequests();
+    void signalMessages();
+
+    // Block until the queue has been signalled since the last wait.
+    status_t waitForRequests();
+    status_t waitForMessages();
+
+protected:
+    virtual ~OMXBufferRing();
+
+private:
+    struct Queue;
+    struct Shared;
+
+    sp<IMemory> mMemory;
+    Shared *mShared;
+    int mRequestFd;
+    int mMessageFd;
+
+    DISALLOW_EVIL_CONSTRUCTORS(OMXBufferRing);
+};
+
+}  // namespace android
+
+#endif  // ANDROID_OMX_BUFFER_RING_H_
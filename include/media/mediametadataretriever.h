@@ -73,6 +73,12 @@ public:
 
     status_t setDataSource(int fd, int64_t offset, int64_t length);
     sp<IMemory> getFrameAtTime(int64_t timeUs, int option);
+    sp<IMemory> getFrameAtTime(
+            int64_t timeUs, int option, const VideoFrameOptions &frameOptions);
+    status_t getFramesAtTimes(
+            const Vector<int64_t> &timesUs, int option,
+            const VideoFrameOptions &frameOptions,
+            Vector<sp<IMemory> > *frames);
     sp<IMemory> extractAlbumArt();
     const char* extractMetadata(int keyCode);
 
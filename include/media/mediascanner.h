@@ -53,6 +53,23 @@ struct MediaScanner {
 
     void setLocale(const char *locale);
 
+    // Walks directories on |numThreads| threads. Client callbacks are
+    // still made on the thread calling processDirectory(), in an order
+    // where every directory is reported before its contents. 1 walks
+    // directories serially on the calling thread. The default is taken
+    // from the media.scanner.threads property, 1 if it is not set.
+    void setNumThreads(size_t numThreads);
+
+    // Enables incremental rescans. The modification time, size and
+    // noMedia flag of every regular file seen by a successful
+    // processDirectory() are stored in |path|. Later scans tell the client
+    // which files did not change since, see MediaScannerClient::scanFile(),
+    // or leave them out if the client asks for it, see
+    // MediaScannerClient::skipUnchangedFiles(). Remove the file to forget
+    // the state, pass NULL to disable. The default is taken from the
+    // media.scanner.state_file property, disabled if it is not set.
+    void setScanStateFile(const char *path);
+
     // extracts album art as a block of data
     virtual char *extractAlbumArt(int fd) = 0;
 
@@ -60,17 +77,29 @@ protected:
     const char *locale() const;
 
 private:
+    struct ScanState;
+    struct ParallelWalk;
+
     // current locale (like "ja_JP"), created/destroyed with strdup()/free()
     char *mLocale;
     char *mSkipList;
     int *mSkipIndex;
+    size_t mNumThreads;
+    char *mScanStateFile;
+
+    // only valid for the duration of processDirectory()
+    ScanState *mScanState;
 
     MediaScanResult doProcessDirectory(
             char *path, int pathRemaining, MediaScannerClient &client, bool noMedia);
     MediaScanResult doProcessDirectoryEntry(
             char *path, int pathRemaining, MediaScannerClient &client, bool noMedia,
             struct dirent* entry, char* fileSpot);
+    MediaScanResult checkDirectory(
+            char *path, int pathRemaining, bool *noMedia);
+    int getEntryType(char *path, struct dirent *entry);
     void loadSkipList();
+    void loadScanOptions();
     bool shouldSkipDirectory(char *path);
 
 
@@ -90,6 +119,21 @@ public:
 
     virtual status_t scanFile(const char* path, long long lastModified,
             long long fileSize, bool isDirectory, bool noMedia) = 0;
+
+    // Called by MediaScanner for every file and directory. |unchanged| is
+    // set for files whose modification time, size and noMedia flag match
+    // those recorded by the previous scan with the same scan state file,
+    // clients may skip reading their metadata again. The default ignores
+    // the hint and calls the method above.
+    virtual status_t scanFile(const char* path, long long lastModified,
+            long long fileSize, bool isDirectory, bool noMedia,
+            bool unchanged);
+
+    // Clients that only need to hear about new and modified files return
+    // true, MediaScanner then does not call scanFile() for unchanged ones
+    // at all. Clients that must see every file, e.g. to find the ones that
+    // were deleted, keep the default.
+    virtual bool skipUnchangedFiles() const { return false; }
     virtual status_t handleStringTag(const char* name, const char* value) = 0;
     virtual status_t setMimeType(const char* mimeType) = 0;
 
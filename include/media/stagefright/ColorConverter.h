@@ -25,14 +25,39 @@
 
 #include <OMX_Video.h>
 
+// 32 bits per pixel, one byte each of R, G, B and A in that order in memory.
+// This is the Android extension value, the IL headers only define the
+// packed ARGB/BGRA variants.
+#define OMX_COLOR_Format32BitRGBA8888 ((OMX_COLOR_FORMATTYPE)0x7F00A000)
+
 namespace android {
 
 struct ColorConverter {
+    // Filter used when the destination crop rectangle is smaller than the
+    // source crop rectangle.
+    enum ScalingMode {
+        kScalingBox,
+        kScalingBilinear,
+    };
+
     ColorConverter(OMX_COLOR_FORMATTYPE from, OMX_COLOR_FORMATTYPE to);
     ~ColorConverter();
 
     bool isValid() const;
 
+    // Splits frames of at least kMinRowsPerBand * 2 rows into horizontal
+    // bands that are converted concurrently on up to |numThreads| threads,
+    // the calling thread included. The default of 1 converts on the calling
+    // thread only.
+    void setNumThreads(size_t numThreads);
+
+    // Defaults to kScalingBox.
+    void setScalingMode(ScalingMode mode);
+
+    // The destination crop rectangle may be smaller than the source crop
+    // rectangle in either dimension, in which case the frame is downscaled
+    // as part of the conversion, without an intermediate full resolution
+    // RGB image. Upscaling is not supported.
     status_t convert(
             const void *srcBits,
             size_t srcWidth, size_t srcHeight,
@@ -59,25 +84,39 @@ private:
         size_t mCropLeft, mCropTop, mCropRight, mCropBottom;
     };
 
-    OMX_COLOR_FORMATTYPE mSrcFormat, mDstFormat;
-    uint8_t *mClip;
-
-    uint8_t *initClip();
-
-    status_t convertCbYCrY(
-            const BitmapParams &src, const BitmapParams &dst);
-
-    status_t convertYUV420Planar(
-            const BitmapParams &src, const BitmapParams &dst);
+    struct BandPool;
+    struct SourceLayout;
 
-    status_t convertQCOMYUV420SemiPlanar(
-            const BitmapParams &src, const BitmapParams &dst);
-
-    status_t convertYUV420SemiPlanar(
-            const BitmapParams &src, const BitmapParams &dst);
+    enum {
+        kMinRowsPerBand = 64,
+    };
 
-    status_t convertTIYUV420PackedSemiPlanar(
-            const BitmapParams &src, const BitmapParams &dst);
+    OMX_COLOR_FORMATTYPE mSrcFormat, mDstFormat;
+    ScalingMode mScalingMode;
+    size_t mNumThreads;
+    BandPool *mBandPool;
+
+    // Converts rows [firstRow, firstRow + numRows) of the destination crop
+    // rectangle. Safe to call concurrently for disjoint row ranges.
+    void convertRows(
+            const BitmapParams &src, const BitmapParams &dst,
+            size_t firstRow, size_t numRows) const;
+
+    void convertScaledRows(
+            const BitmapParams &src, const BitmapParams &dst,
+            const SourceLayout &layout,
+            size_t firstRow, size_t numRows) const;
+
+    // Describes where the Y, U and V samples of the source crop rectangle
+    // live for the source color format.
+    void getSourceLayout(const BitmapParams &src, SourceLayout *layout) const;
+
+    // Returns the start of row |row| of the destination crop rectangle.
+    uint8_t *dstRow(const BitmapParams &dst, size_t row) const;
+
+    // Whether the destination stores B where the row kernels put R, which
+    // only depends on the destination format.
+    bool swapRB() const;
 
     ColorConverter(const ColorConverter &);
     ColorConverter &operator=(const ColorConverter &);
@@ -44,12 +44,36 @@ struct MediaCodec : public AHandler {
         BUFFER_FLAG_EOS         = 4,
     };
 
+    enum CallbackID {
+        CB_INPUT_AVAILABLE          = 1,
+        CB_OUTPUT_AVAILABLE         = 2,
+        CB_ERROR                    = 3,
+        CB_OUTPUT_FORMAT_CHANGED    = 4,
+    };
+
     static sp<MediaCodec> CreateByType(
             const sp<ALooper> &looper, const char *mime, bool encoder);
 
     static sp<MediaCodec> CreateByComponentName(
             const sp<ALooper> &looper, const char *name);
 
+    // Switches the codec to asynchronous operation, must be called before
+    // configure(). Instead of being dequeued, buffers are handed to the
+    // client by posting a copy of "callback" with "callbackID" set to
+    //   CB_INPUT_AVAILABLE: "index"
+    //   CB_OUTPUT_AVAILABLE: "index", "offset", "size", "timeUs", "flags"
+    //   CB_OUTPUT_FORMAT_CHANGED: "format", and "buffers-changed" if
+    //       getOutputBuffers() must be called again
+    //   CB_ERROR: "err", and "index" if a queueInputBuffer() or
+    //       releaseOutputBuffer() call on that buffer failed; without
+    //       "index" the codec is unusable until stop()
+    // queueInputBuffer(), renderOutputBufferAndRelease() and
+    // releaseOutputBuffer() then return without waiting for the codec and
+    // may be called from any thread. dequeueInputBuffer() and
+    // dequeueOutputBuffer() are not available. A NULL callback returns the
+    // codec to synchronous operation.
+    status_t setCallback(const sp<AMessage> &callback);
+
     status_t configure(
             const sp<AMessage> &format,
             const sp<Surface> &nativeWindow,
@@ -166,6 +190,7 @@ private:
         kWhatRequestActivityNotification    = 'racN',
         kWhatGetName                        = 'getN',
         kWhatSetParameters                  = 'setP',
+        kWhatSetCallback                    = 'setC',
     };
 
     enum {
@@ -179,6 +204,7 @@ private:
         kFlagSawMediaServerDie          = 128,
         kFlagIsEncoder                  = 256,
         kFlagGatherCodecSpecificData    = 512,
+        kFlagIsAsync                    = 1024,
     };
 
     struct BufferInfo {
@@ -215,8 +241,15 @@ private:
 
     sp<AMessage> mActivityNotify;
 
+    sp<AMessage> mCallback;
+
     bool mHaveInputSurface;
 
+    // A copy of kFlagIsAsync for the client's threads, which decides whether
+    // their calls wait for a response. Only the looper writes it, together
+    // with kFlagIsAsync.
+    volatile int32_t mIsAsync;
+
     MediaCodec(const sp<ALooper> &looper);
 
     static status_t PostAndAwaitResponse(
@@ -244,6 +277,11 @@ private:
 
     void postActivityNotificationIfPossible();
 
+    void onInputBufferAvailable();
+    void onOutputBufferAvailable();
+    void onOutputFormatChanged();
+    void onError(status_t err, ssize_t index = -1);
+
     status_t onSetParameters(const sp<AMessage> &params);
 
     status_t amendOutputFormatWithCodecSpecificData(const sp<ABuffer> &buffer);
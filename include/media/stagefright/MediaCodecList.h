@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <utils/Errors.h>
 #include <utils/KeyedVector.h>
+#include <utils/threads.h>
 #include <utils/Vector.h>
 
 namespace android {
@@ -47,6 +48,9 @@ struct MediaCodecList {
         uint32_t mProfile;
         uint32_t mLevel;
     };
+
+    // Only the first query for a component and type instantiates the
+    // component, the answer is kept in the cache.
     status_t getCodecCapabilities(
             size_t index, const char *type,
             Vector<ProfileLevel> *profileLevels,
@@ -68,9 +72,16 @@ private:
         uint32_t mQuirks;
     };
 
+    struct Capabilities {
+        Vector<ProfileLevel> mProfileLevels;
+        Vector<uint32_t> mColorFormats;
+    };
+
     static MediaCodecList *sCodecList;
 
     status_t mInitCheck;
+    AString mCodecsXmlFile;
+    AString mCacheFile;
     Section mCurrentSection;
     int32_t mDepth;
 
@@ -78,12 +89,29 @@ private:
     KeyedVector<AString, size_t> mCodecQuirks;
     KeyedVector<AString, size_t> mTypes;
 
-    MediaCodecList();
+    // The codecs that came from the configuration file, and are saved in
+    // the cache, are the first mNumConfiguredCodecs ones.
+    size_t mNumConfiguredCodecs;
+
+    // Indices of the decoders (2 * type bit) and encoders (2 * type bit + 1)
+    // of each type, in ascending order.
+    Vector<Vector<size_t> > mCodecsForType;
+    KeyedVector<AString, size_t> mCodecIndexByName;
+
+    // Keyed by "<component name>/<type>".
+    mutable Mutex mCapsLock;
+    mutable KeyedVector<AString, Capabilities> mCaps;
+
+    MediaCodecList(const char *codecsXmlFile, const char *cacheFile);
     ~MediaCodecList();
 
     status_t initCheck() const;
     void parseXMLFile(FILE *file);
 
+    status_t loadCache();
+    void saveCache_l() const;
+    void buildIndex();
+
     static void StartElementHandlerWrapper(
             void *me, const char *name, const char **attrs);
 
@@ -100,6 +128,7 @@ private:
     void addType(const char *name);
 
     friend class QCUtils;
+    friend struct MediaCodecListTest;
 
     DISALLOW_EVIL_CONSTRUCTORS(MediaCodecList);
 };
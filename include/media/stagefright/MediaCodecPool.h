@@ -0,0 +1,114 @@
+/*
+ * Copyright 2013, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEDIA_CODEC_POOL_H_
+
+#define MEDIA_CODEC_POOL_H_
+
+#include <media/stagefright/foundation/AHandler.h>
+#include <media/stagefright/foundation/AString.h>
+#include <utils/KeyedVector.h>
+#include <utils/List.h>
+#include <utils/threads.h>
+
+namespace android {
+
+struct ALooper;
+struct MediaCodec;
+
+// Keeps stopped MediaCodecs, whose components remain allocated, so that
+// the next client asking for the same component only has to configure and
+// start it. Short clips and thumbnails otherwise spend most of their time
+// finding, allocating and freeing the component.
+//
+// Codecs handed out are used as usual; when done, the client gives them
+// back with recycle() instead of calling release(). Idle codecs are
+// released after idleTimeoutUs, and at most maxIdleCodecs are kept.
+struct MediaCodecPool : public AHandler {
+    enum {
+        kDefaultMaxIdleCodecs   = 4,
+        kDefaultIdleTimeoutUs   = 5000000,
+    };
+
+    MediaCodecPool(
+            size_t maxIdleCodecs = kDefaultMaxIdleCodecs,
+            int64_t idleTimeoutUs = kDefaultIdleTimeoutUs);
+
+    // The pool runs on a looper of its own. Each codec it creates gets a
+    // looper of its own as well, which the codec keeps running for as long
+    // as it exists, so codecs handed out outlive the pool.
+    status_t start();
+
+    // Releases the idle codecs. Codecs handed out are unaffected.
+    void stop();
+
+    // Like MediaCodec::CreateByType() and CreateByComponentName(), but a
+    // codec for the same component is taken from the pool if there is one.
+    sp<MediaCodec> acquireByType(const char *mime, bool encoder);
+    sp<MediaCodec> acquireByComponentName(const char *name);
+
+    // Stops the codec and keeps it, or releases it if it failed or the
+    // pool is full. The codec must have come from this pool.
+    void recycle(const sp<MediaCodec> &codec);
+
+    size_t countIdleCodecs() const;
+
+protected:
+    virtual ~MediaCodecPool();
+
+    virtual void onMessageReceived(const sp<AMessage> &msg);
+
+private:
+    enum {
+        kWhatCheckIdle  = 'chkI',
+    };
+
+    struct IdleCodec {
+        sp<MediaCodec> mCodec;
+        AString mComponentName;
+        int64_t mIdleSinceUs;
+    };
+
+    size_t mMaxIdleCodecs;
+    int64_t mIdleTimeoutUs;
+
+    sp<ALooper> mLooper;
+
+    mutable Mutex mLock;
+
+    // Oldest first.
+    List<IdleCodec> mIdleCodecs;
+
+    // The component picked the last time a codec was created by type,
+    // keyed by "<mime>/<encoder>". Saves the MediaCodecList lookup and
+    // makes acquireByType() find the idle codecs of that component.
+    KeyedVector<AString, AString> mComponentForType;
+
+    bool mCheckIdlePending;
+
+    sp<MediaCodec> takeIdleCodec(const AString &componentName);
+    static sp<ALooper> NewCodecLooper();
+    void scheduleCheckIdle_l();
+    void onCheckIdle();
+
+    static void ReleaseCodecs(List<IdleCodec> *codecs);
+
+    DISALLOW_EVIL_CONSTRUCTORS(MediaCodecPool);
+};
+
+}  // namespace android
+
+#endif  // MEDIA_CODEC_POOL_H_
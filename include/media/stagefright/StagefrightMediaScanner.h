@@ -32,6 +32,12 @@ struct StagefrightMediaScanner : public MediaScanner {
 
     virtual char *extractAlbumArt(int fd);
 
+protected:
+    // Reads the metadata through a MediaMetadataRetriever, for the files
+    // that the in-process extractors cannot describe.
+    virtual MediaScanResult processFileWithRetriever(
+            const char *path, MediaScannerClient &client);
+
 private:
     StagefrightMediaScanner(const StagefrightMediaScanner &);
     StagefrightMediaScanner &operator=(const StagefrightMediaScanner &);
@@ -113,6 +113,15 @@ public:
 
                 // Cache line boundary (32 bytes)
 
+private:
+                // AudioTrack only: total number of underruns, never reset.
+                // Server write-only, client reads it without the lock.
+    volatile    uint32_t    mUnderrunCount;
+
+                // number of clients blocked in waitServer_l(), protected by lock
+                int32_t     mWaiters;
+
+public:
 #if 0
                 union {
                     AudioTrackSharedStreaming   mStreaming;
@@ -127,6 +136,11 @@ public:
                 // is only used for placement new().  It is never used for regular new() or stack.
                             audio_track_cblk_t();
 
+                // Called by the client with lock held, to wait until the server has stepped.
+                // stepServer() only signals cv when a client is waiting here, which saves the
+                // server a futex wake per step while the client is busy filling the buffer.
+                status_t    waitServer_l(nsecs_t reltime);
+
 private:
                 // if there is a shared buffer, "buffers" is the value of pointer() for the shared
                 // buffer, otherwise "buffers" points immediately after the control block
@@ -229,6 +243,11 @@ public:
         return mCblk->framesAvailable_l(mFrameCount, true /*isOut*/);
     }
 
+    // called by AudioTrack::getUnderrunCount, does not take any lock
+    uint32_t    getUnderrunCount() const {
+        return mCblk->mUnderrunCount;
+    }
+
 };
 
 // ----------------------------------------------------------------------------
@@ -274,6 +293,12 @@ public:
     uint16_t    getSendLevel_U4_12() const { return mCblk->mSendLevel; }
     uint32_t    getVolumeLR() const { return mCblk->mVolumeLR; }
 
+    // for AudioTrack only, publishes the track's underrun count to the client
+    void        setUnderrunCount(uint32_t underrunCount) {
+        ALOG_ASSERT(mIsOut);
+        mCblk->mUnderrunCount = underrunCount;
+    }
+
     // for AudioTrack only
     size_t      framesReady() {
         ALOG_ASSERT(mIsOut);
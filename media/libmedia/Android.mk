@@ -56,6 +56,7 @@ LOCAL_SRC_FILES:= \
     ToneGenerator.cpp \
     JetPlayer.cpp \
     IOMX.cpp \
+    OMXBufferRing.cpp \
     IAudioPolicyService.cpp \
     MediaScanner.cpp \
     MediaScannerClient.cpp \
@@ -642,7 +642,7 @@ status_t AudioRecord::obtainBuffer(Buffer* audioBuffer, int32_t waitCount)
                 // this condition is in shared memory, so if IAudioRecord and control block
                 // are replaced due to mediaserver death or IAudioRecord invalidation then
                 // cv won't be signalled, but fortunately the timeout will limit the wait
-                result = cblk->cv.waitRelative(cblk->lock, milliseconds(waitTimeMs));
+                result = cblk->waitServer_l(milliseconds(waitTimeMs));
                 cblk->lock.unlock();
                 mLock.lock();
                 if (!mActive) {
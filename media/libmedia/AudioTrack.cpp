@@ -874,6 +874,17 @@ status_t AudioTrack::getPosition(uint32_t *position)
     return NO_ERROR;
 }
 
+uint32_t AudioTrack::getUnderrunCount() const
+{
+    if (mStatus != NO_ERROR) {
+        return 0;
+    }
+
+    // mLock is local to this process; it only guards against the control block being replaced
+    AutoMutex lock(mLock);
+    return mProxy->getUnderrunCount();
+}
+
 status_t AudioTrack::reload()
 {
     if (mStatus != NO_ERROR) {
@@ -1158,86 +1169,82 @@ status_t AudioTrack::obtainBuffer(Buffer* audioBuffer, int32_t waitCount)
     audioBuffer->frameCount  = 0;
     audioBuffer->size = 0;
 
-    size_t framesAvail = mProxy->framesAvailable();
+    size_t framesAvail;
 
+    // A single round trip on the shared lock when there is room, which is the common case.
     cblk->lock.lock();
     if (cblk->flags & CBLK_INVALID) {
         goto create_new_track;
     }
-    cblk->lock.unlock();
+    framesAvail = mProxy->framesAvailable_l();
 
-    if (framesAvail == 0) {
-        cblk->lock.lock();
-        goto start_loop_here;
-        while (framesAvail == 0) {
-            active = mActive;
-            if (CC_UNLIKELY(!active)) {
-                ALOGV("Not active and NO_MORE_BUFFERS");
-                cblk->lock.unlock();
-                return NO_MORE_BUFFERS;
-            }
-            if (CC_UNLIKELY(!waitCount)) {
-                cblk->lock.unlock();
-                return WOULD_BLOCK;
-            }
-            if (!(cblk->flags & CBLK_INVALID)) {
-                mLock.unlock();
-                // this condition is in shared memory, so if IAudioTrack and control block
-                // are replaced due to mediaserver death or IAudioTrack invalidation then
-                // cv won't be signalled, but fortunately the timeout will limit the wait
-                result = cblk->cv.waitRelative(cblk->lock, milliseconds(waitTimeMs));
-                cblk->lock.unlock();
-                mLock.lock();
-                if (!mActive) {
-                    return status_t(STOPPED);
-                }
-                // IAudioTrack may have been re-created while mLock was unlocked
-                cblk = mCblk;
-                cblk->lock.lock();
+    while (framesAvail == 0) {
+        active = mActive;
+        if (CC_UNLIKELY(!active)) {
+            ALOGV("Not active and NO_MORE_BUFFERS");
+            cblk->lock.unlock();
+            return NO_MORE_BUFFERS;
+        }
+        if (CC_UNLIKELY(!waitCount)) {
+            cblk->lock.unlock();
+            return WOULD_BLOCK;
+        }
+        if (!(cblk->flags & CBLK_INVALID)) {
+            mLock.unlock();
+            // this condition is in shared memory, so if IAudioTrack and control block
+            // are replaced due to mediaserver death or IAudioTrack invalidation then
+            // cv won't be signalled, but fortunately the timeout will limit the wait
+            result = cblk->waitServer_l(milliseconds(waitTimeMs));
+            cblk->lock.unlock();
+            mLock.lock();
+            if (!mActive) {
+                return status_t(STOPPED);
             }
+            // IAudioTrack may have been re-created while mLock was unlocked
+            cblk = mCblk;
+            cblk->lock.lock();
+        }
 
-            if (cblk->flags & CBLK_INVALID) {
-                goto create_new_track;
-            }
-            if (CC_UNLIKELY(result != NO_ERROR)) {
-                cblk->waitTimeMs += waitTimeMs;
-                if (cblk->waitTimeMs >= cblk->bufferTimeoutMs) {
-                    // timing out when a loop has been set and we have already written upto loop end
-                    // is a normal condition: no need to wake AudioFlinger up.
-                    if (cblk->user < cblk->loopEnd) {
-                        ALOGW("obtainBuffer timed out (is the CPU pegged?) %p name=%#x user=%08x, "
-                              "server=%08x", this, cblk->mName, cblk->user, cblk->server);
-                        //unlock cblk mutex before calling mAudioTrack->start() (see issue #1617140)
-                        cblk->lock.unlock();
-                        result = mAudioTrack->start();
-                        cblk->lock.lock();
-                        if (result == DEAD_OBJECT) {
-                            android_atomic_or(CBLK_INVALID, &cblk->flags);
+        if (cblk->flags & CBLK_INVALID) {
+            goto create_new_track;
+        }
+        if (CC_UNLIKELY(result != NO_ERROR)) {
+            cblk->waitTimeMs += waitTimeMs;
+            if (cblk->waitTimeMs >= cblk->bufferTimeoutMs) {
+                // timing out when a loop has been set and we have already written upto loop end
+                // is a normal condition: no need to wake AudioFlinger up.
+                if (cblk->user < cblk->loopEnd) {
+                    ALOGW("obtainBuffer timed out (is the CPU pegged?) %p name=%#x user=%08x, "
+                          "server=%08x", this, cblk->mName, cblk->user, cblk->server);
+                    //unlock cblk mutex before calling mAudioTrack->start() (see issue #1617140)
+                    cblk->lock.unlock();
+                    result = mAudioTrack->start();
+                    cblk->lock.lock();
+                    if (result == DEAD_OBJECT) {
+                        android_atomic_or(CBLK_INVALID, &cblk->flags);
 create_new_track:
-                            audio_track_cblk_t* temp = cblk;
-                            result = restoreTrack_l(temp, false /*fromStart*/);
-                            cblk = temp;
-                        }
-                        if (result != NO_ERROR) {
-                            ALOGW("obtainBuffer create Track error %d", result);
-                            cblk->lock.unlock();
-                            return result;
-                        }
+                        audio_track_cblk_t* temp = cblk;
+                        result = restoreTrack_l(temp, false /*fromStart*/);
+                        cblk = temp;
+                    }
+                    if (result != NO_ERROR) {
+                        ALOGW("obtainBuffer create Track error %d", result);
+                        cblk->lock.unlock();
+                        return result;
                     }
-                    cblk->waitTimeMs = 0;
                 }
+                cblk->waitTimeMs = 0;
+            }
 
-                if (--waitCount == 0) {
-                    cblk->lock.unlock();
-                    return TIMED_OUT;
-                }
+            if (--waitCount == 0) {
+                cblk->lock.unlock();
+                return TIMED_OUT;
             }
-            // read the server count again
-        start_loop_here:
-            framesAvail = mProxy->framesAvailable_l();
         }
-        cblk->lock.unlock();
+        // read the server count again
+        framesAvail = mProxy->framesAvailable_l();
     }
+    cblk->lock.unlock();
 
     cblk->waitTimeMs = 0;
 
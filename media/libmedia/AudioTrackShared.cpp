@@ -26,10 +26,18 @@ audio_track_cblk_t::audio_track_cblk_t()
     : lock(Mutex::SHARED), cv(Condition::SHARED), user(0), server(0),
     userBase(0), serverBase(0), frameCount_(0),
     loopStart(UINT_MAX), loopEnd(UINT_MAX), loopCount(0), mVolumeLR(0x10001000),
-    mSampleRate(0), mSendLevel(0), flags(0)
+    mSampleRate(0), mSendLevel(0), flags(0), mUnderrunCount(0), mWaiters(0)
 {
 }
 
+status_t audio_track_cblk_t::waitServer_l(nsecs_t reltime)
+{
+    ++mWaiters;
+    status_t result = cv.waitRelative(lock, reltime);
+    --mWaiters;
+    return result;
+}
+
 uint32_t audio_track_cblk_t::stepUser(size_t stepCount, size_t frameCount, bool isOut)
 {
     ALOGV("stepuser %08x %08x %d", user, server, stepCount);
@@ -117,7 +125,7 @@ bool audio_track_cblk_t::stepServer(size_t stepCount, size_t frameCount, bool is
 
     server = s;
 
-    if (!(flags & CBLK_INVALID)) {
+    if (mWaiters > 0 && !(flags & CBLK_INVALID)) {
         cv.signal();
     }
     lock.unlock();
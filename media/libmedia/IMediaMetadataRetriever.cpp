@@ -65,6 +65,7 @@ enum {
     GET_FRAME_AT_TIME,
     EXTRACT_ALBUM_ART,
     EXTRACT_METADATA,
+    GET_FRAMES_AT_TIMES,
 };
 
 class BpMediaMetadataRetriever: public BpInterface<IMediaMetadataRetriever>
@@ -116,13 +117,18 @@ public:
         return reply.readInt32();
     }
 
-    sp<IMemory> getFrameAtTime(int64_t timeUs, int option)
+    sp<IMemory> getFrameAtTime(
+            int64_t timeUs, int option, const VideoFrameOptions &frameOptions)
     {
         ALOGV("getTimeAtTime: time(%lld us) and option(%d)", timeUs, option);
         Parcel data, reply;
         data.writeInterfaceToken(IMediaMetadataRetriever::getInterfaceDescriptor());
         data.writeInt64(timeUs);
         data.writeInt32(option);
+        data.writeInt32(frameOptions.mFormat);
+        data.writeInt32(frameOptions.mMaxWidth);
+        data.writeInt32(frameOptions.mMaxHeight);
+        data.writeInt32(frameOptions.mScalingMode);
 #ifndef DISABLE_GROUP_SCHEDULE_HACK
         sendSchedPolicy(data);
 #endif
@@ -134,6 +140,48 @@ public:
         return interface_cast<IMemory>(reply.readStrongBinder());
     }
 
+    status_t getFramesAtTimes(
+            const Vector<int64_t> &timesUs, int option,
+            const VideoFrameOptions &frameOptions,
+            Vector<sp<IMemory> > *frames)
+    {
+        ALOGV("getFramesAtTimes: %zu times and option(%d)",
+                timesUs.size(), option);
+        frames->clear();
+        Parcel data, reply;
+        data.writeInterfaceToken(IMediaMetadataRetriever::getInterfaceDescriptor());
+        data.writeInt32(timesUs.size());
+        for (size_t i = 0; i < timesUs.size(); ++i) {
+            data.writeInt64(timesUs[i]);
+        }
+        data.writeInt32(option);
+        data.writeInt32(frameOptions.mFormat);
+        data.writeInt32(frameOptions.mMaxWidth);
+        data.writeInt32(frameOptions.mMaxHeight);
+        data.writeInt32(frameOptions.mScalingMode);
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+        sendSchedPolicy(data);
+#endif
+        status_t err = remote()->transact(GET_FRAMES_AT_TIMES, data, &reply);
+        if (err != NO_ERROR) {
+            return err;
+        }
+        status_t ret = reply.readInt32();
+        if (ret != NO_ERROR) {
+            return ret;
+        }
+        // Frames that share a heap map it once, see HeapCache.
+        size_t count = reply.readInt32();
+        for (size_t i = 0; i < count; ++i) {
+            if (reply.readInt32()) {
+                frames->push(interface_cast<IMemory>(reply.readStrongBinder()));
+            } else {
+                frames->push(NULL);
+            }
+        }
+        return NO_ERROR;
+    }
+
     sp<IMemory> extractAlbumArt()
     {
         Parcel data, reply;
@@ -222,11 +270,16 @@ status_t BnMediaMetadataRetriever::onTransact(
             CHECK_INTERFACE(IMediaMetadataRetriever, data, reply);
             int64_t timeUs = data.readInt64();
             int option = data.readInt32();
+            VideoFrameOptions frameOptions;
+            frameOptions.mFormat = data.readInt32();
+            frameOptions.mMaxWidth = data.readInt32();
+            frameOptions.mMaxHeight = data.readInt32();
+            frameOptions.mScalingMode = data.readInt32();
             ALOGV("getTimeAtTime: time(%lld us) and option(%d)", timeUs, option);
 #ifndef DISABLE_GROUP_SCHEDULE_HACK
             setSchedPolicy(data);
 #endif
-            sp<IMemory> bitmap = getFrameAtTime(timeUs, option);
+            sp<IMemory> bitmap = getFrameAtTime(timeUs, option, frameOptions);
             if (bitmap != 0) {  // Don't send NULL across the binder interface
                 reply->writeInt32(NO_ERROR);
                 reply->writeStrongBinder(bitmap->asBinder());
@@ -235,6 +288,47 @@ status_t BnMediaMetadataRetriever::onTransact(
             }
 #ifndef DISABLE_GROUP_SCHEDULE_HACK
             restoreSchedPolicy();
+#endif
+            return NO_ERROR;
+        } break;
+        case GET_FRAMES_AT_TIMES: {
+            CHECK_INTERFACE(IMediaMetadataRetriever, data, reply);
+            int32_t count = data.readInt32();
+            if (count < 0
+                    || (size_t)count > data.dataAvail() / sizeof(int64_t)) {
+                return BAD_VALUE;
+            }
+            Vector<int64_t> timesUs;
+            for (int32_t i = 0; i < count; ++i) {
+                timesUs.push(data.readInt64());
+            }
+            int option = data.readInt32();
+            VideoFrameOptions frameOptions;
+            frameOptions.mFormat = data.readInt32();
+            frameOptions.mMaxWidth = data.readInt32();
+            frameOptions.mMaxHeight = data.readInt32();
+            frameOptions.mScalingMode = data.readInt32();
+            ALOGV("getFramesAtTimes: %d times and option(%d)", count, option);
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+            setSchedPolicy(data);
+#endif
+            Vector<sp<IMemory> > frames;
+            status_t err = getFramesAtTimes(timesUs, option, frameOptions, &frames);
+            reply->writeInt32(err);
+            if (err == NO_ERROR) {
+                reply->writeInt32(frames.size());
+                for (size_t i = 0; i < frames.size(); ++i) {
+                    // Don't send NULL across the binder interface
+                    if (frames[i] != 0) {
+                        reply->writeInt32(1);
+                        reply->writeStrongBinder(frames[i]->asBinder());
+                    } else {
+                        reply->writeInt32(0);
+                    }
+                }
+            }
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+            restoreSchedPolicy();
 #endif
             return NO_ERROR;
         } break;
@@ -18,10 +18,17 @@
 #define LOG_TAG "IOMX"
 #include <utils/Log.h>
 
+#include <string.h>
+#include <unistd.h>
+
 #include <binder/IMemory.h>
 #include <binder/Parcel.h>
+#include <cutils/properties.h>
 #include <media/IOMX.h>
+#include <media/OMXBufferRing.h>
 #include <media/stagefright/foundation/ADebug.h>
+#include <utils/KeyedVector.h>
+#include <utils/threads.h>
 
 namespace android {
 
@@ -51,6 +58,57 @@ enum {
     GET_EXTENSION_INDEX,
     OBSERVER_ON_MSG,
     GET_GRAPHIC_BUFFER_USAGE,
+    OBSERVER_ON_MSGS,
+    SET_BUFFER_RING,
+};
+
+// Hands the messages a node posts to its ring to the observer.
+struct BufferRingListener : public Thread {
+    BufferRingListener(
+            const sp<OMXBufferRing> &ring, const sp<IOMXObserver> &observer)
+        : Thread(false /* canCallJava */),
+          mRing(ring),
+          mObserver(observer) {
+    }
+
+    const sp<OMXBufferRing> &ring() const {
+        return mRing;
+    }
+
+    void stop() {
+        requestExit();
+        mRing->signalMessages();
+
+        // The observer may free the node from within onMessages().
+        status_t status = join();
+        if (status != WOULD_BLOCK) {
+            CHECK_EQ(status, (status_t)NO_ERROR);
+        }
+    }
+
+private:
+    sp<OMXBufferRing> mRing;
+    sp<IOMXObserver> mObserver;
+
+    virtual bool threadLoop() {
+        if (mRing->waitForMessages() != OK || exitPending()) {
+            return false;
+        }
+
+        List<omx_message> messages;
+        omx_message msg;
+        while (mRing->readMessage(&msg)) {
+            messages.push_back(msg);
+        }
+
+        if (!messages.empty()) {
+            mObserver->onMessages(messages);
+        }
+
+        return true;
+    }
+
+    DISALLOW_EVIL_CONSTRUCTORS(BufferRingListener);
 };
 
 class BpOMX : public BpInterface<IOMX> {
@@ -59,6 +117,12 @@ public:
         : BpInterface<IOMX>(impl) {
     }
 
+    virtual ~BpOMX() {
+        for (size_t i = 0; i < mRingListeners.size(); ++i) {
+            mRingListeners.valueAt(i)->stop();
+        }
+    }
+
     virtual bool livesLocally(node_id node, pid_t pid) {
         Parcel data, reply;
         data.writeInterfaceToken(IOMX::getInterfaceDescriptor());
@@ -102,6 +166,7 @@ public:
         status_t err = reply.readInt32();
         if (err == OK) {
             *node = (void*)reply.readIntPtr();
+            attachBufferRing(*node, observer);
         } else {
             *node = 0;
         }
@@ -115,6 +180,8 @@ public:
         data.writeIntPtr((intptr_t)node);
         remote()->transact(FREE_NODE, data, &reply);
 
+        detachBufferRing(node);
+
         return reply.readInt32();
     }
 
@@ -392,6 +459,17 @@ public:
     }
 
     virtual status_t fillBuffer(node_id node, buffer_id buffer) {
+        OMXBufferRing::Request request;
+        request.type = OMXBufferRing::Request::FILL_BUFFER;
+        request.buffer = buffer;
+        request.range_offset = 0;
+        request.range_length = 0;
+        request.flags = 0;
+        request.timestamp = 0;
+        if (postBufferRequest(node, request)) {
+            return OK;
+        }
+
         Parcel data, reply;
         data.writeInterfaceToken(IOMX::getInterfaceDescriptor());
         data.writeIntPtr((intptr_t)node);
@@ -406,6 +484,17 @@ public:
             buffer_id buffer,
             OMX_U32 range_offset, OMX_U32 range_length,
             OMX_U32 flags, OMX_TICKS timestamp) {
+        OMXBufferRing::Request request;
+        request.type = OMXBufferRing::Request::EMPTY_BUFFER;
+        request.buffer = buffer;
+        request.range_offset = range_offset;
+        request.range_length = range_length;
+        request.flags = flags;
+        request.timestamp = timestamp;
+        if (postBufferRequest(node, request)) {
+            return OK;
+        }
+
         Parcel data, reply;
         data.writeInterfaceToken(IOMX::getInterfaceDescriptor());
         data.writeIntPtr((intptr_t)node);
@@ -439,6 +528,93 @@ public:
 
         return err;
     }
+
+    virtual status_t setBufferRing(
+            node_id node, const sp<OMXBufferRing> &ring) {
+        Parcel data, reply;
+        data.writeInterfaceToken(IOMX::getInterfaceDescriptor());
+        data.writeIntPtr((intptr_t)node);
+        data.writeStrongBinder(ring->memory()->asBinder());
+        data.writeFileDescriptor(ring->requestFd());
+        data.writeFileDescriptor(ring->messageFd());
+
+        status_t err = remote()->transact(SET_BUFFER_RING, data, &reply);
+        if (err != OK) {
+            return err;
+        }
+
+        return reply.readInt32();
+    }
+
+private:
+    Mutex mLock;
+    KeyedVector<node_id, sp<BufferRingListener> > mRingListeners;
+
+    // Without a ring the node keeps working through binder, so nothing
+    // here is an error.
+    void attachBufferRing(node_id node, const sp<IOMXObserver> &observer) {
+        char value[PROPERTY_VALUE_MAX];
+        if (property_get("media.stagefright.omx.ring", value, NULL)
+                && !strcmp(value, "0")) {
+            return;
+        }
+
+        sp<OMXBufferRing> ring = OMXBufferRing::Create();
+        if (ring == NULL) {
+            ALOGW("Could not create a buffer ring for node %p", node);
+            return;
+        }
+
+        // Listen before the node starts posting.
+        sp<BufferRingListener> listener =
+            new BufferRingListener(ring, observer);
+        if (listener->run("OMXBufferRing", ANDROID_PRIORITY_FOREGROUND) != OK) {
+            return;
+        }
+
+        if (setBufferRing(node, ring) != OK) {
+            listener->stop();
+            return;
+        }
+
+        Mutex::Autolock autoLock(mLock);
+        mRingListeners.add(node, listener);
+    }
+
+    void detachBufferRing(node_id node) {
+        sp<BufferRingListener> listener;
+        {
+            Mutex::Autolock autoLock(mLock);
+            ssize_t index = mRingListeners.indexOfKey(node);
+            if (index < 0) {
+                return;
+            }
+            listener = mRingListeners.valueAt(index);
+            mRingListeners.removeItemsAt(index);
+        }
+
+        listener->stop();
+    }
+
+    // Returns false if the request has to go through binder because the
+    // node has no ring or the ring is full. The node carries out what is
+    // queued in the ring before any binder call.
+    bool postBufferRequest(
+            node_id node, const OMXBufferRing::Request &request) {
+        Mutex::Autolock autoLock(mLock);
+        ssize_t index = mRingListeners.indexOfKey(node);
+        if (index < 0) {
+            return false;
+        }
+
+        const sp<OMXBufferRing> &ring = mRingListeners.valueAt(index)->ring();
+        if (!ring->postRequest(request)) {
+            return false;
+        }
+        ring->signalRequests();
+
+        return true;
+    }
 };
 
 IMPLEMENT_META_INTERFACE(OMX, "android.hardware.IOMX");
@@ -813,6 +989,28 @@ status_t BnOMX::onTransact(
             return OK;
         }
 
+        case SET_BUFFER_RING:
+        {
+            CHECK_OMX_INTERFACE(IOMX, data, reply);
+
+            node_id node = (void*)data.readIntPtr();
+            sp<IMemory> memory =
+                interface_cast<IMemory>(data.readStrongBinder());
+            int requestFd = dup(data.readFileDescriptor());
+            int messageFd = dup(data.readFileDescriptor());
+
+            sp<OMXBufferRing> ring =
+                new OMXBufferRing(memory, requestFd, messageFd);
+
+            status_t err = ring->initCheck();
+            if (err == OK) {
+                err = setBufferRing(node, ring);
+            }
+            reply->writeInt32(err);
+
+            return NO_ERROR;
+        }
+
         default:
             return BBinder::onTransact(code, data, reply, flags);
     }
@@ -833,10 +1031,34 @@ public:
 
         remote()->transact(OBSERVER_ON_MSG, data, &reply, IBinder::FLAG_ONEWAY);
     }
+
+    virtual void onMessages(const List<omx_message> &messages) {
+        if (messages.size() == 1) {
+            onMessage(*messages.begin());
+            return;
+        }
+
+        Parcel data, reply;
+        data.writeInterfaceToken(IOMXObserver::getInterfaceDescriptor());
+        data.writeInt32(messages.size());
+        for (List<omx_message>::const_iterator it = messages.begin();
+                it != messages.end(); ++it) {
+            data.write(&*it, sizeof(omx_message));
+        }
+
+        remote()->transact(OBSERVER_ON_MSGS, data, &reply, IBinder::FLAG_ONEWAY);
+    }
 };
 
 IMPLEMENT_META_INTERFACE(OMXObserver, "android.hardware.IOMXObserver");
 
+void IOMXObserver::onMessages(const List<omx_message> &messages) {
+    for (List<omx_message>::const_iterator it = messages.begin();
+            it != messages.end(); ++it) {
+        onMessage(*it);
+    }
+}
+
 status_t BnOMXObserver::onTransact(
     uint32_t code, const Parcel &data, Parcel *reply, uint32_t flags) {
     switch (code) {
@@ -853,6 +1075,28 @@ status_t BnOMXObserver::onTransact(
             return NO_ERROR;
         }
 
+        case OBSERVER_ON_MSGS:
+        {
+            CHECK_OMX_INTERFACE(IOMXObserver, data, reply);
+
+            int32_t count = data.readInt32();
+            if (count < 0
+                    || (size_t)count > data.dataAvail() / sizeof(omx_message)) {
+                return BAD_VALUE;
+            }
+
+            List<omx_message> messages;
+            for (int32_t i = 0; i < count; ++i) {
+                omx_message msg;
+                data.read(&msg, sizeof(msg));
+                messages.push_back(msg);
+            }
+
+            onMessages(messages);
+
+            return NO_ERROR;
+        }
+
         default:
             return BBinder::onTransact(code, data, reply, flags);
     }
@@ -20,23 +20,565 @@
 #include <utils/Log.h>
 
 #include <media/mediascanner.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
 
 #include <sys/stat.h>
 #include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 namespace android {
 
+// Remembers the regular files seen under one scan root, see
+// MediaScanner::setScanStateFile(). The state file holds one
+// "<mtime> <size> <noMedia> <path>" line per file, sorted by path.
+struct MediaScanner::ScanState {
+    ScanState(const char *stateFile, const char *root);
+
+    // Safe to call from several threads at once.
+    bool isUnchanged(
+            const char *path, long long lastModified, long long fileSize,
+            bool noMedia) const;
+
+    // Callers must serialize calls to record().
+    void record(
+            const char *path, long long lastModified, long long fileSize,
+            bool noMedia);
+
+    // Writes the files recorded by this scan and those of earlier scans
+    // outside of its root back to the state file.
+    status_t save();
+
+private:
+    struct Entry {
+        String8 mPath;
+        long long mLastModified;
+        long long mFileSize;
+        bool mNoMedia;
+    };
+
+    String8 mStateFile;
+    String8 mRoot;
+
+    // Sorted by path.
+    Vector<Entry> mOldEntries;
+    Vector<Entry> mNewEntries;
+
+    void load();
+
+    static int CompareEntries(const void *a, const void *b);
+
+    ScanState(const ScanState &);
+    ScanState &operator=(const ScanState &);
+};
+
+MediaScanner::ScanState::ScanState(const char *stateFile, const char *root)
+    : mStateFile(stateFile),
+      mRoot(root) {
+    load();
+}
+
+void MediaScanner::ScanState::load() {
+    FILE *file = fopen(mStateFile.string(), "r");
+    if (file == NULL) {
+        ALOGV("no scan state in '%s', rescanning everything",
+              mStateFile.string());
+        return;
+    }
+
+    char *line = (char *)malloc(PATH_MAX + 64);
+    if (line == NULL) {
+        fclose(file);
+        return;
+    }
+
+    while (fgets(line, PATH_MAX + 64, file) != NULL) {
+        size_t length = strlen(line);
+        if (length == 0 || line[length - 1] != '\n') {
+            break;
+        }
+        line[length - 1] = '\0';
+
+        Entry entry;
+        int noMedia;
+        int pathOffset;
+        if (sscanf(line, "%lld %lld %d %n",
+                   &entry.mLastModified, &entry.mFileSize, &noMedia,
+                   &pathOffset) != 3
+                || line[pathOffset] == '\0') {
+            break;
+        }
+
+        entry.mPath.setTo(&line[pathOffset]);
+        entry.mNoMedia = noMedia != 0;
+
+        if (!mOldEntries.isEmpty()
+                && strcmp(mOldEntries.top().mPath.string(),
+                          entry.mPath.string()) >= 0) {
+            break;
+        }
+
+        mOldEntries.push(entry);
+    }
+
+    if (!feof(file)) {
+        ALOGW("scan state in '%s' is corrupt, rescanning everything",
+              mStateFile.string());
+        mOldEntries.clear();
+    }
+
+    free(line);
+    fclose(file);
+}
+
+bool MediaScanner::ScanState::isUnchanged(
+        const char *path, long long lastModified, long long fileSize,
+        bool noMedia) const {
+    ssize_t lo = 0;
+    ssize_t hi = (ssize_t)mOldEntries.size() - 1;
+
+    while (lo <= hi) {
+        ssize_t mid = lo + (hi - lo) / 2;
+        const Entry &entry = mOldEntries.itemAt(mid);
+
+        int res = strcmp(entry.mPath.string(), path);
+        if (res < 0) {
+            lo = mid + 1;
+        } else if (res > 0) {
+            hi = mid - 1;
+        } else {
+            return entry.mLastModified == lastModified
+                && entry.mFileSize == fileSize
+                && entry.mNoMedia == noMedia;
+        }
+    }
+
+    return false;
+}
+
+void MediaScanner::ScanState::record(
+        const char *path, long long lastModified, long long fileSize,
+        bool noMedia) {
+    if (strchr(path, '\n') != NULL) {
+        // Can't be stored, such files are always rescanned.
+        return;
+    }
+
+    Entry entry;
+    entry.mPath.setTo(path);
+    entry.mLastModified = lastModified;
+    entry.mFileSize = fileSize;
+    entry.mNoMedia = noMedia;
+
+    mNewEntries.push(entry);
+}
+
+// static
+int MediaScanner::ScanState::CompareEntries(const void *a, const void *b) {
+    const Entry *entryA = *(const Entry * const *)a;
+    const Entry *entryB = *(const Entry * const *)b;
+
+    return strcmp(entryA->mPath.string(), entryB->mPath.string());
+}
+
+status_t MediaScanner::ScanState::save() {
+    // Vector::sort() is an insertion sort, far too slow for the number
+    // of files on a large volume, so sort pointers with qsort() instead.
+    Vector<const Entry *> entries;
+    entries.setCapacity(mOldEntries.size() + mNewEntries.size());
+
+    for (size_t i = 0; i < mOldEntries.size(); ++i) {
+        const Entry &entry = mOldEntries.itemAt(i);
+        if (strncmp(entry.mPath.string(), mRoot.string(), mRoot.length())) {
+            entries.push(&entry);
+        }
+    }
+
+    for (size_t i = 0; i < mNewEntries.size(); ++i) {
+        entries.push(&mNewEntries.itemAt(i));
+    }
+
+    qsort(entries.editArray(), entries.size(), sizeof(const Entry *),
+          CompareEntries);
+
+    String8 tmpFile(mStateFile);
+    tmpFile.append(".tmp");
+
+    FILE *file = fopen(tmpFile.string(), "w");
+    if (file == NULL) {
+        ALOGW("unable to write scan state to '%s': %s",
+              tmpFile.string(), strerror(errno));
+        return -errno;
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry *entry = entries[i];
+        fprintf(file, "%lld %lld %d %s\n",
+                entry->mLastModified, entry->mFileSize,
+                entry->mNoMedia ? 1 : 0, entry->mPath.string());
+    }
+
+    bool failed = ferror(file) != 0;
+    if (fclose(file) != 0) {
+        failed = true;
+    }
+
+    if (failed || rename(tmpFile.string(), mStateFile.string()) != 0) {
+        ALOGW("unable to write scan state to '%s'", mStateFile.string());
+        unlink(tmpFile.string());
+        return UNKNOWN_ERROR;
+    }
+
+    return OK;
+}
+
+// Walks a directory tree on a set of walker threads. The walkers queue up
+// the entries to report in a bounded queue that the thread calling run()
+// drains, so that a slow client throttles the walkers rather than letting
+// the queue grow with the size of the volume.
+struct MediaScanner::ParallelWalk {
+    ParallelWalk(
+            MediaScanner *scanner, const char *root, bool noMedia,
+            size_t numThreads);
+
+    ~ParallelWalk();
+
+    MediaScanResult run(MediaScannerClient &client);
+
+private:
+    enum {
+        kMaxQueuedEntries = 256,
+    };
+
+    struct Directory {
+        String8 mPath;
+        bool mNoMedia;
+    };
+
+    struct Entry {
+        String8 mPath;
+        long long mLastModified;
+        long long mFileSize;
+        bool mIsDirectory;
+        bool mNoMedia;
+        bool mUnchanged;
+    };
+
+    struct Walker : public Thread {
+        Walker(ParallelWalk *walk)
+            : Thread(false /* canCallJava */),
+              mWalk(walk) {
+        }
+
+    protected:
+        virtual bool threadLoop() {
+            mWalk->walk();
+            return false;
+        }
+
+    private:
+        ParallelWalk *mWalk;
+
+        Walker(const Walker &);
+        Walker &operator=(const Walker &);
+    };
+
+    MediaScanner *mScanner;
+    size_t mNumThreads;
+    bool mSkipUnchanged;
+
+    Mutex mLock;
+    Condition mWorkAvailable;
+    Condition mEntriesAvailable;
+    Condition mSpaceAvailable;
+
+    List<Directory> mDirectories;
+    List<Entry> mEntries;
+    size_t mNumQueuedEntries;
+    size_t mNumBusyWalkers;
+    bool mAborted;
+
+    Vector<sp<Walker> > mWalkers;
+
+    bool isDone_l() const {
+        return mDirectories.empty() && mNumBusyWalkers == 0;
+    }
+
+    void walk();
+    void walkDirectory(char *path, bool noMedia);
+
+    bool post(
+            const char *path, const struct stat &statbuf, bool isDirectory,
+            bool noMedia, bool unchanged, bool report);
+
+    ParallelWalk(const ParallelWalk &);
+    ParallelWalk &operator=(const ParallelWalk &);
+};
+
+MediaScanner::ParallelWalk::ParallelWalk(
+        MediaScanner *scanner, const char *root, bool noMedia,
+        size_t numThreads)
+    : mScanner(scanner),
+      mNumThreads(numThreads),
+      mSkipUnchanged(false),
+      mNumQueuedEntries(0),
+      mNumBusyWalkers(0),
+      mAborted(false) {
+    Directory dir;
+    dir.mPath.setTo(root);
+    dir.mNoMedia = noMedia;
+    mDirectories.push_back(dir);
+}
+
+MediaScanner::ParallelWalk::~ParallelWalk() {
+    for (size_t i = 0; i < mWalkers.size(); ++i) {
+        mWalkers[i]->requestExitAndWait();
+    }
+    mWalkers.clear();
+}
+
+MediaScanResult MediaScanner::ParallelWalk::run(MediaScannerClient &client) {
+    // Asked once here, the walkers must not call into the client.
+    mSkipUnchanged = client.skipUnchangedFiles();
+
+    for (size_t i = 0; i < mNumThreads; ++i) {
+        sp<Walker> walker = new Walker(this);
+        if (walker->run("MediaScannerWalker") != OK) {
+            break;
+        }
+        mWalkers.push(walker);
+    }
+
+    if (mWalkers.isEmpty()) {
+        return MEDIA_SCAN_RESULT_ERROR;
+    }
+
+    MediaScanResult result = MEDIA_SCAN_RESULT_OK;
+
+    Mutex::Autolock autoLock(mLock);
+    for (;;) {
+        while (mNumQueuedEntries == 0 && !isDone_l() && !mAborted) {
+            mEntriesAvailable.wait(mLock);
+        }
+
+        if (mAborted) {
+            result = MEDIA_SCAN_RESULT_ERROR;
+            break;
+        }
+
+        if (mNumQueuedEntries == 0) {
+            break;
+        }
+
+        Entry entry = *mEntries.begin();
+        mEntries.erase(mEntries.begin());
+        --mNumQueuedEntries;
+        mSpaceAvailable.signal();
+
+        mLock.unlock();
+        status_t status = client.scanFile(
+                entry.mPath.string(), entry.mLastModified, entry.mFileSize,
+                entry.mIsDirectory, entry.mNoMedia, entry.mUnchanged);
+        mLock.lock();
+
+        if (status) {
+            result = MEDIA_SCAN_RESULT_ERROR;
+            mAborted = true;
+            mWorkAvailable.broadcast();
+            mSpaceAvailable.broadcast();
+            break;
+        }
+    }
+
+    return result;
+}
+
+void MediaScanner::ParallelWalk::walk() {
+    char *path = (char *)malloc(PATH_MAX + 1);
+
+    Mutex::Autolock autoLock(mLock);
+    if (path == NULL) {
+        mAborted = true;
+        mWorkAvailable.broadcast();
+        mEntriesAvailable.signal();
+        return;
+    }
+
+    for (;;) {
+        while (mDirectories.empty() && !isDone_l() && !mAborted) {
+            mWorkAvailable.wait(mLock);
+        }
+
+        if (mAborted || isDone_l()) {
+            break;
+        }
+
+        Directory dir = *mDirectories.begin();
+        mDirectories.erase(mDirectories.begin());
+        ++mNumBusyWalkers;
+
+        mLock.unlock();
+        strcpy(path, dir.mPath.string());
+        walkDirectory(path, dir.mNoMedia);
+        mLock.lock();
+
+        if (--mNumBusyWalkers == 0 && mDirectories.empty()) {
+            mWorkAvailable.broadcast();
+            mEntriesAvailable.signal();
+        }
+    }
+
+    free(path);
+}
+
+void MediaScanner::ParallelWalk::walkDirectory(char *path, bool noMedia) {
+    int pathRemaining = PATH_MAX - strlen(path);
+    char *fileSpot = path + strlen(path);
+
+    if (mScanner->shouldSkipDirectory(path)) {
+        ALOGD("Skipping: %s", path);
+        return;
+    }
+
+    if (mScanner->checkDirectory(path, pathRemaining, &noMedia)
+            != MEDIA_SCAN_RESULT_OK) {
+        return;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        ALOGW("Error opening directory '%s', skipping: %s.", path, strerror(errno));
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        const char *name = entry->d_name;
+
+        // ignore "." and ".."
+        if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+            continue;
+        }
+
+        int nameLength = strlen(name);
+        if (nameLength + 1 > pathRemaining) {
+            // path too long!
+            continue;
+        }
+        strcpy(fileSpot, name);
+
+        struct stat statbuf;
+        bool ok = true;
+        int type = mScanner->getEntryType(path, entry);
+        if (type == DT_DIR) {
+            // set noMedia flag on directories with a name that starts with '.'
+            bool childNoMedia = noMedia || name[0] == '.';
+            bool report = stat(path, &statbuf) == 0;
+
+            ok = post(path, statbuf, true /* isDirectory */, childNoMedia,
+                      false /* unchanged */, report);
+        } else if (type == DT_REG && stat(path, &statbuf) == 0) {
+            bool unchanged = mScanner->mScanState != NULL
+                && mScanner->mScanState->isUnchanged(
+                        path, statbuf.st_mtime, statbuf.st_size, noMedia);
+
+            ok = post(path, statbuf, false /* isDirectory */, noMedia,
+                      unchanged, !(unchanged && mSkipUnchanged));
+        }
+
+        if (!ok) {
+            break;
+        }
+    }
+    closedir(dir);
+
+    // restore path
+    fileSpot[0] = 0;
+}
+
+bool MediaScanner::ParallelWalk::post(
+        const char *path, const struct stat &statbuf, bool isDirectory,
+        bool noMedia, bool unchanged, bool report) {
+    Mutex::Autolock autoLock(mLock);
+
+    if (report) {
+        while (mNumQueuedEntries >= kMaxQueuedEntries && !mAborted) {
+            mSpaceAvailable.wait(mLock);
+        }
+    }
+
+    if (mAborted) {
+        return false;
+    }
+
+    if (!isDirectory && mScanner->mScanState != NULL) {
+        mScanner->mScanState->record(
+                path, statbuf.st_mtime, statbuf.st_size, noMedia);
+    }
+
+    // Queue the directory itself before walking it so that it is always
+    // reported ahead of its contents.
+    if (report) {
+        Entry entry;
+        entry.mPath.setTo(path);
+        entry.mLastModified = statbuf.st_mtime;
+        entry.mFileSize = isDirectory ? 0 : statbuf.st_size;
+        entry.mIsDirectory = isDirectory;
+        entry.mNoMedia = noMedia;
+        entry.mUnchanged = unchanged;
+
+        mEntries.push_back(entry);
+        ++mNumQueuedEntries;
+        mEntriesAvailable.signal();
+    }
+
+    if (isDirectory) {
+        Directory dir;
+        dir.mPath.setTo(path);
+        dir.mPath.append("/");
+        dir.mNoMedia = noMedia;
+
+        mDirectories.push_back(dir);
+        mWorkAvailable.signal();
+    }
+
+    return true;
+}
+
 MediaScanner::MediaScanner()
-    : mLocale(NULL), mSkipList(NULL), mSkipIndex(NULL) {
+    : mLocale(NULL),
+      mSkipList(NULL),
+      mSkipIndex(NULL),
+      mNumThreads(1),
+      mScanStateFile(NULL),
+      mScanState(NULL) {
     loadSkipList();
+    loadScanOptions();
 }
 
 MediaScanner::~MediaScanner() {
     setLocale(NULL);
+    setScanStateFile(NULL);
     free(mSkipList);
     free(mSkipIndex);
 }
 
+void MediaScanner::setNumThreads(size_t numThreads) {
+    mNumThreads = numThreads > 0 ? numThreads : 1;
+}
+
+void MediaScanner::setScanStateFile(const char *path) {
+    if (mScanStateFile) {
+        free(mScanStateFile);
+        mScanStateFile = NULL;
+    }
+    if (path) {
+        mScanStateFile = strdup(path);
+    }
+}
+
 void MediaScanner::setLocale(const char *locale) {
     if (mLocale) {
         free(mLocale);
@@ -51,6 +593,22 @@ const char *MediaScanner::locale() const {
     return mLocale;
 }
 
+void MediaScanner::loadScanOptions() {
+    char value[PROPERTY_VALUE_MAX];
+
+    if (property_get("media.scanner.threads", value, NULL) > 0) {
+        char *end;
+        long numThreads = strtol(value, &end, 10);
+        if (*end == '\0' && numThreads > 0) {
+            setNumThreads(numThreads);
+        }
+    }
+
+    if (property_get("media.scanner.state_file", value, NULL) > 0) {
+        setScanStateFile(value);
+    }
+}
+
 void MediaScanner::loadSkipList() {
     mSkipList = (char *)malloc(PROPERTY_VALUE_MAX * sizeof(char));
     if (mSkipList) {
@@ -99,7 +657,34 @@ MediaScanResult MediaScanner::processDirectory(
 
     client.setLocale(locale());
 
-    MediaScanResult result = doProcessDirectory(pathBuffer, pathRemaining, client, false);
+    if (mScanStateFile) {
+        mScanState = new ScanState(mScanStateFile, pathBuffer);
+    }
+
+    MediaScanResult result;
+    if (mNumThreads > 1) {
+        bool noMedia = false;
+        if (shouldSkipDirectory(pathBuffer)) {
+            ALOGD("Skipping: %s", pathBuffer);
+            result = MEDIA_SCAN_RESULT_OK;
+        } else {
+            result = checkDirectory(pathBuffer, pathRemaining, &noMedia);
+            if (result == MEDIA_SCAN_RESULT_OK) {
+                ParallelWalk walk(this, pathBuffer, noMedia, mNumThreads);
+                result = walk.run(client);
+            }
+        }
+    } else {
+        result = doProcessDirectory(pathBuffer, pathRemaining, client, false);
+    }
+
+    if (mScanState) {
+        if (result != MEDIA_SCAN_RESULT_ERROR) {
+            mScanState->save();
+        }
+        delete mScanState;
+        mScanState = NULL;
+    }
 
     free(pathBuffer);
 
@@ -128,16 +713,10 @@ bool MediaScanner::shouldSkipDirectory(char *path) {
     return false;
 }
 
-MediaScanResult MediaScanner::doProcessDirectory(
-        char *path, int pathRemaining, MediaScannerClient &client, bool noMedia) {
+MediaScanResult MediaScanner::checkDirectory(
+        char *path, int pathRemaining, bool *noMedia) {
     // place to copy file or directory name
     char* fileSpot = path + strlen(path);
-    struct dirent* entry;
-
-    if (shouldSkipDirectory(path)) {
-        ALOGD("Skipping: %s", path);
-        return MEDIA_SCAN_RESULT_OK;
-    }
 
     // Completely skip all directories containing a ".noscanandnomtp" file
     if (pathRemaining >= 15 /* strlen(".noscanandnomtp") */ ) {
@@ -156,20 +735,58 @@ MediaScanResult MediaScanner::doProcessDirectory(
         strcpy(fileSpot, ".nomedia");
         if (access(path, F_OK) == 0) {
             ALOGV("found .nomedia, setting noMedia flag");
-            noMedia = true;
+            *noMedia = true;
         }
 
         // restore path
         fileSpot[0] = 0;
     }
 
+    return MEDIA_SCAN_RESULT_OK;
+}
+
+int MediaScanner::getEntryType(char *path, struct dirent *entry) {
+    int type = entry->d_type;
+    if (type == DT_UNKNOWN) {
+        // If the type is unknown, stat() the file instead.
+        // This is sometimes necessary when accessing NFS mounted filesystems, but
+        // could be needed in other cases well.
+        struct stat statbuf;
+        if (stat(path, &statbuf) == 0) {
+            if (S_ISREG(statbuf.st_mode)) {
+                type = DT_REG;
+            } else if (S_ISDIR(statbuf.st_mode)) {
+                type = DT_DIR;
+            }
+        } else {
+            ALOGD("stat() failed for %s: %s", path, strerror(errno) );
+        }
+    }
+    return type;
+}
+
+MediaScanResult MediaScanner::doProcessDirectory(
+        char *path, int pathRemaining, MediaScannerClient &client, bool noMedia) {
+    // place to copy file or directory name
+    char* fileSpot = path + strlen(path);
+    struct dirent* entry;
+
+    if (shouldSkipDirectory(path)) {
+        ALOGD("Skipping: %s", path);
+        return MEDIA_SCAN_RESULT_OK;
+    }
+
+    MediaScanResult result = checkDirectory(path, pathRemaining, &noMedia);
+    if (result != MEDIA_SCAN_RESULT_OK) {
+        return result;
+    }
+
     DIR* dir = opendir(path);
     if (!dir) {
         ALOGW("Error opening directory '%s', skipping: %s.", path, strerror(errno));
         return MEDIA_SCAN_RESULT_SKIPPED;
     }
 
-    MediaScanResult result = MEDIA_SCAN_RESULT_OK;
     while ((entry = readdir(dir))) {
         if (doProcessDirectoryEntry(path, pathRemaining, client, noMedia, entry, fileSpot)
                 == MEDIA_SCAN_RESULT_ERROR) {
@@ -199,21 +816,7 @@ MediaScanResult MediaScanner::doProcessDirectoryEntry(
     }
     strcpy(fileSpot, name);
 
-    int type = entry->d_type;
-    if (type == DT_UNKNOWN) {
-        // If the type is unknown, stat() the file instead.
-        // This is sometimes necessary when accessing NFS mounted filesystems, but
-        // could be needed in other cases well.
-        if (stat(path, &statbuf) == 0) {
-            if (S_ISREG(statbuf.st_mode)) {
-                type = DT_REG;
-            } else if (S_ISDIR(statbuf.st_mode)) {
-                type = DT_DIR;
-            }
-        } else {
-            ALOGD("stat() failed for %s: %s", path, strerror(errno) );
-        }
-    }
+    int type = getEntryType(path, entry);
     if (type == DT_DIR) {
         bool childNoMedia = noMedia;
         // set noMedia flag on directories with a name that starts with '.'
@@ -224,7 +827,7 @@ MediaScanResult MediaScanner::doProcessDirectoryEntry(
         // report the directory to the client
         if (stat(path, &statbuf) == 0) {
             status_t status = client.scanFile(path, statbuf.st_mtime, 0,
-                    true /*isDirectory*/, childNoMedia);
+                    true /*isDirectory*/, childNoMedia, false /*unchanged*/);
             if (status) {
                 return MEDIA_SCAN_RESULT_ERROR;
             }
@@ -239,8 +842,20 @@ MediaScanResult MediaScanner::doProcessDirectoryEntry(
         }
     } else if (type == DT_REG) {
         stat(path, &statbuf);
+        bool unchanged = false;
+        if (mScanState) {
+            unchanged = mScanState->isUnchanged(
+                    path, statbuf.st_mtime, statbuf.st_size, noMedia);
+            mScanState->record(
+                    path, statbuf.st_mtime, statbuf.st_size, noMedia);
+        }
+
+        if (unchanged && client.skipUnchangedFiles()) {
+            return MEDIA_SCAN_RESULT_OK;
+        }
+
         status_t status = client.scanFile(path, statbuf.st_mtime, statbuf.st_size,
-                false /*isDirectory*/, noMedia);
+                false /*isDirectory*/, noMedia, unchanged);
         if (status) {
             return MEDIA_SCAN_RESULT_ERROR;
         }
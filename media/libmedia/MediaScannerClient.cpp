@@ -56,6 +56,12 @@ void MediaScannerClient::setLocale(const char* locale)
     }
 }
 
+status_t MediaScannerClient::scanFile(const char* path, long long lastModified,
+        long long fileSize, bool isDirectory, bool noMedia, bool /* unchanged */)
+{
+    return scanFile(path, lastModified, fileSize, isDirectory, noMedia);
+}
+
 void MediaScannerClient::beginFile()
 {
     mNames = new StringArray;
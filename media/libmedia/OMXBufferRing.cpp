@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "OMXBufferRing"
+#include <utils/Log.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <binder/MemoryBase.h>
+#include <binder/MemoryHeapBase.h>
+#include <cutils/atomic.h>
+#include <media/OMXBufferRing.h>
+
+namespace android {
+
+// The indices only ever grow; an entry lives at index & (size - 1).
+struct OMXBufferRing::Queue {
+    volatile int32_t mReadIndex;
+    volatile int32_t mWriteIndex;
+};
+
+struct OMXBufferRing::Shared {
+    Queue mRequestQueue;
+    Request mRequests[kNumRequests];
+
+    Queue mMessageQueue;
+    omx_message mMessages[kNumMessages];
+};
+
+template<typename T, size_t N>
+static bool push(volatile int32_t *readIndex, volatile int32_t *writeIndex,
+        T (&entries)[N], const T &entry) {
+    int32_t rear = *writeIndex;
+    int32_t front = android_atomic_acquire_load(readIndex);
+    if ((uint32_t)(rear - front) >= N) {
+        return false;
+    }
+
+    memcpy(&entries[rear & (N - 1)], &entry, sizeof(T));
+    android_atomic_release_store(rear + 1, writeIndex);
+
+    return true;
+}
+
+template<typename T, size_t N>
+static bool pop(volatile int32_t *readIndex, volatile int32_t *writeIndex,
+        T (&entries)[N], T *entry) {
+    int32_t front = *readIndex;
+    int32_t rear = android_atomic_acquire_load(writeIndex);
+    if (rear == front) {
+        return false;
+    }
+
+    // The other process can write anything here; the entry is copied out
+    // before it is looked at.
+    if ((uint32_t)(rear - front) > N) {
+        ALOGE("queue indices %d/%d are corrupt", front, rear);
+        return false;
+    }
+
+    memcpy(entry, &entries[front & (N - 1)], sizeof(T));
+    android_atomic_release_store(front + 1, readIndex);
+
+    return true;
+}
+
+static void signal(int fd) {
+    uint64_t count = 1;
+    ssize_t n;
+    do {
+        n = write(fd, &count, sizeof(count));
+    } while (n < 0 && errno == EINTR);
+
+    if (n != (ssize_t)sizeof(count)) {
+        ALOGE("eventfd write failed: %s", strerror(errno));
+    }
+}
+
+static status_t wait(int fd) {
+    uint64_t count;
+    ssize_t n;
+    do {
+        n = read(fd, &count, sizeof(count));
+    } while (n < 0 && errno == EINTR);
+
+    return n == (ssize_t)sizeof(count) ? OK : -errno;
+}
+
+// static
+sp<OMXBufferRing> OMXBufferRing::Create() {
+    sp<MemoryHeapBase> heap =
+        new MemoryHeapBase(sizeof(Shared), 0, "OMXBufferRing");
+    if (heap->getHeapID() < 0) {
+        return NULL;
+    }
+    memset(heap->getBase(), 0, sizeof(Shared));
+
+    sp<OMXBufferRing> ring = new OMXBufferRing(
+            new MemoryBase(heap, 0, sizeof(Shared)), eventfd(0, 0), eventfd(0, 0));
+
+    return ring->initCheck() == OK ? ring : NULL;
+}
+
+OMXBufferRing::OMXBufferRing(
+        const sp<IMemory> &memory, int requestFd, int messageFd)
+    : mMemory(memory),
+      mShared(NULL),
+      mRequestFd(requestFd),
+      mMessageFd(messageFd) {
+    if (mMemory != NULL && mMemory->pointer() != NULL
+            && mMemory->size() >= sizeof(Shared)) {
+        mShared = (Shared *)mMemory->pointer();
+    }
+}
+
+OMXBufferRing::~OMXBufferRing() {
+    if (mRequestFd >= 0) {
+        close(mRequestFd);
+        mRequestFd = -1;
+    }
+    if (mMessageFd >= 0) {
+        close(mMessageFd);
+        mMessageFd = -1;
+    }
+}
+
+status_t OMXBufferRing::initCheck() const {
+    return (mShared != NULL && mRequestFd >= 0 && mMessageFd >= 0)
+        ? OK : NO_INIT;
+}
+
+bool OMXBufferRing::postRequest(const Request &request) {
+    return push(&mShared->mRequestQueue.mReadIndex,
+                &mShared->mRequestQueue.mWriteIndex,
+                mShared->mRequests, request);
+}
+
+bool OMXBufferRing::postMessage(const omx_message &msg) {
+    return push(&mShared->mMessageQueue.mReadIndex,
+                &mShared->mMessageQueue.mWriteIndex,
+                mShared->mMessages, msg);
+}
+
+bool OMXBufferRing::readRequest(Request *request) {
+    return pop(&mShared->mRequestQueue.mReadIndex,
+               &mShared->mRequestQueue.mWriteIndex,
+               mShared->mRequests, request);
+}
+
+bool OMXBufferRing::readMessage(omx_message *msg) {
+    return pop(&mShared->mMessageQueue.mReadIndex,
+               &mShared->mMessageQueue.mWriteIndex,
+               mShared->mMessages, msg);
+}
+
+void OMXBufferRing::signalRequests() {
+    signal(mRequestFd);
+}
+
+void OMXBufferRing::signalMessages() {
+    signal(mMessageFd);
+}
+
+status_t OMXBufferRing::waitForRequests() {
+    return wait(mRequestFd);
+}
+
+status_t OMXBufferRing::waitForMessages() {
+    return wait(mMessageFd);
+}
+
+}  // namespace android
@@ -126,13 +126,37 @@ status_t MediaMetadataRetriever::setDataSource(int fd, int64_t offset, int64_t l
 
 sp<IMemory> MediaMetadataRetriever::getFrameAtTime(int64_t timeUs, int option)
 {
-    ALOGV("getFrameAtTime: time(%lld us) option(%d)", timeUs, option);
+    return getFrameAtTime(timeUs, option, VideoFrameOptions());
+}
+
+sp<IMemory> MediaMetadataRetriever::getFrameAtTime(
+        int64_t timeUs, int option, const VideoFrameOptions &frameOptions)
+{
+    ALOGV("getFrameAtTime: time(%lld us) option(%d) format(%d) max(%dx%d)",
+            timeUs, option, frameOptions.mFormat,
+            frameOptions.mMaxWidth, frameOptions.mMaxHeight);
     Mutex::Autolock _l(mLock);
     if (mRetriever == 0) {
         ALOGE("retriever is not initialized");
         return NULL;
     }
-    return mRetriever->getFrameAtTime(timeUs, option);
+    return mRetriever->getFrameAtTime(timeUs, option, frameOptions);
+}
+
+status_t MediaMetadataRetriever::getFramesAtTimes(
+        const Vector<int64_t> &timesUs, int option,
+        const VideoFrameOptions &frameOptions,
+        Vector<sp<IMemory> > *frames)
+{
+    ALOGV("getFramesAtTimes: %zu times option(%d) format(%d) max(%dx%d)",
+            timesUs.size(), option, frameOptions.mFormat,
+            frameOptions.mMaxWidth, frameOptions.mMaxHeight);
+    Mutex::Autolock _l(mLock);
+    if (mRetriever == 0) {
+        ALOGE("retriever is not initialized");
+        return INVALID_OPERATION;
+    }
+    return mRetriever->getFramesAtTimes(timesUs, option, frameOptions, frames);
 }
 
 const char* MediaMetadataRetriever::extractMetadata(int keyCode)
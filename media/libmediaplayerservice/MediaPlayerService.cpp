@@ -396,6 +396,9 @@ status_t MediaPlayerService::dump(int fd, const Vector<String16>& args)
             sp<Client> c = mClients[i].promote();
             if (c != 0) c->dump(fd, args);
         }
+        if (mOMX != NULL) {
+            mOMX->asBinder()->dump(fd, args);
+        }
         if (mMediaRecorderClients.size() == 0) {
                 result.append(" No media recorder client\n\n");
         } else {
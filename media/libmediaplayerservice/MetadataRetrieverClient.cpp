@@ -175,7 +175,8 @@ status_t MetadataRetrieverClient::setDataSource(int fd, int64_t offset, int64_t
     return status;
 }
 
-sp<IMemory> MetadataRetrieverClient::getFrameAtTime(int64_t timeUs, int option)
+sp<IMemory> MetadataRetrieverClient::getFrameAtTime(
+        int64_t timeUs, int option, const VideoFrameOptions &frameOptions)
 {
     ALOGV("getFrameAtTime: time(%lld us) option(%d)", timeUs, option);
     Mutex::Autolock lock(mLock);
@@ -184,7 +185,7 @@ sp<IMemory> MetadataRetrieverClient::getFrameAtTime(int64_t timeUs, int option)
         ALOGE("retriever is not initialized");
         return NULL;
     }
-    VideoFrame *frame = mRetriever->getFrameAtTime(timeUs, option);
+    VideoFrame *frame = mRetriever->getFrameAtTime(timeUs, option, frameOptions);
     if (frame == NULL) {
         ALOGE("failed to capture a video frame");
         return NULL;
@@ -216,6 +217,80 @@ sp<IMemory> MetadataRetrieverClient::getFrameAtTime(int64_t timeUs, int option)
     return mThumbnail;
 }
 
+status_t MetadataRetrieverClient::getFramesAtTimes(
+        const Vector<int64_t> &timesUs, int option,
+        const VideoFrameOptions &frameOptions,
+        Vector<sp<IMemory> > *frames)
+{
+    ALOGV("getFramesAtTimes: %zu times option(%d)", timesUs.size(), option);
+    Mutex::Autolock lock(mLock);
+    mFrames.clear();
+    frames->clear();
+    if (mRetriever == NULL) {
+        ALOGE("retriever is not initialized");
+        return INVALID_OPERATION;
+    }
+    Vector<VideoFrame *> decoded;
+    status_t err = mRetriever->getFramesAtTimes(
+            timesUs, option, frameOptions, &decoded);
+    if (err != OK) {
+        ALOGE("failed to capture video frames");
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            delete decoded[i];
+        }
+        return err;
+    }
+
+    // All frames go into one heap, so that the caller maps it only once.
+    Vector<size_t> offsets;
+    size_t heapSize = 0;
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        offsets.push(heapSize);
+        if (decoded[i] != NULL) {
+            size_t size = sizeof(VideoFrame) + decoded[i]->mSize;
+            heapSize += (size + 7) & ~7;
+        }
+    }
+
+    sp<MemoryHeapBase> heap;
+    if (heapSize > 0) {
+        heap = new MemoryHeapBase(heapSize, 0, "MetadataRetrieverClient");
+        if (heap == NULL || heap->getHeapID() < 0) {
+            ALOGE("failed to create MemoryHeapBase of size=%zu", heapSize);
+            err = NO_MEMORY;
+        }
+    }
+
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        VideoFrame *frame = decoded[i];
+        if (frame == NULL || err != OK) {
+            mFrames.push(NULL);
+            delete frame;
+            continue;
+        }
+        size_t size = sizeof(VideoFrame) + frame->mSize;
+        sp<IMemory> memory = new MemoryBase(heap, offsets[i], size);
+        VideoFrame *frameCopy = static_cast<VideoFrame *>(memory->pointer());
+        frameCopy->mWidth = frame->mWidth;
+        frameCopy->mHeight = frame->mHeight;
+        frameCopy->mDisplayWidth = frame->mDisplayWidth;
+        frameCopy->mDisplayHeight = frame->mDisplayHeight;
+        frameCopy->mSize = frame->mSize;
+        frameCopy->mRotationAngle = frame->mRotationAngle;
+        frameCopy->mData = (uint8_t *)frameCopy + sizeof(VideoFrame);
+        memcpy(frameCopy->mData, frame->mData, frame->mSize);
+        delete frame;
+        mFrames.push(memory);
+    }
+
+    if (err != OK) {
+        mFrames.clear();
+        return err;
+    }
+    *frames = mFrames;
+    return OK;
+}
+
 sp<IMemory> MetadataRetrieverClient::extractAlbumArt()
 {
     ALOGV("extractAlbumArt");
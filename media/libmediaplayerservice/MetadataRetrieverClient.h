@@ -46,7 +46,12 @@ public:
             const char *url, const KeyedVector<String8, String8> *headers);
 
     virtual status_t                setDataSource(int fd, int64_t offset, int64_t length);
-    virtual sp<IMemory>             getFrameAtTime(int64_t timeUs, int option);
+    virtual sp<IMemory>             getFrameAtTime(
+            int64_t timeUs, int option, const VideoFrameOptions &frameOptions);
+    virtual status_t                getFramesAtTimes(
+            const Vector<int64_t> &timesUs, int option,
+            const VideoFrameOptions &frameOptions,
+            Vector<sp<IMemory> > *frames);
     virtual sp<IMemory>             extractAlbumArt();
     virtual const char*             extractMetadata(int keyCode);
 
@@ -65,6 +70,7 @@ private:
     // Keep the shared memory copy of album art and capture frame (for thumbnail)
     sp<IMemory>                            mAlbumArt;
     sp<IMemory>                            mThumbnail;
+    Vector<sp<IMemory> >                   mFrames;
 };
 
 }; // namespace android
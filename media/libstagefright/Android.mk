@@ -57,6 +57,7 @@ LOCAL_SRC_FILES:=                         \
         MediaBufferGroup.cpp              \
         MediaCodec.cpp                    \
         MediaCodecList.cpp                \
+        MediaCodecPool.cpp                \
         MediaDefs.cpp                     \
         MediaExtractor.cpp                \
         MediaMuxer.cpp                    \
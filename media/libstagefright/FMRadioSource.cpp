@@ -169,7 +169,7 @@ status_t FMRadioSource::obtainBuffer(Buffer* audioBuffer)
     uint32_t framesReady = mCblk->framesReady();
     if (framesReady == 0) {
         do {
-            result = mCblk->cv.waitRelative(mCblk->lock, milliseconds(kBufferTimeoutMs));
+            result = mCblk->waitServer_l(milliseconds(kBufferTimeoutMs));
             if (CC_UNLIKELY(result != NO_ERROR)) {
                 ALOGE("obtainBuffer timed out (is the CPU pegged?) "
                         "user=%08x, server=%08x", mCblk->user, mCblk->server);
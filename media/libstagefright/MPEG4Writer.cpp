@@ -1063,35 +1063,84 @@ static void StripStartcode(MediaBuffer *buffer) {
     }
 }
 
+// Returns the first 4-byte start code in [data, data + size), or
+// data + size if there is none. Emulation prevention keeps start codes
+// out of the NAL units themselves.
+static const uint8_t *findStartCode(const uint8_t *data, size_t size) {
+    const uint8_t *end = data + size;
+    const uint8_t *ptr = data + 3;
+
+    while (ptr < end) {
+        ptr = (const uint8_t *)memchr(ptr, 0x01, end - ptr);
+        if (ptr == NULL) {
+            break;
+        }
+        if (ptr[-1] == 0x00 && ptr[-2] == 0x00 && ptr[-3] == 0x00) {
+            return ptr - 3;
+        }
+        ++ptr;
+    }
+
+    return end;
+}
+
+// The size of a sample whose NAL units, separated by start codes, are
+// written each with a length of nalLengthSize bytes instead.
+static size_t getLengthPrefixedSampleSize(
+        const uint8_t *data, size_t size, size_t nalLengthSize) {
+    size_t sampleSize = size + nalLengthSize;
+
+    const uint8_t *end = data + size;
+    const uint8_t *next;
+    while ((next = findStartCode(data, end - data)) < end) {
+        sampleSize += nalLengthSize - 4;
+        data = next + 4;
+    }
+
+    return sampleSize;
+}
+
 off64_t MPEG4Writer::addLengthPrefixedSample_l(MediaBuffer *buffer) {
     off64_t old_offset = mOffset;
 
-    size_t length = buffer->range_length();
+    // A sample may hold more than one NAL unit, e.g. the slices of a
+    // picture, separated by start codes.
+    const uint8_t *data =
+        (const uint8_t *)buffer->data() + buffer->range_offset();
+    const uint8_t *end = data + buffer->range_length();
 
-    if (mUse4ByteNalLength) {
-        uint8_t x = length >> 24;
-        ::write(mFd, &x, 1);
-        x = (length >> 16) & 0xff;
-        ::write(mFd, &x, 1);
-        x = (length >> 8) & 0xff;
-        ::write(mFd, &x, 1);
-        x = length & 0xff;
-        ::write(mFd, &x, 1);
+    for (;;) {
+        const uint8_t *next = findStartCode(data, end - data);
+        size_t length = next - data;
 
-        ::write(mFd,
-              (const uint8_t *)buffer->data() + buffer->range_offset(),
-              length);
+        if (mUse4ByteNalLength) {
+            uint8_t x = length >> 24;
+            ::write(mFd, &x, 1);
+            x = (length >> 16) & 0xff;
+            ::write(mFd, &x, 1);
+            x = (length >> 8) & 0xff;
+            ::write(mFd, &x, 1);
+            x = length & 0xff;
+            ::write(mFd, &x, 1);
 
-        mOffset += length + 4;
-    } else {
-        CHECK_LT(length, 65536);
+            ::write(mFd, data, length);
 
-        uint8_t x = length >> 8;
-        ::write(mFd, &x, 1);
-        x = length & 0xff;
-        ::write(mFd, &x, 1);
-        ::write(mFd, (const uint8_t *)buffer->data() + buffer->range_offset(), length);
-        mOffset += length + 2;
+            mOffset += length + 4;
+        } else {
+            CHECK_LT(length, 65536);
+
+            uint8_t x = length >> 8;
+            ::write(mFd, &x, 1);
+            x = length & 0xff;
+            ::write(mFd, &x, 1);
+            ::write(mFd, data, length);
+            mOffset += length + 2;
+        }
+
+        if (next == end) {
+            break;
+        }
+        data = next + 4;
     }
 
     return old_offset;
@@ -2327,11 +2376,10 @@ status_t MPEG4Writer::Track::threadEntry() {
         size_t sampleSize = copy->range_length();
         ALOGV("%s: received 1 frame, length = %u",mIsAudio? "Audio": "Video",sampleSize);
         if (mIsAvc) {
-            if (mOwner->useNalLengthFour()) {
-                sampleSize += 4;
-            } else {
-                sampleSize += 2;
-            }
+            sampleSize = getLengthPrefixedSampleSize(
+                    (const uint8_t *)copy->data() + copy->range_offset(),
+                    copy->range_length(),
+                    mOwner->useNalLengthFour() ? 4 : 2);
         }
 
         // Max file size or duration handling
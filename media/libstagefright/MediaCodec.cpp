@@ -22,6 +22,7 @@
 
 #include "include/SoftwareRenderer.h"
 
+#include <cutils/atomic.h>
 #include <gui/Surface.h>
 #include <media/ICrypto.h>
 #include <media/stagefright/foundation/ABuffer.h>
@@ -74,7 +75,8 @@ MediaCodec::MediaCodec(const sp<ALooper> &looper)
       mDequeueInputReplyID(0),
       mDequeueOutputTimeoutGeneration(0),
       mDequeueOutputReplyID(0),
-      mHaveInputSurface(false) {
+      mHaveInputSurface(false),
+      mIsAsync(0) {
 }
 
 MediaCodec::~MediaCodec() {
@@ -137,6 +139,14 @@ status_t MediaCodec::init(const char *name, bool nameIsType, bool encoder) {
     return PostAndAwaitResponse(msg, &response);
 }
 
+status_t MediaCodec::setCallback(const sp<AMessage> &callback) {
+    sp<AMessage> msg = new AMessage(kWhatSetCallback, id());
+    msg->setMessage("callback", callback);
+
+    sp<AMessage> response;
+    return PostAndAwaitResponse(msg, &response);
+}
+
 status_t MediaCodec::configure(
         const sp<AMessage> &format,
         const sp<Surface> &nativeWindow,
@@ -219,6 +229,14 @@ status_t MediaCodec::queueInputBuffer(
     msg->setSize("size", size);
     msg->setInt64("timeUs", presentationTimeUs);
     msg->setInt32("flags", flags);
+
+    if (android_atomic_acquire_load(&mIsAsync)) {
+        // The caller does not wait, errors are reported by CB_ERROR.
+        msg->setPointer("errorDetailMsg", NULL);
+        msg->post();
+        return OK;
+    }
+
     msg->setPointer("errorDetailMsg", errorDetailMsg);
 
     sp<AMessage> response;
@@ -303,6 +321,11 @@ status_t MediaCodec::renderOutputBufferAndRelease(size_t index) {
     msg->setSize("index", index);
     msg->setInt32("render", true);
 
+    if (android_atomic_acquire_load(&mIsAsync)) {
+        msg->post();
+        return OK;
+    }
+
     sp<AMessage> response;
     return PostAndAwaitResponse(msg, &response);
 }
@@ -311,6 +334,11 @@ status_t MediaCodec::releaseOutputBuffer(size_t index) {
     sp<AMessage> msg = new AMessage(kWhatReleaseOutputBuffer, id());
     msg->setSize("index", index);
 
+    if (android_atomic_acquire_load(&mIsAsync)) {
+        msg->post();
+        return OK;
+    }
+
     sp<AMessage> response;
     return PostAndAwaitResponse(msg, &response);
 }
@@ -411,9 +439,24 @@ void MediaCodec::cancelPendingDequeueOperations() {
     }
 }
 
+static uint32_t BufferFlagsFromOMXFlags(int32_t omxFlags) {
+    uint32_t flags = 0;
+    if (omxFlags & OMX_BUFFERFLAG_SYNCFRAME) {
+        flags |= MediaCodec::BUFFER_FLAG_SYNCFRAME;
+    }
+    if (omxFlags & OMX_BUFFERFLAG_CODECCONFIG) {
+        flags |= MediaCodec::BUFFER_FLAG_CODECCONFIG;
+    }
+    if (omxFlags & OMX_BUFFERFLAG_EOS) {
+        flags |= MediaCodec::BUFFER_FLAG_EOS;
+    }
+
+    return flags;
+}
+
 bool MediaCodec::handleDequeueInputBuffer(uint32_t replyID, bool newRequest) {
     if (mState != STARTED
-            || (mFlags & kFlagStickyError)
+            || (mFlags & (kFlagStickyError | kFlagIsAsync))
             || (newRequest && (mFlags & kFlagDequeueInputPending))) {
         sp<AMessage> response = new AMessage;
         response->setInt32("err", INVALID_OPERATION);
@@ -441,7 +484,7 @@ bool MediaCodec::handleDequeueOutputBuffer(uint32_t replyID, bool newRequest) {
     sp<AMessage> response = new AMessage;
 
     if (mState != STARTED
-            || (mFlags & kFlagStickyError)
+            || (mFlags & (kFlagStickyError | kFlagIsAsync))
             || (newRequest && (mFlags & kFlagDequeueOutputPending))) {
         response->setInt32("err", INVALID_OPERATION);
     } else if (mFlags & kFlagOutputBuffersChanged) {
@@ -473,18 +516,7 @@ bool MediaCodec::handleDequeueOutputBuffer(uint32_t replyID, bool newRequest) {
         int32_t omxFlags;
         CHECK(buffer->meta()->findInt32("omxFlags", &omxFlags));
 
-        uint32_t flags = 0;
-        if (omxFlags & OMX_BUFFERFLAG_SYNCFRAME) {
-            flags |= BUFFER_FLAG_SYNCFRAME;
-        }
-        if (omxFlags & OMX_BUFFERFLAG_CODECCONFIG) {
-            flags |= BUFFER_FLAG_CODECCONFIG;
-        }
-        if (omxFlags & OMX_BUFFERFLAG_EOS) {
-            flags |= BUFFER_FLAG_EOS;
-        }
-
-        response->setInt32("flags", flags);
+        response->setInt32("flags", BufferFlagsFromOMXFlags(omxFlags));
     }
 
     response->postReply(replyID);
@@ -571,6 +603,7 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
 
                             mFlags |= kFlagStickyError;
                             postActivityNotificationIfPossible();
+                            onError(internalError);
 
                             cancelPendingDequeueOperations();
                             break;
@@ -582,6 +615,7 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
 
                             mFlags |= kFlagStickyError;
                             postActivityNotificationIfPossible();
+                            onError(internalError);
                             break;
                         }
                     }
@@ -705,7 +739,13 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
                             // indication that now all buffers are allocated.
                             setState(STARTED);
                             (new AMessage)->postReply(mReplyID);
+
+                            // Input buffers the codec returned while
+                            // starting could not be handed out yet.
+                            onInputBufferAvailable();
                         } else {
+                            // Asynchronous clients learn about this with
+                            // the format change that follows.
                             mFlags |= kFlagOutputBuffersChanged;
                             postActivityNotificationIfPossible();
                         }
@@ -752,8 +792,7 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
                         // format as necessary.
                         mFlags |= kFlagGatherCodecSpecificData;
                     } else {
-                        mFlags |= kFlagOutputFormatChanged;
-                        postActivityNotificationIfPossible();
+                        onOutputFormatChanged();
                     }
                     break;
                 }
@@ -787,13 +826,16 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
 
                             mFlags |= kFlagStickyError;
                             postActivityNotificationIfPossible();
+                            onError(err);
 
                             cancelPendingDequeueOperations();
                         }
                         break;
                     }
 
-                    if (mFlags & kFlagDequeueInputPending) {
+                    if (mFlags & kFlagIsAsync) {
+                        onInputBufferAvailable();
+                    } else if (mFlags & kFlagDequeueInputPending) {
                         CHECK(handleDequeueInputBuffer(mDequeueInputReplyID));
 
                         ++mDequeueInputTimeoutGeneration;
@@ -840,10 +882,12 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
                         }
 
                         mFlags &= ~kFlagGatherCodecSpecificData;
-                        mFlags |= kFlagOutputFormatChanged;
+                        onOutputFormatChanged();
                     }
 
-                    if (mFlags & kFlagDequeueOutputPending) {
+                    if (mFlags & kFlagIsAsync) {
+                        onOutputBufferAvailable();
+                    } else if (mFlags & kFlagDequeueOutputPending) {
                         CHECK(handleDequeueOutputBuffer(mDequeueOutputReplyID));
 
                         ++mDequeueOutputTimeoutGeneration;
@@ -1141,23 +1185,31 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
         }
 
         case kWhatQueueInputBuffer:
+        case kWhatReleaseOutputBuffer:
         {
-            uint32_t replyID;
-            CHECK(msg->senderAwaitsResponse(&replyID));
-
+            status_t err;
             if (mState != STARTED || (mFlags & kFlagStickyError)) {
-                sp<AMessage> response = new AMessage;
-                response->setInt32("err", INVALID_OPERATION);
+                err = INVALID_OPERATION;
+            } else if (msg->what() == kWhatQueueInputBuffer) {
+                err = onQueueInputBuffer(msg);
+            } else {
+                err = onReleaseOutputBuffer(msg);
+            }
 
+            uint32_t replyID;
+            if (msg->senderAwaitsResponse(&replyID)) {
+                sp<AMessage> response = new AMessage;
+                response->setInt32("err", err);
                 response->postReply(replyID);
-                break;
+            } else if (err != OK
+                    && mState == STARTED && !(mFlags & kFlagStickyError)) {
+                // Posted by an asynchronous client. Buffers that arrive
+                // while stopping or flushing are taken back anyway, and a
+                // sticky error has been reported already.
+                size_t index;
+                CHECK(msg->findSize("index", &index));
+                onError(err, index);
             }
-
-            status_t err = onQueueInputBuffer(msg);
-
-            sp<AMessage> response = new AMessage;
-            response->setInt32("err", err);
-            response->postReply(replyID);
             break;
         }
 
@@ -1214,27 +1266,6 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
             break;
         }
 
-        case kWhatReleaseOutputBuffer:
-        {
-            uint32_t replyID;
-            CHECK(msg->senderAwaitsResponse(&replyID));
-
-            if (mState != STARTED || (mFlags & kFlagStickyError)) {
-                sp<AMessage> response = new AMessage;
-                response->setInt32("err", INVALID_OPERATION);
-
-                response->postReply(replyID);
-                break;
-            }
-
-            status_t err = onReleaseOutputBuffer(msg);
-
-            sp<AMessage> response = new AMessage;
-            response->setInt32("err", err);
-            response->postReply(replyID);
-            break;
-        }
-
         case kWhatSignalEndOfInputStream:
         {
             uint32_t replyID;
@@ -1363,6 +1394,36 @@ void MediaCodec::onMessageReceived(const sp<AMessage> &msg) {
             break;
         }
 
+        case kWhatSetCallback:
+        {
+            uint32_t replyID;
+            CHECK(msg->senderAwaitsResponse(&replyID));
+
+            if (mState != INITIALIZED) {
+                sp<AMessage> response = new AMessage;
+                response->setInt32("err", INVALID_OPERATION);
+
+                response->postReply(replyID);
+                break;
+            }
+
+            sp<AMessage> callback;
+            CHECK(msg->findMessage("callback", &callback));
+
+            mCallback = callback;
+
+            if (mCallback != NULL) {
+                mFlags |= kFlagIsAsync;
+                android_atomic_release_store(1, &mIsAsync);
+            } else {
+                mFlags &= ~kFlagIsAsync;
+                android_atomic_release_store(0, &mIsAsync);
+            }
+
+            (new AMessage)->postReply(replyID);
+            break;
+        }
+
         case kWhatSetParameters:
         {
             uint32_t replyID;
@@ -1471,6 +1532,10 @@ void MediaCodec::setState(State newState) {
         // but should definitely be back up should we try to instantiate
         // another component.. and the cycle continues.
         mFlags &= ~kFlagSawMediaServerDie;
+
+        mFlags &= ~kFlagIsAsync;
+        android_atomic_release_store(0, &mIsAsync);
+        mCallback.clear();
     }
 
     mState = newState;
@@ -1753,6 +1818,78 @@ void MediaCodec::postActivityNotificationIfPossible() {
     }
 }
 
+void MediaCodec::onInputBufferAvailable() {
+    if (!(mFlags & kFlagIsAsync) || mState != STARTED) {
+        return;
+    }
+
+    ssize_t index;
+    while ((index = dequeuePortBuffer(kPortIndexInput)) >= 0) {
+        sp<AMessage> msg = mCallback->dup();
+        msg->setInt32("callbackID", CB_INPUT_AVAILABLE);
+        msg->setSize("index", index);
+        msg->post();
+    }
+}
+
+void MediaCodec::onOutputBufferAvailable() {
+    ssize_t index;
+    while ((index = dequeuePortBuffer(kPortIndexOutput)) >= 0) {
+        const sp<ABuffer> &buffer =
+            mPortBuffers[kPortIndexOutput].itemAt(index).mData;
+
+        int64_t timeUs;
+        CHECK(buffer->meta()->findInt64("timeUs", &timeUs));
+
+        int32_t omxFlags;
+        CHECK(buffer->meta()->findInt32("omxFlags", &omxFlags));
+
+        sp<AMessage> msg = mCallback->dup();
+        msg->setInt32("callbackID", CB_OUTPUT_AVAILABLE);
+        msg->setSize("index", index);
+        msg->setSize("offset", buffer->offset());
+        msg->setSize("size", buffer->size());
+        msg->setInt64("timeUs", timeUs);
+        msg->setInt32("flags", BufferFlagsFromOMXFlags(omxFlags));
+        msg->post();
+    }
+}
+
+void MediaCodec::onOutputFormatChanged() {
+    if (!(mFlags & kFlagIsAsync)) {
+        mFlags |= kFlagOutputFormatChanged;
+        postActivityNotificationIfPossible();
+        return;
+    }
+
+    sp<AMessage> msg = mCallback->dup();
+    msg->setInt32("callbackID", CB_OUTPUT_FORMAT_CHANGED);
+    msg->setMessage("format", mOutputFormat);
+
+    if (mFlags & kFlagOutputBuffersChanged) {
+        msg->setInt32("buffers-changed", true);
+        mFlags &= ~kFlagOutputBuffersChanged;
+    }
+
+    msg->post();
+}
+
+void MediaCodec::onError(status_t err, ssize_t index) {
+    if (!(mFlags & kFlagIsAsync)) {
+        return;
+    }
+
+    sp<AMessage> msg = mCallback->dup();
+    msg->setInt32("callbackID", CB_ERROR);
+    msg->setInt32("err", err);
+
+    if (index >= 0) {
+        msg->setSize("index", index);
+    }
+
+    msg->post();
+}
+
 status_t MediaCodec::setParameters(const sp<AMessage> &params) {
     sp<AMessage> msg = new AMessage(kWhatSetParameters, id());
     msg->setMessage("params", params);
@@ -21,6 +21,7 @@
 
 #include <media/stagefright/MediaCodecList.h>
 
+#include <binder/Parcel.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/MediaErrors.h>
 #include <media/stagefright/OMXClient.h>
@@ -30,10 +31,95 @@
 #include <libexpat/expat.h>
 #include "include/QCUtils.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace android {
 
 static Mutex sInitMutex;
 
+static const char *kCodecsXmlFile = "/etc/media_codecs.xml";
+
+// The parsed configuration and the capabilities queried so far, so that
+// neither the xml file nor the components have to be looked at again.
+static const char *kCacheFile = "/data/misc/media/media_codecs.cache";
+static const int32_t kCacheMagic = 0x4d434c63;  // "MCLc"
+static const int32_t kCacheVersion = 1;
+static const off_t kMaxCacheSize = 1024 * 1024;
+
+// The cache is stale once the xml file or any of these changed, or the
+// build did. The software components live in /system/lib, whose
+// modification time changes when they are replaced.
+static const char *kCacheStampFiles[] = {
+    "/system/lib",
+    "/system/lib/libstagefright_omx.so",
+    "/system/lib/libstagefrighthw.so",
+    "/system/lib/libsomxcore.so",
+};
+
+static const size_t kNumCacheStampFiles =
+    sizeof(kCacheStampFiles) / sizeof(kCacheStampFiles[0]);
+
+static void GetFileStamp(const char *path, int64_t *mtime, int64_t *size) {
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        *mtime = st.st_mtime;
+        *size = st.st_size;
+    } else {
+        *mtime = -1;
+        *size = -1;
+    }
+}
+
+static void WriteFileStamp(Parcel *parcel, const char *path) {
+    int64_t mtime, size;
+    GetFileStamp(path, &mtime, &size);
+    parcel->writeInt64(mtime);
+    parcel->writeInt64(size);
+}
+
+static bool FileStampMatches(const Parcel &parcel, const char *path) {
+    int64_t mtime, size;
+    GetFileStamp(path, &mtime, &size);
+    return parcel.readInt64() == mtime && parcel.readInt64() == size;
+}
+
+static void WriteCacheStamp(Parcel *parcel, const char *codecsXmlFile) {
+    char fingerprint[PROPERTY_VALUE_MAX];
+    property_get("ro.build.fingerprint", fingerprint, "");
+    parcel->writeCString(fingerprint);
+
+    WriteFileStamp(parcel, codecsXmlFile);
+    for (size_t i = 0; i < kNumCacheStampFiles; ++i) {
+        WriteFileStamp(parcel, kCacheStampFiles[i]);
+    }
+}
+
+// Reads what WriteCacheStamp() wrote and compares it with the current
+// state of the files.
+static bool CacheStampMatches(const Parcel &parcel, const char *codecsXmlFile) {
+    char fingerprint[PROPERTY_VALUE_MAX];
+    property_get("ro.build.fingerprint", fingerprint, "");
+
+    const char *cachedFingerprint = parcel.readCString();
+    if (cachedFingerprint == NULL || strcmp(fingerprint, cachedFingerprint)) {
+        return false;
+    }
+
+    if (!FileStampMatches(parcel, codecsXmlFile)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < kNumCacheStampFiles; ++i) {
+        if (!FileStampMatches(parcel, kCacheStampFiles[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 // static
 MediaCodecList *MediaCodecList::sCodecList;
 
@@ -42,22 +128,43 @@ const MediaCodecList *MediaCodecList::getInstance() {
     Mutex::Autolock autoLock(sInitMutex);
 
     if (sCodecList == NULL) {
-        sCodecList = new MediaCodecList;
+        sCodecList = new MediaCodecList(kCodecsXmlFile, kCacheFile);
     }
 
     return sCodecList->initCheck() == OK ? sCodecList : NULL;
 }
 
-MediaCodecList::MediaCodecList()
-    : mInitCheck(NO_INIT) {
-    FILE *file = fopen("/etc/media_codecs.xml", "r");
+MediaCodecList::MediaCodecList(
+        const char *codecsXmlFile, const char *cacheFile)
+    : mInitCheck(NO_INIT),
+      mCodecsXmlFile(codecsXmlFile),
+      mCacheFile(cacheFile),
+      mNumConfiguredCodecs(0) {
+    if (loadCache() != OK) {
+        mTypes.clear();
+        mCodecQuirks.clear();
+        mCodecInfos.clear();
+        mCaps.clear();
+
+        FILE *file = fopen(mCodecsXmlFile.c_str(), "r");
 
-    if (file == NULL) {
-        ALOGW("unable to open media codecs configuration xml file.");
-        return;
-    }
+        if (file == NULL) {
+            ALOGW("unable to open media codecs configuration xml file.");
+            return;
+        }
+
+        parseXMLFile(file);
+
+        fclose(file);
+        file = NULL;
+
+        mNumConfiguredCodecs = mCodecInfos.size();
 
-    parseXMLFile(file);
+        if (mInitCheck == OK) {
+            Mutex::Autolock autoLock(mCapsLock);
+            saveCache_l();
+        }
+    }
 
     if (mInitCheck == OK) {
         // These are currently still used by the video editing suite.
@@ -99,8 +206,9 @@ MediaCodecList::MediaCodecList()
     }
 #endif
 
-    fclose(file);
-    file = NULL;
+    if (mInitCheck == OK) {
+        buildIndex();
+    }
 }
 
 MediaCodecList::~MediaCodecList() {
@@ -110,6 +218,206 @@ status_t MediaCodecList::initCheck() const {
     return mInitCheck;
 }
 
+status_t MediaCodecList::loadCache() {
+    int fd = open(mCacheFile.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size > kMaxCacheSize) {
+        close(fd);
+        return ERROR_MALFORMED;
+    }
+
+    uint8_t *data = new uint8_t[st.st_size];
+    ssize_t n = read(fd, data, st.st_size);
+    close(fd);
+    fd = -1;
+
+    Parcel parcel;
+    if (n == st.st_size) {
+        parcel.setData(data, n);
+    }
+
+    delete[] data;
+    data = NULL;
+
+    if (parcel.readInt32() != kCacheMagic
+            || parcel.readInt32() != kCacheVersion) {
+        return ERROR_MALFORMED;
+    }
+
+    if (!CacheStampMatches(parcel, mCodecsXmlFile.c_str())) {
+        ALOGI("codec list cache is stale.");
+        return ERROR_MALFORMED;
+    }
+
+    // Type and quirk names along with their bits.
+    KeyedVector<AString, size_t> *names[] = { &mTypes, &mCodecQuirks };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        size_t count = parcel.readInt32();
+        if (count > 32) {
+            return ERROR_MALFORMED;
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            String8 name = parcel.readString8();
+            uint32_t bit = parcel.readInt32();
+            if (bit >= 32) {
+                return ERROR_MALFORMED;
+            }
+
+            names[i]->add(AString(name.string()), bit);
+        }
+    }
+
+    size_t numCodecs = parcel.readInt32();
+    if (numCodecs > parcel.dataAvail()) {
+        return ERROR_MALFORMED;
+    }
+
+    for (size_t i = 0; i < numCodecs; ++i) {
+        CodecInfo info;
+        info.mName = parcel.readString8().string();
+        info.mIsEncoder = parcel.readInt32() != 0;
+        info.mTypes = parcel.readInt32();
+        info.mQuirks = parcel.readInt32();
+        mCodecInfos.push(info);
+    }
+
+    size_t numCaps = parcel.readInt32();
+    if (numCaps > parcel.dataAvail()) {
+        return ERROR_MALFORMED;
+    }
+
+    for (size_t i = 0; i < numCaps; ++i) {
+        AString key = parcel.readString8().string();
+
+        Capabilities caps;
+
+        size_t count = parcel.readInt32();
+        if (count > parcel.dataAvail() / 8) {
+            return ERROR_MALFORMED;
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            ProfileLevel profileLevel;
+            profileLevel.mProfile = parcel.readInt32();
+            profileLevel.mLevel = parcel.readInt32();
+            caps.mProfileLevels.push(profileLevel);
+        }
+
+        count = parcel.readInt32();
+        if (count > parcel.dataAvail() / 4) {
+            return ERROR_MALFORMED;
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            caps.mColorFormats.push(parcel.readInt32());
+        }
+
+        mCaps.add(key, caps);
+    }
+
+    // Catches a truncated file.
+    if (parcel.readInt32() != kCacheMagic) {
+        ALOGW("codec list cache is corrupt.");
+        return ERROR_MALFORMED;
+    }
+
+    mNumConfiguredCodecs = mCodecInfos.size();
+    mInitCheck = OK;
+
+    return OK;
+}
+
+void MediaCodecList::saveCache_l() const {
+    Parcel parcel;
+    parcel.writeInt32(kCacheMagic);
+    parcel.writeInt32(kCacheVersion);
+    WriteCacheStamp(&parcel, mCodecsXmlFile.c_str());
+
+    const KeyedVector<AString, size_t> *names[] = { &mTypes, &mCodecQuirks };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        parcel.writeInt32(names[i]->size());
+        for (size_t j = 0; j < names[i]->size(); ++j) {
+            parcel.writeString8(String8(names[i]->keyAt(j).c_str()));
+            parcel.writeInt32(names[i]->valueAt(j));
+        }
+    }
+
+    parcel.writeInt32(mNumConfiguredCodecs);
+    for (size_t i = 0; i < mNumConfiguredCodecs; ++i) {
+        const CodecInfo &info = mCodecInfos.itemAt(i);
+        parcel.writeString8(String8(info.mName.c_str()));
+        parcel.writeInt32(info.mIsEncoder);
+        parcel.writeInt32(info.mTypes);
+        parcel.writeInt32(info.mQuirks);
+    }
+
+    parcel.writeInt32(mCaps.size());
+    for (size_t i = 0; i < mCaps.size(); ++i) {
+        const Capabilities &caps = mCaps.valueAt(i);
+
+        parcel.writeString8(String8(mCaps.keyAt(i).c_str()));
+
+        parcel.writeInt32(caps.mProfileLevels.size());
+        for (size_t j = 0; j < caps.mProfileLevels.size(); ++j) {
+            parcel.writeInt32(caps.mProfileLevels.itemAt(j).mProfile);
+            parcel.writeInt32(caps.mProfileLevels.itemAt(j).mLevel);
+        }
+
+        parcel.writeInt32(caps.mColorFormats.size());
+        for (size_t j = 0; j < caps.mColorFormats.size(); ++j) {
+            parcel.writeInt32(caps.mColorFormats.itemAt(j));
+        }
+    }
+
+    parcel.writeInt32(kCacheMagic);
+
+    // Other processes may be reading or writing the cache, it is replaced
+    // as a whole. Processes without access to it just don't have one.
+    AString tmpFile = StringPrintf("%s.%d", mCacheFile.c_str(), getpid());
+
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        ALOGV("unable to write codec list cache (%s)", strerror(errno));
+        return;
+    }
+
+    ssize_t n = write(fd, parcel.data(), parcel.dataSize());
+    close(fd);
+    fd = -1;
+
+    if (n != (ssize_t)parcel.dataSize()
+            || rename(tmpFile.c_str(), mCacheFile.c_str()) != 0) {
+        ALOGW("unable to write codec list cache.");
+        unlink(tmpFile.c_str());
+    }
+}
+
+void MediaCodecList::buildIndex() {
+    mCodecsForType.clear();
+    mCodecsForType.insertAt(0, 2 * 32);
+
+    mCodecIndexByName.clear();
+
+    for (size_t i = 0; i < mCodecInfos.size(); ++i) {
+        const CodecInfo &info = mCodecInfos.itemAt(i);
+
+        for (size_t bit = 0; bit < 32; ++bit) {
+            if (info.mTypes & (1ul << bit)) {
+                mCodecsForType.editItemAt(2 * bit + info.mIsEncoder).push(i);
+            }
+        }
+
+        if (mCodecIndexByName.indexOfKey(info.mName) < 0) {
+            mCodecIndexByName.add(info.mName, i);
+        }
+    }
+}
+
 void MediaCodecList::parseXMLFile(FILE *file) {
     mInitCheck = OK;
     mCurrentSection = SECTION_TOPLEVEL;
@@ -432,31 +740,26 @@ ssize_t MediaCodecList::findCodecByType(
         return -ENOENT;
     }
 
-    uint32_t typeMask = 1ul << mTypes.valueAt(typeIndex);
-
-    while (startIndex < mCodecInfos.size()) {
-        const CodecInfo &info = mCodecInfos.itemAt(startIndex);
+    const Vector<size_t> &codecs =
+        mCodecsForType.itemAt(2 * mTypes.valueAt(typeIndex) + encoder);
 
-        if (info.mIsEncoder == encoder && (info.mTypes & typeMask)) {
-            return startIndex;
+    for (size_t i = 0; i < codecs.size(); ++i) {
+        if (codecs.itemAt(i) >= startIndex) {
+            return codecs.itemAt(i);
         }
-
-        ++startIndex;
     }
 
     return -ENOENT;
 }
 
 ssize_t MediaCodecList::findCodecByName(const char *name) const {
-    for (size_t i = 0; i < mCodecInfos.size(); ++i) {
-        const CodecInfo &info = mCodecInfos.itemAt(i);
+    ssize_t index = mCodecIndexByName.indexOfKey(AString(name));
 
-        if (info.mName == name) {
-            return i;
-        }
+    if (index < 0) {
+        return -ENOENT;
     }
 
-    return -ENOENT;
+    return mCodecIndexByName.valueAt(index);
 }
 
 size_t MediaCodecList::countCodecs() const {
@@ -533,6 +836,21 @@ status_t MediaCodecList::getCodecCapabilities(
 
     const CodecInfo &info = mCodecInfos.itemAt(index);
 
+    AString key = StringPrintf("%s/%s", info.mName.c_str(), type);
+
+    {
+        Mutex::Autolock autoLock(mCapsLock);
+
+        ssize_t capsIndex = mCaps.indexOfKey(key);
+        if (capsIndex >= 0) {
+            const Capabilities &caps = mCaps.valueAt(capsIndex);
+            *profileLevels = caps.mProfileLevels;
+            *colorFormats = caps.mColorFormats;
+
+            return OK;
+        }
+    }
+
     OMXClient client;
     status_t err = client.connect();
     if (err != OK) {
@@ -561,6 +879,14 @@ status_t MediaCodecList::getCodecCapabilities(
         colorFormats->push(caps.mColorFormats.itemAt(i));
     }
 
+    Capabilities cached;
+    cached.mProfileLevels = *profileLevels;
+    cached.mColorFormats = *colorFormats;
+
+    Mutex::Autolock autoLock(mCapsLock);
+    mCaps.add(key, cached);
+    saveCache_l();
+
     return OK;
 }
 
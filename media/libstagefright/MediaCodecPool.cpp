@@ -0,0 +1,270 @@
+/*
+ * Copyright 2013, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MediaCodecPool"
+#include <utils/Log.h>
+
+#include <media/stagefright/MediaCodecPool.h>
+
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/MediaCodec.h>
+
+namespace android {
+
+MediaCodecPool::MediaCodecPool(size_t maxIdleCodecs, int64_t idleTimeoutUs)
+    : mMaxIdleCodecs(maxIdleCodecs),
+      mIdleTimeoutUs(idleTimeoutUs),
+      mCheckIdlePending(false) {
+}
+
+MediaCodecPool::~MediaCodecPool() {
+    stop();
+
+    // The codecs handed out keep their loopers.
+    if (mLooper != NULL) {
+        mLooper->unregisterHandler(id());
+        mLooper->stop();
+    }
+}
+
+status_t MediaCodecPool::start() {
+    if (mLooper != NULL) {
+        return INVALID_OPERATION;
+    }
+
+    // The idle codecs are released from here, which must not be the looper
+    // the codecs run on.
+    mLooper = new ALooper;
+    mLooper->setName("MediaCodecPool");
+    status_t err = mLooper->start();
+    if (err != OK) {
+        mLooper.clear();
+        return err;
+    }
+
+    mLooper->registerHandler(this);
+
+    return OK;
+}
+
+void MediaCodecPool::stop() {
+    List<IdleCodec> codecs;
+
+    {
+        Mutex::Autolock autoLock(mLock);
+        codecs = mIdleCodecs;
+        mIdleCodecs.clear();
+    }
+
+    ReleaseCodecs(&codecs);
+}
+
+sp<MediaCodec> MediaCodecPool::acquireByType(const char *mime, bool encoder) {
+    CHECK(mLooper != NULL);
+
+    AString key = StringPrintf("%s/%d", mime, encoder);
+
+    AString componentName;
+    {
+        Mutex::Autolock autoLock(mLock);
+        ssize_t index = mComponentForType.indexOfKey(key);
+        if (index >= 0) {
+            componentName = mComponentForType.valueAt(index);
+        }
+    }
+
+    if (!componentName.empty()) {
+        sp<MediaCodec> codec = takeIdleCodec(componentName);
+        if (codec != NULL) {
+            return codec;
+        }
+    }
+
+    sp<ALooper> looper = NewCodecLooper();
+    if (looper == NULL) {
+        return NULL;
+    }
+
+    sp<MediaCodec> codec = MediaCodec::CreateByType(looper, mime, encoder);
+
+    if (codec != NULL && codec->getName(&componentName) == OK) {
+        Mutex::Autolock autoLock(mLock);
+        mComponentForType.add(key, componentName);
+    }
+
+    return codec;
+}
+
+sp<MediaCodec> MediaCodecPool::acquireByComponentName(const char *name) {
+    CHECK(mLooper != NULL);
+
+    sp<MediaCodec> codec = takeIdleCodec(name);
+    if (codec != NULL) {
+        return codec;
+    }
+
+    sp<ALooper> looper = NewCodecLooper();
+    if (looper == NULL) {
+        return NULL;
+    }
+
+    return MediaCodec::CreateByComponentName(looper, name);
+}
+
+// static
+sp<ALooper> MediaCodecPool::NewCodecLooper() {
+    // The codec holds on to its looper, which stops when the codec is gone.
+    sp<ALooper> looper = new ALooper;
+    looper->setName("MediaCodecPool codec");
+
+    status_t err = looper->start();
+    if (err != OK) {
+        ALOGE("unable to start a codec looper, err %d", err);
+        return NULL;
+    }
+
+    return looper;
+}
+
+void MediaCodecPool::recycle(const sp<MediaCodec> &codec) {
+    IdleCodec idle;
+    idle.mCodec = codec;
+
+    // stop() keeps the component allocated, in the loaded state. The
+    // callback of the last client must not see the next one's buffers.
+    status_t err = codec->getName(&idle.mComponentName);
+    if (err == OK) {
+        err = codec->stop();
+    }
+    if (err == OK) {
+        err = codec->setCallback(NULL);
+    }
+
+    List<IdleCodec> evicted;
+
+    if (err != OK) {
+        ALOGW("not keeping codec '%s', err %d",
+              idle.mComponentName.c_str(), err);
+
+        evicted.push_back(idle);
+    } else {
+        Mutex::Autolock autoLock(mLock);
+
+        while (!mIdleCodecs.empty() && mIdleCodecs.size() >= mMaxIdleCodecs) {
+            evicted.push_back(*mIdleCodecs.begin());
+            mIdleCodecs.erase(mIdleCodecs.begin());
+        }
+
+        if (mMaxIdleCodecs > 0) {
+            idle.mIdleSinceUs = ALooper::GetNowUs();
+            mIdleCodecs.push_back(idle);
+
+            scheduleCheckIdle_l();
+        } else {
+            evicted.push_back(idle);
+        }
+    }
+
+    ReleaseCodecs(&evicted);
+}
+
+size_t MediaCodecPool::countIdleCodecs() const {
+    Mutex::Autolock autoLock(mLock);
+    return mIdleCodecs.size();
+}
+
+sp<MediaCodec> MediaCodecPool::takeIdleCodec(const AString &componentName) {
+    Mutex::Autolock autoLock(mLock);
+
+    // Most recently used first, it is the least likely to be paged out.
+    List<IdleCodec>::iterator it = mIdleCodecs.end();
+    while (it != mIdleCodecs.begin()) {
+        --it;
+
+        if ((*it).mComponentName == componentName) {
+            sp<MediaCodec> codec = (*it).mCodec;
+            mIdleCodecs.erase(it);
+
+            ALOGV("reusing codec '%s'", componentName.c_str());
+            return codec;
+        }
+    }
+
+    return NULL;
+}
+
+void MediaCodecPool::scheduleCheckIdle_l() {
+    if (mCheckIdlePending || mIdleCodecs.empty()) {
+        return;
+    }
+
+    int64_t delayUs = (*mIdleCodecs.begin()).mIdleSinceUs + mIdleTimeoutUs
+        - ALooper::GetNowUs();
+
+    (new AMessage(kWhatCheckIdle, id()))->post(delayUs > 0 ? delayUs : 0);
+    mCheckIdlePending = true;
+}
+
+void MediaCodecPool::onCheckIdle() {
+    List<IdleCodec> expired;
+
+    {
+        Mutex::Autolock autoLock(mLock);
+        mCheckIdlePending = false;
+
+        int64_t nowUs = ALooper::GetNowUs();
+
+        List<IdleCodec>::iterator it = mIdleCodecs.begin();
+        while (it != mIdleCodecs.end()
+                && nowUs - (*it).mIdleSinceUs >= mIdleTimeoutUs) {
+            expired.push_back(*it);
+            it = mIdleCodecs.erase(it);
+        }
+
+        scheduleCheckIdle_l();
+    }
+
+    ReleaseCodecs(&expired);
+}
+
+// static
+void MediaCodecPool::ReleaseCodecs(List<IdleCodec> *codecs) {
+    for (List<IdleCodec>::iterator it = codecs->begin();
+            it != codecs->end(); ++it) {
+        ALOGV("releasing codec '%s'", (*it).mComponentName.c_str());
+        (*it).mCodec->release();
+    }
+
+    codecs->clear();
+}
+
+void MediaCodecPool::onMessageReceived(const sp<AMessage> &msg) {
+    switch (msg->what()) {
+        case kWhatCheckIdle:
+        {
+            onCheckIdle();
+            break;
+        }
+
+        default:
+            TRESPASS();
+    }
+}
+
+}  // namespace android
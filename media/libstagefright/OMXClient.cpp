@@ -113,6 +113,9 @@ struct MuxOMX : public IOMX {
             const char *parameter_name,
             OMX_INDEXTYPE *index);
 
+    virtual status_t setBufferRing(
+            node_id node, const sp<OMXBufferRing> &ring);
+
 private:
     mutable Mutex mLock;
 
@@ -331,6 +334,11 @@ status_t MuxOMX::getExtensionIndex(
     return getOMX(node)->getExtensionIndex(node, parameter_name, index);
 }
 
+status_t MuxOMX::setBufferRing(
+        node_id node, const sp<OMXBufferRing> &ring) {
+    return getOMX(node)->setBufferRing(node, ring);
+}
+
 OMXClient::OMXClient() {
 }
 
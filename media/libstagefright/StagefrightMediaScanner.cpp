@@ -26,14 +26,24 @@
 #include <media/stagefright/StagefrightMediaScanner.h>
 
 #include <media/mediametadataretriever.h>
+#include <media/stagefright/DataSource.h>
+#include <media/stagefright/FileSource.h>
+#include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/MediaExtractor.h>
+#include <media/stagefright/MetaData.h>
 #include <private/media/VideoFrame.h>
+#include <utils/KeyedVector.h>
+#include <utils/String8.h>
 
 // Sonivox includes
 #include <libsonivox/eas.h>
 
 namespace android {
 
-StagefrightMediaScanner::StagefrightMediaScanner() {}
+StagefrightMediaScanner::StagefrightMediaScanner() {
+    // MediaExtractor::Create() finds no container without them.
+    DataSource::RegisterDefaultSniffers();
+}
 
 StagefrightMediaScanner::~StagefrightMediaScanner() {}
 
@@ -60,6 +70,138 @@ static bool FileHasAcceptableExtension(const char *extension) {
     return false;
 }
 
+// Files of these types carry all the tags the scanner reports in their
+// container (ID3, MP4 'udta'/'ilst', Vorbis comments, Matroska segment
+// info), so they are scanned with an in-process extractor rather than a
+// MediaMetadataRetriever round trip through the media server.
+static bool FileHasContainerMetadata(const char *extension) {
+    static const char *kContainerExtensions[] = {
+        ".mp3", ".mpga", ".mp4", ".m4a", ".3gp", ".3gpp", ".3g2", ".3gpp2",
+        ".ogg", ".mkv", ".mka", ".webm", ".flac", ".aac", ".amr", ".awb",
+        ".wav",
+    };
+    static const size_t kNumContainerExtensions =
+        sizeof(kContainerExtensions) / sizeof(kContainerExtensions[0]);
+
+    for (size_t i = 0; i < kNumContainerExtensions; ++i) {
+        if (!strcasecmp(extension, kContainerExtensions[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Collects the same tags as MediaMetadataRetriever would report for the
+// file, using only the extractor's file and track metadata. Returns
+// MEDIA_SCAN_RESULT_SKIPPED without touching the client if the file
+// should go through the retriever instead.
+static MediaScanResult HandleContainerMetadata(
+        const char *path, MediaScannerClient *client) {
+    sp<DataSource> source = new FileSource(path);
+    if (source->initCheck() != OK) {
+        return MEDIA_SCAN_RESULT_SKIPPED;
+    }
+
+    sp<MediaExtractor> extractor = MediaExtractor::Create(source);
+    if (extractor == NULL || extractor->getDrmFlag()) {
+        return MEDIA_SCAN_RESULT_SKIPPED;
+    }
+
+    sp<MetaData> meta = extractor->getMetaData();
+    const char *fileMIME;
+    if (meta == NULL || !meta->findCString(kKeyMIMEType, &fileMIME)) {
+        return MEDIA_SCAN_RESULT_SKIPPED;
+    }
+
+    KeyedVector<String8, String8> tags;
+
+    struct KeyMap {
+        const char *tag;
+        uint32_t key;
+    };
+    static const KeyMap kKeyMap[] = {
+        { "tracknumber", kKeyCDTrackNumber },
+        { "discnumber", kKeyDiscNumber },
+        { "album", kKeyAlbum },
+        { "artist", kKeyArtist },
+        { "albumartist", kKeyAlbumArtist },
+        { "composer", kKeyComposer },
+        { "genre", kKeyGenre },
+        { "title", kKeyTitle },
+        { "year", kKeyYear },
+        { "writer", kKeyWriter },
+        { "compilation", kKeyCompilation },
+    };
+    static const size_t kNumEntries = sizeof(kKeyMap) / sizeof(kKeyMap[0]);
+
+    for (size_t i = 0; i < kNumEntries; ++i) {
+        const char *value;
+        if (meta->findCString(kKeyMap[i].key, &value)) {
+            tags.add(String8(kKeyMap[i].tag), String8(value));
+        }
+    }
+
+    size_t numTracks = extractor->countTracks();
+    bool hasAudio = false;
+    bool hasVideo = false;
+    int64_t maxDurationUs = 0;
+    for (size_t i = 0; i < numTracks; ++i) {
+        sp<MetaData> trackMeta = extractor->getTrackMetaData(i);
+        if (trackMeta == NULL) {
+            continue;
+        }
+
+        int64_t durationUs;
+        if (trackMeta->findInt64(kKeyDuration, &durationUs)
+                && durationUs > maxDurationUs) {
+            maxDurationUs = durationUs;
+        }
+
+        const char *mime;
+        if (!trackMeta->findCString(kKeyMIMEType, &mime)) {
+            continue;
+        }
+
+        if (!strncasecmp("audio/", mime, 6)) {
+            hasAudio = true;
+        } else if (!hasVideo && !strncasecmp("video/", mime, 6)) {
+            int32_t width, height;
+            if (!trackMeta->findInt32(kKeyWidth, &width)
+                    || !trackMeta->findInt32(kKeyHeight, &height)) {
+                return MEDIA_SCAN_RESULT_SKIPPED;
+            }
+            hasVideo = true;
+
+            tags.add(String8("width"), String8::format("%d", width));
+            tags.add(String8("height"), String8::format("%d", height));
+        }
+    }
+
+    tags.add(String8("duration"),
+             String8::format("%lld", (maxDurationUs + 500) / 1000));
+
+    // Same as StagefrightMetadataRetriever, a matroska file holding nothing
+    // but a single audio track is reported as audio.
+    if (numTracks == 1 && hasAudio && !hasVideo
+            && !strcasecmp(fileMIME, MEDIA_MIMETYPE_CONTAINER_MATROSKA)) {
+        fileMIME = "audio/x-matroska";
+    }
+
+    if (client->setMimeType(fileMIME) != OK) {
+        return MEDIA_SCAN_RESULT_ERROR;
+    }
+
+    for (size_t i = 0; i < tags.size(); ++i) {
+        if (client->addStringTag(
+                    tags.keyAt(i).string(), tags.valueAt(i).string()) != OK) {
+            return MEDIA_SCAN_RESULT_ERROR;
+        }
+    }
+
+    return MEDIA_SCAN_RESULT_OK;
+}
+
 static MediaScanResult HandleMIDI(
         const char *filename, MediaScannerClient *client) {
     // get the library configuration and do sanity check
@@ -145,6 +287,18 @@ MediaScanResult StagefrightMediaScanner::processFileInternal(
         return HandleMIDI(path, &client);
     }
 
+    if (FileHasContainerMetadata(extension)) {
+        MediaScanResult result = HandleContainerMetadata(path, &client);
+        if (result != MEDIA_SCAN_RESULT_SKIPPED) {
+            return result;
+        }
+    }
+
+    return processFileWithRetriever(path, client);
+}
+
+MediaScanResult StagefrightMediaScanner::processFileWithRetriever(
+        const char *path, MediaScannerClient &client) {
     sp<MediaMetadataRetriever> mRetriever(new MediaMetadataRetriever);
 
     int fd = open(path, O_RDONLY | O_LARGEFILE);
@@ -20,17 +20,30 @@
 
 #include "include/StagefrightMetadataRetriever.h"
 
+#include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/cpucount.h>
 #include <media/stagefright/ColorConverter.h>
 #include <media/stagefright/DataSource.h>
 #include <media/stagefright/FileSource.h>
+#include <media/stagefright/MediaCodec.h>
+#include <media/stagefright/MediaCodecList.h>
+#include <media/stagefright/MediaCodecPool.h>
+#include <media/stagefright/MediaErrors.h>
 #include <media/stagefright/MediaExtractor.h>
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/OMXCodec.h>
 #include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/Utils.h>
 
 namespace android {
 
+// Frames are extracted while the caller waits for them, so convert on as
+// many cores as a large frame can use.
+static const size_t kMaxConverterThreads = 4;
+
 StagefrightMetadataRetriever::StagefrightMetadataRetriever()
     : mParsedMetaData(false),
       mAlbumArt(NULL) {
@@ -135,13 +148,65 @@ static bool isYUV420PlanarSupported(
     return false;
 }
 
-static VideoFrame *extractVideoFrameWithCodecFlags(
+// Maps the VIDEO_FRAME_FORMAT_* of |frameOptions| to a color converter
+// destination format. Returns false if the format is unknown.
+static bool getDstColorFormat(
+        const VideoFrameOptions &frameOptions, OMX_COLOR_FORMATTYPE *format) {
+    switch (frameOptions.mFormat) {
+        case VIDEO_FRAME_FORMAT_RGB565:
+            *format = OMX_COLOR_Format16bitRGB565;
+            return true;
+        case VIDEO_FRAME_FORMAT_RGBA8888:
+            *format = OMX_COLOR_Format32BitRGBA8888;
+            return true;
+        case VIDEO_FRAME_FORMAT_BGRA8888:
+            *format = OMX_COLOR_Format32bitBGRA8888;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static ColorConverter::ScalingMode getScalingMode(
+        const VideoFrameOptions &frameOptions) {
+    return (frameOptions.mScalingMode == VIDEO_FRAME_SCALING_BILINEAR)
+        ? ColorConverter::kScalingBilinear : ColorConverter::kScalingBox;
+}
+
+// Scales |width| x |height| down to fit into the bounds of |frameOptions|,
+// if any, keeping the aspect ratio.
+static void getScaledFrameSize(
+        const VideoFrameOptions &frameOptions,
+        int32_t *width, int32_t *height) {
+    if (frameOptions.mMaxWidth <= 0 || frameOptions.mMaxHeight <= 0
+            || (*width <= frameOptions.mMaxWidth
+                && *height <= frameOptions.mMaxHeight)) {
+        return;
+    }
+
+    if ((int64_t)*width * frameOptions.mMaxHeight
+            > (int64_t)*height * frameOptions.mMaxWidth) {
+        *height = (int64_t)*height * frameOptions.mMaxWidth / *width;
+        *width = frameOptions.mMaxWidth;
+    } else {
+        *width = (int64_t)*width * frameOptions.mMaxHeight / *height;
+        *height = frameOptions.mMaxHeight;
+    }
+
+    if (*width < 1) {
+        *width = 1;
+    }
+    if (*height < 1) {
+        *height = 1;
+    }
+}
+
+// Instantiates and starts a decoder for |source|, or returns NULL.
+static sp<MediaSource> createVideoDecoder(
         OMXClient *client,
         const sp<MetaData> &trackMeta,
         const sp<MediaSource> &source,
-        uint32_t flags,
-        int64_t frameTimeUs,
-        int seekMode) {
+        uint32_t flags) {
 
     sp<MetaData> format = source->getFormat();
 
@@ -177,80 +242,191 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         return NULL;
     }
 
-    // Read one output buffer, ignore format change notifications
-    // and spurious empty buffers.
-
-    MediaSource::ReadOptions options;
-    if (seekMode < MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC ||
-        seekMode > MediaSource::ReadOptions::SEEK_CLOSEST) {
-
-        ALOGE("Unknown seek mode: %d", seekMode);
-        return NULL;
-    }
-
-    MediaSource::ReadOptions::SeekMode mode =
-            static_cast<MediaSource::ReadOptions::SeekMode>(seekMode);
+    return decoder;
+}
 
-    int64_t thumbNailTime;
-    if (frameTimeUs < 0) {
-        if (!trackMeta->findInt64(kKeyThumbnailTime, &thumbNailTime)
-                || thumbNailTime < 0) {
-            thumbNailTime = 0;
-        }
-        options.setSeekTo(thumbNailTime, mode);
-    } else {
-        thumbNailTime = -1;
-        options.setSeekTo(frameTimeUs, mode);
-    }
+// Reads one output buffer, ignoring format change notifications and
+// spurious empty buffers. The seek in |options|, if any, is consumed.
+static status_t readVideoFrame(
+        const sp<MediaSource> &decoder,
+        MediaSource::ReadOptions *options,
+        MediaBuffer **buffer) {
+    status_t err;
 
-    MediaBuffer *buffer = NULL;
+    *buffer = NULL;
     do {
-        if (buffer != NULL) {
-            buffer->release();
-            buffer = NULL;
+        if (*buffer != NULL) {
+            (*buffer)->release();
+            *buffer = NULL;
         }
-        err = decoder->read(&buffer, &options);
-        options.clearSeekTo();
+        err = decoder->read(buffer, options);
+        options->clearSeekTo();
     } while (err == INFO_FORMAT_CHANGED
-             || (buffer != NULL && buffer->range_length() == 0));
+             || (*buffer != NULL && (*buffer)->range_length() == 0));
 
     if (err != OK) {
-        CHECK(buffer == NULL);
+        CHECK(*buffer == NULL);
 
         ALOGV("decoding frame failed.");
-        decoder->stop();
-
-        return NULL;
+        return err;
     }
 
     ALOGV("successfully decoded video frame.");
 
     int32_t unreadable;
-    if (buffer->meta_data()->findInt32(kKeyIsUnreadable, &unreadable)
+    if ((*buffer)->meta_data()->findInt32(kKeyIsUnreadable, &unreadable)
             && unreadable != 0) {
         ALOGV("video frame is unreadable, decoder does not give us access "
              "to the video data.");
 
-        buffer->release();
-        buffer = NULL;
+        (*buffer)->release();
+        *buffer = NULL;
 
-        decoder->stop();
+        return ERROR_UNSUPPORTED;
+    }
 
-        return NULL;
+    return OK;
+}
+
+// The color converter of one retriever call. The converter and its worker
+// threads are set up for the first frame and reused for the others, the
+// destination format and scaling mode are those of the call.
+struct FrameConverter {
+    FrameConverter(const VideoFrameOptions &frameOptions)
+        : mScalingMode(getScalingMode(frameOptions)),
+          mSrcFormat(OMX_COLOR_FormatUnused),
+          mConverter(NULL) {
+        CHECK(getDstColorFormat(frameOptions, &mDstFormat));
     }
 
-    int64_t timeUs;
-    CHECK(buffer->meta_data()->findInt64(kKeyTime, &timeUs));
-    if (thumbNailTime >= 0) {
-        if (timeUs != thumbNailTime) {
-            const char *mime;
-            CHECK(trackMeta->findCString(kKeyMIMEType, &mime));
+    ~FrameConverter() {
+        delete mConverter;
+        mConverter = NULL;
+    }
 
-            ALOGV("thumbNailTime = %lld us, timeUs = %lld us, mime = %s",
-                 thumbNailTime, timeUs, mime);
+    OMX_COLOR_FORMATTYPE dstFormat() const {
+        return mDstFormat;
+    }
+
+    // Returns the converter from |srcFormat|, or NULL if there is none.
+    // Decoders rarely change their output format between frames, the
+    // converter is only recreated if they do.
+    ColorConverter *get(OMX_COLOR_FORMATTYPE srcFormat) {
+        if (mConverter != NULL && srcFormat == mSrcFormat) {
+            return mConverter->isValid() ? mConverter : NULL;
+        }
+
+        delete mConverter;
+        mConverter = new ColorConverter(srcFormat, mDstFormat);
+        mSrcFormat = srcFormat;
+
+        if (!mConverter->isValid()) {
+            ALOGE("Unable to instantiate color conversion from format "
+                  "0x%08x to 0x%08x",
+                  srcFormat, mDstFormat);
+
+            return NULL;
         }
+
+        mConverter->setScalingMode(mScalingMode);
+
+        size_t numThreads = GetCPUCoreCount();
+        mConverter->setNumThreads(
+                numThreads < kMaxConverterThreads
+                    ? numThreads : kMaxConverterThreads);
+
+        return mConverter;
     }
 
+private:
+    OMX_COLOR_FORMATTYPE mDstFormat;
+    ColorConverter::ScalingMode mScalingMode;
+    OMX_COLOR_FORMATTYPE mSrcFormat;
+    ColorConverter *mConverter;
+
+    DISALLOW_EVIL_CONSTRUCTORS(FrameConverter);
+};
+
+// Color converts the |srcWidth| x |srcHeight| frame at |data|, cropped to
+// the inclusive crop rectangle, with |converter| according to
+// |frameOptions|. The display size, if the decoder gave one (> 0), is that
+// of the cropped frame.
+static VideoFrame *convertVideoFrame(
+        const sp<MetaData> &trackMeta,
+        const uint8_t *data,
+        OMX_COLOR_FORMATTYPE srcFormat,
+        int32_t srcWidth, int32_t srcHeight,
+        int32_t crop_left, int32_t crop_top,
+        int32_t crop_right, int32_t crop_bottom,
+        int32_t displayWidth, int32_t displayHeight,
+        FrameConverter *converter,
+        const VideoFrameOptions &frameOptions) {
+    int32_t rotationAngle;
+    if (!trackMeta->findInt32(kKeyRotation, &rotationAngle)) {
+        rotationAngle = 0;  // By default, no rotation
+    }
+
+    ColorConverter *colorConverter = converter->get(srcFormat);
+    if (colorConverter == NULL) {
+        return NULL;
+    }
+
+    int32_t cropWidth = crop_right - crop_left + 1;
+    int32_t cropHeight = crop_bottom - crop_top + 1;
+
+    int32_t frameWidth = cropWidth;
+    int32_t frameHeight = cropHeight;
+    getScaledFrameSize(frameOptions, &frameWidth, &frameHeight);
+
+    size_t bytesPerPixel =
+        (converter->dstFormat() == OMX_COLOR_Format16bitRGB565) ? 2 : 4;
+
+    VideoFrame *frame = new VideoFrame;
+    frame->mWidth = frameWidth;
+    frame->mHeight = frameHeight;
+    frame->mDisplayWidth = frame->mWidth;
+    frame->mDisplayHeight = frame->mHeight;
+    frame->mSize = frame->mWidth * frame->mHeight * bytesPerPixel;
+    frame->mData = new uint8_t[frame->mSize];
+    frame->mRotationAngle = rotationAngle;
+
+    // The display size is given for the unscaled frame.
+    if (displayWidth > 0) {
+        frame->mDisplayWidth =
+            (int64_t)displayWidth * frameWidth / cropWidth;
+    }
+    if (displayHeight > 0) {
+        frame->mDisplayHeight =
+            (int64_t)displayHeight * frameHeight / cropHeight;
+    }
+
+    status_t err = colorConverter->convert(
+            data,
+            srcWidth, srcHeight,
+            crop_left, crop_top, crop_right, crop_bottom,
+            frame->mData,
+            frame->mWidth,
+            frame->mHeight,
+            0, 0, frame->mWidth - 1, frame->mHeight - 1);
+
+    if (err != OK) {
+        ALOGE("Colorconverter failed to convert frame.");
+
+        delete frame;
+        frame = NULL;
+    }
+
+    return frame;
+}
+
+// Color converts the |buffer| decoded by |decoder| according to
+// |frameOptions|. The caller keeps ownership of |buffer|.
+static VideoFrame *convertVideoFrame(
+        const sp<MetaData> &trackMeta,
+        const sp<MediaSource> &decoder,
+        MediaBuffer *buffer,
+        FrameConverter *converter,
+        const VideoFrameOptions &frameOptions) {
     sp<MetaData> meta = decoder->getFormat();
 
     int32_t width, height;
@@ -266,87 +442,396 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         crop_bottom = height - 1;
     }
 
-    int32_t rotationAngle;
-    if (!trackMeta->findInt32(kKeyRotation, &rotationAngle)) {
-        rotationAngle = 0;  // By default, no rotation
-    }
-
-    VideoFrame *frame = new VideoFrame;
-    frame->mWidth = crop_right - crop_left + 1;
-    frame->mHeight = crop_bottom - crop_top + 1;
-    frame->mDisplayWidth = frame->mWidth;
-    frame->mDisplayHeight = frame->mHeight;
-    frame->mSize = frame->mWidth * frame->mHeight * 2;
-    frame->mData = new uint8_t[frame->mSize];
-    frame->mRotationAngle = rotationAngle;
-
     int32_t displayWidth, displayHeight;
-    if (meta->findInt32(kKeyDisplayWidth, &displayWidth)) {
-        frame->mDisplayWidth = displayWidth;
+    if (!meta->findInt32(kKeyDisplayWidth, &displayWidth)) {
+        displayWidth = -1;
     }
-    if (meta->findInt32(kKeyDisplayHeight, &displayHeight)) {
-        frame->mDisplayHeight = displayHeight;
+    if (!meta->findInt32(kKeyDisplayHeight, &displayHeight)) {
+        displayHeight = -1;
     }
 
     int32_t srcFormat;
     CHECK(meta->findInt32(kKeyColorFormat, &srcFormat));
 
-    ColorConverter converter(
-            (OMX_COLOR_FORMATTYPE)srcFormat, OMX_COLOR_Format16bitRGB565);
-
-    if (converter.isValid()) {
-        err = converter.convert(
-                (const uint8_t *)buffer->data() + buffer->range_offset(),
-                width, height,
-                crop_left, crop_top, crop_right, crop_bottom,
-                frame->mData,
-                frame->mWidth,
-                frame->mHeight,
-                0, 0, frame->mWidth - 1, frame->mHeight - 1);
+    return convertVideoFrame(
+            trackMeta,
+            (const uint8_t *)buffer->data() + buffer->range_offset(),
+            (OMX_COLOR_FORMATTYPE)srcFormat, width, height,
+            crop_left, crop_top, crop_right, crop_bottom,
+            displayWidth, displayHeight,
+            converter,
+            frameOptions);
+}
+
+static bool isValidSeekMode(int seekMode) {
+    return seekMode >= MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC
+        && seekMode <= MediaSource::ReadOptions::SEEK_CLOSEST;
+}
+
+static VideoFrame *extractVideoFrameWithCodecFlags(
+        OMXClient *client,
+        const sp<MetaData> &trackMeta,
+        const sp<MediaSource> &source,
+        uint32_t flags,
+        int64_t frameTimeUs,
+        int seekMode,
+        FrameConverter *converter,
+        const VideoFrameOptions &frameOptions) {
+    if (!isValidSeekMode(seekMode)) {
+        ALOGE("Unknown seek mode: %d", seekMode);
+        return NULL;
+    }
+
+    sp<MediaSource> decoder =
+        createVideoDecoder(client, trackMeta, source, flags);
+
+    if (decoder == NULL) {
+        return NULL;
+    }
+
+    MediaSource::ReadOptions options;
+    MediaSource::ReadOptions::SeekMode mode =
+            static_cast<MediaSource::ReadOptions::SeekMode>(seekMode);
+
+    int64_t thumbNailTime;
+    if (frameTimeUs < 0) {
+        if (!trackMeta->findInt64(kKeyThumbnailTime, &thumbNailTime)
+                || thumbNailTime < 0) {
+            thumbNailTime = 0;
+        }
+        options.setSeekTo(thumbNailTime, mode);
     } else {
-        ALOGE("Unable to instantiate color conversion from format 0x%08x to "
-              "RGB565",
-              srcFormat);
+        thumbNailTime = -1;
+        options.setSeekTo(frameTimeUs, mode);
+    }
+
+    MediaBuffer *buffer;
+    if (readVideoFrame(decoder, &options, &buffer) != OK) {
+        decoder->stop();
+
+        return NULL;
+    }
 
-        err = ERROR_UNSUPPORTED;
+    int64_t timeUs;
+    CHECK(buffer->meta_data()->findInt64(kKeyTime, &timeUs));
+    if (thumbNailTime >= 0) {
+        if (timeUs != thumbNailTime) {
+            const char *mime;
+            CHECK(trackMeta->findCString(kKeyMIMEType, &mime));
+
+            ALOGV("thumbNailTime = %lld us, timeUs = %lld us, mime = %s",
+                 thumbNailTime, timeUs, mime);
+        }
     }
 
+    VideoFrame *frame =
+        convertVideoFrame(
+                trackMeta, decoder, buffer, converter, frameOptions);
+
     buffer->release();
     buffer = NULL;
 
     decoder->stop();
 
-    if (err != OK) {
-        ALOGE("Colorconverter failed to convert frame.");
+    return frame;
+}
 
-        delete frame;
-        frame = NULL;
+// Thumbnails tend to be asked for one file after another, e.g. by a gallery
+// filling a grid, and each retriever is used for a single file. Software
+// decoders are kept in a process wide pool so that the next file only has to
+// configure one instead of allocating a component.
+static Mutex gCodecPoolLock;
+static sp<MediaCodecPool> gCodecPool;
+
+static sp<MediaCodecPool> getCodecPool() {
+    Mutex::Autolock autoLock(gCodecPoolLock);
+
+    if (gCodecPool == NULL) {
+        sp<MediaCodecPool> pool = new MediaCodecPool;
+        if (pool->start() != OK) {
+            return NULL;
+        }
+        gCodecPool = pool;
     }
 
-    return frame;
+    return gCodecPool;
 }
 
-VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
-        int64_t timeUs, int option) {
+// The first software decoder for |mime|, the one kPreferSoftwareCodecs would
+// make OMXCodec pick, or an empty string.
+static AString findSoftwareVideoDecoder(const char *mime) {
+    const MediaCodecList *list = MediaCodecList::getInstance();
+    if (list == NULL) {
+        return AString();
+    }
 
-    ALOGV("getFrameAtTime: %lld us option: %d", timeUs, option);
+    for (ssize_t index = list->findCodecByType(mime, false /* encoder */);
+            index >= 0;
+            index = list->findCodecByType(mime, false, index + 1)) {
+        const char *name = list->getCodecName(index);
+        if (!strncmp(name, "OMX.google.", 11)) {
+            return AString(name);
+        }
+    }
+
+    return AString();
+}
 
+// Feeds |source| to the started |codec| from a seek to |seekTimeUs| until it
+// outputs the frame that seek asks for, and converts that frame. Gives up
+// if the codec outputs nothing for as long as OMXCodec::read() would wait,
+// so that a stuck decoder falls back to OMXCodec about as fast as the
+// OMXCodec path reports its own failures.
+static VideoFrame *decodeVideoFrameWithCodec(
+        const sp<MediaCodec> &codec,
+        const sp<MetaData> &trackMeta,
+        const sp<MediaSource> &source,
+        int64_t seekTimeUs,
+        MediaSource::ReadOptions::SeekMode mode,
+        FrameConverter *converter,
+        const VideoFrameOptions &frameOptions) {
+    static const int64_t kBufferTimeoutUs = 10000ll;
+    static const int64_t kOutputTimeoutUs = 3000000ll;
+
+    Vector<sp<ABuffer> > inputBuffers;
+    Vector<sp<ABuffer> > outputBuffers;
+    if (codec->getInputBuffers(&inputBuffers) != OK
+            || codec->getOutputBuffers(&outputBuffers) != OK) {
+        return NULL;
+    }
+
+    MediaSource::ReadOptions options;
+    options.setSeekTo(seekTimeUs, mode);
+
+    sp<AMessage> outputFormat;
+    bool sawInputEOS = false;
+    int64_t deadlineUs = ALooper::GetNowUs() + kOutputTimeoutUs;
+
+    while (ALooper::GetNowUs() < deadlineUs) {
+        status_t err;
+
+        if (!sawInputEOS) {
+            size_t index;
+            err = codec->dequeueInputBuffer(&index, kBufferTimeoutUs);
+
+            if (err == OK) {
+                MediaBuffer *mediaBuffer;
+                err = source->read(&mediaBuffer, &options);
+                options.clearSeekTo();
+
+                if (err == OK) {
+                    const sp<ABuffer> &buffer = inputBuffers.itemAt(index);
+                    size_t size = mediaBuffer->range_length();
+
+                    int64_t timeUs;
+                    CHECK(mediaBuffer->meta_data()->findInt64(
+                                kKeyTime, &timeUs));
+
+                    if (size > buffer->capacity()) {
+                        ALOGW("input buffer too small for %zu bytes", size);
+                        err = ERROR_BUFFER_TOO_SMALL;
+                    } else {
+                        memcpy(buffer->data(),
+                               (const uint8_t *)mediaBuffer->data()
+                                    + mediaBuffer->range_offset(),
+                               size);
+
+                        err = codec->queueInputBuffer(
+                                index, 0, size, timeUs, 0);
+                    }
+
+                    mediaBuffer->release();
+                    mediaBuffer = NULL;
+                } else {
+                    // End of stream or a read error, let the decoder drain.
+                    sawInputEOS = true;
+
+                    err = codec->queueInputBuffer(
+                            index, 0, 0, 0, MediaCodec::BUFFER_FLAG_EOS);
+                }
+
+                if (err != OK) {
+                    return NULL;
+                }
+            } else if (err != -EAGAIN) {
+                return NULL;
+            }
+        }
+
+        size_t index, offset, size;
+        int64_t timeUs;
+        uint32_t flags;
+        err = codec->dequeueOutputBuffer(
+                &index, &offset, &size, &timeUs, &flags, kBufferTimeoutUs);
+
+        if (err == INFO_FORMAT_CHANGED) {
+            if (codec->getOutputFormat(&outputFormat) != OK) {
+                return NULL;
+            }
+            continue;
+        } else if (err == INFO_OUTPUT_BUFFERS_CHANGED) {
+            if (codec->getOutputBuffers(&outputBuffers) != OK) {
+                return NULL;
+            }
+            continue;
+        } else if (err == -EAGAIN) {
+            continue;
+        } else if (err != OK) {
+            return NULL;
+        }
+
+        deadlineUs = ALooper::GetNowUs() + kOutputTimeoutUs;
+
+        // The sync modes take whatever frame the seek lands on, SEEK_CLOSEST
+        // decodes forward up to the requested time.
+        if (size > 0 && outputFormat != NULL
+                && (mode != MediaSource::ReadOptions::SEEK_CLOSEST
+                        || timeUs >= seekTimeUs)) {
+            int32_t width, height, srcFormat;
+            CHECK(outputFormat->findInt32("width", &width));
+            CHECK(outputFormat->findInt32("height", &height));
+            CHECK(outputFormat->findInt32("color-format", &srcFormat));
+
+            // The buffer is laid out by stride and slice height.
+            int32_t stride, sliceHeight;
+            if (!outputFormat->findInt32("stride", &stride)
+                    || stride < width) {
+                stride = width;
+            }
+            if (!outputFormat->findInt32("slice-height", &sliceHeight)
+                    || sliceHeight < height) {
+                sliceHeight = height;
+            }
+
+            int32_t crop_left, crop_top, crop_right, crop_bottom;
+            if (!outputFormat->findRect(
+                        "crop",
+                        &crop_left, &crop_top, &crop_right, &crop_bottom)) {
+                crop_left = crop_top = 0;
+                crop_right = width - 1;
+                crop_bottom = height - 1;
+            }
+
+            // MediaCodec does not report a display size, the container may.
+            int32_t displayWidth, displayHeight;
+            if (!trackMeta->findInt32(kKeyDisplayWidth, &displayWidth)) {
+                displayWidth = -1;
+            }
+            if (!trackMeta->findInt32(kKeyDisplayHeight, &displayHeight)) {
+                displayHeight = -1;
+            }
+
+            VideoFrame *frame = convertVideoFrame(
+                    trackMeta,
+                    outputBuffers.itemAt(index)->data() + offset,
+                    (OMX_COLOR_FORMATTYPE)srcFormat, stride, sliceHeight,
+                    crop_left, crop_top, crop_right, crop_bottom,
+                    displayWidth, displayHeight,
+                    converter,
+                    frameOptions);
+
+            codec->releaseOutputBuffer(index);
+
+            return frame;
+        }
+
+        codec->releaseOutputBuffer(index);
+
+        if (flags & MediaCodec::BUFFER_FLAG_EOS) {
+            return NULL;
+        }
+    }
+
+    ALOGW("timed out decoding the frame at %lld us", seekTimeUs);
+
+    return NULL;
+}
+
+// Like extractVideoFrameWithCodecFlags() with kPreferSoftwareCodecs, but the
+// software decoder comes from the pool and goes back to it. Returns NULL if
+// the track has no software decoder or decoding fails, the caller then goes
+// through OMXCodec.
+static VideoFrame *extractVideoFrameWithPooledCodec(
+        const sp<MetaData> &trackMeta,
+        const sp<MediaSource> &source,
+        int64_t frameTimeUs,
+        int seekMode,
+        FrameConverter *converter,
+        const VideoFrameOptions &frameOptions) {
+    if (!isValidSeekMode(seekMode)) {
+        ALOGE("Unknown seek mode: %d", seekMode);
+        return NULL;
+    }
+
+    const char *mime;
+    CHECK(trackMeta->findCString(kKeyMIMEType, &mime));
+
+    AString componentName = findSoftwareVideoDecoder(mime);
+    if (componentName.empty()) {
+        return NULL;
+    }
+
+    sp<MediaCodecPool> pool = getCodecPool();
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    sp<AMessage> format;
+    if (convertMetaDataToMessage(trackMeta, &format) != OK) {
+        return NULL;
+    }
+
+    int64_t seekTimeUs = frameTimeUs;
+    if (seekTimeUs < 0) {
+        if (!trackMeta->findInt64(kKeyThumbnailTime, &seekTimeUs)
+                || seekTimeUs < 0) {
+            seekTimeUs = 0;
+        }
+    }
+
+    sp<MediaCodec> codec = pool->acquireByComponentName(componentName.c_str());
+    if (codec == NULL) {
+        return NULL;
+    }
+
+    VideoFrame *frame = NULL;
+
+    if (codec->configure(format, NULL /* nativeWindow */, NULL /* crypto */,
+                0 /* flags */) == OK
+            && codec->start() == OK
+            && source->start() == OK) {
+        frame = decodeVideoFrameWithCodec(
+                codec, trackMeta, source, seekTimeUs,
+                static_cast<MediaSource::ReadOptions::SeekMode>(seekMode),
+                converter, frameOptions);
+
+        source->stop();
+    }
+
+    // Keeps the codec for the next thumbnail, or releases it if it failed.
+    pool->recycle(codec);
+
+    return frame;
+}
+
+status_t StagefrightMetadataRetriever::findVideoTrack(
+        sp<MetaData> *trackMeta, size_t *trackIndex) {
     if (mExtractor.get() == NULL) {
         ALOGV("no extractor.");
-        return NULL;
+        return NO_INIT;
     }
 
     sp<MetaData> fileMeta = mExtractor->getMetaData();
 
     if (fileMeta == NULL) {
         ALOGV("extractor doesn't publish metadata, failed to initialize?");
-        return NULL;
+        return NO_INIT;
     }
 
     int32_t drm = 0;
     if (fileMeta->findInt32(kKeyIsDRM, &drm) && drm != 0) {
         ALOGE("frame grab not allowed.");
-        return NULL;
+        return INVALID_OPERATION;
     }
 
     size_t n = mExtractor->countTracks();
@@ -364,19 +849,47 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
 
     if (i == n) {
         ALOGV("no video track found.");
-        return NULL;
+        return NAME_NOT_FOUND;
     }
 
-    sp<MetaData> trackMeta = mExtractor->getTrackMetaData(
+    *trackMeta = mExtractor->getTrackMetaData(
             i, MediaExtractor::kIncludeExtensiveMetaData);
+    *trackIndex = i;
+
+    return OK;
+}
+
+VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
+        int64_t timeUs, int option) {
+    return getFrameAtTime(timeUs, option, VideoFrameOptions());
+}
+
+VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
+        int64_t timeUs, int option, const VideoFrameOptions &frameOptions) {
+
+    ALOGV("getFrameAtTime: %lld us option: %d", timeUs, option);
+
+    OMX_COLOR_FORMATTYPE dstFormat;
+    if (!getDstColorFormat(frameOptions, &dstFormat)) {
+        ALOGE("Unknown frame format: %d", frameOptions.mFormat);
+        return NULL;
+    }
+
+    sp<MetaData> trackMeta;
+    size_t trackIndex;
+    if (findVideoTrack(&trackMeta, &trackIndex) != OK) {
+        return NULL;
+    }
 
-    sp<MediaSource> source = mExtractor->getTrack(i);
+    sp<MediaSource> source = mExtractor->getTrack(trackIndex);
 
     if (source.get() == NULL) {
         ALOGV("unable to instantiate video track.");
         return NULL;
     }
 
+    sp<MetaData> fileMeta = mExtractor->getMetaData();
+
     const void *data;
     uint32_t type;
     size_t dataSize;
@@ -388,26 +901,265 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
         memcpy(mAlbumArt->mData, data, dataSize);
     }
 
+    FrameConverter converter(frameOptions);
+
     VideoFrame *frame =
-        extractVideoFrameWithCodecFlags(
+        extractVideoFrameWithPooledCodec(
+                trackMeta, source, timeUs, option, &converter, frameOptions);
+
+    if (frame == NULL) {
+        ALOGV("Pooled software decoder failed to extract thumbnail, "
+             "trying OMXCodec.");
+
+        frame = extractVideoFrameWithCodecFlags(
 #ifndef QCOM_HARDWARE
                 &mClient, trackMeta, source, OMXCodec::kPreferSoftwareCodecs,
 #else
                 &mClient, trackMeta, source, OMXCodec::kSoftwareCodecsOnly,
 #endif
-                timeUs, option);
+                timeUs, option, &converter, frameOptions);
+    }
 
     if (frame == NULL) {
         ALOGV("Software decoder failed to extract thumbnail, "
              "trying hardware decoder.");
 
         frame = extractVideoFrameWithCodecFlags(&mClient, trackMeta, source, 0,
-                        timeUs, option);
+                        timeUs, option, &converter, frameOptions);
     }
 
     return frame;
 }
 
+// Opens the video track once more, from an extractor of its own, so that
+// it can be seeked without disturbing |mExtractor|'s tracks. Some
+// extractors share state between the instances of a track. Returns NULL
+// if the track cannot be opened.
+sp<MediaSource> StagefrightMetadataRetriever::createProbe(
+        size_t trackIndex, sp<MediaExtractor> *extractor) {
+    const char *containerMime;
+    if (!mExtractor->getMetaData()->findCString(
+                kKeyMIMEType, &containerMime)) {
+        containerMime = NULL;
+    }
+
+    *extractor = MediaExtractor::Create(mSource, containerMime);
+    if (*extractor == NULL || (*extractor)->countTracks() <= trackIndex) {
+        return NULL;
+    }
+
+    sp<MediaSource> probe = (*extractor)->getTrack(trackIndex);
+    if (probe == NULL || probe->start() != OK) {
+        return NULL;
+    }
+
+    return probe;
+}
+
+// Returns the time of the sample a seek of |probe| to |timeUs| with |mode|
+// lands on, which only takes reading one compressed sample, or -1.
+static int64_t findSeekTargetTime(
+        const sp<MediaSource> &probe,
+        int64_t timeUs,
+        MediaSource::ReadOptions::SeekMode mode) {
+    MediaSource::ReadOptions options;
+    options.setSeekTo(timeUs, mode);
+
+    MediaBuffer *buffer;
+    if (probe->read(&buffer, &options) != OK) {
+        return -1;
+    }
+
+    int64_t sampleTimeUs;
+    if (!buffer->meta_data()->findInt64(kKeyTime, &sampleTimeUs)) {
+        sampleTimeUs = -1;
+    }
+
+    buffer->release();
+    buffer = NULL;
+
+    return sampleTimeUs;
+}
+
+status_t StagefrightMetadataRetriever::getFramesAtTimes(
+        const Vector<int64_t> &timesUs, int option,
+        const VideoFrameOptions &frameOptions,
+        Vector<VideoFrame *> *frames) {
+    ALOGV("getFramesAtTimes: %zu frames option: %d", timesUs.size(), option);
+
+    frames->clear();
+
+    OMX_COLOR_FORMATTYPE dstFormat;
+    if (!getDstColorFormat(frameOptions, &dstFormat)) {
+        ALOGE("Unknown frame format: %d", frameOptions.mFormat);
+        return BAD_VALUE;
+    }
+
+    if (!isValidSeekMode(option)) {
+        ALOGE("Unknown seek mode: %d", option);
+        return BAD_VALUE;
+    }
+
+    for (size_t i = 1; i < timesUs.size(); ++i) {
+        if (timesUs[i] < timesUs[i - 1]) {
+            ALOGE("frame times are not sorted.");
+            return BAD_VALUE;
+        }
+    }
+
+    sp<MetaData> trackMeta;
+    size_t trackIndex;
+    status_t err = findVideoTrack(&trackMeta, &trackIndex);
+    if (err != OK) {
+        return err;
+    }
+
+    sp<MediaSource> source = mExtractor->getTrack(trackIndex);
+
+    if (source.get() == NULL) {
+        ALOGV("unable to instantiate video track.");
+        return UNKNOWN_ERROR;
+    }
+
+    sp<MediaSource> decoder =
+        createVideoDecoder(
+#ifndef QCOM_HARDWARE
+                &mClient, trackMeta, source, OMXCodec::kPreferSoftwareCodecs);
+#else
+                &mClient, trackMeta, source, OMXCodec::kSoftwareCodecsOnly);
+#endif
+
+    if (decoder == NULL) {
+        ALOGV("Software decoder failed to instantiate, "
+             "trying hardware decoder.");
+
+        decoder = createVideoDecoder(&mClient, trackMeta, source, 0);
+    }
+
+    if (decoder == NULL) {
+        return UNKNOWN_ERROR;
+    }
+
+    MediaSource::ReadOptions::SeekMode mode =
+            static_cast<MediaSource::ReadOptions::SeekMode>(option);
+
+    // Tells where a seek would land without seeking the decoder. Without
+    // it every time is seeked to.
+    sp<MediaExtractor> probeExtractor;
+    sp<MediaSource> probe;
+    if (timesUs.size() > 1) {
+        probe = createProbe(trackIndex, &probeExtractor);
+    }
+
+    FrameConverter converter(frameOptions);
+
+    int64_t lastFrameTimeUs = -1;
+    VideoFrame *lastFrame = NULL;
+    size_t numSeeks = 0;
+    size_t numFramesDecoded = 0;
+
+    for (size_t i = 0; i < timesUs.size(); ++i) {
+        int64_t targetTimeUs = timesUs[i];
+
+        MediaSource::ReadOptions options;
+        bool seek = true;
+
+        if (lastFrame != NULL
+                && mode == MediaSource::ReadOptions::SEEK_CLOSEST) {
+            // Targets that fall on the last returned frame share it.
+            if (targetTimeUs <= lastFrameTimeUs) {
+                frames->push(new VideoFrame(*lastFrame));
+                continue;
+            }
+
+            // A seek would restart from the sync sample before the target.
+            // If the decoder is already past that sample, decoding on from
+            // where it is gets there with less work.
+            if (probe != NULL) {
+                int64_t syncTimeUs = findSeekTargetTime(
+                        probe, targetTimeUs,
+                        MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC);
+
+                seek = (syncTimeUs < 0 || syncTimeUs > lastFrameTimeUs);
+            }
+        } else if (lastFrame != NULL && probe != NULL) {
+            // The sync modes return the sync sample the seek lands on,
+            // which may well be the one returned last.
+            if (findSeekTargetTime(probe, targetTimeUs, mode)
+                    == lastFrameTimeUs) {
+                frames->push(new VideoFrame(*lastFrame));
+                continue;
+            }
+        }
+
+        if (seek) {
+            options.setSeekTo(targetTimeUs, mode);
+            ++numSeeks;
+        }
+
+        MediaBuffer *buffer = NULL;
+        int64_t timeUs = -1;
+        for (;;) {
+            err = readVideoFrame(decoder, &options, &buffer);
+            if (err != OK) {
+                break;
+            }
+
+            ++numFramesDecoded;
+
+            CHECK(buffer->meta_data()->findInt64(kKeyTime, &timeUs));
+
+            // The sync modes take whatever frame the seek lands on. For
+            // SEEK_CLOSEST decode forward up to the target, which the
+            // decoder may already have done for us after a seek.
+            if (mode != MediaSource::ReadOptions::SEEK_CLOSEST
+                    || timeUs >= targetTimeUs) {
+                break;
+            }
+
+            buffer->release();
+            buffer = NULL;
+        }
+
+        if (err != OK) {
+            ALOGW("decoding stopped at %lld us (%d)", targetTimeUs, err);
+            break;
+        }
+
+        VideoFrame *frame =
+            convertVideoFrame(
+                trackMeta, decoder, buffer, &converter, frameOptions);
+
+        buffer->release();
+        buffer = NULL;
+
+        if (frame == NULL) {
+            break;
+        }
+
+        frames->push(frame);
+
+        lastFrame = frame;
+        lastFrameTimeUs = timeUs;
+    }
+
+    ALOGV("decoded %zu frames with %zu seeks for %zu frame times",
+          numFramesDecoded, numSeeks, timesUs.size());
+
+    // Times past the end of the stream or a decoder error get no frame.
+    while (frames->size() < timesUs.size()) {
+        frames->push(NULL);
+    }
+
+    if (probe != NULL) {
+        probe->stop();
+    }
+
+    decoder->stop();
+
+    return (lastFrame != NULL) ? OK : UNKNOWN_ERROR;
+}
+
 MediaAlbumArt *StagefrightMetadataRetriever::extractAlbumArt() {
     ALOGV("extractAlbumArt (extractor: %s)", mExtractor.get() != NULL ? "YES" : "NO");
 
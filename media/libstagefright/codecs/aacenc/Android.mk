@@ -82,6 +82,12 @@ LOCAL_C_INCLUDES += $(LOCAL_PATH)/src/asm/ARMV5E
 LOCAL_C_INCLUDES += $(LOCAL_PATH)/src/asm/ARMV7
 endif
 
+# The band energy, TNS autocorrelation and quantization loops are replaced by
+# bit-exact SSE2 versions in src/band_nrg.c, src/tns.c and src/quantize.c.
+ifeq ($(TARGET_ARCH),x86)
+LOCAL_CFLAGS += -DAACENC_SSE2
+endif
+
 include $(BUILD_STATIC_LIBRARY)
 
 ################################################################################
@@ -141,3 +147,33 @@ else # visualon
   include $(BUILD_SHARED_LIBRARY)
 
 endif # $(AAC_LIBRARY)
+
+################################################################################
+
+# test utility: checks the SSE2 kernels and measures the encoding speed
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	test/aacenc_bench.c
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/media/libstagefright/codecs/common/include \
+	$(LOCAL_PATH)/src \
+	$(LOCAL_PATH)/inc \
+	$(LOCAL_PATH)/basic_op
+
+ifeq ($(TARGET_ARCH),x86)
+LOCAL_CFLAGS += -DAACENC_SSE2
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+	libstagefright_aacenc
+
+LOCAL_SHARED_LIBRARIES := \
+	libstagefright_enc_common
+
+LOCAL_MODULE := aacenc_bench
+LOCAL_MODULE_TAGS := debug
+
+include $(BUILD_EXECUTABLE)
@@ -43,4 +43,21 @@ void CalcBandEnergyMS(const Word32 *mdctSpectrumLeft,
                       Word32       *bandEnergySide,
                       Word32       *bandEnergySideSum);
 
+#ifdef AACENC_SSE2
+void CalcBandEnergy_SSE2(const Word32 *mdctSpectrum,
+                         const Word16 *bandOffset,
+                         const Word16  numBands,
+                         Word32       *bandEnergy,
+                         Word32       *bandEnergySum);
+
+void CalcBandEnergyMS_SSE2(const Word32 *mdctSpectrumLeft,
+                           const Word32 *mdctSpectrumRight,
+                           const Word16 *bandOffset,
+                           const Word16  numBands,
+                           Word32       *bandEnergyMid,
+                           Word32       *bandEnergyMidSum,
+                           Word32       *bandEnergySide,
+                           Word32       *bandEnergySideSum);
+#endif
+
 #endif
@@ -39,4 +39,17 @@ Word32 calcSfbDist(const Word32 *spec,
                    Word16  sfbWidth,
                    Word16  gain);
 
+#ifdef AACENC_SSE2
+void QuantizeSpectrum_SSE2(Word16 sfbCnt,
+                           Word16 maxSfbPerGroup,
+                           Word16 sfbPerGroup,
+                           Word16 *sfbOffset, Word32 *mdctSpectrum,
+                           Word16 globalGain, Word16 *scalefactors,
+                           Word16 *quantizedSpectrum);
+
+Word32 calcSfbDist_SSE2(const Word32 *spec,
+                        Word16  sfbWidth,
+                        Word16  gain);
+#endif
+
 #endif /* _QUANTIZE_H_ */
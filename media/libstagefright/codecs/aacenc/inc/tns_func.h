@@ -71,5 +71,9 @@ void ApplyTnsMultTableToRatios(Word16 startCb,
                                TNS_SUBBLOCK_INFO subInfo,
                                Word32 *thresholds);
 
+#ifdef AACENC_SSE2
+void AutoCorrelation_SSE2(const Word16 input[], Word32 corr[],
+                          Word16 samples, Word16 corrCoeff);
+#endif
 
 #endif /* _TNS_FUNC_H */
@@ -20,6 +20,12 @@
 
 *******************************************************************************/
 
+/* Include system headers before local headers - the local headers
+ * redefine __inline, which can mess up definitions in libc headers if
+ * they happen to use __inline. */
+#ifdef AACENC_SSE2
+#include <emmintrin.h>
+#endif
 #include "basic_op.h"
 #include "band_nrg.h"
 
@@ -100,3 +106,129 @@ void CalcBandEnergyMS(const Word32 *mdctSpectrumLeft,
 }
 
 #endif
+
+#ifdef AACENC_SSE2
+/********************************************************************************
+*
+* function name: SumSquaresHigh_SSE2
+* description:   sum of MULHIGH(x, x) for 4 lanes, as 2 64 bit sums
+*                x*x is never negative, so MULHIGH(x, x) is the high word of
+*                the unsigned square of |x|; |0x80000000| is still 2^31 unsigned
+*
+**********************************************************************************/
+__inline __m128i SumSquaresHigh_SSE2(__m128i acc, __m128i x)
+{
+  __m128i sign = _mm_srai_epi32(x, 31);
+  __m128i ax = _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+
+  acc = _mm_add_epi64(acc, _mm_srli_epi64(_mm_mul_epu32(ax, ax), 32));
+  ax = _mm_srli_epi64(ax, 32);
+  acc = _mm_add_epi64(acc, _mm_srli_epi64(_mm_mul_epu32(ax, ax), 32));
+
+  return acc;
+}
+
+/********************************************************************************
+*
+* function name: SaturateSum_SSE2
+* description:   L_add() of non negative values saturates only once, so the
+*                band sum is min(sum, MAX_32)
+*
+**********************************************************************************/
+__inline Word32 SaturateSum_SSE2(__m128i acc, Word64 tail)
+{
+  Word64 sum[2];
+
+  _mm_storeu_si128((__m128i *)sum, acc);
+  sum[0] += sum[1] + tail;
+
+  return sum[0] > MAX_32 ? MAX_32 : (Word32)sum[0];
+}
+
+/********************************************************************************
+*
+* function name: CalcBandEnergy_SSE2
+* description:   SSE2 version of CalcBandEnergy, bit exact with the C version
+*
+**********************************************************************************/
+void CalcBandEnergy_SSE2(const Word32 *mdctSpectrum,
+                         const Word16 *bandOffset,
+                         const Word16  numBands,
+                         Word32       *bandEnergy,
+                         Word32       *bandEnergySum)
+{
+  Word32 i, j;
+  Word32 accuSum = 0;
+
+  for (i=0; i<numBands; i++) {
+    __m128i acc = _mm_setzero_si128();
+    Word64 tail = 0;
+    Word32 accu;
+
+    for (j=bandOffset[i]; j+4<=bandOffset[i+1]; j+=4)
+      acc = SumSquaresHigh_SSE2(acc, _mm_loadu_si128((const __m128i *)&mdctSpectrum[j]));
+    for (; j<bandOffset[i+1]; j++)
+      tail += MULHIGH(mdctSpectrum[j], mdctSpectrum[j]);
+
+    accu = SaturateSum_SSE2(acc, tail);
+    accu = L_add(accu, accu);
+    accuSum = L_add(accuSum, accu);
+    bandEnergy[i] = accu;
+  }
+  *bandEnergySum = accuSum;
+}
+
+/********************************************************************************
+*
+* function name: CalcBandEnergyMS_SSE2
+* description:   SSE2 version of CalcBandEnergyMS, bit exact with the C version
+*
+**********************************************************************************/
+void CalcBandEnergyMS_SSE2(const Word32 *mdctSpectrumLeft,
+                           const Word32 *mdctSpectrumRight,
+                           const Word16 *bandOffset,
+                           const Word16  numBands,
+                           Word32       *bandEnergyMid,
+                           Word32       *bandEnergyMidSum,
+                           Word32       *bandEnergySide,
+                           Word32       *bandEnergySideSum)
+{
+  Word32 i, j;
+  Word32 accuMidSum = 0;
+  Word32 accuSideSum = 0;
+
+  for(i=0; i<numBands; i++) {
+    __m128i accMid = _mm_setzero_si128();
+    __m128i accSide = _mm_setzero_si128();
+    Word64 tailMid = 0;
+    Word64 tailSide = 0;
+    Word32 accuMid, accuSide;
+
+    for (j=bandOffset[i]; j+4<=bandOffset[i+1]; j+=4) {
+      __m128i l = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)&mdctSpectrumLeft[j]), 1);
+      __m128i r = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)&mdctSpectrumRight[j]), 1);
+
+      accMid = SumSquaresHigh_SSE2(accMid, _mm_add_epi32(l, r));
+      accSide = SumSquaresHigh_SSE2(accSide, _mm_sub_epi32(l, r));
+    }
+    for (; j<bandOffset[i+1]; j++) {
+      Word32 l = mdctSpectrumLeft[j] >> 1;
+      Word32 r = mdctSpectrumRight[j] >> 1;
+
+      tailMid += MULHIGH(l + r, l + r);
+      tailSide += MULHIGH(l - r, l - r);
+    }
+
+    accuMid = SaturateSum_SSE2(accMid, tailMid);
+    accuSide = SaturateSum_SSE2(accSide, tailSide);
+    accuMid = L_add(accuMid, accuMid);
+    accuSide = L_add(accuSide, accuSide);
+    bandEnergyMid[i] = accuMid;
+    accuMidSum = L_add(accuMidSum, accuMid);
+    bandEnergySide[i] = accuSide;
+    accuSideSum = L_add(accuSideSum, accuSide);
+  }
+  *bandEnergyMidSum = accuMidSum;
+  *bandEnergySideSum = accuSideSum;
+}
+#endif
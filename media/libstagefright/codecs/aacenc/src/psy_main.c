@@ -38,6 +38,11 @@
 #include "tns_func.h"
 #include "memalign.h"
 
+#ifdef AACENC_SSE2
+#define CalcBandEnergy   CalcBandEnergy_SSE2
+#define CalcBandEnergyMS CalcBandEnergyMS_SSE2
+#endif
+
 /*                                    long       start       short       stop */
 static Word16 blockType2windowShape[] = {KBD_WINDOW,SINE_WINDOW,SINE_WINDOW,KBD_WINDOW};
 
@@ -33,6 +33,10 @@
 #include "channel_map.h"
 #include "memalign.h"
 
+#ifdef AACENC_SSE2
+#define QuantizeSpectrum QuantizeSpectrum_SSE2
+#endif
+
 
 typedef enum{
   FRAME_LEN_BYTES_MODULO =  1,
@@ -20,6 +20,12 @@
 
 *******************************************************************************/
 
+/* Include system headers before local headers - the local headers
+ * redefine __inline, which can mess up definitions in libc headers if
+ * they happen to use __inline. */
+#ifdef AACENC_SSE2
+#include <emmintrin.h>
+#endif
 #include "typedef.h"
 #include "basic_op.h"
 #include "oper_32b.h"
@@ -443,3 +449,207 @@ Word32 calcSfbDist(const Word32 *spec,
 
   return dist;
 }
+
+#ifdef AACENC_SSE2
+/*****************************************************************************
+*
+* function name: absLines_SSE2
+* description: L_abs() of 4 lines
+*
+*****************************************************************************/
+__inline __m128i absLines_SSE2(__m128i x)
+{
+  __m128i sign = _mm_srai_epi32(x, 31);
+  __m128i ax = _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+
+  /* L_abs(MIN_32) is MAX_32 */
+  return _mm_add_epi32(ax, _mm_cmpeq_epi32(ax, _mm_set1_epi32(MIN_32)));
+}
+
+/*****************************************************************************
+*
+* function name: quantizeLines_SSE2
+* description: SSE2 version of quantizeLines, bit exact with the C version
+*              the lines below pquat[3] are classified 8 at a time, the
+*              others are quantized with quantizeSingleLine()
+*
+*****************************************************************************/
+static void quantizeLines_SSE2(const Word16 gain,
+                               const Word16 noOfLines,
+                               const Word32 *mdctSpectrum,
+                               Word16 *quaSpectrum)
+{
+  Word32 line;
+  Word32 m = gain&3;
+  Word32 g = (gain >> 2) + 4 + 16;
+  const Word16 *pquat;
+  __m128i shift, border0, border1, border2, border3;
+
+  /* a shift left or by 32 or more is left to the C version */
+  if (g < 0 || g >= INT_BITS) {
+    quantizeLines(gain, noOfLines, mdctSpectrum, quaSpectrum);
+    return;
+  }
+
+  pquat = quantBorders[m];
+  shift = _mm_cvtsi32_si128(g);
+  border0 = _mm_set1_epi32(pquat[0]);
+  border1 = _mm_set1_epi32(pquat[1] - 1);
+  border2 = _mm_set1_epi32(pquat[2] - 1);
+  border3 = _mm_set1_epi32(pquat[3] - 1);
+
+  for (line=0; line+8<=noOfLines; line+=8) {
+    __m128i qua[2], large[2];
+    Word32 k, mask;
+
+    for (k=0; k<2; k++) {
+      __m128i spec = _mm_loadu_si128((const __m128i *)&mdctSpectrum[line + 4*k]);
+      __m128i sign = _mm_srai_epi32(spec, 31);
+      __m128i saShft = _mm_srl_epi32(absLines_SSE2(spec), shift);
+      __m128i q;
+
+      /* 0, 1, 2 or 3 as the number of borders passed */
+      q = _mm_add_epi32(_mm_cmpgt_epi32(saShft, border0),
+                        _mm_cmpgt_epi32(saShft, border1));
+      q = _mm_sub_epi32(_mm_setzero_si128(),
+                        _mm_add_epi32(q, _mm_cmpgt_epi32(saShft, border2)));
+      qua[k] = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);
+      large[k] = _mm_cmpgt_epi32(saShft, border3);
+    }
+
+    _mm_storeu_si128((__m128i *)&quaSpectrum[line], _mm_packs_epi32(qua[0], qua[1]));
+
+    mask = _mm_movemask_epi8(_mm_packs_epi16(_mm_packs_epi32(large[0], large[1]),
+                                             _mm_setzero_si128()));
+    for (k=0; mask; k++, mask>>=1) {
+      if (mask & 1) {
+        Word32 mdctSpeL = mdctSpectrum[line + k];
+        Word16 q = quantizeSingleLine(gain, L_abs(mdctSpeL));
+
+        quaSpectrum[line + k] = mdctSpeL < 0 ? -q : q;
+      }
+    }
+  }
+
+  if (line < noOfLines) {
+    quantizeLines(gain, noOfLines - line, mdctSpectrum + line, quaSpectrum + line);
+  }
+}
+
+/*****************************************************************************
+*
+* function name: QuantizeSpectrum_SSE2
+* description: SSE2 version of QuantizeSpectrum
+*
+*****************************************************************************/
+void QuantizeSpectrum_SSE2(Word16 sfbCnt,
+                           Word16 maxSfbPerGroup,
+                           Word16 sfbPerGroup,
+                           Word16 *sfbOffset,
+                           Word32 *mdctSpectrum,
+                           Word16 globalGain,
+                           Word16 *scalefactors,
+                           Word16 *quantizedSpectrum)
+{
+  Word32 sfbOffs, sfb;
+
+  for(sfbOffs=0;sfbOffs<sfbCnt;sfbOffs+=sfbPerGroup) {
+    Word32 sfbNext ;
+    for (sfb = 0; sfb < maxSfbPerGroup; sfb = sfbNext) {
+      Word16 scalefactor = scalefactors[sfbOffs+sfb];
+      /* coalesce sfbs with the same scalefactor */
+      for (sfbNext = sfb+1;
+           sfbNext < maxSfbPerGroup && scalefactor == scalefactors[sfbOffs+sfbNext];
+           sfbNext++) ;
+
+      quantizeLines_SSE2(globalGain - scalefactor,
+                         sfbOffset[sfbOffs+sfbNext] - sfbOffset[sfbOffs+sfb],
+                         mdctSpectrum + sfbOffset[sfbOffs+sfb],
+                         quantizedSpectrum + sfbOffset[sfbOffs+sfb]);
+    }
+  }
+}
+
+/*****************************************************************************
+*
+* function name: calcSfbDist_SSE2
+* description: SSE2 version of calcSfbDist, bit exact with the C version
+*              all distortions are positive, so the L_add() of the C version
+*              saturates at most once and the sum is min(sum, MAX_32)
+*
+*****************************************************************************/
+Word32 calcSfbDist_SSE2(const Word32 *spec,
+                        Word16  sfbWidth,
+                        Word16  gain)
+{
+  Word32 line;
+  Word32 m = gain&3;
+  Word32 g = (gain >> 2) + 4;
+  Word32 g2 = (g << 1) + 1;
+  const Word16 *pquat, *repquat;
+  __m128i shift, shift2, border0, border1, border2, border3;
+  __m128i recon0, recon1, recon2;
+  __m128i acc = _mm_setzero_si128();
+  Word64 sum[2];
+  Word64 dist = 0;
+
+  g += 16;
+  if (!(g2 < 0 && g >= 0)) {
+    return calcSfbDist(spec, sfbWidth, gain);
+  }
+
+  pquat = quantBorders[m];
+  repquat = quantRecon[m];
+  shift = _mm_cvtsi32_si128(g);
+  shift2 = _mm_cvtsi32_si128(-g2);
+  border0 = _mm_set1_epi32(pquat[0] - 1);
+  border1 = _mm_set1_epi32(pquat[1] - 1);
+  border2 = _mm_set1_epi32(pquat[2] - 1);
+  border3 = _mm_set1_epi32(pquat[3] - 1);
+  recon0 = _mm_set1_epi32(repquat[0]);
+  recon1 = _mm_set1_epi32(repquat[1] - repquat[0]);
+  recon2 = _mm_set1_epi32(repquat[2] - repquat[1]);
+
+  for (line=0; line+4<=sfbWidth; line+=4) {
+    __m128i sa = absLines_SSE2(_mm_loadu_si128((const __m128i *)&spec[line]));
+    __m128i saShft = _mm_srl_epi32(sa, shift);
+    __m128i large = _mm_cmpgt_epi32(saShft, border3);
+    __m128i recon, diff, distSingle;
+    Word32 k, mask;
+
+    recon = _mm_and_si128(_mm_cmpgt_epi32(saShft, border0), recon0);
+    recon = _mm_add_epi32(recon, _mm_and_si128(_mm_cmpgt_epi32(saShft, border1), recon1));
+    recon = _mm_add_epi32(recon, _mm_and_si128(_mm_cmpgt_epi32(saShft, border2), recon2));
+
+    /* below pquat[3] the difference fits in 16 bits */
+    diff = _mm_andnot_si128(large, _mm_sub_epi32(saShft, recon));
+    diff = _mm_and_si128(diff, _mm_set1_epi32(0xffff));
+    distSingle = _mm_srl_epi32(_mm_madd_epi16(diff, diff), shift2);
+
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(distSingle, _mm_setzero_si128()));
+    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(distSingle, _mm_setzero_si128()));
+
+    mask = _mm_movemask_ps(_mm_castsi128_ps(large));
+    for (k=0; mask; k++, mask>>=1) {
+      if (mask & 1) {
+        Word32 sa = L_abs(spec[line + k]);
+        Word16 qua = quantizeSingleLine(gain, sa);
+        Word32 iqval, diff32;
+        /* now that we have quantized x, re-quantize it. */
+        iquantizeLines(gain, 1, &qua, &iqval);
+        diff32 = sa - iqval;
+        dist += fixmul(diff32, diff32);
+      }
+    }
+  }
+
+  if (line < sfbWidth) {
+    dist += calcSfbDist(spec + line, sfbWidth - line, gain);
+  }
+
+  _mm_storeu_si128((__m128i *)sum, acc);
+  dist += sum[0] + sum[1];
+
+  return dist > MAX_32 ? MAX_32 : (Word32)dist;
+}
+#endif
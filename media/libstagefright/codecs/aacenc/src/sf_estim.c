@@ -27,6 +27,10 @@
 #include "bit_cnt.h"
 #include "aac_rom.h"
 
+#ifdef AACENC_SSE2
+#define calcSfbDist calcSfbDist_SSE2
+#endif
+
 static const Word16 MAX_SCF_DELTA = 60;
 
 /*!
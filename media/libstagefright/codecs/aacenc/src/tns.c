@@ -20,6 +20,12 @@
 
 *******************************************************************************/
 
+/* Include system headers before local headers - the local headers
+ * redefine __inline, which can mess up definitions in libc headers if
+ * they happen to use __inline. */
+#ifdef AACENC_SSE2
+#include <emmintrin.h>
+#endif
 #include "basic_op.h"
 #include "oper_32b.h"
 #include "assert.h"
@@ -649,7 +655,11 @@ static Word16 CalcTnsFilter(const Word16 *signal,
     parcor[i] = 0;
   }
 
+#ifdef AACENC_SSE2
+  AutoCorrelation_SSE2(signal, parcorWorkBuffer, numOfLines, tnsOrderPlus1);
+#else
   AutoCorrelation(signal, parcorWorkBuffer, numOfLines, tnsOrderPlus1);
+#endif
 
   /* early return if signal is very low: signal prediction off, with zero parcor coeffs */
   if (parcorWorkBuffer[0] == 0)
@@ -703,6 +713,99 @@ void AutoCorrelation(const Word16		 input[],
 }
 #endif
 
+#ifdef AACENC_SSE2
+/*****************************************************************************
+*
+* function name: DotProductShr_SSE2
+* description:  sum { (x[j] * y[j]) >> scf } ; j = 0..n-1, without saturation
+*
+*****************************************************************************/
+static Word32 DotProductShr_SSE2(const Word16 x[],
+                                 const Word16 y[],
+                                 Word32       n,
+                                 Word32       scf)
+{
+  __m128i acc = _mm_setzero_si128();
+  __m128i shift = _mm_cvtsi32_si128(scf);
+  Word32 sum[4];
+  Word32 j, accu;
+
+  for(j=0; j+8<=n; j+=8) {
+    __m128i a = _mm_loadu_si128((const __m128i *)&x[j]);
+    __m128i b = _mm_loadu_si128((const __m128i *)&y[j]);
+    __m128i lo = _mm_mullo_epi16(a, b);
+    __m128i hi = _mm_mulhi_epi16(a, b);
+
+    /* each 32 bit product is shifted on its own, as in the C version */
+    acc = _mm_add_epi32(acc, _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift));
+    acc = _mm_add_epi32(acc, _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift));
+  }
+  _mm_storeu_si128((__m128i *)sum, acc);
+  accu = sum[0] + sum[1] + sum[2] + sum[3];
+
+  for(; j<n; j++) {
+    accu += (x[j] * y[j]) >> scf;
+  }
+
+  return accu;
+}
+
+/*****************************************************************************
+*
+* function name: AutoCorrelation_SSE2
+* description:  SSE2 version of AutoCorrelation, bit exact with the C version
+*               |sum { t[i] * t[i+j] }| <= sum { t[i] * t[i] }, so when the
+*               energy is small enough none of the L_add() of the C version
+*               saturates and the sums can be formed in any order; otherwise
+*               the C version is used
+*
+*****************************************************************************/
+void AutoCorrelation_SSE2(const Word16		 input[],
+                                 Word32       corr[],
+                                 Word16       samples,
+                                 Word16       corrCoeff) {
+  Word32 i, j, isamples;
+  Word64 energy[2];
+  __m128i acc;
+  __m128i zero = _mm_setzero_si128();
+  Word32 scf;
+
+  scf = 10 - 1;
+
+  isamples = samples;
+  acc = zero;
+  for(j=0; j+8<=isamples; j+=8) {
+    __m128i x = _mm_loadu_si128((const __m128i *)&input[j]);
+    /* at most 2 * 2^30, not negative as an unsigned value */
+    __m128i sq = _mm_madd_epi16(x, x);
+
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+    acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+  }
+  _mm_storeu_si128((__m128i *)energy, acc);
+  energy[0] += energy[1];
+  for(; j<isamples; j++) {
+    energy[0] += input[j] * input[j];
+  }
+
+  /* each term may round down by one more than the product does */
+  if((energy[0] >> scf) + isamples + 1 > MAX_32) {
+    AutoCorrelation(input, corr, samples, corrCoeff);
+    return;
+  }
+
+  corr[0] = DotProductShr_SSE2(input, input, isamples, scf);
+
+  /* early termination if all corr coeffs are likely going to be zero */
+  if(corr[0] == 0) return ;
+
+  for(i=1; i<corrCoeff; i++) {
+    isamples = isamples - 1;
+    corr[i] = DotProductShr_SSE2(input, input + i, isamples, scf);
+  }
+}
+#endif
+
 /*****************************************************************************
 *
 * function name: AutoToParcor
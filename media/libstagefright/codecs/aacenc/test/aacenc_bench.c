@@ -0,0 +1,434 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * With AACENC_SSE2, checks that the SSE2 band energy, TNS autocorrelation
+ * and quantization kernels give exactly what the C versions give on random
+ * input, and prints the time each of them takes.
+ *
+ * Then encodes 16 bit stereo PCM (a synthetic signal with transients, or
+ * the given raw file) as 44.1 kHz and 48 kHz AAC and prints the realtime
+ * factor (seconds of audio encoded per second) and a checksum of the
+ * bitstream, which is the same with and without AACENC_SSE2.
+ *
+ * Usage: aacenc_bench [-b bitrate] [-n seconds] [-r repeat] [file.pcm]
+ */
+
+/* Include system headers before local headers - the local headers
+ * redefine __inline, which can mess up definitions in libc headers if
+ * they happen to use __inline. */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "voAAC.h"
+#include "cmnMemory.h"
+#include "typedef.h"
+#include "psy_const.h"
+#include "band_nrg.h"
+#include "quantize.h"
+#include "tns.h"
+#include "tns_func.h"
+
+#define PCM_FRAME_BYTES (1024 * 2 * 2)
+
+static int64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+#ifdef AACENC_SSE2
+
+/* defined in tns.c */
+void AutoCorrelation(const Word16 input[], Word32 corr[],
+                     Word16 samples, Word16 corrCoeff);
+
+static uint32_t gSeed = 1;
+
+static Word32 random32(void)
+{
+    uint32_t hi;
+
+    gSeed = gSeed * 1103515245 + 12345;
+    hi = gSeed >> 16;
+    gSeed = gSeed * 1103515245 + 12345;
+    return (Word32)((hi << 16) | (gSeed >> 16));
+}
+
+static Word32 randomRange(Word32 lo, Word32 hi)
+{
+    return lo + (Word32)((uint32_t)random32() % (uint32_t)(hi - lo + 1));
+}
+
+/* spectral values of all magnitudes, with a few full scale ones */
+static Word32 randomLine(void)
+{
+    Word32 x = random32();
+
+    return (x & 0xf) ? (x >> randomRange(1, 31)) : x;
+}
+
+static void randomBands(Word16 *offset, Word16 *numBands, Word32 maxLines)
+{
+    Word32 n = 0;
+    Word32 i;
+
+    offset[0] = 0;
+    for (i = 0; i < MAX_SFB_LONG; i++) {
+        /* mostly multiples of 4 like the real tables */
+        Word32 width = (random32() & 3) ? 4 * randomRange(1, 8) : randomRange(1, 32);
+        if (offset[i] + width > maxLines)
+            break;
+        offset[i + 1] = offset[i] + width;
+        n++;
+    }
+    *numBands = n;
+}
+
+static int checkBandEnergy(int iterations)
+{
+    Word32 left[FRAME_LEN_LONG], right[FRAME_LEN_LONG];
+    Word32 nrg[4][MAX_SFB_LONG], nrgSse2[4][MAX_SFB_LONG];
+    Word32 sum[2], sumSse2[2];
+    Word16 offset[MAX_SFB_LONG + 1];
+    Word16 numBands;
+    int64_t a, b, c;
+    int i, k;
+
+    for (i = 0; i < iterations; i++) {
+        for (k = 0; k < FRAME_LEN_LONG; k++) {
+            left[k] = randomLine();
+            right[k] = randomLine();
+        }
+        randomBands(offset, &numBands, FRAME_LEN_LONG);
+
+        memset(nrg, 0, sizeof(nrg));
+        memset(nrgSse2, 0, sizeof(nrgSse2));
+        CalcBandEnergy(left, offset, numBands, nrg[0], &sum[0]);
+        CalcBandEnergy_SSE2(left, offset, numBands, nrgSse2[0], &sumSse2[0]);
+        if (memcmp(nrg[0], nrgSse2[0], sizeof(nrg[0])) || sum[0] != sumSse2[0]) {
+            printf("CalcBandEnergy: FAILED at iteration %d\n", i);
+            return 1;
+        }
+        CalcBandEnergyMS(left, right, offset, numBands, nrg[1], &sum[0], nrg[2], &sum[1]);
+        CalcBandEnergyMS_SSE2(left, right, offset, numBands,
+                              nrgSse2[1], &sumSse2[0], nrgSse2[2], &sumSse2[1]);
+        if (memcmp(nrg, nrgSse2, sizeof(nrg)) || memcmp(sum, sumSse2, sizeof(sum))) {
+            printf("CalcBandEnergyMS: FAILED at iteration %d\n", i);
+            return 1;
+        }
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        CalcBandEnergyMS(left, right, offset, numBands, nrg[1], &sum[0], nrg[2], &sum[1]);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        CalcBandEnergyMS_SSE2(left, right, offset, numBands,
+                              nrgSse2[1], &sumSse2[0], nrgSse2[2], &sumSse2[1]);
+    c = nowNs();
+    printf("CalcBandEnergy(MS): ok, C %.1f ns SSE2 %.1f ns\n",
+           (double)(b - a) / iterations, (double)(c - b) / iterations);
+    return 0;
+}
+
+static int checkAutoCorrelation(int iterations)
+{
+    Word16 input[FRAME_LEN_LONG];
+    Word32 corr[TNS_MAX_ORDER + 1], corrSse2[TNS_MAX_ORDER + 1];
+    Word16 samples = 0, corrCoeff = 0;
+    int64_t a, b, c;
+    int i, k;
+
+    for (i = 0; i < iterations; i++) {
+        /* loud inputs take the C path in the SSE2 version */
+        Word32 shift = randomRange(0, 15);
+
+        samples = randomRange(TNS_MAX_ORDER + 1, FRAME_LEN_LONG);
+        corrCoeff = randomRange(1, TNS_MAX_ORDER + 1);
+        for (k = 0; k < samples; k++)
+            input[k] = (Word16)(random32() >> 16) >> shift;
+
+        memset(corr, 0, sizeof(corr));
+        memset(corrSse2, 0, sizeof(corrSse2));
+        AutoCorrelation(input, corr, samples, corrCoeff);
+        AutoCorrelation_SSE2(input, corrSse2, samples, corrCoeff);
+        if (memcmp(corr, corrSse2, sizeof(corr))) {
+            printf("AutoCorrelation: FAILED at iteration %d\n", i);
+            return 1;
+        }
+    }
+
+    for (k = 0; k < FRAME_LEN_LONG; k++)
+        input[k] = (Word16)(random32() >> 16) >> 4;
+    samples = FRAME_LEN_LONG / 2;
+    corrCoeff = TNS_MAX_ORDER + 1;
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        AutoCorrelation(input, corr, samples, corrCoeff);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        AutoCorrelation_SSE2(input, corrSse2, samples, corrCoeff);
+    c = nowNs();
+    printf("AutoCorrelation: ok, C %.1f ns SSE2 %.1f ns\n",
+           (double)(b - a) / iterations, (double)(c - b) / iterations);
+    return 0;
+}
+
+static int checkQuantize(int iterations)
+{
+    Word32 spec[FRAME_LEN_LONG];
+    Word16 offset[MAX_SFB_LONG + 1];
+    Word16 scf[MAX_SFB_LONG];
+    Word16 qua[FRAME_LEN_LONG], quaSse2[FRAME_LEN_LONG];
+    Word16 numBands = 0, globalGain = 0;
+    Word32 dist = 0, distSse2 = 0;
+    int64_t a, b, c;
+    int i, k;
+
+    for (i = 0; i < iterations; i++) {
+        for (k = 0; k < FRAME_LEN_LONG; k++)
+            spec[k] = randomLine();
+        randomBands(offset, &numBands, FRAME_LEN_LONG);
+        globalGain = randomRange(0, 255);
+        for (k = 0; k < numBands; k++) {
+            /* runs of equal scalefactors are quantized together */
+            scf[k] = (k && (random32() & 1)) ? scf[k - 1] : randomRange(-60, 255);
+        }
+
+        memset(qua, 0, sizeof(qua));
+        memset(quaSse2, 0, sizeof(quaSse2));
+        QuantizeSpectrum(numBands, numBands, numBands, offset, spec, globalGain, scf, qua);
+        QuantizeSpectrum_SSE2(numBands, numBands, numBands, offset, spec, globalGain, scf, quaSse2);
+        if (memcmp(qua, quaSse2, sizeof(qua))) {
+            printf("QuantizeSpectrum: FAILED at iteration %d\n", i);
+            return 1;
+        }
+
+        for (k = 0; k < numBands; k++) {
+            Word16 gain = globalGain - scf[k];
+            dist = calcSfbDist(spec + offset[k], offset[k + 1] - offset[k], gain);
+            distSse2 = calcSfbDist_SSE2(spec + offset[k], offset[k + 1] - offset[k], gain);
+            if (dist != distSse2) {
+                printf("calcSfbDist: FAILED at iteration %d\n", i);
+                return 1;
+            }
+        }
+    }
+
+    /* the encoder's spectra, against gains it would try */
+    for (k = 0; k < FRAME_LEN_LONG; k++)
+        spec[k] = random32() >> randomRange(8, 20);
+    for (k = 0; k < numBands; k++)
+        scf[k] = 60 + (k >> 2);
+    globalGain = 20;
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        QuantizeSpectrum(numBands, numBands, numBands, offset, spec, globalGain, scf, qua);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        QuantizeSpectrum_SSE2(numBands, numBands, numBands, offset, spec, globalGain, scf, quaSse2);
+    c = nowNs();
+    printf("QuantizeSpectrum: ok, C %.1f ns SSE2 %.1f ns\n",
+           (double)(b - a) / iterations, (double)(c - b) / iterations);
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        for (k = 0; k < numBands; k++)
+            dist += calcSfbDist(spec + offset[k], offset[k + 1] - offset[k], globalGain - scf[k]);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        for (k = 0; k < numBands; k++)
+            distSse2 += calcSfbDist_SSE2(spec + offset[k], offset[k + 1] - offset[k], globalGain - scf[k]);
+    c = nowNs();
+    printf("calcSfbDist x %d: ok, C %.1f ns SSE2 %.1f ns\n", numBands,
+           (double)(b - a) / iterations, (double)(c - b) / iterations);
+    return dist != distSse2;
+}
+
+#endif
+
+/* tones with a slow pan, noise and a click every half second for short blocks */
+static unsigned char *makeSignal(int seconds, long *size)
+{
+    static const double freqs[6] = { 110, 220, 330, 523, 1250, 4400 };
+    long n = 44100L * seconds;
+    short *pcm = (short *)malloc(n * 4);
+    uint32_t seed = 3;
+    long i;
+    int k;
+
+    for (i = 0; i < n; i++) {
+        double t = (double)i / 44100;
+        double env = 0.5 + 0.5 * sin(2 * M_PI * 0.3 * t);
+        double s = 0, noise, l, r;
+
+        for (k = 0; k < 6; k++)
+            s += sin(2 * M_PI * freqs[k] * t + k) / (k + 2);
+        seed = seed * 1103515245 + 12345;
+        noise = ((double)(seed >> 16) / 32768 - 1) * 0.05;
+        if (i % 22050 < 256)
+            s += noise * 40;
+        l = 0.4 * env * s + noise;
+        r = 0.4 * (1 - env) * s + noise * 0.5;
+        pcm[2 * i] = (short)(32000 * (l > 1 ? 1 : l < -1 ? -1 : l));
+        pcm[2 * i + 1] = (short)(32000 * (r > 1 ? 1 : r < -1 ? -1 : r));
+    }
+    *size = n * 4;
+    return (unsigned char *)pcm;
+}
+
+static int encode(const unsigned char *pcm, long size, int sampleRate, int bitRate, int repeat)
+{
+    VO_AUDIO_CODECAPI api;
+    VO_MEM_OPERATOR memOperator;
+    VO_CODEC_INIT_USERDATA userData;
+    static unsigned char outBuf[8192];
+    uint32_t checksum = 0;
+    long frames = 0;
+    int64_t elapsed = 0;
+    int r;
+
+    voGetAACEncAPI(&api);
+    memOperator.Alloc = cmnMemAlloc;
+    memOperator.Copy = cmnMemCopy;
+    memOperator.Free = cmnMemFree;
+    memOperator.Set = cmnMemSet;
+    memOperator.Check = cmnMemCheck;
+    userData.memflag = VO_IMF_USERMEMOPERATOR;
+    userData.memData = &memOperator;
+
+    for (r = 0; r < repeat; r++) {
+        VO_HANDLE handle;
+        AACENC_PARAM param;
+        long offset;
+
+        if (api.Init(&handle, VO_AUDIO_CodingAAC, &userData) != VO_ERR_NONE) {
+            printf("cannot create the encoder\n");
+            return 1;
+        }
+        param.adtsUsed = 1;
+        param.nChannels = 2;
+        param.sampleRate = sampleRate;
+        param.bitRate = bitRate;
+        if (api.SetParam(handle, VO_PID_AAC_ENCPARAM, &param) != VO_ERR_NONE) {
+            printf("cannot configure the encoder for %d Hz %d bps\n", sampleRate, bitRate);
+            api.Uninit(handle);
+            return 1;
+        }
+
+        for (offset = 0; offset + PCM_FRAME_BYTES <= size; offset += PCM_FRAME_BYTES) {
+            VO_CODECBUFFER in, out;
+            VO_AUDIO_OUTPUTINFO info;
+            int64_t start = nowNs();
+
+            in.Buffer = (unsigned char *)pcm + offset;
+            in.Length = PCM_FRAME_BYTES;
+            api.SetInputData(handle, &in);
+            out.Buffer = outBuf;
+            out.Length = sizeof(outBuf);
+            if (api.GetOutputData(handle, &out, &info) == VO_ERR_NONE) {
+                VO_U32 k;
+                elapsed += nowNs() - start;
+                frames++;
+                for (k = 0; r == 0 && k < out.Length; k++)
+                    checksum = checksum * 31 + out.Buffer[k];
+            }
+        }
+        api.Uninit(handle);
+    }
+
+    printf("%d Hz stereo %d bps: %ld frames, %.1f us/frame, %.1fx realtime, checksum %08x\n",
+           sampleRate, bitRate, frames, frames ? elapsed * 1e-3 / frames : 0.0,
+           elapsed ? (double)frames * 1024 / sampleRate / (elapsed * 1e-9) : 0.0, checksum);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int bitRate = 128000;
+    int seconds = 20;
+    int repeat = 1;
+    int failures = 0;
+    unsigned char *pcm;
+    long size;
+    int res;
+
+    while ((res = getopt(argc, argv, "b:n:r:")) >= 0) {
+        switch (res) {
+            case 'b':
+                bitRate = atoi(optarg);
+                break;
+            case 'n':
+                seconds = atoi(optarg);
+                break;
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            default:
+                printf("usage: %s [-b bitrate] [-n seconds] [-r repeat] [file.pcm]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (seconds < 1 || repeat < 1) {
+        printf("seconds and repeat must be at least 1\n");
+        return 1;
+    }
+
+#ifdef AACENC_SSE2
+    failures += checkBandEnergy(20000);
+    failures += checkAutoCorrelation(20000);
+    failures += checkQuantize(20000);
+#else
+    printf("built without AACENC_SSE2, no kernels to check\n");
+#endif
+
+    if (optind < argc) {
+        FILE *fp = fopen(argv[optind], "rb");
+        if (fp == NULL) {
+            printf("cannot open %s\n", argv[optind]);
+            return 1;
+        }
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        pcm = (unsigned char *)malloc(size);
+        if (fread(pcm, 1, size, fp) != (size_t)size) {
+            printf("cannot read %s\n", argv[optind]);
+            fclose(fp);
+            free(pcm);
+            return 1;
+        }
+        fclose(fp);
+    } else {
+        pcm = makeSignal(seconds, &size);
+    }
+
+    /* the same samples, played at either rate */
+    failures += encode(pcm, size, 44100, bitRate, repeat);
+    failures += encode(pcm, size, 48000, bitRate, repeat);
+    free(pcm);
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -6,6 +6,7 @@ LOCAL_SRC_FILES := \
  	src/agc.cpp \
  	src/amrdecode.cpp \
  	src/b_cn_cod.cpp \
+ 	src/batch_filt.cpp \
  	src/bgnscd.cpp \
  	src/c_g_aver.cpp \
  	src/d1035pf.cpp \
@@ -47,6 +48,18 @@ LOCAL_C_INCLUDES := \
 LOCAL_CFLAGS := \
         -DOSCL_UNUSED_ARG= -DOSCL_IMPORT_REF=
 
+# The synthesis and residual filters of the multi-channel batch decoder
+# (AMRDecodeBatch) are replaced by bit-exact SSE2 or NEON versions in
+# src/batch_filt.cpp.
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DAMRNBDEC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DAMRNBDEC_NEON
+endif
+
 LOCAL_MODULE := libstagefright_amrnbdec
 
 include $(BUILD_STATIC_LIBRARY)
@@ -79,3 +92,41 @@ LOCAL_MODULE := libstagefright_soft_amrdec
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
+
+################################################################################
+# test utility: checks the batch filters and AMRDecodeBatch against the
+# single channel decoder and prints how many channels one core decodes
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        test/amrdec_bench.cpp
+
+LOCAL_C_INCLUDES := \
+        frameworks/av/media/libstagefright/include \
+        $(LOCAL_PATH)/src \
+        $(LOCAL_PATH)/include \
+        $(LOCAL_PATH)/../common/include
+
+LOCAL_CFLAGS := \
+        -DOSCL_UNUSED_ARG= -DOSCL_IMPORT_REF=
+
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DAMRNBDEC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DAMRNBDEC_NEON
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+        libstagefright_amrnbdec
+
+LOCAL_SHARED_LIBRARIES := \
+        libstagefright_amrnb_common
+
+LOCAL_MODULE := amrdec_bench
+LOCAL_MODULE_TAGS := debug
+
+include $(BUILD_EXECUTABLE)
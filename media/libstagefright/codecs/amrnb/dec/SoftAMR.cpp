@@ -20,7 +20,6 @@
 
 #include "SoftAMR.h"
 
-#include "gsmamr_dec.h"
 #include "pvamrwbdecoder.h"
 
 #include <media/stagefright/foundation/ADebug.h>
@@ -43,9 +42,7 @@ SoftAMR::SoftAMR(
         OMX_COMPONENTTYPE **component)
     : SimpleSoftOMXComponent(name, callbacks, appData, component),
       mMode(MODE_NARROW),
-      mState(NULL),
-      mDecoderBuf(NULL),
-      mDecoderCookie(NULL),
+      mNumChannels(1),
       mInputBufferCount(0),
       mAnchorTimeUs(0),
       mNumSamplesOutput(0),
@@ -58,20 +55,11 @@ SoftAMR::SoftAMR(
     }
 
     initPorts();
-    CHECK_EQ(initDecoder(), (status_t)OK);
+    CHECK_EQ(initDecoder(mNumChannels), (status_t)OK);
 }
 
 SoftAMR::~SoftAMR() {
-    if (mMode == MODE_NARROW) {
-        GSMDecodeFrameExit(&mState);
-        mState = NULL;
-    } else {
-        free(mDecoderBuf);
-        mDecoderBuf = NULL;
-
-        mState = NULL;
-        mDecoderCookie = NULL;
-    }
+    deinitDecoder();
 }
 
 void SoftAMR::initPorts() {
@@ -123,23 +111,80 @@ void SoftAMR::initPorts() {
     addPort(def);
 }
 
-status_t SoftAMR::initDecoder() {
-    if (mMode == MODE_NARROW) {
-        Word16 err = GSMInitDecode(&mState, (Word8 *)"AMRNBDecoder");
+static size_t getFrameSize(unsigned FT);
+static size_t getFrameSizeNB(unsigned FT);
+
+void SoftAMR::updatePortSizes() {
+    size_t maxFrameSize =
+        (mMode == MODE_NARROW) ? getFrameSizeNB(7) : getFrameSize(8);
+
+    size_t inputSize = mNumChannels * maxFrameSize;
+    editPortInfo(0)->mDef.nBufferSize = (inputSize > 8192) ? inputSize : 8192;
+
+    editPortInfo(1)->mDef.nBufferSize =
+        mNumChannels
+            * (mMode == MODE_NARROW
+                    ? kNumSamplesPerFrameNB : kNumSamplesPerFrameWB)
+            * sizeof(int16_t);
+}
 
-        if (err != 0) {
-            return UNKNOWN_ERROR;
+status_t SoftAMR::initDecoder(size_t numChannels) {
+    for (size_t i = 0; i < numChannels; ++i) {
+        void *state = NULL;
+        void *decoderBuf = NULL;
+        int16_t *decoderCookie = NULL;
+
+        if (mMode == MODE_NARROW) {
+            Word16 err = GSMInitDecode(&state, (Word8 *)"AMRNBDecoder");
+
+            if (err != 0) {
+                deinitDecoder();
+                return UNKNOWN_ERROR;
+            }
+        } else {
+            int32_t memReq = pvDecoder_AmrWbMemRequirements();
+            decoderBuf = malloc(memReq);
+
+            if (decoderBuf == NULL) {
+                deinitDecoder();
+                return NO_MEMORY;
+            }
+
+            pvDecoder_AmrWb_Init(&state, decoderBuf, &decoderCookie);
         }
-    } else {
-        int32_t memReq = pvDecoder_AmrWbMemRequirements();
-        mDecoderBuf = malloc(memReq);
 
-        pvDecoder_AmrWb_Init(&mState, mDecoderBuf, &mDecoderCookie);
+        mStates.push(state);
+        mDecoderBufs.push(decoderBuf);
+        mDecoderCookies.push(decoderCookie);
     }
 
+    mFrameTypes.insertAt(AMR_NO_DATA, 0, numChannels);
+    mFramePtrs.insertAt(NULL, 0, numChannels);
+    mByteOffsets.insertAt(0, 0, numChannels);
+
+    mNumChannels = numChannels;
+
     return OK;
 }
 
+void SoftAMR::deinitDecoder() {
+    for (size_t i = 0; i < mStates.size(); ++i) {
+        if (mMode == MODE_NARROW) {
+            GSMDecodeFrameExit(&mStates.editItemAt(i));
+        } else {
+            free(mDecoderBufs[i]);
+        }
+    }
+
+    mStates.clear();
+    mDecoderBufs.clear();
+    mDecoderCookies.clear();
+
+    mFrameTypes.clear();
+    mFramePtrs.clear();
+    mByteOffsets.clear();
+}
+
 OMX_ERRORTYPE SoftAMR::internalGetParameter(
         OMX_INDEXTYPE index, OMX_PTR params) {
     switch (index) {
@@ -152,7 +197,7 @@ OMX_ERRORTYPE SoftAMR::internalGetParameter(
                 return OMX_ErrorUndefined;
             }
 
-            amrParams->nChannels = 1;
+            amrParams->nChannels = mNumChannels;
             amrParams->eAMRDTXMode = OMX_AUDIO_AMRDTXModeOff;
             amrParams->eAMRFrameFormat = OMX_AUDIO_AMRFrameFormatFSF;
 
@@ -178,10 +223,14 @@ OMX_ERRORTYPE SoftAMR::internalGetParameter(
                 return OMX_ErrorUndefined;
             }
 
-            pcmParams->nChannels = 1;
+            pcmParams->nChannels = mNumChannels;
             pcmParams->eNumData = OMX_NumericalDataSigned;
             pcmParams->eEndian = OMX_EndianBig;
-            pcmParams->bInterleaved = OMX_TRUE;
+
+            // The frames of the channels follow each other.
+            pcmParams->bInterleaved =
+                (mNumChannels > 1) ? OMX_FALSE : OMX_TRUE;
+
             pcmParams->nBitPerSample = 16;
 
             pcmParams->nSamplingRate =
@@ -233,6 +282,26 @@ OMX_ERRORTYPE SoftAMR::internalSetParameter(
                 return OMX_ErrorUndefined;
             }
 
+            if (aacParams->nChannels < 1
+                    || aacParams->nChannels > kMaxChannels) {
+                return OMX_ErrorUndefined;
+            }
+
+            if (aacParams->nChannels != mNumChannels) {
+                deinitDecoder();
+
+                if (initDecoder(aacParams->nChannels) != OK) {
+                    ALOGE("failed to initialize %lu channels",
+                          aacParams->nChannels);
+
+                    CHECK_EQ(initDecoder(1), (status_t)OK);
+                    updatePortSizes();
+                    return OMX_ErrorInsufficientResources;
+                }
+
+                updatePortSizes();
+            }
+
             return OMX_ErrorNone;
         }
 
@@ -274,6 +343,141 @@ static size_t getFrameSize(unsigned FT) {
     return frameSize;
 }
 
+// Size of a storage format AMR-NB frame, header byte included, 0 for the
+// frame types the decoder rejects.
+static size_t getFrameSizeNB(unsigned FT) {
+    static const size_t kFrameSizeNB[9] = {
+        12, 13, 15, 17, 19, 20, 26, 31, 5
+    };
+
+    if (FT == AMR_NO_DATA) {
+        return 1;
+    } else if (FT >= 9) {
+        return 0;
+    }
+
+    return kFrameSizeNB[FT] + 1;
+}
+
+int32_t SoftAMR::decodeFrameWB(
+        size_t channel, const uint8_t *inputPtr, size_t size,
+        int16_t *outPtr) {
+    int16 mode = ((inputPtr[0] >> 3) & 0x0f);
+
+    if (mode >= 10 && mode <= 13) {
+        ALOGE("encountered illegal frame type %d in AMR WB content.",
+              mode);
+
+        return -1;
+    }
+
+    size_t frameSize = getFrameSize(mode);
+    if (size < frameSize) {
+        ALOGE("Filled length vs frameSize %d vs %d. Corrupt clip?",
+           size, frameSize);
+
+        return -1;
+    }
+
+    if (mode >= 9) {
+        // Produce silence instead of comfort noise and for
+        // speech lost/no data.
+        memset(outPtr, 0, kNumSamplesPerFrameWB * sizeof(int16_t));
+    } else if (mode < 9) {
+        int16 frameType;
+        RX_State_wb rx_state;
+        mime_unsorting(
+                const_cast<uint8_t *>(&inputPtr[1]),
+                mInputSampleBuffer,
+                &frameType, &mode, 1, &rx_state);
+
+        int16_t numSamplesOutput;
+        pvDecoder_AmrWb(
+                mode, mInputSampleBuffer,
+                outPtr,
+                &numSamplesOutput,
+                mDecoderBufs[channel], frameType, mDecoderCookies[channel]);
+
+        CHECK_EQ((int)numSamplesOutput, (int)kNumSamplesPerFrameWB);
+
+        for (int i = 0; i < kNumSamplesPerFrameWB; ++i) {
+            /* Delete the 2 LSBs (14-bit output) */
+            outPtr[i] &= 0xfffC;
+        }
+    }
+
+    return frameSize;
+}
+
+// Decodes one frame of each channel, returns the number of bytes read or -1.
+int32_t SoftAMR::decodeBatch(
+        const uint8_t *inputPtr, size_t size, int16_t *outPtr) {
+    size_t offset = 0;
+
+    if (mMode == MODE_WIDE) {
+        for (size_t c = 0; c < mNumChannels; ++c) {
+            if (offset >= size) {
+                ALOGE("input buffer holds fewer than %d frames", mNumChannels);
+                return -1;
+            }
+
+            int32_t numBytesRead =
+                decodeFrameWB(
+                        c, inputPtr + offset, size - offset,
+                        outPtr + c * kNumSamplesPerFrameWB);
+
+            if (numBytesRead < 0) {
+                return -1;
+            }
+
+            offset += numBytesRead;
+        }
+
+        return offset;
+    }
+
+    for (size_t c = 0; c < mNumChannels; ++c) {
+        if (offset >= size) {
+            ALOGE("input buffer holds fewer than %d frames", mNumChannels);
+            return -1;
+        }
+
+        unsigned FT = (inputPtr[offset] >> 3) & 0x0f;
+        size_t frameSize = getFrameSizeNB(FT);
+
+        if (frameSize == 0) {
+            ALOGE("encountered illegal frame type %d in AMR NB content.", FT);
+            return -1;
+        }
+
+        if (offset + frameSize > size) {
+            ALOGE("Filled length vs frameSize %d vs %d. Corrupt clip?",
+                  size - offset, frameSize);
+            return -1;
+        }
+
+        mFrameTypes.editItemAt(c) = (Frame_Type_3GPP)FT;
+        mFramePtrs.editItemAt(c) = (UWord8 *)&inputPtr[offset + 1];
+
+        offset += frameSize;
+    }
+
+    AMRDecodeBatch(
+            mStates.editArray(), mNumChannels,
+            mFrameTypes.editArray(), mFramePtrs.editArray(),
+            outPtr, MIME_IETF, mByteOffsets.editArray());
+
+    for (size_t c = 0; c < mNumChannels; ++c) {
+        if (mByteOffsets[c] == -1) {
+            ALOGE("PV AMR decoder AMRDecodeBatch() call failed on channel %d",
+                  c);
+            return -1;
+        }
+    }
+
+    return offset;
+}
+
 void SoftAMR::onQueueFilled(OMX_U32 portIndex) {
     List<BufferInfo *> &inQueue = getPortQueue(0);
     List<BufferInfo *> &outQueue = getPortQueue(1);
@@ -311,9 +515,37 @@ void SoftAMR::onQueueFilled(OMX_U32 portIndex) {
         const uint8_t *inputPtr = inHeader->pBuffer + inHeader->nOffset;
         int32_t numBytesRead;
 
-        if (mMode == MODE_NARROW) {
+        size_t outputSize =
+            mNumChannels
+                * (mMode == MODE_NARROW
+                        ? kNumSamplesPerFrameNB : kNumSamplesPerFrameWB)
+                * sizeof(int16_t);
+
+        if (outHeader->nAllocLen < outputSize) {
+            ALOGE("output buffer too small: %lu < %d",
+                  outHeader->nAllocLen, outputSize);
+
+            notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
+            mSignalledError = true;
+
+            return;
+        }
+
+        if (mNumChannels > 1) {
+            numBytesRead =
+                decodeBatch(
+                        inputPtr, inHeader->nFilledLen,
+                        reinterpret_cast<int16_t *>(outHeader->pBuffer));
+
+            if (numBytesRead == -1) {
+                notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
+                mSignalledError = true;
+
+                return;
+            }
+        } else if (mMode == MODE_NARROW) {
             numBytesRead =
-                AMRDecode(mState,
+                AMRDecode(mStates[0],
                   (Frame_Type_3GPP)((inputPtr[0] >> 3) & 0x0f),
                   (UWord8 *)&inputPtr[1],
                   reinterpret_cast<int16_t *>(outHeader->pBuffer),
@@ -339,58 +571,16 @@ void SoftAMR::onQueueFilled(OMX_U32 portIndex) {
                 return;
             }
         } else {
-            int16 mode = ((inputPtr[0] >> 3) & 0x0f);
-
-            if (mode >= 10 && mode <= 13) {
-                ALOGE("encountered illegal frame type %d in AMR WB content.",
-                      mode);
-
-                notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
-                mSignalledError = true;
-
-                return;
-            }
-
-            size_t frameSize = getFrameSize(mode);
-            if (inHeader->nFilledLen < frameSize) {
-                ALOGE("Filled length vs frameSize %d vs %d. Corrupt clip?",
-                   inHeader->nFilledLen, frameSize);
+            numBytesRead =
+                decodeFrameWB(
+                        0, inputPtr, inHeader->nFilledLen,
+                        (int16_t *)outHeader->pBuffer);
 
+            if (numBytesRead == -1) {
                 notify(OMX_EventError, OMX_ErrorUndefined, 0, NULL);
                 mSignalledError = true;
                 return;
             }
-
-            int16_t *outPtr = (int16_t *)outHeader->pBuffer;
-
-            if (mode >= 9) {
-                // Produce silence instead of comfort noise and for
-                // speech lost/no data.
-                memset(outPtr, 0, kNumSamplesPerFrameWB * sizeof(int16_t));
-            } else if (mode < 9) {
-                int16 frameType;
-                RX_State_wb rx_state;
-                mime_unsorting(
-                        const_cast<uint8_t *>(&inputPtr[1]),
-                        mInputSampleBuffer,
-                        &frameType, &mode, 1, &rx_state);
-
-                int16_t numSamplesOutput;
-                pvDecoder_AmrWb(
-                        mode, mInputSampleBuffer,
-                        outPtr,
-                        &numSamplesOutput,
-                        mDecoderBuf, frameType, mDecoderCookie);
-
-                CHECK_EQ((int)numSamplesOutput, (int)kNumSamplesPerFrameWB);
-
-                for (int i = 0; i < kNumSamplesPerFrameWB; ++i) {
-                    /* Delete the 2 LSBs (14-bit output) */
-                    outPtr[i] &= 0xfffC;
-                }
-            }
-
-            numBytesRead = frameSize;
         }
 
         inHeader->nOffset += numBytesRead;
@@ -400,7 +590,8 @@ void SoftAMR::onQueueFilled(OMX_U32 portIndex) {
         outHeader->nOffset = 0;
 
         if (mMode == MODE_NARROW) {
-            outHeader->nFilledLen = kNumSamplesPerFrameNB * sizeof(int16_t);
+            outHeader->nFilledLen =
+                mNumChannels * kNumSamplesPerFrameNB * sizeof(int16_t);
 
             outHeader->nTimeStamp =
                 mAnchorTimeUs
@@ -408,7 +599,8 @@ void SoftAMR::onQueueFilled(OMX_U32 portIndex) {
 
             mNumSamplesOutput += kNumSamplesPerFrameNB;
         } else {
-            outHeader->nFilledLen = kNumSamplesPerFrameWB * sizeof(int16_t);
+            outHeader->nFilledLen =
+                mNumChannels * kNumSamplesPerFrameWB * sizeof(int16_t);
 
             outHeader->nTimeStamp =
                 mAnchorTimeUs
@@ -438,10 +630,12 @@ void SoftAMR::onQueueFilled(OMX_U32 portIndex) {
 void SoftAMR::onPortFlushCompleted(OMX_U32 portIndex) {
         ALOGE("onPortFlushCompleted portindex %d, resetting frame ",portIndex);
         if(portIndex == 0) {
-           if(mMode == MODE_NARROW)
-              Speech_Decode_Frame_reset(mState);
-           else
-              pvDecoder_AmrWb_Reset(mState, 0);
+           for (size_t i = 0; i < mStates.size(); ++i) {
+              if(mMode == MODE_NARROW)
+                 Speech_Decode_Frame_reset(mStates[i]);
+              else
+                 pvDecoder_AmrWb_Reset(mStates[i], 0);
+           }
         }
 }
 
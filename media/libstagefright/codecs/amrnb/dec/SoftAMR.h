@@ -20,6 +20,8 @@
 
 #include "SimpleSoftOMXComponent.h"
 
+#include "gsmamr_dec.h"
+
 namespace android {
 
 struct SoftAMR : public SimpleSoftOMXComponent {
@@ -48,6 +50,7 @@ private:
         kSampleRateWB           = 16000,
         kNumSamplesPerFrameNB   = 160,
         kNumSamplesPerFrameWB   = 320,
+        kMaxChannels            = 1024,
     };
 
     enum {
@@ -56,9 +59,18 @@ private:
 
     } mMode;
 
-    void *mState;
-    void *mDecoderBuf;
-    int16_t *mDecoderCookie;
+    // With more than one channel (nChannels of OMX_IndexParamAudioAmr), each
+    // input buffer holds one frame of each of mNumChannels independent mono
+    // streams, and each output buffer the decoded frames one after the other.
+    size_t mNumChannels;
+
+    Vector<void *> mStates;
+    Vector<void *> mDecoderBufs;
+    Vector<int16_t *> mDecoderCookies;
+
+    Vector<Frame_Type_3GPP> mFrameTypes;
+    Vector<UWord8 *> mFramePtrs;
+    Vector<Word16> mByteOffsets;
 
     size_t mInputBufferCount;
     int64_t mAnchorTimeUs;
@@ -75,9 +87,18 @@ private:
     int16_t mInputSampleBuffer[477];
 
     void initPorts();
-    status_t initDecoder();
+    void updatePortSizes();
+    status_t initDecoder(size_t numChannels);
+    void deinitDecoder();
     bool isConfigured() const;
 
+    int32_t decodeFrameWB(
+            size_t channel, const uint8_t *inputPtr, size_t size,
+            int16_t *outPtr);
+
+    int32_t decodeBatch(
+            const uint8_t *inputPtr, size_t size, int16_t *outPtr);
+
     DISALLOW_EVIL_CONSTRUCTORS(SoftAMR);
 };
 
@@ -105,6 +105,7 @@ terms listed above has been obtained from the copyright holder.
 #include "wmf_to_ets.h"
 #include "if2_to_ets.h"
 #include "frame_type_3gpp.h"
+#include "batch_filt.h"
 
 /*----------------------------------------------------------------------------
 ; MACROS
@@ -129,6 +130,137 @@ terms listed above has been obtained from the copyright holder.
 ; Variable declaration - defined here and used outside this module
 ----------------------------------------------------------------------------*/
 
+/*
+ * Converts the input frame to ETS format into dec_ets_input_bfr and finds
+ * its AMR mode and RX frame type. Returns the address offset of the next
+ * frame, -1 if the frame type or the input format is invalid.
+ */
+static Word16 AMRDecodeInput(
+    Speech_Decode_FrameState  *decoder_state,
+    enum Frame_Type_3GPP      frame_type,
+    UWord8                    *speech_bits_ptr,
+    bitstream_format          input_format,
+    Word16                    dec_ets_input_bfr[],
+    enum Mode                 *mode,
+    enum RXFrameType          *rx_type
+)
+{
+    Word16 *ets_word_ptr;
+    int modeStore;
+    int tempInt;
+    Word16 i;
+    Word16 byte_offset = -1;
+
+    /* Determine type of de-formatting */
+    /* WMF or IF2 frames */
+    if ((input_format == MIME_IETF) | (input_format == IF2))
+    {
+        if (input_format == MIME_IETF)
+        {
+            /* Convert incoming packetized raw WMF data to ETS format */
+            wmf_to_ets(frame_type, speech_bits_ptr, dec_ets_input_bfr);
+
+            /* Address offset of the start of next frame */
+            byte_offset = WmfDecBytesPerFrame[frame_type];
+        }
+        else   /* else has to be input_format  IF2 */
+        {
+            /* Convert incoming packetized raw IF2 data to ETS format */
+            if2_to_ets(frame_type, speech_bits_ptr, dec_ets_input_bfr);
+
+            /* Address offset of the start of next frame */
+            byte_offset = If2DecBytesPerFrame[frame_type];
+        }
+
+        /* At this point, input data is in ETS format     */
+        /* Determine AMR codec mode and AMR RX frame type */
+        if (frame_type <= AMR_122)
+        {
+            *mode = (enum Mode) frame_type;
+            *rx_type = RX_SPEECH_GOOD;
+        }
+        else if (frame_type == AMR_SID)
+        {
+            /* Clear mode store prior to reading mode info from input buffer */
+            modeStore = 0;
+
+            for (i = 0; i < NUM_AMRSID_RXMODE_BITS; i++)
+            {
+                tempInt = dec_ets_input_bfr[AMRSID_RXMODE_BIT_OFFSET+i] << i;
+                modeStore |= tempInt;
+            }
+            *mode = (enum Mode) modeStore;
+
+            /* Get RX frame type */
+            if (dec_ets_input_bfr[AMRSID_RXTYPE_BIT_OFFSET] == 0)
+            {
+                *rx_type = RX_SID_FIRST;
+            }
+            else
+            {
+                *rx_type = RX_SID_UPDATE;
+            }
+        }
+        else if (frame_type < AMR_NO_DATA)
+        {
+            /* Invalid frame_type, return error code */
+            byte_offset = -1;   /*  !!! */
+        }
+        else
+        {
+            *mode = decoder_state->prev_mode;
+
+            /*
+             * RX_NO_DATA, generate exponential decay from latest valid frame for the first 6 frames
+             * after that, create silent frames
+             */
+            *rx_type = RX_NO_DATA;
+
+        }
+
+    }
+
+    /* ETS frames */
+    else if (input_format == ETS)
+    {
+        /* Change type of pointer to incoming raw ETS data */
+        ets_word_ptr = (Word16 *) speech_bits_ptr;
+
+        /* Get RX frame type */
+        *rx_type = (enum RXFrameType) * ets_word_ptr;
+        ets_word_ptr++;
+
+        /* Copy incoming raw ETS data to dec_ets_input_bfr */
+        for (i = 0; i < MAX_SERIAL_SIZE; i++)
+        {
+            dec_ets_input_bfr[i] = *ets_word_ptr;
+            ets_word_ptr++;
+        }
+
+        /* Get codec mode */
+        if (*rx_type != RX_NO_DATA)
+        {
+            /* Get mode from input bitstream */
+            *mode = (enum Mode) * ets_word_ptr;
+        }
+        else
+        {
+            /* Use previous mode if no received data */
+            *mode = decoder_state->prev_mode;
+        }
+
+        /* Set up byte_offset */
+        byte_offset = 2 * (MAX_SERIAL_SIZE + 2);
+    }
+    else
+    {
+        /* Invalid input format, return error code */
+        byte_offset = -1;
+    }
+
+    return (byte_offset);
+}
+
 /*
 ------------------------------------------------------------------------------
  FUNCTION NAME: AMRDecode
@@ -393,14 +525,10 @@ Word16 AMRDecode(
     bitstream_format          input_format
 )
 {
-    Word16 *ets_word_ptr;
     enum Mode mode = (enum Mode)MR475;
-    int modeStore;
-    int tempInt;
     enum RXFrameType rx_type = RX_NO_DATA;
     Word16 dec_ets_input_bfr[MAX_SERIAL_SIZE];
-    Word16 i;
-    Word16 byte_offset = -1;
+    Word16 byte_offset;
 
     /* Type cast state_data to Speech_Decode_FrameState rather than passing
      * that structure type to this function so the structure make up can't
@@ -409,112 +537,9 @@ Word16 AMRDecode(
     Speech_Decode_FrameState *decoder_state
     = (Speech_Decode_FrameState *) state_data;
 
-    /* Determine type of de-formatting */
-    /* WMF or IF2 frames */
-    if ((input_format == MIME_IETF) | (input_format == IF2))
-    {
-        if (input_format == MIME_IETF)
-        {
-            /* Convert incoming packetized raw WMF data to ETS format */
-            wmf_to_ets(frame_type, speech_bits_ptr, dec_ets_input_bfr);
-
-            /* Address offset of the start of next frame */
-            byte_offset = WmfDecBytesPerFrame[frame_type];
-        }
-        else   /* else has to be input_format  IF2 */
-        {
-            /* Convert incoming packetized raw IF2 data to ETS format */
-            if2_to_ets(frame_type, speech_bits_ptr, dec_ets_input_bfr);
-
-            /* Address offset of the start of next frame */
-            byte_offset = If2DecBytesPerFrame[frame_type];
-        }
-
-        /* At this point, input data is in ETS format     */
-        /* Determine AMR codec mode and AMR RX frame type */
-        if (frame_type <= AMR_122)
-        {
-            mode = (enum Mode) frame_type;
-            rx_type = RX_SPEECH_GOOD;
-        }
-        else if (frame_type == AMR_SID)
-        {
-            /* Clear mode store prior to reading mode info from input buffer */
-            modeStore = 0;
-
-            for (i = 0; i < NUM_AMRSID_RXMODE_BITS; i++)
-            {
-                tempInt = dec_ets_input_bfr[AMRSID_RXMODE_BIT_OFFSET+i] << i;
-                modeStore |= tempInt;
-            }
-            mode = (enum Mode) modeStore;
-
-            /* Get RX frame type */
-            if (dec_ets_input_bfr[AMRSID_RXTYPE_BIT_OFFSET] == 0)
-            {
-                rx_type = RX_SID_FIRST;
-            }
-            else
-            {
-                rx_type = RX_SID_UPDATE;
-            }
-        }
-        else if (frame_type < AMR_NO_DATA)
-        {
-            /* Invalid frame_type, return error code */
-            byte_offset = -1;   /*  !!! */
-        }
-        else
-        {
-            mode = decoder_state->prev_mode;
-
-            /*
-             * RX_NO_DATA, generate exponential decay from latest valid frame for the first 6 frames
-             * after that, create silent frames
-             */
-            rx_type = RX_NO_DATA;
-
-        }
-
-    }
-
-    /* ETS frames */
-    else if (input_format == ETS)
-    {
-        /* Change type of pointer to incoming raw ETS data */
-        ets_word_ptr = (Word16 *) speech_bits_ptr;
-
-        /* Get RX frame type */
-        rx_type = (enum RXFrameType) * ets_word_ptr;
-        ets_word_ptr++;
-
-        /* Copy incoming raw ETS data to dec_ets_input_bfr */
-        for (i = 0; i < MAX_SERIAL_SIZE; i++)
-        {
-            dec_ets_input_bfr[i] = *ets_word_ptr;
-            ets_word_ptr++;
-        }
-
-        /* Get codec mode */
-        if (rx_type != RX_NO_DATA)
-        {
-            /* Get mode from input bitstream */
-            mode = (enum Mode) * ets_word_ptr;
-        }
-        else
-        {
-            /* Use previous mode if no received data */
-            mode = decoder_state->prev_mode;
-        }
-
-        /* Set up byte_offset */
-        byte_offset = 2 * (MAX_SERIAL_SIZE + 2);
-    }
-    else
-    {
-        /* Invalid input format, return error code */
-        byte_offset = -1;
-    }
+    byte_offset = AMRDecodeInput(decoder_state, frame_type, speech_bits_ptr,
+                                 input_format, dec_ets_input_bfr,
+                                 &mode, &rx_type);
 
     /* Proceed with decoding frame, if there are no errors */
     if (byte_offset != -1)
@@ -540,5 +565,87 @@ Word16 AMRDecode(
     return (byte_offset);
 }
 
+/*
+------------------------------------------------------------------------------
+ FUNCTION NAME: AMRDecodeBatch
+------------------------------------------------------------------------------
+ INPUT AND OUTPUT DEFINITIONS
+
+ Inputs:
+    state_data = states of the num_channels channels, from GSMInitDecode
+    num_channels = number of channels
+    frame_type = frame type of the frame of each channel
+    speech_bits_ptr = raw data of the frame of each channel
+    raw_pcm_buffer = L_FRAME output samples for each channel, channel c
+                     starting at raw_pcm_buffer[c * L_FRAME]
+    input_format = input format of all the frames
+    byte_offset = AMRDecode() return value of each channel
+
+ Outputs:
+    raw_pcm_buffer contains the decoded speech of the channels whose
+    byte_offset is not -1, the samples of the other channels are unchanged
+
+------------------------------------------------------------------------------
+ FUNCTION DESCRIPTION
+
+ Decodes one frame of each of num_channels independent channels, as
+ AMRDecode() does for each of them, with the filters of the synthesis and of
+ the post-filter running on several channels at once (GSMFrameDecodeBatch).
+
+------------------------------------------------------------------------------
+*/
+
+void AMRDecodeBatch(
+    void                      *state_data[],
+    Word16                    num_channels,
+    enum Frame_Type_3GPP      frame_type[],
+    UWord8                    *speech_bits_ptr[],
+    Word16                    *raw_pcm_buffer,
+    bitstream_format          input_format,
+    Word16                    byte_offset[]
+)
+{
+    Speech_Decode_FrameState *decoder_state[AMR_BATCH_LANES];
+    enum Mode mode[AMR_BATCH_LANES];
+    enum RXFrameType rx_type[AMR_BATCH_LANES];
+    Word16 dec_ets_input_bfr[AMR_BATCH_LANES][MAX_SERIAL_SIZE];
+    Word16 *serial[AMR_BATCH_LANES];
+    Word16 *pcm[AMR_BATCH_LANES];
+    Word16 c;
+    Word16 i;
+    Word16 n = 0;
+
+    for (c = 0; c < num_channels; c++)
+    {
+        decoder_state[n] = (Speech_Decode_FrameState *) state_data[c];
+        mode[n] = (enum Mode)MR475;
+        rx_type[n] = RX_NO_DATA;
 
+        byte_offset[c] = AMRDecodeInput(decoder_state[n], frame_type[c],
+                                        speech_bits_ptr[c], input_format,
+                                        dec_ets_input_bfr[n],
+                                        &mode[n], &rx_type[n]);
 
+        if (byte_offset[c] != -1)
+        {
+            serial[n] = dec_ets_input_bfr[n];
+            pcm[n] = raw_pcm_buffer + c * L_FRAME;
+            n++;
+        }
+
+        if (n == AMR_BATCH_LANES || (n > 0 && c == num_channels - 1))
+        {
+            /* Decode a 20 ms frame of each channel */
+            GSMFrameDecodeBatch(decoder_state, mode, serial, rx_type, pcm, n);
+
+            /* Save mode for next frame */
+            for (i = 0; i < n; i++)
+            {
+                decoder_state[i]->prev_mode = mode[i];
+            }
+            n = 0;
+        }
+    }
+
+    return;
+}
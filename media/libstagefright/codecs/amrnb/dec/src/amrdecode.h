@@ -158,6 +158,16 @@ extern "C"
         bitstream_format input_format
     );
 
+    void AMRDecodeBatch(
+        void *state_data[],
+        Word16 num_channels,
+        enum Frame_Type_3GPP frame_type[],
+        UWord8 *speech_bits_ptr[],
+        Word16 *raw_pcm_buffer,
+        bitstream_format input_format,
+        Word16 byte_offset[]
+    );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,361 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+
+
+
+ Filename: /audio/gsm_amr/c/src/batch_filt.cpp
+
+------------------------------------------------------------------------------
+ MODULE DESCRIPTION
+
+ Syn_filt() and Residu() over AMR_BATCH_LANES channels stored structure of
+ arrays, see batch_filt.h.
+
+ Like the single channel versions, the sums wrap around and are rounded by
+ adding 0x800 before the shift by 12. Syn_filt() saturates the output to
+ 16 bits, Residu() truncates it.
+
+ The SSE2 versions feed _mm_madd_epi16() with pairs of consecutive samples
+ of a lane and the matching pairs of coefficients, so that one madd gives two
+ taps of four lanes. The x * a[0] term and the rounding constant are one more
+ pair, (x, 1) * (a[0], 0x800). The pairs of past samples are kept, each one
+ being used by M/2 outputs.
+
+------------------------------------------------------------------------------
+*/
+
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+#if defined(AMRNBDEC_SSE2)
+#include <emmintrin.h>
+#elif defined(AMRNBDEC_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "batch_filt.h"
+#include "basic_op.h"
+
+/*----------------------------------------------------------------------------
+; DEFINES
+----------------------------------------------------------------------------*/
+#define LANES AMR_BATCH_LANES
+
+/*----------------------------------------------------------------------------
+; FUNCTION CODE
+----------------------------------------------------------------------------*/
+void Syn_filt_batch(
+    Word16 a[],
+    Word16 x[],
+    Word16 y[],
+    Word16 lg)
+{
+    Word16 i, j, l;
+    Word32 s;
+
+    for (i = 0; i < lg; i++)
+    {
+        for (l = 0; l < LANES; l++)
+        {
+            s = amrnb_fxp_mac_16_by_16bb((Word32) x[i * LANES + l],
+                                         (Word32) a[l], 0x00000800L);
+
+            for (j = 1; j <= M; j++)
+            {
+                s = amrnb_fxp_msu_16_by_16bb((Word32) a[j * LANES + l],
+                                             (Word32) y[(i - j) * LANES + l], s);
+            }
+
+            s >>= 12;
+
+            if (s > MAX_16)
+            {
+                s = MAX_16;
+            }
+            else if (s < MIN_16)
+            {
+                s = MIN_16;
+            }
+            y[i * LANES + l] = (Word16) s;
+        }
+    }
+
+    return;
+}
+
+void Residu_batch(
+    Word16 a[],
+    Word16 x[],
+    Word16 y[],
+    Word16 lg)
+{
+    Word16 i, j, l;
+    Word32 s;
+
+    for (i = 0; i < lg; i++)
+    {
+        for (l = 0; l < LANES; l++)
+        {
+            s = 0x00000800L;
+
+            for (j = 0; j <= M; j++)
+            {
+                s = amrnb_fxp_mac_16_by_16bb((Word32) a[j * LANES + l],
+                                             (Word32) x[(i - j) * LANES + l], s);
+            }
+
+            y[i * LANES + l] = (Word16)(s >> 12);
+        }
+    }
+
+    return;
+}
+
+#if defined(AMRNBDEC_SSE2)
+
+#define LOAD(p)     _mm_loadu_si128((const __m128i *)(p))
+#define STORE(p, v) _mm_storeu_si128((__m128i *)(p), v)
+
+void Syn_filt_batch_SSE2(
+    Word16 a[],
+    Word16 x[],
+    Word16 y[],
+    Word16 lg)
+{
+    /* (a[2m+1], a[2m+2]) and (y[k], y[k-1]) for lanes 0..3 and 4..7 */
+    __m128i coef_lo[M / 2];
+    __m128i coef_hi[M / 2];
+    __m128i pair_lo[M + L_FRAME];
+    __m128i pair_hi[M + L_FRAME];
+    __m128i a0_lo;
+    __m128i a0_hi;
+    __m128i prev;
+    __m128i v;
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i round = _mm_set1_epi16(0x0800);
+    Word16 i, m;
+
+    v = LOAD(a);
+    a0_lo = _mm_unpacklo_epi16(v, round);
+    a0_hi = _mm_unpackhi_epi16(v, round);
+
+    for (m = 0; m < M / 2; m++)
+    {
+        __m128i c1 = LOAD(&a[(2 * m + 1) * LANES]);
+        __m128i c2 = LOAD(&a[(2 * m + 2) * LANES]);
+
+        coef_lo[m] = _mm_unpacklo_epi16(c1, c2);
+        coef_hi[m] = _mm_unpackhi_epi16(c1, c2);
+    }
+
+    /* pairs of the filter memory, pair_x[M + k] is (y[k], y[k-1]) */
+    prev = LOAD(&y[-M * LANES]);
+    for (i = 1 - M; i < 0; i++)
+    {
+        v = LOAD(&y[i * LANES]);
+        pair_lo[M + i] = _mm_unpacklo_epi16(v, prev);
+        pair_hi[M + i] = _mm_unpackhi_epi16(v, prev);
+        prev = v;
+    }
+
+    for (i = 0; i < lg; i++)
+    {
+        __m128i s_lo;
+        __m128i s_hi;
+        __m128i acc_lo;
+        __m128i acc_hi;
+
+        v = LOAD(&x[i * LANES]);
+        s_lo = _mm_madd_epi16(_mm_unpacklo_epi16(v, one), a0_lo);
+        s_hi = _mm_madd_epi16(_mm_unpackhi_epi16(v, one), a0_hi);
+
+        acc_lo = _mm_madd_epi16(pair_lo[M + i - 1], coef_lo[0]);
+        acc_hi = _mm_madd_epi16(pair_hi[M + i - 1], coef_hi[0]);
+        for (m = 1; m < M / 2; m++)
+        {
+            acc_lo = _mm_add_epi32(acc_lo, _mm_madd_epi16(pair_lo[M + i - 1 - 2 * m], coef_lo[m]));
+            acc_hi = _mm_add_epi32(acc_hi, _mm_madd_epi16(pair_hi[M + i - 1 - 2 * m], coef_hi[m]));
+        }
+
+        s_lo = _mm_srai_epi32(_mm_sub_epi32(s_lo, acc_lo), 12);
+        s_hi = _mm_srai_epi32(_mm_sub_epi32(s_hi, acc_hi), 12);
+
+        /* packs saturates to MIN_16..MAX_16 as Syn_filt() does */
+        v = _mm_packs_epi32(s_lo, s_hi);
+        STORE(&y[i * LANES], v);
+
+        pair_lo[M + i] = _mm_unpacklo_epi16(v, prev);
+        pair_hi[M + i] = _mm_unpackhi_epi16(v, prev);
+        prev = v;
+    }
+
+    return;
+}
+
+void Residu_batch_SSE2(
+    Word16 a[],
+    Word16 x[],
+    Word16 y[],
+    Word16 lg)
+{
+    /* (a[2m], a[2m+1]) and (x[k], x[k-1]) for lanes 0..3 and 4..7 */
+    __m128i coef_lo[M / 2];
+    __m128i coef_hi[M / 2];
+    __m128i pair_lo[M + L_FRAME];
+    __m128i pair_hi[M + L_FRAME];
+    __m128i aM_lo;
+    __m128i aM_hi;
+    __m128i prev;
+    __m128i v;
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i round = _mm_set1_epi16(0x0800);
+    Word16 i, m;
+
+    for (m = 0; m < M / 2; m++)
+    {
+        __m128i c1 = LOAD(&a[(2 * m) * LANES]);
+        __m128i c2 = LOAD(&a[(2 * m + 1) * LANES]);
+
+        coef_lo[m] = _mm_unpacklo_epi16(c1, c2);
+        coef_hi[m] = _mm_unpackhi_epi16(c1, c2);
+    }
+
+    v = LOAD(&a[M * LANES]);
+    aM_lo = _mm_unpacklo_epi16(v, round);
+    aM_hi = _mm_unpackhi_epi16(v, round);
+
+    /* pair_x[M + k] is (x[k], x[k-1]) */
+    prev = LOAD(&x[-M * LANES]);
+    for (i = 1 - M; i < lg; i++)
+    {
+        v = LOAD(&x[i * LANES]);
+        pair_lo[M + i] = _mm_unpacklo_epi16(v, prev);
+        pair_hi[M + i] = _mm_unpackhi_epi16(v, prev);
+        prev = v;
+    }
+
+    for (i = 0; i < lg; i++)
+    {
+        __m128i s_lo;
+        __m128i s_hi;
+
+        v = LOAD(&x[(i - M) * LANES]);
+        s_lo = _mm_madd_epi16(_mm_unpacklo_epi16(v, one), aM_lo);
+        s_hi = _mm_madd_epi16(_mm_unpackhi_epi16(v, one), aM_hi);
+
+        for (m = 0; m < M / 2; m++)
+        {
+            s_lo = _mm_add_epi32(s_lo, _mm_madd_epi16(pair_lo[M + i - 2 * m], coef_lo[m]));
+            s_hi = _mm_add_epi32(s_hi, _mm_madd_epi16(pair_hi[M + i - 2 * m], coef_hi[m]));
+        }
+
+        /* (Word16)(s >> 12): bits 12..27 of s, sign extended */
+        s_lo = _mm_srai_epi32(_mm_slli_epi32(s_lo, 4), 16);
+        s_hi = _mm_srai_epi32(_mm_slli_epi32(s_hi, 4), 16);
+
+        STORE(&y[i * LANES], _mm_packs_epi32(s_lo, s_hi));
+    }
+
+    return;
+}
+
+#elif defined(AMRNBDEC_NEON)
+
+void Syn_filt_batch_NEON(
+    Word16 a[],
+    Word16 x[],
+    Word16 y[],
+    Word16 lg)
+{
+    int16x4_t a_lo[M + 1];
+    int16x4_t a_hi[M + 1];
+    const int32x4_t round = vdupq_n_s32(0x00000800L);
+    Word16 i, j;
+
+    for (j = 0; j <= M; j++)
+    {
+        int16x8_t v = vld1q_s16(&a[j * LANES]);
+
+        a_lo[j] = vget_low_s16(v);
+        a_hi[j] = vget_high_s16(v);
+    }
+
+    for (i = 0; i < lg; i++)
+    {
+        int16x8_t v = vld1q_s16(&x[i * LANES]);
+        int32x4_t s_lo = vmlal_s16(round, vget_low_s16(v), a_lo[0]);
+        int32x4_t s_hi = vmlal_s16(round, vget_high_s16(v), a_hi[0]);
+
+        for (j = 1; j <= M; j++)
+        {
+            v = vld1q_s16(&y[(i - j) * LANES]);
+            s_lo = vmlsl_s16(s_lo, vget_low_s16(v), a_lo[j]);
+            s_hi = vmlsl_s16(s_hi, vget_high_s16(v), a_hi[j]);
+        }
+
+        /* vqshrn saturates to MIN_16..MAX_16 as Syn_filt() does */
+        vst1q_s16(&y[i * LANES], vcombine_s16(vqshrn_n_s32(s_lo, 12),
+                                              vqshrn_n_s32(s_hi, 12)));
+    }
+
+    return;
+}
+
+void Residu_batch_NEON(
+    Word16 a[],
+    Word16 x[],
+    Word16 y[],
+    Word16 lg)
+{
+    int16x4_t a_lo[M + 1];
+    int16x4_t a_hi[M + 1];
+    const int32x4_t round = vdupq_n_s32(0x00000800L);
+    Word16 i, j;
+
+    for (j = 0; j <= M; j++)
+    {
+        int16x8_t v = vld1q_s16(&a[j * LANES]);
+
+        a_lo[j] = vget_low_s16(v);
+        a_hi[j] = vget_high_s16(v);
+    }
+
+    for (i = 0; i < lg; i++)
+    {
+        int32x4_t s_lo = round;
+        int32x4_t s_hi = round;
+
+        for (j = 0; j <= M; j++)
+        {
+            int16x8_t v = vld1q_s16(&x[(i - j) * LANES]);
+
+            s_lo = vmlal_s16(s_lo, vget_low_s16(v), a_lo[j]);
+            s_hi = vmlal_s16(s_hi, vget_high_s16(v), a_hi[j]);
+        }
+
+        /* vshrn truncates as (Word16)(s >> 12) does */
+        vst1q_s16(&y[i * LANES], vcombine_s16(vshrn_n_s32(s_lo, 12),
+                                              vshrn_n_s32(s_hi, 12)));
+    }
+
+    return;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+
+
+
+ Filename: /audio/gsm_amr/c/src/include/batch_filt.h
+
+------------------------------------------------------------------------------
+ INCLUDE DESCRIPTION
+
+ Synthesis and residual filters of the batch decoder (see GSMFrameDecodeBatch)
+ which filter AMR_BATCH_LANES independent channels at once.
+
+ The signals and the coefficients are stored structure of arrays: sample n
+ (or coefficient n) of lane l is at x[n * AMR_BATCH_LANES + l]. Lane l of
+ Syn_filt_batch() gives exactly what Syn_filt() gives for that lane, and lane
+ l of Residu_batch() exactly what Residu() gives.
+
+ Syn_filt_batch_SSE2/Residu_batch_SSE2 (AMRNBDEC_SSE2) and the _NEON
+ versions (AMRNBDEC_NEON) are bit exact with the C versions.
+
+------------------------------------------------------------------------------
+*/
+
+#ifndef _BATCH_FILT_H_
+#define _BATCH_FILT_H_
+
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+#include "typedef.h"
+#include "cnst.h"
+
+/*--------------------------------------------------------------------------*/
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*----------------------------------------------------------------------------
+    ; DEFINES
+    ----------------------------------------------------------------------------*/
+    /* Number of channels filtered by one call */
+#define AMR_BATCH_LANES 8
+
+    /*----------------------------------------------------------------------------
+    ; GLOBAL FUNCTION DEFINITIONS
+    ----------------------------------------------------------------------------*/
+    /*
+     * 1/A(z) filtering of x[0..lg-1] into y[0..lg-1], with the memory of the
+     * filter in y[-M..-1]. a[] holds the M+1 coefficients of every lane.
+     */
+    void Syn_filt_batch(
+        Word16 a[],     /* (i) : a[(M+1) * AMR_BATCH_LANES]                 */
+        Word16 x[],     /* (i) : x[lg * AMR_BATCH_LANES]                    */
+        Word16 y[],     /* (i/o) : y[-M * AMR_BATCH_LANES..lg * AMR_BATCH_LANES-1] */
+        Word16 lg       /* (i) : size of filtering                          */
+    );
+
+    /*
+     * A(z) filtering of x[0..lg-1] into y[0..lg-1], x[-M..-1] being the
+     * past input.
+     */
+    void Residu_batch(
+        Word16 a[],     /* (i) : a[(M+1) * AMR_BATCH_LANES]                 */
+        Word16 x[],     /* (i) : x[-M * AMR_BATCH_LANES..lg * AMR_BATCH_LANES-1] */
+        Word16 y[],     /* (o) : y[lg * AMR_BATCH_LANES]                    */
+        Word16 lg       /* (i) : size of filtering                          */
+    );
+
+#if defined(AMRNBDEC_SSE2)
+    void Syn_filt_batch_SSE2(Word16 a[], Word16 x[], Word16 y[], Word16 lg);
+    void Residu_batch_SSE2(Word16 a[], Word16 x[], Word16 y[], Word16 lg);
+#elif defined(AMRNBDEC_NEON)
+    void Syn_filt_batch_NEON(Word16 a[], Word16 x[], Word16 y[], Word16 lg);
+    void Residu_batch_NEON(Word16 a[], Word16 x[], Word16 y[], Word16 lg);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _BATCH_FILT_H_ */
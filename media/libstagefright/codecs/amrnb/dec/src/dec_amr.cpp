@@ -1330,15 +1330,16 @@ the_end:
 ------------------------------------------------------------------------------
 */
 
-void Decoder_amr(
+static Word16 Decoder_amr_frame(
     Decoder_amrState *st,      /* i/o : State variables                   */
     enum Mode mode,            /* i   : AMR mode                          */
     Word16 parm[],             /* i   : vector of synthesis parameters
                                         (PRM_SIZE)                        */
     enum RXFrameType frame_type, /* i   : received frame type             */
     Word16 synth[],            /* o   : synthesis speech (L_FRAME)        */
-    Word16 A_t[]               /* o   : decoded LP filter in 4 subframes
+    Word16 A_t[],              /* o   : decoded LP filter in 4 subframes
                                         (AZ_SIZE)                         */
+    Flag deferSynth            /* i   : leave the excitation in synth[]   */
 )
 {
     /* LPC coefficients */
@@ -2278,16 +2279,34 @@ void Decoder_amr(
             }
             agc2(exc_enhanced, excp, L_SUBFR, pOverflow);
             *pOverflow = 0;
-            Syn_filt(Az, excp, &synth[i_subfr], L_SUBFR,
-                     st->mem_syn, 0);
+
+            if (deferSynth)
+            {
+                Copy(excp, &synth[i_subfr], L_SUBFR);
+            }
+            else
+            {
+                Syn_filt(Az, excp, &synth[i_subfr], L_SUBFR,
+                         st->mem_syn, 0);
+            }
         }
         else
         {
             *pOverflow = 0;
-            Syn_filt(Az, exc_enhanced, &synth[i_subfr], L_SUBFR,
-                     st->mem_syn, 0);
+
+            if (deferSynth)
+            {
+                Copy(exc_enhanced, &synth[i_subfr], L_SUBFR);
+            }
+            else
+            {
+                Syn_filt(Az, exc_enhanced, &synth[i_subfr], L_SUBFR,
+                         st->mem_syn, 0);
+            }
         }
 
+        /* Syn_filt() does not set *pOverflow, with deferSynth this only
+         * leaves the update of st->mem_syn to the caller */
         if (*pOverflow != 0)    /* Test for overflow */
         {
             for (i = PIT_MAX + L_INTERPOL + L_SUBFR - 1; i >= 0; i--)
@@ -2316,7 +2335,7 @@ void Decoder_amr(
             }
             Syn_filt(Az, exc_enhanced, &synth[i_subfr], L_SUBFR, st->mem_syn, 1);
         }
-        else
+        else if (!deferSynth)
         {
             Copy(&synth[i_subfr+L_SUBFR-M], st->mem_syn, M);
         }
@@ -2335,6 +2354,63 @@ void Decoder_amr(
         st->old_T0 = T0;
     }
 
+    /* store bfi for next subframe */
+    st->prev_bf = bfi;
+    st->prev_pdf = pdfi;
+
+    if (deferSynth)
+    {
+        /* the updates of Decoder_amr_end() need the synthesis speech,
+         * they do not use prev_bf, prev_pdf or dtxGlobalState */
+        st->dtxDecoderState.dtxGlobalState = newDTXState;
+
+        return 1;
+    }
+
+    Decoder_amr_end(st, synth);
+
+the_end:
+    st->dtxDecoderState.dtxGlobalState = newDTXState;
+
+    return 0;
+}
+
+void Decoder_amr(
+    Decoder_amrState *st,      /* i/o : State variables                   */
+    enum Mode mode,            /* i   : AMR mode                          */
+    Word16 parm[],             /* i   : vector of synthesis parameters
+                                        (PRM_SIZE)                        */
+    enum RXFrameType frame_type, /* i   : received frame type             */
+    Word16 synth[],            /* o   : synthesis speech (L_FRAME)        */
+    Word16 A_t[]               /* o   : decoded LP filter in 4 subframes
+                                        (AZ_SIZE)                         */
+)
+{
+    Decoder_amr_frame(st, mode, parm, frame_type, synth, A_t, 0);
+}
+
+Word16 Decoder_amr_exc(
+    Decoder_amrState *st,      /* i/o : State variables                   */
+    enum Mode mode,            /* i   : AMR mode                          */
+    Word16 parm[],             /* i   : vector of synthesis parameters
+                                        (PRM_SIZE)                        */
+    enum RXFrameType frame_type, /* i   : received frame type             */
+    Word16 synth[],            /* o   : excitation or synthesis speech
+                                        (L_FRAME)                         */
+    Word16 A_t[]               /* o   : decoded LP filter in 4 subframes
+                                        (AZ_SIZE)                         */
+)
+{
+    return Decoder_amr_frame(st, mode, parm, frame_type, synth, A_t, 1);
+}
+
+void Decoder_amr_end(
+    Decoder_amrState *st,      /* i/o : State variables                   */
+    Word16 synth[]             /* i   : synthesis speech (L_FRAME)        */
+)
+{
+    Flag   *pOverflow = &(st->overflow);     /* Overflow flag            */
+
     /*-------------------------------------------------------*
      * Call the Source Characteristic Detector which updates *
      * st->inBackgroundNoise and st->voicedHangover.         *
@@ -2354,10 +2430,6 @@ void Decoder_amr(
         synth,
         pOverflow);
 
-    /* store bfi for next subframe */
-    st->prev_bf = bfi;
-    st->prev_pdf = pdfi;
-
     /*--------------------------------------------------*
      * Calculate the LSF averages on the eight          *
      * previous frames                                  *
@@ -2366,9 +2438,4 @@ void Decoder_amr(
         &(st->lsp_avg_st),
         st->lsfState.past_lsf_q,
         pOverflow);
-
-the_end:
-    st->dtxDecoderState.dtxGlobalState = newDTXState;
-
-//    return(0);
 }
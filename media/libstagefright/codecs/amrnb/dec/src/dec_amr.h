@@ -193,6 +193,40 @@ extern "C"
                                     (AZ_SIZE)                             */
     );
 
+    /*
+     *  Function    : Decoder_amr_exc
+     *  Purpose     : Decoder_amr() without the synthesis filter, for the
+     *                batch decoder. When it returns 1, synth[] holds the
+     *                excitation: the caller filters it through 1/A(z) with
+     *                the coefficients of A_t[] and the memory st->mem_syn,
+     *                updates st->mem_syn with the last M samples and calls
+     *                Decoder_amr_end() on the synthesis speech.
+     *                When it returns 0 (DTX frames), synth[] holds the
+     *                synthesis speech and the frame is done.
+     */
+    Word16 Decoder_amr_exc(
+        Decoder_amrState *st,  /* i/o : State variables                       */
+        enum Mode mode,        /* i   : AMR mode                              */
+        Word16 parm[],         /* i   : vector of synthesis parameters
+                                    (PRM_SIZE)                            */
+        enum RXFrameType frame_type, /* i   : received frame type               */
+        Word16 synth[],        /* o   : excitation or synthesis speech
+                                    (L_FRAME)                             */
+        Word16 A_t[]           /* o   : decoded LP filter in 4 subframes
+                                    (AZ_SIZE)                             */
+    );
+
+    /*
+     *  Function    : Decoder_amr_end
+     *  Purpose     : Updates of the state which follow the synthesis filter
+     *                (source characteristic detector, DTX history and LSF
+     *                averages).
+     */
+    void Decoder_amr_end(
+        Decoder_amrState *st,  /* i/o : State variables                       */
+        Word16 synth[]         /* i   : synthesis speech (L_FRAME)            */
+    );
+
     /*----------------------------------------------------------------------------
     ; END
     ----------------------------------------------------------------------------*/
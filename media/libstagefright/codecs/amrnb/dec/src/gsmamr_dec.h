@@ -148,6 +148,24 @@ extern "C"
         Word16                    input_format
     );
 
+    /*
+     * AMRDecodeBatch decodes one frame of each of num_channels independent
+     * channels, each with its own state from GSMInitDecode(), exactly as
+     * AMRDecode() would, several channels at a time. The output of channel
+     * c is the L_FRAME samples at raw_pcm_buffer[c * L_FRAME], and
+     * byte_offset[c] gets what AMRDecode() returns for it; channels with an
+     * invalid frame get -1 and their output is left unchanged.
+     */
+    void AMRDecodeBatch(
+        void                      *state_data[],
+        Word16                    num_channels,
+        enum Frame_Type_3GPP      frame_type[],
+        UWord8                    *speech_bits_ptr[],
+        Word16                    *raw_pcm_buffer,
+        Word16                    input_format,
+        Word16                    byte_offset[]
+    );
+
     /*
      * This function resets the state memory used by the GSM AMR decoder. This
      * function returns zero. It will return negative one if there is an error.
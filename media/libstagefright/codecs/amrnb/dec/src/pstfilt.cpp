@@ -100,6 +100,15 @@ terms listed above has been obtained from the copyright holder.
 #include "syn_filt.h"
 #include "preemph.h"
 #include "cnst.h"
+#include "batch_filt.h"
+
+#if defined(AMRNBDEC_SSE2)
+#define Residu_batch   Residu_batch_SSE2
+#define Syn_filt_batch Syn_filt_batch_SSE2
+#elif defined(AMRNBDEC_NEON)
+#define Residu_batch   Residu_batch_NEON
+#define Syn_filt_batch Syn_filt_batch_NEON
+#endif
 
 /*----------------------------------------------------------------------------
 ; MACROS
@@ -254,6 +263,108 @@ Word16 Post_Filter_reset(Post_FilterState *state)
 
 /****************************************************************************/
 
+/*
+------------------------------------------------------------------------------
+ FUNCTION NAME: tilt_factor
+------------------------------------------------------------------------------
+ INPUT AND OUTPUT DEFINITIONS
+
+ Inputs:
+    Ap3 = coefficients of A(z/0.7)
+    Ap4 = coefficients of A(z/0.75)
+    pOverflow = pointer to overflow indicator of type Flag
+
+ Returns:
+    the coefficient of the tilt compensation filter of Post_Filter
+
+------------------------------------------------------------------------------
+*/
+
+static Word16 tilt_factor(
+    Word16 Ap3[],
+    Word16 Ap4[],
+    Flag   *pOverflow
+)
+{
+    Word16 h[L_H];
+
+    register Word16 i;
+    Word16 temp1;
+    Word16 temp2;
+    Word32 L_tmp;
+    Word32 L_tmp2;
+
+    /* impulse response of A(z/0.7)/A(z/0.75) */
+
+    Copy(Ap3, h, M + 1);
+    memset(&h[M + 1], 0, sizeof(Word16)*(L_H - M - 1));
+    Syn_filt(Ap4, h, h, L_H, &h[M + 1], 0);
+
+    /* 1st correlation of h[] */
+
+    L_tmp = 0;
+
+    for (i = L_H - 1; i >= 0; i--)
+    {
+        L_tmp2 = ((Word32) h[i]) * h[i];
+
+        if (L_tmp2 != (Word32) 0x40000000L)
+        {
+            L_tmp2 = L_tmp2 << 1;
+        }
+        else
+        {
+            *pOverflow = 1;
+            L_tmp2 = MAX_32;
+            break;
+        }
+
+        L_tmp = L_add(L_tmp, L_tmp2, pOverflow);
+    }
+    temp1 = (Word16)(L_tmp >> 16);
+
+    L_tmp = 0;
+
+    for (i = L_H - 2; i >= 0; i--)
+    {
+        L_tmp2 = ((Word32) h[i]) * h[i + 1];
+
+        if (L_tmp2 != (Word32) 0x40000000L)
+        {
+            L_tmp2 = L_tmp2 << 1;
+        }
+        else
+        {
+            *pOverflow = 1;
+            L_tmp2 = MAX_32;
+            break;
+        }
+
+        L_tmp = L_add(L_tmp, L_tmp2, pOverflow);
+    }
+    temp2 = (Word16)(L_tmp >> 16);
+
+    if (temp2 <= 0)
+    {
+        temp2 = 0;
+    }
+    else
+    {
+        L_tmp = (((Word32) temp2) * MU) >> 15;
+
+        /* Sign-extend product */
+        if (L_tmp & (Word32) 0x00010000L)
+        {
+            L_tmp = L_tmp | (Word32) 0xffff0000L;
+        }
+        temp2 = (Word16) L_tmp;
+
+        temp2 = div_s(temp2, temp1);
+    }
+
+    return temp2;
+}
+
 /*
 ------------------------------------------------------------------------------
  FUNCTION NAME: Post_Filter
@@ -449,13 +560,7 @@ void Post_Filter(
     Word16 *Az;                 /* pointer to Az_4:                 */
     /*  LPC parameters in each subframe */
     register Word16 i_subfr;    /* index for beginning of subframe  */
-    Word16 h[L_H];
-
-    register Word16 i;
-    Word16 temp1;
     Word16 temp2;
-    Word32 L_tmp;
-    Word32 L_tmp2;
     Word16 *syn_work = &st->synth_buf[M];
 
 
@@ -488,91 +593,200 @@ void Post_Filter(
 
         /* tilt compensation filter */
 
-        /* impulse response of A(z/0.7)/A(z/0.75) */
+        temp2 = tilt_factor(Ap3, Ap4, pOverflow);
 
-        Copy(Ap3, h, M + 1);
-        memset(&h[M + 1], 0, sizeof(Word16)*(L_H - M - 1));
-        Syn_filt(Ap4, h, h, L_H, &h[M + 1], 0);
+        preemphasis(&(st->preemph_state), st->res2, temp2, L_SUBFR, pOverflow);
 
-        /* 1st correlation of h[] */
+        /* filtering through  1/A(z/0.75) */
 
-        L_tmp = 0;
+        Syn_filt(Ap4, st->res2, &syn[i_subfr], L_SUBFR, st->mem_syn_pst, 1);
 
-        for (i = L_H - 1; i >= 0; i--)
-        {
-            L_tmp2 = ((Word32) h[i]) * h[i];
+        /* scale output to input */
 
-            if (L_tmp2 != (Word32) 0x40000000L)
-            {
-                L_tmp2 = L_tmp2 << 1;
-            }
-            else
-            {
-                *pOverflow = 1;
-                L_tmp2 = MAX_32;
-                break;
-            }
+        agc(&(st->agc_state), &syn_work[i_subfr], &syn[i_subfr],
+            AGC_FAC, L_SUBFR, pOverflow);
 
-            L_tmp = L_add(L_tmp, L_tmp2, pOverflow);
-        }
-        temp1 = (Word16)(L_tmp >> 16);
+        Az += MP1;
+    }
+
+    /* update syn_work[] buffer */
+
+    Copy(&syn_work[L_FRAME - M], &syn_work[-M], M);
+
+    return;
+}
+
+/*
+------------------------------------------------------------------------------
+ FUNCTION NAME: Post_Filter_batch
+------------------------------------------------------------------------------
+ INPUT AND OUTPUT DEFINITIONS
+
+ Inputs:
+    st = post filter states of the n channels
+    mode = AMR mode of each channel
+    syn = synthesized speech of each channel, post-filtered on return
+    Az_4 = interpolated LPC parameters for all subframes of each channel
+    pOverflow = overflow indicator of each channel
+    n = number of channels, 1..AMR_BATCH_LANES
+
+------------------------------------------------------------------------------
+ FUNCTION DESCRIPTION
 
-        L_tmp = 0;
+ Post_Filter() of n independent channels. The residual and the synthesis
+ filters run on all the channels at once, with the signals and the
+ coefficients stored structure of arrays (see batch_filt.h); the weighted
+ coefficients, the tilt compensation and the gain control are computed for
+ each channel as in Post_Filter(). The output and the states are exactly
+ what Post_Filter() gives for each channel.
 
-        for (i = L_H - 2; i >= 0; i--)
+------------------------------------------------------------------------------
+*/
+
+void Post_Filter_batch(
+    Post_FilterState *st[],
+    enum Mode mode[],
+    Word16 *syn[],
+    Word16 *Az_4[],
+    Flag   *pOverflow[],
+    Word16 n
+)
+{
+    Word16 Ap3[MP1];
+    Word16 Ap4[MP1];
+    Word16 *Az;
+    Word16 i_subfr;
+    Word16 i;
+    Word16 j;
+    Word16 l;
+    Word16 tilt[L_FRAME / L_SUBFR][AMR_BATCH_LANES];
+
+    /* structure of arrays, see batch_filt.h */
+    Word16 a3[L_FRAME / L_SUBFR][MP1 * AMR_BATCH_LANES];
+    Word16 a4[L_FRAME / L_SUBFR][MP1 * AMR_BATCH_LANES];
+    Word16 syn_work[(M + L_FRAME) * AMR_BATCH_LANES];
+    Word16 res2[L_FRAME * AMR_BATCH_LANES];
+    Word16 syn_pst[(M + L_FRAME) * AMR_BATCH_LANES];
+
+    if (n < AMR_BATCH_LANES)
+    {
+        /* the unused lanes filter zeros */
+        memset(a3, 0, sizeof(a3));
+        memset(a4, 0, sizeof(a4));
+        memset(syn_work, 0, sizeof(syn_work));
+        memset(syn_pst, 0, sizeof(syn_pst));
+    }
+
+    for (l = 0; l < n; l++)
+    {
+        Word16 *work = st[l]->synth_buf;
+
+        Copy(syn[l], &work[M], L_FRAME);
+
+        for (i = 0; i < M + L_FRAME; i++)
         {
-            L_tmp2 = ((Word32) h[i]) * h[i + 1];
+            syn_work[i * AMR_BATCH_LANES + l] = work[i];
+        }
 
-            if (L_tmp2 != (Word32) 0x40000000L)
+        for (i = 0; i < M; i++)
+        {
+            syn_pst[i * AMR_BATCH_LANES + l] = st[l]->mem_syn_pst[i];
+        }
+
+        Az = Az_4[l];
+
+        for (i_subfr = 0; i_subfr < L_FRAME / L_SUBFR; i_subfr++)
+        {
+            if (mode[l] == MR122 || mode[l] == MR102)
             {
-                L_tmp2 = L_tmp2 << 1;
+                Weight_Ai(Az, gamma3_MR122, Ap3);
+                Weight_Ai(Az, gamma4_MR122, Ap4);
             }
             else
             {
-                *pOverflow = 1;
-                L_tmp2 = MAX_32;
-                break;
+                Weight_Ai(Az, gamma3, Ap3);
+                Weight_Ai(Az, gamma4, Ap4);
             }
 
-            L_tmp = L_add(L_tmp, L_tmp2, pOverflow);
-        }
-        temp2 = (Word16)(L_tmp >> 16);
+            for (j = 0; j < MP1; j++)
+            {
+                a3[i_subfr][j * AMR_BATCH_LANES + l] = Ap3[j];
+                a4[i_subfr][j * AMR_BATCH_LANES + l] = Ap4[j];
+            }
 
-        if (temp2 <= 0)
-        {
-            temp2 = 0;
+            tilt[i_subfr][l] = tilt_factor(Ap3, Ap4, pOverflow[l]);
+
+            Az += MP1;
         }
-        else
+    }
+
+    /* filtering of synthesis speech by A(z/0.7) to find res2[] */
+
+    for (i_subfr = 0; i_subfr < L_FRAME / L_SUBFR; i_subfr++)
+    {
+        Residu_batch(a3[i_subfr],
+                     &syn_work[(M + i_subfr * L_SUBFR) * AMR_BATCH_LANES],
+                     &res2[i_subfr * L_SUBFR * AMR_BATCH_LANES], L_SUBFR);
+    }
+
+    /* tilt compensation filter, st->res2 is left with the last subframe */
+
+    for (l = 0; l < n; l++)
+    {
+        for (i_subfr = 0; i_subfr < L_FRAME / L_SUBFR; i_subfr++)
         {
-            L_tmp = (((Word32) temp2) * MU) >> 15;
+            Word16 *p = &res2[i_subfr * L_SUBFR * AMR_BATCH_LANES + l];
 
-            /* Sign-extend product */
-            if (L_tmp & (Word32) 0x00010000L)
+            for (i = 0; i < L_SUBFR; i++)
             {
-                L_tmp = L_tmp | (Word32) 0xffff0000L;
+                st[l]->res2[i] = p[i * AMR_BATCH_LANES];
             }
-            temp2 = (Word16) L_tmp;
 
-            temp2 = div_s(temp2, temp1);
+            preemphasis(&(st[l]->preemph_state), st[l]->res2, tilt[i_subfr][l],
+                        L_SUBFR, pOverflow[l]);
+
+            for (i = 0; i < L_SUBFR; i++)
+            {
+                p[i * AMR_BATCH_LANES] = st[l]->res2[i];
+            }
         }
+    }
 
-        preemphasis(&(st->preemph_state), st->res2, temp2, L_SUBFR, pOverflow);
+    /* filtering through  1/A(z/0.75) */
 
-        /* filtering through  1/A(z/0.75) */
+    for (i_subfr = 0; i_subfr < L_FRAME / L_SUBFR; i_subfr++)
+    {
+        Syn_filt_batch(a4[i_subfr], &res2[i_subfr * L_SUBFR * AMR_BATCH_LANES],
+                       &syn_pst[(M + i_subfr * L_SUBFR) * AMR_BATCH_LANES],
+                       L_SUBFR);
+    }
 
-        Syn_filt(Ap4, st->res2, &syn[i_subfr], L_SUBFR, st->mem_syn_pst, 1);
+    /* scale output to input */
 
-        /* scale output to input */
+    for (l = 0; l < n; l++)
+    {
+        Word16 *work = st[l]->synth_buf;
 
-        agc(&(st->agc_state), &syn_work[i_subfr], &syn[i_subfr],
-            AGC_FAC, L_SUBFR, pOverflow);
+        for (i = 0; i < L_FRAME; i++)
+        {
+            syn[l][i] = syn_pst[(M + i) * AMR_BATCH_LANES + l];
+        }
 
-        Az += MP1;
-    }
+        for (i = 0; i < M; i++)
+        {
+            st[l]->mem_syn_pst[i] = syn_pst[(L_FRAME + i) * AMR_BATCH_LANES + l];
+        }
 
-    /* update syn_work[] buffer */
+        for (i_subfr = 0; i_subfr < L_FRAME; i_subfr += L_SUBFR)
+        {
+            agc(&(st[l]->agc_state), &work[M + i_subfr], &syn[l][i_subfr],
+                AGC_FAC, L_SUBFR, pOverflow[l]);
+        }
 
-    Copy(&syn_work[L_FRAME - M], &syn_work[-M], M);
+        /* update syn_work[] buffer */
+
+        Copy(&work[L_FRAME], &work[0], M);
+    }
 
     return;
 }
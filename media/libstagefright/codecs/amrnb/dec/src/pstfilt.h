@@ -133,6 +133,19 @@ extern "C"
        return 0 on success
      */
 
+    void Post_Filter_batch(
+        Post_FilterState *st[], /* i/o : post filter states of each channel   */
+        enum Mode mode[],       /* i   : AMR mode of each channel             */
+        Word16 *syn[],          /* i/o : synthesis speech of each channel     */
+        Word16 *Az_4[],         /* i   : LPC parameters of each channel       */
+        Flag   *pOverflow[],    /* o   : overflow indicator of each channel   */
+        Word16 n                /* i   : number of channels (at most 8)       */
+    );
+    /* Post_Filter() of n independent channels, with the filters running on
+       all of them at once (see batch_filt.h). Gives exactly what Post_Filter()
+       gives for each channel.
+     */
+
 #ifdef __cplusplus
 }
 #endif
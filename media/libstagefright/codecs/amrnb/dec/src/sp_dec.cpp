@@ -94,6 +94,7 @@ terms listed above has been obtained from the copyright holder.
 ; INCLUDES
 ----------------------------------------------------------------------------*/
 #include <stdlib.h>
+#include <string.h>
 
 #include "sp_dec.h"
 #include "typedef.h"
@@ -103,6 +104,14 @@ terms listed above has been obtained from the copyright holder.
 #include "bits2prm.h"
 #include "mode.h"
 #include "post_pro.h"
+#include "batch_filt.h"
+#include "copy.h"
+
+#if defined(AMRNBDEC_SSE2)
+#define Syn_filt_batch Syn_filt_batch_SSE2
+#elif defined(AMRNBDEC_NEON)
+#define Syn_filt_batch Syn_filt_batch_NEON
+#endif
 
 
 /*----------------------------------------------------------------------------
@@ -695,5 +704,199 @@ void GSMFrameDecode(
     return;
 }
 
+/*
+------------------------------------------------------------------------------
+ FUNCTION NAME: GSMFrameDecodeBatch
+------------------------------------------------------------------------------
+ INPUT AND OUTPUT DEFINITIONS
+
+ Inputs:
+    st = states of the n channels, of type Speech_Decode_FrameState
+    mode = AMR mode of each channel
+    serial = serial bit stream of each channel
+    frame_type = frame type of each channel
+    synth = output buffer of each channel, L_FRAME samples
+    n = number of channels
+
+ Outputs:
+    synth buffers contain the decoded speech
+
+------------------------------------------------------------------------------
+ FUNCTION DESCRIPTION
+
+ GSMFrameDecode() of n independent channels, AMR_BATCH_LANES at a time.
+ The excitation of each channel is decoded by Decoder_amr_exc(), then the
+ synthesis filter and the filters of the post-filter run on all the channels
+ at once with the signals stored structure of arrays (see batch_filt.h).
+ DTX frames are synthesized by Decoder_amr_exc() itself and only join the
+ post-filter. Each channel gets exactly the output and the state that
+ GSMFrameDecode() gives.
+
+------------------------------------------------------------------------------
+*/
 
+void GSMFrameDecodeBatch(
+    Speech_Decode_FrameState *st[],
+    enum Mode mode[],
+    Word16 *serial[],
+    enum RXFrameType frame_type[],
+    Word16 *synth[],
+    Word16 n)
+{
+    Word16 parm[MAX_PRM_SIZE + 1];  /* Synthesis parameters                */
+    Word16 Az_dec[AMR_BATCH_LANES][AZ_SIZE];
+    Word16 *Az[AMR_BATCH_LANES];
+    Word16 deferred[AMR_BATCH_LANES];
+    Post_FilterState *post_state[AMR_BATCH_LANES];
+    Flag *pOverflow[AMR_BATCH_LANES];
+
+    /* structure of arrays, see batch_filt.h */
+    Word16 a[L_FRAME / L_SUBFR][MP1 * AMR_BATCH_LANES];
+    Word16 exc[L_FRAME * AMR_BATCH_LANES];
+    Word16 syn[(M + L_FRAME) * AMR_BATCH_LANES];
+
+    Word16 base;
+    Word16 count;
+    Word16 numDeferred;
+    Word16 i, j, l;
+    Word16 i_subfr;
+
+    for (base = 0; base < n; base += AMR_BATCH_LANES)
+    {
+        count = n - base;
+        if (count > AMR_BATCH_LANES)
+        {
+            count = AMR_BATCH_LANES;
+        }
+
+        numDeferred = 0;
+
+        for (l = 0; l < count; l++)
+        {
+            Speech_Decode_FrameState *s = st[base + l];
+
+            /* Serial to parameters   */
+            if ((frame_type[base + l] == RX_SID_BAD) ||
+                    (frame_type[base + l] == RX_SID_UPDATE))
+            {
+                /* Override mode to MRDTX */
+                Bits2prm(MRDTX, serial[base + l], parm);
+            }
+            else
+            {
+                Bits2prm(mode[base + l], serial[base + l], parm);
+            }
+
+            /* Excitation */
+            deferred[l] = Decoder_amr_exc(
+                              &(s->decoder_amrState),
+                              mode[base + l],
+                              parm,
+                              frame_type[base + l],
+                              synth[base + l],
+                              Az_dec[l]);
+
+            numDeferred += deferred[l];
+
+            Az[l] = Az_dec[l];
+            post_state[l] = &(s->post_state);
+            pOverflow[l] = &(s->decoder_amrState.overflow);
+        }
+
+        /* Synthesis */
+        if (numDeferred != 0)
+        {
+            if (numDeferred < AMR_BATCH_LANES)
+            {
+                /* the other lanes filter zeros */
+                memset(a, 0, sizeof(a));
+                memset(exc, 0, sizeof(exc));
+                memset(syn, 0, M * AMR_BATCH_LANES * sizeof(Word16));
+            }
+
+            for (l = 0; l < count; l++)
+            {
+                Decoder_amrState *s = &(st[base + l]->decoder_amrState);
+
+                if (!deferred[l])
+                {
+                    continue;
+                }
+
+                for (i_subfr = 0; i_subfr < L_FRAME / L_SUBFR; i_subfr++)
+                {
+                    for (j = 0; j < MP1; j++)
+                    {
+                        a[i_subfr][j * AMR_BATCH_LANES + l] =
+                            Az_dec[l][i_subfr * MP1 + j];
+                    }
+                }
+
+                for (i = 0; i < L_FRAME; i++)
+                {
+                    exc[i * AMR_BATCH_LANES + l] = synth[base + l][i];
+                }
+
+                for (i = 0; i < M; i++)
+                {
+                    syn[i * AMR_BATCH_LANES + l] = s->mem_syn[i];
+                }
+            }
+
+            for (i_subfr = 0; i_subfr < L_FRAME / L_SUBFR; i_subfr++)
+            {
+                Syn_filt_batch(a[i_subfr], &exc[i_subfr * L_SUBFR * AMR_BATCH_LANES],
+                               &syn[(M + i_subfr * L_SUBFR) * AMR_BATCH_LANES],
+                               L_SUBFR);
+            }
+
+            for (l = 0; l < count; l++)
+            {
+                Decoder_amrState *s = &(st[base + l]->decoder_amrState);
+
+                if (!deferred[l])
+                {
+                    continue;
+                }
+
+                for (i = 0; i < L_FRAME; i++)
+                {
+                    synth[base + l][i] = syn[(M + i) * AMR_BATCH_LANES + l];
+                }
+
+                Copy(&synth[base + l][L_FRAME - M], s->mem_syn, M);
+
+                Decoder_amr_end(s, synth[base + l]);
+            }
+        }
+
+        /* Post-filter */
+        Post_Filter_batch(
+            post_state,
+            &mode[base],
+            &synth[base],
+            Az,
+            pOverflow,
+            count);
+
+        for (l = 0; l < count; l++)
+        {
+            /* post HP filter, and 15->16 bits */
+            Post_Process(
+                &(st[base + l]->postHP_state),
+                synth[base + l],
+                L_FRAME,
+                pOverflow[l]);
 
+#if !defined(NO13BIT)
+            /* Truncate to 13 bits */
+            for (i = 0; i < L_FRAME; i++)
+            {
+                synth[base + l][i] = synth[base + l][i] & 0xfff8;
+            }
+#endif
+        }
+    }
+
+    return;
+}
@@ -107,6 +107,19 @@ extern "C"
     );
     /*    return 0 on success
      */
+
+    void GSMFrameDecodeBatch(
+        Speech_Decode_FrameState *st[], /* io: states of each channel          */
+        enum Mode mode[],             /* i : AMR mode of each channel          */
+        Word16 *serial[],             /* i : serial bit stream of each channel */
+        enum RXFrameType frame_type[], /* i : Frame type of each channel       */
+        Word16 *synth[],              /* o : synthesis speech of each channel  */
+        Word16 n                      /* i : number of channels                */
+    );
+    /*    GSMFrameDecode() of n independent channels, with the filters
+          running on several channels at once. Gives exactly what
+          GSMFrameDecode() gives for each channel.
+     */
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,412 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that the batch filters give exactly what Syn_filt() and Residu()
+// give for each lane, and prints the time each of them takes.
+//
+// Decodes <channels> independent AMR-NB channels, each one starting at a
+// different frame of the given .amr file (or of random frames when no file
+// is given), once with AMRDecode() for each channel and once with
+// AMRDecodeBatch() for all of them. Checks that both give the same PCM and
+// prints the number of channels one core can decode in real time with each.
+//
+// Usage: amrdec_bench [-c channels] [-r repeat] [file.amr]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gsmamr_dec.h"
+#include "batch_filt.h"
+#include "residu.h"
+#include "syn_filt.h"
+
+#if defined(AMRNBDEC_SSE2)
+#define Syn_filt_batch_SIMD Syn_filt_batch_SSE2
+#define Residu_batch_SIMD   Residu_batch_SSE2
+#define SIMD_NAME           "SSE2"
+#elif defined(AMRNBDEC_NEON)
+#define Syn_filt_batch_SIMD Syn_filt_batch_NEON
+#define Residu_batch_SIMD   Residu_batch_NEON
+#define SIMD_NAME           "NEON"
+#endif
+
+enum {
+    kMaxChannels = 1024,
+    kRandomFrames = 1000,
+    kFrameRate = 50,
+};
+
+#define LANES AMR_BATCH_LANES
+
+// Size of the frames in the storage format, without the header byte.
+static const int kFrameSize[16] = {
+    12, 13, 15, 17, 19, 20, 26, 31, 5, 0, 0, 0, 0, 0, 0, 0
+};
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static uint32_t gSeed = 1;
+
+static uint32_t random32() {
+    gSeed = gSeed * 1103515245 + 12345;
+    uint32_t hi = gSeed >> 16;
+    gSeed = gSeed * 1103515245 + 12345;
+    return (hi << 16) | (gSeed >> 16);
+}
+
+// Mostly values in the range the decoder uses, with some full scale ones to
+// exercise the wrap around and the saturation.
+static Word16 randomSample(int shift) {
+    uint32_t x = random32();
+    return (x & 0xf) ? (Word16)x >> shift : (Word16)x;
+}
+
+static int checkSynFilt(int iterations) {
+    Word16 a[MP1 * LANES], x[L_SUBFR * LANES];
+    Word16 y[(M + L_SUBFR) * LANES], ySimd[(M + L_SUBFR) * LANES];
+    Word16 al[MP1], xl[L_SUBFR], yl[L_SUBFR], mem[M];
+
+    for (int i = 0; i < iterations; ++i) {
+        for (int k = 0; k < MP1 * LANES; ++k) {
+            a[k] = randomSample(3);
+        }
+        for (int k = 0; k < L_SUBFR * LANES; ++k) {
+            x[k] = randomSample(2);
+        }
+        for (int k = 0; k < (M + L_SUBFR) * LANES; ++k) {
+            y[k] = ySimd[k] = randomSample(1);
+        }
+        Syn_filt_batch(a, x, &y[M * LANES], L_SUBFR);
+#if defined(SIMD_NAME)
+        Syn_filt_batch_SIMD(a, x, &ySimd[M * LANES], L_SUBFR);
+        if (memcmp(y, ySimd, sizeof(y))) {
+            printf("Syn_filt_batch_" SIMD_NAME ": FAILED at iteration %d\n", i);
+            return 1;
+        }
+#endif
+        for (int l = 0; l < LANES; ++l) {
+            for (int k = 0; k < MP1; ++k) {
+                al[k] = a[k * LANES + l];
+            }
+            for (int k = 0; k < L_SUBFR; ++k) {
+                xl[k] = x[k * LANES + l];
+            }
+            for (int k = 0; k < M; ++k) {
+                mem[k] = ySimd[k * LANES + l];
+            }
+            Syn_filt(al, xl, yl, L_SUBFR, mem, 0);
+            for (int k = 0; k < L_SUBFR; ++k) {
+                if (yl[k] != y[(M + k) * LANES + l]) {
+                    printf("Syn_filt_batch: FAILED at iteration %d\n", i);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    int64_t a0 = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        for (int l = 0; l < LANES; ++l) {
+            Syn_filt(al, xl, yl, L_SUBFR, mem, 1);
+        }
+    }
+    int64_t a1 = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        Syn_filt_batch(a, x, &y[M * LANES], L_SUBFR);
+    }
+    int64_t a2 = nowNs();
+#if defined(SIMD_NAME)
+    for (int i = 0; i < iterations; ++i) {
+        Syn_filt_batch_SIMD(a, x, &ySimd[M * LANES], L_SUBFR);
+    }
+#endif
+    int64_t a3 = nowNs();
+    printf("Syn_filt x%d: ok, Syn_filt %.1f ns batch C %.1f ns batch SIMD %.1f ns\n",
+           LANES, (double)(a1 - a0) / iterations, (double)(a2 - a1) / iterations,
+           (double)(a3 - a2) / iterations);
+    return 0;
+}
+
+static int checkResidu(int iterations) {
+    Word16 a[MP1 * LANES], x[(M + L_SUBFR) * LANES];
+    Word16 y[L_SUBFR * LANES], ySimd[L_SUBFR * LANES];
+    Word16 al[MP1], xl[M + L_SUBFR], yl[L_SUBFR];
+
+    for (int i = 0; i < iterations; ++i) {
+        for (int k = 0; k < MP1 * LANES; ++k) {
+            a[k] = randomSample(3);
+        }
+        for (int k = 0; k < (M + L_SUBFR) * LANES; ++k) {
+            x[k] = randomSample(1);
+        }
+        Residu_batch(a, &x[M * LANES], y, L_SUBFR);
+#if defined(SIMD_NAME)
+        Residu_batch_SIMD(a, &x[M * LANES], ySimd, L_SUBFR);
+        if (memcmp(y, ySimd, sizeof(y))) {
+            printf("Residu_batch_" SIMD_NAME ": FAILED at iteration %d\n", i);
+            return 1;
+        }
+#endif
+        for (int l = 0; l < LANES; ++l) {
+            for (int k = 0; k < MP1; ++k) {
+                al[k] = a[k * LANES + l];
+            }
+            for (int k = 0; k < M + L_SUBFR; ++k) {
+                xl[k] = x[k * LANES + l];
+            }
+            Residu(al, &xl[M], yl, L_SUBFR);
+            for (int k = 0; k < L_SUBFR; ++k) {
+                if (yl[k] != y[k * LANES + l]) {
+                    printf("Residu_batch: FAILED at iteration %d\n", i);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    int64_t a0 = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        for (int l = 0; l < LANES; ++l) {
+            Residu(al, &xl[M], yl, L_SUBFR);
+        }
+    }
+    int64_t a1 = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        Residu_batch(a, &x[M * LANES], y, L_SUBFR);
+    }
+    int64_t a2 = nowNs();
+#if defined(SIMD_NAME)
+    for (int i = 0; i < iterations; ++i) {
+        Residu_batch_SIMD(a, &x[M * LANES], ySimd, L_SUBFR);
+    }
+#endif
+    int64_t a3 = nowNs();
+    printf("Residu x%d: ok, Residu %.1f ns batch C %.1f ns batch SIMD %.1f ns\n",
+           LANES, (double)(a1 - a0) / iterations, (double)(a2 - a1) / iterations,
+           (double)(a3 - a2) / iterations);
+    return 0;
+}
+
+struct Frame {
+    enum Frame_Type_3GPP type;
+    uint8_t *data;
+};
+
+// Splits a storage format file (RFC 4867 section 5) into frames.
+static int readFrames(const char *path, uint8_t **buffer, Frame **frames) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        printf("cannot open %s\n", path);
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *data = (uint8_t *)malloc(size);
+    if (fread(data, 1, size, fp) != size || size < 6 || memcmp(data, "#!AMR\n", 6)) {
+        printf("%s is not an AMR-NB file\n", path);
+        fclose(fp);
+        free(data);
+        return -1;
+    }
+    fclose(fp);
+
+    int numFrames = 0;
+    Frame *list = (Frame *)malloc(sizeof(Frame) * size);
+    for (size_t offset = 6; offset < size;) {
+        unsigned type = (data[offset] >> 3) & 0x0f;
+        if ((type > AMR_SID && type < AMR_NO_DATA)
+                || offset + 1 + kFrameSize[type] > size) {
+            break;
+        }
+        list[numFrames].type = (enum Frame_Type_3GPP)type;
+        list[numFrames].data = &data[offset + 1];
+        ++numFrames;
+        offset += 1 + kFrameSize[type];
+    }
+    *buffer = data;
+    *frames = list;
+    return numFrames;
+}
+
+// Speech of every mode, comfort noise and missing frames with random bits.
+static int randomFrames(uint8_t **buffer, Frame **frames) {
+    uint8_t *data = (uint8_t *)malloc(kRandomFrames * 32);
+    Frame *list = (Frame *)malloc(sizeof(Frame) * kRandomFrames);
+
+    for (int i = 0; i < kRandomFrames * 32; ++i) {
+        data[i] = random32() >> 24;
+    }
+    for (int i = 0; i < kRandomFrames; ++i) {
+        unsigned type = random32() % 10;
+        list[i].type = (enum Frame_Type_3GPP)(type == 9 ? AMR_NO_DATA : type);
+        list[i].data = &data[i * 32];
+    }
+    *buffer = data;
+    *frames = list;
+    return kRandomFrames;
+}
+
+static void initStates(void **states, int numChannels) {
+    for (int c = 0; c < numChannels; ++c) {
+        GSMInitDecode(&states[c], (Word8 *)"AMRNBDecoder");
+    }
+}
+
+static void exitStates(void **states, int numChannels) {
+    for (int c = 0; c < numChannels; ++c) {
+        GSMDecodeFrameExit(&states[c]);
+    }
+}
+
+// Frame i of channel c.
+static const Frame *channelFrame(const Frame *frames, int numFrames, int c, int i) {
+    return &frames[(c * 37 + i) % numFrames];
+}
+
+static int runDecoder(const Frame *frames, int numFrames, int numChannels,
+                      int repeat) {
+    void **states = new void *[numChannels];
+    void **batchStates = new void *[numChannels];
+    enum Frame_Type_3GPP *types = new enum Frame_Type_3GPP[numChannels];
+    UWord8 **data = new UWord8 *[numChannels];
+    Word16 *offsets = new Word16[numChannels];
+    Word16 *pcm = new Word16[numChannels * L_FRAME];
+    Word16 *batchPcm = new Word16[numChannels * L_FRAME];
+    int totalFrames = numFrames * repeat;
+    int result = 0;
+
+    // the two ways give the same output
+    initStates(states, numChannels);
+    initStates(batchStates, numChannels);
+    for (int i = 0; i < numFrames && !result; ++i) {
+        for (int c = 0; c < numChannels; ++c) {
+            const Frame *f = channelFrame(frames, numFrames, c, i);
+            AMRDecode(states[c], f->type, f->data, &pcm[c * L_FRAME], MIME_IETF);
+            types[c] = f->type;
+            data[c] = f->data;
+        }
+        AMRDecodeBatch(batchStates, numChannels, types, data, batchPcm,
+                       MIME_IETF, offsets);
+        if (memcmp(pcm, batchPcm, numChannels * L_FRAME * sizeof(Word16))) {
+            printf("AMRDecodeBatch: FAILED at frame %d\n", i);
+            result = 1;
+        }
+    }
+    exitStates(states, numChannels);
+    exitStates(batchStates, numChannels);
+    if (result) {
+        goto exit;
+    }
+
+    {
+        initStates(states, numChannels);
+        int64_t a0 = nowNs();
+        for (int i = 0; i < totalFrames; ++i) {
+            for (int c = 0; c < numChannels; ++c) {
+                const Frame *f = channelFrame(frames, numFrames, c, i);
+                AMRDecode(states[c], f->type, f->data, &pcm[c * L_FRAME], MIME_IETF);
+            }
+        }
+        int64_t a1 = nowNs();
+        exitStates(states, numChannels);
+
+        initStates(batchStates, numChannels);
+        int64_t b0 = nowNs();
+        for (int i = 0; i < totalFrames; ++i) {
+            for (int c = 0; c < numChannels; ++c) {
+                const Frame *f = channelFrame(frames, numFrames, c, i);
+                types[c] = f->type;
+                data[c] = f->data;
+            }
+            AMRDecodeBatch(batchStates, numChannels, types, data, batchPcm,
+                           MIME_IETF, offsets);
+        }
+        int64_t b1 = nowNs();
+        exitStates(batchStates, numChannels);
+
+        double frames = (double)totalFrames * numChannels;
+        double single = (a1 - a0) * 1e-3 / frames;
+        double batch = (b1 - b0) * 1e-3 / frames;
+        printf("%d channels, %d frames each: ok\n", numChannels, totalFrames);
+        printf("  AMRDecode:      %.2f us/frame, %.0f channels per core\n",
+               single, 1e6 / kFrameRate / single);
+        printf("  AMRDecodeBatch: %.2f us/frame, %.0f channels per core\n",
+               batch, 1e6 / kFrameRate / batch);
+    }
+
+exit:
+    delete[] states;
+    delete[] batchStates;
+    delete[] types;
+    delete[] data;
+    delete[] offsets;
+    delete[] pcm;
+    delete[] batchPcm;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int numChannels = 64;
+    int repeat = 1;
+    int res;
+
+    while ((res = getopt(argc, argv, "c:r:")) >= 0) {
+        switch (res) {
+            case 'c':
+                numChannels = atoi(optarg);
+                break;
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            default:
+                printf("usage: %s [-c channels] [-r repeat] [file.amr]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (numChannels < 1 || numChannels > kMaxChannels || repeat < 1) {
+        printf("channels must be 1..%d\n", kMaxChannels);
+        return 1;
+    }
+
+    int failures = 0;
+    failures += checkSynFilt(100000);
+    failures += checkResidu(100000);
+
+    uint8_t *buffer;
+    Frame *frames;
+    int numFrames = (optind < argc)
+            ? readFrames(argv[optind], &buffer, &frames)
+            : randomFrames(&buffer, &frames);
+    if (numFrames <= 0) {
+        failures++;
+    } else {
+        failures += runDecoder(frames, numFrames, numChannels, repeat);
+        free(frames);
+        free(buffer);
+    }
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -86,6 +86,22 @@ LOCAL_SRC_FILES += \
 
 endif
 
+ifeq ($(TARGET_ARCH),x86)
+LOCAL_SRC_FILES += \
+	src/asm/X86/convolve_sse2.c \
+	src/asm/X86/cor_h_vec_sse2.c \
+	src/asm/X86/Deemph_32_sse2.c \
+	src/asm/X86/Dot_p_sse2.c \
+	src/asm/X86/Filt_6k_7k_sse2.c \
+	src/asm/X86/Norm_Corr_sse2.c \
+	src/asm/X86/pred_lt4_1_sse2.c \
+	src/asm/X86/residu_sse2.c \
+	src/asm/X86/scale_sig_sse2.c \
+	src/asm/X86/Syn_filt_32_sse2.c \
+	src/asm/X86/syn_filt_sse2.c
+
+endif
+
 LOCAL_MODULE := libstagefright_amrwbenc
 
 LOCAL_ARM_MODE := arm
@@ -112,6 +128,11 @@ LOCAL_C_INCLUDES += $(LOCAL_PATH)/src/asm/ARMV5E
 LOCAL_C_INCLUDES += $(LOCAL_PATH)/src/asm/ARMV7
 endif
 
+# The ASM_OPT entry points are the bit-exact SSE2 versions in src/asm/X86.
+ifeq ($(TARGET_ARCH),x86)
+LOCAL_CFLAGS += -DASM_OPT -DAMRWBENC_SSE2
+endif
+
 include $(BUILD_STATIC_LIBRARY)
 
 ################################################################################
@@ -137,3 +158,32 @@ LOCAL_MODULE := libstagefright_soft_amrwbenc
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
+
+################################################################################
+
+# test utility: checks the SSE2 kernels and measures the encoding speed
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	test/amrwbenc_bench.c
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/media/libstagefright/codecs/common/include \
+	$(LOCAL_PATH)/src \
+	$(LOCAL_PATH)/inc
+
+ifeq ($(TARGET_ARCH),x86)
+LOCAL_CFLAGS += -DASM_OPT -DAMRWBENC_SSE2
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+	libstagefright_amrwbenc
+
+LOCAL_SHARED_LIBRARIES := \
+	libstagefright_enc_common
+
+LOCAL_MODULE := amrwbenc_bench
+LOCAL_MODULE_TAGS := debug
+
+include $(BUILD_EXECUTABLE)
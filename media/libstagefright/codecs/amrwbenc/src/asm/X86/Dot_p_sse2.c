@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: Dot_p_sse2.c                                             *
+*                                                                      *
+*       Description: SSE2 version of Dot_product12(), bit exact with   *
+*                    math_op.c                                         *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "math_op.h"
+
+Word32 Dot_product12_asm(                  /* (o) Q31: normalized result (1 < val <= -1) */
+		Word16 x[],                           /* (i) 12bits: x vector                       */
+		Word16 y[],                           /* (i) 12bits: y vector                       */
+		Word16 lg,                            /* (i)    : vector length                     */
+		Word16 * exp                          /* (o)    : exponent of result (0..+30)       */
+		)
+{
+	Word16 sft;
+	Word32 i, L_sum;
+	__m128i acc;
+
+	/* the C version also lets the sum wrap around */
+	acc = _mm_setzero_si128();
+	for (i = 0; i + 8 <= lg; i += 8)
+	{
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((__m128i *)&x[i]),
+					_mm_loadu_si128((__m128i *)&y[i])));
+	}
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+	L_sum = _mm_cvtsi128_si32(acc);
+	for (; i < lg; i++)
+	{
+		L_sum += x[i] * y[i];
+	}
+
+	L_sum = (L_sum << 1) + 1;
+	/* Normalize acc in Q31 */
+	sft = norm_l(L_sum);
+	L_sum = L_sum << sft;
+	*exp = 30 - sft;            /* exponent = 0..30 */
+	return (L_sum);
+}
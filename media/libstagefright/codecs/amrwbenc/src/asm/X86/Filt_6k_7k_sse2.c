@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: Filt_6k_7k_sse2.c                                        *
+*                                                                      *
+*       Description: SSE2 version of Filt_6k_7k(), bit exact with      *
+*                    hp6k.c                                            *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+
+#define L_FIR 31
+
+/* defined in hp6k.c */
+extern Word16 fir_6k_7k[L_FIR];
+
+/* x[] is signal[] >> 2, so the sums of the two samples that share a
+ * coefficient of the symmetric filter fit in 16 bits. Taps k and k+1 of
+ * those sums are interleaved and multiplied with one madd for 4 outputs; the
+ * middle tap is paired with a zero. */
+
+void Filt_6k_7k_asm(
+		Word16 signal[],                      /* input:  signal                  */
+		Word16 lg,                            /* input:  length of input         */
+		Word16 mem[]                          /* in/out: memory (size=30)        */
+		)
+{
+	Word16 x[L_SUBFR16k + (L_FIR - 1) + 8];
+	__m128i coef[8], p0, p1, lo, hi, round;
+	Word32 i, k, L_tmp;
+
+	for (i = 0; i < L_FIR - 1; i++)
+	{
+		x[i] = mem[i];
+	}
+	for (i = lg - 1; i >= 0; i--)
+	{
+		x[i + L_FIR - 1] = signal[i] >> 2;                         /* gain of filter = 4 */
+	}
+
+	for (k = 0; k < 16; k += 2)
+	{
+		coef[k >> 1] = _mm_set1_epi32((fir_6k_7k[k + 1] << 16) | (fir_6k_7k[k] & 0xffff));
+	}
+	round = _mm_set1_epi32(0x4000);
+
+	for (i = 0; i + 8 <= lg; i += 8)
+	{
+		lo = hi = _mm_setzero_si128();
+		for (k = 0; k < 14; k += 2)
+		{
+			p0 = _mm_add_epi16(_mm_loadu_si128((__m128i *)&x[i + k]),
+					_mm_loadu_si128((__m128i *)&x[i + 30 - k]));
+			p1 = _mm_add_epi16(_mm_loadu_si128((__m128i *)&x[i + k + 1]),
+					_mm_loadu_si128((__m128i *)&x[i + 29 - k]));
+			lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(p0, p1), coef[k >> 1]));
+			hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(p0, p1), coef[k >> 1]));
+		}
+		/* taps 14 and 15 */
+		p0 = _mm_add_epi16(_mm_loadu_si128((__m128i *)&x[i + 14]),
+				_mm_loadu_si128((__m128i *)&x[i + 16]));
+		p1 = _mm_loadu_si128((__m128i *)&x[i + 15]);
+		lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(p0, p1), coef[7]));
+		hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(p0, p1), coef[7]));
+
+		/* signal[i] = (Word16)((L_tmp + 0x4000) >> 15), without saturation */
+		lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 15);
+		hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 15);
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i *)&signal[i], _mm_packs_epi32(lo, hi));
+	}
+
+	for (; i < lg; i++)
+	{
+		L_tmp = x[i + 15] * fir_6k_7k[15];
+		for (k = 0; k < 15; k++)
+		{
+			L_tmp += (x[i + k] + x[i + 30 - k]) * fir_6k_7k[k];
+		}
+		signal[i] = (L_tmp + 0x4000) >> 15;
+	}
+
+	for (i = 0; i < L_FIR - 1; i++)
+	{
+		mem[i] = x[lg + i];
+	}
+
+	return;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: Norm_Corr_sse2.c                                         *
+*                                                                      *
+*       Description: SSE2 version of Norm_Corr(), bit exact with       *
+*                    pitch_f4.c                                        *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "math_op.h"
+#include "acelp.h"
+
+/* The two correlations of each lag are formed with madd. For the next lag,
+ * excf[i] = vo_mult(tmp, h[i]) + excf[i - 1] is formed 8 samples at a time
+ * into a second buffer: the low 16 bits of (tmp * h[i]) >> 15 come from
+ * mulhi and mullo, which is all the Word16 store of the C version keeps. The
+ * buffers hold excf[] at index 1, after a zero, so that excf[i - 1] is an
+ * unaligned load. */
+
+static inline Word32 sum4(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(v);
+}
+
+void Norm_corr_asm(
+		Word16 exc[],                         /* (i)     : excitation buffer                     */
+		Word16 xn[],                          /* (i)     : target vector                         */
+		Word16 h[],                           /* (i) Q15 : impulse response of synth/wgt filters */
+		Word16 L_subfr,
+		Word16 t_min,                         /* (i)     : minimum value of pitch lag.           */
+		Word16 t_max,                         /* (i)     : maximum value of pitch lag.           */
+		Word16 corr_norm[])                   /* (o) Q15 : normalized correlation                */
+{
+	Word32 i, t;
+	Word32 corr, exp_corr, norm, exp, scale;
+	Word16 exp_norm;
+	Word16 buf0[8 + 64], buf1[8 + 64];
+	Word16 *excf, *next, *swap;
+	Word32 L_tmp, L_tmp1, L_tmp2;
+	__m128i xv[8], hv[8], acc0, acc1, e, m, lo, hi;
+
+	(void)L_subfr;
+	excf = &buf0[1];
+	next = &buf1[1];
+	buf0[0] = buf1[0] = 0;
+
+	/* compute the filtered excitation for the first delay t_min */
+	Convolve_asm(&exc[-t_min], h, excf, 64);
+
+	for (i = 0; i < 8; i++)
+	{
+		xv[i] = _mm_loadu_si128((__m128i *)&xn[8 * i]);
+		hv[i] = _mm_loadu_si128((__m128i *)&h[8 * i]);
+	}
+
+	/* Compute rounded down 1/sqrt(energy of xn[]) */
+	acc0 = _mm_setzero_si128();
+	for (i = 0; i < 8; i++)
+	{
+		acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(xv[i], xv[i]));
+	}
+	L_tmp = sum4(acc0);
+
+	L_tmp = (L_tmp << 1) + 1;
+	exp = norm_l(L_tmp);
+	exp = (32 - exp);
+	scale = -(exp >> 1);           /* (1<<scale) < 1/sqrt(energy rounded) */
+
+	/* loop for every possible period */
+
+	for (t = t_min; t <= t_max; t++)
+	{
+		/* Compute correlation between xn[] and excf[] */
+		acc0 = acc1 = _mm_setzero_si128();
+		for (i = 0; i < 8; i++)
+		{
+			e = _mm_loadu_si128((__m128i *)&excf[8 * i]);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(xv[i], e));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(e, e));
+		}
+		L_tmp = sum4(acc0);
+		L_tmp1 = sum4(acc1);
+
+		L_tmp = (L_tmp << 1) + 1;
+		L_tmp1 = (L_tmp1 << 1) + 1;
+
+		exp = norm_l(L_tmp);
+		L_tmp = (L_tmp << exp);
+		exp_corr = (30 - exp);
+		corr = extract_h(L_tmp);
+
+		exp = norm_l(L_tmp1);
+		L_tmp = (L_tmp1 << exp);
+		exp_norm = (30 - exp);
+
+		Isqrt_n(&L_tmp, &exp_norm);
+		norm = extract_h(L_tmp);
+
+		/* Normalize correlation = correlation * (1/sqrt(energy)) */
+
+		L_tmp = vo_L_mult(corr, norm);
+
+		L_tmp2 = exp_corr + exp_norm + scale;
+		if(L_tmp2 < 0)
+		{
+			L_tmp2 = -L_tmp2;
+			L_tmp = L_tmp >> L_tmp2;
+		}
+		else
+		{
+			L_tmp = L_tmp << L_tmp2;
+		}
+
+		corr_norm[t] = vo_round(L_tmp);
+		/* modify the filtered excitation excf[] for the next iteration */
+
+		if(t != t_max)
+		{
+			m = _mm_set1_epi16(exc[-(t + 1)]);
+			for (i = 0; i < 8; i++)
+			{
+				lo = _mm_mullo_epi16(m, hv[i]);
+				hi = _mm_mulhi_epi16(m, hv[i]);
+				lo = _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+				e = _mm_loadu_si128((__m128i *)&excf[8 * i - 1]);
+				_mm_storeu_si128((__m128i *)&next[8 * i], _mm_add_epi16(lo, e));
+			}
+			swap = excf;
+			excf = next;
+			next = swap;
+		}
+	}
+	return;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: Syn_filt_32_sse2.c                                       *
+*                                                                      *
+*       Description: SSE2 version of Syn_filt_32(), bit exact with     *
+*                    syn_filt.c                                        *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+
+/* As in syn_filt_sse2.c, the part of the two sums that uses the outputs of
+ * earlier blocks is formed for 8 outputs at once, and the terms within the
+ * block one output at a time. Like the C version, a[0..15] are applied to
+ * sig[i-1..i-16]. The filtering is done in local copies of sig_hi[] and
+ * sig_lo[] in which the outputs not computed yet are zero. */
+
+void Syn_filt_32_asm(
+		Word16 a[],                           /* (i) Q12 : a[m+1] prediction coefficients */
+		Word16 m,                             /* (i)     : order of LP filter             */
+		Word16 exc[],                         /* (i) Qnew: excitation (exc[i] >> Qnew)    */
+		Word16 Qnew,                          /* (i)     : exc scaling = 0(min) to 8(max) */
+		Word16 sig_hi[],                      /* (o) /16 : synthesis high                 */
+		Word16 sig_lo[],                      /* (o) /16 : synthesis low                  */
+		Word16 lg                             /* (i)     : size of filtering              */
+		)
+{
+	Word16 hi_buf[M + L_SUBFR + 8], lo_buf[M + L_SUBFR + 8];
+	Word16 *hi, *lo;
+	__m128i coef[8], sh0, sh1, sl0, sl1, v0, v1;
+	Word32 i, j, k, a0, n;
+	Word32 L_tmp, L_tmp1;
+	Word32 past_hi[8], past_lo[8];
+
+	if (lg > L_SUBFR)
+	{
+		Syn_filt_32(a, m, exc, Qnew, sig_hi, sig_lo, lg);
+		return;
+	}
+
+	for (i = 0; i < M; i++)
+	{
+		hi_buf[i] = sig_hi[i - M];
+		lo_buf[i] = sig_lo[i - M];
+	}
+	for (i = M; i < M + L_SUBFR + 8; i++)
+	{
+		hi_buf[i] = lo_buf[i] = 0;
+	}
+	hi = &hi_buf[M];
+	lo = &lo_buf[M];
+
+	/* taps k and k+1 for k = 0, 2, .. 14 */
+	for (k = 0; k < 16; k += 2)
+	{
+		coef[k >> 1] = _mm_set1_epi32((a[k + 1] << 16) | (a[k] & 0xffff));
+	}
+	a0 = a[0] >> (4 + Qnew);          /* input / 16 and >>Qnew */
+
+	for (i = 0; i < lg; i += 8)
+	{
+		sh0 = sh1 = sl0 = sl1 = _mm_setzero_si128();
+		for (k = 0; k < 16; k += 2)
+		{
+			v0 = _mm_loadu_si128((__m128i *)&hi[i - 1 - k]);
+			v1 = _mm_loadu_si128((__m128i *)&hi[i - 2 - k]);
+			sh0 = _mm_sub_epi32(sh0, _mm_madd_epi16(_mm_unpacklo_epi16(v0, v1), coef[k >> 1]));
+			sh1 = _mm_sub_epi32(sh1, _mm_madd_epi16(_mm_unpackhi_epi16(v0, v1), coef[k >> 1]));
+			v0 = _mm_loadu_si128((__m128i *)&lo[i - 1 - k]);
+			v1 = _mm_loadu_si128((__m128i *)&lo[i - 2 - k]);
+			sl0 = _mm_sub_epi32(sl0, _mm_madd_epi16(_mm_unpacklo_epi16(v0, v1), coef[k >> 1]));
+			sl1 = _mm_sub_epi32(sl1, _mm_madd_epi16(_mm_unpackhi_epi16(v0, v1), coef[k >> 1]));
+		}
+		_mm_storeu_si128((__m128i *)&past_hi[0], sh0);
+		_mm_storeu_si128((__m128i *)&past_hi[4], sh1);
+		_mm_storeu_si128((__m128i *)&past_lo[0], sl0);
+		_mm_storeu_si128((__m128i *)&past_lo[4], sl1);
+
+		n = (lg - i < 8) ? lg - i : 8;
+		for (j = 0; j < n; j++)
+		{
+			L_tmp = past_lo[j];
+			L_tmp1 = past_hi[j];
+			for (k = 0; k < j; k++)
+			{
+				L_tmp -= vo_mult32(lo[i + j - 1 - k], a[k]);
+				L_tmp1 -= vo_mult32(hi[i + j - 1 - k], a[k]);
+			}
+
+			L_tmp = L_tmp >> 11;
+			L_tmp += vo_L_mult(exc[i + j], a0);
+
+			/* sig_hi = bit16 to bit31 of synthesis */
+			L_tmp = L_tmp - (L_tmp1<<1);
+
+			L_tmp = L_tmp >> 3;           /* ai in Q12 */
+			hi[i + j] = extract_h(L_tmp);
+
+			/* sig_lo = bit4 to bit15 of synthesis */
+			L_tmp >>= 4;           /* 4 : sig_lo[i] >> 4 */
+			lo[i + j] = (Word16)((L_tmp - (hi[i + j] << 13)));
+		}
+	}
+
+	for (i = 0; i < lg; i++)
+	{
+		sig_hi[i] = hi[i];
+		sig_lo[i] = lo[i];
+	}
+
+	return;
+}
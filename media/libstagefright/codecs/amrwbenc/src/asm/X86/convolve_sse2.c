@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: convolve_sse2.c                                          *
+*                                                                      *
+*       Description: SSE2 version of Convolve(), bit exact with        *
+*                    convolve.c                                        *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+
+/* y[n] = sum(x[k] * h[n-k]), k = 0..n, is the dot product of x[] with h[]
+ * reversed. With hr[63-m] = h[m] and zeros after it, y[n] is the dot product
+ * of x[0..] with hr[63-n..], and the terms past k = n are zero. Four outputs
+ * are formed together, in blocks of 8 terms. */
+
+void Convolve_asm(
+		Word16 x[],        /* (i)     : input vector                           */
+		Word16 h[],        /* (i)     : impulse response                       */
+		Word16 y[],        /* (o)     : output vector                          */
+		Word16 L           /* (i)     : vector size                            */
+		)
+{
+	Word16 hr[2 * 64] __attribute__((aligned(16)));
+	__m128i acc0, acc1, acc2, acc3, xv, t0, t1, s;
+	Word32 i, n, k;
+
+	(void)L;
+	for (i = 0; i < 64; i++)
+	{
+		hr[63 - i] = h[i];
+		hr[64 + i] = 0;
+	}
+
+	for (n = 0; n < 64; n += 4)
+	{
+		acc0 = acc1 = acc2 = acc3 = _mm_setzero_si128();
+		/* terms k = 0..n+3 */
+		for (k = 0; k <= n + 3; k += 8)
+		{
+			xv = _mm_loadu_si128((__m128i *)&x[k]);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(xv, _mm_loadu_si128((__m128i *)&hr[63 - n + k])));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(xv, _mm_loadu_si128((__m128i *)&hr[62 - n + k])));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(xv, _mm_loadu_si128((__m128i *)&hr[61 - n + k])));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(xv, _mm_loadu_si128((__m128i *)&hr[60 - n + k])));
+		}
+		/* s = { sum(acc0), sum(acc1), sum(acc2), sum(acc3) } */
+		t0 = _mm_add_epi32(_mm_unpacklo_epi32(acc0, acc1), _mm_unpackhi_epi32(acc0, acc1));
+		t1 = _mm_add_epi32(_mm_unpacklo_epi32(acc2, acc3), _mm_unpackhi_epi32(acc2, acc3));
+		s = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1));
+
+		/* y[n] = ((s << 1) + 0x8000) >> 16 */
+		s = _mm_add_epi32(_mm_slli_epi32(s, 1), _mm_set1_epi32(0x8000));
+		s = _mm_srai_epi32(s, 16);
+		_mm_storel_epi64((__m128i *)&y[n], _mm_packs_epi32(s, s));
+	}
+
+	return;
+}
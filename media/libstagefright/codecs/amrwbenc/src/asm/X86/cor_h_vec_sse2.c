@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: cor_h_vec_sse2.c                                         *
+*                                                                      *
+*       Description: SSE2 version of cor_h_vec_012(), bit exact with   *
+*                    c4t64fx.c                                         *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+
+#define L_SUBFR   64
+#define STEP      4
+#define NB_POS    16
+
+/* The correlations of h[] with vec[pos..63] and vec[pos+1..63] are dot
+ * products of h[0..63] with a copy of vec[] padded with zeros, which gives
+ * the same terms as the C loops plus terms that are zero. */
+
+static inline Word32 sum4(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(v);
+}
+
+void cor_h_vec_012_asm(
+		Word16 h[],                           /* (i) scaled impulse response                 */
+		Word16 vec[],                         /* (i) scaled vector (/8) to correlate with h[] */
+		Word16 track,                         /* (i) track to use                            */
+		Word16 sign[],                        /* (i) sign vector                             */
+		Word16 rrixix[][NB_POS],              /* (i) correlation of h[x] with h[x]      */
+		Word16 cor_1[],                       /* (o) result of correlation (NB_POS elements) */
+		Word16 cor_2[]                        /* (o) result of correlation (NB_POS elements) */
+		)
+{
+	Word16 vz[2 * L_SUBFR + 8];
+	__m128i hv[8], acc1, acc2;
+	Word32 i, j, pos, corr;
+	Word32 L_sum1, L_sum2;
+	Word16 *p0, *p3;
+
+	for (i = 0; i < L_SUBFR; i++)
+	{
+		vz[i] = vec[i];
+	}
+	for (; i < 2 * L_SUBFR + 8; i++)
+	{
+		vz[i] = 0;
+	}
+	for (j = 0; j < 8; j++)
+	{
+		hv[j] = _mm_loadu_si128((__m128i *)&h[8 * j]);
+	}
+
+	p0 = rrixix[track];
+	p3 = rrixix[track + 1];
+	pos = track;
+
+	for (i = 0; i < NB_POS; i++)
+	{
+		acc1 = acc2 = _mm_setzero_si128();
+		/* h[j] for j > 63 - pos only meets zeros */
+		for (j = 0; j < (L_SUBFR - pos + 7) >> 3; j++)
+		{
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(hv[j], _mm_loadu_si128((__m128i *)&vz[pos + 8 * j])));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(hv[j], _mm_loadu_si128((__m128i *)&vz[pos + 1 + 8 * j])));
+		}
+		L_sum1 = sum4(acc1) << 2;
+		L_sum2 = sum4(acc2) << 2;
+
+		corr = (L_sum1 + 0x8000) >> 16;
+		cor_1[i] = vo_mult(corr, sign[pos]) + (*p0++);
+		corr = (L_sum2 + 0x8000) >> 16;
+		cor_2[i] = vo_mult(corr, sign[pos + 1]) + (*p3++);
+		pos += STEP;
+	}
+
+	return;
+}
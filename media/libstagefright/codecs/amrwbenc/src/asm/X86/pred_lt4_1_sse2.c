@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: pred_lt4_1_sse2.c                                        *
+*                                                                      *
+*       Description: SSE2 version of Pred_lt4(), bit exact with        *
+*                    pred_lt4.c                                        *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "acelp.h"
+
+#define UP_SAMP      4
+#define L_INTERPOL2  16
+
+/* defined in pred_lt4.c */
+extern Word16 inter4_2[4][32];
+
+/* exc[j] is interpolated from exc[j-T0-16..j-T0+16], so when the lag is
+ * shorter than the subframe the filter reads what it has just written. With
+ * T0 >= 24 the 8 outputs of a block only read samples from before the
+ * block, and they are formed together: taps k and k+1 are interleaved and
+ * multiplied with one madd for 4 outputs. L_shl2(L_sum, 2) and the saturated
+ * rounding of the C version are ((L_sum >> 13) + 1) >> 1 saturated to 16
+ * bits. Shorter lags use the C version. */
+
+void pred_lt4_asm(
+		Word16 exc[],                         /* in/out: excitation buffer */
+		Word16 T0,                            /* input : integer pitch lag */
+		Word16 frac,                          /* input : fraction of lag   */
+		Word16 L_subfr                        /* input : subframe size     */
+		)
+{
+	Word16 *x, *ptr2;
+	__m128i coef[16], lo, hi, v0, v1, one;
+	Word32 j, k, L_sum;
+
+	if (T0 < 24)
+	{
+		Pred_lt4(exc, T0, frac, L_subfr);
+		return;
+	}
+
+	x = exc - T0;
+	frac = -frac;
+	if (frac < 0)
+	{
+		frac += UP_SAMP;
+		x--;
+	}
+	x -= 15;                                     /* x = L_INTERPOL2 - 1 */
+	k = 3 - frac;                                /* k = UP_SAMP - 1 - frac */
+
+	ptr2 = &(inter4_2[k][0]);
+	for (k = 0; k < 32; k += 2)
+	{
+		coef[k >> 1] = _mm_set1_epi32((ptr2[k + 1] << 16) | (ptr2[k] & 0xffff));
+	}
+	one = _mm_set1_epi32(1);
+
+	for (j = 0; j + 8 <= L_subfr; j += 8)
+	{
+		lo = hi = _mm_setzero_si128();
+		for (k = 0; k < 32; k += 2)
+		{
+			v0 = _mm_loadu_si128((__m128i *)&x[j + k]);
+			v1 = _mm_loadu_si128((__m128i *)&x[j + k + 1]);
+			lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(v0, v1), coef[k >> 1]));
+			hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(v0, v1), coef[k >> 1]));
+		}
+		lo = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(lo, 13), one), 1);
+		hi = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(hi, 13), one), 1);
+		_mm_storeu_si128((__m128i *)&exc[j], _mm_packs_epi32(lo, hi));
+	}
+
+	for (; j < L_subfr; j++)
+	{
+		L_sum = 0;
+		for (k = 0; k < 32; k++)
+		{
+			L_sum += vo_mult32(x[j + k], ptr2[k]);
+		}
+		L_sum = L_shl2(L_sum, 2);
+		exc[j] = extract_h(L_add(L_sum, 0x8000));
+	}
+
+	return;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: residu_sse2.c                                            *
+*                                                                      *
+*       Description: SSE2 version of Residu(), bit exact with          *
+*                    residu.c                                          *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+
+/* Eight outputs are formed together. Taps j and j+1 are interleaved so that
+ * one madd gives a[j] * x[i-j] + a[j+1] * x[i-j-1] for four outputs; tap 16
+ * is paired with a zero. Then L_shl2(s, 5) and the saturated rounding of
+ * the C version are ((s >> 10) + 1) >> 1 saturated to 16 bits. */
+
+void Residu_opt(
+		Word16 a[],                           /* (i) Q12 : prediction coefficients                     */
+		Word16 x[],                           /* (i)     : speech (values x[-m..-1] are needed         */
+		Word16 y[],                           /* (o) x2  : residual signal                             */
+		Word16 lg                             /* (i)     : size of filtering                           */
+		)
+{
+	__m128i coef[9], lo, hi, v0, v1, one;
+	Word32 i, j, s;
+
+	for (j = 0; j < 16; j += 2)
+	{
+		coef[j >> 1] = _mm_set1_epi32((a[j + 1] << 16) | (a[j] & 0xffff));
+	}
+	coef[8] = _mm_set1_epi32(a[16] & 0xffff);
+	one = _mm_set1_epi32(1);
+
+	for (i = 0; i + 8 <= lg; i += 8)
+	{
+		lo = hi = _mm_setzero_si128();
+		for (j = 0; j < 16; j += 2)
+		{
+			v0 = _mm_loadu_si128((__m128i *)&x[i - j]);
+			v1 = _mm_loadu_si128((__m128i *)&x[i - j - 1]);
+			lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(v0, v1), coef[j >> 1]));
+			hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(v0, v1), coef[j >> 1]));
+		}
+		v0 = _mm_loadu_si128((__m128i *)&x[i - 16]);
+		v1 = _mm_setzero_si128();
+		lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(v0, v1), coef[8]));
+		hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(v0, v1), coef[8]));
+
+		lo = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(lo, 10), one), 1);
+		hi = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(hi, 10), one), 1);
+		_mm_storeu_si128((__m128i *)&y[i], _mm_packs_epi32(lo, hi));
+	}
+
+	for (; i < lg; i++)
+	{
+		s = 0;
+		for (j = 0; j <= 16; j++)
+		{
+			s += vo_mult32(a[j], x[i - j]);
+		}
+		s = L_shl2(s, 5);
+		y[i] = extract_h(L_add(s, 0x8000));
+	}
+
+	return;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: scale_sig_sse2.c                                         *
+*                                                                      *
+*       Description: SSE2 version of Scale_sig(), bit exact with       *
+*                    scale.c                                           *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "acelp.h"
+
+/* For 0 < exp <= 15, the saturated L_shl2(x, 16 + exp) rounded to 16 bits is
+ * x << exp saturated to 16 bits. For exp <= 0 the C version shifts x << 16
+ * right by -exp and rounds, which can be done in 32 bit lanes as it is. Other
+ * exponents go to the C version. */
+
+void Scale_sig_opt(
+		Word16 x[],                           /* (i/o) : signal to scale               */
+		Word16 lg,                            /* (i)   : size of x[]                   */
+		Word16 exp                            /* (i)   : exponent: x = round(x << exp) */
+		)
+{
+	__m128i v, lo, hi, round, shift;
+	Word32 i;
+
+	if (exp > 15 || exp < -31)
+	{
+		Scale_sig(x, lg, exp);
+		return;
+	}
+
+	if (exp > 0)
+	{
+		shift = _mm_cvtsi32_si128(exp);
+		for (i = 0; i + 8 <= lg; i += 8)
+		{
+			v = _mm_loadu_si128((__m128i *)&x[i]);
+			lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+			hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+			lo = _mm_sll_epi32(lo, shift);
+			hi = _mm_sll_epi32(hi, shift);
+			_mm_storeu_si128((__m128i *)&x[i], _mm_packs_epi32(lo, hi));
+		}
+	}
+	else
+	{
+		shift = _mm_cvtsi32_si128(-exp);
+		round = _mm_set1_epi32(0x8000);
+		for (i = 0; i + 8 <= lg; i += 8)
+		{
+			v = _mm_loadu_si128((__m128i *)&x[i]);
+			/* x[i] << 16 */
+			lo = _mm_unpacklo_epi16(_mm_setzero_si128(), v);
+			hi = _mm_unpackhi_epi16(_mm_setzero_si128(), v);
+			lo = _mm_srai_epi32(_mm_add_epi32(_mm_sra_epi32(lo, shift), round), 16);
+			hi = _mm_srai_epi32(_mm_add_epi32(_mm_sra_epi32(hi, shift), round), 16);
+			_mm_storeu_si128((__m128i *)&x[i], _mm_packs_epi32(lo, hi));
+		}
+	}
+
+	if (i < lg)
+	{
+		Scale_sig(&x[i], lg - i, exp);
+	}
+
+	return;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***********************************************************************
+*       File: syn_filt_sse2.c                                          *
+*                                                                      *
+*       Description: SSE2 version of Syn_filt() with lg = L_SUBFR16k   *
+*                    and update = 1, bit exact with syn_filt.c         *
+*                                                                      *
+************************************************************************/
+
+#include <emmintrin.h>
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "cnst.h"
+
+/* The outputs are formed in blocks of 8. The part of the sum that uses the
+ * outputs of earlier blocks is formed for the 8 outputs at once, with the
+ * outputs of the block itself still zero in y_buf[]; the terms within the
+ * block are then added one output at a time. The sums wrap around like in
+ * the C version, so the order of the terms does not matter. */
+
+void Syn_filt_asm(
+		Word16 a[],                           /* (i) Q12 : a[m+1] prediction coefficients           */
+		Word16 x[],                           /* (i)     : input signal                             */
+		Word16 y[],                           /* (o)     : output signal                            */
+		Word16 mem[]                          /* (i/o)   : memory associated with this filtering.   */
+		)
+{
+	Word16 y_buf[M16k + L_SUBFR16k];
+	Word16 *yy;
+	__m128i coef[8], lo, hi, v0, v1;
+	Word32 i, j, m, a0, L_tmp;
+	Word32 past[8];
+
+	for (i = 0; i < 16; i++)
+	{
+		y_buf[i] = mem[i];
+	}
+	for (i = 16; i < M16k + L_SUBFR16k; i++)
+	{
+		y_buf[i] = 0;
+	}
+	yy = &y_buf[16];
+
+	/* taps j and j+1 for j = 1, 3, .. 15 */
+	for (j = 1; j < 16; j += 2)
+	{
+		coef[j >> 1] = _mm_set1_epi32((a[j + 1] << 16) | (a[j] & 0xffff));
+	}
+	a0 = (a[0] >> 1);                     /* input / 2 */
+
+	for (i = 0; i < L_SUBFR16k; i += 8)
+	{
+		lo = hi = _mm_setzero_si128();
+		for (j = 1; j < 16; j += 2)
+		{
+			v0 = _mm_loadu_si128((__m128i *)&yy[i - j]);
+			v1 = _mm_loadu_si128((__m128i *)&yy[i - j - 1]);
+			lo = _mm_sub_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(v0, v1), coef[j >> 1]));
+			hi = _mm_sub_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(v0, v1), coef[j >> 1]));
+		}
+		_mm_storeu_si128((__m128i *)&past[0], lo);
+		_mm_storeu_si128((__m128i *)&past[4], hi);
+
+		for (m = 0; m < 8; m++)
+		{
+			L_tmp = past[m] + vo_mult32(a0, x[i + m]);
+			for (j = 1; j <= m; j++)
+			{
+				L_tmp -= vo_mult32(a[j], yy[i + m - j]);
+			}
+			L_tmp = L_shl2(L_tmp, 4);
+			y[i + m] = yy[i + m] = extract_h(L_add(L_tmp, 0x8000));
+		}
+	}
+
+	for (i = 0; i < 16; i++)
+	{
+		mem[i] = yy[L_SUBFR16k - 16 + i];
+	}
+	return;
+}
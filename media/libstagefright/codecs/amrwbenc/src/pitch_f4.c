@@ -43,8 +43,10 @@ void Norm_corr_asm(
 		Word16 t_max,                         /* (i)     : maximum value of pitch lag.           */
 		Word16 corr_norm[]                    /* (o) Q15 : normalized correlation                */
 		);
-#else
-static void Norm_Corr(
+#endif
+
+/* not static, so that the asm versions can be checked against it */
+void Norm_Corr(
 		Word16 exc[],                         /* (i)     : excitation buffer                     */
 		Word16 xn[],                          /* (i)     : target vector                         */
 		Word16 h[],                           /* (i) Q15 : impulse response of synth/wgt filters */
@@ -53,7 +55,6 @@ static void Norm_Corr(
 		Word16 t_max,                         /* (i)     : maximum value of pitch lag.           */
 		Word16 corr_norm[]                    /* (o) Q15 : normalized correlation                */
 		);
-#endif
 
 static Word16 Interpol_4(                  /* (o)  : interpolated value  */
 		Word16 * x,                           /* (i)  : input vector        */
@@ -157,8 +158,7 @@ Word16 Pitch_fr4(                          /* (o)     : pitch period.
 * (correlation between target and filtered excitation divided by the                *
 *  square root of energy of target and filtered excitation).                        *
 ************************************************************************************/
-#ifndef ASM_OPT
-static void Norm_Corr(
+void Norm_Corr(
 		Word16 exc[],                         /* (i)     : excitation buffer                     */
 		Word16 xn[],                          /* (i)     : target vector                         */
 		Word16 h[],                           /* (i) Q15 : impulse response of synth/wgt filters */
@@ -263,7 +263,6 @@ static void Norm_Corr(
 	return;
 }
 
-#endif
 /************************************************************************************
 * Function: Interpol_4()                                                             *
 *                                                                                    *
@@ -0,0 +1,643 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * With AMRWBENC_SSE2, checks that each SSE2 kernel of src/asm/X86 gives
+ * exactly what the C function it replaces gives on random input, and prints
+ * the time each of them takes.
+ *
+ * Then encodes 16 kHz mono PCM (a synthetic voice-like signal, or the given
+ * raw file) in each of the nine modes and prints the realtime factor of the
+ * encoder (seconds of audio encoded per second on one core) and a checksum
+ * of the bitstream, which is the same with and without AMRWBENC_SSE2.
+ *
+ * Usage: amrwbenc_bench [-n seconds] [-r repeat] [-d] [file.pcm]
+ */
+
+/* Include system headers before local headers - the local headers
+ * redefine __inline, which can mess up definitions in libc headers if
+ * they happen to use __inline. */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "voAMRWB.h"
+#include "cmnMemory.h"
+#include "typedef.h"
+#include "basic_op.h"
+#include "math_op.h"
+#include "acelp.h"
+#include "cnst.h"
+
+/* typedefs.h renames the library's Copy(), not the field of VO_MEM_OPERATOR */
+#undef Copy
+
+#define PCM_FRAME_BYTES (L_FRAME16k * 2)
+
+static int64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+#ifdef AMRWBENC_SSE2
+
+#define NB_POS 16
+
+/* defined in c4t64fx.c and pitch_f4.c */
+void cor_h_vec_012(Word16 h[], Word16 vec[], Word16 track, Word16 sign[],
+        Word16 rrixix[][NB_POS], Word16 cor_1[], Word16 cor_2[]);
+void cor_h_vec_012_asm(Word16 h[], Word16 vec[], Word16 track, Word16 sign[],
+        Word16 rrixix[][NB_POS], Word16 cor_1[], Word16 cor_2[]);
+void Norm_Corr(Word16 exc[], Word16 xn[], Word16 h[], Word16 L_subfr,
+        Word16 t_min, Word16 t_max, Word16 corr_norm[]);
+void Norm_corr_asm(Word16 exc[], Word16 xn[], Word16 h[], Word16 L_subfr,
+        Word16 t_min, Word16 t_max, Word16 corr_norm[]);
+
+static uint32_t gSeed = 1;
+
+static Word32 random32(void)
+{
+    uint32_t hi;
+
+    gSeed = gSeed * 1103515245 + 12345;
+    hi = gSeed >> 16;
+    gSeed = gSeed * 1103515245 + 12345;
+    return (Word32)((hi << 16) | (gSeed >> 16));
+}
+
+/* 0..n-1 */
+static int randomBelow(int n)
+{
+    return (int)((uint32_t)random32() % n);
+}
+
+/* Mostly values of the given number of bits, with some full scale ones to
+ * exercise the saturation and the wrap around of the fixed point code. */
+static Word16 randomSample(int bits)
+{
+    Word32 x = random32();
+
+    if ((x & 0x3f) == 0)
+        return (Word16)(x >> 16);
+    return (Word16)(x >> (32 - bits));
+}
+
+static void randomVector(Word16 *x, int n, int bits)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        x[i] = randomSample(bits);
+}
+
+/* LP coefficients in Q12, a[0] = 4096, as the encoder passes them. */
+static void randomFilter(Word16 *a, int bits)
+{
+    randomVector(a, M + 1, bits);
+    a[0] = 4096;
+}
+
+static int report(const char *name, int iterations, int64_t c, int64_t sse2)
+{
+    printf("%s: ok, C %.1f ns SSE2 %.1f ns\n", name,
+           (double)c / iterations, (double)sse2 / iterations);
+    return 0;
+}
+
+static int mismatch(const char *name, int iteration)
+{
+    printf("%s: FAILED at iteration %d\n", name, iteration);
+    return 1;
+}
+
+static int checkConvolve(int iterations)
+{
+    Word16 x[L_SUBFR], h[L_SUBFR], y[L_SUBFR], ySse2[L_SUBFR];
+    int64_t a, b, c;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        randomVector(x, L_SUBFR, 16);
+        randomVector(h, L_SUBFR, 16);
+        Convolve(x, h, y, L_SUBFR);
+        Convolve_asm(x, h, ySse2, L_SUBFR);
+        if (memcmp(y, ySse2, sizeof(y)))
+            return mismatch("Convolve", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        Convolve(x, h, y, L_SUBFR);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        Convolve_asm(x, h, ySse2, L_SUBFR);
+    c = nowNs();
+    return report("Convolve", iterations, b - a, c - b);
+}
+
+static int checkDotProduct(int iterations)
+{
+    static const Word16 lengths[3] = { L_SUBFR, L_SUBFR16k, 37 };
+    Word16 x[L_SUBFR16k], y[L_SUBFR16k];
+    Word16 exp, expSse2;
+    Word32 s, sSse2;
+    int64_t a, b, c;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        Word16 lg = lengths[i % 3];
+        /* the encoder keeps the vectors to 12 bits */
+        randomVector(x, lg, (i & 1) ? 12 : 16);
+        randomVector(y, lg, (i & 1) ? 12 : 16);
+        s = Dot_product12(x, y, lg, &exp);
+        sSse2 = Dot_product12_asm(x, y, lg, &expSse2);
+        if (s != sSse2 || exp != expSse2)
+            return mismatch("Dot_product12", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        s += Dot_product12(x, y, L_SUBFR, &exp);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        sSse2 += Dot_product12_asm(x, y, L_SUBFR, &expSse2);
+    c = nowNs();
+    return report("Dot_product12", iterations, b - a, c - b);
+}
+
+static int checkResidu(int iterations)
+{
+    static const Word16 lengths[4] = { L_SUBFR, L_FRAME, L_SUBFR / 2, 21 };
+    Word16 a[M + 1], x[M + L_FRAME], y[L_FRAME], ySse2[L_FRAME];
+    int64_t t0, t1, t2;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        Word16 lg = lengths[i % 4];
+        randomFilter(a, (i & 1) ? 13 : 16);
+        randomVector(x, M + lg, (i & 2) ? 12 : 16);
+        Residu(a, &x[M], y, lg);
+        Residu_opt(a, &x[M], ySse2, lg);
+        if (memcmp(y, ySse2, lg * sizeof(Word16)))
+            return mismatch("Residu", i);
+    }
+
+    t0 = nowNs();
+    for (i = 0; i < iterations; i++)
+        Residu(a, &x[M], y, L_SUBFR);
+    t1 = nowNs();
+    for (i = 0; i < iterations; i++)
+        Residu_opt(a, &x[M], ySse2, L_SUBFR);
+    t2 = nowNs();
+    return report("Residu", iterations, t1 - t0, t2 - t1);
+}
+
+static int checkScaleSig(int iterations)
+{
+    static const Word16 lengths[3] = { L_SUBFR, L_FRAME, L_SUBFR16k };
+    Word16 x[L_FRAME], xSse2[L_FRAME];
+    int64_t a, b, c;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        Word16 lg = lengths[i % 3];
+        /* the encoder scales by -16..15 */
+        Word16 exp = (Word16)randomBelow(32) - 16;
+        randomVector(x, lg, 16 - (i % 16));
+        memcpy(xSse2, x, lg * sizeof(Word16));
+        Scale_sig(x, lg, exp);
+        Scale_sig_opt(xSse2, lg, exp);
+        if (memcmp(x, xSse2, lg * sizeof(Word16)))
+            return mismatch("Scale_sig", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        Scale_sig(x, L_FRAME, (i & 1) ? 1 : -1);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        Scale_sig_opt(xSse2, L_FRAME, (i & 1) ? 1 : -1);
+    c = nowNs();
+    return report("Scale_sig", iterations, b - a, c - b);
+}
+
+static int checkSynFilt(int iterations)
+{
+    Word16 a[M + 1], x[L_SUBFR16k], y[L_SUBFR16k], ySse2[L_SUBFR16k];
+    Word16 mem[M], memSse2[M];
+    int64_t t0, t1, t2;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        randomFilter(a, (i & 1) ? 12 : 16);
+        randomVector(x, L_SUBFR16k, (i & 2) ? 12 : 16);
+        randomVector(mem, M, 16);
+        memcpy(memSse2, mem, sizeof(mem));
+        Syn_filt(a, x, y, L_SUBFR16k, mem, 1);
+        Syn_filt_asm(a, x, ySse2, memSse2);
+        if (memcmp(y, ySse2, sizeof(y)) || memcmp(mem, memSse2, sizeof(mem)))
+            return mismatch("Syn_filt", i);
+    }
+
+    t0 = nowNs();
+    for (i = 0; i < iterations; i++)
+        Syn_filt(a, x, y, L_SUBFR16k, mem, 1);
+    t1 = nowNs();
+    for (i = 0; i < iterations; i++)
+        Syn_filt_asm(a, x, ySse2, memSse2);
+    t2 = nowNs();
+    return report("Syn_filt", iterations, t1 - t0, t2 - t1);
+}
+
+static int checkSynFilt32(int iterations)
+{
+    Word16 a[M + 1], exc[L_SUBFR];
+    Word16 hi[M + L_SUBFR], lo[M + L_SUBFR];
+    Word16 hiSse2[M + L_SUBFR], loSse2[M + L_SUBFR];
+    int64_t t0, t1, t2;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        Word16 Qnew = (Word16)randomBelow(9);
+        randomFilter(a, (i & 1) ? 12 : 16);
+        randomVector(exc, L_SUBFR, 16);
+        randomVector(hi, M, 16);
+        randomVector(lo, M, 12);
+        memcpy(hiSse2, hi, M * sizeof(Word16));
+        memcpy(loSse2, lo, M * sizeof(Word16));
+        Syn_filt_32(a, M, exc, Qnew, &hi[M], &lo[M], L_SUBFR);
+        Syn_filt_32_asm(a, M, exc, Qnew, &hiSse2[M], &loSse2[M], L_SUBFR);
+        if (memcmp(hi, hiSse2, sizeof(hi)) || memcmp(lo, loSse2, sizeof(lo)))
+            return mismatch("Syn_filt_32", i);
+    }
+
+    t0 = nowNs();
+    for (i = 0; i < iterations; i++)
+        Syn_filt_32(a, M, exc, 3, &hi[M], &lo[M], L_SUBFR);
+    t1 = nowNs();
+    for (i = 0; i < iterations; i++)
+        Syn_filt_32_asm(a, M, exc, 3, &hiSse2[M], &loSse2[M], L_SUBFR);
+    t2 = nowNs();
+    return report("Syn_filt_32", iterations, t1 - t0, t2 - t1);
+}
+
+static int checkDeemph32(int iterations)
+{
+    Word16 hi[L_SUBFR], lo[L_SUBFR], y[L_SUBFR], ySse2[L_SUBFR];
+    Word16 mem, memSse2;
+    int64_t a, b, c;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        randomVector(hi, L_SUBFR, 16);
+        randomVector(lo, L_SUBFR, 12);
+        mem = memSse2 = randomSample(16);
+        Deemph_32(hi, lo, y, PREEMPH_FAC, L_SUBFR, &mem);
+        Deemph_32_asm(hi, lo, ySse2, &memSse2);
+        if (memcmp(y, ySse2, sizeof(y)) || mem != memSse2)
+            return mismatch("Deemph_32", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        Deemph_32(hi, lo, y, PREEMPH_FAC, L_SUBFR, &mem);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        Deemph_32_asm(hi, lo, ySse2, &memSse2);
+    c = nowNs();
+    return report("Deemph_32", iterations, b - a, c - b);
+}
+
+static int checkFilt6k7k(int iterations)
+{
+    Word16 x[L_SUBFR16k], xSse2[L_SUBFR16k];
+    Word16 mem[30], memSse2[30];
+    int64_t a, b, c;
+    int i, k;
+
+    for (i = 0; i < iterations; i++) {
+        randomVector(x, L_SUBFR16k, 16);
+        /* the memory holds earlier input samples, divided by 4 */
+        randomVector(mem, 30, 16);
+        for (k = 0; k < 30; k++)
+            mem[k] >>= 2;
+        memcpy(xSse2, x, sizeof(x));
+        memcpy(memSse2, mem, sizeof(mem));
+        Filt_6k_7k(x, L_SUBFR16k, mem);
+        Filt_6k_7k_asm(xSse2, L_SUBFR16k, memSse2);
+        if (memcmp(x, xSse2, sizeof(x)) || memcmp(mem, memSse2, sizeof(mem)))
+            return mismatch("Filt_6k_7k", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        Filt_6k_7k(x, L_SUBFR16k, mem);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        Filt_6k_7k_asm(xSse2, L_SUBFR16k, memSse2);
+    c = nowNs();
+    return report("Filt_6k_7k", iterations, b - a, c - b);
+}
+
+static int checkPredLt4(int iterations)
+{
+    Word16 exc[PIT_MAX + L_INTERPOL + L_SUBFR + 1];
+    Word16 excSse2[PIT_MAX + L_INTERPOL + L_SUBFR + 1];
+    Word16 *p = &exc[PIT_MAX + L_INTERPOL], *pSse2 = &excSse2[PIT_MAX + L_INTERPOL];
+    int64_t a, b, c;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        /* a lag shorter than the subframe reads what it writes */
+        Word16 T0 = (Word16)(PIT_MIN + randomBelow(PIT_MAX - PIT_MIN + 1));
+        Word16 frac = (Word16)randomBelow(4);
+        if (i & 1)
+            T0 = (Word16)(PIT_MIN + randomBelow(L_SUBFR));
+        randomVector(exc, sizeof(exc) / sizeof(Word16), (i & 2) ? 14 : 16);
+        memcpy(excSse2, exc, sizeof(exc));
+        Pred_lt4(p, T0, frac, L_SUBFR + 1);
+        pred_lt4_asm(pSse2, T0, frac, L_SUBFR + 1);
+        if (memcmp(exc, excSse2, sizeof(exc)))
+            return mismatch("Pred_lt4", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        Pred_lt4(p, 100, 1, L_SUBFR + 1);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        pred_lt4_asm(pSse2, 100, 1, L_SUBFR + 1);
+    c = nowNs();
+    return report("Pred_lt4", iterations, b - a, c - b);
+}
+
+static int checkCorHVec(int iterations)
+{
+    Word16 h[L_SUBFR], vec[L_SUBFR], sign[L_SUBFR];
+    Word16 rrixix[4][NB_POS];
+    Word16 x[NB_POS], y[NB_POS], xSse2[NB_POS], ySse2[NB_POS];
+    int64_t a, b, c;
+    int i, k;
+
+    for (i = 0; i < iterations; i++) {
+        Word16 track = (Word16)(i % 3);
+        randomVector(h, L_SUBFR, (i & 1) ? 13 : 16);
+        randomVector(vec, L_SUBFR, (i & 2) ? 13 : 16);
+        for (k = 0; k < L_SUBFR; k++)
+            sign[k] = (random32() & 1) ? 32767 : -32767;
+        randomVector(rrixix[0], 4 * NB_POS, 14);
+        cor_h_vec_012(h, vec, track, sign, rrixix, x, y);
+        cor_h_vec_012_asm(h, vec, track, sign, rrixix, xSse2, ySse2);
+        if (memcmp(x, xSse2, sizeof(x)) || memcmp(y, ySse2, sizeof(y)))
+            return mismatch("cor_h_vec_012", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        cor_h_vec_012(h, vec, (Word16)(i % 3), sign, rrixix, x, y);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        cor_h_vec_012_asm(h, vec, (Word16)(i % 3), sign, rrixix, xSse2, ySse2);
+    c = nowNs();
+    return report("cor_h_vec_012", iterations, b - a, c - b);
+}
+
+static int checkNormCorr(int iterations)
+{
+    Word16 exc[PIT_MAX + L_INTERPOL + L_SUBFR], xn[L_SUBFR], h[L_SUBFR];
+    Word16 corr[PIT_MAX + L_INTERPOL + 1], corrSse2[PIT_MAX + L_INTERPOL + 1];
+    Word16 *p = &exc[PIT_MAX + L_INTERPOL];
+    int64_t a, b, c;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        /* the encoder scales exc[], xn[] and h[] to leave some headroom */
+        Word16 t_min = (Word16)(PIT_MIN + randomBelow(PIT_MAX - PIT_MIN - 16));
+        Word16 t_max = t_min + (Word16)randomBelow(17);
+        randomVector(exc, PIT_MAX + L_INTERPOL + L_SUBFR, 13);
+        randomVector(xn, L_SUBFR, 12);
+        randomVector(h, L_SUBFR, 14);
+        memset(corr, 0, sizeof(corr));
+        memset(corrSse2, 0, sizeof(corrSse2));
+        Norm_Corr(p, xn, h, L_SUBFR, t_min, t_max, corr);
+        Norm_corr_asm(p, xn, h, L_SUBFR, t_min, t_max, corrSse2);
+        if (memcmp(corr, corrSse2, sizeof(corr)))
+            return mismatch("Norm_Corr", i);
+    }
+
+    a = nowNs();
+    for (i = 0; i < iterations; i++)
+        Norm_Corr(p, xn, h, L_SUBFR, 100, 116, corr);
+    b = nowNs();
+    for (i = 0; i < iterations; i++)
+        Norm_corr_asm(p, xn, h, L_SUBFR, 100, 116, corrSse2);
+    c = nowNs();
+    return report("Norm_Corr", iterations, b - a, c - b);
+}
+
+#endif
+
+/* a voice-like signal: a pitch pulse train through two resonances, with
+ * a slowly varying pitch, pauses and some noise, so that every part of the
+ * encoder (and the VAD with -d) runs */
+static unsigned char *makeSignal(int seconds, long *size)
+{
+    long n = 16000L * seconds;
+    short *pcm = (short *)malloc(n * 2);
+    double y1 = 0, y2 = 0, z1 = 0, z2 = 0, phase = 0;
+    uint32_t seed = 5;
+    long i;
+
+    for (i = 0; i < n; i++) {
+        double t = (double)i / 16000;
+        double pitch = 120 + 60 * sin(2 * M_PI * 0.7 * t);
+        double env = sin(2 * M_PI * 0.4 * t);
+        double noise, e, s;
+
+        seed = seed * 1103515245 + 12345;
+        noise = (double)(seed >> 16) / 32768 - 1;
+        phase += pitch / 16000;
+        e = 0.1 * noise;
+        if (phase >= 1) {
+            phase -= 1;
+            e += 1;
+        }
+        /* 700 Hz and 1800 Hz formants */
+        s = e + 1.85 * y1 - 0.95 * y2;
+        y2 = y1;
+        y1 = s;
+        s = 0.1 * s + 1.12 * z1 - 0.9 * z2;
+        z2 = z1;
+        z1 = s;
+        s *= (env > 0.2) ? env : 0.01;
+        s = 0.3 * s + 0.002 * noise;
+        pcm[i] = (short)(32000 * (s > 1 ? 1 : s < -1 ? -1 : s));
+    }
+    *size = n * 2;
+    return (unsigned char *)pcm;
+}
+
+static int encode(const unsigned char *pcm, long size, VOAMRWBMODE mode, int dtx, int repeat)
+{
+    static const int kBitRates[9] = {
+        6600, 8850, 12650, 14250, 15850, 18250, 19850, 23050, 23850
+    };
+    VO_AUDIO_CODECAPI api;
+    VO_MEM_OPERATOR memOperator;
+    VO_CODEC_INIT_USERDATA userData;
+    unsigned char outBuf[256];
+    uint32_t checksum = 0;
+    long frames = 0;
+    int64_t elapsed = 0;
+    int r;
+
+    voGetAMRWBEncAPI(&api);
+    memOperator.Alloc = cmnMemAlloc;
+    memOperator.Copy = cmnMemCopy;
+    memOperator.Free = cmnMemFree;
+    memOperator.Set = cmnMemSet;
+    memOperator.Check = cmnMemCheck;
+    userData.memflag = VO_IMF_USERMEMOPERATOR;
+    userData.memData = &memOperator;
+
+    for (r = 0; r < repeat; r++) {
+        VO_HANDLE handle;
+        VOAMRWBFRAMETYPE type = VOAMRWB_RFC3267;
+        long offset;
+
+        if (api.Init(&handle, VO_AUDIO_CodingAMRWB, &userData) != VO_ERR_NONE) {
+            printf("cannot create the encoder\n");
+            return 1;
+        }
+        if (api.SetParam(handle, VO_PID_AMRWB_FRAMETYPE, &type) != VO_ERR_NONE
+                || api.SetParam(handle, VO_PID_AMRWB_MODE, &mode) != VO_ERR_NONE
+                || api.SetParam(handle, VO_PID_AMRWB_DTX, &dtx) != VO_ERR_NONE) {
+            printf("cannot configure the encoder for mode %d\n", mode);
+            api.Uninit(handle);
+            return 1;
+        }
+
+        for (offset = 0; offset + PCM_FRAME_BYTES <= size; offset += PCM_FRAME_BYTES) {
+            VO_CODECBUFFER in, out;
+            VO_AUDIO_OUTPUTINFO info;
+            int64_t start = nowNs();
+
+            in.Buffer = (unsigned char *)pcm + offset;
+            in.Length = PCM_FRAME_BYTES;
+            api.SetInputData(handle, &in);
+            out.Buffer = outBuf;
+            out.Length = sizeof(outBuf);
+            if (api.GetOutputData(handle, &out, &info) == VO_ERR_NONE) {
+                VO_U32 k;
+                elapsed += nowNs() - start;
+                frames++;
+                for (k = 0; r == 0 && k < out.Length; k++)
+                    checksum = checksum * 31 + out.Buffer[k];
+            }
+        }
+        api.Uninit(handle);
+    }
+
+    printf("%5d bps%s: %ld frames, %.1f us/frame, %.1fx realtime, checksum %08x\n",
+           kBitRates[mode], dtx ? " dtx" : "", frames,
+           frames ? elapsed * 1e-3 / frames : 0.0,
+           elapsed ? (double)frames * L_FRAME16k / 16000 / (elapsed * 1e-9) : 0.0,
+           checksum);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = 20;
+    int repeat = 1;
+    int dtx = 0;
+    int failures = 0;
+    unsigned char *pcm;
+    long size;
+    int mode;
+    int res;
+
+    while ((res = getopt(argc, argv, "n:r:d")) >= 0) {
+        switch (res) {
+            case 'n':
+                seconds = atoi(optarg);
+                break;
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            case 'd':
+                dtx = 1;
+                break;
+            default:
+                printf("usage: %s [-n seconds] [-r repeat] [-d] [file.pcm]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (seconds < 1 || repeat < 1) {
+        printf("seconds and repeat must be at least 1\n");
+        return 1;
+    }
+
+#ifdef AMRWBENC_SSE2
+    failures += checkConvolve(20000);
+    failures += checkDotProduct(20000);
+    failures += checkResidu(20000);
+    failures += checkScaleSig(20000);
+    failures += checkSynFilt(20000);
+    failures += checkSynFilt32(20000);
+    failures += checkDeemph32(20000);
+    failures += checkFilt6k7k(20000);
+    failures += checkPredLt4(20000);
+    failures += checkCorHVec(20000);
+    failures += checkNormCorr(20000);
+#else
+    printf("built without AMRWBENC_SSE2, no kernels to check\n");
+#endif
+
+    if (optind < argc) {
+        FILE *fp = fopen(argv[optind], "rb");
+        if (fp == NULL) {
+            printf("cannot open %s\n", argv[optind]);
+            return 1;
+        }
+        fseek(fp, 0, SEEK_END);
+        size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        pcm = (unsigned char *)malloc(size);
+        if (fread(pcm, 1, size, fp) != (size_t)size) {
+            printf("cannot read %s\n", argv[optind]);
+            fclose(fp);
+            free(pcm);
+            return 1;
+        }
+        fclose(fp);
+    } else {
+        pcm = makeSignal(seconds, &size);
+    }
+
+    for (mode = VOAMRWB_MD66; mode <= VOAMRWB_MD2385; mode++)
+        failures += encode(pcm, size, (VOAMRWBMODE)mode, dtx, repeat);
+    free(pcm);
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -230,6 +230,16 @@ typedef void (*FunctionType_Free)(void *userData, void *mem);
 */
 typedef void (*FunctionType_DebugLog)(uint32 *userData, AVCLogType type, char *string1, int val1, int val2);
 
+/** Runs job(arg, index) for every index from 0 to num_jobs - 1 and returns when all of them
+    are done. The jobs are independent of each other and may run concurrently on any threads.
+    Used by the encoder to encode the slices of a picture in parallel.
+\param "job" "Function to run, called once for each index."
+\param "arg" "Argument to be passed to the job."
+\param "num_jobs" "Number of jobs."
+\return "void"
+*/
+typedef void (*FunctionType_RunJobs)(void *userData, void (*job)(void *arg, int index), void *arg, int num_jobs);
+
 /**
 This structure has to be allocated and maintained by the user of the library.
 This structure is used as a handle to the library object.
@@ -258,6 +268,9 @@ typedef struct tagAVCHandle
 
     FunctionType_DebugLog CBAVC_DebugLog;
 
+    /** Optional, NULL to run all the jobs on the calling thread. */
+    FunctionType_RunJobs CBAVC_RunJobs;
+
     /** Flag to enable debugging */
     uint32  debugEnable;
 
@@ -504,6 +504,7 @@ typedef struct tagPictureData
     int     pitch; /* how many pixel between the line */
 
     uint    padded; /* flag for being padded */
+    uint    padded_chroma; /* flag for the chromas being padded all around */
 
 } AVCPictureData;
 
@@ -98,6 +98,7 @@ AVCStatus InitDPB(AVCHandle *avcHandle, AVCCommonObj *video, int FrameHeightInMb
         dpb->fs[num_fs]->frame.isReference = 0;
         video->RefPicList0[num_fs] = &(dpb->fs[num_fs]->frame);
         dpb->fs[num_fs]->frame.padded = 0;
+        dpb->fs[num_fs]->frame.padded_chroma = 0;
         dpb->used_size += (framesize + video->padded_size);
         num_fs++;
     }
@@ -290,6 +291,7 @@ OSCL_EXPORT_REF void DPBInitPic(AVCCommonObj *video, int CurrPicNum)
     video->currPic = &(video->currFS->frame);
 
     video->currPic->padded = 0; // reset this flag to not-padded
+    video->currPic->padded_chroma = 0;
 
     if (video->padded_size)
     {
@@ -11,10 +11,12 @@ LOCAL_SRC_FILES := \
     src/intra_est.cpp \
     src/motion_comp.cpp \
     src/motion_est.cpp \
+    src/multi_slice.cpp \
     src/rate_control.cpp \
     src/residual.cpp \
     src/sad.cpp \
     src/sad_halfpel.cpp \
+    src/sad_simd.cpp \
     src/slice.cpp \
     src/vlc_encode.cpp
 
@@ -30,6 +32,17 @@ LOCAL_C_INCLUDES := \
 LOCAL_CFLAGS := \
     -DOSCL_IMPORT_REF= -DOSCL_UNUSED_ARG= -DOSCL_EXPORT_REF=
 
+# The SAD kernels of the motion search are replaced by bit-exact SSE2 or
+# NEON versions in src/sad_simd.cpp.
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DAVCENC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DAVCENC_NEON
+endif
+
 include $(BUILD_STATIC_LIBRARY)
 
 ################################################################################
@@ -62,6 +75,7 @@ LOCAL_SHARED_LIBRARIES := \
         libstagefright_foundation \
         libstagefright_omx \
         libutils \
+        libcutils \
         liblog \
         libui
 
@@ -70,3 +84,38 @@ LOCAL_MODULE := libstagefright_soft_h264enc
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
+
+################################################################################
+# test utility: compares the SSE2/NEON SAD kernels with the C versions
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        test/sad_test.cpp
+
+LOCAL_C_INCLUDES := \
+        $(LOCAL_PATH)/src \
+        $(LOCAL_PATH)/../common/include
+
+LOCAL_CFLAGS := \
+    -DOSCL_IMPORT_REF= -DOSCL_UNUSED_ARG= -DOSCL_EXPORT_REF=
+
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DAVCENC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DAVCENC_NEON
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+        libstagefright_avcenc
+
+LOCAL_SHARED_LIBRARIES := \
+        libstagefright_avc_common
+
+LOCAL_MODULE := avcenc_sad_test
+LOCAL_MODULE_TAGS := debug
+
+include $(BUILD_EXECUTABLE)
@@ -24,13 +24,18 @@
 
 #include <HardwareAPI.h>
 #include <MetadataBufferType.h>
+#include <cutils/properties.h>
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/cpucount.h>
 #include <media/stagefright/MediaDefs.h>
 #include <media/stagefright/MediaErrors.h>
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/Utils.h>
 #include <ui/Rect.h>
 #include <ui/GraphicBufferMapper.h>
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+#include <utils/Thread.h>
 
 #include "SoftAVCEncoder.h"
 
@@ -167,6 +172,148 @@ static void UnbindFrameWrapper(void *userData, int32_t index) {
     return encoder->unbindOutputBuffer(index);
 }
 
+static void RunJobsWrapper(void *userData,
+        void (*job)(void *arg, int index), void *arg, int numJobs) {
+    SoftAVCEncoder *encoder = static_cast<SoftAVCEncoder *>(userData);
+    CHECK(encoder != NULL);
+    encoder->runJobs(job, arg, numJobs);
+}
+
+// Worker threads that run the slice jobs of the encoder together with the
+// component thread.
+struct SoftAVCEncoder::WorkerPool {
+    WorkerPool(size_t numWorkers);
+    ~WorkerPool();
+
+    size_t numWorkers() const { return mWorkers.size(); }
+
+    // Runs job(arg, 0) to job(arg, numJobs - 1) and returns once all of
+    // them are done.
+    void runJobs(void (*job)(void *arg, int index), void *arg, int numJobs);
+
+private:
+    struct Worker : public Thread {
+        Worker(WorkerPool *pool)
+            : Thread(false /* canCallJava */),
+              mPool(pool) {
+        }
+
+    private:
+        WorkerPool *mPool;
+
+        virtual bool threadLoop() {
+            return mPool->workerLoop();
+        }
+    };
+
+    Vector<sp<Worker> > mWorkers;
+
+    Mutex mLock;
+    Condition mWorkAvailable;
+    Condition mJobsDone;
+    bool mQuit;
+
+    void (*mJob)(void *arg, int index);
+    void *mJobArg;
+    int mNumJobs;
+    int mNextJob;
+    int mJobsPending;
+
+    bool workerLoop();
+
+    // Runs jobs until none are left to claim. Called with mLock held.
+    void runJobs_l();
+
+    WorkerPool(const WorkerPool &);
+    WorkerPool &operator=(const WorkerPool &);
+};
+
+SoftAVCEncoder::WorkerPool::WorkerPool(size_t numWorkers)
+    : mQuit(false),
+      mJob(NULL),
+      mJobArg(NULL),
+      mNumJobs(0),
+      mNextJob(0),
+      mJobsPending(0) {
+    for (size_t i = 0; i < numWorkers; ++i) {
+        sp<Worker> worker = new Worker(this);
+        if (worker->run("SoftAVCEncWorker", ANDROID_PRIORITY_FOREGROUND) != OK) {
+            ALOGW("Failed to start encoder worker.");
+            break;
+        }
+
+        mWorkers.push(worker);
+    }
+}
+
+SoftAVCEncoder::WorkerPool::~WorkerPool() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        mQuit = true;
+        mWorkAvailable.broadcast();
+    }
+
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        mWorkers.editItemAt(i)->requestExitAndWait();
+    }
+}
+
+void SoftAVCEncoder::WorkerPool::runJobs(
+        void (*job)(void *arg, int index), void *arg, int numJobs) {
+    Mutex::Autolock autoLock(mLock);
+
+    mJob = job;
+    mJobArg = arg;
+    mNumJobs = numJobs;
+    mNextJob = 0;
+    mJobsPending = numJobs;
+
+    mWorkAvailable.broadcast();
+
+    runJobs_l();
+
+    while (mJobsPending > 0) {
+        mJobsDone.wait(mLock);
+    }
+
+    mNumJobs = 0;
+    mNextJob = 0;
+    mJob = NULL;
+    mJobArg = NULL;
+}
+
+bool SoftAVCEncoder::WorkerPool::workerLoop() {
+    Mutex::Autolock autoLock(mLock);
+
+    while (!mQuit && mNextJob >= mNumJobs) {
+        mWorkAvailable.wait(mLock);
+    }
+
+    if (mQuit) {
+        return false;
+    }
+
+    runJobs_l();
+
+    return true;
+}
+
+void SoftAVCEncoder::WorkerPool::runJobs_l() {
+    while (mNextJob < mNumJobs) {
+        int index = mNextJob++;
+
+        mLock.unlock();
+        (*mJob)(mJobArg, index);
+        mLock.lock();
+
+        if (--mJobsPending == 0) {
+            mJobsDone.broadcast();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 SoftAVCEncoder::SoftAVCEncoder(
             const char *name,
             const OMX_CALLBACKTYPE *callbacks,
@@ -187,6 +334,8 @@ SoftAVCEncoder::SoftAVCEncoder(
       mStarted(false),
       mSawInputEOS(false),
       mSignalledError(false),
+      mNumSlices(1),
+      mWorkerPool(NULL),
       mHandle(new tagAVCHandle),
       mEncParams(new tagAVCEncParam),
       mInputFrameData(NULL),
@@ -253,6 +402,7 @@ OMX_ERRORTYPE SoftAVCEncoder::initEncParams() {
     mEncParams->bidir_pred = AVC_OFF;
 
     mEncParams->use_overrun_buffer = AVC_OFF;
+    mEncParams->num_slice = mNumSlices;
 
     if (mVideoColorFormat == OMX_COLOR_FormatYUV420SemiPlanar) {
         // Color conversion is needed.
@@ -308,6 +458,18 @@ OMX_ERRORTYPE SoftAVCEncoder::initEncParams() {
 OMX_ERRORTYPE SoftAVCEncoder::initEncoder() {
     CHECK(!mStarted);
 
+    // A slice is at least one macroblock row.
+    char value[PROPERTY_VALUE_MAX];
+    int32_t mbHeight = (mVideoHeight + 15) >> 4;
+    mNumSlices = 1;
+    if (property_get("media.stagefright.avcenc.slices", value, NULL)
+            && atoi(value) > 0) {
+        mNumSlices = atoi(value);
+    }
+    if (mNumSlices > mbHeight) {
+        mNumSlices = mbHeight;
+    }
+
     OMX_ERRORTYPE errType = OMX_ErrorNone;
     if (OMX_ErrorNone != (errType = initEncParams())) {
         ALOGE("Failed to initialized encoder params");
@@ -316,6 +478,32 @@ OMX_ERRORTYPE SoftAVCEncoder::initEncoder() {
         return errType;
     }
 
+    // One thread per core up to kMaxNumThreads, "1" encodes all slices
+    // on the component thread.
+    size_t numThreads = GetCPUCoreCount();
+    if (property_get("media.stagefright.avcenc.threads", value, NULL)
+            && atoi(value) > 0) {
+        numThreads = atoi(value);
+    }
+    if (numThreads > kMaxNumThreads) {
+        numThreads = kMaxNumThreads;
+    }
+    if (numThreads > (size_t)mNumSlices) {
+        numThreads = mNumSlices;
+    }
+
+    if (numThreads > 1) {
+        CHECK(mWorkerPool == NULL);
+        mWorkerPool = new WorkerPool(numThreads - 1);
+
+        if (mWorkerPool->numWorkers() > 0) {
+            mHandle->CBAVC_RunJobs = RunJobsWrapper;
+        } else {
+            delete mWorkerPool;
+            mWorkerPool = NULL;
+        }
+    }
+
     AVCEnc_Status err;
     err = PVAVCEncInitialize(mHandle, mEncParams, NULL, NULL);
     if (err != AVCENC_SUCCESS) {
@@ -342,6 +530,9 @@ OMX_ERRORTYPE SoftAVCEncoder::releaseEncoder() {
     PVAVCCleanUpEncoder(mHandle);
     releaseOutputBuffers();
 
+    delete mWorkerPool;
+    mWorkerPool = NULL;
+
     delete mInputFrameData;
     mInputFrameData = NULL;
 
@@ -871,7 +1062,23 @@ void SoftAVCEncoder::onQueueFilled(OMX_U32 portIndex) {
         CHECK(encoderStatus == AVCENC_SUCCESS || encoderStatus == AVCENC_NEW_IDR);
         dataLength = outHeader->nAllocLen;  // Reset the output buffer length
         if (inHeader->nFilledLen > 0) {
-            encoderStatus = PVAVCEncodeNAL(mHandle, outPtr, &dataLength, &type);
+            // All slices of the picture, each after a start code like the
+            // parameter sets, however many slices there are.
+            uint32_t filledLen = 0;
+            do {
+                if (outHeader->nAllocLen - filledLen <= 4) {
+                    encoderStatus = AVCENC_BITSTREAM_BUFFER_FULL;
+                    break;
+                }
+                uint8_t *nalPtr = outPtr + filledLen;
+                memcpy(nalPtr, "\x00\x00\x00\x01", 4);
+                filledLen += 4;
+                dataLength = outHeader->nAllocLen - filledLen;
+                encoderStatus = PVAVCEncodeNAL(mHandle, nalPtr + 4, &dataLength, &type);
+                filledLen += dataLength;
+            } while (encoderStatus == AVCENC_SUCCESS);
+            dataLength = filledLen;
+
             if (encoderStatus == AVCENC_SUCCESS) {
                 CHECK(NULL == PVAVCEncGetOverrunBuffer(mHandle));
             } else if (encoderStatus == AVCENC_PICTURE_READY) {
@@ -946,6 +1153,12 @@ int32_t SoftAVCEncoder::bindOutputBuffer(int32_t index, uint8_t **yuv) {
     return 1;
 }
 
+void SoftAVCEncoder::runJobs(
+        void (*job)(void *arg, int index), void *arg, int numJobs) {
+    CHECK(mWorkerPool != NULL);
+    mWorkerPool->runJobs(job, arg, numJobs);
+}
+
 void SoftAVCEncoder::signalBufferReturned(MediaBuffer *buffer) {
     ALOGV("signalBufferReturned: %p", buffer);
 }
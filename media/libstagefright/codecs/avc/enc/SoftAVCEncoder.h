@@ -58,6 +58,7 @@ struct SoftAVCEncoder : public MediaBufferObserver,
     int32_t allocOutputBuffers(unsigned int sizeInMbs, unsigned int numBuffers);
     void    unbindOutputBuffer(int32_t index);
     int32_t bindOutputBuffer(int32_t index, uint8_t **yuv);
+    void    runJobs(void (*job)(void *arg, int index), void *arg, int numJobs);
 
 protected:
     virtual ~SoftAVCEncoder();
@@ -65,12 +66,15 @@ protected:
 private:
     enum {
         kNumBuffers = 2,
+        kMaxNumThreads = 4,
     };
 
     enum {
         kStoreMetaDataExtensionIndex = OMX_IndexVendorStartUnused + 1
     };
 
+    struct WorkerPool;
+
     // OMX input buffer's timestamp and flags
     typedef struct {
         int64_t mTimeUs;
@@ -96,6 +100,15 @@ private:
     bool     mSignalledError;
     bool     mIsIDRFrame;
 
+    // Slices per picture, set by media.stagefright.avcenc.slices. The NALs
+    // of all slices of a picture go into one output buffer, each after a
+    // start code.
+    int32_t  mNumSlices;
+
+    // Encodes the slices of a picture in parallel, NULL when encoding
+    // single-threaded.
+    WorkerPool *mWorkerPool;
+
     tagAVCHandle          *mHandle;
     tagAVCEncParam        *mEncParams;
     uint8_t               *mInputFrameData;
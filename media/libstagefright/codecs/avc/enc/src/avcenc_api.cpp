@@ -81,6 +81,7 @@ OSCL_EXPORT_REF AVCEnc_Status PVAVCEncInitialize(AVCHandle *avcHandle, AVCEncPar
     encvid->enc_state = AVCEnc_Initializing;
 
     encvid->avcHandle = avcHandle;
+    encvid->slices = NULL;
 
     encvid->common = (AVCCommonObj*) avcHandle->CBAVC_Malloc(userData, sizeof(AVCCommonObj), DEFAULT_ATTR);
     if (encvid->common == NULL)
@@ -211,17 +212,19 @@ OSCL_EXPORT_REF AVCEnc_Status PVAVCEncInitialize(AVCHandle *avcHandle, AVCEncPar
         return AVCENC_MEMORY_FAIL;
     }
 
+    /* allocate the state of the slices of a picture */
+    if (AVCENC_SUCCESS != InitMultiSliceModule(avcHandle))
+    {
+        return AVCENC_MEMORY_FAIL;
+    }
+
     /* intialize function pointers */
     encvid->functionPointer = (AVCEncFuncPtr*) avcHandle->CBAVC_Malloc(userData, sizeof(AVCEncFuncPtr), DEFAULT_ATTR);
     if (encvid->functionPointer == NULL)
     {
         return AVCENC_MEMORY_FAIL;
     }
-    encvid->functionPointer->SAD_Macroblock = &AVCSAD_Macroblock_C;
-    encvid->functionPointer->SAD_MB_HalfPel[0] = NULL;
-    encvid->functionPointer->SAD_MB_HalfPel[1] = &AVCSAD_MB_HalfPel_Cxh;
-    encvid->functionPointer->SAD_MB_HalfPel[2] = &AVCSAD_MB_HalfPel_Cyh;
-    encvid->functionPointer->SAD_MB_HalfPel[3] = &AVCSAD_MB_HalfPel_Cxhyh;
+    AVCInitSADFunctions(encvid->functionPointer);
 
     /* initialize timing control */
     encvid->modTimeRef = 0;     /* ALWAYS ASSUME THAT TIMESTAMP START FROM 0 !!!*/
@@ -437,48 +440,88 @@ OSCL_EXPORT_REF AVCEnc_Status PVAVCEncodeNAL(AVCHandle *avcHandle, unsigned char
         case AVCEnc_Encoding_Frame:
             /* initialized the structure */
             BitstreamEncInit(bitstream, buffer, *buf_nal_size, encvid->overrunBuffer, encvid->oBSize);
-            BitstreamWriteBits(bitstream, 8, (video->nal_ref_idc << 5) | (video->nal_unit_type));
-
-            /* Re-order the reference list according to the ref_pic_list_reordering() */
-            /* We don't have to reorder the list for the encoder here. This can only be done
-            after we encode this slice. We can run thru a second-pass to see if new ordering
-            would save more bits. Too much delay !! */
-            /* status = ReOrderList(video);*/
-            status = InitSlice(encvid);
-            if (status != AVCENC_SUCCESS)
-            {
-                return status;
-            }
 
-            /* when we have everything, we encode the slice header */
-            status = EncodeSliceHeader(encvid, bitstream);
-            if (status != AVCENC_SUCCESS)
+            if (encvid->numSlices > 1)
             {
-                return status;
+                /* all the slices are encoded with the first call, the
+                   following calls return them one by one. */
+                if (encvid->currSlice == 0)
+                {
+                    status = AVCEncodeSlices(encvid);
+                    if (status != AVCENC_SUCCESS)
+                    {
+                        return status;
+                    }
+
+                    /* decide on skipping before any slice is returned */
+                    status = RCUpdateFrame(encvid);
+                    if (status == AVCENC_SKIPPED_PICTURE) /* skip current frame */
+                    {
+                        DPBReleaseCurrentFrame(avcHandle, video);
+                        encvid->enc_state = AVCEnc_Analyzing_Frame;
+
+                        return status;
+                    }
+                }
+
+                status = AVCGetSliceNAL(encvid, bitstream);
+                if (status != AVCENC_SUCCESS && status != AVCENC_PICTURE_READY)
+                {
+                    return status;
+                }
+
+                *buf_nal_size = bitstream->write_pos;
+
+                *nal_type = video->nal_unit_type;
             }
+            else
+            {
+                BitstreamWriteBits(bitstream, 8, (video->nal_ref_idc << 5) | (video->nal_unit_type));
+
+                /* Re-order the reference list according to the ref_pic_list_reordering() */
+                /* We don't have to reorder the list for the encoder here. This can only be done
+                after we encode this slice. We can run thru a second-pass to see if new ordering
+                would save more bits. Too much delay !! */
+                /* status = ReOrderList(video);*/
+                status = InitSlice(encvid);
+                if (status != AVCENC_SUCCESS)
+                {
+                    return status;
+                }
 
-            status = AVCEncodeSlice(encvid);
+                /* when we have everything, we encode the slice header */
+                status = EncodeSliceHeader(encvid, bitstream);
+                if (status != AVCENC_SUCCESS)
+                {
+                    return status;
+                }
 
-            video->slice_id++;
+                status = AVCEncodeSlice(encvid);
 
-            /* closing the NAL with trailing bits */
-            BitstreamTrailingBits(bitstream, buf_nal_size);
+                video->slice_id++;
+
+                /* closing the NAL with trailing bits */
+                BitstreamTrailingBits(bitstream, buf_nal_size);
 
-            *buf_nal_size = bitstream->write_pos;
+                *buf_nal_size = bitstream->write_pos;
 
-            encvid->rateCtrl->numFrameBits += ((*buf_nal_size) << 3);
+                encvid->rateCtrl->numFrameBits += ((*buf_nal_size) << 3);
 
-            *nal_type = video->nal_unit_type;
+                *nal_type = video->nal_unit_type;
+            }
 
             if (status == AVCENC_PICTURE_READY)
             {
-                status = RCUpdateFrame(encvid);
-                if (status == AVCENC_SKIPPED_PICTURE) /* skip current frame */
+                if (encvid->numSlices == 1) /* already done with the first slice otherwise */
                 {
-                    DPBReleaseCurrentFrame(avcHandle, video);
-                    encvid->enc_state = AVCEnc_Analyzing_Frame;
-
-                    return status;
+                    status = RCUpdateFrame(encvid);
+                    if (status == AVCENC_SKIPPED_PICTURE) /* skip current frame */
+                    {
+                        DPBReleaseCurrentFrame(avcHandle, video);
+                        encvid->enc_state = AVCEnc_Analyzing_Frame;
+
+                        return status;
+                    }
                 }
 
                 /* perform loop-filtering on the entire frame */
@@ -600,6 +643,8 @@ OSCL_EXPORT_REF void    PVAVCCleanUpEncoder(AVCHandle *avcHandle)
 
         CleanupRateControlModule(avcHandle);
 
+        CleanMultiSliceModule(avcHandle);
+
         if (encvid->functionPointer != NULL)
         {
             avcHandle->CBAVC_Free(userData, encvid->functionPointer);
@@ -124,6 +124,10 @@ typedef struct tagAVCEncParam
     /* fmo_type == 6 */
     uint *slice_group; /* array of size MBWidth*MBHeight */
 
+    int num_slice;  /* number of slices per picture, each one a run of whole MB rows. 0 or 1 for
+                    one slice per picture. Only with num_slice_group == 1. The slices are encoded
+                    in parallel when the CBAVC_RunJobs callback is set. */
+
     AVCFlag db_filter;  /* enable deblocking loop filter */
     int disable_db_idc;  /* 0: filter everywhere, 1: no filter, 2: no filter across slice boundary */
     int alpha_offset;   /* alpha offset range -6,...,6 */
@@ -234,7 +238,8 @@ extern "C"
     fixed number of macroblocks, as specified in the encoder parameters set, or the
     maximum number of macroblocks fitted into the given input argument "buffer". The
     input frame is taken from the oldest unencoded input frame retrieved by users by
-    PVAVCEncGetInput API.
+    PVAVCEncGetInput API. With more than one slice per picture (num_slice), the first call
+    encodes all the slices of the picture and every call returns one of them, in order.
     \param "avcHandle"  "Handle to the AVC encoder library object."
     \param "buffer"     "Pointer to the output AVC bitstream buffer, the format will be EBSP,
                          not RBSP."
@@ -386,6 +386,13 @@ typedef struct tagEncObject
 
     int                 currSliceGroup; /* currently encoded slice group id */
 
+    /* more than one slice per picture, see multi_slice.cpp */
+    int                 numSlices;  /* number of slices per picture */
+    int                 currSlice;  /* next slice to be returned by PVAVCEncodeNAL */
+    struct tagEncSlice  *slices;    /* state of each slice, NULL for one slice per picture */
+    int                 mbRowStart; /* MB rows of the slice being processed, */
+    int                 mbRowEnd;   /* the whole picture for one slice */
+
     int     level[24][16], run[24][16]; /* scratch memory */
     int     leveldc[16], rundc[16]; /* for DC component */
     int     levelcdc[16], runcdc[16]; /* for chroma DC component */
@@ -466,6 +473,35 @@ typedef struct tagEncObject
 
 } AVCEncObject;
 
+/**
+This structure holds one slice of a picture encoded with more than one slice.
+The slices are searched and encoded concurrently, each on its own copy of the
+encoder objects. The macroblock arrays and the pictures stay shared, a slice
+only writes to the macroblocks of its own rows.
+@publishedAll
+*/
+typedef struct tagEncSlice
+{
+    AVCEncObject    encvid;     /* copies of the main objects, see AVCPrepareSlices() */
+    AVCCommonObj    video;
+    AVCSliceHeader  sliceHdr;
+    AVCRateControl  rateCtrl;
+    AVCEncBitstream bitstream;
+
+    int     mbRowStart;         /* MB rows of the slice, mbRowEnd is excluded */
+    int     mbRowEnd;
+
+    uint8   *buffer;            /* the slice NAL, grown by AVCBitstreamUseOverrunBuffer() */
+    int     bufSize;
+    int     nalSize;            /* size of the encoded slice NAL */
+    AVCEnc_Status status;       /* status of encoding the slice */
+
+    /* motion estimation of the slice */
+    int     numIntraSearch;
+    int     totalSAD;
+
+} AVCEncSlice;
+
 
 #endif /*AVCENC_INT_H_INCLUDED*/
 
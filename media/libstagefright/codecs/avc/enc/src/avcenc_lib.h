@@ -452,6 +452,12 @@ extern "C"
                            uint8 *out, int outpitch,
                            int blkwidth, int blkheight);
 
+    /**
+    Pads the chroma reference around the block at x_pos, y_pos in 1/8 pel resolution,
+    as needed by eChromaMotionComp().
+    */
+    void ePadChroma(uint8 *ref, int picwidth, int picheight, int picpitch, int x_pos, int y_pos);
+
     void eChromaMotionComp(uint8 *ref, int picwidth, int picheight,
                            int x_pos, int y_pos, uint8 *pred, int pred_pitch,
                            int blkwidth, int blkheight);
@@ -494,6 +500,13 @@ extern "C"
     */
     void CleanMotionSearchModule(AVCHandle *avcHandle);
 
+    /**
+    Set the half-pel and quarter-pel candidate pointers to the sub-pel prediction
+    memory of the given object.
+    \param "encvid" "Pointer to AVCEncObject."
+    \return "void."
+    */
+    void AVCInitSubPelPointers(AVCEncObject *encvid);
 
     /**
     This function performs motion estimation of all macroblocks in a frame during the InitFrame.
@@ -504,6 +517,20 @@ extern "C"
     */
     void AVCMotionEstimation(AVCEncObject *encvid);
 
+    /**
+    This function performs one pass of the motion estimation over a range of macroblock rows.
+    \param "encvid" "Pointer to AVCEncObject."
+    \param "first_row, end_row" "Range of macroblock rows, end_row is excluded."
+    \param "start_i" "First macroblock of the pass, 0 or 1."
+    \param "incr_i" "1 to search every macroblock, 2 to search every other one."
+    \param "type_pred" "Type of the candidate selection."
+    \param "NumIntraSearch" "Incremented for every macroblock to be intra searched."
+    \param "totalSAD" "Incremented by the SAD of every macroblock."
+    \return "void"
+    */
+    void AVCMotionSearchRows(AVCEncObject *encvid, int first_row, int end_row, int start_i,
+                             int incr_i, int type_pred, int *NumIntraSearch, int *totalSAD);
+
     /**
     This function performs repetitive edge padding to the reference picture by adding 16 pixels
     around the luma and 8 pixels around the chromas.
@@ -512,6 +539,15 @@ extern "C"
     */
     void  AVCPaddingEdge(AVCPictureData *refPic);
 
+    /**
+    This function pads the chromas of the reference picture by 8 pixels all around at once,
+    eChromaMotionComp() then doesn't have to pad around each block. It's used when the
+    slices of a picture are encoded at the same time.
+    \param "refPic" "Pointer to the reference picture."
+    \return "void"
+    */
+    void  AVCPaddingEdgeChroma(AVCPictureData *refPic);
+
     /**
     This function keeps track of intra refresh macroblock locations.
     \param "encvid" "Pointer to the global array structure AVCEncObject."
@@ -650,12 +686,61 @@ extern "C"
 
     /**
     This function calculates the SATD of a subpel candidate.
+    \param "encvid" "Pointer to AVCEncObject."
     \param "cand"   "Pointer to a candidate."
     \param "cur"    "Pointer to the current block."
     \param "dmin"   "Min-so-far SATD."
     \return "Sum of Absolute Transformed Difference."
     */
-    int SATD_MB(uint8 *cand, uint8 *cur, int dmin);
+    int SATD_MB(AVCEncObject *encvid, uint8 *cand, uint8 *cur, int dmin);
+
+    /*------------- multi_slice.c -------------------*/
+
+    /**
+    Allocate the per-slice state for encoding pictures with more than one slice.
+    \param "avcHandle" "Pointer to AVCHandle."
+    \return "AVCENC_SUCCESS or AVCENC_MEMORY_FAIL."
+    */
+    AVCEnc_Status InitMultiSliceModule(AVCHandle *avcHandle);
+
+    /**
+    Clean up memory allocated in InitMultiSliceModule.
+    \param "avcHandle" "Pointer to AVCHandle."
+    \return "void."
+    */
+    void CleanMultiSliceModule(AVCHandle *avcHandle);
+
+    /**
+    Copy the current state of the encoder to the objects of every slice.
+    \param "encvid" "Pointer to AVCEncObject."
+    \return "void."
+    */
+    void AVCPrepareSlices(AVCEncObject *encvid);
+
+    /**
+    Run job once for every slice, through the CBAVC_RunJobs callback if it is set.
+    \param "encvid" "Pointer to AVCEncObject."
+    \param "job" "Function to run with arg and the slice index."
+    \param "arg" "Argument to the job."
+    \return "void."
+    */
+    void AVCRunSliceJobs(AVCEncObject *encvid, void (*job)(void *arg, int index), void *arg);
+
+    /**
+    Encode all the slices of the current picture into their NAL buffers.
+    \param "encvid" "Pointer to AVCEncObject."
+    \return "AVCENC_SUCCESS or the failure of the first slice that failed."
+    */
+    AVCEnc_Status AVCEncodeSlices(AVCEncObject *encvid);
+
+    /**
+    Return the NAL of the next slice of the current picture.
+    \param "encvid" "Pointer to AVCEncObject."
+    \param "stream" "Bitstream structure set up with the output buffer."
+    \return "AVCENC_SUCCESS for a slice, AVCENC_PICTURE_READY for the last slice of the picture,
+             AVCENC_BITSTREAM_BUFFER_FULL if the NAL doesn't fit."
+    */
+    AVCEnc_Status AVCGetSliceNAL(AVCEncObject *encvid, AVCEncBitstream *stream);
 
     /*------------- rate_control.c -------------------*/
 
@@ -805,6 +890,28 @@ extern "C"
     int AVCSAD_MB_HalfPel_Cxh(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
     int AVCSAD_Macroblock_C(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
 
+    /*------------- sad_simd.c ----------------------*/
+
+    /**
+    This function sets the SAD function pointers to the SSE2 or NEON versions
+    of the C functions above when the encoder is built with them.
+    \param "functionPointer" "Pointer to AVCEncFuncPtr."
+    \return "void"
+    */
+    void AVCInitSADFunctions(AVCEncFuncPtr *functionPointer);
+
+#if defined(AVCENC_SSE2)
+    int AVCSAD_MB_HalfPel_SSE2xhyh(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+    int AVCSAD_MB_HalfPel_SSE2yh(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+    int AVCSAD_MB_HalfPel_SSE2xh(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+    int AVCSAD_Macroblock_SSE2(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+#elif defined(AVCENC_NEON)
+    int AVCSAD_MB_HalfPel_NEONxhyh(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+    int AVCSAD_MB_HalfPel_NEONyh(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+    int AVCSAD_MB_HalfPel_NEONxh(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+    int AVCSAD_Macroblock_NEON(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+#endif
+
 #ifdef HTFM /*  3/2/1, Hypothesis Testing Fast Matching */
     int AVCSAD_MB_HP_HTFM_Collectxhyh(uint8 *ref, uint8 *blk, int dmin_x, void *extra_info);
     int AVCSAD_MB_HP_HTFM_Collectyh(uint8 *ref, uint8 *blk, int dmin_x, void *extra_info);
@@ -499,6 +499,17 @@ AVCEnc_Status  SetEncodeParam(AVCHandle* avcHandle, AVCEncParams* encParam,
 
     /* the rest will be set in InitSlice() */
 
+    /* slices per picture, each one a run of whole MB rows */
+    encvid->numSlices = (encParam->num_slice > 1) ? encParam->num_slice : 1;
+    if (encvid->numSlices > 1 && picParam->num_slice_groups_minus1 > 0)
+    {
+        return AVCENC_TOOLS_NOT_SUPPORTED; /* not with FMO */
+    }
+    if (encvid->numSlices > (int)video->PicHeightInMbs)
+    {
+        encvid->numSlices = video->PicHeightInMbs;
+    }
+
     /* now the rate control and performance related parameters */
     rateCtrl->scdEnable = (encParam->auto_scd == AVC_ON) ? TRUE : FALSE;
     rateCtrl->idrPeriod = encParam->idr_period + 1;
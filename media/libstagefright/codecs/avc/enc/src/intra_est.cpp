@@ -43,8 +43,10 @@ bool IntraDecisionABE(AVCEncObject *encvid, int min_cost, uint8 *curL, int picPi
     OsclFloat ABE;
     bool intra = true;
 
+    /* the left neighbor is read down to the first row of the MB below, at
+       the bottom of a slice that row belongs to another slice. */
     if (((x_pos >> 4) != (int)video->PicWidthInMbs - 1) &&
-            ((y_pos >> 4) != (int)video->PicHeightInMbs - 1) &&
+            ((y_pos >> 4) != encvid->mbRowEnd - 1) &&
             video->intraAvailA &&
             video->intraAvailB)
     {
@@ -100,6 +100,13 @@ void AVCMBMotionComp(AVCEncObject *encvid, AVCCommonObj *video)
                             /*comp_Sl + offset + offset_x,*/
                             predBlock + offsetP, picPitch, MbWidth, MbHeight);
 
+            /* the chromas are padded around the block unless done for the whole picture */
+            if (!video->RefPicList0[ref_idx]->padded_chroma)
+            {
+                ePadChroma(ref_Cb, picWidth >> 1, picHeight >> 1, picPitch >> 1, x_pos, y_pos);
+                ePadChroma(ref_Cr, picWidth >> 1, picHeight >> 1, picPitch >> 1, x_pos, y_pos);
+            }
+
             offsetP = (block_y * picWidth) + (block_x << 1);
             eChromaMotionComp(ref_Cb, picWidth >> 1, picHeight >> 1, x_pos, y_pos,
                               /*comp_Scb +  offsetC,*/
@@ -1811,7 +1818,8 @@ void eChromaMotionComp(uint8 *ref, int picwidth, int picheight,
     int offset_dx, offset_dy;
     int index;
 
-    ePadChroma(ref, picwidth, picheight, picpitch, x_pos, y_pos);
+    (void)(picwidth);
+    (void)(picheight);
 
     dx = x_pos & 7;
     dy = y_pos & 7;
@@ -75,8 +75,6 @@ AVCEnc_Status InitMotionSearchModule(AVCHandle *avcHandle)
     int temp_bits = 0;
     uint8 *mvbits;
     int bits, imax, imin, i;
-    uint8* subpel_pred = (uint8*) encvid->subpel_pred; // all 16 sub-pel positions
-
 
     while (number_of_subpel_positions > 0)
     {
@@ -106,6 +104,17 @@ AVCEnc_Status InitMotionSearchModule(AVCHandle *avcHandle)
         for (i = imin; i < imax; i++)   mvbits[-i] = mvbits[i] = bits;
     }
 
+    AVCInitSubPelPointers(encvid);
+
+    return AVCENC_SUCCESS;
+}
+
+/* Point hpel_cand and bilin_base into subpel_pred of encvid. Called again for
+   copies of the object, see AVCPrepareSlices(). */
+void AVCInitSubPelPointers(AVCEncObject *encvid)
+{
+    uint8* subpel_pred = (uint8*) encvid->subpel_pred; // all 16 sub-pel positions
+
     /* initialize half-pel search */
     encvid->hpel_cand[0] = subpel_pred + REF_CENTER;
     encvid->hpel_cand[1] = subpel_pred + V2Q_H0Q * SUBPEL_PRED_BLK_SIZE + 1 ;
@@ -165,8 +174,7 @@ AVCEnc_Status InitMotionSearchModule(AVCHandle *avcHandle)
     encvid->bilin_base[8][2] = subpel_pred + V2Q_H0Q * SUBPEL_PRED_BLK_SIZE;
     encvid->bilin_base[8][3] = subpel_pred + V2Q_H2Q * SUBPEL_PRED_BLK_SIZE;
 
-
-    return AVCENC_SUCCESS;
+    return ;
 }
 
 /* Clean-up memory */
@@ -232,45 +240,54 @@ bool IntraDecisionABE(int *min_cost, uint8 *cur, int pitch, bool ave)
     return intra;
 }
 
+typedef struct tagMotionSearchJob
+{
+    AVCEncObject *encvid;
+    int start_i;
+    int incr_i;
+    int type_pred;
+} AVCMotionSearchJob;
+
+/* motion search of the rows of one slice, see AVCRunSliceJobs() */
+static void AVCMotionSearchSlice(void *arg, int index)
+{
+    AVCMotionSearchJob *job = (AVCMotionSearchJob*) arg;
+    AVCEncSlice *slice = &(job->encvid->slices[index]);
+
+    slice->numIntraSearch = 0;
+    slice->totalSAD = 0;
+
+    AVCMotionSearchRows(&(slice->encvid), slice->mbRowStart, slice->mbRowEnd,
+                        job->start_i, job->incr_i, job->type_pred,
+                        &(slice->numIntraSearch), &(slice->totalSAD));
+}
+
 /******* main function for macroblock prediction for the entire frame ***/
 /* if turns out to be IDR frame, set video->nal_unit_type to AVC_NALTYPE_IDR */
 void AVCMotionEstimation(AVCEncObject *encvid)
 {
     AVCCommonObj *video = encvid->common;
     int slice_type = video->slice_type;
-    AVCFrameIO *currInput = encvid->currInput;
     AVCPictureData *refPic = video->RefPicList0[0];
-    int i, j, k;
-    int mbwidth = video->PicWidthInMbs;
+    int i;
     int mbheight = video->PicHeightInMbs;
     int totalMB = video->PicSizeInMbs;
-    int pitch = currInput->pitch;
-    AVCMacroblock *currMB, *mblock = video->mblock;
-    AVCMV *mot_mb_16x16, *mot16x16 = encvid->mot16x16;
-    // AVCMV *mot_mb_16x8, *mot_mb_8x16, *mot_mb_8x8, etc;
+    AVCMacroblock *mblock = video->mblock;
     AVCRateControl *rateCtrl = encvid->rateCtrl;
     uint8 *intraSearch = encvid->intraSearch;
-    uint FS_en = encvid->fullsearch_enable;
+    AVCMotionSearchJob job;
 
     int NumIntraSearch, start_i, numLoop, incr_i;
-    int mbnum, offset;
-    uint8 *cur, *best_cand[5];
     int totalSAD = 0;   /* average SAD for rate control */
     int type_pred;
-    int abe_cost;
 
 #ifdef HTFM
     /***** HYPOTHESIS TESTING ********/  /* 2/28/01 */
     int collect = 0;
-    HTFM_Stat htfm_stat;
     double newvar[16];
     double exp_lamda[15];
     /*********************************/
 #endif
-    int hp_guess = 0;
-    uint32 mv_uint32;
-
-    offset = 0;
 
     if (slice_type == AVC_I_SLICE)
     {
@@ -309,7 +326,7 @@ void AVCMotionEstimation(AVCEncObject *encvid)
     encvid->sad_extra_info = NULL;
 #ifdef HTFM
     /***** HYPOTHESIS TESTING ********/
-    InitHTFM(video, &htfm_stat, newvar, &collect);
+    InitHTFM(video, &(encvid->htfm_stat), newvar, &collect);
     /*********************************/
 #endif
 
@@ -330,100 +347,39 @@ void AVCMotionEstimation(AVCEncObject *encvid)
         type_pred = 2;
     }
 
+    if (encvid->numSlices > 1)
+    {
+        /* each slice searches its own rows on its own copy of the encoder object */
+        AVCPrepareSlices(encvid);
+        job.encvid = encvid;
+    }
+
     /* First pass, loop thru half the macroblock */
     /* determine scene change */
     /* Second pass, for the rest of macroblocks */
     NumIntraSearch = 0; // to be intra searched in the encoding loop.
     while (numLoop--)
     {
-        for (j = 0; j < mbheight; j++)
+        if (encvid->numSlices > 1)
         {
-            if (incr_i > 1)
-                start_i = (start_i == 0 ? 1 : 0) ; /* toggle 0 and 1 */
+            job.start_i = start_i;
+            job.incr_i = incr_i;
+            job.type_pred = type_pred;
 
-            offset = pitch * (j << 4) + (start_i << 4);
+            AVCRunSliceJobs(encvid, &AVCMotionSearchSlice, &job);
 
-            mbnum = j * mbwidth + start_i;
-
-            for (i = start_i; i < mbwidth; i += incr_i)
+            /* add up in slice order, the result doesn't depend on the threads */
+            for (i = 0; i < encvid->numSlices; i++)
             {
-                video->mbNum = mbnum;
-                video->currMB = currMB = mblock + mbnum;
-                mot_mb_16x16 = mot16x16 + mbnum;
-
-                cur = currInput->YCbCr[0] + offset;
-
-                if (currMB->mb_intra == 0) /* for INTER mode */
-                {
-#if defined(HTFM)
-                    HTFMPrepareCurMB_AVC(encvid, &htfm_stat, cur, pitch);
-#else
-                    AVCPrepareCurMB(encvid, cur, pitch);
-#endif
-                    /************************************************************/
-                    /******** full-pel 1MV search **********************/
-
-                    AVCMBMotionSearch(encvid, cur, best_cand, i << 4, j << 4, type_pred,
-                                      FS_en, &hp_guess);
-
-                    abe_cost = encvid->min_cost[mbnum] = mot_mb_16x16->sad;
-
-                    /* set mbMode and MVs */
-                    currMB->mbMode = AVC_P16;
-                    currMB->MBPartPredMode[0][0] = AVC_Pred_L0;
-                    mv_uint32 = ((mot_mb_16x16->y) << 16) | ((mot_mb_16x16->x) & 0xffff);
-                    for (k = 0; k < 32; k += 2)
-                    {
-                        currMB->mvL0[k>>1] = mv_uint32;
-                    }
-
-                    /* make a decision whether it should be tested for intra or not */
-                    if (i != mbwidth - 1 && j != mbheight - 1 && i != 0 && j != 0)
-                    {
-                        if (false == IntraDecisionABE(&abe_cost, cur, pitch, true))
-                        {
-                            intraSearch[mbnum] = 0;
-                        }
-                        else
-                        {
-                            NumIntraSearch++;
-                            rateCtrl->MADofMB[mbnum] = abe_cost;
-                        }
-                    }
-                    else // boundary MBs, always do intra search
-                    {
-                        NumIntraSearch++;
-                    }
-
-                    totalSAD += (int) rateCtrl->MADofMB[mbnum];//mot_mb_16x16->sad;
-                }
-                else    /* INTRA update, use for prediction */
-                {
-                    mot_mb_16x16[0].x = mot_mb_16x16[0].y = 0;
-
-                    /* reset all other MVs to zero */
-                    /* mot_mb_16x8, mot_mb_8x16, mot_mb_8x8, etc. */
-                    abe_cost = encvid->min_cost[mbnum] = 0x7FFFFFFF;  /* max value for int */
-
-                    if (i != mbwidth - 1 && j != mbheight - 1 && i != 0 && j != 0)
-                    {
-                        IntraDecisionABE(&abe_cost, cur, pitch, false);
-
-                        rateCtrl->MADofMB[mbnum] = abe_cost;
-                        totalSAD += abe_cost;
-                    }
-
-                    NumIntraSearch++ ;
-                    /* cannot do I16 prediction here because it needs full decoding. */
-                    // intraSearch[mbnum] = 1;
-
-                }
-
-                mbnum += incr_i;
-                offset += (incr_i << 4);
-
-            } /* for i */
-        } /* for j */
+                NumIntraSearch += encvid->slices[i].numIntraSearch;
+                totalSAD += encvid->slices[i].totalSAD;
+            }
+        }
+        else
+        {
+            AVCMotionSearchRows(encvid, 0, mbheight, start_i, incr_i, type_pred,
+                                &NumIntraSearch, &totalSAD);
+        }
 
         /* since we cannot do intra/inter decision here, the SCD has to be
         based on other criteria such as motion vectors coherency or the SAD */
@@ -464,7 +420,7 @@ void AVCMotionEstimation(AVCEncObject *encvid)
     if (collect)
     {
         collect = 0;
-        UpdateHTFM(encvid, newvar, exp_lamda, &htfm_stat);
+        UpdateHTFM(encvid, newvar, exp_lamda, &(encvid->htfm_stat));
     }
     /*********************************/
 #endif
@@ -472,6 +428,124 @@ void AVCMotionEstimation(AVCEncObject *encvid)
     return ;
 }
 
+/* One pass of the motion search over MB rows [first_row, end_row). With the scene
+   change detection on, the passes search alternate MBs in a checkerboard pattern,
+   start_i is 1 for the first pass and 0 for the second one. */
+void AVCMotionSearchRows(AVCEncObject *encvid, int first_row, int end_row, int start_i,
+                         int incr_i, int type_pred, int *NumIntraSearch, int *totalSAD)
+{
+    AVCCommonObj *video = encvid->common;
+    AVCFrameIO *currInput = encvid->currInput;
+    int i, j, k;
+    int mbwidth = video->PicWidthInMbs;
+    int mbheight = video->PicHeightInMbs;
+    int pitch = currInput->pitch;
+    AVCMacroblock *currMB, *mblock = video->mblock;
+    AVCMV *mot_mb_16x16, *mot16x16 = encvid->mot16x16;
+    // AVCMV *mot_mb_16x8, *mot_mb_8x16, *mot_mb_8x8, etc;
+    AVCRateControl *rateCtrl = encvid->rateCtrl;
+    uint8 *intraSearch = encvid->intraSearch;
+    uint FS_en = encvid->fullsearch_enable;
+
+    int mbnum, offset, row_start_i;
+    uint8 *cur, *best_cand[5];
+    int abe_cost;
+    int hp_guess = 0;
+    uint32 mv_uint32;
+
+    for (j = first_row; j < end_row; j++)
+    {
+        row_start_i = start_i;
+        if (incr_i > 1)
+            row_start_i = (start_i + j + 1) & 1; /* toggle 0 and 1 */
+
+        offset = pitch * (j << 4) + (row_start_i << 4);
+
+        mbnum = j * mbwidth + row_start_i;
+
+        for (i = row_start_i; i < mbwidth; i += incr_i)
+        {
+            video->mbNum = mbnum;
+            video->currMB = currMB = mblock + mbnum;
+            mot_mb_16x16 = mot16x16 + mbnum;
+
+            cur = currInput->YCbCr[0] + offset;
+
+            if (currMB->mb_intra == 0) /* for INTER mode */
+            {
+#if defined(HTFM)
+                HTFMPrepareCurMB_AVC(encvid, &(encvid->htfm_stat), cur, pitch);
+#else
+                AVCPrepareCurMB(encvid, cur, pitch);
+#endif
+                /************************************************************/
+                /******** full-pel 1MV search **********************/
+
+                AVCMBMotionSearch(encvid, cur, best_cand, i << 4, j << 4, type_pred,
+                                  FS_en, &hp_guess);
+
+                abe_cost = encvid->min_cost[mbnum] = mot_mb_16x16->sad;
+
+                /* set mbMode and MVs */
+                currMB->mbMode = AVC_P16;
+                currMB->MBPartPredMode[0][0] = AVC_Pred_L0;
+                mv_uint32 = ((mot_mb_16x16->y) << 16) | ((mot_mb_16x16->x) & 0xffff);
+                for (k = 0; k < 32; k += 2)
+                {
+                    currMB->mvL0[k>>1] = mv_uint32;
+                }
+
+                /* make a decision whether it should be tested for intra or not */
+                if (i != mbwidth - 1 && j != mbheight - 1 && i != 0 && j != 0)
+                {
+                    if (false == IntraDecisionABE(&abe_cost, cur, pitch, true))
+                    {
+                        intraSearch[mbnum] = 0;
+                    }
+                    else
+                    {
+                        (*NumIntraSearch)++;
+                        rateCtrl->MADofMB[mbnum] = abe_cost;
+                    }
+                }
+                else // boundary MBs, always do intra search
+                {
+                    (*NumIntraSearch)++;
+                }
+
+                *totalSAD += (int) rateCtrl->MADofMB[mbnum];//mot_mb_16x16->sad;
+            }
+            else    /* INTRA update, use for prediction */
+            {
+                mot_mb_16x16[0].x = mot_mb_16x16[0].y = 0;
+
+                /* reset all other MVs to zero */
+                /* mot_mb_16x8, mot_mb_8x16, mot_mb_8x8, etc. */
+                abe_cost = encvid->min_cost[mbnum] = 0x7FFFFFFF;  /* max value for int */
+
+                if (i != mbwidth - 1 && j != mbheight - 1 && i != 0 && j != 0)
+                {
+                    IntraDecisionABE(&abe_cost, cur, pitch, false);
+
+                    rateCtrl->MADofMB[mbnum] = abe_cost;
+                    *totalSAD += abe_cost;
+                }
+
+                (*NumIntraSearch)++ ;
+                /* cannot do I16 prediction here because it needs full decoding. */
+                // intraSearch[mbnum] = 1;
+
+            }
+
+            mbnum += incr_i;
+            offset += (incr_i << 4);
+
+        } /* for i */
+    } /* for j */
+
+    return ;
+}
+
 /*=====================================================================
     Function:   PaddingEdge
     Date:       09/16/2000
@@ -562,6 +636,46 @@ void  AVCPaddingEdge(AVCPictureData *refPic)
     return ;
 }
 
+/* pad 8 pixels around one chroma plane, the corners are the corner pixels */
+static void AVCPaddingEdgeChromaPlane(uint8 *src, int width, int height, int pitch)
+{
+    uint8 *dst;
+    int i;
+
+    /* pad sides */
+    dst = src;
+    i = height;
+    while (i--)
+    {
+        memset(dst - 8, dst[0], 8);
+        memset(dst + width, dst[width-1], 8);
+        dst += pitch;
+    }
+
+    /* pad top and bottom */
+    src -= 8;
+    dst = src + (height - 1) * pitch;
+    for (i = 1; i <= 8; i++)
+    {
+        memcpy(src - i * pitch, src, width + 16);
+        memcpy(dst + i * pitch, dst, width + 16);
+    }
+
+    return ;
+}
+
+void  AVCPaddingEdgeChroma(AVCPictureData *refPic)
+{
+    int width = refPic->width >> 1;
+    int height = refPic->height >> 1;
+    int pitch = refPic->pitch >> 1;
+
+    AVCPaddingEdgeChromaPlane(refPic->Scb, width, height, pitch);
+    AVCPaddingEdgeChromaPlane(refPic->Scr, width, height, pitch);
+
+    return ;
+}
+
 /*===========================================================================
     Function:   AVCRasterIntraUpdate
     Date:       2/26/01
@@ -1068,7 +1182,8 @@ void AVCMBMotionSearch(AVCEncObject *encvid, uint8 *cur, uint8 *best_cand[],
     else
     {   /*       fullsearch the top row to only upto (0,3) MB */
         /*       upto 30% complexity saving with the same complexity */
-        if (video->PrevRefFrameNum == 0 && j0 == 0 && i0 <= 64 && type_pred != 1)
+        /*       the top row of each slice, it has no candidates above */
+        if (video->PrevRefFrameNum == 0 && (j0 >> 4) == encvid->mbRowStart && i0 <= 64 && type_pred != 1)
         {
             *hp_guess = 0; /* no guess for fast half-pel */
             dmin =  AVCFullSearch(encvid, ref, cur, &imin, &jmin, ilow, ihigh, jlow, jhigh, cmvx, cmvy);
@@ -1362,6 +1477,8 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
     int mbnum = video->mbNum;
     int mbwidth = video->PicWidthInMbs;
     int mbheight = video->PicHeightInMbs;
+    int mbtop = encvid->mbRowStart; /* candidates only come from the rows of the slice */
+    int mbbottom = encvid->mbRowEnd - 1;
     int i, j, same, num1;
 
     /* this part is for predicted MV */
@@ -1391,26 +1508,26 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
 
-            if (jmb < mbheight - 1)  /*bottom neighbor previous frame */
+            if (jmb < mbbottom)  /*bottom neighbor previous frame */
             {
                 pmot = &mot16x16[mbnum+mbwidth];
                 mvx[(*num_can)] = (pmot->x) >> 2;
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
-            else if (jmb > 0)   /*upper neighbor previous frame */
+            else if (jmb > mbtop)   /*upper neighbor previous frame */
             {
                 pmot = &mot16x16[mbnum-mbwidth];
                 mvx[(*num_can)] = (pmot->x) >> 2;
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
 
-            if (imb > 0 && jmb > 0)  /* upper-left neighbor current frame*/
+            if (imb > 0 && jmb > mbtop)  /* upper-left neighbor current frame*/
             {
                 pmot = &mot16x16[mbnum-mbwidth-1];
                 mvx[(*num_can)] = (pmot->x) >> 2;
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
-            if (jmb > 0 && imb < mbheight - 1)  /* upper right neighbor current frame*/
+            if (jmb > mbtop && imb < mbheight - 1)  /* upper right neighbor current frame*/
             {
                 pmot = &mot16x16[mbnum-mbwidth+1];
                 mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1430,7 +1547,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                 mvx[(*num_can)] = (pmot->x) >> 2;
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
-            if (jmb > 0)  /*upper neighbor current frame */
+            if (jmb > mbtop)  /*upper neighbor current frame */
             {
                 pmot = &mot16x16[mbnum-mbwidth];
                 mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1442,7 +1559,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                 mvx[(*num_can)] = (pmot->x) >> 2;
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
-            if (jmb < mbheight - 1)  /*bottom neighbor previous frame */
+            if (jmb < mbbottom)  /*bottom neighbor previous frame */
             {
                 pmot = &mot16x16[mbnum+mbwidth];
                 mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1459,7 +1576,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
             pmvA_y = pmot->y;
         }
 
-        if (jmb > 0) /* get MV from top (B) neighbor either on current or previous frame */
+        if (jmb > mbtop) /* get MV from top (B) neighbor either on current or previous frame */
         {
             availB = 1;
             pmot = &mot16x16[mbnum-mbwidth];
@@ -1491,13 +1608,13 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                 mvx[(*num_can)] = (pmot->x) >> 2;
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
-            if (imb > 0 && jmb > 0)  /* upper-left neighbor */
+            if (imb > 0 && jmb > mbtop)  /* upper-left neighbor */
             {
                 pmot = &mot16x16[mbnum-mbwidth-1];
                 mvx[(*num_can)] = (pmot->x) >> 2;
                 mvy[(*num_can)++] = (pmot->y) >> 2;
             }
-            if (jmb > 0 && imb < mbheight - 1)  /* upper right neighbor */
+            if (jmb > mbtop && imb < mbheight - 1)  /* upper right neighbor */
             {
                 pmot = &mot16x16[mbnum-mbwidth+1];
                 mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1513,7 +1630,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                 pmvA_y = pmot->y;
             }
 
-            if (jmb > 0 && imb > 0) /* get MV from top-left (B) neighbor of current frame */
+            if (jmb > mbtop && imb > 0) /* get MV from top-left (B) neighbor of current frame */
             {
                 availB = 1;
                 pmot = &mot16x16[mbnum-mbwidth-1];
@@ -1521,7 +1638,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                 pmvB_y = pmot->y;
             }
 
-            if (jmb > 0 && imb < mbwidth - 1)
+            if (jmb > mbtop && imb < mbwidth - 1)
             {
                 availC = 1;
                 pmot = &mot16x16[mbnum-mbwidth+1];
@@ -1541,7 +1658,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                     mvx[(*num_can)] = (pmot->x) >> 2;
                     mvy[(*num_can)++] = (pmot->y) >> 2;
                 }
-                if (jmb > 0)  /*upper neighbor current frame */
+                if (jmb > mbtop)  /*upper neighbor current frame */
                 {
                     pmot = &mot16x16[mbnum-mbwidth];
                     mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1553,7 +1670,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                     mvx[(*num_can)] = (pmot->x) >> 2;
                     mvy[(*num_can)++] = (pmot->y) >> 2;
                 }
-                if (jmb < mbheight - 1)  /*bottom neighbor current frame */
+                if (jmb < mbbottom)  /*bottom neighbor current frame */
                 {
                     pmot = &mot16x16[mbnum+mbwidth];
                     mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1569,7 +1686,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                     mvx[(*num_can)] = (pmot->x) >> 2;
                     mvy[(*num_can)++] = (pmot->y) >> 2;
 
-                    if (jmb > 0)  /*upper-left neighbor current frame */
+                    if (jmb > mbtop)  /*upper-left neighbor current frame */
                     {
                         pmot = &mot16x16[mbnum-mbwidth-1];
                         mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1577,7 +1694,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                     }
 
                 }
-                if (jmb > 0)  /*upper neighbor current frame */
+                if (jmb > mbtop)  /*upper neighbor current frame */
                 {
                     pmot = &mot16x16[mbnum-mbwidth];
                     mvx[(*num_can)] = (pmot->x) >> 2;
@@ -1601,7 +1718,7 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
                 pmvA_y = pmot->y;
             }
 
-            if (jmb > 0) /* get MV from top (B) neighbor either on current or previous frame */
+            if (jmb > mbtop) /* get MV from top (B) neighbor either on current or previous frame */
             {
                 availB = 1;
                 pmot = &mot16x16[mbnum-mbwidth];
@@ -1625,6 +1742,12 @@ void AVCCandidateSelection(int *mvx, int *mvy, int *num_can, int imb, int jmb,
 //#endif
     }
 
+    if (*num_can == 0) /* no neighbor, e.g. at the top-left of a slice */
+    {
+        mvx[0] = mvy[0] = 0;
+        *num_can = 1;
+    }
+
     /*  3/23/01, remove redundant candidate (possible k-mean) */
     num1 = *num_can;
     *num_can = 1;
@@ -0,0 +1,326 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+#include "avcenc_lib.h"
+
+/* consist of
+AVCEnc_Status InitMultiSliceModule(AVCHandle *avcHandle)
+void CleanMultiSliceModule(AVCHandle *avcHandle)
+void AVCPrepareSlices(AVCEncObject *encvid)
+void AVCRunSliceJobs(AVCEncObject *encvid, void (*job)(void *arg, int index), void *arg)
+AVCEnc_Status AVCEncodeSlices(AVCEncObject *encvid)
+AVCEnc_Status AVCGetSliceNAL(AVCEncObject *encvid, AVCEncBitstream *stream)
+
+A picture with more than one slice is split into runs of whole MB rows. The
+motion estimation of the slices runs in parallel (AVCMotionEstimation), and so
+does the encoding of the slices into NALs once the picture QP is known. The rate
+control stays at the picture level, it sees the sums of the slices.
+
+Each slice works on its own copy of the encoder objects and only writes to the
+macroblocks, motion vectors and pixels of its own rows. Neighbors in other
+slices are never used: the slice ids make them unavailable to the encoding, and
+the motion search takes no candidates from other rows than its own. The
+bitstream is the same whether the slices run on one thread or on many.
+*/
+
+/* the NAL of a slice starts at the raw size of its MBs and grows if needed */
+#define SLICE_BUFFER_SIZE_PER_MB    384
+#define SLICE_BUFFER_EXTRA_SIZE     1024
+
+AVCEnc_Status InitMultiSliceModule(AVCHandle *avcHandle)
+{
+    AVCEncObject *encvid = (AVCEncObject*) avcHandle->AVCObject;
+    AVCCommonObj *video = encvid->common;
+    AVCEncSlice *slice;
+    int numSlices = encvid->numSlices;
+    int mbheight = video->PicHeightInMbs;
+    int i;
+
+    encvid->currSlice = 0;
+    encvid->slices = NULL;
+    encvid->mbRowStart = 0;
+    encvid->mbRowEnd = mbheight;
+
+    if (numSlices <= 1)
+    {
+        return AVCENC_SUCCESS;
+    }
+
+    encvid->slices = (AVCEncSlice*) avcHandle->CBAVC_Malloc(avcHandle->userData,
+                     sizeof(AVCEncSlice) * numSlices, DEFAULT_ATTR);
+    if (encvid->slices == NULL)
+    {
+        return AVCENC_MEMORY_FAIL;
+    }
+    memset(encvid->slices, 0, sizeof(AVCEncSlice) * numSlices);
+
+    for (i = 0; i < numSlices; i++)
+    {
+        slice = &(encvid->slices[i]);
+
+        /* rows as evenly as possible */
+        slice->mbRowStart = (i * mbheight) / numSlices;
+        slice->mbRowEnd = ((i + 1) * mbheight) / numSlices;
+
+        slice->bufSize = (slice->mbRowEnd - slice->mbRowStart) * video->PicWidthInMbs
+                         * SLICE_BUFFER_SIZE_PER_MB + SLICE_BUFFER_EXTRA_SIZE;
+        slice->buffer = (uint8*) avcHandle->CBAVC_Malloc(avcHandle->userData,
+                        slice->bufSize, DEFAULT_ATTR);
+        if (slice->buffer == NULL)
+        {
+            return AVCENC_MEMORY_FAIL;
+        }
+    }
+
+    return AVCENC_SUCCESS;
+}
+
+void CleanMultiSliceModule(AVCHandle *avcHandle)
+{
+    AVCEncObject *encvid = (AVCEncObject*) avcHandle->AVCObject;
+    int i;
+
+    if (encvid->slices)
+    {
+        for (i = 0; i < encvid->numSlices; i++)
+        {
+            if (encvid->slices[i].buffer)
+            {
+                avcHandle->CBAVC_Free(avcHandle->userData, encvid->slices[i].buffer);
+            }
+        }
+
+        avcHandle->CBAVC_Free(avcHandle->userData, encvid->slices);
+        encvid->slices = NULL;
+    }
+
+    return ;
+}
+
+void AVCPrepareSlices(AVCEncObject *encvid)
+{
+    AVCCommonObj *video = encvid->common;
+    AVCEncSlice *slice;
+    int i;
+
+    for (i = 0; i < encvid->numSlices; i++)
+    {
+        slice = &(encvid->slices[i]);
+
+        memcpy(&(slice->encvid), encvid, sizeof(AVCEncObject));
+        memcpy(&(slice->video), video, sizeof(AVCCommonObj));
+        memcpy(&(slice->sliceHdr), video->sliceHdr, sizeof(AVCSliceHeader));
+        memcpy(&(slice->rateCtrl), encvid->rateCtrl, sizeof(AVCRateControl));
+
+        slice->encvid.common = &(slice->video);
+        slice->encvid.rateCtrl = &(slice->rateCtrl);
+        slice->encvid.bitstream = &(slice->bitstream);
+        slice->video.sliceHdr = &(slice->sliceHdr);
+        slice->bitstream.encvid = &(slice->encvid);
+
+        /* the pointers into the scratch memory of the object */
+        AVCInitSubPelPointers(&(slice->encvid));
+
+        /* the slice buffer is also the overrun buffer of the copy, it's
+           reallocated through the copy when the slice doesn't fit. */
+        slice->encvid.overrunBuffer = slice->buffer;
+        slice->encvid.oBSize = slice->bufSize;
+
+        slice->encvid.mbRowStart = slice->mbRowStart;
+        slice->encvid.mbRowEnd = slice->mbRowEnd;
+        slice->video.mbNum = slice->mbRowStart * video->PicWidthInMbs;
+        slice->video.slice_id = video->slice_id + i;
+    }
+
+    return ;
+}
+
+void AVCRunSliceJobs(AVCEncObject *encvid, void (*job)(void *arg, int index), void *arg)
+{
+    AVCHandle *avcHandle = encvid->avcHandle;
+    int i;
+
+    if (avcHandle->CBAVC_RunJobs)
+    {
+        avcHandle->CBAVC_RunJobs(avcHandle->userData, job, arg, encvid->numSlices);
+    }
+    else
+    {
+        for (i = 0; i < encvid->numSlices; i++)
+        {
+            (*job)(arg, i);
+        }
+    }
+
+    return ;
+}
+
+/* encode one slice into its buffer, see AVCRunSliceJobs() */
+static void AVCEncodeSliceJob(void *arg, int index)
+{
+    AVCEncObject *encvid = (AVCEncObject*) arg;
+    AVCEncSlice *slice = &(encvid->slices[index]);
+    AVCEncObject *sliceEnc = &(slice->encvid);
+    AVCCommonObj *video = sliceEnc->common;
+    AVCEncBitstream *stream = sliceEnc->bitstream;
+    AVCEnc_Status status;
+
+    BitstreamEncInit(stream, sliceEnc->overrunBuffer, sliceEnc->oBSize,
+                     sliceEnc->overrunBuffer, sliceEnc->oBSize);
+    BitstreamWriteBits(stream, 8, (video->nal_ref_idc << 5) | (video->nal_unit_type));
+
+    status = InitSlice(sliceEnc);
+
+    if (status == AVCENC_SUCCESS)
+    {
+        status = EncodeSliceHeader(sliceEnc, stream);
+    }
+
+    if (status == AVCENC_SUCCESS)
+    {
+        status = AVCEncodeSlice(sliceEnc);
+        if (status == AVCENC_PICTURE_READY) /* the last slice */
+        {
+            status = AVCENC_SUCCESS;
+        }
+    }
+
+    if (status == AVCENC_SUCCESS)
+    {
+        status = BitstreamTrailingBits(stream, NULL);
+    }
+
+    /* the buffer may have been reallocated */
+    slice->buffer = sliceEnc->overrunBuffer;
+    slice->bufSize = sliceEnc->oBSize;
+
+    slice->nalSize = stream->write_pos;
+    slice->status = status;
+
+    return ;
+}
+
+AVCEnc_Status AVCEncodeSlices(AVCEncObject *encvid)
+{
+    AVCCommonObj *video = encvid->common;
+    AVCRateControl *rateCtrl = encvid->rateCtrl;
+    AVCMacroblock *mblock = video->mblock;
+    AVCPictureData *refPic;
+    AVCEncSlice *slice;
+    AVCEnc_Status status;
+    int i, mbnum, end;
+
+    /* the slice header of the first slice, the end of the picture
+       uses some of its values, e.g. for the deblocking. */
+    video->mbNum = 0;
+    status = InitSlice(encvid);
+    if (status != AVCENC_SUCCESS)
+    {
+        return status;
+    }
+
+    /* the availability of the neighbors depends on the slice ids, they
+       are set before any slice starts. */
+    for (i = 0; i < encvid->numSlices; i++)
+    {
+        slice = &(encvid->slices[i]);
+        end = slice->mbRowEnd * video->PicWidthInMbs;
+
+        for (mbnum = slice->mbRowStart * video->PicWidthInMbs; mbnum < end; mbnum++)
+        {
+            mblock[mbnum].slice_id = video->slice_id + i;
+        }
+    }
+
+    /* the motion compensation pads the chromas of the references around
+       each block, the slices would do that at the same time. */
+    if (video->slice_type != AVC_I_SLICE)
+    {
+        for (i = 0; i < video->refList0Size; i++)
+        {
+            refPic = video->RefPicList0[i];
+            if (refPic->padded_chroma == 0)
+            {
+                AVCPaddingEdgeChroma(refPic);
+                refPic->padded_chroma = 1;
+            }
+        }
+    }
+
+    AVCPrepareSlices(encvid);
+
+    for (i = 0; i < encvid->numSlices; i++)
+    {
+        slice = &(encvid->slices[i]);
+        slice->rateCtrl.NumberofHeaderBits = 0;
+        slice->rateCtrl.NumberofTextureBits = 0;
+        slice->encvid.numIntraMB = 0;
+    }
+
+    AVCRunSliceJobs(encvid, &AVCEncodeSliceJob, encvid);
+
+    /* add up the statistics of the slices for the rate control */
+    for (i = 0; i < encvid->numSlices; i++)
+    {
+        slice = &(encvid->slices[i]);
+
+        if (slice->status != AVCENC_SUCCESS)
+        {
+            return slice->status;
+        }
+
+        rateCtrl->NumberofHeaderBits += slice->rateCtrl.NumberofHeaderBits;
+        rateCtrl->NumberofTextureBits += slice->rateCtrl.NumberofTextureBits;
+        rateCtrl->numFrameBits += (slice->nalSize << 3);
+        encvid->numIntraMB += slice->encvid.numIntraMB;
+    }
+
+    /* set by the dec_ref_pic_marking() of the slice headers */
+    video->MaxLongTermFrameIdx = encvid->slices[0].video.MaxLongTermFrameIdx;
+    video->LongTermFrameIdx = encvid->slices[0].video.LongTermFrameIdx;
+
+    video->slice_id += encvid->numSlices;
+    encvid->currSlice = 0;
+
+    return AVCENC_SUCCESS;
+}
+
+AVCEnc_Status AVCGetSliceNAL(AVCEncObject *encvid, AVCEncBitstream *stream)
+{
+    AVCEncSlice *slice = &(encvid->slices[encvid->currSlice]);
+
+    if (slice->nalSize > stream->buf_size)
+    {
+        if (AVCBitstreamUseOverrunBuffer(stream, slice->nalSize) != AVCENC_SUCCESS)
+        {
+            return AVCENC_BITSTREAM_BUFFER_FULL;
+        }
+    }
+
+    memcpy(stream->bitstreamBuffer, slice->buffer, slice->nalSize);
+    stream->write_pos = slice->nalSize;
+
+    encvid->currSlice++;
+    if (encvid->currSlice == encvid->numSlices)
+    {
+        encvid->currSlice = 0;
+
+        return AVCENC_PICTURE_READY;
+    }
+
+    return AVCENC_SUCCESS;
+}
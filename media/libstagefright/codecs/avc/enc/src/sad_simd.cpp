@@ -0,0 +1,325 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+#include "avcenc_lib.h"
+
+#if defined(AVCENC_SSE2)
+#include <emmintrin.h>
+#elif defined(AVCENC_NEON)
+#include <arm_neon.h>
+#endif
+
+/* consist of
+void AVCInitSADFunctions(AVCEncFuncPtr *functionPointer)
+int AVCSAD_Macroblock_SSE2(uint8 *ref,uint8 *blk,int dmin_lx,void *extra_info)
+int AVCSAD_MB_HalfPel_SSE2xh(uint8 *ref,uint8 *blk,int dmin_rx,void *extra_info)
+int AVCSAD_MB_HalfPel_SSE2yh(uint8 *ref,uint8 *blk,int dmin_rx,void *extra_info)
+int AVCSAD_MB_HalfPel_SSE2xhyh(uint8 *ref,uint8 *blk,int dmin_rx,void *extra_info)
+and the NEON versions of the same.
+
+The vector versions return exactly what the C versions in sad.cpp and
+sad_halfpel.cpp return. That includes the early termination: the partial
+SAD is compared with dmin after every row and returned as soon as it is
+larger, since the motion search uses that value when it is not the best.
+ref may have any alignment, blk is the 16x16 current MB with a pitch of 16.
+*/
+
+#if defined(AVCENC_SSE2)
+
+static inline int sad_row_sse2(__m128i a, const uint8 *blk)
+{
+    __m128i sad = _mm_sad_epu8(a, _mm_loadu_si128((const __m128i*)blk));
+
+    return _mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4);
+}
+
+int AVCSAD_Macroblock_SSE2(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_lx >> 16;
+    int lx = dmin_lx & 0xFFFF;
+
+    for (i = 0; i < 16; i++)
+    {
+        sad += sad_row_sse2(_mm_loadu_si128((const __m128i*)ref), blk);
+
+        if (sad > dmin)
+            return sad;
+
+        ref += lx;
+        blk += 16;
+    }
+    return sad;
+}
+
+int AVCSAD_MB_HalfPel_SSE2xhyh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_rx >> 16;
+    int rx = dmin_rx & 0xFFFF;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    __m128i a, b, lo, hi, sum_lo, sum_hi;
+
+    /* the horizontal sums of the row above are reused for the next row */
+    a = _mm_loadu_si128((const __m128i*)ref);
+    b = _mm_loadu_si128((const __m128i*)(ref + 1));
+    lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+    hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+    for (i = 0; i < 16; i++)
+    {
+        ref += rx;
+
+        a = _mm_loadu_si128((const __m128i*)ref);
+        b = _mm_loadu_si128((const __m128i*)(ref + 1));
+        sum_lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        sum_hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+        a = _mm_packus_epi16(
+                _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, sum_lo), two), 2),
+                _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, sum_hi), two), 2));
+
+        sad += sad_row_sse2(a, blk);
+
+        if (sad > dmin)
+            return sad;
+
+        lo = sum_lo;
+        hi = sum_hi;
+        blk += 16;
+    }
+    return sad;
+}
+
+int AVCSAD_MB_HalfPel_SSE2yh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_rx >> 16;
+    int rx = dmin_rx & 0xFFFF;
+    __m128i p1, p2;
+
+    p1 = _mm_loadu_si128((const __m128i*)ref);
+
+    for (i = 0; i < 16; i++)
+    {
+        ref += rx;
+        p2 = _mm_loadu_si128((const __m128i*)ref);
+
+        /* pavgb is (p1 + p2 + 1) >> 1 */
+        sad += sad_row_sse2(_mm_avg_epu8(p1, p2), blk);
+
+        if (sad > dmin)
+            return sad;
+
+        p1 = p2;
+        blk += 16;
+    }
+    return sad;
+}
+
+int AVCSAD_MB_HalfPel_SSE2xh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_rx >> 16;
+    int rx = dmin_rx & 0xFFFF;
+    __m128i p1, p2;
+
+    for (i = 0; i < 16; i++)
+    {
+        p1 = _mm_loadu_si128((const __m128i*)ref);
+        p2 = _mm_loadu_si128((const __m128i*)(ref + 1));
+
+        sad += sad_row_sse2(_mm_avg_epu8(p1, p2), blk);
+
+        if (sad > dmin)
+            return sad;
+
+        ref += rx;
+        blk += 16;
+    }
+    return sad;
+}
+
+#elif defined(AVCENC_NEON)
+
+static inline int sad_row_neon(uint8x16_t a, const uint8 *blk)
+{
+    uint8x16_t b = vld1q_u8(blk);
+    uint16x8_t diff;
+    uint32x4_t sum32;
+    uint64x2_t sum64;
+
+    diff = vabdl_u8(vget_low_u8(a), vget_low_u8(b));
+    diff = vabal_u8(diff, vget_high_u8(a), vget_high_u8(b));
+    sum32 = vpaddlq_u16(diff);
+    sum64 = vpaddlq_u32(sum32);
+
+    return (int)(vgetq_lane_u64(sum64, 0) + vgetq_lane_u64(sum64, 1));
+}
+
+int AVCSAD_Macroblock_NEON(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_lx >> 16;
+    int lx = dmin_lx & 0xFFFF;
+
+    for (i = 0; i < 16; i++)
+    {
+        sad += sad_row_neon(vld1q_u8(ref), blk);
+
+        if (sad > dmin)
+            return sad;
+
+        ref += lx;
+        blk += 16;
+    }
+    return sad;
+}
+
+int AVCSAD_MB_HalfPel_NEONxhyh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_rx >> 16;
+    int rx = dmin_rx & 0xFFFF;
+    uint8x16_t a, b;
+    uint16x8_t lo, hi, sum_lo, sum_hi;
+
+    /* the horizontal sums of the row above are reused for the next row */
+    a = vld1q_u8(ref);
+    b = vld1q_u8(ref + 1);
+    lo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+    hi = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+
+    for (i = 0; i < 16; i++)
+    {
+        ref += rx;
+
+        a = vld1q_u8(ref);
+        b = vld1q_u8(ref + 1);
+        sum_lo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+        sum_hi = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+
+        /* vrshrn is (x + 2) >> 2 */
+        a = vcombine_u8(vrshrn_n_u16(vaddq_u16(lo, sum_lo), 2),
+                        vrshrn_n_u16(vaddq_u16(hi, sum_hi), 2));
+
+        sad += sad_row_neon(a, blk);
+
+        if (sad > dmin)
+            return sad;
+
+        lo = sum_lo;
+        hi = sum_hi;
+        blk += 16;
+    }
+    return sad;
+}
+
+int AVCSAD_MB_HalfPel_NEONyh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_rx >> 16;
+    int rx = dmin_rx & 0xFFFF;
+    uint8x16_t p1, p2;
+
+    p1 = vld1q_u8(ref);
+
+    for (i = 0; i < 16; i++)
+    {
+        ref += rx;
+        p2 = vld1q_u8(ref);
+
+        /* vrhadd is (p1 + p2 + 1) >> 1 */
+        sad += sad_row_neon(vrhaddq_u8(p1, p2), blk);
+
+        if (sad > dmin)
+            return sad;
+
+        p1 = p2;
+        blk += 16;
+    }
+    return sad;
+}
+
+int AVCSAD_MB_HalfPel_NEONxh(uint8 *ref, uint8 *blk, int dmin_rx, void *extra_info)
+{
+    (void)(extra_info);
+
+    int i;
+    int sad = 0;
+    int dmin = (uint32)dmin_rx >> 16;
+    int rx = dmin_rx & 0xFFFF;
+
+    for (i = 0; i < 16; i++)
+    {
+        sad += sad_row_neon(vrhaddq_u8(vld1q_u8(ref), vld1q_u8(ref + 1)), blk);
+
+        if (sad > dmin)
+            return sad;
+
+        ref += rx;
+        blk += 16;
+    }
+    return sad;
+}
+
+#endif
+
+void AVCInitSADFunctions(AVCEncFuncPtr *functionPointer)
+{
+#if defined(AVCENC_SSE2)
+    functionPointer->SAD_Macroblock = &AVCSAD_Macroblock_SSE2;
+    functionPointer->SAD_MB_HalfPel[0] = NULL;
+    functionPointer->SAD_MB_HalfPel[1] = &AVCSAD_MB_HalfPel_SSE2xh;
+    functionPointer->SAD_MB_HalfPel[2] = &AVCSAD_MB_HalfPel_SSE2yh;
+    functionPointer->SAD_MB_HalfPel[3] = &AVCSAD_MB_HalfPel_SSE2xhyh;
+#elif defined(AVCENC_NEON)
+    functionPointer->SAD_Macroblock = &AVCSAD_Macroblock_NEON;
+    functionPointer->SAD_MB_HalfPel[0] = NULL;
+    functionPointer->SAD_MB_HalfPel[1] = &AVCSAD_MB_HalfPel_NEONxh;
+    functionPointer->SAD_MB_HalfPel[2] = &AVCSAD_MB_HalfPel_NEONyh;
+    functionPointer->SAD_MB_HalfPel[3] = &AVCSAD_MB_HalfPel_NEONxhyh;
+#else
+    functionPointer->SAD_Macroblock = &AVCSAD_Macroblock_C;
+    functionPointer->SAD_MB_HalfPel[0] = NULL;
+    functionPointer->SAD_MB_HalfPel[1] = &AVCSAD_MB_HalfPel_Cxh;
+    functionPointer->SAD_MB_HalfPel[2] = &AVCSAD_MB_HalfPel_Cyh;
+    functionPointer->SAD_MB_HalfPel[3] = &AVCSAD_MB_HalfPel_Cxhyh;
+#endif
+}
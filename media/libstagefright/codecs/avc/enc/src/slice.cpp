@@ -42,7 +42,10 @@ AVCEnc_Status AVCEncodeSlice(AVCEncObject *encvid)
     {
         video->mbNum = CurrMbAddr;
         currMB = video->currMB = &(video->mblock[CurrMbAddr]);
-        currMB->slice_id = video->slice_id;  // for deblocking
+        if (encvid->numSlices == 1) /* otherwise set up front by AVCEncodeSlices() */
+        {
+            currMB->slice_id = video->slice_id;  // for deblocking
+        }
 
         video->mb_x = CurrMbAddr % video->PicWidthInMbs;
         video->mb_y = CurrMbAddr / video->PicWidthInMbs;
@@ -101,6 +104,14 @@ AVCEnc_Status AVCEncodeSlice(AVCEncObject *encvid)
             CurrMbAddr++;
         }
 
+        if (CurrMbAddr >= encvid->mbRowEnd * (int)video->PicWidthInMbs &&
+                (uint)CurrMbAddr < video->PicSizeInMbs)
+        {
+            /* end of a slice of a picture with more than one slice, see AVCEncodeSlices() */
+            video->mbNum = CurrMbAddr;
+            break;
+        }
+
         if ((uint)CurrMbAddr >= video->PicSizeInMbs)
         {
             /* end of slice, return, but before that check to see if there are other slices
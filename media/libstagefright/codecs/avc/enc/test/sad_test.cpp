@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that the SAD functions selected by AVCInitSADFunctions() return
+// exactly what the C versions return, including the partial sums returned
+// on early termination, for all alignments of the reference, for the
+// pitches the encoder uses and for random, flat and extreme content.
+//
+// Usage: avcenc_sad_test [iterations] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "avcenc_lib.h"
+
+typedef int (*SADFunc)(uint8 *ref, uint8 *blk, int dmin_lx, void *extra_info);
+
+enum {
+    kMaxPitch = 1952,
+    kRefSize = kMaxPitch * 18 + 64,
+};
+
+static const int kPitches[] = { 16, 24, 48, 176, 352, 1952 };
+
+static uint8 gRef[kRefSize];
+static uint8 gBlk[256 + 16];
+
+static void fillBuffer(uint8 *data, size_t size, int pattern) {
+    for (size_t i = 0; i < size; ++i) {
+        switch (pattern) {
+            case 0:
+                data[i] = rand() & 0xff;
+                break;
+            case 1:
+                // Small differences, the common case in a motion search.
+                data[i] = 128 + (rand() % 9) - 4;
+                break;
+            case 2:
+                data[i] = (rand() & 1) ? 0xff : 0x00;
+                break;
+            default:
+                data[i] = 0;
+                break;
+        }
+    }
+}
+
+static int checkFunction(
+        const char *name, SADFunc ref, SADFunc test,
+        uint8 *refPtr, uint8 *blkPtr, int dmin, int lx) {
+    int dmin_lx = (dmin << 16) | lx;
+    int expected = ref(refPtr, blkPtr, dmin_lx, NULL);
+    int actual = test(refPtr, blkPtr, dmin_lx, NULL);
+
+    if (expected != actual) {
+        fprintf(stderr, "%s mismatch: dmin %d lx %d offset %d: %d vs. %d\n",
+                name, dmin, lx, (int)((intptr_t)refPtr & 15),
+                expected, actual);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+    unsigned seed = (argc > 2) ? atoi(argv[2]) : (unsigned)time(NULL);
+
+    srand(seed);
+
+    AVCEncFuncPtr simd;
+    AVCInitSADFunctions(&simd);
+
+    if (simd.SAD_Macroblock == &AVCSAD_Macroblock_C) {
+        printf("No SIMD SAD functions in this build, checking the C ones.\n");
+    }
+
+    static const struct {
+        const char *name;
+        SADFunc ref;
+        int index;
+    } kFunctions[] = {
+        { "SAD_Macroblock", &AVCSAD_Macroblock_C, -1 },
+        { "SAD_MB_HalfPel xh", &AVCSAD_MB_HalfPel_Cxh, 1 },
+        { "SAD_MB_HalfPel yh", &AVCSAD_MB_HalfPel_Cyh, 2 },
+        { "SAD_MB_HalfPel xhyh", &AVCSAD_MB_HalfPel_Cxhyh, 3 },
+    };
+
+    int failures = 0;
+    int checks = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        int pattern = i % 4;
+        fillBuffer(gRef, sizeof(gRef), pattern);
+        fillBuffer(gBlk, sizeof(gBlk), pattern);
+
+        if (pattern == 3) {
+            // All 0xff against all 0x00: the largest possible SAD.
+            memset(gBlk, (i & 8) ? 0x00 : 0xff, sizeof(gBlk));
+            memset(gRef, (i & 8) ? 0xff : 0x00, sizeof(gRef));
+        }
+
+        int lx = kPitches[i % (sizeof(kPitches) / sizeof(kPitches[0]))];
+        int refOffset = rand() % 16;
+        int blkOffset = (i & 1) ? 0 : rand() % 16;
+
+        // Full range, no early termination, and a few thresholds that stop
+        // the sum at different rows.
+        int dmins[] = { 65535, 0, rand() % 256, rand() % 4096, rand() % 65536 };
+
+        for (size_t f = 0; f < sizeof(kFunctions) / sizeof(kFunctions[0]); ++f) {
+            SADFunc test = (kFunctions[f].index < 0)
+                    ? simd.SAD_Macroblock
+                    : simd.SAD_MB_HalfPel[kFunctions[f].index];
+
+            for (size_t d = 0; d < sizeof(dmins) / sizeof(dmins[0]); ++d) {
+                failures += checkFunction(
+                        kFunctions[f].name, kFunctions[f].ref, test,
+                        gRef + refOffset, gBlk + blkOffset, dmins[d], lx);
+                ++checks;
+            }
+        }
+    }
+
+    printf("%d of %d checks failed (seed %u)\n", failures, checks, seed);
+
+    return failures > 0 ? 1 : 0;
+}
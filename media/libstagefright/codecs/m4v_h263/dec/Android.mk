@@ -17,8 +17,10 @@ LOCAL_SRC_FILES := \
  	src/deringing_luma.cpp \
  	src/find_min_max.cpp \
  	src/get_pred_adv_b_add.cpp \
+ 	src/get_pred_adv_b_simd.cpp \
  	src/get_pred_outside.cpp \
  	src/idct.cpp \
+ 	src/idct_simd.cpp \
  	src/idct_vca.cpp \
  	src/mb_motion_comp.cpp \
  	src/mb_utils.cpp \
@@ -46,6 +48,17 @@ LOCAL_C_INCLUDES := \
 
 LOCAL_CFLAGS := -DOSCL_EXPORT_REF= -DOSCL_IMPORT_REF=
 
+# The full 8x8 IDCT and the half-pel prediction are replaced by bit-exact
+# SSE2 or NEON versions in src/idct_simd.cpp and src/get_pred_adv_b_simd.cpp.
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DM4VH263DEC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DM4VH263DEC_NEON
+endif
+
 include $(BUILD_STATIC_LIBRARY)
 
 ################################################################################
@@ -73,3 +86,35 @@ LOCAL_MODULE := libstagefright_soft_mpeg4dec
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
+
+################################################################################
+# test utility: checks the IDCT against IEEE 1180 and the SSE2/NEON kernels
+# against the C versions
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        test/idct_test.cpp
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/src \
+	$(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := -DOSCL_EXPORT_REF= -DOSCL_IMPORT_REF=
+
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DM4VH263DEC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DM4VH263DEC_NEON
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+        libstagefright_m4vh263dec
+
+LOCAL_MODULE := m4vh263dec_idct_test
+LOCAL_MODULE_TAGS := debug
+
+include $(BUILD_EXECUTABLE)
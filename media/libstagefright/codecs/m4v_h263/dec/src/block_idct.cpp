@@ -277,6 +277,12 @@ void BlockIDCT_intra(
     }
     else
     {
+#if defined(M4VH263DEC_SSE2)
+        /* same output as the column and row functions below */
+        idct8x8_intra_SSE2(coeff_in, c_comp, width);
+#elif defined(M4VH263DEC_NEON)
+        idct8x8_intra_NEON(coeff_in, c_comp, width);
+#else
         i = 8;
         while (i--)
         {
@@ -302,6 +308,7 @@ void BlockIDCT_intra(
         {
             idctrow_intra(coeff_in, c_comp, width);
         }
+#endif
     }
 #else
     void idct_intra(int *block, uint8 *comp, int width);
@@ -374,6 +381,12 @@ void BlockIDCT(
     }
     else
     {
+#if defined(M4VH263DEC_SSE2)
+        /* same output as the column and row functions below */
+        idct8x8_SSE2(coeff_in, pred, dst, width);
+#elif defined(M4VH263DEC_NEON)
+        idct8x8_NEON(coeff_in, pred, dst, width);
+#else
         i = 8;
 
         while (i--)
@@ -399,6 +412,7 @@ void BlockIDCT(
         {
             idctrow(coeff_in, pred, dst, width);
         }
+#endif
         return ;
     }
 #else // FAST_IDCT
@@ -0,0 +1,209 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+#include "mp4dec_lib.h"
+
+#if defined(M4VH263DEC_SSE2)
+#include <emmintrin.h>
+#elif defined(M4VH263DEC_NEON)
+#include <arm_neon.h>
+#endif
+
+/* consist of
+int GetPredAdvancedBy0x0_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+int GetPredAdvancedBy0x1_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+int GetPredAdvancedBy1x0_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+int GetPredAdvancedBy1x1_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+and the NEON versions of the same.
+
+These give the same 8x8 prediction as the functions of get_pred_adv_b_add.cpp,
+with any alignment of prev. The pitch of pred_block is pred_width_rnd >> 1
+and the rounding control is pred_width_rnd & 1:
+    0x1, 1x0:   (a + b + rnd1) >> 1
+    1x1:        (a + b + c + d + 1 + rnd1) >> 2
+*/
+
+#if defined(M4VH263DEC_SSE2)
+
+int GetPredAdvancedBy0x0_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        _mm_storel_epi64((__m128i*)pred_block, _mm_loadl_epi64((__m128i*)prev));
+        prev += width;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+/* (a + b + rnd1) >> 1, _mm_avg_epu8 rounds up */
+static inline __m128i avg_rnd(__m128i a, __m128i b, int rnd1)
+{
+    __m128i avg = _mm_avg_epu8(a, b);
+
+    if (rnd1 == 0)
+    {
+        avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+    }
+    return avg;
+}
+
+int GetPredAdvancedBy0x1_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+    int rnd1 = pred_width_rnd & 1;
+    __m128i a, b;
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        a = _mm_loadl_epi64((__m128i*)prev);
+        b = _mm_loadl_epi64((__m128i*)(prev + 1));
+        _mm_storel_epi64((__m128i*)pred_block, avg_rnd(a, b, rnd1));
+        prev += width;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+int GetPredAdvancedBy1x0_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+    int rnd1 = pred_width_rnd & 1;
+    __m128i a, b;
+
+    a = _mm_loadl_epi64((__m128i*)prev);
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += width;
+        b = _mm_loadl_epi64((__m128i*)prev);
+        _mm_storel_epi64((__m128i*)pred_block, avg_rnd(a, b, rnd1));
+        a = b;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+int GetPredAdvancedBy1x1_SSE2(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rnd2 = _mm_set1_epi16((pred_width_rnd & 1) + 1);
+    __m128i sum0, sum1;
+
+    /* the horizontal sums of a row are used for the rows above and below */
+    sum0 = _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)prev), zero),
+                         _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(prev + 1)), zero));
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += width;
+        sum1 = _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)prev), zero),
+                             _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(prev + 1)), zero));
+        sum0 = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(sum0, sum1), rnd2), 2);
+        _mm_storel_epi64((__m128i*)pred_block, _mm_packus_epi16(sum0, sum0));
+        sum0 = sum1;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+#elif defined(M4VH263DEC_NEON)
+
+int GetPredAdvancedBy0x0_NEON(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        vst1_u8(pred_block, vld1_u8(prev));
+        prev += width;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+/* (a + b + rnd1) >> 1 */
+static inline uint8x8_t avg_rnd(uint8x8_t a, uint8x8_t b, int rnd1)
+{
+    return rnd1 ? vrhadd_u8(a, b) : vhadd_u8(a, b);
+}
+
+int GetPredAdvancedBy0x1_NEON(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+    int rnd1 = pred_width_rnd & 1;
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        vst1_u8(pred_block, avg_rnd(vld1_u8(prev), vld1_u8(prev + 1), rnd1));
+        prev += width;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+int GetPredAdvancedBy1x0_NEON(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+    int rnd1 = pred_width_rnd & 1;
+    uint8x8_t a, b;
+
+    a = vld1_u8(prev);
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += width;
+        b = vld1_u8(prev);
+        vst1_u8(pred_block, avg_rnd(a, b, rnd1));
+        a = b;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+int GetPredAdvancedBy1x1_NEON(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd)
+{
+    int i;
+    int pred_width = pred_width_rnd >> 1;
+    const uint16x8_t rnd2 = vdupq_n_u16((pred_width_rnd & 1) + 1);
+    uint16x8_t sum0, sum1;
+
+    /* the horizontal sums of a row are used for the rows above and below */
+    sum0 = vaddl_u8(vld1_u8(prev), vld1_u8(prev + 1));
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += width;
+        sum1 = vaddl_u8(vld1_u8(prev), vld1_u8(prev + 1));
+        vst1_u8(pred_block, vshrn_n_u16(vaddq_u16(vaddq_u16(sum0, sum1), rnd2), 2));
+        sum0 = sum1;
+        pred_block += pred_width;
+    }
+    return 1;
+}
+
+#endif
@@ -61,6 +61,15 @@ extern "C"
     void idctrow2_intra(int16 *blk, PIXEL *comp, int width);
     void idctrow3_intra(int16 *blk, PIXEL *comp, int width);
     void idctrow4_intra(int16 *blk, PIXEL *comp, int width);
+
+    /* full IDCT of the blocks with more than 10 coefficients */
+#if defined(M4VH263DEC_SSE2)
+    void idct8x8_SSE2(int16 *blk, uint8 *pred, uint8 *dst, int width);
+    void idct8x8_intra_SSE2(int16 *blk, PIXEL *comp, int width);
+#elif defined(M4VH263DEC_NEON)
+    void idct8x8_NEON(int16 *blk, uint8 *pred, uint8 *dst, int width);
+    void idct8x8_intra_NEON(int16 *blk, PIXEL *comp, int width);
+#endif
 #ifdef __cplusplus
 }
 #endif
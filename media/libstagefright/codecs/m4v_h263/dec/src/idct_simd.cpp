@@ -0,0 +1,422 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+#include "mp4def.h"
+#include "idct.h"
+
+#if defined(M4VH263DEC_SSE2)
+#include <emmintrin.h>
+#elif defined(M4VH263DEC_NEON)
+#include <arm_neon.h>
+#endif
+
+/* consist of
+void idct8x8_SSE2(int16 *blk, uint8 *pred, uint8 *dst, int width)
+void idct8x8_intra_SSE2(int16 *blk, PIXEL *comp, int width)
+and the NEON versions of the same.
+
+These do the idctcol() of block_idct.cpp on the eight columns, then the
+idctrow() or idctrow_intra() on the eight rows of a block, a whole pass at
+a time, with the same integer operations so that the output is bit-exact.
+The first stage is written without the common factors of the C version,
+e.g. W7 * (x4 + x5) + (W1 - W7) * x4 is W1 * x4 + W7 * x5, which is one
+multiply-add of 16-bit pairs. The column results are truncated to 16 bits
+like the stores of idctcol(). blk is cleared for the next block, as the
+row pass of the C version does.
+
+pred has a pitch of 16, dst and comp a pitch of width.
+*/
+
+#if defined(M4VH263DEC_SSE2)
+
+/* a pair of 16-bit constants for _mm_madd_epi16 */
+#define PAIR(a, b)  _mm_set_epi16((b), (a), (b), (a), (b), (a), (b), (a))
+
+static inline __m128i mul181(__m128i x)
+{
+    /* 181 = 128 + 32 + 16 + 4 + 1, SSE2 has no 32-bit multiply */
+    __m128i y = _mm_add_epi32(_mm_slli_epi32(x, 7), _mm_slli_epi32(x, 5));
+
+    y = _mm_add_epi32(y, _mm_slli_epi32(x, 4));
+    y = _mm_add_epi32(y, _mm_slli_epi32(x, 2));
+    return _mm_add_epi32(y, x);
+}
+
+static inline void transpose8x8(__m128i *v)
+{
+    __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+    __m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+    __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+    __m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+    __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+    __m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+    __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+    __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    v[0] = _mm_unpacklo_epi64(b0, b4);
+    v[1] = _mm_unpackhi_epi64(b0, b4);
+    v[2] = _mm_unpacklo_epi64(b1, b5);
+    v[3] = _mm_unpackhi_epi64(b1, b5);
+    v[4] = _mm_unpacklo_epi64(b2, b6);
+    v[5] = _mm_unpackhi_epi64(b2, b6);
+    v[6] = _mm_unpacklo_epi64(b3, b7);
+    v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/* one pass on v[0..7], each lane is a column (row == 0) or a row (row == 1) */
+static inline void idct_pass(__m128i *v, int row)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w1_w7 = PAIR(W1, W7);
+    const __m128i w7_mw1 = PAIR(W7, -W1);
+    const __m128i w5_w3 = PAIR(W5, W3);
+    const __m128i w3_mw5 = PAIR(W3, -W5);
+    const __m128i w6_mw2 = PAIR(W6, -W2);
+    const __m128i w2_w6 = PAIR(W2, W6);
+    const __m128i four = _mm_set1_epi32(4);
+    const __m128i rnd0 = _mm_set1_epi32(row ? 8192 : 128);
+    const __m128i rnd181 = _mm_set1_epi32(128);
+    __m128i out[2][8];
+    __m128i p17, p53, p26, x0, x1, x2, x3, x4, x5, x6, x7, x8;
+    int h;
+
+    for (h = 0; h < 2; h++)
+    {
+        if (h == 0)
+        {
+            p17 = _mm_unpacklo_epi16(v[1], v[7]);
+            p53 = _mm_unpacklo_epi16(v[5], v[3]);
+            p26 = _mm_unpacklo_epi16(v[2], v[6]);
+            x0 = _mm_unpacklo_epi16(zero, v[0]);
+            x1 = _mm_unpacklo_epi16(zero, v[4]);
+        }
+        else
+        {
+            p17 = _mm_unpackhi_epi16(v[1], v[7]);
+            p53 = _mm_unpackhi_epi16(v[5], v[3]);
+            p26 = _mm_unpackhi_epi16(v[2], v[6]);
+            x0 = _mm_unpackhi_epi16(zero, v[0]);
+            x1 = _mm_unpackhi_epi16(zero, v[4]);
+        }
+
+        /* first stage */
+        x4 = _mm_madd_epi16(p17, w1_w7);
+        x5 = _mm_madd_epi16(p17, w7_mw1);
+        x6 = _mm_madd_epi16(p53, w5_w3);
+        x7 = _mm_madd_epi16(p53, w3_mw5);
+        x2 = _mm_madd_epi16(p26, w6_mw2);
+        x3 = _mm_madd_epi16(p26, w2_w6);
+
+        if (row)
+        {
+            x4 = _mm_srai_epi32(_mm_add_epi32(x4, four), 3);
+            x5 = _mm_srai_epi32(_mm_add_epi32(x5, four), 3);
+            x6 = _mm_srai_epi32(_mm_add_epi32(x6, four), 3);
+            x7 = _mm_srai_epi32(_mm_add_epi32(x7, four), 3);
+            x2 = _mm_srai_epi32(_mm_add_epi32(x2, four), 3);
+            x3 = _mm_srai_epi32(_mm_add_epi32(x3, four), 3);
+
+            /* x << 16 >> 8, blk[0] << 8 and blk[4] << 8 */
+            x0 = _mm_srai_epi32(x0, 8);
+            x1 = _mm_srai_epi32(x1, 8);
+        }
+        else
+        {
+            /* blk[0] << 11 and blk[32] << 11 */
+            x0 = _mm_srai_epi32(x0, 5);
+            x1 = _mm_srai_epi32(x1, 5);
+        }
+        x0 = _mm_add_epi32(x0, rnd0);
+
+        /* second stage */
+        x8 = _mm_add_epi32(x0, x1);
+        x0 = _mm_sub_epi32(x0, x1);
+        x1 = _mm_add_epi32(x4, x6);
+        x4 = _mm_sub_epi32(x4, x6);
+        x6 = _mm_add_epi32(x5, x7);
+        x5 = _mm_sub_epi32(x5, x7);
+
+        /* third stage */
+        x7 = _mm_add_epi32(x8, x3);
+        x8 = _mm_sub_epi32(x8, x3);
+        x3 = _mm_add_epi32(x0, x2);
+        x0 = _mm_sub_epi32(x0, x2);
+        x2 = _mm_srai_epi32(_mm_add_epi32(mul181(_mm_add_epi32(x4, x5)), rnd181), 8);
+        x4 = _mm_srai_epi32(_mm_add_epi32(mul181(_mm_sub_epi32(x4, x5)), rnd181), 8);
+
+        /* fourth stage */
+        out[h][0] = _mm_add_epi32(x7, x1);
+        out[h][1] = _mm_add_epi32(x3, x2);
+        out[h][2] = _mm_add_epi32(x0, x4);
+        out[h][3] = _mm_add_epi32(x8, x6);
+        out[h][4] = _mm_sub_epi32(x8, x6);
+        out[h][5] = _mm_sub_epi32(x0, x4);
+        out[h][6] = _mm_sub_epi32(x3, x2);
+        out[h][7] = _mm_sub_epi32(x7, x1);
+    }
+
+    for (h = 0; h < 8; h++)
+    {
+        if (row)
+        {
+            /* saturated, the clipping to 8 bits that follows gives the same */
+            v[h] = _mm_packs_epi32(_mm_srai_epi32(out[0][h], 14),
+                                   _mm_srai_epi32(out[1][h], 14));
+        }
+        else
+        {
+            /* truncated to 16 bits like the int16 store of idctcol() */
+            x0 = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(out[0][h], 8), 16), 16);
+            x1 = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(out[1][h], 8), 16), 16);
+            v[h] = _mm_packs_epi32(x0, x1);
+        }
+    }
+}
+
+/* the 2-D IDCT of blk into v[0..7] with one row of 16-bit results each */
+static inline void idct8x8(int16 *blk, __m128i *v)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        v[i] = _mm_loadu_si128((__m128i*)(blk + (i << 3)));
+        _mm_storeu_si128((__m128i*)(blk + (i << 3)), zero);
+    }
+
+    idct_pass(v, 0);
+    transpose8x8(v);
+    idct_pass(v, 1);
+    transpose8x8(v);
+}
+
+void idct8x8_SSE2(int16 *blk, uint8 *pred, uint8 *dst, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v[8], p;
+    int i;
+
+    idct8x8(blk, v);
+
+    for (i = 0; i < 8; i++)
+    {
+        p = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)pred), zero);
+        _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(_mm_adds_epi16(v[i], p), zero));
+        pred += 16;
+        dst += width;
+    }
+}
+
+void idct8x8_intra_SSE2(int16 *blk, PIXEL *comp, int width)
+{
+    __m128i v[8];
+    int i;
+
+    idct8x8(blk, v);
+
+    for (i = 0; i < 8; i++)
+    {
+        _mm_storel_epi64((__m128i*)comp, _mm_packus_epi16(v[i], v[i]));
+        comp += width;
+    }
+}
+
+#elif defined(M4VH263DEC_NEON)
+
+static inline void transpose8x8(int16x8_t *v)
+{
+    int16x8x2_t t0 = vtrnq_s16(v[0], v[1]);
+    int16x8x2_t t1 = vtrnq_s16(v[2], v[3]);
+    int16x8x2_t t2 = vtrnq_s16(v[4], v[5]);
+    int16x8x2_t t3 = vtrnq_s16(v[6], v[7]);
+    int32x4x2_t u0 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[0]), vreinterpretq_s32_s16(t1.val[0]));
+    int32x4x2_t u1 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[1]), vreinterpretq_s32_s16(t1.val[1]));
+    int32x4x2_t u2 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[0]), vreinterpretq_s32_s16(t3.val[0]));
+    int32x4x2_t u3 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[1]), vreinterpretq_s32_s16(t3.val[1]));
+
+    v[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[0]), vget_low_s32(u2.val[0])));
+    v[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[0]), vget_low_s32(u3.val[0])));
+    v[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[1]), vget_low_s32(u2.val[1])));
+    v[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[1]), vget_low_s32(u3.val[1])));
+    v[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[0]), vget_high_s32(u2.val[0])));
+    v[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[0]), vget_high_s32(u3.val[0])));
+    v[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[1]), vget_high_s32(u2.val[1])));
+    v[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[1]), vget_high_s32(u3.val[1])));
+}
+
+/* one pass on v[0..7], each lane is a column (row == 0) or a row (row == 1) */
+static inline void idct_pass(int16x8_t *v, int row)
+{
+    const int32x4_t four = vdupq_n_s32(4);
+    const int32x4_t rnd0 = vdupq_n_s32(row ? 8192 : 128);
+    const int32x4_t rnd181 = vdupq_n_s32(128);
+    int32x4_t out[2][8];
+    int16x4_t r0, r1, r2, r3, r4, r5, r6, r7;
+    int32x4_t x0, x1, x2, x3, x4, x5, x6, x7, x8;
+    int h;
+
+    for (h = 0; h < 2; h++)
+    {
+        if (h == 0)
+        {
+            r0 = vget_low_s16(v[0]);
+            r1 = vget_low_s16(v[1]);
+            r2 = vget_low_s16(v[2]);
+            r3 = vget_low_s16(v[3]);
+            r4 = vget_low_s16(v[4]);
+            r5 = vget_low_s16(v[5]);
+            r6 = vget_low_s16(v[6]);
+            r7 = vget_low_s16(v[7]);
+        }
+        else
+        {
+            r0 = vget_high_s16(v[0]);
+            r1 = vget_high_s16(v[1]);
+            r2 = vget_high_s16(v[2]);
+            r3 = vget_high_s16(v[3]);
+            r4 = vget_high_s16(v[4]);
+            r5 = vget_high_s16(v[5]);
+            r6 = vget_high_s16(v[6]);
+            r7 = vget_high_s16(v[7]);
+        }
+
+        /* first stage */
+        x4 = vmlal_n_s16(vmull_n_s16(r1, W1), r7, W7);
+        x5 = vmlsl_n_s16(vmull_n_s16(r1, W7), r7, W1);
+        x6 = vmlal_n_s16(vmull_n_s16(r5, W5), r3, W3);
+        x7 = vmlsl_n_s16(vmull_n_s16(r5, W3), r3, W5);
+        x2 = vmlsl_n_s16(vmull_n_s16(r2, W6), r6, W2);
+        x3 = vmlal_n_s16(vmull_n_s16(r2, W2), r6, W6);
+
+        if (row)
+        {
+            x4 = vshrq_n_s32(vaddq_s32(x4, four), 3);
+            x5 = vshrq_n_s32(vaddq_s32(x5, four), 3);
+            x6 = vshrq_n_s32(vaddq_s32(x6, four), 3);
+            x7 = vshrq_n_s32(vaddq_s32(x7, four), 3);
+            x2 = vshrq_n_s32(vaddq_s32(x2, four), 3);
+            x3 = vshrq_n_s32(vaddq_s32(x3, four), 3);
+            x0 = vshll_n_s16(r0, 8);
+            x1 = vshll_n_s16(r4, 8);
+        }
+        else
+        {
+            x0 = vshll_n_s16(r0, 11);
+            x1 = vshll_n_s16(r4, 11);
+        }
+        x0 = vaddq_s32(x0, rnd0);
+
+        /* second stage */
+        x8 = vaddq_s32(x0, x1);
+        x0 = vsubq_s32(x0, x1);
+        x1 = vaddq_s32(x4, x6);
+        x4 = vsubq_s32(x4, x6);
+        x6 = vaddq_s32(x5, x7);
+        x5 = vsubq_s32(x5, x7);
+
+        /* third stage */
+        x7 = vaddq_s32(x8, x3);
+        x8 = vsubq_s32(x8, x3);
+        x3 = vaddq_s32(x0, x2);
+        x0 = vsubq_s32(x0, x2);
+        x2 = vshrq_n_s32(vmlaq_n_s32(rnd181, vaddq_s32(x4, x5), 181), 8);
+        x4 = vshrq_n_s32(vmlaq_n_s32(rnd181, vsubq_s32(x4, x5), 181), 8);
+
+        /* fourth stage */
+        out[h][0] = vaddq_s32(x7, x1);
+        out[h][1] = vaddq_s32(x3, x2);
+        out[h][2] = vaddq_s32(x0, x4);
+        out[h][3] = vaddq_s32(x8, x6);
+        out[h][4] = vsubq_s32(x8, x6);
+        out[h][5] = vsubq_s32(x0, x4);
+        out[h][6] = vsubq_s32(x3, x2);
+        out[h][7] = vsubq_s32(x7, x1);
+    }
+
+    for (h = 0; h < 8; h++)
+    {
+        if (row)
+        {
+            /* saturated, the clipping to 8 bits that follows gives the same */
+            v[h] = vcombine_s16(vqshrn_n_s32(out[0][h], 14), vqshrn_n_s32(out[1][h], 14));
+        }
+        else
+        {
+            /* truncated to 16 bits like the int16 store of idctcol() */
+            v[h] = vcombine_s16(vshrn_n_s32(out[0][h], 8), vshrn_n_s32(out[1][h], 8));
+        }
+    }
+}
+
+/* the 2-D IDCT of blk into v[0..7] with one row of 16-bit results each */
+static inline void idct8x8(int16 *blk, int16x8_t *v)
+{
+    const int16x8_t zero = vdupq_n_s16(0);
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        v[i] = vld1q_s16(blk + (i << 3));
+        vst1q_s16(blk + (i << 3), zero);
+    }
+
+    idct_pass(v, 0);
+    transpose8x8(v);
+    idct_pass(v, 1);
+    transpose8x8(v);
+}
+
+void idct8x8_NEON(int16 *blk, uint8 *pred, uint8 *dst, int width)
+{
+    int16x8_t v[8], p;
+    int i;
+
+    idct8x8(blk, v);
+
+    for (i = 0; i < 8; i++)
+    {
+        p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(pred)));
+        vst1_u8(dst, vqmovun_s16(vqaddq_s16(v[i], p)));
+        pred += 16;
+        dst += width;
+    }
+}
+
+void idct8x8_intra_NEON(int16 *blk, PIXEL *comp, int width)
+{
+    int16x8_t v[8];
+    int i;
+
+    idct8x8(blk, v);
+
+    for (i = 0; i < 8; i++)
+    {
+        vst1_u8(comp, vqmovun_s16(v[i]));
+        comp += width;
+    }
+}
+
+#endif
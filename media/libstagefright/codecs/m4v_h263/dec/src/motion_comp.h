@@ -72,11 +72,25 @@ extern "C"
                             }
 
 
+#if defined(M4VH263DEC_SSE2)
+    static int (*const GetPredAdvBTable[2][2])(uint8*, uint8*, int, int) =
+    {
+        {&GetPredAdvancedBy0x0_SSE2, &GetPredAdvancedBy0x1_SSE2},
+        {&GetPredAdvancedBy1x0_SSE2, &GetPredAdvancedBy1x1_SSE2}
+    };
+#elif defined(M4VH263DEC_NEON)
+    static int (*const GetPredAdvBTable[2][2])(uint8*, uint8*, int, int) =
+    {
+        {&GetPredAdvancedBy0x0_NEON, &GetPredAdvancedBy0x1_NEON},
+        {&GetPredAdvancedBy1x0_NEON, &GetPredAdvancedBy1x1_NEON}
+    };
+#else
     static int (*const GetPredAdvBTable[2][2])(uint8*, uint8*, int, int) =
     {
         {&GetPredAdvancedBy0x0, &GetPredAdvancedBy0x1},
         {&GetPredAdvancedBy1x0, &GetPredAdvancedBy1x1}
     };
+#endif
 
     /*----------------------------------------------------------------------------
     ; SIMPLE TYPEDEF'S
@@ -242,6 +242,20 @@ extern "C"
         int pred_width_rnd /* i */
     );
 
+    /*--------------------------------------------------------------------------*/
+    /* defined in get_pred_adv_b_simd.c, the same as above */
+#if defined(M4VH263DEC_SSE2)
+    int GetPredAdvancedBy0x0_SSE2(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+    int GetPredAdvancedBy0x1_SSE2(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+    int GetPredAdvancedBy1x0_SSE2(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+    int GetPredAdvancedBy1x1_SSE2(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+#elif defined(M4VH263DEC_NEON)
+    int GetPredAdvancedBy0x0_NEON(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+    int GetPredAdvancedBy0x1_NEON(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+    int GetPredAdvancedBy1x0_NEON(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+    int GetPredAdvancedBy1x1_NEON(uint8 *c_prev, uint8 *pred_block, int width, int pred_width_rnd);
+#endif
+
     /*--------------------------------------------------------------------------*/
     /* defined in get_pred_outside.c */
     int GetPredOutside(
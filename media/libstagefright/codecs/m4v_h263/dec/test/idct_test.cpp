@@ -0,0 +1,561 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks the IDCT of BlockIDCT() and BlockIDCT_intra() against the accuracy
+// limits of IEEE 1180-1990, checks that it gives exactly what the column
+// and row functions of block_idct.cpp give, checks the motion compensation
+// functions of GetPredAdvBTable against the C versions, and prints the time
+// each of them takes. With M4VH263DEC_SSE2 or M4VH263DEC_NEON these are the
+// SIMD kernels, otherwise the C ones.
+//
+// Usage: m4vh263dec_idct_test [iterations] [seed]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mp4dec_lib.h"
+#include "idct.h"
+#include "motion_comp.h"
+
+enum {
+    kWidth = 40,
+    kIeeeBlocks = 10000,
+};
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+// The random number generator of IEEE 1180, uniform in [-L, H].
+static long gRandx = 1;
+
+static long ieeeRandom(long L, long H) {
+    gRandx = (gRandx * 1103515245) + 12345;
+    long i = gRandx & 0x7ffffffe;
+    double x = ((double)i) / (double)0x7fffffff;
+    x *= (L + H + 1);
+    return (long)x - L;
+}
+
+static double gCos[8][8];
+
+static void initCos() {
+    for (int k = 0; k < 8; ++k) {
+        for (int n = 0; n < 8; ++n) {
+            double c = (k == 0) ? sqrt(0.125) : 0.5;
+            gCos[k][n] = c * cos((2 * n + 1) * k * M_PI / 16.0);
+        }
+    }
+}
+
+static void referenceFdct(const int *in, double *out) {
+    double tmp[64];
+    for (int y = 0; y < 8; ++y) {
+        for (int k = 0; k < 8; ++k) {
+            double s = 0;
+            for (int n = 0; n < 8; ++n) s += gCos[k][n] * in[y * 8 + n];
+            tmp[y * 8 + k] = s;
+        }
+    }
+    for (int x = 0; x < 8; ++x) {
+        for (int k = 0; k < 8; ++k) {
+            double s = 0;
+            for (int n = 0; n < 8; ++n) s += gCos[k][n] * tmp[n * 8 + x];
+            out[k * 8 + x] = s;
+        }
+    }
+}
+
+static void referenceIdct(const int *in, double *out) {
+    double tmp[64];
+    for (int y = 0; y < 8; ++y) {
+        for (int n = 0; n < 8; ++n) {
+            double s = 0;
+            for (int k = 0; k < 8; ++k) s += gCos[k][n] * in[y * 8 + k];
+            tmp[y * 8 + n] = s;
+        }
+    }
+    for (int x = 0; x < 8; ++x) {
+        for (int n = 0; n < 8; ++n) {
+            double s = 0;
+            for (int k = 0; k < 8; ++k) s += gCos[k][n] * tmp[k * 8 + x];
+            out[n * 8 + x] = s;
+        }
+    }
+}
+
+static int clip(int x, int lo, int hi) {
+    return (x < lo) ? lo : (x > hi) ? hi : x;
+}
+
+// The bitmaps and coefficient count the way VlcDequantH263InterBlock()
+// sets them for a block with more than 10 coefficients.
+static void setBitmaps(const int16 *blk, uint8 *bitmapcol, uint8 *bitmaprow) {
+    static const uint8 mask[8] = { 128, 64, 32, 16, 8, 4, 2, 1 };
+
+    memset(bitmapcol, 0, 8);
+    *bitmaprow = 0;
+    for (int k = 0; k < 64; ++k) {
+        if (blk[k]) {
+            bitmapcol[k & 7] |= mask[k >> 3];
+        }
+    }
+    for (int k = 1; k < 4; ++k) {
+        if (bitmapcol[k]) {
+            *bitmaprow |= mask[k];
+        }
+    }
+}
+
+// The inter IDCT of the library with a prediction of 0 and of 255, which
+// together give its output in [-255, 255].
+static void libraryIdct(const int16 *coeffs, int *out) {
+    int16 blk[64];
+    uint8 bitmapcol[8], bitmaprow;
+    uint8 pred[128];
+    uint8 low[8 * kWidth], high[8 * kWidth];
+
+    setBitmaps(coeffs, bitmapcol, &bitmaprow);
+
+    memcpy(blk, coeffs, sizeof(blk));
+    memset(pred, 0, sizeof(pred));
+    BlockIDCT(low, pred, blk, kWidth, 64, bitmapcol, bitmaprow);
+
+    memcpy(blk, coeffs, sizeof(blk));
+    memset(pred, 255, sizeof(pred));
+    BlockIDCT(high, pred, blk, kWidth, 64, bitmapcol, bitmaprow);
+
+    for (int i = 0; i < 64; ++i) {
+        int p = (i >> 3) * kWidth + (i & 7);
+        out[i] = (low[p] > 0) ? low[p] : high[p] - 255;
+    }
+}
+
+static int checkIeee1180(long L, long H, int sign) {
+    int64_t errSum[64], errSquares[64];
+    int peak = 0;
+
+    memset(errSum, 0, sizeof(errSum));
+    memset(errSquares, 0, sizeof(errSquares));
+    gRandx = 1;
+
+    for (int b = 0; b < kIeeeBlocks; ++b) {
+        int pixels[64], coeffs[64], out[64];
+        double dct[64], ref[64];
+        int16 blk[64];
+
+        for (int i = 0; i < 64; ++i) {
+            pixels[i] = sign * ieeeRandom(L, H);
+        }
+        referenceFdct(pixels, dct);
+        for (int i = 0; i < 64; ++i) {
+            coeffs[i] = clip((int)floor(dct[i] + 0.5), -2048, 2047);
+            blk[i] = coeffs[i];
+        }
+
+        referenceIdct(coeffs, ref);
+        libraryIdct(blk, out);
+
+        for (int i = 0; i < 64; ++i) {
+            // -256 cannot be told from -255 with an 8-bit output.
+            int err = out[i] - clip((int)floor(ref[i] + 0.5), -255, 255);
+            if (abs(err) > peak) peak = abs(err);
+            errSum[i] += err;
+            errSquares[i] += err * err;
+        }
+    }
+
+    double pmse = 0, pme = 0, omse = 0, ome = 0;
+    for (int i = 0; i < 64; ++i) {
+        double mse = (double)errSquares[i] / kIeeeBlocks;
+        double me = fabs((double)errSum[i] / kIeeeBlocks);
+        if (mse > pmse) pmse = mse;
+        if (me > pme) pme = me;
+        omse += (double)errSquares[i];
+        ome += (double)errSum[i];
+    }
+    omse /= 64.0 * kIeeeBlocks;
+    ome = fabs(ome / (64.0 * kIeeeBlocks));
+
+    bool ok = (peak <= 1) && (pmse <= 0.06) && (omse <= 0.02)
+            && (pme <= 0.015) && (ome <= 0.0015);
+
+    printf("IEEE 1180 [-%ld, %ld] sign %+d: peak %d pmse %.4f omse %.4f "
+           "pme %.4f ome %.5f %s\n",
+           L, H, sign, peak, pmse, omse, pme, ome, ok ? "ok" : "FAILED");
+
+    return ok ? 0 : 1;
+}
+
+static int checkZeroInput() {
+    int16 blk[64];
+    int out[64];
+
+    memset(blk, 0, sizeof(blk));
+    libraryIdct(blk, out);
+    for (int i = 0; i < 64; ++i) {
+        if (out[i] != 0) {
+            printf("IEEE 1180 zero input: FAILED\n");
+            return 1;
+        }
+    }
+    printf("IEEE 1180 zero input: ok\n");
+    return 0;
+}
+
+// A transcription of idctcol() and idctrow()/idctrow_intra() of
+// block_idct.cpp, which the full IDCT has to match bit for bit.
+static void scalarIdct(const int16 *in, const uint8 *pred, uint8 *dst, int width) {
+    int16 blk[64];
+    memcpy(blk, in, sizeof(blk));
+
+    for (int c = 0; c < 8; ++c) {
+        int16 *b = blk + c;
+        int32 x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+        x1 = (int32)b[32] << 11;
+        x2 = b[48];
+        x3 = b[16];
+        x4 = b[8];
+        x5 = b[56];
+        x6 = b[40];
+        x7 = b[24];
+        x0 = ((int32)b[0] << 11) + 128;
+
+        x8 = W7 * (x4 + x5);
+        x4 = x8 + (W1 - W7) * x4;
+        x5 = x8 - (W1 + W7) * x5;
+        x8 = W3 * (x6 + x7);
+        x6 = x8 - (W3 - W5) * x6;
+        x7 = x8 - (W3 + W5) * x7;
+
+        x8 = x0 + x1;
+        x0 -= x1;
+        x1 = W6 * (x3 + x2);
+        x2 = x1 - (W2 + W6) * x2;
+        x3 = x1 + (W2 - W6) * x3;
+        x1 = x4 + x6;
+        x4 -= x6;
+        x6 = x5 + x7;
+        x5 -= x7;
+
+        x7 = x8 + x3;
+        x8 -= x3;
+        x3 = x0 + x2;
+        x0 -= x2;
+        x2 = (181 * (x4 + x5) + 128) >> 8;
+        x4 = (181 * (x4 - x5) + 128) >> 8;
+
+        b[0] = (x7 + x1) >> 8;
+        b[8] = (x3 + x2) >> 8;
+        b[16] = (x0 + x4) >> 8;
+        b[24] = (x8 + x6) >> 8;
+        b[32] = (x8 - x6) >> 8;
+        b[40] = (x0 - x4) >> 8;
+        b[48] = (x3 - x2) >> 8;
+        b[56] = (x7 - x1) >> 8;
+    }
+
+    for (int r = 0; r < 8; ++r) {
+        int16 *b = blk + r * 8;
+        int32 x0, x1, x2, x3, x4, x5, x6, x7, x8;
+        int32 res[8];
+
+        x1 = (int32)b[4] << 8;
+        x2 = b[6];
+        x3 = b[2];
+        x4 = b[1];
+        x5 = b[7];
+        x6 = b[5];
+        x7 = b[3];
+        x0 = ((int32)b[0] << 8) + 8192;
+
+        x8 = W7 * (x4 + x5) + 4;
+        x4 = (x8 + (W1 - W7) * x4) >> 3;
+        x5 = (x8 - (W1 + W7) * x5) >> 3;
+        x8 = W3 * (x6 + x7) + 4;
+        x6 = (x8 - (W3 - W5) * x6) >> 3;
+        x7 = (x8 - (W3 + W5) * x7) >> 3;
+
+        x8 = x0 + x1;
+        x0 -= x1;
+        x1 = W6 * (x3 + x2) + 4;
+        x2 = (x1 - (W2 + W6) * x2) >> 3;
+        x3 = (x1 + (W2 - W6) * x3) >> 3;
+        x1 = x4 + x6;
+        x4 -= x6;
+        x6 = x5 + x7;
+        x5 -= x7;
+
+        x7 = x8 + x3;
+        x8 -= x3;
+        x3 = x0 + x2;
+        x0 -= x2;
+        x2 = (181 * (x4 + x5) + 128) >> 8;
+        x4 = (181 * (x4 - x5) + 128) >> 8;
+
+        res[0] = (x7 + x1) >> 14;
+        res[1] = (x3 + x2) >> 14;
+        res[2] = (x0 + x4) >> 14;
+        res[3] = (x8 + x6) >> 14;
+        res[4] = (x8 - x6) >> 14;
+        res[5] = (x0 - x4) >> 14;
+        res[6] = (x3 - x2) >> 14;
+        res[7] = (x7 - x1) >> 14;
+
+        for (int i = 0; i < 8; ++i) {
+            dst[r * width + i] = clip(res[i] + (pred ? pred[r * 16 + i] : 0), 0, 255);
+        }
+    }
+}
+
+static void randomDenseBlock(int16 *blk, int pattern) {
+    memset(blk, 0, 64 * sizeof(int16));
+
+    int count = 11 + rand() % 54;
+    for (int c = 0; c < count; ++c) {
+        int k;
+        switch (pattern) {
+            case 0:
+                // Only the first four columns, the VCA2 column functions.
+                k = (rand() % 8) * 8 + rand() % 4;
+                break;
+            case 1:
+                // Only the top-left 4x4, the VCA2 row functions.
+                k = (rand() % 4) * 8 + rand() % 4;
+                break;
+            default:
+                k = rand() % 64;
+                break;
+        }
+
+        int v;
+        switch (pattern) {
+            case 3:
+                v = (rand() % 4096) - 2048;
+                break;
+            case 4:
+                // The extremes of the dequantizer output.
+                v = (rand() & 1) ? 2047 : -2048;
+                break;
+            default:
+                v = (rand() % 401) - 200;
+                break;
+        }
+        blk[k] = v;
+    }
+
+    // More than 10 coefficients, whatever the random positions were.
+    for (int k = 0; k < 11; ++k) {
+        if (blk[k] == 0) blk[k] = 1;
+    }
+}
+
+static int checkBitExact(int iterations) {
+    int failures = 0;
+
+    for (int it = 0; it < iterations; ++it) {
+        int16 coeffs[64], blk[64];
+        uint8 bitmapcol[8], bitmaprow;
+        uint8 pred[128];
+        uint8 expected[8 * kWidth], actual[8 * kWidth];
+        bool intra = (it & 1);
+
+        randomDenseBlock(coeffs, (it >> 1) % 5);
+        setBitmaps(coeffs, bitmapcol, &bitmaprow);
+        for (int i = 0; i < 128; ++i) {
+            pred[i] = rand() & 0xff;
+        }
+
+        memset(expected, 0x55, sizeof(expected));
+        memset(actual, 0x55, sizeof(actual));
+        scalarIdct(coeffs, intra ? NULL : pred, expected, kWidth);
+
+        if (intra) {
+            MacroBlock mblock;
+            memset(&mblock, 0, sizeof(mblock));
+            memcpy(mblock.block[0], coeffs, sizeof(coeffs));
+            mblock.no_coeff[0] = 64;
+            memcpy(mblock.bitmapcol[0], bitmapcol, 8);
+            mblock.bitmaprow[0] = bitmaprow;
+            BlockIDCT_intra(&mblock, actual, 0, kWidth);
+            memcpy(blk, mblock.block[0], sizeof(blk));
+        } else {
+            memcpy(blk, coeffs, sizeof(blk));
+            BlockIDCT(actual, pred, blk, kWidth, 64, bitmapcol, bitmaprow);
+        }
+
+        bool ok = true;
+        for (int r = 0; r < 8; ++r) {
+            if (memcmp(expected + r * kWidth, actual + r * kWidth, 8)) ok = false;
+        }
+        for (int i = 0; i < 64; ++i) {
+            if (blk[i] != 0) ok = false;
+        }
+
+        if (!ok) {
+            if (failures < 10) {
+                fprintf(stderr, "%s IDCT mismatch at iteration %d\n",
+                        intra ? "intra" : "inter", it);
+            }
+            ++failures;
+        }
+    }
+
+    printf("IDCT: %d of %d blocks differ from the column and row functions\n",
+           failures, iterations);
+
+    return failures;
+}
+
+typedef int (*PredFunc)(uint8 *prev, uint8 *pred_block, int width, int pred_width_rnd);
+
+static int checkMotionComp(int iterations) {
+    static const PredFunc kReference[2][2] = {
+        { &GetPredAdvancedBy0x0, &GetPredAdvancedBy0x1 },
+        { &GetPredAdvancedBy1x0, &GetPredAdvancedBy1x1 },
+    };
+    static const int kPitches[] = { 24, 40, 192, 736 };
+
+    static uint8 prev[736 * 10 + 32];
+    uint8 expected[16 * 8], actual[16 * 8];
+    int failures = 0;
+
+    for (int it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < sizeof(prev); ++i) {
+            switch (it % 3) {
+                case 0: prev[i] = rand() & 0xff; break;
+                case 1: prev[i] = (rand() & 1) ? 0xff : 0x00; break;
+                default: prev[i] = 128 + (rand() % 5) - 2; break;
+            }
+        }
+
+        int width = kPitches[it % 4];
+        int offset = rand() % 16;
+        int predWidth = (it & 2) ? 8 : 16;
+        int rnd1 = (it >> 2) & 1;
+
+        for (int y = 0; y < 2; ++y) {
+            for (int x = 0; x < 2; ++x) {
+                memset(expected, 0x55, sizeof(expected));
+                memset(actual, 0x55, sizeof(actual));
+                kReference[y][x](prev + offset, expected, width, (predWidth << 1) | rnd1);
+                GetPredAdvBTable[y][x](prev + offset, actual, width, (predWidth << 1) | rnd1);
+
+                if (memcmp(expected, actual, sizeof(expected))) {
+                    if (failures < 10) {
+                        fprintf(stderr, "GetPredAdvancedBy%dx%d mismatch: width %d "
+                                "offset %d rnd1 %d\n", y, x, width, offset, rnd1);
+                    }
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    printf("motion compensation: %d of %d blocks differ from the C functions\n",
+           failures, iterations * 4);
+
+    return failures;
+}
+
+static void benchmark() {
+    enum { kRuns = 200000 };
+    static const PredFunc kReference[2][2] = {
+        { &GetPredAdvancedBy0x0, &GetPredAdvancedBy0x1 },
+        { &GetPredAdvancedBy1x0, &GetPredAdvancedBy1x1 },
+    };
+    int16 coeffs[64], blk[64];
+    uint8 bitmapcol[8], bitmaprow;
+    uint8 pred[128], dst[8 * kWidth];
+    static uint8 prev[kWidth * 10];
+    uint8 block[16 * 8];
+    MacroBlock mblock;
+
+    randomDenseBlock(coeffs, 2);
+    setBitmaps(coeffs, bitmapcol, &bitmaprow);
+    for (int i = 0; i < 128; ++i) pred[i] = rand() & 0xff;
+    for (size_t i = 0; i < sizeof(prev); ++i) prev[i] = rand() & 0xff;
+
+    int64_t start = nowNs();
+    for (int i = 0; i < kRuns; ++i) {
+        memcpy(blk, coeffs, sizeof(blk));
+        BlockIDCT(dst, pred, blk, kWidth, 64, bitmapcol, bitmaprow);
+    }
+    printf("BlockIDCT, 8x8: %.1f ns\n", (double)(nowNs() - start) / kRuns);
+
+    memset(&mblock, 0, sizeof(mblock));
+    mblock.no_coeff[0] = 64;
+    memcpy(mblock.bitmapcol[0], bitmapcol, 8);
+    mblock.bitmaprow[0] = bitmaprow;
+    start = nowNs();
+    for (int i = 0; i < kRuns; ++i) {
+        memcpy(mblock.block[0], coeffs, sizeof(coeffs));
+        BlockIDCT_intra(&mblock, dst, 0, kWidth);
+    }
+    printf("BlockIDCT_intra, 8x8: %.1f ns\n", (double)(nowNs() - start) / kRuns);
+
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            start = nowNs();
+            for (int i = 0; i < kRuns; ++i) {
+                kReference[y][x](prev + (i & 3), block, kWidth, (16 << 1) | (i & 1));
+            }
+            int64_t c = nowNs() - start;
+
+            start = nowNs();
+            for (int i = 0; i < kRuns; ++i) {
+                GetPredAdvBTable[y][x](prev + (i & 3), block, kWidth, (16 << 1) | (i & 1));
+            }
+            int64_t selected = nowNs() - start;
+
+            printf("GetPredAdvancedBy%dx%d: C %.1f ns, selected %.1f ns\n", y, x,
+                   (double)c / kRuns, (double)selected / kRuns);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 100000;
+    unsigned seed = (argc > 2) ? atoi(argv[2]) : (unsigned)time(NULL);
+
+    srand(seed);
+    initCos();
+
+    int failures = 0;
+
+    failures += checkIeee1180(256, 255, 1);
+    failures += checkIeee1180(256, 255, -1);
+    failures += checkIeee1180(5, 5, 1);
+    failures += checkIeee1180(5, 5, -1);
+    failures += checkIeee1180(300, 300, 1);
+    failures += checkIeee1180(300, 300, -1);
+    failures += checkZeroInput();
+
+    failures += checkBitExact(iterations);
+    failures += checkMotionComp(iterations / 10);
+
+    benchmark();
+
+    printf("%s (seed %u)\n", failures ? "FAILED" : "passed", seed);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -6,6 +6,7 @@ LOCAL_SRC_FILES := \
     src/combined_encode.cpp \
     src/datapart_encode.cpp \
     src/dct.cpp \
+    src/dct_simd.cpp \
     src/findhalfpel.cpp \
     src/fastcodemb.cpp \
     src/fastidct.cpp \
@@ -15,6 +16,7 @@ LOCAL_SRC_FILES := \
     src/rate_control.cpp \
     src/motion_est.cpp \
     src/motion_comp.cpp \
+    src/motion_comp_simd.cpp \
     src/sad.cpp \
     src/sad_halfpel.cpp \
     src/vlc_encode.cpp \
@@ -27,6 +29,17 @@ LOCAL_CFLAGS := \
     -DBX_RC \
     -DOSCL_IMPORT_REF= -DOSCL_UNUSED_ARG= -DOSCL_EXPORT_REF=
 
+# The 8x8 DCT, IDCT and half-pel prediction are replaced by bit-exact SSE2 or
+# NEON versions in src/dct_simd.cpp and src/motion_comp_simd.cpp.
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DM4VH263ENC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DM4VH263ENC_NEON
+endif
+
 LOCAL_C_INCLUDES := \
     $(LOCAL_PATH)/src \
     $(LOCAL_PATH)/include \
@@ -73,3 +86,37 @@ LOCAL_MODULE := libstagefright_soft_mpeg4enc
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
+
+################################################################################
+# test utility: compares the SSE2/NEON DCT, IDCT and motion compensation
+# kernels with the C versions
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        test/dct_test.cpp
+
+LOCAL_C_INCLUDES := \
+        $(LOCAL_PATH)/src \
+        $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := \
+    -DBX_RC \
+    -DOSCL_IMPORT_REF= -DOSCL_UNUSED_ARG= -DOSCL_EXPORT_REF=
+
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DM4VH263ENC_SSE2
+endif
+
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+    LOCAL_CFLAGS += -DM4VH263ENC_NEON
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+        libstagefright_m4vh263enc
+
+LOCAL_MODULE := m4vh263enc_dct_test
+LOCAL_MODULE_TAGS := debug
+
+include $(BUILD_EXECUTABLE)
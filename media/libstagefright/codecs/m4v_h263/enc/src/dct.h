@@ -184,6 +184,18 @@ extern "C"
     Void Block4x4DCT_AANIntra(Short *out, UChar *cur, UChar *dummy1, Int pitch_chroma);
     Void Block2x2DCT_AANIntra(Short *out, UChar *cur, UChar *dummy1, Int pitch_chroma);
 
+    /* This part is in dct_simd.c, the same as BlockDCT_AANwSub, BlockDCT_AANIntra
+       and BlockIDCTMotionComp with all the columns */
+#if defined(M4VH263ENC_SSE2)
+    Void BlockDCT_AANwSub_SSE2(Short *out, UChar *cur, UChar *prev, Int pitch_chroma);
+    Void BlockDCT_AANIntra_SSE2(Short *out, UChar *cur, UChar *dummy1, Int pitch_chroma);
+    void BlockIDCT8x8MotionComp_SSE2(Short *block, UChar *rec, UChar *prev, Int lx_intra);
+#elif defined(M4VH263ENC_NEON)
+    Void BlockDCT_AANwSub_NEON(Short *out, UChar *cur, UChar *prev, Int pitch_chroma);
+    Void BlockDCT_AANIntra_NEON(Short *out, UChar *cur, UChar *dummy1, Int pitch_chroma);
+    void BlockIDCT8x8MotionComp_NEON(Short *block, UChar *rec, UChar *prev, Int lx_intra);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,808 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+#include "mp4def.h"
+#include "mp4enc_lib.h"
+#include "mp4lib_int.h"
+#include "dct.h"
+
+#if defined(M4VH263ENC_SSE2)
+#include <emmintrin.h>
+#elif defined(M4VH263ENC_NEON)
+#include <arm_neon.h>
+#endif
+
+/* consist of
+Void BlockDCT_AANwSub_SSE2(Short *out, UChar *cur, UChar *pred, Int width)
+Void BlockDCT_AANIntra_SSE2(Short *out, UChar *cur, UChar *dummy2, Int width)
+void BlockIDCT8x8MotionComp_SSE2(Short *block, UChar *rec, UChar *pred, Int lx_intra)
+and the NEON versions of the same.
+
+The forward DCTs give exactly what BlockDCT_AANwSub() and BlockDCT_AANIntra()
+of dct.cpp give, in out[64..127] with the column threshold read from out[64].
+A column below the threshold keeps its row results and gets 0x7fff in its
+first row. The row pass is done on 16-bit lanes: its inputs are at most
+2 * 255 and the operands of the multiplications stay within 16 bits, the
+additions after them wrap like the Short stores of the C version. The
+column pass needs 32 bits. The two multiplications of a rotation are merged,
+    554 * k4 + (392 * (k4 - k6) + round) = 946 * k4 - 392 * k6 + round
+    1338 * k6 + (392 * (k4 - k6) + round) = 392 * k4 + 946 * k6 + round
+
+The IDCT is the one of BlockIDCTMotionComp() in fastidct.cpp for a block
+with any coefficients: idct_col() on the columns, then idct_rowIntra() or
+idct_rowzmv() on the rows, with the same integer operations. It clears the
+block. rec has a pitch of lx_intra >> 1, pred a pitch of 16, and the
+prediction is not added for intra blocks (lx_intra & 1).
+*/
+
+#define FDCT_SHIFT  10
+
+#if defined(M4VH263ENC_SSE2)
+
+/* a pair of 16-bit constants for _mm_madd_epi16 */
+#define PAIR(a, b)  _mm_set_epi16((b), (a), (b), (a), (b), (a), (b), (a))
+
+static inline void transpose8x8(__m128i *v)
+{
+    __m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+    __m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+    __m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+    __m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+    __m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+    __m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+    __m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+    __m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    v[0] = _mm_unpacklo_epi64(b0, b4);
+    v[1] = _mm_unpackhi_epi64(b0, b4);
+    v[2] = _mm_unpacklo_epi64(b1, b5);
+    v[3] = _mm_unpackhi_epi64(b1, b5);
+    v[4] = _mm_unpacklo_epi64(b2, b6);
+    v[5] = _mm_unpackhi_epi64(b2, b6);
+    v[6] = _mm_unpacklo_epi64(b3, b7);
+    v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/* the low 32 bits of a * b, SSE2 has no 32-bit multiply */
+static inline __m128i mul32(__m128i a, Int b)
+{
+    const __m128i k = _mm_set1_epi32(b);
+    __m128i even = _mm_mul_epu32(a, k);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), k);
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/* (a * ka + b * kb + round) >> FDCT_SHIFT on 16-bit lanes, k = PAIR(ka, kb) */
+static inline __m128i fdct_mul16(__m128i a, __m128i b, __m128i k)
+{
+    const __m128i round = _mm_set1_epi32(1 << (FDCT_SHIFT - 1));
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), k);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), k);
+
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, round), FDCT_SHIFT);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, round), FDCT_SHIFT);
+    return _mm_packs_epi32(lo, hi);
+}
+
+/* the row pass, x[k] holds the k-th pixel of the eight rows */
+static inline void fdct_rows(__m128i *x)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i k0, k1, k2, k3, k4, k5, k6, k7;
+
+    /* fdct_1 */
+    k0 = _mm_add_epi16(x[0], x[7]);
+    k7 = _mm_sub_epi16(x[0], x[7]);
+    k1 = _mm_add_epi16(x[1], x[6]);
+    k6 = _mm_sub_epi16(x[1], x[6]);
+    k2 = _mm_add_epi16(x[2], x[5]);
+    k5 = _mm_sub_epi16(x[2], x[5]);
+    k3 = _mm_add_epi16(x[3], x[4]);
+    k4 = _mm_sub_epi16(x[3], x[4]);
+
+    x[0] = _mm_add_epi16(k0, k3);
+    k3 = _mm_sub_epi16(k0, k3);
+    x[4] = _mm_add_epi16(k1, k2);
+    k2 = _mm_sub_epi16(k1, k2);
+
+    k0 = x[0];
+    x[0] = _mm_add_epi16(k0, x[4]);
+    x[4] = _mm_sub_epi16(k0, x[4]);
+
+    /* fdct_2 */
+    k4 = _mm_add_epi16(k4, k5);
+    k5 = _mm_add_epi16(k5, k6);
+    k6 = _mm_add_epi16(k6, k7);
+    k2 = _mm_add_epi16(k2, k3);
+    k5 = fdct_mul16(k5, zero, PAIR(724, 0));
+    k2 = fdct_mul16(k2, zero, PAIR(724, 0));
+    k2 = _mm_add_epi16(k2, k3);
+    k3 = _mm_sub_epi16(_mm_slli_epi16(k3, 1), k2);
+    x[2] = k2;
+    x[6] = _mm_slli_epi16(k3, 1);
+
+    /* fdct_3 */
+    k0 = fdct_mul16(k4, k6, PAIR(946, -392));
+    k1 = fdct_mul16(k4, k6, PAIR(392, 946));
+    k5 = _mm_add_epi16(k5, k7);
+    k7 = _mm_sub_epi16(_mm_slli_epi16(k7, 1), k5);
+    k4 = _mm_add_epi16(k0, k7);
+    k7 = _mm_sub_epi16(_mm_slli_epi16(k7, 1), k4);
+    k5 = _mm_add_epi16(k5, k1);
+    k6 = _mm_sub_epi16(k5, _mm_slli_epi16(k1, 1));
+    x[1] = k5;
+    x[3] = k7;
+    x[5] = _mm_slli_epi16(k4, 1);
+    x[7] = _mm_slli_epi16(k6, 2);
+}
+
+/* the column pass on v[0..7], the rows of the block, into out */
+static inline void fdct_cols(__m128i *v, Short *out, Int ColTh)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (FDCT_SHIFT - 1));
+    const __m128i th = _mm_set1_epi32(ColTh);
+    const __m128i skip = _mm_set1_epi32(0x7fff);
+    __m128i res[2][8];
+    __m128i x[8], d[8];
+    __m128i k0, k1, k2, k3, k4, k5, k6, k7, s, abs_sum, mask;
+    Int h, i;
+
+    for (h = 0; h < 2; h++)
+    {
+        for (i = 0; i < 8; i++)
+        {
+            if (h == 0)
+                x[i] = _mm_srai_epi32(_mm_unpacklo_epi16(zero, v[i]), 16);
+            else
+                x[i] = _mm_srai_epi32(_mm_unpackhi_epi16(zero, v[i]), 16);
+        }
+
+        /* deadzone thresholding for column, like sum_abs() the first
+           term is k0 ^ (k0 >> 31) */
+        abs_sum = _mm_xor_si128(x[0], _mm_srai_epi32(x[0], 31));
+        for (i = 1; i < 8; i++)
+        {
+            s = _mm_srai_epi32(x[i], 31);
+            abs_sum = _mm_add_epi32(abs_sum, _mm_sub_epi32(_mm_xor_si128(x[i], s), s));
+        }
+        mask = _mm_cmplt_epi32(abs_sum, th);
+
+        /* fdct_1 */
+        k0 = _mm_add_epi32(x[0], x[7]);
+        k7 = _mm_sub_epi32(x[0], x[7]);
+        k1 = _mm_add_epi32(x[1], x[6]);
+        k6 = _mm_sub_epi32(x[1], x[6]);
+        k2 = _mm_add_epi32(x[2], x[5]);
+        k5 = _mm_sub_epi32(x[2], x[5]);
+        k3 = _mm_add_epi32(x[3], x[4]);
+        k4 = _mm_sub_epi32(x[3], x[4]);
+
+        d[0] = _mm_add_epi32(k0, k3);
+        k3 = _mm_sub_epi32(k0, k3);
+        d[4] = _mm_add_epi32(k1, k2);
+        k2 = _mm_sub_epi32(k1, k2);
+
+        k0 = d[0];
+        d[0] = _mm_add_epi32(k0, d[4]);
+        d[4] = _mm_sub_epi32(k0, d[4]);
+
+        /* fdct_2 */
+        k4 = _mm_add_epi32(k4, k5);
+        k5 = _mm_add_epi32(k5, k6);
+        k6 = _mm_add_epi32(k6, k7);
+        k2 = _mm_add_epi32(k2, k3);
+        k5 = _mm_srai_epi32(_mm_add_epi32(mul32(k5, 724), round), FDCT_SHIFT);
+        k2 = _mm_srai_epi32(_mm_add_epi32(mul32(k2, 724), round), FDCT_SHIFT);
+        k2 = _mm_add_epi32(k2, k3);
+        k3 = _mm_sub_epi32(_mm_slli_epi32(k3, 1), k2);
+        d[2] = k2;
+        d[6] = _mm_slli_epi32(k3, 1);
+
+        /* fdct_3 */
+        k0 = _mm_sub_epi32(mul32(k4, 946), mul32(k6, 392));
+        k1 = _mm_add_epi32(mul32(k4, 392), mul32(k6, 946));
+        k0 = _mm_srai_epi32(_mm_add_epi32(k0, round), FDCT_SHIFT);
+        k1 = _mm_srai_epi32(_mm_add_epi32(k1, round), FDCT_SHIFT);
+        k5 = _mm_add_epi32(k5, k7);
+        k7 = _mm_sub_epi32(_mm_slli_epi32(k7, 1), k5);
+        k4 = _mm_add_epi32(k0, k7);
+        k7 = _mm_sub_epi32(_mm_slli_epi32(k7, 1), k4);
+        k5 = _mm_add_epi32(k5, k1);
+        k6 = _mm_sub_epi32(k5, _mm_slli_epi32(k1, 1));
+        d[1] = k5;
+        d[3] = k7;
+        d[5] = _mm_slli_epi32(k4, 1);
+        d[7] = _mm_slli_epi32(k6, 2);
+
+        /* the skipped columns keep the row results */
+        x[0] = skip;
+        for (i = 0; i < 8; i++)
+        {
+            res[h][i] = _mm_or_si128(_mm_and_si128(mask, x[i]), _mm_andnot_si128(mask, d[i]));
+            /* truncated to 16 bits like the Short stores */
+            res[h][i] = _mm_srai_epi32(_mm_slli_epi32(res[h][i], 16), 16);
+        }
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        _mm_storeu_si128((__m128i*)(out + (i << 3)), _mm_packs_epi32(res[0][i], res[1][i]));
+    }
+}
+
+Void BlockDCT_AANwSub_SSE2(Short *out, UChar *cur, UChar *pred, Int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v[8], c, p;
+    Int ColTh = out[64];
+    Int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        c = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)cur), zero);
+        p = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)pred), zero);
+        v[i] = _mm_slli_epi16(_mm_sub_epi16(c, p), 1);
+        cur += width;
+        pred += 16;
+    }
+
+    transpose8x8(v);
+    fdct_rows(v);
+    transpose8x8(v);
+    fdct_cols(v, out + 64, ColTh);
+}
+
+Void BlockDCT_AANIntra_SSE2(Short *out, UChar *cur, UChar *dummy2, Int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v[8];
+    Int ColTh = out[64];
+    Int i;
+
+    OSCL_UNUSED_ARG(dummy2);
+
+    for (i = 0; i < 8; i++)
+    {
+        v[i] = _mm_slli_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)cur), zero), 1);
+        cur += width;
+    }
+
+    transpose8x8(v);
+    fdct_rows(v);
+    transpose8x8(v);
+    fdct_cols(v, out + 64, ColTh);
+}
+
+static inline __m128i mul181(__m128i x)
+{
+    /* 181 = 128 + 32 + 16 + 4 + 1 */
+    __m128i y = _mm_add_epi32(_mm_slli_epi32(x, 7), _mm_slli_epi32(x, 5));
+
+    y = _mm_add_epi32(y, _mm_slli_epi32(x, 4));
+    y = _mm_add_epi32(y, _mm_slli_epi32(x, 2));
+    return _mm_add_epi32(y, x);
+}
+
+/* one IDCT pass on v[0..7], each lane is a column (row == 0) or a row (row == 1) */
+static inline void idct_pass(__m128i *v, Int row)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w1_w7 = PAIR(W1, W7);
+    const __m128i w7_mw1 = PAIR(W7, -W1);
+    const __m128i w5_w3 = PAIR(W5, W3);
+    const __m128i w3_mw5 = PAIR(W3, -W5);
+    const __m128i w6_mw2 = PAIR(W6, -W2);
+    const __m128i w2_w6 = PAIR(W2, W6);
+    const __m128i four = _mm_set1_epi32(4);
+    const __m128i rnd0 = _mm_set1_epi32(row ? 8192 : 128);
+    const __m128i rnd181 = _mm_set1_epi32(128);
+    __m128i out[2][8];
+    __m128i p17, p53, p26, x0, x1, x2, x3, x4, x5, x6, x7, x8;
+    Int h;
+
+    for (h = 0; h < 2; h++)
+    {
+        if (h == 0)
+        {
+            p17 = _mm_unpacklo_epi16(v[1], v[7]);
+            p53 = _mm_unpacklo_epi16(v[5], v[3]);
+            p26 = _mm_unpacklo_epi16(v[2], v[6]);
+            x0 = _mm_unpacklo_epi16(zero, v[0]);
+            x1 = _mm_unpacklo_epi16(zero, v[4]);
+        }
+        else
+        {
+            p17 = _mm_unpackhi_epi16(v[1], v[7]);
+            p53 = _mm_unpackhi_epi16(v[5], v[3]);
+            p26 = _mm_unpackhi_epi16(v[2], v[6]);
+            x0 = _mm_unpackhi_epi16(zero, v[0]);
+            x1 = _mm_unpackhi_epi16(zero, v[4]);
+        }
+
+        /* first stage */
+        x4 = _mm_madd_epi16(p17, w1_w7);
+        x5 = _mm_madd_epi16(p17, w7_mw1);
+        x6 = _mm_madd_epi16(p53, w5_w3);
+        x7 = _mm_madd_epi16(p53, w3_mw5);
+        x2 = _mm_madd_epi16(p26, w6_mw2);
+        x3 = _mm_madd_epi16(p26, w2_w6);
+
+        if (row)
+        {
+            x4 = _mm_srai_epi32(_mm_add_epi32(x4, four), 3);
+            x5 = _mm_srai_epi32(_mm_add_epi32(x5, four), 3);
+            x6 = _mm_srai_epi32(_mm_add_epi32(x6, four), 3);
+            x7 = _mm_srai_epi32(_mm_add_epi32(x7, four), 3);
+            x2 = _mm_srai_epi32(_mm_add_epi32(x2, four), 3);
+            x3 = _mm_srai_epi32(_mm_add_epi32(x3, four), 3);
+
+            /* blk[0] << 8 and blk[4] << 8 */
+            x0 = _mm_srai_epi32(x0, 8);
+            x1 = _mm_srai_epi32(x1, 8);
+        }
+        else
+        {
+            /* blk[0] << 11 and blk[32] << 11 */
+            x0 = _mm_srai_epi32(x0, 5);
+            x1 = _mm_srai_epi32(x1, 5);
+        }
+        x0 = _mm_add_epi32(x0, rnd0);
+
+        /* second stage */
+        x8 = _mm_add_epi32(x0, x1);
+        x0 = _mm_sub_epi32(x0, x1);
+        x1 = _mm_add_epi32(x4, x6);
+        x4 = _mm_sub_epi32(x4, x6);
+        x6 = _mm_add_epi32(x5, x7);
+        x5 = _mm_sub_epi32(x5, x7);
+
+        /* third stage */
+        x7 = _mm_add_epi32(x8, x3);
+        x8 = _mm_sub_epi32(x8, x3);
+        x3 = _mm_add_epi32(x0, x2);
+        x0 = _mm_sub_epi32(x0, x2);
+        x2 = _mm_srai_epi32(_mm_add_epi32(mul181(_mm_add_epi32(x4, x5)), rnd181), 8);
+        x4 = _mm_srai_epi32(_mm_add_epi32(mul181(_mm_sub_epi32(x4, x5)), rnd181), 8);
+
+        /* fourth stage */
+        out[h][0] = _mm_add_epi32(x7, x1);
+        out[h][1] = _mm_add_epi32(x3, x2);
+        out[h][2] = _mm_add_epi32(x0, x4);
+        out[h][3] = _mm_add_epi32(x8, x6);
+        out[h][4] = _mm_sub_epi32(x8, x6);
+        out[h][5] = _mm_sub_epi32(x0, x4);
+        out[h][6] = _mm_sub_epi32(x3, x2);
+        out[h][7] = _mm_sub_epi32(x7, x1);
+    }
+
+    for (h = 0; h < 8; h++)
+    {
+        if (row)
+        {
+            /* saturated, the clipping to 8 bits that follows gives the same */
+            v[h] = _mm_packs_epi32(_mm_srai_epi32(out[0][h], 14),
+                                   _mm_srai_epi32(out[1][h], 14));
+        }
+        else
+        {
+            /* truncated to 16 bits like the Short store of idct_col() */
+            x0 = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(out[0][h], 8), 16), 16);
+            x1 = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(out[1][h], 8), 16), 16);
+            v[h] = _mm_packs_epi32(x0, x1);
+        }
+    }
+}
+
+void BlockIDCT8x8MotionComp_SSE2(Short *block, UChar *rec, UChar *pred, Int lx_intra)
+{
+    const __m128i zero = _mm_setzero_si128();
+    Int lx = lx_intra >> 1;
+    Int intra = (lx_intra & 1);
+    __m128i v[8], p;
+    Int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        v[i] = _mm_loadu_si128((__m128i*)(block + (i << 3)));
+        _mm_storeu_si128((__m128i*)(block + (i << 3)), zero);
+    }
+
+    idct_pass(v, 0);
+    transpose8x8(v);
+    idct_pass(v, 1);
+    transpose8x8(v);
+
+    for (i = 0; i < 8; i++)
+    {
+        if (!intra)
+        {
+            p = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)pred), zero);
+            v[i] = _mm_adds_epi16(v[i], p);
+            pred += 16;
+        }
+        _mm_storel_epi64((__m128i*)rec, _mm_packus_epi16(v[i], v[i]));
+        rec += lx;
+    }
+}
+
+#elif defined(M4VH263ENC_NEON)
+
+static inline void transpose8x8(int16x8_t *v)
+{
+    int16x8x2_t t0 = vtrnq_s16(v[0], v[1]);
+    int16x8x2_t t1 = vtrnq_s16(v[2], v[3]);
+    int16x8x2_t t2 = vtrnq_s16(v[4], v[5]);
+    int16x8x2_t t3 = vtrnq_s16(v[6], v[7]);
+    int32x4x2_t u0 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[0]), vreinterpretq_s32_s16(t1.val[0]));
+    int32x4x2_t u1 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[1]), vreinterpretq_s32_s16(t1.val[1]));
+    int32x4x2_t u2 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[0]), vreinterpretq_s32_s16(t3.val[0]));
+    int32x4x2_t u3 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[1]), vreinterpretq_s32_s16(t3.val[1]));
+
+    v[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[0]), vget_low_s32(u2.val[0])));
+    v[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[0]), vget_low_s32(u3.val[0])));
+    v[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[1]), vget_low_s32(u2.val[1])));
+    v[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[1]), vget_low_s32(u3.val[1])));
+    v[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[0]), vget_high_s32(u2.val[0])));
+    v[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[0]), vget_high_s32(u3.val[0])));
+    v[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[1]), vget_high_s32(u2.val[1])));
+    v[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[1]), vget_high_s32(u3.val[1])));
+}
+
+/* (a * 724 + round) >> FDCT_SHIFT on 16-bit lanes */
+static inline int16x8_t fdct_mul724(int16x8_t a)
+{
+    /* vrshrn is (x + round) >> FDCT_SHIFT */
+    return vcombine_s16(vrshrn_n_s32(vmull_n_s16(vget_low_s16(a), 724), FDCT_SHIFT),
+                        vrshrn_n_s32(vmull_n_s16(vget_high_s16(a), 724), FDCT_SHIFT));
+}
+
+/* (a * ka + b * kb + round) >> FDCT_SHIFT on 16-bit lanes */
+static inline int16x8_t fdct_mul16(int16x8_t a, int16x8_t b, int16 ka, int16 kb)
+{
+    int32x4_t lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(a), ka), vget_low_s16(b), kb);
+    int32x4_t hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(a), ka), vget_high_s16(b), kb);
+
+    return vcombine_s16(vrshrn_n_s32(lo, FDCT_SHIFT), vrshrn_n_s32(hi, FDCT_SHIFT));
+}
+
+/* the row pass, x[k] holds the k-th pixel of the eight rows */
+static inline void fdct_rows(int16x8_t *x)
+{
+    int16x8_t k0, k1, k2, k3, k4, k5, k6, k7;
+
+    /* fdct_1 */
+    k0 = vaddq_s16(x[0], x[7]);
+    k7 = vsubq_s16(x[0], x[7]);
+    k1 = vaddq_s16(x[1], x[6]);
+    k6 = vsubq_s16(x[1], x[6]);
+    k2 = vaddq_s16(x[2], x[5]);
+    k5 = vsubq_s16(x[2], x[5]);
+    k3 = vaddq_s16(x[3], x[4]);
+    k4 = vsubq_s16(x[3], x[4]);
+
+    x[0] = vaddq_s16(k0, k3);
+    k3 = vsubq_s16(k0, k3);
+    x[4] = vaddq_s16(k1, k2);
+    k2 = vsubq_s16(k1, k2);
+
+    k0 = x[0];
+    x[0] = vaddq_s16(k0, x[4]);
+    x[4] = vsubq_s16(k0, x[4]);
+
+    /* fdct_2 */
+    k4 = vaddq_s16(k4, k5);
+    k5 = vaddq_s16(k5, k6);
+    k6 = vaddq_s16(k6, k7);
+    k2 = vaddq_s16(k2, k3);
+    k5 = fdct_mul724(k5);
+    k2 = fdct_mul724(k2);
+    k2 = vaddq_s16(k2, k3);
+    k3 = vsubq_s16(vshlq_n_s16(k3, 1), k2);
+    x[2] = k2;
+    x[6] = vshlq_n_s16(k3, 1);
+
+    /* fdct_3 */
+    k0 = fdct_mul16(k4, k6, 946, -392);
+    k1 = fdct_mul16(k4, k6, 392, 946);
+    k5 = vaddq_s16(k5, k7);
+    k7 = vsubq_s16(vshlq_n_s16(k7, 1), k5);
+    k4 = vaddq_s16(k0, k7);
+    k7 = vsubq_s16(vshlq_n_s16(k7, 1), k4);
+    k5 = vaddq_s16(k5, k1);
+    k6 = vsubq_s16(k5, vshlq_n_s16(k1, 1));
+    x[1] = k5;
+    x[3] = k7;
+    x[5] = vshlq_n_s16(k4, 1);
+    x[7] = vshlq_n_s16(k6, 2);
+}
+
+/* the column pass on v[0..7], the rows of the block, into out */
+static inline void fdct_cols(int16x8_t *v, Short *out, Int ColTh)
+{
+    const int32x4_t th = vdupq_n_s32(ColTh);
+    const int32x4_t skip = vdupq_n_s32(0x7fff);
+    int16x4_t res[2][8];
+    int32x4_t x[8], d[8];
+    int32x4_t k0, k1, k2, k3, k4, k5, k6, k7, abs_sum;
+    uint32x4_t mask;
+    Int h, i;
+
+    for (h = 0; h < 2; h++)
+    {
+        for (i = 0; i < 8; i++)
+        {
+            x[i] = vmovl_s16(h == 0 ? vget_low_s16(v[i]) : vget_high_s16(v[i]));
+        }
+
+        /* deadzone thresholding for column, like sum_abs() the first
+           term is k0 ^ (k0 >> 31) */
+        abs_sum = veorq_s32(x[0], vshrq_n_s32(x[0], 31));
+        for (i = 1; i < 8; i++)
+        {
+            abs_sum = vaddq_s32(abs_sum, vabsq_s32(x[i]));
+        }
+        mask = vcltq_s32(abs_sum, th);
+
+        /* fdct_1 */
+        k0 = vaddq_s32(x[0], x[7]);
+        k7 = vsubq_s32(x[0], x[7]);
+        k1 = vaddq_s32(x[1], x[6]);
+        k6 = vsubq_s32(x[1], x[6]);
+        k2 = vaddq_s32(x[2], x[5]);
+        k5 = vsubq_s32(x[2], x[5]);
+        k3 = vaddq_s32(x[3], x[4]);
+        k4 = vsubq_s32(x[3], x[4]);
+
+        d[0] = vaddq_s32(k0, k3);
+        k3 = vsubq_s32(k0, k3);
+        d[4] = vaddq_s32(k1, k2);
+        k2 = vsubq_s32(k1, k2);
+
+        k0 = d[0];
+        d[0] = vaddq_s32(k0, d[4]);
+        d[4] = vsubq_s32(k0, d[4]);
+
+        /* fdct_2, vrshr is (x + round) >> FDCT_SHIFT */
+        k4 = vaddq_s32(k4, k5);
+        k5 = vaddq_s32(k5, k6);
+        k6 = vaddq_s32(k6, k7);
+        k2 = vaddq_s32(k2, k3);
+        k5 = vrshrq_n_s32(vmulq_n_s32(k5, 724), FDCT_SHIFT);
+        k2 = vrshrq_n_s32(vmulq_n_s32(k2, 724), FDCT_SHIFT);
+        k2 = vaddq_s32(k2, k3);
+        k3 = vsubq_s32(vshlq_n_s32(k3, 1), k2);
+        d[2] = k2;
+        d[6] = vshlq_n_s32(k3, 1);
+
+        /* fdct_3 */
+        k0 = vrshrq_n_s32(vmlsq_n_s32(vmulq_n_s32(k4, 946), k6, 392), FDCT_SHIFT);
+        k1 = vrshrq_n_s32(vmlaq_n_s32(vmulq_n_s32(k4, 392), k6, 946), FDCT_SHIFT);
+        k5 = vaddq_s32(k5, k7);
+        k7 = vsubq_s32(vshlq_n_s32(k7, 1), k5);
+        k4 = vaddq_s32(k0, k7);
+        k7 = vsubq_s32(vshlq_n_s32(k7, 1), k4);
+        k5 = vaddq_s32(k5, k1);
+        k6 = vsubq_s32(k5, vshlq_n_s32(k1, 1));
+        d[1] = k5;
+        d[3] = k7;
+        d[5] = vshlq_n_s32(k4, 1);
+        d[7] = vshlq_n_s32(k6, 2);
+
+        /* the skipped columns keep the row results */
+        x[0] = skip;
+        for (i = 0; i < 8; i++)
+        {
+            /* truncated to 16 bits like the Short stores */
+            res[h][i] = vmovn_s32(vbslq_s32(mask, x[i], d[i]));
+        }
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        vst1q_s16(out + (i << 3), vcombine_s16(res[0][i], res[1][i]));
+    }
+}
+
+Void BlockDCT_AANwSub_NEON(Short *out, UChar *cur, UChar *pred, Int width)
+{
+    int16x8_t v[8], c, p;
+    Int ColTh = out[64];
+    Int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        c = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cur)));
+        p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(pred)));
+        v[i] = vshlq_n_s16(vsubq_s16(c, p), 1);
+        cur += width;
+        pred += 16;
+    }
+
+    transpose8x8(v);
+    fdct_rows(v);
+    transpose8x8(v);
+    fdct_cols(v, out + 64, ColTh);
+}
+
+Void BlockDCT_AANIntra_NEON(Short *out, UChar *cur, UChar *dummy2, Int width)
+{
+    int16x8_t v[8];
+    Int ColTh = out[64];
+    Int i;
+
+    OSCL_UNUSED_ARG(dummy2);
+
+    for (i = 0; i < 8; i++)
+    {
+        v[i] = vreinterpretq_s16_u16(vshll_n_u8(vld1_u8(cur), 1));
+        cur += width;
+    }
+
+    transpose8x8(v);
+    fdct_rows(v);
+    transpose8x8(v);
+    fdct_cols(v, out + 64, ColTh);
+}
+
+/* one IDCT pass on v[0..7], each lane is a column (row == 0) or a row (row == 1) */
+static inline void idct_pass(int16x8_t *v, Int row)
+{
+    const int32x4_t four = vdupq_n_s32(4);
+    const int32x4_t rnd0 = vdupq_n_s32(row ? 8192 : 128);
+    const int32x4_t rnd181 = vdupq_n_s32(128);
+    int32x4_t out[2][8];
+    int16x4_t r0, r1, r2, r3, r4, r5, r6, r7;
+    int32x4_t x0, x1, x2, x3, x4, x5, x6, x7, x8;
+    Int h;
+
+    for (h = 0; h < 2; h++)
+    {
+        if (h == 0)
+        {
+            r0 = vget_low_s16(v[0]);
+            r1 = vget_low_s16(v[1]);
+            r2 = vget_low_s16(v[2]);
+            r3 = vget_low_s16(v[3]);
+            r4 = vget_low_s16(v[4]);
+            r5 = vget_low_s16(v[5]);
+            r6 = vget_low_s16(v[6]);
+            r7 = vget_low_s16(v[7]);
+        }
+        else
+        {
+            r0 = vget_high_s16(v[0]);
+            r1 = vget_high_s16(v[1]);
+            r2 = vget_high_s16(v[2]);
+            r3 = vget_high_s16(v[3]);
+            r4 = vget_high_s16(v[4]);
+            r5 = vget_high_s16(v[5]);
+            r6 = vget_high_s16(v[6]);
+            r7 = vget_high_s16(v[7]);
+        }
+
+        /* first stage */
+        x4 = vmlal_n_s16(vmull_n_s16(r1, W1), r7, W7);
+        x5 = vmlsl_n_s16(vmull_n_s16(r1, W7), r7, W1);
+        x6 = vmlal_n_s16(vmull_n_s16(r5, W5), r3, W3);
+        x7 = vmlsl_n_s16(vmull_n_s16(r5, W3), r3, W5);
+        x2 = vmlsl_n_s16(vmull_n_s16(r2, W6), r6, W2);
+        x3 = vmlal_n_s16(vmull_n_s16(r2, W2), r6, W6);
+
+        if (row)
+        {
+            x4 = vshrq_n_s32(vaddq_s32(x4, four), 3);
+            x5 = vshrq_n_s32(vaddq_s32(x5, four), 3);
+            x6 = vshrq_n_s32(vaddq_s32(x6, four), 3);
+            x7 = vshrq_n_s32(vaddq_s32(x7, four), 3);
+            x2 = vshrq_n_s32(vaddq_s32(x2, four), 3);
+            x3 = vshrq_n_s32(vaddq_s32(x3, four), 3);
+            x0 = vshll_n_s16(r0, 8);
+            x1 = vshll_n_s16(r4, 8);
+        }
+        else
+        {
+            x0 = vshll_n_s16(r0, 11);
+            x1 = vshll_n_s16(r4, 11);
+        }
+        x0 = vaddq_s32(x0, rnd0);
+
+        /* second stage */
+        x8 = vaddq_s32(x0, x1);
+        x0 = vsubq_s32(x0, x1);
+        x1 = vaddq_s32(x4, x6);
+        x4 = vsubq_s32(x4, x6);
+        x6 = vaddq_s32(x5, x7);
+        x5 = vsubq_s32(x5, x7);
+
+        /* third stage */
+        x7 = vaddq_s32(x8, x3);
+        x8 = vsubq_s32(x8, x3);
+        x3 = vaddq_s32(x0, x2);
+        x0 = vsubq_s32(x0, x2);
+        x2 = vshrq_n_s32(vmlaq_n_s32(rnd181, vaddq_s32(x4, x5), 181), 8);
+        x4 = vshrq_n_s32(vmlaq_n_s32(rnd181, vsubq_s32(x4, x5), 181), 8);
+
+        /* fourth stage */
+        out[h][0] = vaddq_s32(x7, x1);
+        out[h][1] = vaddq_s32(x3, x2);
+        out[h][2] = vaddq_s32(x0, x4);
+        out[h][3] = vaddq_s32(x8, x6);
+        out[h][4] = vsubq_s32(x8, x6);
+        out[h][5] = vsubq_s32(x0, x4);
+        out[h][6] = vsubq_s32(x3, x2);
+        out[h][7] = vsubq_s32(x7, x1);
+    }
+
+    for (h = 0; h < 8; h++)
+    {
+        if (row)
+        {
+            /* saturated, the clipping to 8 bits that follows gives the same */
+            v[h] = vcombine_s16(vqshrn_n_s32(out[0][h], 14), vqshrn_n_s32(out[1][h], 14));
+        }
+        else
+        {
+            /* truncated to 16 bits like the Short store of idct_col() */
+            v[h] = vcombine_s16(vshrn_n_s32(out[0][h], 8), vshrn_n_s32(out[1][h], 8));
+        }
+    }
+}
+
+void BlockIDCT8x8MotionComp_NEON(Short *block, UChar *rec, UChar *pred, Int lx_intra)
+{
+    const int16x8_t zero = vdupq_n_s16(0);
+    Int lx = lx_intra >> 1;
+    Int intra = (lx_intra & 1);
+    int16x8_t v[8], p;
+    Int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        v[i] = vld1q_s16(block + (i << 3));
+        vst1q_s16(block + (i << 3), zero);
+    }
+
+    idct_pass(v, 0);
+    transpose8x8(v);
+    idct_pass(v, 1);
+    transpose8x8(v);
+
+    for (i = 0; i < 8; i++)
+    {
+        if (!intra)
+        {
+            p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(pred)));
+            v[i] = vqaddq_s16(v[i], p);
+            pred += 16;
+        }
+        vst1_u8(rec, vqmovun_s16(v[i]));
+        rec += lx;
+    }
+}
+
+#endif
@@ -99,7 +99,13 @@ PV_STATUS CodeMB_H263(VideoEncData *video, approxDCT *function, Int QP, Int ncoe
         BlockDCT1x1 = &Block1x1DCTIntra;
         BlockDCT2x2 = &Block2x2DCT_AANIntra;
         BlockDCT4x4 = &Block4x4DCT_AANIntra;
+#if defined(M4VH263ENC_SSE2)
+        BlockDCT8x8 = &BlockDCT_AANIntra_SSE2;
+#elif defined(M4VH263ENC_NEON)
+        BlockDCT8x8 = &BlockDCT_AANIntra_NEON;
+#else
         BlockDCT8x8 = &BlockDCT_AANIntra;
+#endif
         BlockQuantDequantH263 = &BlockQuantDequantH263Intra;
         BlockQuantDequantH263DC = &BlockQuantDequantH263DCIntra;
         if (shortHeader)
@@ -118,7 +124,13 @@ PV_STATUS CodeMB_H263(VideoEncData *video, approxDCT *function, Int QP, Int ncoe
         BlockDCT1x1 = &Block1x1DCTwSub;
         BlockDCT2x2 = &Block2x2DCT_AANwSub;
         BlockDCT4x4 = &Block4x4DCT_AANwSub;
+#if defined(M4VH263ENC_SSE2)
+        BlockDCT8x8 = &BlockDCT_AANwSub_SSE2;
+#elif defined(M4VH263ENC_NEON)
+        BlockDCT8x8 = &BlockDCT_AANwSub_NEON;
+#else
         BlockDCT8x8 = &BlockDCT_AANwSub;
+#endif
 
         BlockQuantDequantH263 = &BlockQuantDequantH263Inter;
         BlockQuantDequantH263DC = &BlockQuantDequantH263DCInter;
@@ -324,7 +336,13 @@ PV_STATUS CodeMB_MPEG(VideoEncData *video, approxDCT *function, Int QP, Int ncoe
         BlockDCT1x1 = &Block1x1DCTIntra;
         BlockDCT2x2 = &Block2x2DCT_AANIntra;
         BlockDCT4x4 = &Block4x4DCT_AANIntra;
+#if defined(M4VH263ENC_SSE2)
+        BlockDCT8x8 = &BlockDCT_AANIntra_SSE2;
+#elif defined(M4VH263ENC_NEON)
+        BlockDCT8x8 = &BlockDCT_AANIntra_NEON;
+#else
         BlockDCT8x8 = &BlockDCT_AANIntra;
+#endif
 
         BlockQuantDequantMPEG = &BlockQuantDequantMPEGIntra;
         BlockQuantDequantMPEGDC = &BlockQuantDequantMPEGDCIntra;
@@ -341,7 +359,13 @@ PV_STATUS CodeMB_MPEG(VideoEncData *video, approxDCT *function, Int QP, Int ncoe
         BlockDCT1x1 = &Block1x1DCTwSub;
         BlockDCT2x2 = &Block2x2DCT_AANwSub;
         BlockDCT4x4 = &Block4x4DCT_AANwSub;
+#if defined(M4VH263ENC_SSE2)
+        BlockDCT8x8 = &BlockDCT_AANwSub_SSE2;
+#elif defined(M4VH263ENC_NEON)
+        BlockDCT8x8 = &BlockDCT_AANwSub_NEON;
+#else
         BlockDCT8x8 = &BlockDCT_AANwSub;
+#endif
 
         BlockQuantDequantMPEG = &BlockQuantDequantMPEGInter;
         BlockQuantDequantMPEGDC = &BlockQuantDequantMPEGDCInter;
@@ -1990,6 +1990,21 @@ void BlockIDCTMotionComp(Short *block, UChar *bitmapcol, UChar bitmaprow,
         }
     }
 
+#if defined(M4VH263ENC_SSE2)
+    if (dctMode == 8)
+    {
+        /* same output as the column and row functions below */
+        BlockIDCT8x8MotionComp_SSE2(block, rec, pred, lx_intra);
+        return ;
+    }
+#elif defined(M4VH263ENC_NEON)
+    if (dctMode == 8)
+    {
+        BlockIDCT8x8MotionComp_NEON(block, rec, pred, lx_intra);
+        return ;
+    }
+#endif
+
     for (i = 0; i < dctMode; i++)
     {
         bmap = (Int)bitmapcol[i];
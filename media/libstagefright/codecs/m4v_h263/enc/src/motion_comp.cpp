@@ -72,11 +72,25 @@ extern "C"
         Int rnd1 /* i */
     );
 
+#if defined(M4VH263ENC_SSE2)
+    static Int(*const GetPredAdvBTable[2][2])(UChar*, UChar*, Int, Int) =
+    {
+        {&GetPredAdvBy0x0_SSE2, &GetPredAdvBy0x1_SSE2},
+        {&GetPredAdvBy1x0_SSE2, &GetPredAdvBy1x1_SSE2}
+    };
+#elif defined(M4VH263ENC_NEON)
+    static Int(*const GetPredAdvBTable[2][2])(UChar*, UChar*, Int, Int) =
+    {
+        {&GetPredAdvBy0x0_NEON, &GetPredAdvBy0x1_NEON},
+        {&GetPredAdvBy1x0_NEON, &GetPredAdvBy1x1_NEON}
+    };
+#else
     static Int(*const GetPredAdvBTable[2][2])(UChar*, UChar*, Int, Int) =
     {
         {&GetPredAdvBy0x0, &GetPredAdvBy0x1},
         {&GetPredAdvBy1x0, &GetPredAdvBy1x1}
     };
+#endif
 
 
 #ifdef __cplusplus
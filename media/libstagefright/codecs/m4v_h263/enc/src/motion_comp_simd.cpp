@@ -0,0 +1,201 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+#include "mp4lib_int.h"
+#include "mp4enc_lib.h"
+
+#if defined(M4VH263ENC_SSE2)
+#include <emmintrin.h>
+#elif defined(M4VH263ENC_NEON)
+#include <arm_neon.h>
+#endif
+
+/* consist of
+Int GetPredAdvBy0x0_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+Int GetPredAdvBy0x1_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+Int GetPredAdvBy1x0_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+Int GetPredAdvBy1x1_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+and the NEON versions of the same.
+
+These give the same 8x8 prediction as GetPredAdvBy0x0() to GetPredAdvBy1x1()
+of motion_comp.cpp, with any alignment of prev. rec has a pitch of 16:
+    0x1, 1x0:   (a + b + rnd1) >> 1
+    1x1:        (a + b + c + d + 1 + rnd1) >> 2
+*/
+
+#if defined(M4VH263ENC_SSE2)
+
+Int GetPredAdvBy0x0_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+
+    OSCL_UNUSED_ARG(rnd1);
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        _mm_storel_epi64((__m128i*)rec, _mm_loadl_epi64((__m128i*)prev));
+        prev += lx;
+        rec += 16;
+    }
+    return 1;
+}
+
+/* (a + b + rnd1) >> 1, _mm_avg_epu8 rounds up */
+static inline __m128i avg_rnd(__m128i a, __m128i b, Int rnd1)
+{
+    __m128i avg = _mm_avg_epu8(a, b);
+
+    if (rnd1 == 0)
+    {
+        avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+    }
+    return avg;
+}
+
+Int GetPredAdvBy0x1_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+    __m128i a, b;
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        a = _mm_loadl_epi64((__m128i*)prev);
+        b = _mm_loadl_epi64((__m128i*)(prev + 1));
+        _mm_storel_epi64((__m128i*)rec, avg_rnd(a, b, rnd1));
+        prev += lx;
+        rec += 16;
+    }
+    return 1;
+}
+
+Int GetPredAdvBy1x0_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+    __m128i a, b;
+
+    a = _mm_loadl_epi64((__m128i*)prev);
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += lx;
+        b = _mm_loadl_epi64((__m128i*)prev);
+        _mm_storel_epi64((__m128i*)rec, avg_rnd(a, b, rnd1));
+        a = b;
+        rec += 16;
+    }
+    return 1;
+}
+
+Int GetPredAdvBy1x1_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rnd2 = _mm_set1_epi16(rnd1 + 1);
+    __m128i sum0, sum1;
+
+    /* the horizontal sums of a row are used for the rows above and below */
+    sum0 = _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)prev), zero),
+                         _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(prev + 1)), zero));
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += lx;
+        sum1 = _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)prev), zero),
+                             _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(prev + 1)), zero));
+        sum0 = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(sum0, sum1), rnd2), 2);
+        _mm_storel_epi64((__m128i*)rec, _mm_packus_epi16(sum0, sum0));
+        sum0 = sum1;
+        rec += 16;
+    }
+    return 1;
+}
+
+#elif defined(M4VH263ENC_NEON)
+
+Int GetPredAdvBy0x0_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+
+    OSCL_UNUSED_ARG(rnd1);
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        vst1_u8(rec, vld1_u8(prev));
+        prev += lx;
+        rec += 16;
+    }
+    return 1;
+}
+
+/* (a + b + rnd1) >> 1 */
+static inline uint8x8_t avg_rnd(uint8x8_t a, uint8x8_t b, Int rnd1)
+{
+    return rnd1 ? vrhadd_u8(a, b) : vhadd_u8(a, b);
+}
+
+Int GetPredAdvBy0x1_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        vst1_u8(rec, avg_rnd(vld1_u8(prev), vld1_u8(prev + 1), rnd1));
+        prev += lx;
+        rec += 16;
+    }
+    return 1;
+}
+
+Int GetPredAdvBy1x0_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+    uint8x8_t a, b;
+
+    a = vld1_u8(prev);
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += lx;
+        b = vld1_u8(prev);
+        vst1_u8(rec, avg_rnd(a, b, rnd1));
+        a = b;
+        rec += 16;
+    }
+    return 1;
+}
+
+Int GetPredAdvBy1x1_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1)
+{
+    Int i;
+    const uint16x8_t rnd2 = vdupq_n_u16(rnd1 + 1);
+    uint16x8_t sum0, sum1;
+
+    /* the horizontal sums of a row are used for the rows above and below */
+    sum0 = vaddl_u8(vld1_u8(prev), vld1_u8(prev + 1));
+
+    for (i = 0; i < B_SIZE; i++)
+    {
+        prev += lx;
+        sum1 = vaddl_u8(vld1_u8(prev), vld1_u8(prev + 1));
+        vst1_u8(rec, vshrn_n_u16(vaddq_u16(vaddq_u16(sum0, sum1), rnd2), 2));
+        sum0 = sum1;
+        rec += 16;
+    }
+    return 1;
+}
+
+#endif
@@ -108,6 +108,19 @@ extern "C"
     void EncPrediction_Chrom(Int xpred, Int ypred, UChar *cu_prev, UChar *cv_prev, UChar *cu_rec,
                              UChar *cv_rec, Int pitch_uv, Int width_uv, Int height_uv, Int round1);
 
+    /* defined in motion_comp_simd.c, the same as GetPredAdvBy0x0 to GetPredAdvBy1x1 */
+#if defined(M4VH263ENC_SSE2)
+    Int GetPredAdvBy0x0_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy0x1_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy1x0_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy1x1_SSE2(UChar *prev, UChar *rec, Int lx, Int rnd1);
+#elif defined(M4VH263ENC_NEON)
+    Int GetPredAdvBy0x0_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy0x1_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy1x0_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy1x1_NEON(UChar *prev, UChar *rec, Int lx, Int rnd1);
+#endif
+
     void get_MB(UChar *c_prev, UChar *c_prev_u  , UChar *c_prev_v,
                 Short mb[6][64], Int width, Int width_uv);
 
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that the SSE2/NEON forward DCTs and half-pel predictions return
+// exactly what the C versions return, and that BlockIDCTMotionComp() gives
+// the output of the column and row functions of fastidct.cpp for blocks with
+// any coefficients, for random, flat and extreme content. Prints the time
+// each kernel takes.
+//
+// Usage: m4vh263enc_dct_test [iterations] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mp4def.h"
+#include "mp4lib_int.h"
+#include "mp4enc_lib.h"
+#include "dct.h"
+
+extern "C" {
+    // defined in motion_comp.cpp
+    Int GetPredAdvBy0x0(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy0x1(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy1x0(UChar *prev, UChar *rec, Int lx, Int rnd1);
+    Int GetPredAdvBy1x1(UChar *prev, UChar *rec, Int lx, Int rnd1);
+}
+
+typedef Void (*DctFunc)(Short *out, UChar *cur, UChar *pred, Int width);
+typedef Int (*PredFunc)(UChar *prev, UChar *rec, Int lx, Int rnd1);
+
+#if defined(M4VH263ENC_SSE2)
+static const DctFunc kDctWSub = &BlockDCT_AANwSub_SSE2;
+static const DctFunc kDctIntra = &BlockDCT_AANIntra_SSE2;
+static const PredFunc kPred[2][2] = {
+    { &GetPredAdvBy0x0_SSE2, &GetPredAdvBy0x1_SSE2 },
+    { &GetPredAdvBy1x0_SSE2, &GetPredAdvBy1x1_SSE2 },
+};
+#elif defined(M4VH263ENC_NEON)
+static const DctFunc kDctWSub = &BlockDCT_AANwSub_NEON;
+static const DctFunc kDctIntra = &BlockDCT_AANIntra_NEON;
+static const PredFunc kPred[2][2] = {
+    { &GetPredAdvBy0x0_NEON, &GetPredAdvBy0x1_NEON },
+    { &GetPredAdvBy1x0_NEON, &GetPredAdvBy1x1_NEON },
+};
+#else
+static const DctFunc kDctWSub = &BlockDCT_AANwSub;
+static const DctFunc kDctIntra = &BlockDCT_AANIntra;
+static const PredFunc kPred[2][2] = {
+    { &GetPredAdvBy0x0, &GetPredAdvBy0x1 },
+    { &GetPredAdvBy1x0, &GetPredAdvBy1x1 },
+};
+#endif
+
+static const PredFunc kPredC[2][2] = {
+    { &GetPredAdvBy0x0, &GetPredAdvBy0x1 },
+    { &GetPredAdvBy1x0, &GetPredAdvBy1x1 },
+};
+
+enum {
+    kMaxPitch = 1952,
+};
+
+static const int kPitches[] = { 16, 176, 352, 1952 };
+
+static UChar gFrame[kMaxPitch * 10 + 32];
+static UChar gPred[16 * 8];
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static void fillBuffer(UChar *data, size_t size, int pattern) {
+    for (size_t i = 0; i < size; ++i) {
+        switch (pattern) {
+            case 0:
+                data[i] = rand() & 0xff;
+                break;
+            case 1:
+                // Small differences, the common case of an inter block.
+                data[i] = 128 + (rand() % 9) - 4;
+                break;
+            case 2:
+                data[i] = (rand() & 1) ? 0xff : 0x00;
+                break;
+            default:
+                data[i] = (pattern & 4) ? 0xff : 0x00;
+                break;
+        }
+    }
+}
+
+static int checkDct(int iterations) {
+    int failures = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        int pattern = i % 4;
+        fillBuffer(gFrame, sizeof(gFrame), pattern);
+        fillBuffer(gPred, sizeof(gPred), pattern);
+        if (pattern == 3) {
+            // All 0xff against all 0x00: the largest differences.
+            memset(gPred, (i & 4) ? 0x00 : 0xff, sizeof(gPred));
+            memset(gFrame, (i & 4) ? 0xff : 0x00, sizeof(gFrame));
+        }
+
+        int width = kPitches[i % (sizeof(kPitches) / sizeof(kPitches[0]))];
+        UChar *cur = gFrame + rand() % 16;
+
+        // The thresholds of the encoder, and none and all columns skipped.
+        Int colTh;
+        switch ((i >> 2) % 4) {
+            case 0: colTh = ColThInter[1 + rand() % 31]; break;
+            case 1: colTh = ColThIntra[1 + rand() % 31]; break;
+            case 2: colTh = 0; break;
+            default: colTh = 0x7fff; break;
+        }
+
+        bool intra = (i & 1);
+        DctFunc ref = intra ? &BlockDCT_AANIntra : &BlockDCT_AANwSub;
+        DctFunc test = intra ? kDctIntra : kDctWSub;
+
+        Short expected[128], actual[128];
+        for (int k = 0; k < 128; ++k) {
+            expected[k] = actual[k] = rand();
+        }
+        expected[64] = actual[64] = colTh;
+
+        ref(expected, cur, gPred, width);
+        test(actual, cur, gPred, width);
+
+        if (memcmp(expected, actual, sizeof(expected))) {
+            if (failures < 10) {
+                fprintf(stderr, "%s mismatch: width %d ColTh %d\n",
+                        intra ? "BlockDCT_AANIntra" : "BlockDCT_AANwSub",
+                        width, colTh);
+            }
+            ++failures;
+        }
+    }
+
+    printf("forward DCT: %d of %d blocks differ from the C functions\n",
+           failures, iterations);
+
+    return failures;
+}
+
+// idct_col() of fastidct.cpp, which has no prototype outside of it.
+static void referenceColumn(Short *blk) {
+    int32 x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = (int32)blk[32] << 11;
+    x2 = blk[48];
+    x3 = blk[16];
+    x4 = blk[8];
+    x5 = blk[56];
+    x6 = blk[40];
+    x7 = blk[24];
+    x0 = ((int32)blk[0] << 11) + 128;
+
+    x8 = W7 * (x4 + x5);
+    x4 = x8 + (W1 - W7) * x4;
+    x5 = x8 - (W1 + W7) * x5;
+    x8 = W3 * (x6 + x7);
+    x6 = x8 - (W3 - W5) * x6;
+    x7 = x8 - (W3 + W5) * x7;
+
+    x8 = x0 + x1;
+    x0 -= x1;
+    x1 = W6 * (x3 + x2);
+    x2 = x1 - (W2 + W6) * x2;
+    x3 = x1 + (W2 - W6) * x3;
+    x1 = x4 + x6;
+    x4 -= x6;
+    x6 = x5 + x7;
+    x5 -= x7;
+
+    x7 = x8 + x3;
+    x8 -= x3;
+    x3 = x0 + x2;
+    x0 -= x2;
+    x2 = (181 * (x4 + x5) + 128) >> 8;
+    x4 = (181 * (x4 - x5) + 128) >> 8;
+
+    blk[0] = (x7 + x1) >> 8;
+    blk[8] = (x3 + x2) >> 8;
+    blk[16] = (x0 + x4) >> 8;
+    blk[24] = (x8 + x6) >> 8;
+    blk[32] = (x8 - x6) >> 8;
+    blk[40] = (x0 - x4) >> 8;
+    blk[48] = (x3 - x2) >> 8;
+    blk[56] = (x7 - x1) >> 8;
+}
+
+static void randomBlock(Short *blk, UChar *bitmapcol, UChar *bitmaprow, int pattern) {
+    memset(blk, 0, 64 * sizeof(Short));
+
+    int count = 2 + rand() % 63;
+    for (int c = 0; c < count; ++c) {
+        int v;
+        switch (pattern) {
+            case 0:
+                v = (rand() % 4096) - 2048;
+                break;
+            case 1:
+                // The extremes of the dequantizer output.
+                v = (rand() & 1) ? 2047 : -2048;
+                break;
+            default:
+                v = (rand() % 401) - 200;
+                break;
+        }
+        blk[rand() % 64] = v;
+    }
+    blk[63] = 1;
+
+    // The bitmaps BlockQuantDequantH263Inter() sets for dctMode 8.
+    memset(bitmapcol, 0, 8);
+    *bitmaprow = 0;
+    for (int k = 0; k < 64; ++k) {
+        if (blk[k]) {
+            bitmapcol[k & 7] |= imask[k >> 3];
+        }
+    }
+    for (int k = 0; k < 8; ++k) {
+        if (bitmapcol[k]) {
+            *bitmaprow |= imask[k];
+        }
+    }
+}
+
+static int checkIdct(int iterations) {
+    int failures = 0;
+    enum { kRecPitch = 24 };
+
+    for (int i = 0; i < iterations; ++i) {
+        Short coeffs[64], expectedBlk[64], actualBlk[64];
+        UChar bitmapcol[8], bitmaprow;
+        UChar expected[8 * kRecPitch], actual[8 * kRecPitch];
+        bool intra = (i & 1);
+
+        randomBlock(coeffs, bitmapcol, &bitmaprow, (i >> 1) % 3);
+        fillBuffer(gPred, sizeof(gPred), i % 3);
+
+        memset(expected, 0x55, sizeof(expected));
+        memset(actual, 0x55, sizeof(actual));
+
+        memcpy(expectedBlk, coeffs, sizeof(coeffs));
+        for (int c = 0; c < 8; ++c) {
+            referenceColumn(expectedBlk + c);
+        }
+        if (intra) {
+            idct_rowIntra(expectedBlk, expected, kRecPitch);
+        } else {
+            idct_rowzmv(expectedBlk, expected, gPred, kRecPitch);
+        }
+
+        memcpy(actualBlk, coeffs, sizeof(coeffs));
+        BlockIDCTMotionComp(actualBlk, bitmapcol, bitmaprow, 8, actual, gPred,
+                            (kRecPitch << 1) | (intra ? 1 : 0));
+
+        bool ok = !memcmp(expected, actual, sizeof(expected));
+        for (int k = 0; k < 64; ++k) {
+            if (actualBlk[k] != 0) ok = false;
+        }
+
+        if (!ok) {
+            if (failures < 10) {
+                fprintf(stderr, "%s IDCT mismatch at iteration %d\n",
+                        intra ? "intra" : "inter", i);
+            }
+            ++failures;
+        }
+    }
+
+    printf("IDCT: %d of %d blocks differ from the column and row functions\n",
+           failures, iterations);
+
+    return failures;
+}
+
+static int checkMotionComp(int iterations) {
+    UChar expected[16 * 8], actual[16 * 8];
+    int failures = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        fillBuffer(gFrame, sizeof(gFrame), i % 3);
+
+        int lx = kPitches[i % (sizeof(kPitches) / sizeof(kPitches[0]))];
+        int offset = rand() % 16;
+        int rnd1 = (i >> 2) & 1;
+
+        for (int y = 0; y < 2; ++y) {
+            for (int x = 0; x < 2; ++x) {
+                memset(expected, 0x55, sizeof(expected));
+                memset(actual, 0x55, sizeof(actual));
+                kPredC[y][x](gFrame + offset, expected, lx, rnd1);
+                kPred[y][x](gFrame + offset, actual, lx, rnd1);
+
+                if (memcmp(expected, actual, sizeof(expected))) {
+                    if (failures < 10) {
+                        fprintf(stderr, "GetPredAdvBy%dx%d mismatch: lx %d offset %d "
+                                "rnd1 %d\n", y, x, lx, offset, rnd1);
+                    }
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    printf("motion compensation: %d of %d blocks differ from the C functions\n",
+           failures, iterations * 4);
+
+    return failures;
+}
+
+static void benchmark() {
+    enum { kRuns = 200000, kLx = 176 };
+    Short out[128], coeffs[64], blk[64];
+    UChar bitmapcol[8], bitmaprow;
+    UChar rec[16 * 8];
+
+    fillBuffer(gFrame, sizeof(gFrame), 0);
+    fillBuffer(gPred, sizeof(gPred), 0);
+
+    static const struct {
+        const char *name;
+        DctFunc ref;
+        DctFunc test;
+    } kDcts[] = {
+        { "BlockDCT_AANwSub", &BlockDCT_AANwSub, kDctWSub },
+        { "BlockDCT_AANIntra", &BlockDCT_AANIntra, kDctIntra },
+    };
+
+    for (size_t f = 0; f < sizeof(kDcts) / sizeof(kDcts[0]); ++f) {
+        int64_t start = nowNs();
+        for (int i = 0; i < kRuns; ++i) {
+            out[64] = ColThInter[8];
+            kDcts[f].ref(out, gFrame + (i & 3), gPred, kLx);
+        }
+        int64_t c = nowNs() - start;
+
+        start = nowNs();
+        for (int i = 0; i < kRuns; ++i) {
+            out[64] = ColThInter[8];
+            kDcts[f].test(out, gFrame + (i & 3), gPred, kLx);
+        }
+        int64_t selected = nowNs() - start;
+
+        printf("%s: C %.1f ns, selected %.1f ns\n", kDcts[f].name,
+               (double)c / kRuns, (double)selected / kRuns);
+    }
+
+    randomBlock(coeffs, bitmapcol, &bitmaprow, 2);
+    int64_t start = nowNs();
+    for (int i = 0; i < kRuns; ++i) {
+        memcpy(blk, coeffs, sizeof(blk));
+        BlockIDCTMotionComp(blk, bitmapcol, bitmaprow, 8, gFrame, gPred, kLx << 1);
+    }
+    printf("BlockIDCTMotionComp, 8x8: %.1f ns\n", (double)(nowNs() - start) / kRuns);
+
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            start = nowNs();
+            for (int i = 0; i < kRuns; ++i) {
+                kPredC[y][x](gFrame + (i & 3), rec, kLx, i & 1);
+            }
+            int64_t c = nowNs() - start;
+
+            start = nowNs();
+            for (int i = 0; i < kRuns; ++i) {
+                kPred[y][x](gFrame + (i & 3), rec, kLx, i & 1);
+            }
+            int64_t selected = nowNs() - start;
+
+            printf("GetPredAdvBy%dx%d: C %.1f ns, selected %.1f ns\n", y, x,
+                   (double)c / kRuns, (double)selected / kRuns);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 100000;
+    unsigned seed = (argc > 2) ? atoi(argv[2]) : (unsigned)time(NULL);
+
+    srand(seed);
+
+    if (kDctWSub == &BlockDCT_AANwSub) {
+        printf("No SIMD kernels in this build, checking the C ones.\n");
+    }
+
+    int failures = 0;
+
+    failures += checkDct(iterations);
+    failures += checkIdct(iterations);
+    failures += checkMotionComp(iterations / 10);
+
+    benchmark();
+
+    printf("%s (seed %u)\n", failures ? "FAILED" : "passed", seed);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -38,7 +38,9 @@ LOCAL_SRC_FILES += \
 else
 LOCAL_SRC_FILES += \
  	src/pvmp3_polyphase_filter_window.cpp \
+ 	src/pvmp3_polyphase_filter_window_sse2.cpp \
  	src/pvmp3_mdct_18.cpp \
+ 	src/pvmp3_mdct_18_sse2.cpp \
  	src/pvmp3_dct_9.cpp \
  	src/pvmp3_dct_16.cpp
 endif
@@ -51,6 +53,13 @@ LOCAL_C_INCLUDES := \
 LOCAL_CFLAGS := \
         -DOSCL_UNUSED_ARG=
 
+# The polyphase window and the long block IMDCT are replaced by bit-exact
+# SSE2 versions in src/pvmp3_polyphase_filter_window_sse2.cpp and
+# src/pvmp3_mdct_18_sse2.cpp.
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DPVMP3DEC_SSE2
+endif
+
 LOCAL_MODULE := libstagefright_mp3dec
 
 include $(BUILD_STATIC_LIBRARY)
@@ -96,7 +105,9 @@ LOCAL_SRC_FILES += \
 else
 LOCAL_SRC_FILES += \
 	src/pvmp3_polyphase_filter_window.cpp \
+	src/pvmp3_polyphase_filter_window_sse2.cpp \
 	src/pvmp3_mdct_18.cpp \
+	src/pvmp3_mdct_18_sse2.cpp \
 	src/pvmp3_dct_9.cpp \
 	src/pvmp3_dct_16.cpp
 endif
@@ -109,6 +120,13 @@ LOCAL_C_INCLUDES := \
 LOCAL_CFLAGS := \
         -DOSCL_UNUSED_ARG=
 
+# The polyphase window and the long block IMDCT are replaced by bit-exact
+# SSE2 versions in src/pvmp3_polyphase_filter_window_sse2.cpp and
+# src/pvmp3_mdct_18_sse2.cpp.
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DPVMP3DEC_SSE2
+endif
+
 LOCAL_MODULE := libstagefright_mp3dec_omx
 
 LOCAL_ARM_MODE := arm
@@ -138,3 +156,32 @@ LOCAL_MODULE := libstagefright_soft_mp3dec
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
+
+################################################################################
+# test utility: compares the SSE2 kernels with the C versions and measures
+# multi-stream decoding throughput
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+        test/mp3dec_bench.cpp
+
+LOCAL_C_INCLUDES := \
+        frameworks/av/media/libstagefright/include \
+        $(LOCAL_PATH)/src \
+        $(LOCAL_PATH)/include
+
+LOCAL_CFLAGS := \
+        -DOSCL_UNUSED_ARG=
+
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS += -DPVMP3DEC_SSE2
+endif
+
+LOCAL_STATIC_LIBRARIES := \
+        libstagefright_mp3dec
+
+LOCAL_MODULE := mp3dec_bench
+LOCAL_MODULE_TAGS := debug
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,101 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+   PacketVideo Corp.
+   MP3 Decoder Library
+
+   Pathname: ./cpp/include/pv_mp3dec_fxd_op_sse2.h
+
+------------------------------------------------------------------------------
+ REVISION HISTORY
+
+ Description:
+------------------------------------------------------------------------------
+ INCLUDE DESCRIPTION
+
+ Four lane versions of the fixed point operators of
+ pv_mp3dec_fxd_op_c_equivalent.h, giving the same result in every lane as
+ the scalar operator does.
+
+ SSE2 only has the unsigned 32x32->64 bit multiply, the signed product is
+ recovered from it with
+    hi_s(a, b) = hi_u(a, b) - (a < 0 ? b : 0) - (b < 0 ? a : 0)
+ the low word is the same for the signed and the unsigned product.
+------------------------------------------------------------------------------
+*/
+
+#ifndef PV_MP3DEC_FXD_OP_SSE2_H
+#define PV_MP3DEC_FXD_OP_SSE2_H
+
+#include <emmintrin.h>
+
+#include "pvmp3_audio_type_defs.h"
+
+/* the high and the low words of the signed 64 bit products of a and b */
+static inline __m128i fxp_mul32_hi_SSE2(__m128i a, __m128i b, __m128i *lo)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    __m128i hi;
+
+    hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(3, 3, 3, 1)),
+                            _mm_shuffle_epi32(odd,  _MM_SHUFFLE(3, 3, 3, 1)));
+    hi = _mm_sub_epi32(hi, _mm_and_si128(a, _mm_srai_epi32(b, 31)));
+    hi = _mm_sub_epi32(hi, _mm_and_si128(b, _mm_srai_epi32(a, 31)));
+
+    if (lo)
+    {
+        *lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(2, 2, 2, 0)),
+                                 _mm_shuffle_epi32(odd,  _MM_SHUFFLE(2, 2, 2, 0)));
+    }
+    return hi;
+}
+
+static inline __m128i fxp_mul32_Q32_SSE2(__m128i a, __m128i b)
+{
+    return fxp_mul32_hi_SSE2(a, b, 0);
+}
+
+static inline __m128i fxp_mac32_Q32_SSE2(__m128i L_add, __m128i a, __m128i b)
+{
+    return _mm_add_epi32(L_add, fxp_mul32_hi_SSE2(a, b, 0));
+}
+
+static inline __m128i fxp_msb32_Q32_SSE2(__m128i L_sub, __m128i a, __m128i b)
+{
+    return _mm_sub_epi32(L_sub, fxp_mul32_hi_SSE2(a, b, 0));
+}
+
+static inline __m128i fxp_mul32_Q28_SSE2(__m128i a, __m128i b)
+{
+    __m128i lo;
+    __m128i hi = fxp_mul32_hi_SSE2(a, b, &lo);
+
+    return _mm_or_si128(_mm_slli_epi32(hi, 4), _mm_srli_epi32(lo, 28));
+}
+
+static inline __m128i fxp_mul32_Q27_SSE2(__m128i a, __m128i b)
+{
+    __m128i lo;
+    __m128i hi = fxp_mul32_hi_SSE2(a, b, &lo);
+
+    return _mm_or_si128(_mm_slli_epi32(hi, 5), _mm_srli_epi32(lo, 27));
+}
+
+#endif  /* PV_MP3DEC_FXD_OP_SSE2_H */
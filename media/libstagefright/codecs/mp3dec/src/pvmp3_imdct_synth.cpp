@@ -213,6 +213,53 @@ const int32 short_win[12] =
 ; FUNCTION CODE
 ----------------------------------------------------------------------------*/
 
+#if defined(PVMP3DEC_SSE2)
+/*
+ *  Transforms the leading groups of four subbands that use the same long,
+ *  start or stop window at once, and returns the number of subbands done.
+ */
+static int32 pvmp3_imdct_long_x4(int32 in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
+                                 int32 overlap[SUBBANDS_NUMBER*FILTERBANK_BANDS],
+                                 uint32 blk_type,
+                                 int16 mx_band,
+                                 int32 bands2process)
+{
+    int32 band;
+
+    for (band = 0; band + 4 <= bands2process; band += 4)
+    {
+        uint32 current_blk_type = (band < mx_band) ? LONG : blk_type;
+        const int32 *window;
+
+        if ((band + 3 < mx_band ? LONG : blk_type) != current_blk_type)
+        {
+            break;
+        }
+        if (current_blk_type == LONG)
+        {
+            window = normal_win;
+        }
+        else if (current_blk_type == START)
+        {
+            window = start_win;
+        }
+        else if (current_blk_type == STOP)
+        {
+            window = stop_win;
+        }
+        else
+        {
+            break;
+        }
+        pvmp3_mdct_18_x4_SSE2(in      + (band * FILTERBANK_BANDS),
+                              overlap + (band * FILTERBANK_BANDS),
+                              window);
+    }
+
+    return band;
+}
+#endif
+
 void pvmp3_imdct_synth(int32  in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
                        int32  overlap[SUBBANDS_NUMBER*FILTERBANK_BANDS],
                        uint32 blk_type,
@@ -235,6 +282,11 @@ void pvmp3_imdct_synth(int32  in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
      *  long transforms
      */
 
+    int32 bands_x4 = 0;     /* subbands already transformed four at a time */
+
+#if defined(PVMP3DEC_SSE2)
+    bands_x4 = pvmp3_imdct_long_x4(in, overlap, blk_type, mx_band, bands2process);
+#endif
 
     for (band = 0; band < bands2process; band++)
     {
@@ -243,69 +295,72 @@ void pvmp3_imdct_synth(int32  in[SUBBANDS_NUMBER*FILTERBANK_BANDS],
         int32 * out     = in      + (band * FILTERBANK_BANDS);
         int32 * history = overlap + (band * FILTERBANK_BANDS);
 
-        switch (current_blk_type)
+        if (band >= bands_x4)
         {
-            case LONG:
-
-                pvmp3_mdct_18(out, history, normal_win);
-
-                break;
+            switch (current_blk_type)
+            {
+                case LONG:
 
-            case START:
+                    pvmp3_mdct_18(out, history, normal_win);
 
-                pvmp3_mdct_18(out, history, start_win);
+                    break;
 
-                break;
+                case START:
 
-            case STOP:
+                    pvmp3_mdct_18(out, history, start_win);
 
-                pvmp3_mdct_18(out, history, stop_win);
-
-                break;
+                    break;
 
-            case SHORT:
-            {
-                int32 *tmp_prev_ovr = &Scratch_mem[FILTERBANK_BANDS];
-                int32 i;
+                case STOP:
 
-                for (i = 0; i < 6; i++)
-                {
-                    Scratch_mem[i    ] = out[(i*3)];
-                    Scratch_mem[6  +i] = out[(i*3) + 1];
-                    Scratch_mem[12 +i] = out[(i*3) + 2];
-                }
+                    pvmp3_mdct_18(out, history, stop_win);
 
-                pvmp3_mdct_6(&Scratch_mem[ 0], &tmp_prev_ovr[ 0]);
-                pvmp3_mdct_6(&Scratch_mem[ 6], &tmp_prev_ovr[ 6]);
-                pvmp3_mdct_6(&Scratch_mem[12], &tmp_prev_ovr[12]);
+                    break;
 
-                for (i = 0; i < 6; i++)
+                case SHORT:
                 {
-                    int32 temp  =  history[i];
-                    /* next iteration overlap */
-                    history[i]  =  fxp_mul32_Q32(tmp_prev_ovr[ 6+i] << 1, short_win[6+i]);
-                    history[i] +=  fxp_mul32_Q32(Scratch_mem[12+i] << 1, short_win[  i]);
-                    out[i]  =  temp;
+                    int32 *tmp_prev_ovr = &Scratch_mem[FILTERBANK_BANDS];
+                    int32 i;
+
+                    for (i = 0; i < 6; i++)
+                    {
+                        Scratch_mem[i    ] = out[(i*3)];
+                        Scratch_mem[6  +i] = out[(i*3) + 1];
+                        Scratch_mem[12 +i] = out[(i*3) + 2];
+                    }
+
+                    pvmp3_mdct_6(&Scratch_mem[ 0], &tmp_prev_ovr[ 0]);
+                    pvmp3_mdct_6(&Scratch_mem[ 6], &tmp_prev_ovr[ 6]);
+                    pvmp3_mdct_6(&Scratch_mem[12], &tmp_prev_ovr[12]);
+
+                    for (i = 0; i < 6; i++)
+                    {
+                        int32 temp  =  history[i];
+                        /* next iteration overlap */
+                        history[i]  =  fxp_mul32_Q32(tmp_prev_ovr[ 6+i] << 1, short_win[6+i]);
+                        history[i] +=  fxp_mul32_Q32(Scratch_mem[12+i] << 1, short_win[  i]);
+                        out[i]  =  temp;
+                    }
+
+                    for (i = 0; i < 6; i++)
+                    {
+                        out[i+6]   =  fxp_mul32_Q32(Scratch_mem[i] << 1, short_win[i]);
+                        out[i+6]  +=  history[i+6];
+                        /* next iteration overlap */
+                        history[i+6]  =  fxp_mul32_Q32(tmp_prev_ovr[12+i] << 1, short_win[6+i]);
+
+                    }
+                    for (i = 0; i < 6; i++)
+                    {
+                        out[i+12]  =  fxp_mul32_Q32(tmp_prev_ovr[  i] << 1, short_win[6+i]);
+                        out[i+12] +=  fxp_mul32_Q32(Scratch_mem[6+i] << 1, short_win[  i]);
+                        out[i+12] +=  history[i+12];
+                        history[12+i]  =  0;
+                    }
                 }
 
-                for (i = 0; i < 6; i++)
-                {
-                    out[i+6]   =  fxp_mul32_Q32(Scratch_mem[i] << 1, short_win[i]);
-                    out[i+6]  +=  history[i+6];
-                    /* next iteration overlap */
-                    history[i+6]  =  fxp_mul32_Q32(tmp_prev_ovr[12+i] << 1, short_win[6+i]);
-
-                }
-                for (i = 0; i < 6; i++)
-                {
-                    out[i+12]  =  fxp_mul32_Q32(tmp_prev_ovr[  i] << 1, short_win[6+i]);
-                    out[i+12] +=  fxp_mul32_Q32(Scratch_mem[6+i] << 1, short_win[  i]);
-                    out[i+12] +=  history[i+12];
-                    history[12+i]  =  0;
-                }
+                break;
             }
-
-            break;
         }
 
         /*
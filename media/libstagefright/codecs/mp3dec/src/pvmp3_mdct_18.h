@@ -91,6 +91,11 @@ extern "C"
 
     void pvmp3_mdct_18(int32 vec[], int32 *history, const int32 *window);
 
+#if defined(PVMP3DEC_SSE2)
+    /* pvmp3_mdct_18() of four consecutive subbands */
+    void pvmp3_mdct_18_x4_SSE2(int32 vec[], int32 *history, const int32 *window);
+#endif
+
     void pvmp3_dct_9(int32 vec[]);
 
     void pvmp3_mdct_6(int32 vec[], int32 *overlap);
@@ -0,0 +1,369 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+
+   PacketVideo Corp.
+   MP3 Decoder Library
+
+   Filename: pvmp3_mdct_18_sse2.cpp
+
+------------------------------------------------------------------------------
+ INPUT AND OUTPUT DEFINITIONS
+
+Input
+    int32 vec[],        input vectors of length 18 of four consecutive
+                        subbands
+    int32 *history      input for overlap and add of the same subbands,
+                        updated with next overlap and add values
+    const int32 *window sine window used in the mdct of all four subbands
+Returns
+    none                mdct computation in-place
+
+
+------------------------------------------------------------------------------
+ FUNCTION DESCRIPTION
+
+    SSE2 version of pvmp3_mdct_18() that transforms four subbands at once,
+    one per lane, bit exact with the C version. The subbands are transposed
+    in and out, the transform itself follows pvmp3_mdct_18() and
+    pvmp3_dct_9() step by step.
+
+------------------------------------------------------------------------------
+*/
+
+#if defined(PVMP3DEC_SSE2)
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+
+#include "pv_mp3dec_fxd_op.h"
+#include "pv_mp3dec_fxd_op_sse2.h"
+#include "pvmp3_mdct_18.h"
+
+/*----------------------------------------------------------------------------
+; DEFINES
+----------------------------------------------------------------------------*/
+
+/* as in pvmp3_dct_9.cpp */
+#define Qfmt31(a)   (int32)(a*(0x7FFFFFFF))
+
+#define cos_pi_9    Qfmt31( 0.93969262078591f)
+#define cos_2pi_9   Qfmt31( 0.76604444311898f)
+#define cos_4pi_9   Qfmt31( 0.17364817766693f)
+#define cos_5pi_9   Qfmt31(-0.17364817766693f)
+#define cos_7pi_9   Qfmt31(-0.76604444311898f)
+#define cos_8pi_9   Qfmt31(-0.93969262078591f)
+#define cos_pi_6    Qfmt31( 0.86602540378444f)
+#define cos_5pi_6   Qfmt31(-0.86602540378444f)
+#define cos_5pi_18  Qfmt31( 0.64278760968654f)
+#define cos_7pi_18  Qfmt31( 0.34202014332567f)
+#define cos_11pi_18 Qfmt31(-0.34202014332567f)
+#define cos_13pi_18 Qfmt31(-0.64278760968654f)
+#define cos_17pi_18 Qfmt31(-0.98480775301221f)
+
+#define ADD(a, b)   _mm_add_epi32(a, b)
+#define SUB(a, b)   _mm_sub_epi32(a, b)
+#define SHL1(a)     _mm_slli_epi32(a, 1)
+#define C(a)        _mm_set1_epi32(a)
+
+/*----------------------------------------------------------------------------
+; LOCAL STORE/BUFFER/POINTER DEFINITIONS
+----------------------------------------------------------------------------*/
+
+/* as in pvmp3_mdct_18.cpp */
+static const int32 cosTerms_dct18_SSE2[9] =
+{
+    Qfmt(0.50190991877167f),   Qfmt(0.51763809020504f),   Qfmt(0.55168895948125f),
+    Qfmt(0.61038729438073f),   Qfmt(0.70710678118655f),   Qfmt(0.87172339781055f),
+    Qfmt(1.18310079157625f),   Qfmt(1.93185165257814f),   Qfmt(5.73685662283493f)
+};
+
+static const int32 cosTerms_1_ov_cos_phi_SSE2[18] =
+{
+
+    Qfmt1(0.50047634258166f),  Qfmt1(0.50431448029008f),  Qfmt1(0.51213975715725f),
+    Qfmt1(0.52426456257041f),  Qfmt1(0.54119610014620f),  Qfmt1(0.56369097343317f),
+    Qfmt1(0.59284452371708f),  Qfmt1(0.63023620700513f),  Qfmt1(0.67817085245463f),
+
+    Qfmt2(0.74009361646113f),  Qfmt2(0.82133981585229f),  Qfmt2(0.93057949835179f),
+    Qfmt2(1.08284028510010f),  Qfmt2(1.30656296487638f),  Qfmt2(1.66275476171152f),
+    Qfmt2(2.31011315767265f),  Qfmt2(3.83064878777019f),  Qfmt2(11.46279281302667f)
+};
+
+/*----------------------------------------------------------------------------
+; FUNCTION CODE
+----------------------------------------------------------------------------*/
+
+/* x[e] = { in[e], in[18 + e], in[36 + e], in[54 + e] } */
+static void transpose_in(__m128i x[18], const int32 *in)
+{
+    int32 e;
+
+    for (e = 0; e < 16; e += 4)
+    {
+        __m128i r0 = _mm_loadu_si128((const __m128i *) & in[e]);
+        __m128i r1 = _mm_loadu_si128((const __m128i *) & in[e + 18]);
+        __m128i r2 = _mm_loadu_si128((const __m128i *) & in[e + 36]);
+        __m128i r3 = _mm_loadu_si128((const __m128i *) & in[e + 54]);
+        __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+        __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+        __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+        __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+        x[e    ] = _mm_unpacklo_epi64(t0, t1);
+        x[e + 1] = _mm_unpackhi_epi64(t0, t1);
+        x[e + 2] = _mm_unpacklo_epi64(t2, t3);
+        x[e + 3] = _mm_unpackhi_epi64(t2, t3);
+    }
+    x[16] = _mm_set_epi32(in[70], in[52], in[34], in[16]);
+    x[17] = _mm_set_epi32(in[71], in[53], in[35], in[17]);
+}
+
+static void transpose_out(int32 *out, const __m128i x[18])
+{
+    int32 e;
+    int32 tmp[8];
+
+    for (e = 0; e < 16; e += 4)
+    {
+        __m128i t0 = _mm_unpacklo_epi32(x[e    ], x[e + 1]);
+        __m128i t1 = _mm_unpacklo_epi32(x[e + 2], x[e + 3]);
+        __m128i t2 = _mm_unpackhi_epi32(x[e    ], x[e + 1]);
+        __m128i t3 = _mm_unpackhi_epi32(x[e + 2], x[e + 3]);
+
+        _mm_storeu_si128((__m128i *) & out[e     ], _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *) & out[e + 18], _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128((__m128i *) & out[e + 36], _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128((__m128i *) & out[e + 54], _mm_unpackhi_epi64(t2, t3));
+    }
+    _mm_storeu_si128((__m128i *) & tmp[0], _mm_unpacklo_epi32(x[16], x[17]));
+    _mm_storeu_si128((__m128i *) & tmp[4], _mm_unpackhi_epi32(x[16], x[17]));
+    out[16] = tmp[0];
+    out[17] = tmp[1];
+    out[34] = tmp[2];
+    out[35] = tmp[3];
+    out[52] = tmp[4];
+    out[53] = tmp[5];
+    out[70] = tmp[6];
+    out[71] = tmp[7];
+}
+
+static void pvmp3_dct_9_SSE2(__m128i vec[])
+{
+    /*  split input vector */
+    __m128i tmp0 =  ADD(vec[8], vec[0]);
+    __m128i tmp8 =  SUB(vec[8], vec[0]);
+    __m128i tmp1 =  ADD(vec[7], vec[1]);
+    __m128i tmp7 =  SUB(vec[7], vec[1]);
+    __m128i tmp2 =  ADD(vec[6], vec[2]);
+    __m128i tmp6 =  SUB(vec[6], vec[2]);
+    __m128i tmp3 =  ADD(vec[5], vec[3]);
+    __m128i tmp5 =  SUB(vec[5], vec[3]);
+    __m128i tmp;
+
+    tmp     = ADD(ADD(tmp0, tmp2), tmp3);
+    vec[0]  = ADD(tmp, ADD(tmp1, vec[4]));
+    vec[6]  = SUB(_mm_srai_epi32(tmp, 1), ADD(tmp1, vec[4]));
+    vec[2]  = SUB(_mm_srai_epi32(tmp1, 1), vec[4]);
+    vec[4]  = SUB(_mm_setzero_si128(), vec[2]);
+    vec[8]  = vec[4];
+
+    tmp0 = SHL1(tmp0);
+    tmp2 = SHL1(tmp2);
+    tmp3 = SHL1(tmp3);
+
+    vec[4]  = fxp_mac32_Q32_SSE2(vec[4], tmp0, C(cos_2pi_9));
+    vec[8]  = fxp_mac32_Q32_SSE2(vec[8], tmp0, C(cos_4pi_9));
+    vec[2]  = fxp_mac32_Q32_SSE2(vec[2], tmp0, C(cos_pi_9));
+
+    vec[2]  = fxp_mac32_Q32_SSE2(vec[2], tmp2, C(cos_5pi_9));
+    vec[4]  = fxp_mac32_Q32_SSE2(vec[4], tmp2, C(cos_8pi_9));
+    vec[8]  = fxp_mac32_Q32_SSE2(vec[8], tmp2, C(cos_2pi_9));
+
+    vec[8]  = fxp_mac32_Q32_SSE2(vec[8], tmp3, C(cos_8pi_9));
+    vec[4]  = fxp_mac32_Q32_SSE2(vec[4], tmp3, C(cos_4pi_9));
+    vec[2]  = fxp_mac32_Q32_SSE2(vec[2], tmp3, C(cos_7pi_9));
+
+    vec[3]  = fxp_mul32_Q32_SSE2(SHL1(SUB(ADD(tmp5, tmp6), tmp8)), C(cos_pi_6));
+
+    tmp5 = SHL1(tmp5);
+    tmp6 = SHL1(tmp6);
+    tmp7 = SHL1(tmp7);
+    tmp8 = SHL1(tmp8);
+
+    vec[1]  = fxp_mul32_Q32_SSE2(tmp5, C(cos_11pi_18));
+    vec[1]  = fxp_mac32_Q32_SSE2(vec[1], tmp6, C(cos_13pi_18));
+    vec[1]  = fxp_mac32_Q32_SSE2(vec[1], tmp7, C(cos_5pi_6));
+    vec[1]  = fxp_mac32_Q32_SSE2(vec[1], tmp8, C(cos_17pi_18));
+
+    vec[5]  = fxp_mul32_Q32_SSE2(tmp5, C(cos_17pi_18));
+    vec[5]  = fxp_mac32_Q32_SSE2(vec[5], tmp6, C(cos_7pi_18));
+    vec[5]  = fxp_mac32_Q32_SSE2(vec[5], tmp7, C(cos_pi_6));
+    vec[5]  = fxp_mac32_Q32_SSE2(vec[5], tmp8, C(cos_13pi_18));
+
+    vec[7]  = fxp_mul32_Q32_SSE2(tmp5, C(cos_5pi_18));
+    vec[7]  = fxp_mac32_Q32_SSE2(vec[7], tmp6, C(cos_17pi_18));
+    vec[7]  = fxp_mac32_Q32_SSE2(vec[7], tmp7, C(cos_pi_6));
+    vec[7]  = fxp_mac32_Q32_SSE2(vec[7], tmp8, C(cos_11pi_18));
+}
+
+void pvmp3_mdct_18_x4_SSE2(int32 vec_x4[], int32 *history_x4, const int32 *window)
+{
+    __m128i vec[18];
+    __m128i history[18];
+    __m128i tmp;
+    __m128i tmp1;
+    __m128i tmp2;
+    __m128i tmp3;
+    __m128i tmp4;
+    const __m128i zero = _mm_setzero_si128();
+    int32 i;
+
+    transpose_in(vec, vec_x4);
+    transpose_in(history, history_x4);
+
+    for (i = 0; i < 9; i++)
+    {
+        tmp  = fxp_mul32_Q32_SSE2(SHL1(vec[i]), C(cosTerms_1_ov_cos_phi_SSE2[i]));
+        tmp1 = fxp_mul32_Q27_SSE2(vec[17 - i], C(cosTerms_1_ov_cos_phi_SSE2[17 - i]));
+
+        vec[i]      = ADD(tmp, tmp1);
+        vec[17 - i] = fxp_mul32_Q28_SSE2(SUB(tmp, tmp1), C(cosTerms_dct18_SSE2[i]));
+    }
+
+    pvmp3_dct_9_SSE2(vec);         // Even terms
+    pvmp3_dct_9_SSE2(&vec[9]);     // Odd  terms
+
+    tmp3     = vec[16];
+    vec[16]  = vec[ 8];
+    tmp4     = vec[14];
+    vec[14]  = vec[ 7];
+    tmp      = vec[12];
+    vec[12]  = vec[ 6];
+    tmp2     = vec[10];
+    vec[10]  = vec[ 5];
+    vec[ 8]  = vec[ 4];
+    vec[ 6]  = vec[ 3];
+    vec[ 4]  = vec[ 2];
+    vec[ 2]  = vec[ 1];
+    vec[ 1]  = SUB(vec[ 9], tmp2);
+    vec[ 3]  = SUB(vec[11], tmp2);
+    vec[ 5]  = SUB(vec[11], tmp);
+    vec[ 7]  = SUB(vec[13], tmp);
+    vec[ 9]  = SUB(vec[13], tmp4);
+    vec[11]  = SUB(vec[15], tmp4);
+    vec[13]  = SUB(vec[15], tmp3);
+    vec[15]  = SUB(vec[17], tmp3);
+
+    /* overlap and add */
+
+    tmp2 = vec[0];
+    tmp3 = vec[9];
+
+    for (i = 0; i < 6; i++)
+    {
+        tmp  = history[ i];
+        tmp4 = vec[i+10];
+        vec[i+10] = ADD(tmp3, tmp4);
+        tmp1 = vec[i+1];
+        vec[ i] =  fxp_mac32_Q32_SSE2(tmp, vec[i+10], C(window[ i]));
+        tmp3 = tmp4;
+        history[i  ] = SUB(zero, ADD(tmp2, tmp1));
+        tmp2 = tmp1;
+    }
+
+    tmp  = history[ 6];
+    tmp4 = vec[16];
+    vec[16] = ADD(tmp3, tmp4);
+    tmp1 = vec[7];
+    vec[ 6] =  fxp_mac32_Q32_SSE2(tmp, SHL1(vec[16]), C(window[ 6]));
+    tmp  = history[ 7];
+    history[6] = SUB(zero, ADD(tmp2, tmp1));
+    history[7] = SUB(zero, ADD(tmp1, vec[8]));
+
+    tmp1  = history[ 8];
+    tmp4    = ADD(vec[17], tmp4);
+    vec[ 7] =  fxp_mac32_Q32_SSE2(tmp, SHL1(tmp4), C(window[ 7]));
+    history[8] = SUB(zero, ADD(vec[8], vec[9]));
+    vec[ 8] =  fxp_mac32_Q32_SSE2(tmp1, SHL1(vec[17]), C(window[ 8]));
+
+    tmp  = history[9];
+    tmp1 = history[17];
+    tmp2 = history[16];
+    vec[ 9] =  fxp_mac32_Q32_SSE2(tmp,  SHL1(vec[17]), C(window[ 9]));
+
+    vec[17] =  fxp_mac32_Q32_SSE2(tmp1, SHL1(vec[10]), C(window[17]));
+    vec[10] =  SUB(zero, vec[16]);
+    vec[16] =  fxp_mac32_Q32_SSE2(tmp2, SHL1(vec[11]), C(window[16]));
+    tmp1 = history[15];
+    tmp2 = history[14];
+    vec[11] =  SUB(zero, vec[15]);
+    vec[15] =  fxp_mac32_Q32_SSE2(tmp1, SHL1(vec[12]), C(window[15]));
+    vec[12] =  SUB(zero, vec[14]);
+    vec[14] =  fxp_mac32_Q32_SSE2(tmp2, SHL1(vec[13]), C(window[14]));
+
+    tmp  = history[13];
+    tmp1 = history[12];
+    tmp2 = history[11];
+    tmp3 = history[10];
+    vec[13] =  fxp_mac32_Q32_SSE2(tmp,  SHL1(vec[12]), C(window[13]));
+    vec[12] =  fxp_mac32_Q32_SSE2(tmp1, SHL1(vec[11]), C(window[12]));
+    vec[11] =  fxp_mac32_Q32_SSE2(tmp2, SHL1(vec[10]), C(window[11]));
+    vec[10] =  fxp_mac32_Q32_SSE2(tmp3, SHL1(tmp4),    C(window[10]));
+
+    /* next iteration overlap */
+
+    tmp1 = SHL1(history[ 8]);
+    tmp3 = SHL1(history[ 7]);
+    tmp2 = SHL1(history[ 1]);
+    tmp  = SHL1(history[ 0]);
+
+    history[ 0] = fxp_mul32_Q32_SSE2(tmp1, C(window[18]));
+    history[17] = fxp_mul32_Q32_SSE2(tmp1, C(window[35]));
+    history[ 1] = fxp_mul32_Q32_SSE2(tmp3, C(window[19]));
+    history[16] = fxp_mul32_Q32_SSE2(tmp3, C(window[34]));
+
+    history[ 7] = fxp_mul32_Q32_SSE2(tmp2, C(window[25]));
+    history[10] = fxp_mul32_Q32_SSE2(tmp2, C(window[28]));
+    history[ 8] = fxp_mul32_Q32_SSE2(tmp,  C(window[26]));
+    history[ 9] = fxp_mul32_Q32_SSE2(tmp,  C(window[27]));
+
+    tmp1 = SHL1(history[ 6]);
+    tmp3 = SHL1(history[ 5]);
+    tmp4 = SHL1(history[ 4]);
+    tmp2 = SHL1(history[ 3]);
+    tmp  = SHL1(history[ 2]);
+
+    history[ 2] = fxp_mul32_Q32_SSE2(tmp1, C(window[20]));
+    history[15] = fxp_mul32_Q32_SSE2(tmp1, C(window[33]));
+    history[ 3] = fxp_mul32_Q32_SSE2(tmp3, C(window[21]));
+    history[14] = fxp_mul32_Q32_SSE2(tmp3, C(window[32]));
+    history[ 4] = fxp_mul32_Q32_SSE2(tmp4, C(window[22]));
+    history[13] = fxp_mul32_Q32_SSE2(tmp4, C(window[31]));
+
+    history[ 5] = fxp_mul32_Q32_SSE2(tmp2, C(window[23]));
+    history[12] = fxp_mul32_Q32_SSE2(tmp2, C(window[30]));
+    history[ 6] = fxp_mul32_Q32_SSE2(tmp,  C(window[24]));
+    history[11] = fxp_mul32_Q32_SSE2(tmp,  C(window[29]));
+
+    transpose_out(vec_x4, vec);
+    transpose_out(history_x4, history);
+}
+
+#endif // PVMP3DEC_SSE2
@@ -150,9 +150,15 @@ void pvmp3_poly_phase_synthesis(tmp3dec_chan   *pChVars,
 
         pvmp3_merge_in_place_N32(inData);
 
+#if defined(PVMP3DEC_SSE2)
+        pvmp3_polyphase_filter_window_SSE2(inData,
+                                           ptr_out,
+                                           numChannels);
+#else
         pvmp3_polyphase_filter_window(inData,
                                       ptr_out,
                                       numChannels);
+#endif
 
         inData  -= SUBBANDS_NUMBER;
 
@@ -167,9 +173,15 @@ void pvmp3_poly_phase_synthesis(tmp3dec_chan   *pChVars,
 
         pvmp3_merge_in_place_N32(inData);
 
+#if defined(PVMP3DEC_SSE2)
+        pvmp3_polyphase_filter_window_SSE2(inData,
+                                           ptr_out + (numChannels << 5),
+                                           numChannels);
+#else
         pvmp3_polyphase_filter_window(inData,
                                       ptr_out + (numChannels << 5),
                                       numChannels);
+#endif
 
         ptr_out += (numChannels << 6);
 
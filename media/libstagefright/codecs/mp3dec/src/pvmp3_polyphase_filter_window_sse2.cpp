@@ -0,0 +1,245 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 1998-2009 PacketVideo
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+/*
+------------------------------------------------------------------------------
+
+   PacketVideo Corp.
+   MP3 Decoder Library
+
+   Filename: pvmp3_polyphase_filter_window_sse2.cpp
+
+------------------------------------------------------------------------------
+ INPUT AND OUTPUT DEFINITIONS
+
+Input
+    int32 *synth_buffer,    synthesis input buffer
+    int16 *outPcm,          generated output ( 32 values)
+    int32 numChannels       number of channels
+ Returns
+
+    int16 *outPcm
+
+------------------------------------------------------------------------------
+ FUNCTION DESCRIPTION
+
+    SSE2 version of pvmp3_polyphase_filter_window(), bit exact with the
+    C version. The output pairs j = 1..15 are computed four at a time, one
+    per lane; the samples of pt_1 are contiguous across j, the ones of
+    pt_2 are reversed, and the window rows (16 taps per j) are transposed
+    in registers. The last group of lanes is j = 12..15, so output 12 is
+    computed twice. The two remaining outputs are computed as in the C
+    version.
+
+------------------------------------------------------------------------------
+*/
+
+#if defined(PVMP3DEC_SSE2)
+/*----------------------------------------------------------------------------
+; INCLUDES
+----------------------------------------------------------------------------*/
+
+#include "pvmp3_polyphase_filter_window.h"
+#include "pv_mp3dec_fxd_op.h"
+#include "pv_mp3dec_fxd_op_sse2.h"
+#include "pvmp3_dec_defs.h"
+#include "pvmp3_tables.h"
+
+/*----------------------------------------------------------------------------
+; LOCAL STORE/BUFFER/POINTER DEFINITIONS
+----------------------------------------------------------------------------*/
+
+/* first j of each group of four lanes */
+static const int32 jGroup[4] = { 1, 5, 9, 12 };
+
+/*----------------------------------------------------------------------------
+; FUNCTION CODE
+----------------------------------------------------------------------------*/
+
+static inline void transpose4x4(__m128i &r0, __m128i &r1, __m128i &r2, __m128i &r3)
+{
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    r0 = _mm_unpacklo_epi64(t0, t1);
+    r1 = _mm_unpackhi_epi64(t0, t1);
+    r2 = _mm_unpacklo_epi64(t2, t3);
+    r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/*
+ *  A sum of fxp_mul32_Q32() terms, kept as the unsigned products of the even
+ *  and of the odd lanes (high words in lanes 1 and 3) and the sign
+ *  corrections of fxp_mul32_hi_SSE2(), so that the high words are only
+ *  gathered once per sum.
+ */
+typedef struct
+{
+    __m128i even;
+    __m128i odd;
+    __m128i corr;
+} mac_acc;
+
+/* a operand with its odd lanes moved down and its sign mask */
+typedef struct
+{
+    __m128i v;
+    __m128i odd;
+    __m128i sign;
+} mac_opnd;
+
+static inline mac_opnd opnd(__m128i v)
+{
+    mac_opnd x;
+
+    x.v    = v;
+    x.odd  = _mm_srli_epi64(v, 32);
+    x.sign = _mm_srai_epi32(v, 31);
+    return x;
+}
+
+static inline void acc_mac(mac_acc &s, const mac_opnd &a, const mac_opnd &b)
+{
+    s.even = _mm_add_epi32(s.even, _mm_mul_epu32(a.v, b.v));
+    s.odd  = _mm_add_epi32(s.odd,  _mm_mul_epu32(a.odd, b.odd));
+    s.corr = _mm_add_epi32(s.corr, _mm_add_epi32(_mm_and_si128(a.v, b.sign),
+                                                 _mm_and_si128(b.v, a.sign)));
+}
+
+static inline void acc_msb(mac_acc &s, const mac_opnd &a, const mac_opnd &b)
+{
+    s.even = _mm_sub_epi32(s.even, _mm_mul_epu32(a.v, b.v));
+    s.odd  = _mm_sub_epi32(s.odd,  _mm_mul_epu32(a.odd, b.odd));
+    s.corr = _mm_sub_epi32(s.corr, _mm_add_epi32(_mm_and_si128(a.v, b.sign),
+                                                 _mm_and_si128(b.v, a.sign)));
+}
+
+static inline __m128i acc_sum(const mac_acc &s)
+{
+    __m128i hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(s.even, _MM_SHUFFLE(3, 3, 3, 1)),
+                                    _mm_shuffle_epi32(s.odd,  _MM_SHUFFLE(3, 3, 3, 1)));
+
+    return _mm_sub_epi32(hi, s.corr);
+}
+
+void pvmp3_polyphase_filter_window_SSE2(int32 *synth_buffer,
+                                        int16 *outPcm,
+                                        int32 numChannels)
+{
+    int32 sum1;
+    int32 sum2;
+    const int32 *winPtr;
+    int32 i;
+    int32 g;
+    int16 pcm[8];
+
+    for (g = 0; g < 4; g++)
+    {
+        int32 j = jGroup[g];
+        /* lane l is j + l */
+        int32 *pt_1 = &synth_buffer[(SUBBANDS_NUMBER >> 1) + j];
+        int32 *pt_2 = &synth_buffer[(SUBBANDS_NUMBER >> 1) - j - 3];
+        mac_acc acc1;
+        mac_acc acc2;
+
+        acc1.even = acc1.odd = acc1.corr = _mm_setzero_si128();
+        acc2.even = acc2.odd = acc2.corr = _mm_setzero_si128();
+
+        winPtr = &pqmfSynthWin[(j - 1) << 4];
+
+        for (i = 0; i < 16; i += 4)
+        {
+            __m128i w0 = _mm_loadu_si128((const __m128i *) & winPtr[i]);
+            __m128i w1 = _mm_loadu_si128((const __m128i *) & winPtr[i + 16]);
+            __m128i w2 = _mm_loadu_si128((const __m128i *) & winPtr[i + 32]);
+            __m128i w3 = _mm_loadu_si128((const __m128i *) & winPtr[i + 48]);
+            int32 k = i >> 1;
+
+            transpose4x4(w0, w1, w2, w3);
+
+            mac_opnd win0  = opnd(w0);
+            mac_opnd win1  = opnd(w1);
+            mac_opnd win2  = opnd(w2);
+            mac_opnd win3  = opnd(w3);
+            mac_opnd temp1 = opnd(_mm_loadu_si128((__m128i *) & pt_1[SUBBANDS_NUMBER*k]));
+            mac_opnd temp3 = opnd(_mm_shuffle_epi32(
+                                      _mm_loadu_si128((__m128i *) & pt_2[SUBBANDS_NUMBER*(15 - k)]),
+                                      _MM_SHUFFLE(0, 1, 2, 3)));
+            mac_opnd temp2 = opnd(_mm_shuffle_epi32(
+                                      _mm_loadu_si128((__m128i *) & pt_2[SUBBANDS_NUMBER*(k + 1)]),
+                                      _MM_SHUFFLE(0, 1, 2, 3)));
+            mac_opnd temp4 = opnd(_mm_loadu_si128((__m128i *) & pt_1[SUBBANDS_NUMBER*(14 - k)]));
+
+            acc_mac(acc1, temp1, win0);
+            acc_mac(acc2, temp3, win0);
+            acc_mac(acc2, temp1, win1);
+            acc_msb(acc1, temp3, win1);
+            acc_mac(acc1, temp2, win2);
+            acc_msb(acc2, temp4, win2);
+            acc_mac(acc2, temp2, win3);
+            acc_mac(acc1, temp4, win3);
+        }
+
+        __m128i vsum1 = _mm_add_epi32(acc_sum(acc1), _mm_set1_epi32(0x00000020));
+        __m128i vsum2 = _mm_add_epi32(acc_sum(acc2), _mm_set1_epi32(0x00000020));
+
+        /* packs saturates the same way saturate16() does */
+        _mm_storeu_si128((__m128i *)pcm,
+                         _mm_packs_epi32(_mm_srai_epi32(vsum1, 6),
+                                         _mm_srai_epi32(vsum2, 6)));
+
+        for (i = 0; i < 4; i++)
+        {
+            int32 k = (j + i) << (numChannels - 1);
+            outPcm[k] = pcm[i];
+            outPcm[(numChannels<<5) - k] = pcm[i + 4];
+        }
+    }
+
+    winPtr = &pqmfSynthWin[((SUBBANDS_NUMBER / 2) - 1) << 4];
+
+    sum1 = 0x00000020;
+    sum2 = 0x00000020;
+
+    for (i = 16; i < HAN_SIZE + 16; i += (SUBBANDS_NUMBER << 2))
+    {
+        int32 *pt_synth = &synth_buffer[i];
+        int32 temp1 = pt_synth[ 0                ];
+        int32 temp2 = pt_synth[ SUBBANDS_NUMBER  ];
+        int32 temp3 = pt_synth[ SUBBANDS_NUMBER/2];
+
+        sum1 = fxp_mac32_Q32(sum1, temp1, winPtr[0]) ;
+        sum1 = fxp_mac32_Q32(sum1, temp2, winPtr[1]) ;
+        sum2 = fxp_mac32_Q32(sum2, temp3, winPtr[2]) ;
+        temp1 = pt_synth[ SUBBANDS_NUMBER<<1 ];
+        temp2 = pt_synth[ 3*SUBBANDS_NUMBER  ];
+        temp3 = pt_synth[ SUBBANDS_NUMBER*5/2];
+
+        sum1 = fxp_mac32_Q32(sum1, temp1, winPtr[3]) ;
+        sum1 = fxp_mac32_Q32(sum1, temp2, winPtr[4]) ;
+        sum2 = fxp_mac32_Q32(sum2, temp3, winPtr[5]) ;
+
+        winPtr += 6;
+    }
+
+    outPcm[0] = saturate16(sum1 >> 6);
+    outPcm[(SUBBANDS_NUMBER/2)<<(numChannels-1)] = saturate16(sum2 >> 6);
+}
+
+#endif // PVMP3DEC_SSE2
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// With PVMP3DEC_SSE2, checks that the SSE2 polyphase window and mdct_18
+// kernels give exactly what the C versions give on random input, and prints
+// the time each of them takes.
+//
+// Given an mp3 file, decodes it as <streams> independent streams spread
+// over <threads> threads, each thread decoding one frame of each of its
+// streams in turn the way a transcoding server would, and prints the
+// realtime factor (seconds of audio decoded per second). All streams must
+// decode to the same PCM.
+//
+// Usage: mp3dec_bench [-s streams] [-t threads] [-r repeat] [file.mp3]
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pvmp3decoder_api.h"
+#include "pvmp3_dec_defs.h"
+#include "pvmp3_polyphase_filter_window.h"
+#include "pvmp3_mdct_18.h"
+
+enum {
+    kMaxStreams = 256,
+    kMaxThreads = 32,
+    kOutputSamples = 4608,
+};
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+#if defined(PVMP3DEC_SSE2)
+
+static uint32_t gSeed = 1;
+
+static int32 random32() {
+    gSeed = gSeed * 1103515245 + 12345;
+    uint32_t hi = gSeed >> 16;
+    gSeed = gSeed * 1103515245 + 12345;
+    return (int32)((hi << 16) | (gSeed >> 16));
+}
+
+// Mostly values in the range the decoder produces, with some full scale
+// ones to exercise the wrap around of the fixed point operators.
+static int32 randomSample() {
+    int32 x = random32();
+    return (x & 0xf) ? (x >> 4) : x;
+}
+
+static int checkPolyphaseWindow(int iterations) {
+    int32 synth[HAN_SIZE + 32];
+    int16 pcm[2][64], pcmSse2[2][64];
+
+    for (int i = 0; i < iterations; ++i) {
+        int32 numChannels = 1 + (i & 1);
+        for (int k = 0; k < HAN_SIZE + 32; ++k) {
+            synth[k] = randomSample();
+        }
+        memset(pcm, 0, sizeof(pcm));
+        memset(pcmSse2, 0, sizeof(pcmSse2));
+        pvmp3_polyphase_filter_window(synth, pcm[0], numChannels);
+        pvmp3_polyphase_filter_window_SSE2(synth, pcmSse2[0], numChannels);
+        if (memcmp(pcm, pcmSse2, sizeof(pcm))) {
+            printf("polyphase window: FAILED at iteration %d\n", i);
+            return 1;
+        }
+    }
+
+    int64_t a = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        pvmp3_polyphase_filter_window(synth, pcm[0], 2);
+    }
+    int64_t b = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        pvmp3_polyphase_filter_window_SSE2(synth, pcmSse2[0], 2);
+    }
+    int64_t c = nowNs();
+    printf("polyphase window: ok, C %.1f ns SSE2 %.1f ns\n",
+           (double)(b - a) / iterations, (double)(c - b) / iterations);
+    return 0;
+}
+
+static int checkMdct18(int iterations) {
+    int32 window[36];
+    int32 vec[4 * 18], history[4 * 18];
+    int32 vecSse2[4 * 18], historySse2[4 * 18];
+
+    for (int i = 0; i < iterations; ++i) {
+        // the decoder's windows are sines in Q31
+        for (int k = 0; k < 36; ++k) {
+            window[k] = random32() & 0x7fffffff;
+        }
+        for (int k = 0; k < 4 * 18; ++k) {
+            vec[k] = randomSample();
+            history[k] = randomSample();
+        }
+        memcpy(vecSse2, vec, sizeof(vec));
+        memcpy(historySse2, history, sizeof(history));
+        for (int b = 0; b < 4; ++b) {
+            pvmp3_mdct_18(&vec[b * 18], &history[b * 18], window);
+        }
+        pvmp3_mdct_18_x4_SSE2(vecSse2, historySse2, window);
+        if (memcmp(vec, vecSse2, sizeof(vec))
+                || memcmp(history, historySse2, sizeof(history))) {
+            printf("mdct_18: FAILED at iteration %d\n", i);
+            return 1;
+        }
+    }
+
+    // the output of one call is the input of the next one
+    int64_t a = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        for (int b = 0; b < 4; ++b) {
+            pvmp3_mdct_18(&vec[b * 18], &history[b * 18], window);
+        }
+    }
+    int64_t b = nowNs();
+    for (int i = 0; i < iterations; ++i) {
+        pvmp3_mdct_18_x4_SSE2(vecSse2, historySse2, window);
+    }
+    int64_t c = nowNs();
+    printf("mdct_18 x4: ok, C %.1f ns SSE2 %.1f ns\n",
+           (double)(b - a) / iterations, (double)(c - b) / iterations);
+    return 0;
+}
+
+#endif
+
+struct Stream {
+    tPVMP3DecoderExternal config;
+    void *decoderBuf;
+    size_t offset;
+    int repeat;
+    int64_t frames;
+    int64_t samples;
+    uint32_t checksum;
+    bool done;
+};
+
+struct Shared {
+    const uint8_t *data;
+    size_t size;
+    int repeat;
+    Stream *streams;
+    int numStreams;
+    int numThreads;
+};
+
+struct Worker {
+    Shared *shared;
+    int index;
+    pthread_t thread;
+};
+
+// Decodes one frame, returns false at the end of the stream.
+static bool decodeFrame(Shared *shared, Stream *s, int16 *pcm) {
+    while (s->offset + 4 < shared->size) {
+        tPVMP3DecoderExternal *config = &s->config;
+        config->pInputBuffer = (uint8 *)shared->data + s->offset;
+        config->inputBufferCurrentLength = shared->size - s->offset;
+        config->inputBufferMaxLength = 0;
+        config->inputBufferUsedLength = 0;
+        config->pOutputBuffer = pcm;
+        config->outputFrameSize = kOutputSamples;
+
+        ERROR_CODE err = pvmp3_framedecoder(config, s->decoderBuf);
+        s->offset += (config->inputBufferUsedLength > 0)
+                ? config->inputBufferUsedLength : 1;
+        if (err != NO_DECODING_ERROR) {
+            continue;
+        }
+        for (int32 i = 0; i < config->outputFrameSize; ++i) {
+            s->checksum = s->checksum * 31 + (uint16_t)pcm[i];
+        }
+        ++s->frames;
+        s->samples += config->outputFrameSize / config->num_channels;
+        return true;
+    }
+    if (++s->repeat < shared->repeat) {
+        s->offset = 0;
+        return decodeFrame(shared, s, pcm);
+    }
+    return false;
+}
+
+static void *workerThread(void *arg) {
+    Worker *w = (Worker *)arg;
+    Shared *shared = w->shared;
+    int16 pcm[kOutputSamples];
+    bool active = true;
+
+    while (active) {
+        active = false;
+        for (int i = w->index; i < shared->numStreams; i += shared->numThreads) {
+            Stream *s = &shared->streams[i];
+            if (!s->done) {
+                s->done = !decodeFrame(shared, s, pcm);
+                active |= !s->done;
+            }
+        }
+    }
+    return NULL;
+}
+
+static int runBenchmark(const char *path, int numStreams, int numThreads,
+                        int repeat) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        printf("cannot open %s\n", path);
+        return 1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    uint8_t *data = (uint8_t *)malloc(size);
+    if (fread(data, 1, size, fp) != size) {
+        printf("cannot read %s\n", path);
+        fclose(fp);
+        free(data);
+        return 1;
+    }
+    fclose(fp);
+
+    Shared shared;
+    shared.data = data;
+    shared.size = size;
+    shared.repeat = repeat;
+    shared.streams = new Stream[numStreams];
+    shared.numStreams = numStreams;
+    shared.numThreads = numThreads;
+
+    uint32_t memRequirements = pvmp3_decoderMemRequirements();
+    for (int i = 0; i < numStreams; ++i) {
+        Stream *s = &shared.streams[i];
+        memset(s, 0, sizeof(*s));
+        s->config.equalizerType = flat;
+        s->config.crcEnabled = false;
+        s->decoderBuf = malloc(memRequirements);
+        pvmp3_InitDecoder(&s->config, s->decoderBuf);
+    }
+
+    Worker workers[kMaxThreads];
+    int64_t start = nowNs();
+    for (int i = 0; i < numThreads; ++i) {
+        workers[i].shared = &shared;
+        workers[i].index = i;
+        pthread_create(&workers[i].thread, NULL, workerThread, &workers[i]);
+    }
+    for (int i = 0; i < numThreads; ++i) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    int64_t elapsed = nowNs() - start;
+
+    int result = 0;
+    int64_t frames = 0;
+    double audioSeconds = 0;
+    for (int i = 0; i < numStreams; ++i) {
+        Stream *s = &shared.streams[i];
+        if (s->checksum != shared.streams[0].checksum
+                || s->frames != shared.streams[0].frames) {
+            printf("stream %d: decoded differently from stream 0\n", i);
+            result = 1;
+        }
+        frames += s->frames;
+        if (s->config.samplingRate > 0) {
+            audioSeconds += (double)s->samples / s->config.samplingRate;
+        }
+        free(s->decoderBuf);
+    }
+
+    double seconds = elapsed * 1e-9;
+    printf("%d streams on %d threads: %lld frames in %.3f s, %.1f us/frame, "
+           "%.1fx realtime (%.1fx per thread), checksum %08x\n",
+           numStreams, numThreads, (long long)frames, seconds,
+           frames ? elapsed * 1e-3 / frames : 0.0,
+           audioSeconds / seconds, audioSeconds / seconds / numThreads,
+           shared.streams[0].checksum);
+
+    delete[] shared.streams;
+    free(data);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int numStreams = 1;
+    int numThreads = 1;
+    int repeat = 1;
+    int res;
+
+    while ((res = getopt(argc, argv, "s:t:r:")) >= 0) {
+        switch (res) {
+            case 's':
+                numStreams = atoi(optarg);
+                break;
+            case 't':
+                numThreads = atoi(optarg);
+                break;
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            default:
+                printf("usage: %s [-s streams] [-t threads] [-r repeat] "
+                       "[file.mp3]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (numStreams < 1 || numStreams > kMaxStreams
+            || numThreads < 1 || numThreads > kMaxThreads || repeat < 1) {
+        printf("streams must be 1..%d, threads 1..%d\n",
+               kMaxStreams, kMaxThreads);
+        return 1;
+    }
+    if (numThreads > numStreams) {
+        numThreads = numStreams;
+    }
+
+    int failures = 0;
+#if defined(PVMP3DEC_SSE2)
+    failures += checkPolyphaseWindow(100000);
+    failures += checkMdct18(100000);
+#else
+    printf("built without PVMP3DEC_SSE2, no kernels to check\n");
+#endif
+
+    if (optind < argc) {
+        failures += runBenchmark(argv[optind], numStreams, numThreads, repeat);
+    }
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
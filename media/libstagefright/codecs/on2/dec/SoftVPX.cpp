@@ -38,6 +38,28 @@ static void InitOMXParams(T *params) {
     params->nVersion.s.nStep = 0;
 }
 
+// Copies a |width| x |height| plane to the tightly packed |dst| and returns
+// the end of the copied plane. libvpx frames in this tree always live in
+// decoder-owned memory, so the copy can't be avoided, but it collapses to a
+// single memcpy whenever the decoder's stride has no border.
+static uint8_t *CopyPlane(
+        uint8_t *dst, const uint8_t *src, int stride,
+        size_t width, size_t height) {
+    if ((size_t)stride == width) {
+        memcpy(dst, src, width * height);
+        return dst + width * height;
+    }
+
+    for (size_t i = 0; i < height; ++i) {
+        memcpy(dst, src, width);
+
+        src += stride;
+        dst += width;
+    }
+
+    return dst;
+}
+
 SoftVPX::SoftVPX(
         const char *name,
         const OMX_CALLBACKTYPE *callbacks,
@@ -285,30 +307,16 @@ void SoftVPX::onQueueFilled(OMX_U32 portIndex) {
             outHeader->nFlags = 0;
             outHeader->nTimeStamp = inHeader->nTimeStamp;
 
-            const uint8_t *srcLine = (const uint8_t *)img->planes[PLANE_Y];
             uint8_t *dst = outHeader->pBuffer;
-            for (size_t i = 0; i < img->d_h; ++i) {
-                memcpy(dst, srcLine, img->d_w);
-
-                srcLine += img->stride[PLANE_Y];
-                dst += img->d_w;
-            }
-
-            srcLine = (const uint8_t *)img->planes[PLANE_U];
-            for (size_t i = 0; i < img->d_h / 2; ++i) {
-                memcpy(dst, srcLine, img->d_w / 2);
-
-                srcLine += img->stride[PLANE_U];
-                dst += img->d_w / 2;
-            }
-
-            srcLine = (const uint8_t *)img->planes[PLANE_V];
-            for (size_t i = 0; i < img->d_h / 2; ++i) {
-                memcpy(dst, srcLine, img->d_w / 2);
-
-                srcLine += img->stride[PLANE_V];
-                dst += img->d_w / 2;
-            }
+            dst = CopyPlane(
+                    dst, img->planes[PLANE_Y], img->stride[PLANE_Y],
+                    img->d_w, img->d_h);
+            dst = CopyPlane(
+                    dst, img->planes[PLANE_U], img->stride[PLANE_U],
+                    img->d_w / 2, img->d_h / 2);
+            CopyPlane(
+                    dst, img->planes[PLANE_V], img->stride[PLANE_V],
+                    img->d_w / 2, img->d_h / 2);
 
             outInfo->mOwnedByUs = false;
             outQueue.erase(outQueue.begin());
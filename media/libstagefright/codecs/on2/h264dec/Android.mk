@@ -96,8 +96,18 @@ ifeq ($(ARCH_ARM_HAVE_NEON),true)
                         $(LOCAL_PATH)/./omxdl/arm_neon/vc/m4p10/api
 endif
 
+# Every x86 Android target has SSE2, the interpolation and horizontal
+# deblocking kernels of h264bsd_reconstruct.c and h264bsd_deblocking.c are
+# replaced by bit-exact SSE2 versions.
+#
+# The kernels are selected at compile time; there is no runtime dispatch.
+ifeq ($(TARGET_ARCH),x86)
+    LOCAL_CFLAGS     += -DH264DEC_SSE2
+    LOCAL_SRC_FILES  += ./source/h264bsd_reconstruct_sse2.c
+endif
+
 LOCAL_SHARED_LIBRARIES := \
-	libstagefright libstagefright_omx libstagefright_foundation libutils liblog \
+	libstagefright libstagefright_omx libstagefright_foundation libutils libcutils liblog \
 
 LOCAL_MODULE := libstagefright_soft_h264dec
 
@@ -20,11 +20,16 @@
 
 #include "SoftAVC.h"
 
+#include <cutils/properties.h>
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/cpucount.h>
 #include <media/stagefright/MediaDefs.h>
 #include <media/stagefright/MediaErrors.h>
 #include <media/IOMX.h>
-
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+#include <utils/Thread.h>
+#include <utils/Vector.h>
 
 namespace android {
 
@@ -56,6 +61,238 @@ static void InitOMXParams(T *params) {
     params->nVersion.s.nStep = 0;
 }
 
+// Worker threads that deblock the picture being decoded a few macroblock
+// rows behind the decoder, and that copy output pictures in bands together
+// with the component thread.
+struct SoftAVC::WorkerPool {
+    WorkerPool(H264SwDecInst handle, size_t numWorkers);
+    ~WorkerPool();
+
+    size_t numWorkers() const { return mWorkers.size(); }
+
+    // H264SwDecFilterCallbacks, called by the decoder on the component
+    // thread.
+    static void FilterRows(void *cookie, u32 firstRow, u32 numRows);
+    static void FilterSync(void *cookie);
+
+    void copy(uint8_t *dst, const uint8_t *src, size_t size);
+
+private:
+    enum {
+        kMinCopyBandSize = 128 * 1024,
+    };
+
+    struct Worker : public Thread {
+        Worker(WorkerPool *pool)
+            : Thread(false /* canCallJava */),
+              mPool(pool) {
+        }
+
+    private:
+        WorkerPool *mPool;
+
+        virtual bool threadLoop() {
+            return mPool->workerLoop();
+        }
+    };
+
+    H264SwDecInst mHandle;
+    Vector<sp<Worker> > mWorkers;
+
+    Mutex mLock;
+    Condition mWorkAvailable;
+    Condition mFilterDone;
+    Condition mCopyDone;
+    bool mQuit;
+
+    // Rows [mNextFilterRow, mEndFilterRow) of the current picture are
+    // waiting to be deblocked. The decoder requires them to be deblocked in
+    // order, so only one worker at a time takes them.
+    uint32_t mNextFilterRow;
+    uint32_t mEndFilterRow;
+    bool mFiltering;
+
+    uint8_t *mCopyDst;
+    const uint8_t *mCopySrc;
+    size_t mCopySize;
+    size_t mNumCopyBands;
+    size_t mNextCopyBand;
+    size_t mCopyBandsPending;
+
+    void filterRows(uint32_t firstRow, uint32_t numRows);
+    void filterSync();
+
+    bool workerLoop();
+
+    // Copies bands until none are left to claim. Called with mLock held.
+    void copyBands_l();
+
+    WorkerPool(const WorkerPool &);
+    WorkerPool &operator=(const WorkerPool &);
+};
+
+SoftAVC::WorkerPool::WorkerPool(H264SwDecInst handle, size_t numWorkers)
+    : mHandle(handle),
+      mQuit(false),
+      mNextFilterRow(0),
+      mEndFilterRow(0),
+      mFiltering(false),
+      mCopyDst(NULL),
+      mCopySrc(NULL),
+      mCopySize(0),
+      mNumCopyBands(0),
+      mNextCopyBand(0),
+      mCopyBandsPending(0) {
+    for (size_t i = 0; i < numWorkers; ++i) {
+        sp<Worker> worker = new Worker(this);
+        if (worker->run("SoftAVCWorker", ANDROID_PRIORITY_FOREGROUND) != OK) {
+            ALOGW("Failed to start decoder worker.");
+            break;
+        }
+
+        mWorkers.push(worker);
+    }
+}
+
+SoftAVC::WorkerPool::~WorkerPool() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        mQuit = true;
+        mWorkAvailable.broadcast();
+    }
+
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        mWorkers.editItemAt(i)->requestExitAndWait();
+    }
+}
+
+// static
+void SoftAVC::WorkerPool::FilterRows(
+        void *cookie, u32 firstRow, u32 numRows) {
+    static_cast<WorkerPool *>(cookie)->filterRows(firstRow, numRows);
+}
+
+// static
+void SoftAVC::WorkerPool::FilterSync(void *cookie) {
+    static_cast<WorkerPool *>(cookie)->filterSync();
+}
+
+void SoftAVC::WorkerPool::filterRows(uint32_t firstRow, uint32_t numRows) {
+    Mutex::Autolock autoLock(mLock);
+
+    // Rows of a picture are handed out back to back, and the decoder syncs
+    // before it starts over with the next picture.
+    if (mNextFilterRow == mEndFilterRow) {
+        mNextFilterRow = firstRow;
+    } else {
+        CHECK_EQ(firstRow, mEndFilterRow);
+    }
+    mEndFilterRow = firstRow + numRows;
+
+    if (!mFiltering) {
+        mWorkAvailable.signal();
+    }
+}
+
+void SoftAVC::WorkerPool::filterSync() {
+    Mutex::Autolock autoLock(mLock);
+
+    while (mNextFilterRow != mEndFilterRow) {
+        mFilterDone.wait(mLock);
+    }
+}
+
+void SoftAVC::WorkerPool::copy(
+        uint8_t *dst, const uint8_t *src, size_t size) {
+    size_t numBands = size / kMinCopyBandSize;
+    if (numBands > mWorkers.size() + 1) {
+        numBands = mWorkers.size() + 1;
+    }
+
+    if (numBands < 2) {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    Mutex::Autolock autoLock(mLock);
+
+    mCopyDst = dst;
+    mCopySrc = src;
+    mCopySize = size;
+    mNumCopyBands = numBands;
+    mNextCopyBand = 0;
+    mCopyBandsPending = numBands;
+
+    mWorkAvailable.broadcast();
+
+    copyBands_l();
+
+    while (mCopyBandsPending > 0) {
+        mCopyDone.wait(mLock);
+    }
+
+    mNumCopyBands = 0;
+    mNextCopyBand = 0;
+    mCopyDst = NULL;
+    mCopySrc = NULL;
+}
+
+bool SoftAVC::WorkerPool::workerLoop() {
+    Mutex::Autolock autoLock(mLock);
+
+    while (!mQuit && mNextCopyBand >= mNumCopyBands
+            && (mFiltering || mNextFilterRow == mEndFilterRow)) {
+        mWorkAvailable.wait(mLock);
+    }
+
+    if (mQuit) {
+        return false;
+    }
+
+    if (mNextCopyBand < mNumCopyBands) {
+        copyBands_l();
+        return true;
+    }
+
+    uint32_t firstRow = mNextFilterRow;
+    uint32_t numRows = mEndFilterRow - mNextFilterRow;
+    mFiltering = true;
+
+    mLock.unlock();
+    H264SwDecFilterRows(mHandle, firstRow, numRows);
+    mLock.lock();
+
+    mFiltering = false;
+    mNextFilterRow = firstRow + numRows;
+
+    if (mNextFilterRow == mEndFilterRow) {
+        mFilterDone.broadcast();
+    }
+
+    return true;
+}
+
+void SoftAVC::WorkerPool::copyBands_l() {
+    while (mNextCopyBand < mNumCopyBands) {
+        size_t band = mNextCopyBand++;
+
+        // Band boundaries on cache lines.
+        size_t offset = (mCopySize * band / mNumCopyBands) & ~63;
+        size_t end = (band + 1 == mNumCopyBands)
+            ? mCopySize : (mCopySize * (band + 1) / mNumCopyBands) & ~63;
+
+        mLock.unlock();
+        memcpy(mCopyDst + offset, mCopySrc + offset, end - offset);
+        mLock.lock();
+
+        if (--mCopyBandsPending == 0) {
+            mCopyDone.broadcast();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 SoftAVC::SoftAVC(
         const char *name,
         const OMX_CALLBACKTYPE *callbacks,
@@ -63,6 +300,9 @@ SoftAVC::SoftAVC(
         OMX_COMPONENTTYPE **component)
     : SimpleSoftOMXComponent(name, callbacks, appData, component),
       mHandle(NULL),
+      mWorkerPool(NULL),
+      mZeroCopy(false),
+      mNumOutputBuffers(kNumOutputBuffers),
       mInputBufferCount(0),
       mWidth(320),
       mHeight(240),
@@ -78,14 +318,24 @@ SoftAVC::SoftAVC(
       mEOSStatus(INPUT_DATA_AVAILABLE),
       mOutputPortSettingsChange(NONE),
       mSignalledError(false) {
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("media.stagefright.avcdec.zerocopy", value, NULL)
+            && (!strcmp(value, "1") || !strcasecmp(value, "true"))) {
+        mZeroCopy = true;
+    }
+
     initPorts();
     CHECK_EQ(initDecoder(), (status_t)OK);
 }
 
 SoftAVC::~SoftAVC() {
+    // Waits for rows still being deblocked by the workers.
     H264SwDecRelease(mHandle);
     mHandle = NULL;
 
+    delete mWorkerPool;
+    mWorkerPool = NULL;
+
     while (mPicToHeaderMap.size() != 0) {
         OMX_BUFFERHEADERTYPE *header = mPicToHeaderMap.editValueAt(0);
         mPicToHeaderMap.removeItemsAt(0);
@@ -155,16 +405,57 @@ void SoftAVC::initPorts() {
 
     def.nBufferSize =
         (def.format.video.nFrameWidth * def.format.video.nFrameHeight * 3) / 2;
+    if (mZeroCopy) {
+        def.nBufferSize += kPictureBufferPadding;
+    }
 
     addPort(def);
 }
 
 status_t SoftAVC::initDecoder() {
     // Force decoder to output buffers in display order.
-    if (H264SwDecInit(&mHandle, 0) == H264SWDEC_OK) {
-        return OK;
+    if (H264SwDecInit(&mHandle, 0) != H264SWDEC_OK) {
+        return UNKNOWN_ERROR;
+    }
+
+    // One thread per core up to kMaxNumThreads, "1" decodes everything
+    // on the component thread.
+    size_t numThreads = GetCPUCoreCount();
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("media.stagefright.avcdec.threads", value, NULL)
+            && atoi(value) > 0) {
+        numThreads = atoi(value);
+    }
+    if (numThreads > kMaxNumThreads) {
+        numThreads = kMaxNumThreads;
     }
-    return UNKNOWN_ERROR;
+
+    if (numThreads > 1) {
+        mWorkerPool = new WorkerPool(mHandle, numThreads - 1);
+
+        if (mWorkerPool->numWorkers() > 0) {
+            H264SwDecFilterCallbacks callbacks;
+            callbacks.pFilterRows = WorkerPool::FilterRows;
+            callbacks.pFilterSync = WorkerPool::FilterSync;
+            callbacks.pUserData = mWorkerPool;
+            CHECK_EQ(H264SwDecSetFilterCallbacks(mHandle, &callbacks),
+                     H264SWDEC_OK);
+        } else {
+            delete mWorkerPool;
+            mWorkerPool = NULL;
+        }
+    }
+
+    if (mZeroCopy) {
+        H264SwDecBufferCallbacks callbacks;
+        callbacks.pAcquireBuffer = AcquireBuffer;
+        callbacks.pReleaseBuffer = ReleaseBuffer;
+        callbacks.pUserData = this;
+        CHECK_EQ(H264SwDecSetBufferCallbacks(mHandle, &callbacks),
+                 H264SWDEC_OK);
+    }
+
+    return OK;
 }
 
 OMX_ERRORTYPE SoftAVC::internalGetParameter(
@@ -297,11 +588,10 @@ void SoftAVC::onQueueFilled(OMX_U32 portIndex) {
     }
 
     List<BufferInfo *> &inQueue = getPortQueue(kInputPortIndex);
-    List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
     H264SwDecRet ret = H264SWDEC_PIC_RDY;
     bool portSettingsChanged = false;
     while ((mEOSStatus != INPUT_DATA_AVAILABLE || !inQueue.empty())
-            && outQueue.size() == kNumOutputBuffers) {
+            && countFreeOutputBuffers() >= kNumOutputBuffers) {
 
         if (mEOSStatus == INPUT_EOS_SEEN) {
             drainAllOutputBuffers();
@@ -385,14 +675,14 @@ void SoftAVC::onQueueFilled(OMX_U32 portIndex) {
             return;
         }
 
-        if (mFirstPicture && !outQueue.empty()) {
+        if (mFirstPicture && countFreeOutputBuffers() > 0) {
             drainOneOutputBuffer(mFirstPictureId, mFirstPicture);
             delete[] mFirstPicture;
             mFirstPicture = NULL;
             mFirstPictureId = -1;
         }
 
-        while (!outQueue.empty() &&
+        while (canDrainOutputBuffer() &&
                 mHeadersDecoded &&
                 H264SwDecNextPicture(mHandle, &decodedPicture, 0)
                     == H264SWDEC_PIC_RDY) {
@@ -405,12 +695,22 @@ void SoftAVC::onQueueFilled(OMX_U32 portIndex) {
 }
 
 bool SoftAVC::handlePortSettingChangeEvent(const H264SwDecInfo *info) {
-    if (mWidth != info->picWidth || mHeight != info->picHeight) {
+    // Zero-copy needs a buffer for each picture the decoder keeps, on top
+    // of the ones the client holds.
+    size_t numOutputBuffers = kNumOutputBuffers;
+    if (mZeroCopy) {
+        numOutputBuffers += info->numPicBuffers;
+    }
+
+    if (mWidth != info->picWidth || mHeight != info->picHeight
+            || numOutputBuffers
+                > editPortInfo(kOutputPortIndex)->mDef.nBufferCountActual) {
         mWidth  = info->picWidth;
         mHeight = info->picHeight;
         mPictureSize = mWidth * mHeight * 3 / 2;
         mCropWidth = mWidth;
         mCropHeight = mHeight;
+        mNumOutputBuffers = numOutputBuffers;
         updatePortDefinitions();
         notify(OMX_EventPortSettingsChanged, 1, 0, NULL);
         mOutputPortSettingsChange = AWAITING_DISABLED;
@@ -443,21 +743,49 @@ void SoftAVC::saveFirstOutputBuffer(int32_t picId, uint8_t *data) {
     mFirstPictureId = picId;
 
     mFirstPicture = new uint8_t[mPictureSize];
-    memcpy(mFirstPicture, data, mPictureSize);
+    copyPicture(mFirstPicture, data);
+}
+
+void SoftAVC::copyPicture(uint8_t *dst, const uint8_t *src) {
+    if (mWorkerPool != NULL) {
+        mWorkerPool->copy(dst, src, mPictureSize);
+    } else {
+        memcpy(dst, src, mPictureSize);
+    }
 }
 
 void SoftAVC::drainOneOutputBuffer(int32_t picId, uint8_t* data) {
-    List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
-    BufferInfo *outInfo = *outQueue.begin();
-    outQueue.erase(outQueue.begin());
-    OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
     OMX_BUFFERHEADERTYPE *header = mPicToHeaderMap.valueFor(picId);
+    mPicToHeaderMap.removeItem(picId);
+
+    BufferInfo *outInfo;
+    ssize_t index = mOutputBuffers.indexOfKey(data);
+    if (index >= 0) {
+        // Decoded into an output buffer, which is sent as is. It may have
+        // been returned to the client by a flush since.
+        outInfo = findOutputBufferInfo(mOutputBuffers.valueAt(index).mHeader);
+        if (!outInfo->mOwnedByUs) {
+            ALOGV("dropping picture %d, its buffer was flushed", picId);
+            delete header;
+            return;
+        }
+        removeFromOutputQueue(outInfo);
+        outInfo->mHeader->nOffset = 0;
+    } else {
+        outInfo = dequeueFreeOutputBuffer();
+        if (outInfo == NULL) {
+            ALOGW("no output buffer for picture %d, dropping it", picId);
+            delete header;
+            return;
+        }
+        copyPicture(outInfo->mHeader->pBuffer + outInfo->mHeader->nOffset,
+                data);
+    }
+
+    OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
     outHeader->nTimeStamp = header->nTimeStamp;
     outHeader->nFlags = header->nFlags;
     outHeader->nFilledLen = mPictureSize;
-    memcpy(outHeader->pBuffer + outHeader->nOffset,
-            data, mPictureSize);
-    mPicToHeaderMap.removeItem(picId);
     delete header;
     outInfo->mOwnedByUs = false;
     notifyFillBufferDone(outHeader);
@@ -467,39 +795,193 @@ bool SoftAVC::drainAllOutputBuffers() {
     List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
     H264SwDecPicture decodedPicture;
 
-    while (!outQueue.empty()) {
-        BufferInfo *outInfo = *outQueue.begin();
-        outQueue.erase(outQueue.begin());
-        OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
-        if (mHeadersDecoded &&
-            H264SWDEC_PIC_RDY ==
+    while (canDrainOutputBuffer()) {
+        if (!mHeadersDecoded ||
+            H264SWDEC_PIC_RDY !=
                 H264SwDecNextPicture(mHandle, &decodedPicture, 1 /* flush */)) {
+            // All pictures are out, the buffers still with us carry EOS.
+            while (!outQueue.empty()) {
+                BufferInfo *outInfo = *outQueue.begin();
+                outQueue.erase(outQueue.begin());
+                OMX_BUFFERHEADERTYPE *outHeader = outInfo->mHeader;
+                outHeader->nTimeStamp = 0;
+                outHeader->nFilledLen = 0;
+                outHeader->nFlags = OMX_BUFFERFLAG_EOS;
+                mEOSStatus = OUTPUT_FRAMES_FLUSHED;
+
+                outInfo->mOwnedByUs = false;
+                notifyFillBufferDone(outHeader);
+            }
+            break;
+        }
 
-            int32_t picId = decodedPicture.picId;
-            CHECK(mPicToHeaderMap.indexOfKey(picId) >= 0);
+        int32_t picId = decodedPicture.picId;
+        CHECK(mPicToHeaderMap.indexOfKey(picId) >= 0);
 
-            memcpy(outHeader->pBuffer + outHeader->nOffset,
-                decodedPicture.pOutputPicture,
-                mPictureSize);
+        drainOneOutputBuffer(
+                picId, (uint8_t *)decodedPicture.pOutputPicture);
+    }
 
-            OMX_BUFFERHEADERTYPE *header = mPicToHeaderMap.valueFor(picId);
-            outHeader->nTimeStamp = header->nTimeStamp;
-            outHeader->nFlags = header->nFlags;
-            outHeader->nFilledLen = mPictureSize;
-            mPicToHeaderMap.removeItem(picId);
-            delete header;
-        } else {
-            outHeader->nTimeStamp = 0;
-            outHeader->nFilledLen = 0;
-            outHeader->nFlags = OMX_BUFFERFLAG_EOS;
-            mEOSStatus = OUTPUT_FRAMES_FLUSHED;
+    return true;
+}
+
+// static
+u8 *SoftAVC::AcquireBuffer(void *cookie) {
+    return ((SoftAVC *)cookie)->acquireOutputBuffer();
+}
+
+// static
+void SoftAVC::ReleaseBuffer(void *cookie, u8 *data) {
+    ((SoftAVC *)cookie)->releaseOutputBuffer(data);
+}
+
+uint8_t *SoftAVC::acquireOutputBuffer() {
+    // Leave the decoder short of buffers rather than the client: at least
+    // kNumOutputBuffers stay out of the decoder's hands, so that decoding
+    // never waits for buffers that only decoding could release.
+    size_t numUsedByDecoder = 0;
+    for (size_t i = 0; i < mOutputBuffers.size(); ++i) {
+        if (mOutputBuffers.valueAt(i).mUsedByDecoder) {
+            ++numUsedByDecoder;
         }
+    }
 
-        outInfo->mOwnedByUs = false;
-        notifyFillBufferDone(outHeader);
+    size_t numBuffers = editPortInfo(kOutputPortIndex)->mBuffers.size();
+    if (numUsedByDecoder + 1 + kNumOutputBuffers > numBuffers) {
+        return NULL;
     }
 
-    return true;
+    List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
+    for (List<BufferInfo *>::iterator it = outQueue.begin();
+            it != outQueue.end(); ++it) {
+        OMX_BUFFERHEADERTYPE *header = (*it)->mHeader;
+        ssize_t index = mOutputBuffers.indexOfKey(header->pBuffer);
+        if (index < 0
+                || mOutputBuffers.valueAt(index).mUsedByDecoder
+                || header->nAllocLen < mPictureSize + kPictureBufferPadding) {
+            continue;
+        }
+
+        // Stays ours until the picture is output, the queue only holds
+        // buffers that are free to fill.
+        mOutputBuffers.editValueAt(index).mUsedByDecoder = true;
+        outQueue.erase(it);
+
+        return header->pBuffer;
+    }
+
+    return NULL;
+}
+
+void SoftAVC::releaseOutputBuffer(uint8_t *data) {
+    ssize_t index = mOutputBuffers.indexOfKey(data);
+    if (index < 0) {
+        return;
+    }
+
+    OutputBuffer *buffer = &mOutputBuffers.editValueAt(index);
+    CHECK(buffer->mUsedByDecoder);
+    buffer->mUsedByDecoder = false;
+
+    // A picture that was never output, e.g. dropped on an IDR picture,
+    // leaves its buffer with us without being queued.
+    BufferInfo *info = findOutputBufferInfo(buffer->mHeader);
+    if (info->mOwnedByUs && !isOutputQueued(info)) {
+        getPortQueue(kOutputPortIndex).push_back(info);
+    }
+}
+
+SoftAVC::BufferInfo *SoftAVC::findOutputBufferInfo(
+        OMX_BUFFERHEADERTYPE *header) {
+    PortInfo *port = editPortInfo(kOutputPortIndex);
+    for (size_t i = 0; i < port->mBuffers.size(); ++i) {
+        if (port->mBuffers[i].mHeader == header) {
+            return &port->mBuffers.editItemAt(i);
+        }
+    }
+
+    TRESPASS();
+    return NULL;
+}
+
+bool SoftAVC::isOutputQueued(BufferInfo *info) {
+    List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
+    for (List<BufferInfo *>::iterator it = outQueue.begin();
+            it != outQueue.end(); ++it) {
+        if (*it == info) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SoftAVC::removeFromOutputQueue(BufferInfo *info) {
+    List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
+    for (List<BufferInfo *>::iterator it = outQueue.begin();
+            it != outQueue.end(); ++it) {
+        if (*it == info) {
+            outQueue.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SoftAVC::isUsedByDecoder(OMX_BUFFERHEADERTYPE *header) const {
+    ssize_t index = mOutputBuffers.indexOfKey(header->pBuffer);
+    return index >= 0 && mOutputBuffers.valueAt(index).mUsedByDecoder;
+}
+
+// Buffers in the output queue that may be written to. A buffer the client
+// returns while the decoder still references its picture is queued, but
+// must not be overwritten.
+size_t SoftAVC::countFreeOutputBuffers() {
+    List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
+
+    size_t numFree = 0;
+    for (List<BufferInfo *>::iterator it = outQueue.begin();
+            it != outQueue.end(); ++it) {
+        if (!isUsedByDecoder((*it)->mHeader)) {
+            ++numFree;
+        }
+    }
+
+    return numFree;
+}
+
+SoftAVC::BufferInfo *SoftAVC::dequeueFreeOutputBuffer() {
+    List<BufferInfo *> &outQueue = getPortQueue(kOutputPortIndex);
+    for (List<BufferInfo *>::iterator it = outQueue.begin();
+            it != outQueue.end(); ++it) {
+        BufferInfo *info = *it;
+        if (!isUsedByDecoder(info->mHeader)) {
+            outQueue.erase(it);
+            return info;
+        }
+    }
+
+    return NULL;
+}
+
+// Whether the next output picture can be sent: it either goes to a free
+// buffer, or it may have been decoded into a buffer that awaits it.
+bool SoftAVC::canDrainOutputBuffer() {
+    if (countFreeOutputBuffers() > 0) {
+        return true;
+    }
+
+    PortInfo *port = editPortInfo(kOutputPortIndex);
+    for (size_t i = 0; i < port->mBuffers.size(); ++i) {
+        BufferInfo *info = &port->mBuffers.editItemAt(i);
+        if (info->mOwnedByUs && isUsedByDecoder(info->mHeader)
+                && !isOutputQueued(info)) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 void SoftAVC::onPortFlushCompleted(OMX_U32 portIndex) {
@@ -530,6 +1012,37 @@ void SoftAVC::onPortEnableCompleted(OMX_U32 portIndex, bool enabled) {
     }
 }
 
+void SoftAVC::onBufferAdded(
+        OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header) {
+    // The decoder wants 16-byte aligned pictures, the size is checked
+    // whenever a picture is to be decoded into the buffer.
+    if (!mZeroCopy || portIndex != kOutputPortIndex
+            || ((uintptr_t)header->pBuffer & 15) != 0) {
+        return;
+    }
+
+    OutputBuffer buffer;
+    buffer.mHeader = header;
+    buffer.mUsedByDecoder = false;
+    mOutputBuffers.add(header->pBuffer, buffer);
+}
+
+void SoftAVC::onBufferRemoved(
+        OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header) {
+    ssize_t index = mOutputBuffers.indexOfKey(header->pBuffer);
+    if (portIndex != kOutputPortIndex || index < 0) {
+        return;
+    }
+
+    // Pictures the decoder still needs move to its own memory, all
+    // output buffers are released at once.
+    if (mOutputBuffers.valueAt(index).mUsedByDecoder) {
+        CHECK_EQ(H264SwDecDetachBuffers(mHandle), H264SWDEC_OK);
+    }
+
+    mOutputBuffers.removeItem(header->pBuffer);
+}
+
 void SoftAVC::updatePortDefinitions() {
     OMX_PARAM_PORTDEFINITIONTYPE *def = &editPortInfo(0)->mDef;
     def->format.video.nFrameWidth = mWidth;
@@ -546,6 +1059,14 @@ void SoftAVC::updatePortDefinitions() {
     def->nBufferSize =
         (def->format.video.nFrameWidth
             * def->format.video.nFrameHeight * 3) / 2;
+
+    def->nBufferCountMin = mNumOutputBuffers;
+    if (def->nBufferCountActual < def->nBufferCountMin) {
+        def->nBufferCountActual = def->nBufferCountMin;
+    }
+    if (mZeroCopy) {
+        def->nBufferSize += kPictureBufferPadding;
+    }
 }
 
 }  // namespace android
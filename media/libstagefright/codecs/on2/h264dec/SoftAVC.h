@@ -46,6 +46,10 @@ protected:
     virtual void onQueueFilled(OMX_U32 portIndex);
     virtual void onPortFlushCompleted(OMX_U32 portIndex);
     virtual void onPortEnableCompleted(OMX_U32 portIndex, bool enabled);
+    virtual void onBufferAdded(
+            OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header);
+    virtual void onBufferRemoved(
+            OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header);
 
 private:
     enum {
@@ -53,6 +57,10 @@ private:
         kOutputPortIndex  = 1,
         kNumInputBuffers  = 8,
         kNumOutputBuffers = 2,
+        kMaxNumThreads    = 4,
+
+        // The decoder may read this far past the end of a picture.
+        kPictureBufferPadding = 32,
     };
 
     enum EOSStatus {
@@ -61,8 +69,31 @@ private:
         OUTPUT_FRAMES_FLUSHED,
     };
 
+    struct WorkerPool;
+
+    // An output buffer the decoder may decode pictures into.
+    struct OutputBuffer {
+        OMX_BUFFERHEADERTYPE *mHeader;
+
+        // Holds a picture the decoder still uses for reference or has
+        // not output yet.
+        bool mUsedByDecoder;
+    };
+
     void *mHandle;
 
+    // Deblocks behind the decoder and copies output pictures, NULL when
+    // decoding single-threaded.
+    WorkerPool *mWorkerPool;
+
+    // Decode into the client's output buffers instead of copying every
+    // output picture, set by media.stagefright.avcdec.zerocopy.
+    bool mZeroCopy;
+
+    // Output buffers suitable for zero-copy decoding, keyed by pBuffer.
+    KeyedVector<uint8_t *, OutputBuffer> mOutputBuffers;
+    size_t mNumOutputBuffers;
+
     size_t mInputBufferCount;
 
     uint32_t mWidth, mHeight, mPictureSize;
@@ -96,6 +127,21 @@ private:
     bool drainAllOutputBuffers();
     void drainOneOutputBuffer(int32_t picId, uint8_t *data);
     void saveFirstOutputBuffer(int32_t pidId, uint8_t *data);
+    void copyPicture(uint8_t *dst, const uint8_t *src);
+
+    // H264SwDecBufferCallbacks.
+    static u8 *AcquireBuffer(void *cookie);
+    static void ReleaseBuffer(void *cookie, u8 *data);
+
+    uint8_t *acquireOutputBuffer();
+    void releaseOutputBuffer(uint8_t *data);
+    BufferInfo *findOutputBufferInfo(OMX_BUFFERHEADERTYPE *header);
+    bool isOutputQueued(BufferInfo *info);
+    bool removeFromOutputQueue(BufferInfo *info);
+    bool isUsedByDecoder(OMX_BUFFERHEADERTYPE *header) const;
+    size_t countFreeOutputBuffers();
+    BufferInfo *dequeueFreeOutputBuffer();
+    bool canDrainOutputBuffer();
     bool handleCropRectEvent(const CropParams* crop);
     bool handlePortSettingChangeEvent(const H264SwDecInfo *info);
 
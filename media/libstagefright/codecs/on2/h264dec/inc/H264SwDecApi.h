@@ -126,8 +126,39 @@ extern "C"
         u32 parHeight;
         u32 croppingFlag;
         CropParams cropParams;
+        u32 numPicBuffers;      /* Max number of pictures the decoder keeps
+                                   for reference and display reordering,
+                                   current picture included */
     } H264SwDecInfo;
 
+    /* Deblocking on application threads. When set, the decoder hands
+     * macroblock rows of the picture being decoded to pFilterRows as soon
+     * as they can be filtered, and keeps decoding the rest of the picture.
+     * The application filters them by calling H264SwDecFilterRows, on any
+     * thread, in the order the rows were handed out. pFilterSync shall
+     * return when all rows handed out so far have been filtered. */
+    typedef struct
+    {
+        void (*pFilterRows)(void *pUserData, u32 firstRow, u32 numRows);
+        void (*pFilterSync)(void *pUserData);
+        void *pUserData;
+    } H264SwDecFilterCallbacks;
+
+    /* Picture memory from the application. When set, the decoder asks
+     * pAcquireBuffer for the memory of each picture it decodes and keeps
+     * the buffer until the picture is neither used for reference nor
+     * waiting for output, then hands it back through pReleaseBuffer.
+     * Buffers shall be 16-byte aligned and hold picWidth*picHeight*3/2 + 32
+     * bytes. pAcquireBuffer may return NULL, the picture is then decoded
+     * to the decoder's own memory. Pictures from H264SwDecNextPicture
+     * point to the buffer they were decoded to. */
+    typedef struct
+    {
+        u8 *(*pAcquireBuffer)(void *pUserData);
+        void (*pReleaseBuffer)(void *pUserData, u8 *pBuffer);
+        void *pUserData;
+    } H264SwDecBufferCallbacks;
+
     /* Version information */
     typedef struct
     {
@@ -157,6 +188,16 @@ extern "C"
 
     H264SwDecApiVersion H264SwDecGetAPIVersion(void);
 
+    H264SwDecRet H264SwDecSetFilterCallbacks(H264SwDecInst decInst,
+                                 const H264SwDecFilterCallbacks *pCallbacks);
+
+    void H264SwDecFilterRows(H264SwDecInst decInst, u32 firstRow, u32 numRows);
+
+    H264SwDecRet H264SwDecSetBufferCallbacks(H264SwDecInst decInst,
+                                 const H264SwDecBufferCallbacks *pCallbacks);
+
+    H264SwDecRet H264SwDecDetachBuffers(H264SwDecInst decInst);
+
     /* function prototype for API trace */
     void H264SwDecTrace(char *);
 
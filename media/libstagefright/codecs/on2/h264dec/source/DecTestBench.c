@@ -18,6 +18,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
+#include <pthread.h>
 
 /*------------------------------------------------------------------------------
     Module defines
@@ -40,6 +42,45 @@ void WriteOutput(char *filename, u8 *data, u32 picSize);
 u32 NextPacket(u8 **pStrm);
 u32 CropPicture(u8 *pOutImage, u8 *pInImage,
     u32 picWidth, u32 picHeight, CropParams *pCropParams);
+static long long GetTimeUs(void);
+
+/* Deblocking thread for -D: filters rows handed out by the decoder in the
+ * order they were handed out */
+typedef struct
+{
+    H264SwDecInst decInst;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    u32 nextRow;    /* first row not filtered yet */
+    u32 endRow;     /* end of the rows handed out */
+    u32 quit;
+} FilterThread;
+
+static FilterThread filterThread;
+
+static void *FilterThreadMain(void *arg);
+static void FilterRows(void *pUserData, u32 firstRow, u32 numRows);
+static void FilterSync(void *pUserData);
+
+/* Picture buffers for -B: the decoder decodes to these instead of its own
+ * memory */
+typedef struct
+{
+    u8 **pBuffers;
+    u32 *inUse;
+    u32 numBuffers;
+    u32 bufferSize;
+    u32 numAcquired;    /* pictures decoded to the buffers */
+    u32 numMissed;      /* pictures decoded to decoder memory */
+} BufferPool;
+
+static BufferPool bufferPool;
+
+static u32 AllocateBufferPool(BufferPool *pPool, u32 numBuffers, u32 size);
+static void FreeBufferPool(BufferPool *pPool);
+static u8 *AcquireBuffer(void *pUserData);
+static void ReleaseBuffer(void *pUserData, u8 *pBuffer);
 
 /* Global variables for stream handling */
 u8 *streamStop = NULL;
@@ -102,6 +143,13 @@ int main(int argc, char **argv)
     u32 numErrors = 0;
     u32 cropDisplay = 0;
     u32 disableOutputReordering = 0;
+    u32 threadedDeblocking = 0;
+    H264SwDecFilterCallbacks filterCallbacks;
+    u32 appBuffers = 0;
+    u32 numAppBuffers = 0;
+    H264SwDecBufferCallbacks bufferCallbacks;
+    long long decodeTimeUs = 0;
+    long long startUs;
 
     FILE *finput;
 
@@ -123,7 +171,7 @@ int main(int argc, char **argv)
     if (argc < 2)
     {
         DEBUG((
-            "Usage: %s [-Nn] [-Ooutfile] [-P] [-U] [-C] [-R] [-T] file.h264\n",
+            "Usage: %s [-Nn] [-Ooutfile] [-P] [-U] [-C] [-R] [-D] [-B[n]] [-T] file.h264\n",
             argv[0]));
         DEBUG(("\t-Nn forces decoding to stop after n pictures\n"));
 #if defined(_NO_OUT)
@@ -136,6 +184,9 @@ int main(int argc, char **argv)
         DEBUG(("\t-U NAL unit stream mode\n"));
         DEBUG(("\t-C display cropped image (default decoded image)\n"));
         DEBUG(("\t-R disable DPB output reordering\n"));
+        DEBUG(("\t-D deblock on a separate thread while decoding\n"));
+        DEBUG(("\t-B[n] decode to n application picture buffers (default as\n"
+               "\t      many as the stream needs)\n"));
         DEBUG(("\t-T to print tag name and exit\n"));
         return 0;
     }
@@ -167,6 +218,15 @@ int main(int argc, char **argv)
         {
             disableOutputReordering = 1;
         }
+        else if ( strcmp(argv[i], "-D") == 0 )
+        {
+            threadedDeblocking = 1;
+        }
+        else if ( strncmp(argv[i], "-B", 2) == 0 )
+        {
+            appBuffers = 1;
+            numAppBuffers = (u32)atoi(argv[i]+2);
+        }
     }
 
     /* open input file for reading, file name given by user. If file open
@@ -204,6 +264,36 @@ int main(int argc, char **argv)
         return -1;
     }
 
+    /* start deblocking thread, output shall be identical to the one
+     * produced without -D */
+    if (threadedDeblocking)
+    {
+        filterThread.decInst = decInst;
+        pthread_mutex_init(&filterThread.mutex, NULL);
+        pthread_cond_init(&filterThread.cond, NULL);
+        if (pthread_create(&filterThread.thread, NULL, FilterThreadMain,
+                &filterThread) != 0)
+        {
+            DEBUG(("UNABLE TO START DEBLOCKING THREAD\n"));
+            return -1;
+        }
+
+        filterCallbacks.pFilterRows = FilterRows;
+        filterCallbacks.pFilterSync = FilterSync;
+        filterCallbacks.pUserData = &filterThread;
+        H264SwDecSetFilterCallbacks(decInst, &filterCallbacks);
+    }
+
+    /* buffers are allocated when the picture size is known, output shall
+     * be identical to the one produced without -B */
+    if (appBuffers)
+    {
+        bufferCallbacks.pAcquireBuffer = AcquireBuffer;
+        bufferCallbacks.pReleaseBuffer = ReleaseBuffer;
+        bufferCallbacks.pUserData = &bufferPool;
+        H264SwDecSetBufferCallbacks(decInst, &bufferCallbacks);
+    }
+
     /* initialize H264SwDecDecode() input structure */
     streamStop = byteStrmStart + strmLen;
     decInput.pStream = byteStrmStart;
@@ -222,8 +312,11 @@ int main(int argc, char **argv)
         /* Picture ID is the picture number in decoding order */
         decInput.picId = picDecodeNumber;
 
-        /* call API function to perform decoding */
+        /* call API function to perform decoding, only the time spent in
+         * the decoder is counted for the decoding speed */
+        startUs = GetTimeUs();
         ret = H264SwDecDecode(decInst, &decInput, &decOutput);
+        decodeTimeUs += GetTimeUs() - startUs;
 
         switch(ret)
         {
@@ -267,6 +360,19 @@ int main(int argc, char **argv)
                 DEBUG(("videoRange %d, matrixCoefficients %d\n",
                     decInfo.videoRange, decInfo.matrixCoefficients));
 
+                /* new buffers for the new picture size, pictures still
+                 * held in the old ones are moved to decoder memory */
+                if (appBuffers)
+                {
+                    H264SwDecDetachBuffers(decInst);
+                    FreeBufferPool(&bufferPool);
+                    if (AllocateBufferPool(&bufferPool,
+                            numAppBuffers ? numAppBuffers :
+                                decInfo.numPicBuffers,
+                            decInfo.picWidth * decInfo.picHeight * 3 / 2 + 32))
+                        return -1;
+                }
+
                 /* update H264SwDecDecode() input structure, number of bytes
                  * "consumed" is computed as difference between the new stream
                  * pointer and old stream pointer */
@@ -411,6 +517,27 @@ int main(int argc, char **argv)
     /* release decoder instance */
     H264SwDecRelease(decInst);
 
+    if (appBuffers)
+    {
+        DEBUG(("%d pictures decoded to application buffers, %d to decoder "
+               "memory\n", bufferPool.numAcquired, bufferPool.numMissed));
+        for (i = 0; i < bufferPool.numBuffers; i++)
+        {
+            if (bufferPool.inUse[i])
+                DEBUG(("APPLICATION BUFFER %d NOT RELEASED\n", i));
+        }
+        FreeBufferPool(&bufferPool);
+    }
+
+    if (threadedDeblocking)
+    {
+        pthread_mutex_lock(&filterThread.mutex);
+        filterThread.quit = 1;
+        pthread_cond_broadcast(&filterThread.cond);
+        pthread_mutex_unlock(&filterThread.mutex);
+        pthread_join(filterThread.thread, NULL);
+    }
+
     if (foutput)
         fclose(foutput);
 
@@ -421,6 +548,9 @@ int main(int argc, char **argv)
     DEBUG(("Output file: %s\n", outFileName));
 
     DEBUG(("DECODING DONE\n"));
+    DEBUG(("Decoded %d pictures in %lld ms, %.2f fps\n",
+        picDecodeNumber - 1, decodeTimeUs / 1000,
+        decodeTimeUs ? (picDecodeNumber - 1) * 1E6 / decodeTimeUs : 0.0));
     if (numErrors || picDecodeNumber == 1)
     {
         DEBUG(("ERRORS FOUND\n"));
@@ -759,3 +889,207 @@ void H264SwDecMemset(void *ptr, i32 value, u32 count)
     memset(ptr, value, count);
 }
 
+
+/*------------------------------------------------------------------------------
+
+    Function name:  GetTimeUs
+
+    Purpose:
+        Returns the current time in microseconds, used for measuring the
+        decoding speed.
+
+------------------------------------------------------------------------------*/
+long long GetTimeUs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (long long)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/*------------------------------------------------------------------------------
+
+    Function name:  FilterThreadMain
+
+    Purpose:
+        Deblocking thread of the -D option, filters the rows handed out by
+        the decoder until told to quit.
+
+------------------------------------------------------------------------------*/
+void *FilterThreadMain(void *arg)
+{
+    FilterThread *pThread = (FilterThread *)arg;
+    u32 firstRow, numRows;
+
+    pthread_mutex_lock(&pThread->mutex);
+    for (;;)
+    {
+        while (!pThread->quit && pThread->nextRow == pThread->endRow)
+            pthread_cond_wait(&pThread->cond, &pThread->mutex);
+
+        if (pThread->quit)
+            break;
+
+        firstRow = pThread->nextRow;
+        numRows = pThread->endRow - firstRow;
+
+        pthread_mutex_unlock(&pThread->mutex);
+        H264SwDecFilterRows(pThread->decInst, firstRow, numRows);
+        pthread_mutex_lock(&pThread->mutex);
+
+        pThread->nextRow = firstRow + numRows;
+        pthread_cond_broadcast(&pThread->cond);
+    }
+    pthread_mutex_unlock(&pThread->mutex);
+
+    return NULL;
+}
+
+/*------------------------------------------------------------------------------
+
+    Function name:  FilterRows
+
+    Purpose:
+        pFilterRows callback of the decoder, queues rows for the deblocking
+        thread.
+
+------------------------------------------------------------------------------*/
+void FilterRows(void *pUserData, u32 firstRow, u32 numRows)
+{
+    FilterThread *pThread = (FilterThread *)pUserData;
+
+    pthread_mutex_lock(&pThread->mutex);
+    /* previous rows are all filtered when the decoder starts handing out
+     * rows of a new picture */
+    if (pThread->nextRow == pThread->endRow)
+        pThread->nextRow = firstRow;
+    pThread->endRow = firstRow + numRows;
+    pthread_cond_broadcast(&pThread->cond);
+    pthread_mutex_unlock(&pThread->mutex);
+}
+
+/*------------------------------------------------------------------------------
+
+    Function name:  FilterSync
+
+    Purpose:
+        pFilterSync callback of the decoder, waits until the deblocking
+        thread has filtered all rows queued so far.
+
+------------------------------------------------------------------------------*/
+void FilterSync(void *pUserData)
+{
+    FilterThread *pThread = (FilterThread *)pUserData;
+
+    pthread_mutex_lock(&pThread->mutex);
+    while (pThread->nextRow != pThread->endRow)
+        pthread_cond_wait(&pThread->cond, &pThread->mutex);
+    pthread_mutex_unlock(&pThread->mutex);
+}
+
+/*------------------------------------------------------------------------------
+
+    Function name:  AllocateBufferPool
+
+    Purpose:
+        Allocate 16-byte aligned picture buffers for the -B option.
+
+------------------------------------------------------------------------------*/
+u32 AllocateBufferPool(BufferPool *pPool, u32 numBuffers, u32 size)
+{
+    u32 i;
+
+    pPool->pBuffers = (u8 **)calloc(numBuffers, sizeof(u8 *));
+    pPool->inUse = (u32 *)calloc(numBuffers, sizeof(u32));
+    if (pPool->pBuffers == NULL || pPool->inUse == NULL)
+        return 1;
+
+    pPool->numBuffers = numBuffers;
+    pPool->bufferSize = size;
+    for (i = 0; i < numBuffers; i++)
+    {
+        if (posix_memalign((void **)&pPool->pBuffers[i], 16, size) != 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------------------------------------
+
+    Function name:  FreeBufferPool
+
+    Purpose:
+        Free the picture buffers of the -B option, none may be held by the
+        decoder.
+
+------------------------------------------------------------------------------*/
+void FreeBufferPool(BufferPool *pPool)
+{
+    u32 i;
+
+    for (i = 0; i < pPool->numBuffers; i++)
+        free(pPool->pBuffers[i]);
+
+    free(pPool->pBuffers);
+    free(pPool->inUse);
+    pPool->pBuffers = NULL;
+    pPool->inUse = NULL;
+    pPool->numBuffers = 0;
+}
+
+/*------------------------------------------------------------------------------
+
+    Function name:  AcquireBuffer
+
+    Purpose:
+        pAcquireBuffer callback of the decoder, returns a free picture
+        buffer or NULL if all are held by the decoder.
+
+------------------------------------------------------------------------------*/
+u8 *AcquireBuffer(void *pUserData)
+{
+    BufferPool *pPool = (BufferPool *)pUserData;
+    u32 i;
+
+    for (i = 0; i < pPool->numBuffers; i++)
+    {
+        if (!pPool->inUse[i])
+        {
+            pPool->inUse[i] = 1;
+            pPool->numAcquired++;
+            return pPool->pBuffers[i];
+        }
+    }
+
+    pPool->numMissed++;
+
+    return NULL;
+}
+
+/*------------------------------------------------------------------------------
+
+    Function name:  ReleaseBuffer
+
+    Purpose:
+        pReleaseBuffer callback of the decoder, marks the buffer free.
+
+------------------------------------------------------------------------------*/
+void ReleaseBuffer(void *pUserData, u8 *pBuffer)
+{
+    BufferPool *pPool = (BufferPool *)pUserData;
+    u32 i;
+
+    for (i = 0; i < pPool->numBuffers; i++)
+    {
+        if (pPool->pBuffers[i] == pBuffer)
+        {
+            if (!pPool->inUse[i])
+                DEBUG(("BUFFER %p RELEASED TWICE\n", (void *)pBuffer));
+            pPool->inUse[i] = 0;
+            return;
+        }
+    }
+
+    DEBUG(("RELEASE OF UNKNOWN BUFFER %p\n", (void *)pBuffer));
+}
@@ -29,6 +29,10 @@
           H264SwDecDecode
           H264SwDecGetAPIVersion
           H264SwDecNextPicture
+          H264SwDecSetFilterCallbacks
+          H264SwDecFilterRows
+          H264SwDecSetBufferCallbacks
+          H264SwDecDetachBuffers
 
 ------------------------------------------------------------------------------*/
 
@@ -41,13 +45,14 @@
 #include "H264SwDecApi.h"
 #include "h264bsd_decoder.h"
 #include "h264bsd_util.h"
+#include "h264bsd_deblocking.h"
 
 /*------------------------------------------------------------------------------
        Version Information
 ------------------------------------------------------------------------------*/
 
 #define H264SWDEC_MAJOR_VERSION 2
-#define H264SWDEC_MINOR_VERSION 3
+#define H264SWDEC_MINOR_VERSION 5
 
 /*------------------------------------------------------------------------------
     2. External compiler flags
@@ -246,6 +251,9 @@ H264SwDecRet H264SwDecGetInfo(H264SwDecInst decInst, H264SwDecInfo *pDecInfo)
     /* profile */
     pDecInfo->profile = h264bsdProfile(pStorage);
 
+    /* reference and reordering pictures + the one being decoded */
+    pDecInfo->numPicBuffers = h264bsdMaxDpbSize(pStorage) + 1;
+
     DEC_API_TRC("H264SwDecGetInfo# OK");
 
     return(H264SWDEC_OK);
@@ -292,6 +300,7 @@ void H264SwDecRelease(H264SwDecInst decInst)
     DEC_API_TRC(pDecCont->str);
 #endif
 
+    h264bsdSyncFilter(&pDecCont->storage);
     h264bsdShutdown(&pDecCont->storage);
 
     H264SwDecFree(pDecCont);
@@ -564,4 +573,220 @@ H264SwDecRet H264SwDecNextPicture(H264SwDecInst decInst,
 
 }
 
+/*------------------------------------------------------------------------------
+
+    Function: H264SwDecSetFilterCallbacks
+
+        Functional description:
+            Set functions through which the decoder hands deblocking of the
+            picture being decoded to the application, or go back to
+            deblocking each picture on the calling thread if pCallbacks is
+            NULL. Rows already handed out are waited for; the change takes
+            effect from the next picture on.
+
+        Input:
+            decInst     decoder instance
+            pCallbacks  pointer to callback functions or NULL
+
+        Output:
+            none
+
+        Returns:
+            H264SWDEC_OK            success
+            H264SWDEC_PARAM_ERR     invalid parameters
+
+------------------------------------------------------------------------------*/
+
+H264SwDecRet H264SwDecSetFilterCallbacks(H264SwDecInst decInst,
+    const H264SwDecFilterCallbacks *pCallbacks)
+{
+
+    storage_t *pStorage;
+
+    DEC_API_TRC("H264SwDecSetFilterCallbacks#");
+
+    if (decInst == NULL || (pCallbacks != NULL &&
+        (pCallbacks->pFilterRows == NULL || pCallbacks->pFilterSync == NULL)))
+    {
+        DEC_API_TRC("H264SwDecSetFilterCallbacks# ERROR: invalid parameters");
+        return(H264SWDEC_PARAM_ERR);
+    }
+
+    pStorage = &(((decContainer_t *)decInst)->storage);
+
+    h264bsdSyncFilter(pStorage);
+
+    if (pCallbacks)
+    {
+        pStorage->filterRows = pCallbacks->pFilterRows;
+        pStorage->filterSync = pCallbacks->pFilterSync;
+        pStorage->filterUserData = pCallbacks->pUserData;
+    }
+    else
+    {
+        pStorage->filterRows = NULL;
+        pStorage->filterSync = NULL;
+        pStorage->filterUserData = NULL;
+    }
+
+    DEC_API_TRC("H264SwDecSetFilterCallbacks# OK");
+
+    return(H264SWDEC_OK);
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: H264SwDecFilterRows
+
+        Functional description:
+            Deblock macroblock rows handed to the application through the
+            pFilterRows callback. May be called on any thread, but calls for
+            one decoder instance must not overlap and must follow the order
+            in which the rows were handed out.
+
+        Input:
+            decInst     decoder instance
+            firstRow    first row, as given to pFilterRows
+            numRows     number of rows, as given to pFilterRows
+
+        Output:
+            none
+
+        Returns:
+            none
+
+------------------------------------------------------------------------------*/
+
+void H264SwDecFilterRows(H264SwDecInst decInst, u32 firstRow, u32 numRows)
+{
+
+    storage_t *pStorage;
+
+    ASSERT(decInst);
+
+    pStorage = &(((decContainer_t *)decInst)->storage);
+
+    h264bsdFilterRows(pStorage->currImage, pStorage->mb, firstRow, numRows);
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: H264SwDecSetBufferCallbacks
+
+        Functional description:
+            Set functions through which the decoder obtains picture memory
+            from the application, or go back to the decoder's own memory if
+            pCallbacks is NULL. Pictures still in application buffers are
+            moved to the decoder's memory before the change, see
+            H264SwDecDetachBuffers.
+
+        Input:
+            decInst     decoder instance
+            pCallbacks  pointer to callback functions or NULL
+
+        Output:
+            none
+
+        Returns:
+            H264SWDEC_OK            success
+            H264SWDEC_PARAM_ERR     invalid parameters
+
+------------------------------------------------------------------------------*/
+
+H264SwDecRet H264SwDecSetBufferCallbacks(H264SwDecInst decInst,
+    const H264SwDecBufferCallbacks *pCallbacks)
+{
+
+    dpbStorage_t *dpb;
+
+    DEC_API_TRC("H264SwDecSetBufferCallbacks#");
+
+    if (decInst == NULL || (pCallbacks != NULL &&
+        (pCallbacks->pAcquireBuffer == NULL ||
+         pCallbacks->pReleaseBuffer == NULL)))
+    {
+        DEC_API_TRC("H264SwDecSetBufferCallbacks# ERROR: invalid parameters");
+        return(H264SWDEC_PARAM_ERR);
+    }
+
+    (void)H264SwDecDetachBuffers(decInst);
+
+    dpb = ((decContainer_t *)decInst)->storage.dpb;
+
+    if (pCallbacks)
+    {
+        dpb->acquireBuffer = pCallbacks->pAcquireBuffer;
+        dpb->releaseBuffer = pCallbacks->pReleaseBuffer;
+        dpb->bufferUserData = pCallbacks->pUserData;
+    }
+    else
+    {
+        dpb->acquireBuffer = NULL;
+        dpb->releaseBuffer = NULL;
+        dpb->bufferUserData = NULL;
+    }
+
+    DEC_API_TRC("H264SwDecSetBufferCallbacks# OK");
+
+    return(H264SWDEC_OK);
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: H264SwDecDetachBuffers
+
+        Functional description:
+            Release all buffers obtained through pAcquireBuffer. Pictures
+            still needed for reference or output, and a picture whose
+            decoding is not finished, are copied to the decoder's own memory
+            first. Used e.g. when the application is about to free its
+            buffers. New buffers are acquired again from the next picture on.
+
+        Input:
+            decInst     decoder instance
+
+        Output:
+            none
+
+        Returns:
+            H264SWDEC_OK            success
+            H264SWDEC_PARAM_ERR     invalid parameters
+
+------------------------------------------------------------------------------*/
+
+H264SwDecRet H264SwDecDetachBuffers(H264SwDecInst decInst)
+{
+
+    storage_t *pStorage;
+    u32 currentInDpb;
+
+    DEC_API_TRC("H264SwDecDetachBuffers#");
+
+    if (decInst == NULL)
+    {
+        DEC_API_TRC("H264SwDecDetachBuffers# ERROR: decInst is NULL");
+        return(H264SWDEC_PARAM_ERR);
+    }
+
+    pStorage = &(((decContainer_t *)decInst)->storage);
+
+    /* rows of the current picture may be under deblocking */
+    h264bsdSyncFilter(pStorage);
+
+    currentInDpb = pStorage->dpb->currentOut != NULL &&
+        pStorage->currImage->data == pStorage->dpb->currentOut->data;
+
+    h264bsdDpbDetachBuffers(pStorage->dpb);
+
+    if (currentInDpb)
+        pStorage->currImage->data = pStorage->dpb->currentOut->data;
+
+    DEC_API_TRC("H264SwDecDetachBuffers# OK");
+
+    return(H264SWDEC_OK);
+
+}
 
@@ -23,7 +23,7 @@
      3. Module defines
      4. Local function prototypes
      5. Functions
-          h264bsdFilterPicture
+          h264bsdFilterRows
           FilterVerLumaEdge
           FilterHorLumaEdge
           FilterHorLuma
@@ -59,6 +59,10 @@
 #include "armVC.h"
 #endif /* H264DEC_OMXDL */
 
+#ifdef H264DEC_SSE2
+#include <emmintrin.h>
+#endif /* H264DEC_SSE2 */
+
 /*------------------------------------------------------------------------------
     2. External compiler flags
 --------------------------------------------------------------------------------
@@ -190,6 +194,16 @@ static void FilterHorChromaEdge( u8 *data, u32 bS, edgeThreshold_t *thresholds,
 static void FilterHorChroma( u8 *data, u32 bS, edgeThreshold_t *thresholds,
   i32 imageWidth);
 
+#ifdef H264DEC_SSE2
+static __inline __m128i LoadRow8(const u8 *data);
+static __inline void StoreRow8(u8 *data, __m128i row);
+static __inline __m128i AbsLess(__m128i a, __m128i b, __m128i limit);
+static __inline __m128i Select(__m128i mask, __m128i a, __m128i b);
+static __inline __m128i Clip3(__m128i limit, __m128i x);
+static void FilterHorLuma8( u8 *data, u32 bS, edgeThreshold_t *thresholds,
+        i32 imageWidth);
+#endif /* H264DEC_SSE2 */
+
 static void GetLumaEdgeThresholds(
   edgeThreshold_t *thresholds,
   mbStorage_t *mb,
@@ -548,32 +562,43 @@ u32 EdgeBoundaryStrengthLeft(mbStorage_t *mb1, mbStorage_t *mb2)
 #endif /* H264DEC_OMXDL */
 /*------------------------------------------------------------------------------
 
-    Function: h264bsdFilterPicture
+    Function: h264bsdFilterRows
 
         Functional description:
-          Perform deblocking filtering for a picture. Filter does not copy
-          the original picture anywhere but filtering is performed directly
-          on the original image. Parameters controlling the filtering process
+          Perform deblocking filtering for macroblock rows firstRow ...
+          firstRow + numRows - 1 of a picture. Filter does not copy the
+          original picture anywhere but filtering is performed directly on
+          the original image. Parameters controlling the filtering process
           are computed based on information in macroblock structures of the
           filtered macroblock, macroblock above and macroblock on the left of
           the filtered one.
 
+          Rows have to be filtered in top-to-bottom order. Filtering of a
+          row modifies the row itself and the three bottom lines of the row
+          above it, so a row can be filtered as soon as all macroblocks of
+          the next row have been reconstructed, while the decoder is still
+          working on the rest of the picture (see h264bsdFilterDecodedRows).
+
         Inputs:
           image         pointer to image to be filtered
           mb            pointer to macroblock data structure of the top-left
                         macroblock of the picture
+          firstRow      first macroblock row to be filtered
+          numRows       number of macroblock rows to be filtered
 
         Outputs:
-          image         filtered image stored here
+          image         filtered rows stored here
 
         Returns:
           none
 
 ------------------------------------------------------------------------------*/
 #ifndef H264DEC_OMXDL
-void h264bsdFilterPicture(
+void h264bsdFilterRows(
   image_t *image,
-  mbStorage_t *mb)
+  mbStorage_t *mb,
+  u32 firstRow,
+  u32 numRows)
 {
 
 /* Variables */
@@ -593,14 +618,15 @@ void h264bsdFilterPicture(
     ASSERT(image->data);
     ASSERT(image->width);
     ASSERT(image->height);
+    ASSERT(firstRow + numRows <= image->height);
 
     picWidthInMbs = image->width;
     data = image->data;
     picSizeInMbs = picWidthInMbs * image->height;
 
-    pMb = mb;
+    pMb = mb + firstRow * picWidthInMbs;
 
-    for (mbRow = 0, mbCol = 0; mbRow < image->height; pMb++)
+    for (mbRow = firstRow, mbCol = 0; mbRow < firstRow + numRows; pMb++)
     {
         flags = GetMbFilteringFlags(pMb);
 
@@ -817,6 +843,7 @@ void FilterHorLumaEdge(
     }
 }
 
+#ifndef H264DEC_SSE2
 /*------------------------------------------------------------------------------
 
     Function: FilterHorLuma
@@ -930,6 +957,239 @@ void FilterHorLuma(
     }
 
 }
+#else /* H264DEC_SSE2 */
+
+/*------------------------------------------------------------------------------
+
+    Function: LoadRow8
+
+        Functional description:
+            Load eight pels zero-extended to 16 bits.
+
+------------------------------------------------------------------------------*/
+__m128i LoadRow8(const u8 *data)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)data),
+        _mm_setzero_si128());
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: StoreRow8
+
+        Functional description:
+            Saturate eight 16-bit values to 8 bits and store them.
+
+------------------------------------------------------------------------------*/
+void StoreRow8(u8 *data, __m128i row)
+{
+    _mm_storel_epi64((__m128i *)data, _mm_packus_epi16(row, row));
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: AbsLess
+
+        Functional description:
+            Lane mask of |a - b| < limit.
+
+------------------------------------------------------------------------------*/
+__m128i AbsLess(__m128i a, __m128i b, __m128i limit)
+{
+    __m128i diff = _mm_max_epi16(_mm_sub_epi16(a, b), _mm_sub_epi16(b, a));
+    return _mm_cmplt_epi16(diff, limit);
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: Select
+
+        Functional description:
+            Per lane mask ? a : b.
+
+------------------------------------------------------------------------------*/
+__m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: Clip3
+
+        Functional description:
+            Clip each lane of x to [-limit, limit].
+
+------------------------------------------------------------------------------*/
+__m128i Clip3(__m128i limit, __m128i x)
+{
+    return _mm_min_epi16(_mm_max_epi16(x,
+        _mm_sub_epi16(_mm_setzero_si128(), limit)), limit);
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: FilterHorLuma8
+
+        Functional description:
+            Filter eight columns of a horizontal luma edge, SSE2 version of
+            the per-pixel loops of FilterHorLuma. All arithmetic is done in
+            16-bit lanes and gives exactly the same result as the C code.
+
+------------------------------------------------------------------------------*/
+void FilterHorLuma8(
+  u8 *data,
+  u32 bS,
+  edgeThreshold_t *thresholds,
+  i32 imageWidth)
+{
+
+/* Variables */
+
+    __m128i p0, p1, p2, p3, q0, q1, q2, q3;
+    __m128i alpha, beta, filter, ap, aq;
+    __m128i tc, delta, tmp, tmp2;
+
+/* Code */
+
+    p1 = LoadRow8(data - imageWidth*2);
+    p0 = LoadRow8(data - imageWidth);
+    q0 = LoadRow8(data);
+    q1 = LoadRow8(data + imageWidth);
+
+    alpha = _mm_set1_epi16((i16)thresholds->alpha);
+    beta = _mm_set1_epi16((i16)thresholds->beta);
+
+    filter = _mm_and_si128(AbsLess(p0, q0, alpha),
+        _mm_and_si128(AbsLess(p1, p0, beta), AbsLess(q1, q0, beta)));
+    if (!_mm_movemask_epi8(filter))
+        return;
+
+    p2 = LoadRow8(data - imageWidth*3);
+    q2 = LoadRow8(data + imageWidth*2);
+
+    ap = _mm_and_si128(filter, AbsLess(p2, p0, beta));
+    aq = _mm_and_si128(filter, AbsLess(q2, q0, beta));
+
+    if (bS < 4)
+    {
+        tc = _mm_set1_epi16((i16)thresholds->tc0[bS-1]);
+
+        /* (p0 + q0 + 1) >> 1 */
+        tmp = _mm_avg_epu16(p0, q0);
+
+        tmp2 = _mm_sub_epi16(_mm_add_epi16(p2, tmp), _mm_slli_epi16(p1, 1));
+        tmp2 = _mm_add_epi16(p1, Clip3(tc, _mm_srai_epi16(tmp2, 1)));
+        StoreRow8(data - imageWidth*2, Select(ap, tmp2, p1));
+
+        tmp2 = _mm_sub_epi16(_mm_add_epi16(q2, tmp), _mm_slli_epi16(q1, 1));
+        tmp2 = _mm_add_epi16(q1, Clip3(tc, _mm_srai_epi16(tmp2, 1)));
+        StoreRow8(data + imageWidth, Select(aq, tmp2, q1));
+
+        /* masks are -1 where set, tc is incremented for each of ap, aq */
+        tc = _mm_sub_epi16(_mm_sub_epi16(tc, ap), aq);
+
+        delta = _mm_add_epi16(_mm_slli_epi16(_mm_sub_epi16(q0, p0), 2),
+            _mm_sub_epi16(p1, q1));
+        delta = _mm_srai_epi16(_mm_add_epi16(delta, _mm_set1_epi16(4)), 3);
+        delta = _mm_and_si128(filter, Clip3(tc, delta));
+
+        StoreRow8(data - imageWidth, _mm_add_epi16(p0, delta));
+        StoreRow8(data, _mm_sub_epi16(q0, delta));
+    }
+    else
+    {
+        __m128i two = _mm_set1_epi16(2);
+        __m128i four = _mm_set1_epi16(4);
+        __m128i strong, np0, nq0;
+
+        strong = AbsLess(p0, q0, _mm_set1_epi16(
+            (i16)((thresholds->alpha >> 2) + 2)));
+        ap = _mm_and_si128(ap, strong);
+        aq = _mm_and_si128(aq, strong);
+
+        /* weak variants, used for lanes where ap (aq) is not set */
+        np0 = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(p1, 1), p0),
+            _mm_add_epi16(q1, two));
+        np0 = Select(filter, _mm_srli_epi16(np0, 2), p0);
+        nq0 = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(q1, 1), q0),
+            _mm_add_epi16(p1, two));
+        nq0 = Select(filter, _mm_srli_epi16(nq0, 2), q0);
+
+        if (_mm_movemask_epi8(ap))
+        {
+            p3 = LoadRow8(data - imageWidth*4);
+            tmp = _mm_add_epi16(_mm_add_epi16(p1, p0), q0);
+
+            tmp2 = _mm_add_epi16(_mm_add_epi16(p2, _mm_slli_epi16(tmp, 1)),
+                _mm_add_epi16(q1, four));
+            np0 = Select(ap, _mm_srli_epi16(tmp2, 3), np0);
+
+            tmp2 = _mm_add_epi16(_mm_add_epi16(p2, tmp), two);
+            StoreRow8(data - imageWidth*2,
+                Select(ap, _mm_srli_epi16(tmp2, 2), p1));
+
+            tmp2 = _mm_add_epi16(_mm_slli_epi16(p3, 1),
+                _mm_add_epi16(_mm_add_epi16(p2, _mm_slli_epi16(p2, 1)),
+                    _mm_add_epi16(tmp, four)));
+            StoreRow8(data - imageWidth*3,
+                Select(ap, _mm_srli_epi16(tmp2, 3), p2));
+        }
+
+        if (_mm_movemask_epi8(aq))
+        {
+            q3 = LoadRow8(data + imageWidth*3);
+            tmp = _mm_add_epi16(_mm_add_epi16(p0, q0), q1);
+
+            tmp2 = _mm_add_epi16(_mm_add_epi16(p1, _mm_slli_epi16(tmp, 1)),
+                _mm_add_epi16(q2, four));
+            nq0 = Select(aq, _mm_srli_epi16(tmp2, 3), nq0);
+
+            tmp2 = _mm_add_epi16(_mm_add_epi16(tmp, q2), two);
+            StoreRow8(data + imageWidth,
+                Select(aq, _mm_srli_epi16(tmp2, 2), q1));
+
+            tmp2 = _mm_add_epi16(_mm_slli_epi16(q3, 1),
+                _mm_add_epi16(_mm_add_epi16(q2, _mm_slli_epi16(q2, 1)),
+                    _mm_add_epi16(tmp, four)));
+            StoreRow8(data + imageWidth*2,
+                Select(aq, _mm_srli_epi16(tmp2, 3), q2));
+        }
+
+        StoreRow8(data - imageWidth, np0);
+        StoreRow8(data, nq0);
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: FilterHorLuma
+
+        Functional description:
+            Filter all four successive horizontal 4-pixel luma edges. This can
+            be done when bS is equal to all four edges.
+
+------------------------------------------------------------------------------*/
+void FilterHorLuma(
+  u8 *data,
+  u32 bS,
+  edgeThreshold_t *thresholds,
+  i32 imageWidth)
+{
+
+/* Code */
+
+    ASSERT(data);
+    ASSERT(bS <= 4);
+    ASSERT(thresholds);
+
+    FilterHorLuma8(data, bS, thresholds, imageWidth);
+    FilterHorLuma8(data + 8, bS, thresholds, imageWidth);
+
+}
+
+#endif /* H264DEC_SSE2 */
 
 /*------------------------------------------------------------------------------
 
@@ -1053,6 +1313,7 @@ void FilterHorChromaEdge(
     }
 }
 
+#ifndef H264DEC_SSE2
 /*------------------------------------------------------------------------------
 
     Function: FilterHorChroma
@@ -1119,6 +1380,75 @@ void FilterHorChroma(
     }
 
 }
+#else /* H264DEC_SSE2 */
+
+/*------------------------------------------------------------------------------
+
+    Function: FilterHorChroma
+
+        Functional description:
+            Filter all four successive horizontal 2-pixel chroma edges. This
+            can be done if bS is equal for all four edges. SSE2 version, all
+            eight columns are filtered at once.
+
+------------------------------------------------------------------------------*/
+void FilterHorChroma(
+  u8 *data,
+  u32 bS,
+  edgeThreshold_t *thresholds,
+  i32 width)
+{
+
+/* Variables */
+
+    __m128i p0, p1, q0, q1;
+    __m128i alpha, beta, filter, tc, delta, tmp;
+
+/* Code */
+
+    ASSERT(data);
+    ASSERT(bS <= 4);
+    ASSERT(thresholds);
+
+    p1 = LoadRow8(data - width*2);
+    p0 = LoadRow8(data - width);
+    q0 = LoadRow8(data);
+    q1 = LoadRow8(data + width);
+
+    alpha = _mm_set1_epi16((i16)thresholds->alpha);
+    beta = _mm_set1_epi16((i16)thresholds->beta);
+
+    filter = _mm_and_si128(AbsLess(p0, q0, alpha),
+        _mm_and_si128(AbsLess(p1, p0, beta), AbsLess(q1, q0, beta)));
+    if (!_mm_movemask_epi8(filter))
+        return;
+
+    if (bS < 4)
+    {
+        tc = _mm_set1_epi16((i16)(thresholds->tc0[bS-1] + 1));
+
+        delta = _mm_add_epi16(_mm_slli_epi16(_mm_sub_epi16(q0, p0), 2),
+            _mm_sub_epi16(p1, q1));
+        delta = _mm_srai_epi16(_mm_add_epi16(delta, _mm_set1_epi16(4)), 3);
+        delta = _mm_and_si128(filter, Clip3(tc, delta));
+
+        StoreRow8(data - width, _mm_add_epi16(p0, delta));
+        StoreRow8(data, _mm_sub_epi16(q0, delta));
+    }
+    else
+    {
+        tmp = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(p1, 1), p0),
+            _mm_add_epi16(q1, _mm_set1_epi16(2)));
+        StoreRow8(data - width, Select(filter, _mm_srli_epi16(tmp, 2), p0));
+
+        tmp = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(q1, 1), q0),
+            _mm_add_epi16(p1, _mm_set1_epi16(2)));
+        StoreRow8(data, Select(filter, _mm_srli_epi16(tmp, 2), q0));
+    }
+
+}
+
+#endif /* H264DEC_SSE2 */
 
 
 /*------------------------------------------------------------------------------
@@ -1739,23 +2069,32 @@ void FilterChroma(
 
 /*------------------------------------------------------------------------------
 
-    Function: h264bsdFilterPicture
+    Function: h264bsdFilterRows
 
         Functional description:
-          Perform deblocking filtering for a picture. Filter does not copy
-          the original picture anywhere but filtering is performed directly
-          on the original image. Parameters controlling the filtering process
+          Perform deblocking filtering for macroblock rows firstRow ...
+          firstRow + numRows - 1 of a picture. Filter does not copy the
+          original picture anywhere but filtering is performed directly on
+          the original image. Parameters controlling the filtering process
           are computed based on information in macroblock structures of the
           filtered macroblock, macroblock above and macroblock on the left of
           the filtered one.
 
+          Rows have to be filtered in top-to-bottom order. Filtering of a
+          row modifies the row itself and the three bottom lines of the row
+          above it, so a row can be filtered as soon as all macroblocks of
+          the next row have been reconstructed, while the decoder is still
+          working on the rest of the picture (see h264bsdFilterDecodedRows).
+
         Inputs:
           image         pointer to image to be filtered
           mb            pointer to macroblock data structure of the top-left
                         macroblock of the picture
+          firstRow      first macroblock row to be filtered
+          numRows       number of macroblock rows to be filtered
 
         Outputs:
-          image         filtered image stored here
+          image         filtered rows stored here
 
         Returns:
           none
@@ -1763,9 +2102,11 @@ void FilterChroma(
 ------------------------------------------------------------------------------*/
 
 /*lint --e{550} Symbol not accessed */
-void h264bsdFilterPicture(
+void h264bsdFilterRows(
   image_t *image,
-  mbStorage_t *mb)
+  mbStorage_t *mb,
+  u32 firstRow,
+  u32 numRows)
 {
 
 /* Variables */
@@ -1789,14 +2130,15 @@ void h264bsdFilterPicture(
     ASSERT(image->data);
     ASSERT(image->width);
     ASSERT(image->height);
+    ASSERT(firstRow + numRows <= image->height);
 
     picWidthInMbs = image->width;
     data = image->data;
     picSizeInMbs = picWidthInMbs * image->height;
 
-    pMb = mb;
+    pMb = mb + firstRow * picWidthInMbs;
 
-    for (mbRow = 0, mbCol = 0; mbRow < image->height; pMb++)
+    for (mbRow = firstRow, mbCol = 0; mbRow < firstRow + numRows; pMb++)
     {
         flags = GetMbFilteringFlags(pMb);
 
@@ -48,9 +48,11 @@
     4. Function prototypes
 ------------------------------------------------------------------------------*/
 
-void h264bsdFilterPicture(
+void h264bsdFilterRows(
   image_t *image,
-  mbStorage_t *mb);
+  mbStorage_t *mb,
+  u32 firstRow,
+  u32 numRows);
 
 #endif /* #ifdef H264SWDEC_DEBLOCKING_H */
 
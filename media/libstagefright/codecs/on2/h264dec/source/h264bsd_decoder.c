@@ -35,6 +35,7 @@
           h264bsdVideoRange
           h264bsdMatrixCoefficients
           h264bsdCroppingParams
+          h264bsdMaxDpbSize
 
 ------------------------------------------------------------------------------*/
 
@@ -230,6 +231,10 @@ u32 h264bsdDecode(storage_t *pStorage, u8 *byteStrm, u32 len, u32 picId,
         {
             DEBUG(("CONCEALING..."));
 
+            /* concealment reads and writes samples of rows that may be
+             * under deblocking on application threads */
+            h264bsdSyncFilter(pStorage);
+
             /* return error if second phase of
              * initialization is not completed */
             if (pStorage->pendingActivation)
@@ -420,8 +425,15 @@ u32 h264bsdDecode(storage_t *pStorage, u8 *byteStrm, u32 len, u32 picId,
                     }
                     pStorage->currImage->data =
                         h264bsdAllocateDpbImage(pStorage->dpb);
+                    pStorage->asyncFilter = pStorage->filterRows != NULL ?
+                        HANTRO_TRUE : HANTRO_FALSE;
                 }
 
+                /* redundant slices rewrite macroblock data of rows that may
+                 * be under deblocking on application threads */
+                if (pStorage->sliceHeader[1].redundantPicCnt)
+                    h264bsdSyncFilter(pStorage);
+
                 /* store slice header to storage if successfully decoded */
                 pStorage->sliceHeader[0] = pStorage->sliceHeader[1];
                 pStorage->validSliceInAccessUnit = HANTRO_TRUE;
@@ -448,6 +460,7 @@ u32 h264bsdDecode(storage_t *pStorage, u8 *byteStrm, u32 len, u32 picId,
                 if (tmp != HANTRO_OK)
                 {
                     EPRINT("SLICE_DATA");
+                    h264bsdSyncFilter(pStorage);
                     h264bsdMarkSliceCorrupted(pStorage,
                         pStorage->sliceHeader->firstMbInSlice);
                     return(H264BSD_ERROR);
@@ -471,7 +484,11 @@ u32 h264bsdDecode(storage_t *pStorage, u8 *byteStrm, u32 len, u32 picId,
 
     if (picReady)
     {
-        h264bsdFilterPicture(pStorage->currImage, pStorage->mb);
+        /* rows not handed to the application yet are filtered here */
+        h264bsdSyncFilter(pStorage);
+        h264bsdFilterRows(pStorage->currImage, pStorage->mb,
+            pStorage->numFilteredRows,
+            pStorage->currImage->height - pStorage->numFilteredRows);
 
         h264bsdResetStorage(pStorage);
 
@@ -959,3 +976,27 @@ u32 h264bsdProfile(storage_t *pStorage)
         return 0;
 }
 
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdMaxDpbSize
+
+        Functional description:
+            Get maximum number of pictures in the DPB from active SPS
+
+        Inputs:
+            pStorage    pointer to storage structure
+
+        Outputs:
+            none
+
+        Returns:
+            max DPB size, 0 if no active SPS
+
+------------------------------------------------------------------------------*/
+u32 h264bsdMaxDpbSize(storage_t *pStorage)
+{
+    if (pStorage->activeSps)
+        return pStorage->activeSps->maxDpbSize;
+    else
+        return 0;
+}
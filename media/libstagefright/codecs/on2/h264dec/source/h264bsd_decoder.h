@@ -79,5 +79,7 @@ void h264bsdFlushBuffer(storage_t *pStorage);
 
 u32 h264bsdProfile(storage_t *pStorage);
 
+u32 h264bsdMaxDpbSize(storage_t *pStorage);
+
 #endif /* #ifdef H264SWDEC_DECODER_H */
 
@@ -45,7 +45,10 @@
           OutputPicture
           h264bsdDpbOutputPicture
           h264bsdFlushDpb
+          h264bsdDpbDetachBuffers
           h264bsdFreeDpb
+          PictureNeeded
+          ReleaseBuffers
 
 ------------------------------------------------------------------------------*/
 
@@ -80,6 +83,9 @@
 /* macro to set a picture unused for reference */
 #define SET_UNUSED(a) (a).status = UNUSED;
 
+/* macro to determine if picture data is in application supplied memory */
+#define IS_EXTERNAL(a) ((a).data != ALIGN((a).pAllocatedData, 16))
+
 #define MAX_NUM_REF_IDX_L0_ACTIVE 16
 
 /*------------------------------------------------------------------------------
@@ -114,6 +120,10 @@ static u32 OutputPicture(dpbStorage_t *dpb);
 
 static void ShellSort(dpbPicture_t *pPic, u32 num);
 
+static u32 PictureNeeded(dpbStorage_t *dpb, dpbPicture_t *pic);
+
+static void ReleaseBuffers(dpbStorage_t *dpb, dpbPicture_t *keep);
+
 /*------------------------------------------------------------------------------
 
     Function: ComparePictures
@@ -825,6 +835,11 @@ u32 h264bsdMarkDecRefPic(
     /* sort dpb */
     ShellSort(dpb->buffer, dpb->dpbSize+1);
 
+    /* hand back application memory of pictures that were just marked unused
+     * for reference and not needed for display */
+    if (dpb->acquireBuffer)
+        ReleaseBuffers(dpb, NULL);
+
     return(status);
 
 }
@@ -866,7 +881,10 @@ u8* h264bsdGetRefPicData(dpbStorage_t *dpb, u32 index)
         Functional description:
             function to allocate memory for a image. This function does not
             really allocate any memory but reserves one of the buffer
-            positions for decoding of current picture
+            positions for decoding of current picture. If the application
+            supplies picture memory, the position gets a buffer from the
+            application unless it still has one; when the application has
+            no buffer available the decoder's own memory is used.
 
         Returns:
             pointer to memory area for the image
@@ -879,6 +897,8 @@ u8* h264bsdAllocateDpbImage(dpbStorage_t *dpb)
 
 /* Variables */
 
+    u8 *data;
+
 /* Code */
 
     ASSERT( !dpb->buffer[dpb->dpbSize].toBeDisplayed &&
@@ -887,6 +907,22 @@ u8* h264bsdAllocateDpbImage(dpbStorage_t *dpb)
 
     dpb->currentOut = dpb->buffer + dpb->dpbSize;
 
+    if (dpb->acquireBuffer)
+    {
+        /* output pictures of the previous call have been consumed by now */
+        ReleaseBuffers(dpb, dpb->currentOut);
+
+        if (!IS_EXTERNAL(*dpb->currentOut))
+        {
+            data = dpb->acquireBuffer(dpb->bufferUserData);
+            if (data)
+            {
+                ASSERT(data == ALIGN(data, 16));
+                dpb->currentOut->data = data;
+            }
+        }
+    }
+
     return(dpb->currentOut->data);
 
 }
@@ -1006,6 +1042,7 @@ u32 h264bsdInitDpb(
         dpb->dpbSize         = dpbSize;
     dpb->maxFrameNum         = maxFrameNum;
     dpb->noReordering        = noReordering;
+    dpb->picSizeInMbs        = picSizeInMbs;
     dpb->fullness            = 0;
     dpb->numRefFrames        = 0;
     dpb->prevRefFrameNum     = 0;
@@ -1248,7 +1285,7 @@ u32 h264bsdCheckGapsInFrameNum(dpbStorage_t *dpb, u32 frameNum, u32 isRefPic,
 /* Variables */
 
     u32 unUsedShortTermFrameNum;
-    u8 *tmp;
+    u8 *tmp, *tmpAllocated;
 
 /* Code */
 
@@ -1333,6 +1370,14 @@ u32 h264bsdCheckGapsInFrameNum(dpbStorage_t *dpb, u32 frameNum, u32 isRefPic,
                             dpb->buffer[i].data =
                                 dpb->buffer[dpb->dpbSize].data;
                             dpb->buffer[dpb->dpbSize].data = tmp;
+                            /* allocated memory goes along so that 'data' of
+                             * each position keeps pointing to its own
+                             * memory or to application supplied memory */
+                            tmpAllocated = dpb->buffer[i].pAllocatedData;
+                            dpb->buffer[i].pAllocatedData =
+                                dpb->buffer[dpb->dpbSize].pAllocatedData;
+                            dpb->buffer[dpb->dpbSize].pAllocatedData =
+                                tmpAllocated;
                             break;
                         }
                     }
@@ -1511,6 +1556,58 @@ void h264bsdFlushDpb(dpbStorage_t *dpb)
 
 }
 
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdDpbDetachBuffers
+
+        Functional description:
+            Function to move all pictures out of application supplied memory.
+            Pictures still needed for reference or display and the picture
+            possibly being decoded are copied to the decoder's own memory,
+            after which all application buffers are released.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdDpbDetachBuffers(dpbStorage_t *dpb)
+{
+
+/* Variables */
+
+    u32 i, j;
+    u8 *data;
+
+/* Code */
+
+    ASSERT(dpb);
+
+    if (dpb->buffer == NULL || dpb->releaseBuffer == NULL)
+        return;
+
+    for (i = 0; i <= dpb->dpbSize; i++)
+    {
+        if (!IS_EXTERNAL(dpb->buffer[i]))
+            continue;
+
+        data = ALIGN(dpb->buffer[i].pAllocatedData, 16);
+        if (dpb->buffer + i == dpb->currentOut ||
+            PictureNeeded(dpb, dpb->buffer + i))
+        {
+            H264SwDecMemcpy(data, dpb->buffer[i].data,
+                dpb->picSizeInMbs * 384);
+        }
+
+        for (j = 0; j < dpb->numOut; j++)
+        {
+            if (dpb->outBuf[j].data == dpb->buffer[i].data)
+                dpb->outBuf[j].data = data;
+        }
+
+        dpb->releaseBuffer(dpb->bufferUserData, dpb->buffer[i].data);
+        dpb->buffer[i].data = data;
+    }
+
+}
+
 /*------------------------------------------------------------------------------
 
     Function: h264bsdFreeDpb
@@ -1535,6 +1632,8 @@ void h264bsdFreeDpb(dpbStorage_t *dpb)
     {
         for (i = 0; i < dpb->dpbSize+1; i++)
         {
+            if (dpb->releaseBuffer && IS_EXTERNAL(dpb->buffer[i]))
+                dpb->releaseBuffer(dpb->bufferUserData, dpb->buffer[i].data);
             FREE(dpb->buffer[i].pAllocatedData);
         }
     }
@@ -1582,3 +1681,75 @@ static void ShellSort(dpbPicture_t *pPic, u32 num)
 
 }
 
+/*------------------------------------------------------------------------------
+
+    Function: PictureNeeded
+
+        Functional description:
+            Function to check if contents of a picture are still needed, i.e.
+            the picture is used for reference, waits for display or is in the
+            output buffer and not yet fetched by the application.
+
+        Returns:
+            HANTRO_TRUE     picture needed
+            HANTRO_FALSE    memory of the picture may be reused
+
+------------------------------------------------------------------------------*/
+
+static u32 PictureNeeded(dpbStorage_t *dpb, dpbPicture_t *pic)
+{
+
+/* Variables */
+
+    u32 i;
+
+/* Code */
+
+    if (IS_EXISTING(*pic) || pic->toBeDisplayed)
+        return(HANTRO_TRUE);
+
+    for (i = dpb->outIndex; i < dpb->numOut; i++)
+    {
+        if (dpb->outBuf[i].data == pic->data)
+            return(HANTRO_TRUE);
+    }
+
+    return(HANTRO_FALSE);
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: ReleaseBuffers
+
+        Functional description:
+            Function to give application supplied memory of pictures that are
+            not needed anymore back to the application. Buffer position
+            'keep' holds on to its memory, it is being allocated for the
+            next picture.
+
+------------------------------------------------------------------------------*/
+
+static void ReleaseBuffers(dpbStorage_t *dpb, dpbPicture_t *keep)
+{
+
+/* Variables */
+
+    u32 i;
+
+/* Code */
+
+    ASSERT(dpb->releaseBuffer);
+
+    for (i = 0; i <= dpb->dpbSize; i++)
+    {
+        if (dpb->buffer + i != keep &&
+            IS_EXTERNAL(dpb->buffer[i]) &&
+            !PictureNeeded(dpb, dpb->buffer + i))
+        {
+            dpb->releaseBuffer(dpb->bufferUserData, dpb->buffer[i].data);
+            dpb->buffer[i].data = ALIGN(dpb->buffer[i].pAllocatedData, 16);
+        }
+    }
+
+}
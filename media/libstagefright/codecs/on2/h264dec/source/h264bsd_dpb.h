@@ -54,7 +54,8 @@ typedef enum {
 
 /* structure to represent a buffered picture */
 typedef struct {
-    u8 *data;           /* 16-byte aligned pointer of pAllocatedData */
+    u8 *data;           /* 16-byte aligned pointer of pAllocatedData or
+                           application supplied picture memory */
     u8 *pAllocatedData; /* allocated picture pointer; (size + 15) bytes */
     i32 picNum;
     u32 frameNum;
@@ -92,6 +93,11 @@ typedef struct {
     u32 lastContainsMmco5;
     u32 noReordering;
     u32 flushed;
+    u32 picSizeInMbs;
+    /* application supplied picture memory, see H264SwDecSetBufferCallbacks */
+    u8 *(*acquireBuffer)(void *userData);
+    void (*releaseBuffer)(void *userData, u8 *data);
+    void *bufferUserData;
 } dpbStorage_t;
 
 /*------------------------------------------------------------------------------
@@ -143,6 +149,8 @@ dpbOutPicture_t* h264bsdDpbOutputPicture(dpbStorage_t *dpb);
 
 void h264bsdFlushDpb(dpbStorage_t *dpb);
 
+void h264bsdDpbDetachBuffers(dpbStorage_t *dpb);
+
 void h264bsdFreeDpb(dpbStorage_t *dpb);
 
 #endif /* #ifdef H264SWDEC_DPB_H */
@@ -104,7 +104,7 @@ extern const u8 h264bsdClip[];
           predPartChroma    pointer where predicted part is written
 
 ------------------------------------------------------------------------------*/
-#ifndef H264DEC_ARM11
+#if !defined(H264DEC_ARM11) && !defined(H264DEC_SSE2)
 void h264bsdInterpolateChromaHor(
   u8 *pRef,
   u8 *predPartChroma,
@@ -297,6 +297,7 @@ void h264bsdInterpolateChromaVer(
 
 ------------------------------------------------------------------------------*/
 
+#ifndef H264DEC_SSE2
 void h264bsdInterpolateChromaHorVer(
   u8 *ref,
   u8 *predPartChroma,
@@ -400,6 +401,7 @@ void h264bsdInterpolateChromaHorVer(
     }
 
 }
+#endif /* H264DEC_SSE2 */
 
 /*------------------------------------------------------------------------------
 
@@ -485,7 +487,7 @@ static void PredictChroma(
           is written to macroblock array (mb)
 
 ------------------------------------------------------------------------------*/
-#ifndef H264DEC_ARM11
+#if !defined(H264DEC_ARM11) && !defined(H264DEC_SSE2)
 void h264bsdInterpolateVerHalf(
   u8 *ref,
   u8 *mb,
@@ -1205,6 +1207,7 @@ void h264bsdInterpolateHorVerQuarter(
 
 ------------------------------------------------------------------------------*/
 
+#ifndef H264DEC_SSE2
 void h264bsdInterpolateMidHalf(
   u8 *ref,
   u8 *mb,
@@ -1787,6 +1790,7 @@ void h264bsdInterpolateMidHorQuarter(
     }
 
 }
+#endif /* H264DEC_SSE2 */
 
 
 /*------------------------------------------------------------------------------
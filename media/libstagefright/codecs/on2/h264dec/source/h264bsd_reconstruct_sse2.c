@@ -0,0 +1,1034 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*------------------------------------------------------------------------------
+
+    Table of contents
+
+     1. Include headers
+     2. External compiler flags
+     3. Module defines
+     4. Local function prototypes
+     5. Functions
+
+------------------------------------------------------------------------------*/
+
+/*------------------------------------------------------------------------------
+    1. Include headers
+------------------------------------------------------------------------------*/
+
+#include "basetype.h"
+#include "h264bsd_reconstruct.h"
+#include "h264bsd_util.h"
+
+#include <string.h>
+#include <emmintrin.h>
+
+/*------------------------------------------------------------------------------
+    2. External compiler flags
+--------------------------------------------------------------------------------
+
+    H264DEC_SSE2    This file replaces the C interpolation functions of
+                    h264bsd_reconstruct.c, which are compiled out when the
+                    flag is defined.
+
+--------------------------------------------------------------------------------
+    3. Module defines
+------------------------------------------------------------------------------*/
+
+/* All functions below produce exactly the same output as their counterparts
+ * in h264bsd_reconstruct.c. Samples are processed in 16-bit lanes, up to
+ * eight per register, so that the filters need no intermediate rounding.
+ * Only the second pass of the 2D half-sample filter (pixel 'j') needs 32 bits
+ * and is done with _mm_madd_epi16. Reads never go past the reference area
+ * used by the C code. */
+
+#ifdef H264DEC_SSE2
+
+/*------------------------------------------------------------------------------
+    4. Local function prototypes
+------------------------------------------------------------------------------*/
+
+static __inline __m128i LoadPels(const u8 *ptr, u32 num);
+static __inline void StorePels(u8 *ptr, __m128i pels, u32 num);
+static __inline __m128i Tap6(__m128i a, __m128i b, __m128i c, __m128i d,
+    __m128i e, __m128i f);
+static __inline __m128i Tap6Round(__m128i a, __m128i b, __m128i c,
+    __m128i d, __m128i e, __m128i f);
+static __inline __m128i Tap6Mid(const i16 *ptr, u32 stride);
+static __inline __m128i HorHalfPels(const u8 *ptr, u32 num);
+static __inline __m128i VerHalfPels(const u8 *ptr, u32 width, u32 num);
+static void MidHalfTable(u8 *ref, i16 *table, u32 width, u32 partWidth,
+    u32 partHeight);
+
+/*------------------------------------------------------------------------------
+
+    Function: LoadPels
+
+        Functional description:
+          Load 'num' (2, 4 or 8) pels and zero-extend them to 16 bits.
+
+------------------------------------------------------------------------------*/
+
+__m128i LoadPels(const u8 *ptr, u32 num)
+{
+    u32 tmp = 0;
+
+    if (num == 8)
+        return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)ptr),
+            _mm_setzero_si128());
+
+    memcpy(&tmp, ptr, num);
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128((i32)tmp), _mm_setzero_si128());
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: StorePels
+
+        Functional description:
+          Store the 'num' (2, 4 or 8) lowest bytes of 'pels'.
+
+------------------------------------------------------------------------------*/
+
+void StorePels(u8 *ptr, __m128i pels, u32 num)
+{
+    u32 tmp;
+
+    if (num == 8)
+    {
+        _mm_storel_epi64((__m128i *)ptr, pels);
+        return;
+    }
+
+    tmp = (u32)_mm_cvtsi128_si32(pels);
+    memcpy(ptr, &tmp, num);
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: Tap6
+
+        Functional description:
+          6-tap filter (1, -5, 20, 20, -5, 1) without rounding. Fits 16 bits
+          when the inputs are 8-bit samples.
+
+------------------------------------------------------------------------------*/
+
+__m128i Tap6(__m128i a, __m128i b, __m128i c, __m128i d, __m128i e,
+    __m128i f)
+{
+    __m128i tmp;
+
+    tmp = _mm_mullo_epi16(_mm_add_epi16(c, d), _mm_set1_epi16(20));
+    tmp = _mm_sub_epi16(tmp,
+        _mm_mullo_epi16(_mm_add_epi16(b, e), _mm_set1_epi16(5)));
+    return _mm_add_epi16(tmp, _mm_add_epi16(a, f));
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: Tap6Round
+
+        Functional description:
+          6-tap filter of 8-bit samples, rounded, clipped and packed back to
+          8 bits.
+
+------------------------------------------------------------------------------*/
+
+__m128i Tap6Round(__m128i a, __m128i b, __m128i c, __m128i d, __m128i e,
+    __m128i f)
+{
+    __m128i tmp;
+
+    tmp = _mm_add_epi16(Tap6(a, b, c, d, e, f), _mm_set1_epi16(16));
+    tmp = _mm_srai_epi16(tmp, 5);
+    return _mm_packus_epi16(tmp, tmp);
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: Tap6Mid
+
+        Functional description:
+          Vertical 6-tap filter of the unrounded horizontal intermediate
+          values in 'ptr' (eight columns, rows 'stride' apart). Result is
+          rounded, clipped and packed to 8 bits.
+
+------------------------------------------------------------------------------*/
+
+__m128i Tap6Mid(const i16 *ptr, u32 stride)
+{
+    __m128i a, b, c, d, e, f, af, be, cd, lo, hi;
+    const __m128i coeff = _mm_set_epi16(-5, 20, -5, 20, -5, 20, -5, 20);
+    const __m128i round = _mm_set1_epi32(512);
+
+    a = _mm_loadu_si128((const __m128i *)ptr);
+    b = _mm_loadu_si128((const __m128i *)(ptr + stride));
+    c = _mm_loadu_si128((const __m128i *)(ptr + stride*2));
+    d = _mm_loadu_si128((const __m128i *)(ptr + stride*3));
+    e = _mm_loadu_si128((const __m128i *)(ptr + stride*4));
+    f = _mm_loadu_si128((const __m128i *)(ptr + stride*5));
+
+    /* pair sums of the intermediate values still fit 16 bits */
+    af = _mm_add_epi16(a, f);
+    be = _mm_add_epi16(b, e);
+    cd = _mm_add_epi16(c, d);
+
+    lo = _mm_madd_epi16(_mm_unpacklo_epi16(cd, be), coeff);
+    lo = _mm_add_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(af, af), 16));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 10);
+
+    hi = _mm_madd_epi16(_mm_unpackhi_epi16(cd, be), coeff);
+    hi = _mm_add_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(af, af), 16));
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 10);
+
+    lo = _mm_packs_epi32(lo, hi);
+    return _mm_packus_epi16(lo, lo);
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: HorHalfPels
+
+        Functional description:
+          Horizontal half-sample pels (position 'b') for 'num' pixels, 'ptr'
+          points two pixels left of the first integer sample.
+
+------------------------------------------------------------------------------*/
+
+__m128i HorHalfPels(const u8 *ptr, u32 num)
+{
+    return Tap6Round(
+        LoadPels(ptr, num), LoadPels(ptr + 1, num), LoadPels(ptr + 2, num),
+        LoadPels(ptr + 3, num), LoadPels(ptr + 4, num),
+        LoadPels(ptr + 5, num));
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: VerHalfPels
+
+        Functional description:
+          Vertical half-sample pels (position 'h') for 'num' pixels, 'ptr'
+          points two rows above the first integer sample.
+
+------------------------------------------------------------------------------*/
+
+__m128i VerHalfPels(const u8 *ptr, u32 width, u32 num)
+{
+    return Tap6Round(
+        LoadPels(ptr, num), LoadPels(ptr + width, num),
+        LoadPels(ptr + width*2, num), LoadPels(ptr + width*3, num),
+        LoadPels(ptr + width*4, num), LoadPels(ptr + width*5, num));
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: MidHalfTable
+
+        Functional description:
+          Compute unrounded horizontal 6-tap values for partHeight+5 rows
+          starting at 'ref' (which points at G + (-2, -2)). Rows of the table
+          are 16 values apart.
+
+------------------------------------------------------------------------------*/
+
+void MidHalfTable(u8 *ref, i16 *table, u32 width, u32 partWidth,
+    u32 partHeight)
+{
+    u32 x, y, num;
+    __m128i tmp;
+
+    for (y = partHeight + 5; y; y--)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            tmp = Tap6(
+                LoadPels(ref + x, num), LoadPels(ref + x + 1, num),
+                LoadPels(ref + x + 2, num), LoadPels(ref + x + 3, num),
+                LoadPels(ref + x + 4, num), LoadPels(ref + x + 5, num));
+            _mm_storeu_si128((__m128i *)(table + x), tmp);
+        }
+        ref += width;
+        table += 16;
+    }
+}
+
+/*------------------------------------------------------------------------------
+    5. Functions
+------------------------------------------------------------------------------*/
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateChromaHor
+
+        Functional description:
+          SSE2 version of the horizontal chroma interpolation, see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateChromaHor(
+  u8 *pRef,
+  u8 *predPartChroma,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 xFrac,
+  u32 chromaPartWidth,
+  u32 chromaPartHeight)
+{
+
+/* Variables */
+
+    u32 y, comp;
+    u8 *ptrA, *cbr;
+    u8 block[9*8*2];
+    __m128i valA, valB, round, tmp;
+
+/* Code */
+
+    ASSERT(predPartChroma);
+    ASSERT(chromaPartWidth);
+    ASSERT(chromaPartHeight);
+    ASSERT(xFrac < 8);
+    ASSERT(pRef);
+
+    if ((x0 < 0) || ((u32)x0+chromaPartWidth+1 > width) ||
+        (y0 < 0) || ((u32)y0+chromaPartHeight > height))
+    {
+        h264bsdFillBlock(pRef, block, x0, y0, width, height,
+            chromaPartWidth + 1, chromaPartHeight, chromaPartWidth + 1);
+        pRef += width * height;
+        h264bsdFillBlock(pRef, block + (chromaPartWidth+1)*chromaPartHeight,
+            x0, y0, width, height, chromaPartWidth + 1,
+            chromaPartHeight, chromaPartWidth + 1);
+
+        pRef = block;
+        x0 = 0;
+        y0 = 0;
+        width = chromaPartWidth+1;
+        height = chromaPartHeight;
+    }
+
+    /* ((a*(8-xFrac) + b*xFrac) << 3) + 32 >> 6 of the C version is the same
+     * as (a*(8-xFrac) + b*xFrac + 4) >> 3 */
+    valA = _mm_set1_epi16((i16)(8 - xFrac));
+    valB = _mm_set1_epi16((i16)xFrac);
+    round = _mm_set1_epi16(4);
+
+    for (comp = 0; comp <= 1; comp++)
+    {
+        ptrA = pRef + (comp * height + (u32)y0) * width + x0;
+        cbr = predPartChroma + comp * 8 * 8;
+
+        for (y = chromaPartHeight; y; y--)
+        {
+            tmp = _mm_add_epi16(
+                _mm_mullo_epi16(LoadPels(ptrA, chromaPartWidth), valA),
+                _mm_mullo_epi16(LoadPels(ptrA + 1, chromaPartWidth), valB));
+            tmp = _mm_srli_epi16(_mm_add_epi16(tmp, round), 3);
+            StorePels(cbr, _mm_packus_epi16(tmp, tmp), chromaPartWidth);
+
+            cbr += 8;
+            ptrA += width;
+        }
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateChromaVer
+
+        Functional description:
+          SSE2 version of the vertical chroma interpolation, see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateChromaVer(
+  u8 *pRef,
+  u8 *predPartChroma,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 yFrac,
+  u32 chromaPartWidth,
+  u32 chromaPartHeight)
+{
+
+/* Variables */
+
+    u32 y, comp;
+    u8 *ptrA, *cbr;
+    u8 block[9*8*2];
+    __m128i valA, valB, round, tmp;
+
+/* Code */
+
+    ASSERT(predPartChroma);
+    ASSERT(chromaPartWidth);
+    ASSERT(chromaPartHeight);
+    ASSERT(yFrac < 8);
+    ASSERT(pRef);
+
+    if ((x0 < 0) || ((u32)x0+chromaPartWidth > width) ||
+        (y0 < 0) || ((u32)y0+chromaPartHeight+1 > height))
+    {
+        h264bsdFillBlock(pRef, block, x0, y0, width, height, chromaPartWidth,
+            chromaPartHeight + 1, chromaPartWidth);
+        pRef += width * height;
+        h264bsdFillBlock(pRef, block + chromaPartWidth*(chromaPartHeight+1),
+            x0, y0, width, height, chromaPartWidth,
+            chromaPartHeight + 1, chromaPartWidth);
+
+        pRef = block;
+        x0 = 0;
+        y0 = 0;
+        width = chromaPartWidth;
+        height = chromaPartHeight+1;
+    }
+
+    valA = _mm_set1_epi16((i16)(8 - yFrac));
+    valB = _mm_set1_epi16((i16)yFrac);
+    round = _mm_set1_epi16(4);
+
+    for (comp = 0; comp <= 1; comp++)
+    {
+        ptrA = pRef + (comp * height + (u32)y0) * width + x0;
+        cbr = predPartChroma + comp * 8 * 8;
+
+        for (y = chromaPartHeight; y; y--)
+        {
+            tmp = _mm_add_epi16(
+                _mm_mullo_epi16(LoadPels(ptrA, chromaPartWidth), valA),
+                _mm_mullo_epi16(LoadPels(ptrA + width, chromaPartWidth),
+                    valB));
+            tmp = _mm_srli_epi16(_mm_add_epi16(tmp, round), 3);
+            StorePels(cbr, _mm_packus_epi16(tmp, tmp), chromaPartWidth);
+
+            cbr += 8;
+            ptrA += width;
+        }
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateChromaHorVer
+
+        Functional description:
+          SSE2 version of the 2D chroma interpolation, see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateChromaHorVer(
+  u8 *ref,
+  u8 *predPartChroma,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 xFrac,
+  u32 yFrac,
+  u32 chromaPartWidth,
+  u32 chromaPartHeight)
+{
+
+/* Variables */
+
+    u32 y, comp;
+    u8 *ptrA, *cbr;
+    u8 block[9*9*2];
+    __m128i valX, fracX, valY, fracY, round, left, right, tmp;
+
+/* Code */
+
+    ASSERT(predPartChroma);
+    ASSERT(chromaPartWidth);
+    ASSERT(chromaPartHeight);
+    ASSERT(xFrac < 8);
+    ASSERT(yFrac < 8);
+    ASSERT(ref);
+
+    if ((x0 < 0) || ((u32)x0+chromaPartWidth+1 > width) ||
+        (y0 < 0) || ((u32)y0+chromaPartHeight+1 > height))
+    {
+        h264bsdFillBlock(ref, block, x0, y0, width, height,
+            chromaPartWidth + 1, chromaPartHeight + 1, chromaPartWidth + 1);
+        ref += width * height;
+        h264bsdFillBlock(ref, block + (chromaPartWidth+1)*(chromaPartHeight+1),
+            x0, y0, width, height, chromaPartWidth + 1,
+            chromaPartHeight + 1, chromaPartWidth + 1);
+
+        ref = block;
+        x0 = 0;
+        y0 = 0;
+        width = chromaPartWidth+1;
+        height = chromaPartHeight+1;
+    }
+
+    valX = _mm_set1_epi16((i16)(8 - xFrac));
+    fracX = _mm_set1_epi16((i16)xFrac);
+    valY = _mm_set1_epi16((i16)(8 - yFrac));
+    fracY = _mm_set1_epi16((i16)yFrac);
+    round = _mm_set1_epi16(32);
+
+    for (comp = 0; comp <= 1; comp++)
+    {
+        ptrA = ref + (comp * height + (u32)y0) * width + x0;
+        cbr = predPartChroma + comp * 8 * 8;
+
+        for (y = chromaPartHeight; y; y--)
+        {
+            /* vertical first, at most 64*255+32 so 16 bits are enough */
+            left = _mm_add_epi16(
+                _mm_mullo_epi16(LoadPels(ptrA, chromaPartWidth), valY),
+                _mm_mullo_epi16(LoadPels(ptrA + width, chromaPartWidth),
+                    fracY));
+            right = _mm_add_epi16(
+                _mm_mullo_epi16(LoadPels(ptrA + 1, chromaPartWidth), valY),
+                _mm_mullo_epi16(LoadPels(ptrA + width + 1, chromaPartWidth),
+                    fracY));
+            tmp = _mm_add_epi16(_mm_mullo_epi16(left, valX),
+                _mm_mullo_epi16(right, fracX));
+            tmp = _mm_srli_epi16(_mm_add_epi16(tmp, round), 6);
+            StorePels(cbr, _mm_packus_epi16(tmp, tmp), chromaPartWidth);
+
+            cbr += 8;
+            ptrA += width;
+        }
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateVerHalf
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'h', see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateVerHalf(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight)
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+
+    if ((x0 < 0) || ((u32)x0+partWidth > width) ||
+        (y0 < 0) || ((u32)y0+partHeight+5 > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth, partHeight+5, partWidth);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth;
+    }
+
+    ref += (u32)y0 * width + (u32)x0;
+
+    for (y = partHeight; y; y--)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            StorePels(mb + x, VerHalfPels(ref + x, width, num), num);
+        }
+        ref += width;
+        mb += 16;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateVerQuarter
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'd' or 'n', see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateVerQuarter(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight,
+  u32 verOffset)    /* 0 for pixel d, 1 for pixel n */
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+    u8 *ptrInt;
+    __m128i half, full;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+
+    if ((x0 < 0) || ((u32)x0+partWidth > width) ||
+        (y0 < 0) || ((u32)y0+partHeight+5 > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth, partHeight+5, partWidth);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth;
+    }
+
+    ref += (u32)y0 * width + (u32)x0;
+
+    /* integer sample position, either G or M */
+    ptrInt = ref + (2+verOffset)*width;
+
+    for (y = partHeight; y; y--)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            half = VerHalfPels(ref + x, width, num);
+            full = LoadPels(ptrInt + x, num);
+            full = _mm_packus_epi16(full, full);
+            StorePels(mb + x, _mm_avg_epu8(half, full), num);
+        }
+        ref += width;
+        ptrInt += width;
+        mb += 16;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateHorHalf
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'b', see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateHorHalf(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight)
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+    ASSERT((partWidth&0x3) == 0);
+    ASSERT((partHeight&0x3) == 0);
+
+    if ((x0 < 0) || ((u32)x0+partWidth+5 > width) ||
+        (y0 < 0) || ((u32)y0+partHeight > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth+5, partHeight, partWidth+5);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth + 5;
+    }
+
+    ref += (u32)y0 * width + (u32)x0;
+
+    for (y = partHeight; y; y--)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            StorePels(mb + x, HorHalfPels(ref + x, num), num);
+        }
+        ref += width;
+        mb += 16;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateHorQuarter
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'a' or 'c', see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateHorQuarter(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight,
+  u32 horOffset) /* 0 for pixel a, 1 for pixel c */
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+    u8 *ptrInt;
+    __m128i half, full;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+
+    if ((x0 < 0) || ((u32)x0+partWidth+5 > width) ||
+        (y0 < 0) || ((u32)y0+partHeight > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth+5, partHeight, partWidth+5);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth + 5;
+    }
+
+    ref += (u32)y0 * width + (u32)x0;
+
+    /* integer sample position, either G or H */
+    ptrInt = ref + 2 + horOffset;
+
+    for (y = partHeight; y; y--)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            half = HorHalfPels(ref + x, num);
+            full = LoadPels(ptrInt + x, num);
+            full = _mm_packus_epi16(full, full);
+            StorePels(mb + x, _mm_avg_epu8(half, full), num);
+        }
+        ref += width;
+        ptrInt += width;
+        mb += 16;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateHorVerQuarter
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'e', 'g', 'p'
+          or 'r', see h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateHorVerQuarter(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight,
+  u32 horVerOffset) /* 0 for pixel e, 1 for pixel g,
+                       2 for pixel p, 3 for pixel r */
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+    u8 *ptrJ, *ptrC;
+    __m128i hor, ver;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+
+    if ((x0 < 0) || ((u32)x0+partWidth+5 > width) ||
+        (y0 < 0) || ((u32)y0+partHeight+5 > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth+5, partHeight+5, partWidth+5);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth+5;
+    }
+
+    /* Ref points to G + (-2, -2) */
+    ref += (u32)y0 * width + (u32)x0;
+
+    /* ptrJ points to the row of either b or s, depending on vertical
+     * offset */
+    ptrJ = ref + (((horVerOffset & 0x2) >> 1) + 2) * width;
+
+    /* ptrC points to the column of either h or m, depending on horizontal
+     * offset */
+    ptrC = ref + 2 + (horVerOffset & 0x1);
+
+    for (y = partHeight; y; y--)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            hor = HorHalfPels(ptrJ + x, num);
+            ver = VerHalfPels(ptrC + x, width, num);
+            StorePels(mb + x, _mm_avg_epu8(hor, ver), num);
+        }
+        ptrJ += width;
+        ptrC += width;
+        mb += 16;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateMidHalf
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'j', see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateMidHalf(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight)
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+    i16 table[21*16];
+    i16 *ptr;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+
+    if ((x0 < 0) || ((u32)x0+partWidth+5 > width) ||
+        (y0 < 0) || ((u32)y0+partHeight+5 > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth+5, partHeight+5, partWidth+5);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth+5;
+    }
+
+    ref += (u32)y0 * width + (u32)x0;
+
+    /* First step: horizontal intermediate values */
+    MidHalfTable(ref, table, width, partWidth, partHeight);
+
+    /* Second step: vertical interpolation */
+    for (y = 0, ptr = table; y < partHeight; y++, ptr += 16)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            StorePels(mb + x, Tap6Mid(ptr + x, 16), num);
+        }
+        mb += 16;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateMidVerQuarter
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'f' or 'q', see
+          h264bsd_reconstruct.c.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateMidVerQuarter(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight,
+  u32 verOffset)    /* 0 for pixel f, 1 for pixel q */
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+    i16 table[21*16];
+    i16 *ptr, *ptrInt;
+    __m128i mid, half;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+
+    if ((x0 < 0) || ((u32)x0+partWidth+5 > width) ||
+        (y0 < 0) || ((u32)y0+partHeight+5 > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth+5, partHeight+5, partWidth+5);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth+5;
+    }
+
+    ref += (u32)y0 * width + (u32)x0;
+
+    MidHalfTable(ref, table, width, partWidth, partHeight);
+
+    /* the rounded horizontal intermediates on the row of either b or s give
+     * the half-sample pels to average with */
+    ptrInt = table + (2+verOffset)*16;
+
+    for (y = 0, ptr = table; y < partHeight; y++, ptr += 16, ptrInt += 16)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            mid = Tap6Mid(ptr + x, 16);
+            half = _mm_loadu_si128((const __m128i *)(ptrInt + x));
+            half = _mm_srai_epi16(_mm_add_epi16(half, _mm_set1_epi16(16)), 5);
+            half = _mm_packus_epi16(half, half);
+            StorePels(mb + x, _mm_avg_epu8(mid, half), num);
+        }
+        mb += 16;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdInterpolateMidHorQuarter
+
+        Functional description:
+          SSE2 version of the interpolation of pixel position 'i' or 'k', see
+          h264bsd_reconstruct.c. The C version filters vertically first; the
+          2D filter is separable and exact so the order does not change 'j'.
+
+------------------------------------------------------------------------------*/
+
+void h264bsdInterpolateMidHorQuarter(
+  u8 *ref,
+  u8 *mb,
+  i32 x0,
+  i32 y0,
+  u32 width,
+  u32 height,
+  u32 partWidth,
+  u32 partHeight,
+  u32 horOffset)    /* 0 for pixel i, 1 for pixel k */
+{
+    u32 p1[21*21/4+1];
+    u32 x, y, num;
+    i16 table[21*16];
+    i16 *ptr;
+    u8 *ptrC;
+    __m128i mid, half;
+
+    /* Code */
+
+    ASSERT(ref);
+    ASSERT(mb);
+
+    if ((x0 < 0) || ((u32)x0+partWidth+5 > width) ||
+        (y0 < 0) || ((u32)y0+partHeight+5 > height))
+    {
+        h264bsdFillBlock(ref, (u8*)p1, x0, y0, width, height,
+                partWidth+5, partHeight+5, partWidth+5);
+
+        x0 = 0;
+        y0 = 0;
+        ref = (u8*)p1;
+        width = partWidth+5;
+    }
+
+    ref += (u32)y0 * width + (u32)x0;
+
+    MidHalfTable(ref, table, width, partWidth, partHeight);
+
+    /* column of either h or m */
+    ptrC = ref + 2 + horOffset;
+
+    for (y = 0, ptr = table; y < partHeight; y++, ptr += 16)
+    {
+        for (x = 0; x < partWidth; x += 8)
+        {
+            num = partWidth - x < 8 ? partWidth - x : 8;
+            mid = Tap6Mid(ptr + x, 16);
+            half = VerHalfPels(ptrC + x, width, num);
+            StorePels(mb + x, _mm_avg_epu8(mid, half), num);
+        }
+        ptrC += width;
+        mb += 16;
+    }
+
+}
+
+#endif /* H264DEC_SSE2 */
@@ -34,6 +34,8 @@
           h264bsdCheckAccessUnitBoundary
           CheckPps
           h264bsdValidParamSets
+          h264bsdFilterDecodedRows
+          h264bsdSyncFilter
 
 ------------------------------------------------------------------------------*/
 
@@ -457,6 +459,10 @@ void h264bsdResetStorage(storage_t *pStorage)
         pStorage->mb[i].decoded = 0;
     }
 
+    pStorage->asyncFilter = HANTRO_FALSE;
+    pStorage->numCompleteMbs = 0;
+    pStorage->numFilteredRows = 0;
+
 }
 
 /*------------------------------------------------------------------------------
@@ -886,3 +892,96 @@ u32 h264bsdValidParamSets(storage_t *pStorage)
 
 }
 
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdFilterDecodedRows
+
+        Functional description:
+            Hand macroblock rows of the current picture to the deblocking
+            callback of the application as soon as they can be filtered.
+            A row is ready when all macroblocks of the row below it have been
+            reconstructed, because intra prediction of those needs unfiltered
+            samples. Progress is tracked as the number of macroblocks decoded
+            from the start of the picture without gaps, which keeps this
+            valid for any slice order and slice group map. Called after each
+            successfully decoded macroblock.
+
+        Inputs:
+            pStorage    pointer to storage structure
+
+        Outputs:
+            pStorage    numCompleteMbs and numFilteredRows updated
+
+        Returns:
+            none
+
+------------------------------------------------------------------------------*/
+
+void h264bsdFilterDecodedRows(storage_t *pStorage)
+{
+
+/* Variables */
+
+    u32 numRows;
+
+/* Code */
+
+    ASSERT(pStorage);
+
+    if (!pStorage->asyncFilter)
+        return;
+
+    while (pStorage->numCompleteMbs < pStorage->picSizeInMbs &&
+           pStorage->mb[pStorage->numCompleteMbs].decoded)
+        pStorage->numCompleteMbs++;
+
+    numRows = pStorage->numCompleteMbs / pStorage->activeSps->picWidthInMbs;
+
+    /* last complete row is still needed for intra prediction, the last row
+     * of the picture is filtered by h264bsdDecode */
+    if (numRows > pStorage->numFilteredRows + 1)
+    {
+        pStorage->filterRows(pStorage->filterUserData,
+            pStorage->numFilteredRows, numRows - 1 - pStorage->numFilteredRows);
+        pStorage->numFilteredRows = numRows - 1;
+    }
+
+}
+
+/*------------------------------------------------------------------------------
+
+    Function: h264bsdSyncFilter
+
+        Functional description:
+            Wait until the application has filtered all rows handed to it by
+            h264bsdFilterDecodedRows and stop handing out rows of the current
+            picture. Must be called before the current picture or its
+            macroblock data is modified by anything but decoding of new
+            macroblocks (error concealment, redundant slices) and before the
+            picture is finished; the rows from numFilteredRows on are then
+            left for the caller to filter.
+
+        Inputs:
+            pStorage    pointer to storage structure
+
+        Outputs:
+            none
+
+        Returns:
+            none
+
+------------------------------------------------------------------------------*/
+
+void h264bsdSyncFilter(storage_t *pStorage)
+{
+
+/* Code */
+
+    ASSERT(pStorage);
+
+    if (pStorage->asyncFilter && pStorage->numFilteredRows)
+        pStorage->filterSync(pStorage->filterUserData);
+
+    pStorage->asyncFilter = HANTRO_FALSE;
+
+}
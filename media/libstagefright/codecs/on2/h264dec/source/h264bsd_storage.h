@@ -146,6 +146,15 @@ typedef struct
                               HEADERS_RDY to the user */
     u32 intraConcealmentFlag; /* 0 gray picture for corrupted intra
                                  1 previous frame used if available */
+
+    /* deblocking of the current picture on application threads while the
+     * rest of the picture is decoded, set by H264SwDecSetFilterCallbacks */
+    void (*filterRows)(void *userData, u32 firstRow, u32 numRows);
+    void (*filterSync)(void *userData);
+    void *filterUserData;
+    u32 asyncFilter;        /* rows of current picture may be handed out */
+    u32 numCompleteMbs;     /* mbs decoded from the start without gaps */
+    u32 numFilteredRows;    /* rows handed to filterRows */
 } storage_t;
 
 /*------------------------------------------------------------------------------
@@ -170,5 +179,8 @@ u32 h264bsdCheckAccessUnitBoundary(
 
 u32 h264bsdValidParamSets(storage_t *pStorage);
 
+void h264bsdFilterDecodedRows(storage_t *pStorage);
+void h264bsdSyncFilter(storage_t *pStorage);
+
 #endif /* #ifdef H264SWDEC_STORAGE_H */
 
@@ -3,12 +3,17 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES:=                     \
         ColorConverter.cpp            \
+        ColorConverterRows.cpp        \
         SoftwareRenderer.cpp
 
 LOCAL_C_INCLUDES := \
         $(TOP)/frameworks/native/include/media/openmax \
         $(TOP)/hardware/msm7k
 
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+    LOCAL_ARM_NEON := true
+endif
+
 LOCAL_MODULE:= libstagefright_color_conversion
 
 include $(BUILD_STATIC_LIBRARY)
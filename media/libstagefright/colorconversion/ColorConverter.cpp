@@ -18,26 +18,189 @@
 #define LOG_TAG "ColorConverter"
 #include <utils/Log.h>
 
+#include "ColorConverterRows.h"
+
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/ColorConverter.h>
 #include <media/stagefright/MediaErrors.h>
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+#include <utils/Thread.h>
+#include <utils/Vector.h>
 
 namespace android {
 
+// A fixed set of worker threads that, together with the thread calling
+// run(), convert one frame as a number of horizontal bands.
+struct ColorConverter::BandPool {
+    BandPool(const ColorConverter *converter, size_t numWorkers);
+    ~BandPool();
+
+    size_t numWorkers() const { return mWorkers.size(); }
+
+    void run(const BitmapParams &src, const BitmapParams &dst,
+             size_t numBands);
+
+private:
+    struct Worker : public Thread {
+        Worker(BandPool *pool)
+            : Thread(false /* canCallJava */),
+              mPool(pool) {
+        }
+
+    private:
+        BandPool *mPool;
+
+        virtual bool threadLoop() {
+            return mPool->workerLoop();
+        }
+    };
+
+    const ColorConverter *mConverter;
+    Vector<sp<Worker> > mWorkers;
+
+    Mutex mLock;
+    Condition mWorkAvailable;
+    Condition mWorkDone;
+    bool mQuit;
+
+    const BitmapParams *mSrc;
+    const BitmapParams *mDst;
+    size_t mNumBands;
+    size_t mNextBand;
+    size_t mBandsPending;
+
+    bool workerLoop();
+
+    // Converts bands until none are left to claim. Called with mLock held.
+    void convertBands_l();
+
+    BandPool(const BandPool &);
+    BandPool &operator=(const BandPool &);
+};
+
+ColorConverter::BandPool::BandPool(
+        const ColorConverter *converter, size_t numWorkers)
+    : mConverter(converter),
+      mQuit(false),
+      mSrc(NULL),
+      mDst(NULL),
+      mNumBands(0),
+      mNextBand(0),
+      mBandsPending(0) {
+    for (size_t i = 0; i < numWorkers; ++i) {
+        sp<Worker> worker = new Worker(this);
+        if (worker->run("ColorConverter", ANDROID_PRIORITY_DISPLAY) != OK) {
+            ALOGW("Failed to start color conversion worker.");
+            break;
+        }
+
+        mWorkers.push(worker);
+    }
+}
+
+ColorConverter::BandPool::~BandPool() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        mQuit = true;
+        mWorkAvailable.broadcast();
+    }
+
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        mWorkers.editItemAt(i)->requestExitAndWait();
+    }
+}
+
+void ColorConverter::BandPool::run(
+        const BitmapParams &src, const BitmapParams &dst, size_t numBands) {
+    Mutex::Autolock autoLock(mLock);
+
+    mSrc = &src;
+    mDst = &dst;
+    mNumBands = numBands;
+    mNextBand = 0;
+    mBandsPending = numBands;
+
+    mWorkAvailable.broadcast();
+
+    convertBands_l();
+
+    while (mBandsPending > 0) {
+        mWorkDone.wait(mLock);
+    }
+
+    mSrc = NULL;
+    mDst = NULL;
+}
+
+bool ColorConverter::BandPool::workerLoop() {
+    Mutex::Autolock autoLock(mLock);
+
+    while (!mQuit && mNextBand >= mNumBands) {
+        mWorkAvailable.wait(mLock);
+    }
+
+    if (mQuit) {
+        return false;
+    }
+
+    convertBands_l();
+
+    return true;
+}
+
+void ColorConverter::BandPool::convertBands_l() {
+    size_t numRows = mDst->cropHeight();
+
+    while (mNextBand < mNumBands) {
+        size_t band = mNextBand++;
+
+        size_t firstRow = numRows * band / mNumBands;
+        size_t lastRow = numRows * (band + 1) / mNumBands;
+
+        mLock.unlock();
+        mConverter->convertRows(*mSrc, *mDst, firstRow, lastRow - firstRow);
+        mLock.lock();
+
+        if (--mBandsPending == 0) {
+            mWorkDone.broadcast();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 ColorConverter::ColorConverter(
         OMX_COLOR_FORMATTYPE from, OMX_COLOR_FORMATTYPE to)
     : mSrcFormat(from),
       mDstFormat(to),
-      mClip(NULL) {
+      mScalingMode(kScalingBox),
+      mNumThreads(1),
+      mBandPool(NULL) {
 }
 
 ColorConverter::~ColorConverter() {
-    delete[] mClip;
-    mClip = NULL;
+    delete mBandPool;
+    mBandPool = NULL;
+}
+
+void ColorConverter::setNumThreads(size_t numThreads) {
+    mNumThreads = (numThreads > 0) ? numThreads : 1;
+
+    if (mBandPool != NULL && mBandPool->numWorkers() + 1 != mNumThreads) {
+        delete mBandPool;
+        mBandPool = NULL;
+    }
+}
+
+void ColorConverter::setScalingMode(ScalingMode mode) {
+    mScalingMode = mode;
 }
 
 bool ColorConverter::isValid() const {
-    if (mDstFormat != OMX_COLOR_Format16bitRGB565) {
+    if (mDstFormat != OMX_COLOR_Format16bitRGB565
+            && mDstFormat != OMX_COLOR_Format32BitRGBA8888
+            && mDstFormat != OMX_COLOR_Format32bitBGRA8888) {
         return false;
     }
 
@@ -85,7 +248,7 @@ status_t ColorConverter::convert(
         size_t dstWidth, size_t dstHeight,
         size_t dstCropLeft, size_t dstCropTop,
         size_t dstCropRight, size_t dstCropBottom) {
-    if (mDstFormat != OMX_COLOR_Format16bitRGB565) {
+    if (!isValid()) {
         return ERROR_UNSUPPORTED;
     }
 
@@ -99,426 +262,404 @@ status_t ColorConverter::convert(
             dstWidth, dstHeight,
             dstCropLeft, dstCropTop, dstCropRight, dstCropBottom);
 
-    status_t err;
-
-    switch (mSrcFormat) {
-        case OMX_COLOR_FormatYUV420Planar:
-            err = convertYUV420Planar(src, dst);
-            break;
-
-        case OMX_COLOR_FormatCbYCrY:
-            err = convertCbYCrY(src, dst);
-            break;
-
-        case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
-            err = convertQCOMYUV420SemiPlanar(src, dst);
-            break;
-
-        case OMX_COLOR_FormatYUV420SemiPlanar:
-            err = convertYUV420SemiPlanar(src, dst);
-            break;
-
-        case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
-            err = convertTIYUV420PackedSemiPlanar(src, dst);
-            break;
-
-        default:
-        {
-            CHECK(!"Should not be here. Unknown color conversion.");
-            break;
-        }
-    }
-
-    return err;
-}
-
-status_t ColorConverter::convertCbYCrY(
-        const BitmapParams &src, const BitmapParams &dst) {
-    // XXX Untested
-
-    uint8_t *kAdjustedClip = initClip();
-
     if (!((src.mCropLeft & 1) == 0
-        && src.cropWidth() == dst.cropWidth()
-        && src.cropHeight() == dst.cropHeight())) {
+            && src.cropWidth() >= dst.cropWidth()
+            && src.cropHeight() >= dst.cropHeight())) {
         return ERROR_UNSUPPORTED;
     }
 
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_ptr = (const uint8_t *)src.mBits
-        + (src.mCropTop * dst.mWidth + src.mCropLeft) * 2;
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_ptr[2 * x + 1] - 16;
-            signed y2 = (signed)src_ptr[2 * x + 3] - 16;
-            signed u = (signed)src_ptr[2 * x] - 128;
-            signed v = (signed)src_ptr[2 * x + 2] - 128;
-
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
-
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
-
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
-
-            uint32_t rgb1 =
-                ((kAdjustedClip[r1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[b1] >> 3);
-
-            uint32_t rgb2 =
-                ((kAdjustedClip[r2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[b2] >> 3);
-
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
-            } else {
-                dst_ptr[x] = rgb1;
-            }
-        }
+    size_t numBands = dst.cropHeight() / kMinRowsPerBand;
+    if (numBands > mNumThreads) {
+        numBands = mNumThreads;
+    }
+
+    if (numBands < 2) {
+        convertRows(src, dst, 0, dst.cropHeight());
+        return OK;
+    }
 
-        src_ptr += src.mWidth * 2;
-        dst_ptr += dst.mWidth;
+    if (mBandPool == NULL) {
+        mBandPool = new BandPool(this, mNumThreads - 1);
     }
 
+    mBandPool->run(src, dst, numBands);
+
     return OK;
 }
 
-status_t ColorConverter::convertYUV420Planar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
-    }
+struct ColorConverter::SourceLayout {
+    // Sample (row, col) of a plane, relative to the source crop origin, is
+    // at mBase[row * mStride + col * mStep]. mCols x mRows samples are
+    // available.
+    struct Plane {
+        const uint8_t *mBase;
+        size_t mStride;
+        size_t mStep;
+        size_t mCols;
+        size_t mRows;
+
+        const uint8_t *rowAt(size_t row) const {
+            return mBase + row * mStride;
+        }
+    };
 
-    uint8_t *kAdjustedClip = initClip();
+    Plane mY, mU, mV;
 
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
+    // Luma row |y| uses chroma row |y >> mChromaRowShift|.
+    size_t mChromaRowShift;
 
-    const uint8_t *src_y =
-        (const uint8_t *)src.mBits + src.mCropTop * src.mWidth + src.mCropLeft;
+    // For semi-planar sources, whether the first byte of each interleaved
+    // chroma pair is V (NV21) rather than U (NV12).
+    bool mVFirst;
+};
 
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * src.mHeight
-        + src.mCropTop * (src.mWidth / 2) + src.mCropLeft / 2;
+void ColorConverter::getSourceLayout(
+        const BitmapParams &src, SourceLayout *layout) const {
+    const uint8_t *bits = (const uint8_t *)src.mBits;
+    size_t chromaCols = (src.cropWidth() + 1) / 2;
+    size_t chromaRows = (src.cropHeight() + 1) / 2;
 
-    const uint8_t *src_v =
-        src_u + (src.mWidth / 2) * (src.mHeight / 2);
+    SourceLayout::Plane &y = layout->mY;
+    SourceLayout::Plane &u = layout->mU;
+    SourceLayout::Plane &v = layout->mV;
 
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            // B = 1.164 * (Y - 16) + 2.018 * (U - 128)
-            // G = 1.164 * (Y - 16) - 0.813 * (V - 128) - 0.391 * (U - 128)
-            // R = 1.164 * (Y - 16) + 1.596 * (V - 128)
+    y.mStride = src.mWidth;
+    y.mStep = 1;
+    y.mCols = src.cropWidth();
+    y.mRows = src.cropHeight();
 
-            // B = 298/256 * (Y - 16) + 517/256 * (U - 128)
-            // G = .................. - 208/256 * (V - 128) - 100/256 * (U - 128)
-            // R = .................. + 409/256 * (V - 128)
+    u.mCols = v.mCols = chromaCols;
+    u.mRows = v.mRows = chromaRows;
 
-            // min_B = (298 * (- 16) + 517 * (- 128)) / 256 = -277
-            // min_G = (298 * (- 16) - 208 * (255 - 128) - 100 * (255 - 128)) / 256 = -172
-            // min_R = (298 * (- 16) + 409 * (- 128)) / 256 = -223
+    layout->mChromaRowShift = 1;
+    layout->mVFirst = false;
 
-            // max_B = (298 * (255 - 16) + 517 * (255 - 128)) / 256 = 534
-            // max_G = (298 * (255 - 16) - 208 * (- 128) - 100 * (- 128)) / 256 = 432
-            // max_R = (298 * (255 - 16) + 409 * (255 - 128)) / 256 = 481
+    switch (mSrcFormat) {
+        case OMX_COLOR_FormatYUV420Planar:
+        {
+            y.mBase = bits + src.mCropTop * src.mWidth + src.mCropLeft;
 
-            // clip range -278 .. 535
+            u.mBase = y.mBase + src.mWidth * src.mHeight
+                + src.mCropTop * (src.mWidth / 2) + src.mCropLeft / 2;
+            u.mStride = src.mWidth / 2;
+            u.mStep = 1;
+
+            v.mBase = u.mBase + (src.mWidth / 2) * (src.mHeight / 2);
+            v.mStride = src.mWidth / 2;
+            v.mStep = 1;
+            break;
+        }
+
+        case OMX_COLOR_FormatCbYCrY:
+        {
+            // XXX Untested
 
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
+            const uint8_t *base = bits
+                + (src.mCropTop * src.mWidth + src.mCropLeft) * 2;
 
-            signed u = (signed)src_u[x / 2] - 128;
-            signed v = (signed)src_v[x / 2] - 128;
+            y.mBase = base + 1;
+            y.mStride = src.mWidth * 2;
+            y.mStep = 2;
 
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
+            u.mBase = base;
+            v.mBase = base + 2;
+            u.mStride = v.mStride = src.mWidth * 2;
+            u.mStep = v.mStep = 4;
+            u.mRows = v.mRows = src.cropHeight();
 
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
+            layout->mChromaRowShift = 0;
+            break;
+        }
 
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
+        case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
+        case OMX_COLOR_FormatYUV420SemiPlanar:
+        {
+            y.mBase = bits + src.mCropTop * src.mWidth + src.mCropLeft;
 
-            uint32_t rgb1 =
-                ((kAdjustedClip[r1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[b1] >> 3);
+            const uint8_t *uv = y.mBase + src.mWidth * src.mHeight
+                + src.mCropTop * src.mWidth + src.mCropLeft;
 
-            uint32_t rgb2 =
-                ((kAdjustedClip[r2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[b2] >> 3);
+            layout->mVFirst =
+                (mSrcFormat == OMX_QCOM_COLOR_FormatYVU420SemiPlanar);
 
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
+            if (layout->mVFirst) {
+                v.mBase = uv;
+                u.mBase = uv + 1;
             } else {
-                dst_ptr[x] = rgb1;
+                u.mBase = uv;
+                v.mBase = uv + 1;
             }
+
+            u.mStride = v.mStride = src.mWidth;
+            u.mStep = v.mStep = 2;
+            break;
         }
 
-        src_y += src.mWidth;
+        case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
+        {
+            y.mBase = bits;
 
-        if (y & 1) {
-            src_u += src.mWidth / 2;
-            src_v += src.mWidth / 2;
+            u.mBase = bits + src.mWidth * (src.mHeight - src.mCropTop / 2);
+            v.mBase = u.mBase + 1;
+            u.mStride = v.mStride = src.mWidth;
+            u.mStep = v.mStep = 2;
+            break;
         }
 
-        dst_ptr += dst.mWidth;
+        default:
+        {
+            CHECK(!"Should not be here. Unknown color conversion.");
+            break;
+        }
     }
-
-    return OK;
 }
 
-status_t ColorConverter::convertQCOMYUV420SemiPlanar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    uint8_t *kAdjustedClip = initClip();
-
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
-    }
-
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_y =
-        (const uint8_t *)src.mBits + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * src.mHeight
-        + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
+bool ColorConverter::swapRB() const {
+    return mDstFormat == OMX_COLOR_Format32bitBGRA8888;
+}
 
-            signed u = (signed)src_u[x & ~1] - 128;
-            signed v = (signed)src_u[(x & ~1) + 1] - 128;
+uint8_t *ColorConverter::dstRow(const BitmapParams &dst, size_t row) const {
+    size_t bpp = (mDstFormat == OMX_COLOR_Format16bitRGB565) ? 2 : 4;
 
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
+    return (uint8_t *)dst.mBits
+        + ((dst.mCropTop + row) * dst.mWidth + dst.mCropLeft) * bpp;
+}
 
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
+void ColorConverter::convertRows(
+        const BitmapParams &src, const BitmapParams &dst,
+        size_t firstRow, size_t numRows) const {
+    SourceLayout layout;
+    getSourceLayout(src, &layout);
 
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
+    if (src.cropWidth() != dst.cropWidth()
+            || src.cropHeight() != dst.cropHeight()) {
+        convertScaledRows(src, dst, layout, firstRow, numRows);
+        return;
+    }
 
-            uint32_t rgb1 =
-                ((kAdjustedClip[b1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[r1] >> 3);
+    bool rgb565 = (mDstFormat == OMX_COLOR_Format16bitRGB565);
+    bool swap = swapRB();
 
-            uint32_t rgb2 =
-                ((kAdjustedClip[b2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[r2] >> 3);
+    for (size_t y = firstRow; y < firstRow + numRows; ++y) {
+        const uint8_t *row_y = layout.mY.rowAt(y);
+        const uint8_t *row_u = layout.mU.rowAt(y >> layout.mChromaRowShift);
+        const uint8_t *row_v = layout.mV.rowAt(y >> layout.mChromaRowShift);
+        uint8_t *dst_ptr = dstRow(dst, y);
 
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
+        if (layout.mY.mStep == 2) {
+            // Packed CbYCrY, the row starts with the first U sample.
+            if (rgb565) {
+                ConvertRowCbYCrYToRGB565(
+                        row_u, src.cropWidth(), swap, (uint16_t *)dst_ptr);
             } else {
-                dst_ptr[x] = rgb1;
+                ConvertRowCbYCrYToRGBA8888(
+                        row_u, src.cropWidth(), swap, dst_ptr);
             }
-        }
-
-        src_y += src.mWidth;
+        } else if (layout.mU.mStep == 1) {
+            if (rgb565) {
+                ConvertRowPlanarToRGB565(
+                        row_y, row_u, row_v, src.cropWidth(), swap,
+                        (uint16_t *)dst_ptr);
+            } else {
+                ConvertRowPlanarToRGBA8888(
+                        row_y, row_u, row_v, src.cropWidth(), swap, dst_ptr);
+            }
+        } else {
+            const uint8_t *row_uv = layout.mVFirst ? row_v : row_u;
 
-        if (y & 1) {
-            src_u += src.mWidth;
+            if (rgb565) {
+                ConvertRowSemiPlanarToRGB565(
+                        row_y, row_uv, layout.mVFirst, src.cropWidth(), swap,
+                        (uint16_t *)dst_ptr);
+            } else {
+                ConvertRowSemiPlanarToRGBA8888(
+                        row_y, row_uv, layout.mVFirst, src.cropWidth(), swap,
+                        dst_ptr);
+            }
         }
-
-        dst_ptr += dst.mWidth;
     }
-
-    return OK;
 }
 
-status_t ColorConverter::convertYUV420SemiPlanar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    // XXX Untested
-
-    uint8_t *kAdjustedClip = initClip();
-
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
-    }
-
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
-
-    const uint8_t *src_y =
-        (const uint8_t *)src.mBits + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * src.mHeight
-        + src.mCropTop * src.mWidth + src.mCropLeft;
-
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
-
-            signed v = (signed)src_u[x & ~1] - 128;
-            signed u = (signed)src_u[(x & ~1) + 1] - 128;
+// One output sample of a resampled line. For the box filter it averages
+// mCount input samples starting at mStart, for the bilinear filter it
+// blends mStart and the following sample by mWeight / 256.
+struct ScaleTap {
+    size_t mStart;
+    size_t mCount;
+    unsigned mWeight;
+};
+
+// Computes the tap of output sample |index| when resampling a line of
+// |srcLen| samples to |dstLen| samples. Chroma lines use the luma lengths,
+// as both are subsampled by the same factor, and |limit| is the number of
+// input samples actually available.
+static ScaleTap ComputeScaleTap(
+        ColorConverter::ScalingMode mode,
+        size_t srcLen, size_t dstLen, size_t index, size_t limit) {
+    ScaleTap tap;
+
+    if (mode == ColorConverter::kScalingBox) {
+        size_t start = index * srcLen / dstLen;
+        size_t end = (index + 1) * srcLen / dstLen;
+
+        if (start > limit - 1) {
+            start = limit - 1;
+        }
+        if (end > limit) {
+            end = limit;
+        }
+        if (end <= start) {
+            end = start + 1;
+        }
 
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
+        tap.mStart = start;
+        tap.mCount = end - start;
+        tap.mWeight = 0;
+    } else {
+        // Sample centers, in 1/256 units of the input.
+        int64_t pos =
+            (int64_t)(2 * index + 1) * srcLen * 256 / (2 * dstLen) - 128;
 
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
+        if (pos < 0) {
+            pos = 0;
+        }
 
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
+        tap.mStart = pos >> 8;
+        tap.mCount = 2;
+        tap.mWeight = pos & 0xff;
 
-            uint32_t rgb1 =
-                ((kAdjustedClip[b1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[r1] >> 3);
+        if (tap.mStart + 1 >= limit) {
+            tap.mStart = limit - 1;
+            tap.mCount = 1;
+            tap.mWeight = 0;
+        }
+    }
 
-            uint32_t rgb2 =
-                ((kAdjustedClip[b2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[r2] >> 3);
+    return tap;
+}
 
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
-            } else {
-                dst_ptr[x] = rgb1;
+static void ResampleLine(
+        ColorConverter::ScalingMode mode,
+        const ScaleTap &rowTap, const ScaleTap *colTaps, size_t count,
+        const uint8_t *base, size_t stride, size_t step, uint8_t *out) {
+    if (mode == ColorConverter::kScalingBox) {
+        for (size_t i = 0; i < count; ++i) {
+            const ScaleTap &colTap = colTaps[i];
+
+            unsigned sum = 0;
+            for (size_t r = 0; r < rowTap.mCount; ++r) {
+                const uint8_t *in = base
+                    + (rowTap.mStart + r) * stride + colTap.mStart * step;
+
+                for (size_t c = 0; c < colTap.mCount; ++c) {
+                    sum += in[c * step];
+                }
             }
-        }
-
-        src_y += src.mWidth;
 
-        if (y & 1) {
-            src_u += src.mWidth;
+            unsigned n = rowTap.mCount * colTap.mCount;
+            out[i] = (sum + n / 2) / n;
         }
 
-        dst_ptr += dst.mWidth;
+        return;
     }
 
-    return OK;
-}
+    const uint8_t *top = base + rowTap.mStart * stride;
+    const uint8_t *bottom =
+        (rowTap.mCount > 1) ? top + stride : top;
+    unsigned wy = rowTap.mWeight;
 
-status_t ColorConverter::convertTIYUV420PackedSemiPlanar(
-        const BitmapParams &src, const BitmapParams &dst) {
-    uint8_t *kAdjustedClip = initClip();
+    for (size_t i = 0; i < count; ++i) {
+        const ScaleTap &colTap = colTaps[i];
 
-    if (!((src.mCropLeft & 1) == 0
-            && src.cropWidth() == dst.cropWidth()
-            && src.cropHeight() == dst.cropHeight())) {
-        return ERROR_UNSUPPORTED;
-    }
-
-    uint16_t *dst_ptr = (uint16_t *)dst.mBits
-        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
+        size_t c0 = colTap.mStart * step;
+        size_t c1 = (colTap.mCount > 1) ? c0 + step : c0;
+        unsigned wx = colTap.mWeight;
 
-    const uint8_t *src_y = (const uint8_t *)src.mBits;
+        unsigned t = top[c0] * (256 - wx) + top[c1] * wx;
+        unsigned b = bottom[c0] * (256 - wx) + bottom[c1] * wx;
 
-    const uint8_t *src_u =
-        (const uint8_t *)src_y + src.mWidth * (src.mHeight - src.mCropTop / 2);
+        out[i] = (t * (256 - wy) + b * wy + 32768) >> 16;
+    }
+}
 
-    for (size_t y = 0; y < src.cropHeight(); ++y) {
-        for (size_t x = 0; x < src.cropWidth(); x += 2) {
-            signed y1 = (signed)src_y[x] - 16;
-            signed y2 = (signed)src_y[x + 1] - 16;
+void ColorConverter::convertScaledRows(
+        const BitmapParams &src, const BitmapParams &dst,
+        const SourceLayout &layout,
+        size_t firstRow, size_t numRows) const {
+    size_t srcWidth = src.cropWidth();
+    size_t srcHeight = src.cropHeight();
+    size_t dstWidth = dst.cropWidth();
+    size_t dstHeight = dst.cropHeight();
+    size_t chromaWidth = (dstWidth + 1) / 2;
+
+    // The row kernels read the luma sample following an odd last pixel.
+    uint8_t *row_y = new uint8_t[dstWidth + 1];
+    uint8_t *row_u = new uint8_t[chromaWidth];
+    uint8_t *row_v = new uint8_t[chromaWidth];
+    row_y[dstWidth] = 0;
+
+    ScaleTap *lumaTaps = new ScaleTap[dstWidth];
+    for (size_t x = 0; x < dstWidth; ++x) {
+        lumaTaps[x] = ComputeScaleTap(
+                mScalingMode, srcWidth, dstWidth, x, layout.mY.mCols);
+    }
 
-            signed u = (signed)src_u[x & ~1] - 128;
-            signed v = (signed)src_u[(x & ~1) + 1] - 128;
+    ScaleTap *chromaTaps = new ScaleTap[chromaWidth];
+    for (size_t x = 0; x < chromaWidth; ++x) {
+        chromaTaps[x] = ComputeScaleTap(
+                mScalingMode, srcWidth, dstWidth, x, layout.mU.mCols);
+    }
 
-            signed u_b = u * 517;
-            signed u_g = -u * 100;
-            signed v_g = -v * 208;
-            signed v_r = v * 409;
+    bool rgb565 = (mDstFormat == OMX_COLOR_Format16bitRGB565);
+    bool swap = swapRB();
 
-            signed tmp1 = y1 * 298;
-            signed b1 = (tmp1 + u_b) / 256;
-            signed g1 = (tmp1 + v_g + u_g) / 256;
-            signed r1 = (tmp1 + v_r) / 256;
+    for (size_t y = firstRow; y < firstRow + numRows; ++y) {
+        ScaleTap lumaRowTap = ComputeScaleTap(
+                mScalingMode, srcHeight, dstHeight, y, layout.mY.mRows);
 
-            signed tmp2 = y2 * 298;
-            signed b2 = (tmp2 + u_b) / 256;
-            signed g2 = (tmp2 + v_g + u_g) / 256;
-            signed r2 = (tmp2 + v_r) / 256;
+        // Like chroma columns, subsampled chroma rows map through the luma
+        // scaling factor.
+        ScaleTap chromaRowTap = ComputeScaleTap(
+                mScalingMode, srcHeight, dstHeight,
+                y >> layout.mChromaRowShift, layout.mU.mRows);
 
-            uint32_t rgb1 =
-                ((kAdjustedClip[r1] >> 3) << 11)
-                | ((kAdjustedClip[g1] >> 2) << 5)
-                | (kAdjustedClip[b1] >> 3);
+        ResampleLine(
+                mScalingMode, lumaRowTap, lumaTaps, dstWidth,
+                layout.mY.mBase, layout.mY.mStride, layout.mY.mStep, row_y);
 
-            uint32_t rgb2 =
-                ((kAdjustedClip[r2] >> 3) << 11)
-                | ((kAdjustedClip[g2] >> 2) << 5)
-                | (kAdjustedClip[b2] >> 3);
+        ResampleLine(
+                mScalingMode, chromaRowTap, chromaTaps, chromaWidth,
+                layout.mU.mBase, layout.mU.mStride, layout.mU.mStep, row_u);
 
-            if (x + 1 < src.cropWidth()) {
-                *(uint32_t *)(&dst_ptr[x]) = (rgb2 << 16) | rgb1;
-            } else {
-                dst_ptr[x] = rgb1;
-            }
-        }
+        ResampleLine(
+                mScalingMode, chromaRowTap, chromaTaps, chromaWidth,
+                layout.mV.mBase, layout.mV.mStride, layout.mV.mStep, row_v);
 
-        src_y += src.mWidth;
+        uint8_t *dst_ptr = dstRow(dst, y);
 
-        if (y & 1) {
-            src_u += src.mWidth;
+        if (rgb565) {
+            ConvertRowPlanarToRGB565(
+                    row_y, row_u, row_v, dstWidth, swap, (uint16_t *)dst_ptr);
+        } else {
+            ConvertRowPlanarToRGBA8888(
+                    row_y, row_u, row_v, dstWidth, swap, dst_ptr);
         }
-
-        dst_ptr += dst.mWidth;
     }
 
-    return OK;
-}
+    delete[] chromaTaps;
+    chromaTaps = NULL;
 
-uint8_t *ColorConverter::initClip() {
-    static const signed kClipMin = -278;
-    static const signed kClipMax = 535;
+    delete[] lumaTaps;
+    lumaTaps = NULL;
 
-    if (mClip == NULL) {
-        mClip = new uint8_t[kClipMax - kClipMin + 1];
+    delete[] row_v;
+    row_v = NULL;
 
-        for (signed i = kClipMin; i <= kClipMax; ++i) {
-            mClip[i - kClipMin] = (i < 0) ? 0 : (i > 255) ? 255 : (uint8_t)i;
-        }
-    }
+    delete[] row_u;
+    row_u = NULL;
 
-    return &mClip[-kClipMin];
+    delete[] row_y;
+    row_y = NULL;
 }
 
 }  // namespace android
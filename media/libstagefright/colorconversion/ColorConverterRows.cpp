@@ -0,0 +1,458 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ColorConverterRows.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2 1
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define USE_NEON 1
+#endif
+
+namespace android {
+
+// B = 1.164 * (Y - 16) + 2.018 * (U - 128)
+// G = 1.164 * (Y - 16) - 0.813 * (V - 128) - 0.391 * (U - 128)
+// R = 1.164 * (Y - 16) + 1.596 * (V - 128)
+
+// B = 298/256 * (Y - 16) + 517/256 * (U - 128)
+// G = .................. - 208/256 * (V - 128) - 100/256 * (U - 128)
+// R = .................. + 409/256 * (V - 128)
+
+// The intermediate values lie in -277 .. 534. Anything below zero clips to
+// zero, so an arithmetic shift by 8 yields the same clipped result as the
+// division by 256 used in the scalar code, which lets the vector code below
+// stay bit-exact.
+
+static inline unsigned Clip(signed x) {
+    return (x < 0) ? 0 : (x > 255) ? 255 : (unsigned)x;
+}
+
+struct RGB565Writer {
+    enum { kBytesPerPixel = 2 };
+
+    static inline void write(
+            uint8_t *dst, unsigned r, unsigned g, unsigned b) {
+        *(uint16_t *)dst = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+
+#if USE_SSE2
+    // r, g and b are 16-bit lanes in 0 .. 255.
+    static inline void write8(uint8_t *dst, __m128i r, __m128i g, __m128i b) {
+        const __m128i kMaskR = _mm_set1_epi16(0xf8);
+        const __m128i kMaskG = _mm_set1_epi16(0xfc);
+
+        __m128i rgb = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_slli_epi16(_mm_and_si128(r, kMaskR), 8),
+                    _mm_slli_epi16(_mm_and_si128(g, kMaskG), 3)),
+                _mm_srli_epi16(b, 3));
+
+        _mm_storeu_si128((__m128i *)dst, rgb);
+    }
+#elif USE_NEON
+    static inline void write8(
+            uint8_t *dst, uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+        uint16x8_t rgb = vshll_n_u8(r, 8);
+        rgb = vsriq_n_u16(rgb, vshll_n_u8(g, 8), 5);
+        rgb = vsriq_n_u16(rgb, vshll_n_u8(b, 8), 11);
+
+        vst1q_u16((uint16_t *)dst, rgb);
+    }
+#endif
+};
+
+struct RGBA8888Writer {
+    enum { kBytesPerPixel = 4 };
+
+    static inline void write(
+            uint8_t *dst, unsigned r, unsigned g, unsigned b) {
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+        dst[3] = 0xff;
+    }
+
+#if USE_SSE2
+    static inline void write8(uint8_t *dst, __m128i r, __m128i g, __m128i b) {
+        __m128i rg = _mm_unpacklo_epi8(
+                _mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+
+        __m128i ba = _mm_unpacklo_epi8(
+                _mm_packus_epi16(b, b), _mm_set1_epi8((char)0xff));
+
+        _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+#elif USE_NEON
+    static inline void write8(
+            uint8_t *dst, uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+        uint8x8x4_t rgba;
+        rgba.val[0] = r;
+        rgba.val[1] = g;
+        rgba.val[2] = b;
+        rgba.val[3] = vdup_n_u8(0xff);
+
+        vst4_u8(dst, rgba);
+    }
+#endif
+};
+
+// Converts the two pixels sharing one chroma sample. The second pixel is
+// only written if |writeSecond| is set, but like the original code its luma
+// is always read.
+template<class Writer>
+static inline void ConvertPair(
+        unsigned y1, unsigned y2, unsigned u, unsigned v,
+        bool swapRB, bool writeSecond, uint8_t *dst) {
+    signed u_b = ((signed)u - 128) * 517;
+    signed u_g = -((signed)u - 128) * 100;
+    signed v_g = -((signed)v - 128) * 208;
+    signed v_r = ((signed)v - 128) * 409;
+
+    signed tmp1 = ((signed)y1 - 16) * 298;
+    unsigned b1 = Clip((tmp1 + u_b) / 256);
+    unsigned g1 = Clip((tmp1 + v_g + u_g) / 256);
+    unsigned r1 = Clip((tmp1 + v_r) / 256);
+
+    signed tmp2 = ((signed)y2 - 16) * 298;
+    unsigned b2 = Clip((tmp2 + u_b) / 256);
+    unsigned g2 = Clip((tmp2 + v_g + u_g) / 256);
+    unsigned r2 = Clip((tmp2 + v_r) / 256);
+
+    if (swapRB) {
+        Writer::write(dst, b1, g1, r1);
+    } else {
+        Writer::write(dst, r1, g1, b1);
+    }
+
+    if (!writeSecond) {
+        return;
+    }
+
+    dst += Writer::kBytesPerPixel;
+
+    if (swapRB) {
+        Writer::write(dst, b2, g2, r2);
+    } else {
+        Writer::write(dst, r2, g2, b2);
+    }
+}
+
+#if USE_SSE2
+
+typedef __m128i Vec8;
+
+static inline __m128i Coeffs(int16_t even, int16_t odd) {
+    return _mm_set_epi16(odd, even, odd, even, odd, even, odd, even);
+}
+
+// |y|, |u| and |v| hold Y - 16, U - 128 and V - 128 of eight pixels as
+// signed 16-bit lanes.
+template<class Writer>
+static inline void Convert8(
+        Vec8 y, Vec8 u, Vec8 v, bool swapRB, uint8_t *dst) {
+    const __m128i kZero = _mm_setzero_si128();
+    const __m128i kMax = _mm_set1_epi16(255);
+
+    __m128i yu_lo = _mm_unpacklo_epi16(y, u);
+    __m128i yu_hi = _mm_unpackhi_epi16(y, u);
+    __m128i yv_lo = _mm_unpacklo_epi16(y, v);
+    __m128i yv_hi = _mm_unpackhi_epi16(y, v);
+    __m128i v_lo = _mm_unpacklo_epi16(v, kZero);
+    __m128i v_hi = _mm_unpackhi_epi16(v, kZero);
+
+    const __m128i kR = Coeffs(298, 409);
+    const __m128i kGYU = Coeffs(298, -100);
+    const __m128i kGV = Coeffs(-208, 0);
+    const __m128i kB = Coeffs(298, 517);
+
+    __m128i r = _mm_packs_epi32(
+            _mm_srai_epi32(_mm_madd_epi16(yv_lo, kR), 8),
+            _mm_srai_epi32(_mm_madd_epi16(yv_hi, kR), 8));
+
+    __m128i g = _mm_packs_epi32(
+            _mm_srai_epi32(
+                _mm_add_epi32(
+                    _mm_madd_epi16(yu_lo, kGYU), _mm_madd_epi16(v_lo, kGV)),
+                8),
+            _mm_srai_epi32(
+                _mm_add_epi32(
+                    _mm_madd_epi16(yu_hi, kGYU), _mm_madd_epi16(v_hi, kGV)),
+                8));
+
+    __m128i b = _mm_packs_epi32(
+            _mm_srai_epi32(_mm_madd_epi16(yu_lo, kB), 8),
+            _mm_srai_epi32(_mm_madd_epi16(yu_hi, kB), 8));
+
+    r = _mm_min_epi16(_mm_max_epi16(r, kZero), kMax);
+    g = _mm_min_epi16(_mm_max_epi16(g, kZero), kMax);
+    b = _mm_min_epi16(_mm_max_epi16(b, kZero), kMax);
+
+    if (swapRB) {
+        Writer::write8(dst, b, g, r);
+    } else {
+        Writer::write8(dst, r, g, b);
+    }
+}
+
+static inline Vec8 LoadLuma8(const uint8_t *y) {
+    return _mm_sub_epi16(
+            _mm_unpacklo_epi8(
+                _mm_loadl_epi64((const __m128i *)y), _mm_setzero_si128()),
+            _mm_set1_epi16(16));
+}
+
+// Four chroma samples, each duplicated for the two pixels it covers.
+static inline Vec8 LoadChroma4(const uint8_t *c) {
+    int32_t tmp;
+    memcpy(&tmp, c, sizeof(tmp));
+
+    __m128i x = _mm_unpacklo_epi8(
+            _mm_cvtsi32_si128(tmp), _mm_setzero_si128());
+
+    return _mm_sub_epi16(_mm_unpacklo_epi16(x, x), _mm_set1_epi16(128));
+}
+
+// |c| holds 16-bit lanes c0 .. c7 of four interleaved chroma pairs. Splits
+// them into c0 c0 c2 c2 c4 c4 c6 c6 and c1 c1 c3 c3 c5 c5 c7 c7.
+static inline void SplitChromaPairs(Vec8 c, Vec8 *even, Vec8 *odd) {
+    const __m128i kBias = _mm_set1_epi16(128);
+
+    *even = _mm_sub_epi16(
+            _mm_shufflehi_epi16(
+                _mm_shufflelo_epi16(c, _MM_SHUFFLE(2, 2, 0, 0)),
+                _MM_SHUFFLE(2, 2, 0, 0)),
+            kBias);
+
+    *odd = _mm_sub_epi16(
+            _mm_shufflehi_epi16(
+                _mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 1, 1)),
+                _MM_SHUFFLE(3, 3, 1, 1)),
+            kBias);
+}
+
+static inline void LoadSemiPlanarChroma8(
+        const uint8_t *uv, Vec8 *even, Vec8 *odd) {
+    SplitChromaPairs(
+            _mm_unpacklo_epi8(
+                _mm_loadl_epi64((const __m128i *)uv), _mm_setzero_si128()),
+            even, odd);
+}
+
+static inline void LoadCbYCrY8(
+        const uint8_t *src, Vec8 *y, Vec8 *u, Vec8 *v) {
+    __m128i x = _mm_loadu_si128((const __m128i *)src);
+
+    *y = _mm_sub_epi16(_mm_srli_epi16(x, 8), _mm_set1_epi16(16));
+    SplitChromaPairs(_mm_and_si128(x, _mm_set1_epi16(0xff)), u, v);
+}
+
+#elif USE_NEON
+
+typedef int16x8_t Vec8;
+
+template<class Writer>
+static inline void Convert8(
+        Vec8 y, Vec8 u, Vec8 v, bool swapRB, uint8_t *dst) {
+    int32x4_t y_lo = vmull_n_s16(vget_low_s16(y), 298);
+    int32x4_t y_hi = vmull_n_s16(vget_high_s16(y), 298);
+
+    int32x4_t r_lo = vmlal_n_s16(y_lo, vget_low_s16(v), 409);
+    int32x4_t r_hi = vmlal_n_s16(y_hi, vget_high_s16(v), 409);
+
+    int32x4_t g_lo = vmlal_n_s16(
+            vmlal_n_s16(y_lo, vget_low_s16(v), -208), vget_low_s16(u), -100);
+    int32x4_t g_hi = vmlal_n_s16(
+            vmlal_n_s16(y_hi, vget_high_s16(v), -208), vget_high_s16(u), -100);
+
+    int32x4_t b_lo = vmlal_n_s16(y_lo, vget_low_s16(u), 517);
+    int32x4_t b_hi = vmlal_n_s16(y_hi, vget_high_s16(u), 517);
+
+    uint8x8_t r = vqmovun_s16(
+            vcombine_s16(vshrn_n_s32(r_lo, 8), vshrn_n_s32(r_hi, 8)));
+    uint8x8_t g = vqmovun_s16(
+            vcombine_s16(vshrn_n_s32(g_lo, 8), vshrn_n_s32(g_hi, 8)));
+    uint8x8_t b = vqmovun_s16(
+            vcombine_s16(vshrn_n_s32(b_lo, 8), vshrn_n_s32(b_hi, 8)));
+
+    if (swapRB) {
+        Writer::write8(dst, b, g, r);
+    } else {
+        Writer::write8(dst, r, g, b);
+    }
+}
+
+static inline Vec8 Widen(uint8x8_t x, int16_t bias) {
+    return vsubq_s16(
+            vreinterpretq_s16_u16(vmovl_u8(x)), vdupq_n_s16(bias));
+}
+
+static inline Vec8 LoadLuma8(const uint8_t *y) {
+    return Widen(vld1_u8(y), 16);
+}
+
+static inline Vec8 LoadChroma4(const uint8_t *c) {
+    uint32_t tmp;
+    memcpy(&tmp, c, sizeof(tmp));
+
+    uint8x8_t x = vreinterpret_u8_u32(vdup_n_u32(tmp));
+
+    return Widen(vzip_u8(x, x).val[0], 128);
+}
+
+// c0 .. c7 -> c0 c0 c2 c2 c4 c4 c6 c6 and c1 c1 c3 c3 c5 c5 c7 c7.
+static inline void SplitChromaPairs(uint8x8_t c, Vec8 *even, Vec8 *odd) {
+    uint8x8x2_t split = vuzp_u8(c, c);
+
+    *even = Widen(vzip_u8(split.val[0], split.val[0]).val[0], 128);
+    *odd = Widen(vzip_u8(split.val[1], split.val[1]).val[0], 128);
+}
+
+static inline void LoadSemiPlanarChroma8(
+        const uint8_t *uv, Vec8 *even, Vec8 *odd) {
+    SplitChromaPairs(vld1_u8(uv), even, odd);
+}
+
+static inline void LoadCbYCrY8(
+        const uint8_t *src, Vec8 *y, Vec8 *u, Vec8 *v) {
+    uint8x8x2_t x = vld2_u8(src);
+
+    *y = Widen(x.val[1], 16);
+    SplitChromaPairs(x.val[0], u, v);
+}
+
+#endif  // USE_NEON
+
+template<class Writer>
+static void ConvertRowPlanar(
+        const uint8_t *y, const uint8_t *u, const uint8_t *v,
+        size_t width, bool swapRB, uint8_t *dst) {
+    size_t x = 0;
+
+#if USE_SSE2 || USE_NEON
+    for (; x + 8 <= width; x += 8) {
+        Convert8<Writer>(
+                LoadLuma8(&y[x]),
+                LoadChroma4(&u[x / 2]),
+                LoadChroma4(&v[x / 2]),
+                swapRB,
+                &dst[x * Writer::kBytesPerPixel]);
+    }
+#endif
+
+    for (; x < width; x += 2) {
+        ConvertPair<Writer>(
+                y[x], y[x + 1], u[x / 2], v[x / 2],
+                swapRB, x + 1 < width, &dst[x * Writer::kBytesPerPixel]);
+    }
+}
+
+template<class Writer>
+static void ConvertRowSemiPlanar(
+        const uint8_t *y, const uint8_t *uv, bool vFirst,
+        size_t width, bool swapRB, uint8_t *dst) {
+    size_t x = 0;
+
+#if USE_SSE2 || USE_NEON
+    for (; x + 8 <= width; x += 8) {
+        Vec8 first, second;
+        LoadSemiPlanarChroma8(&uv[x], &first, &second);
+
+        Convert8<Writer>(
+                LoadLuma8(&y[x]),
+                vFirst ? second : first,
+                vFirst ? first : second,
+                swapRB,
+                &dst[x * Writer::kBytesPerPixel]);
+    }
+#endif
+
+    for (; x < width; x += 2) {
+        unsigned first = uv[x];
+        unsigned second = uv[x + 1];
+
+        ConvertPair<Writer>(
+                y[x], y[x + 1],
+                vFirst ? second : first,
+                vFirst ? first : second,
+                swapRB, x + 1 < width, &dst[x * Writer::kBytesPerPixel]);
+    }
+}
+
+template<class Writer>
+static void ConvertRowCbYCrY(
+        const uint8_t *src, size_t width, bool swapRB, uint8_t *dst) {
+    size_t x = 0;
+
+#if USE_SSE2 || USE_NEON
+    for (; x + 8 <= width; x += 8) {
+        Vec8 y, u, v;
+        LoadCbYCrY8(&src[2 * x], &y, &u, &v);
+
+        Convert8<Writer>(y, u, v, swapRB, &dst[x * Writer::kBytesPerPixel]);
+    }
+#endif
+
+    for (; x < width; x += 2) {
+        ConvertPair<Writer>(
+                src[2 * x + 1], src[2 * x + 3], src[2 * x], src[2 * x + 2],
+                swapRB, x + 1 < width, &dst[x * Writer::kBytesPerPixel]);
+    }
+}
+
+void ConvertRowPlanarToRGB565(
+        const uint8_t *y, const uint8_t *u, const uint8_t *v,
+        size_t width, bool swapRB, uint16_t *dst) {
+    ConvertRowPlanar<RGB565Writer>(
+            y, u, v, width, swapRB, (uint8_t *)dst);
+}
+
+void ConvertRowPlanarToRGBA8888(
+        const uint8_t *y, const uint8_t *u, const uint8_t *v,
+        size_t width, bool swapRB, uint8_t *dst) {
+    ConvertRowPlanar<RGBA8888Writer>(y, u, v, width, swapRB, dst);
+}
+
+void ConvertRowSemiPlanarToRGB565(
+        const uint8_t *y, const uint8_t *uv, bool vFirst,
+        size_t width, bool swapRB, uint16_t *dst) {
+    ConvertRowSemiPlanar<RGB565Writer>(
+            y, uv, vFirst, width, swapRB, (uint8_t *)dst);
+}
+
+void ConvertRowSemiPlanarToRGBA8888(
+        const uint8_t *y, const uint8_t *uv, bool vFirst,
+        size_t width, bool swapRB, uint8_t *dst) {
+    ConvertRowSemiPlanar<RGBA8888Writer>(
+            y, uv, vFirst, width, swapRB, dst);
+}
+
+void ConvertRowCbYCrYToRGB565(
+        const uint8_t *src, size_t width, bool swapRB, uint16_t *dst) {
+    ConvertRowCbYCrY<RGB565Writer>(src, width, swapRB, (uint8_t *)dst);
+}
+
+void ConvertRowCbYCrYToRGBA8888(
+        const uint8_t *src, size_t width, bool swapRB, uint8_t *dst) {
+    ConvertRowCbYCrY<RGBA8888Writer>(src, width, swapRB, dst);
+}
+
+}  // namespace android
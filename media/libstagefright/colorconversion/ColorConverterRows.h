@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COLOR_CONVERTER_ROWS_H_
+
+#define COLOR_CONVERTER_ROWS_H_
+
+#include <sys/types.h>
+#include <stdint.h>
+
+namespace android {
+
+// Per-row YUV -> RGB kernels shared by all of ColorConverter's source
+// formats. Every kernel converts |width| pixels of a single row and is
+// bit-exact with the original table based per-pixel code, i.e.
+//
+//   R = clip((298 * (Y - 16) + 409 * (V - 128)) >> 8)
+//   G = clip((298 * (Y - 16) - 208 * (V - 128) - 100 * (U - 128)) >> 8)
+//   B = clip((298 * (Y - 16) + 517 * (U - 128)) >> 8)
+//
+// If |swapRB| is set, R and B trade places in the output, as needed for
+// BGRA8888. It is independent of the source chroma order.
+//
+// SSE2 and NEON versions are selected at compile time, the scalar code
+// handles the remaining pixels of each row.
+
+// |u| and |v| hold one sample per two pixels.
+void ConvertRowPlanarToRGB565(
+        const uint8_t *y, const uint8_t *u, const uint8_t *v,
+        size_t width, bool swapRB, uint16_t *dst);
+
+void ConvertRowPlanarToRGBA8888(
+        const uint8_t *y, const uint8_t *u, const uint8_t *v,
+        size_t width, bool swapRB, uint8_t *dst);
+
+// |uv| holds interleaved chroma pairs, one pair per two pixels. If |vFirst|
+// is set, the first byte of each pair is V, otherwise U.
+void ConvertRowSemiPlanarToRGB565(
+        const uint8_t *y, const uint8_t *uv, bool vFirst,
+        size_t width, bool swapRB, uint16_t *dst);
+
+void ConvertRowSemiPlanarToRGBA8888(
+        const uint8_t *y, const uint8_t *uv, bool vFirst,
+        size_t width, bool swapRB, uint8_t *dst);
+
+// |src| is packed U0 Y0 V0 Y1.
+void ConvertRowCbYCrYToRGB565(
+        const uint8_t *src, size_t width, bool swapRB, uint16_t *dst);
+
+void ConvertRowCbYCrYToRGBA8888(
+        const uint8_t *src, size_t width, bool swapRB, uint8_t *dst);
+
+}  // namespace android
+
+#endif  // COLOR_CONVERTER_ROWS_H_
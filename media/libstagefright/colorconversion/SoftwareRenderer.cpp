@@ -21,6 +21,7 @@
 
 #include <cutils/properties.h> // for property_get
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/cpucount.h>
 #include <media/stagefright/MetaData.h>
 #include <system/window.h>
 #include <ui/GraphicBufferMapper.h>
@@ -28,6 +29,9 @@
 
 namespace android {
 
+// The decoder runs concurrently with the renderer, leave it the other cores.
+static const size_t kMaxConverterThreads = 2;
+
 static bool runningInEmulator() {
     char prop[PROPERTY_VALUE_MAX];
     return (property_get("ro.kernel.qemu", prop, NULL) > 0);
@@ -86,6 +90,13 @@ SoftwareRenderer::SoftwareRenderer(
             mConverter = new ColorConverter(
                     mColorFormat, OMX_COLOR_Format16bitRGB565);
             CHECK(mConverter->isValid());
+
+            {
+                size_t numThreads = GetCPUCoreCount();
+                mConverter->setNumThreads(
+                        numThreads < kMaxConverterThreads
+                            ? numThreads : kMaxConverterThreads);
+            }
             break;
     }
 
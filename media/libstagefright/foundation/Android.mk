@@ -12,6 +12,7 @@ LOCAL_SRC_FILES:=                 \
     AMessage.cpp                  \
     AString.cpp                   \
     base64.cpp                    \
+    cpucount.cpp                  \
     hexdump.cpp
 
 LOCAL_C_INCLUDES:= \
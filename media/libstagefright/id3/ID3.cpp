@@ -30,12 +30,26 @@ namespace android {
 
 static const size_t kMaxMetadataSize = 3 * 1024 * 1024;
 
+// Size of the ID3v2 tag header, all offsets into the tag are relative to
+// its end.
+static const size_t kHeaderSize = 10;
+
+// Read up front together with the tag header, large enough for the frame
+// headers and text frames of most tags.
+static const size_t kPrefetchSize = 4096;
+
+// Enough of an APIC frame to hold the mime type and description.
+static const size_t kAlbumArtHeaderSize = 1024;
+
 ID3::ID3(const sp<DataSource> &source, bool ignoreV1)
     : mIsValid(false),
       mData(NULL),
       mSize(0),
+      mPrefetch(NULL),
+      mPrefetchSize(0),
       mFirstFrameOffset(0),
-      mVersion(ID3_UNKNOWN) {
+      mVersion(ID3_UNKNOWN),
+      mAlbumArt(NULL) {
     mIsValid = parseV2(source);
 
     if (!mIsValid && !ignoreV1) {
@@ -44,10 +58,31 @@ ID3::ID3(const sp<DataSource> &source, bool ignoreV1)
 }
 
 ID3::~ID3() {
+    clear();
+}
+
+void ID3::clear() {
+    for (size_t i = 0; i < mFrames.size(); ++i) {
+        free(mFrames[i].mData);
+    }
+    mFrames.clear();
+
     if (mData) {
         free(mData);
         mData = NULL;
     }
+
+    if (mPrefetch) {
+        free(mPrefetch);
+        mPrefetch = NULL;
+    }
+
+    if (mAlbumArt) {
+        free(mAlbumArt);
+        mAlbumArt = NULL;
+    }
+
+    mSource.clear();
 }
 
 bool ID3::isValid() const {
@@ -72,6 +107,20 @@ bool ID3::ParseSyncsafeInteger(const uint8_t encoded[4], size_t *x) {
     return true;
 }
 
+// Removes the 0x00 following every 0xff in place, returns the new size.
+static size_t RemoveUnsynchronization(uint8_t *data, size_t size) {
+    size_t out = 0;
+    for (size_t i = 0; i < size; ++i) {
+        data[out++] = data[i];
+
+        if (data[i] == 0xff && i + 1 < size && data[i + 1] == 0x00) {
+            ++i;
+        }
+    }
+
+    return out;
+}
+
 bool ID3::parseV2(const sp<DataSource> &source) {
 struct id3_header {
     char id[3];
@@ -133,69 +182,50 @@ struct id3_header {
         return false;
     }
 
-    mData = (uint8_t *)malloc(size);
-
-    if (mData == NULL) {
-        return false;
-    }
-
+    mSource = source;
     mSize = size;
 
-    if (source->readAt(sizeof(header), mData, mSize) != (ssize_t)mSize) {
-        free(mData);
-        mData = NULL;
-
-        return false;
-    }
-
-    if (header.version_major == 4) {
-        void *copy = malloc(size);
-        memcpy(copy, mData, size);
-
-        bool success = removeUnsynchronizationV2_4(false /* iTunesHack */);
-        if (!success) {
-            memcpy(mData, copy, size);
-            mSize = size;
+    if (header.version_major < 4 && (header.flags & 0x80)) {
+        // Before version 2.4 unsynchronization covers the frame headers
+        // as well, the tag can only be indexed once it is removed from
+        // the tag as a whole.
+        ALOGV("removing unsynchronization");
 
-            success = removeUnsynchronizationV2_4(true /* iTunesHack */);
+        mData = (uint8_t *)malloc(size);
 
-            if (success) {
-                ALOGV("Had to apply the iTunes hack to parse this ID3 tag");
-            }
+        if (mData == NULL
+                || source->readAt(kHeaderSize, mData, size) != (ssize_t)size) {
+            clear();
+            return false;
         }
 
-        free(copy);
-        copy = NULL;
-
-        if (!success) {
-            free(mData);
-            mData = NULL;
+        mSize = RemoveUnsynchronization(mData, size);
+    } else {
+        mPrefetchSize = size < kPrefetchSize ? size : kPrefetchSize;
+        mPrefetch = (uint8_t *)malloc(mPrefetchSize);
 
+        if (mPrefetch == NULL
+                || source->readAt(kHeaderSize, mPrefetch, mPrefetchSize)
+                        != (ssize_t)mPrefetchSize) {
+            clear();
             return false;
         }
-    } else if (header.flags & 0x80) {
-        ALOGV("removing unsynchronization");
-
-        removeUnsynchronization();
     }
 
     mFirstFrameOffset = 0;
     if (header.version_major == 3 && (header.flags & 0x40)) {
         // Version 2.3 has an optional extended header.
 
-        if (mSize < 4) {
-            free(mData);
-            mData = NULL;
-
+        uint8_t extendedHeader[10];
+        if (!readTag(0, extendedHeader, 4)) {
+            clear();
             return false;
         }
 
-        size_t extendedHeaderSize = U32_AT(&mData[0]) + 4;
+        size_t extendedHeaderSize = U32_AT(&extendedHeader[0]) + 4;
 
         if (extendedHeaderSize > mSize) {
-            free(mData);
-            mData = NULL;
-
+            clear();
             return false;
         }
 
@@ -203,15 +233,19 @@ struct id3_header {
 
         uint16_t extendedFlags = 0;
         if (extendedHeaderSize >= 6) {
-            extendedFlags = U16_AT(&mData[4]);
+            if (!readTag(0, extendedHeader,
+                         extendedHeaderSize < 10 ? extendedHeaderSize : 10)) {
+                clear();
+                return false;
+            }
+
+            extendedFlags = U16_AT(&extendedHeader[4]);
 
             if (extendedHeaderSize >= 10) {
-                size_t paddingSize = U32_AT(&mData[6]);
+                size_t paddingSize = U32_AT(&extendedHeader[6]);
 
                 if (mFirstFrameOffset + paddingSize > mSize) {
-                    free(mData);
-                    mData = NULL;
-
+                    clear();
                     return false;
                 }
 
@@ -226,25 +260,20 @@ struct id3_header {
         // Version 2.4 has an optional extended header, that's different
         // from Version 2.3's...
 
-        if (mSize < 4) {
-            free(mData);
-            mData = NULL;
-
+        uint8_t extendedHeader[4];
+        if (!readTag(0, extendedHeader, 4)) {
+            clear();
             return false;
         }
 
         size_t ext_size;
-        if (!ParseSyncsafeInteger(mData, &ext_size)) {
-            free(mData);
-            mData = NULL;
-
+        if (!ParseSyncsafeInteger(extendedHeader, &ext_size)) {
+            clear();
             return false;
         }
 
         if (ext_size < 6 || ext_size > mSize) {
-            free(mData);
-            mData = NULL;
-
+            clear();
             return false;
         }
 
@@ -260,94 +289,165 @@ struct id3_header {
         mVersion = ID3_V2_4;
     }
 
-    return true;
-}
+    if (!buildFrameIndex(false /* iTunesHack */)) {
+        mFrames.clear();
 
-void ID3::removeUnsynchronization() {
-    for (size_t i = 0; i + 1 < mSize; ++i) {
-        if (mData[i] == 0xff && mData[i + 1] == 0x00) {
-            memmove(&mData[i + 1], &mData[i + 2], mSize - i - 2);
-            --mSize;
+        if (!buildFrameIndex(true /* iTunesHack */)) {
+            clear();
+            mVersion = ID3_UNKNOWN;
+            return false;
         }
+
+        ALOGV("Had to apply the iTunes hack to parse this ID3 tag");
     }
+
+    return true;
 }
 
-static void WriteSyncsafeInteger(uint8_t *dst, size_t x) {
-    for (size_t i = 0; i < 4; ++i) {
-        dst[3 - i] = (x & 0x7f);
-        x >>= 7;
+bool ID3::readTag(size_t offset, void *data, size_t size) const {
+    if (offset > mSize || size > mSize - offset) {
+        return false;
+    }
+
+    if (mData != NULL) {
+        memcpy(data, &mData[offset], size);
+        return true;
     }
+
+    if (offset + size <= mPrefetchSize) {
+        memcpy(data, &mPrefetch[offset], size);
+        return true;
+    }
+
+    return mSource->readAt(kHeaderSize + offset, data, size) == (ssize_t)size;
 }
 
-bool ID3::removeUnsynchronizationV2_4(bool iTunesHack) {
-    size_t oldSize = mSize;
+// Walks the frame headers of an ID3v2 tag. iTunes writes version 2.4 tags
+// with plain instead of syncsafe frame sizes, iTunesHack reads them that
+// way. Only fails for version 2.4 tags whose frames don't add up, earlier
+// versions simply end at the first partial frame.
+bool ID3::buildFrameIndex(bool iTunesHack) {
+    size_t headerLength = (mVersion == ID3_V2_2) ? 6 : 10;
 
-    size_t offset = 0;
-    while (offset + 10 <= mSize) {
-        if (!memcmp(&mData[offset], "\0\0\0\0", 4)) {
-            break;
+    size_t offset = mFirstFrameOffset;
+    while (offset + headerLength <= mSize) {
+        uint8_t header[10];
+        if (!readTag(offset, header, headerLength)) {
+            return mVersion != ID3_V2_4;
         }
 
-        size_t dataSize;
-        if (iTunesHack) {
-            dataSize = U32_AT(&mData[offset + 4]);
-        } else if (!ParseSyncsafeInteger(&mData[offset + 4], &dataSize)) {
-            return false;
+        Frame frame;
+        frame.mOffset = offset + headerLength;
+        frame.mFlags = 0;
+        frame.mData = NULL;
+        frame.mDataSize = 0;
+
+        if (mVersion == ID3_V2_2) {
+            if (!memcmp(header, "\0\0\0", 3)) {
+                break;
+            }
+
+            memcpy(frame.mID, header, 3);
+            frame.mID[3] = '\0';
+
+            frame.mSize = (header[3] << 16) | (header[4] << 8) | header[5];
+        } else {
+            if (!memcmp(header, "\0\0\0\0", 4)) {
+                break;
+            }
+
+            memcpy(frame.mID, header, 4);
+            frame.mID[4] = '\0';
+
+            if (mVersion == ID3_V2_3 || iTunesHack) {
+                frame.mSize = U32_AT(&header[4]);
+            } else if (!ParseSyncsafeInteger(&header[4], &frame.mSize)) {
+                return false;
+            }
+
+            frame.mFlags = U16_AT(&header[8]);
         }
 
-        if (offset + dataSize + 10 > mSize) {
-            return false;
+        if (frame.mSize > mSize - frame.mOffset) {
+            ALOGV("partial frame at offset %d (size = %d, bytes-remaining = %d)",
+                 offset, frame.mSize, mSize - frame.mOffset);
+
+            return mVersion != ID3_V2_4;
         }
 
-        uint16_t flags = U16_AT(&mData[offset + 8]);
-        uint16_t prevFlags = flags;
+        offset = frame.mOffset + frame.mSize;
 
-        if (flags & 1) {
-            // Strip data length indicator
+        if ((mVersion == ID3_V2_4 && (frame.mFlags & 0x000c))
+            || (mVersion == ID3_V2_3 && (frame.mFlags & 0x00c0))) {
+            // Compression or encryption are not supported at this time.
 
-            memmove(&mData[offset + 10], &mData[offset + 14], mSize - offset - 14);
-            mSize -= 4;
-            dataSize -= 4;
+            ALOGV("Skipping unsupported frame (compression or encryption "
+                 "flagged");
 
-            flags &= ~1;
+            continue;
         }
 
-        if (flags & 2) {
-            // Unsynchronization added.
+        mFrames.push(frame);
+    }
 
-            for (size_t i = 0; i + 1 < dataSize; ++i) {
-                if (mData[offset + 10 + i] == 0xff
-                        && mData[offset + 11 + i] == 0x00) {
-                    memmove(&mData[offset + 11 + i], &mData[offset + 12 + i],
-                            mSize - offset - 12 - i);
-                    --mSize;
-                    --dataSize;
-                }
+    return true;
+}
+
+const uint8_t *ID3::loadFrame(const Frame &frame, size_t *size) const {
+    if (mData != NULL) {
+        *size = frame.mSize;
+        return &mData[frame.mOffset];
+    }
+
+    if (frame.mData == NULL) {
+        uint8_t *data = (uint8_t *)malloc(frame.mSize > 0 ? frame.mSize : 1);
+        if (data == NULL) {
+            return NULL;
+        }
+
+        if (!readTag(frame.mOffset, data, frame.mSize)) {
+            free(data);
+            return NULL;
+        }
+
+        size_t dataSize = frame.mSize;
+
+        if (mVersion == ID3_V2_4 && (frame.mFlags & 1)) {
+            // Strip data length indicator
+
+            if (dataSize < 4) {
+                free(data);
+                return NULL;
             }
 
-            flags &= ~2;
+            memmove(data, &data[4], dataSize - 4);
+            dataSize -= 4;
         }
 
-        if (flags != prevFlags || iTunesHack) {
-            WriteSyncsafeInteger(&mData[offset + 4], dataSize);
-            mData[offset + 8] = flags >> 8;
-            mData[offset + 9] = flags & 0xff;
+        if (mVersion == ID3_V2_4 && (frame.mFlags & 2)) {
+            // Unsynchronization added.
+
+            dataSize = RemoveUnsynchronization(data, dataSize);
         }
 
-        offset += 10 + dataSize;
+        frame.mData = data;
+        frame.mDataSize = dataSize;
     }
 
-    memset(&mData[mSize], 0, oldSize - mSize);
-
-    return true;
+    *size = frame.mDataSize;
+    return frame.mData;
 }
 
 ID3::Iterator::Iterator(const ID3 &parent, const char *id)
     : mParent(parent),
       mID(NULL),
-      mOffset(mParent.mFirstFrameOffset),
+      mOffset(0),
       mFrameData(NULL),
       mFrameSize(0) {
+    if (mParent.mVersion == ID3_V1 || mParent.mVersion == ID3_V1_1) {
+        mOffset = mParent.mFirstFrameOffset;
+    }
+
     if (id) {
         mID = strdup(id);
     }
@@ -371,7 +471,11 @@ void ID3::Iterator::next() {
         return;
     }
 
-    mOffset += mFrameSize;
+    if (mParent.mVersion == ID3_V1 || mParent.mVersion == ID3_V1_1) {
+        mOffset += mFrameSize;
+    } else {
+        ++mOffset;
+    }
 
     findFrame();
 }
@@ -383,10 +487,10 @@ void ID3::Iterator::getID(String8 *id) const {
         return;
     }
 
-    if (mParent.mVersion == ID3_V2_2) {
-        id->setTo((const char *)&mParent.mData[mOffset], 3);
-    } else if (mParent.mVersion == ID3_V2_3 || mParent.mVersion == ID3_V2_4) {
-        id->setTo((const char *)&mParent.mData[mOffset], 4);
+    if (mParent.mVersion == ID3_V2_2
+            || mParent.mVersion == ID3_V2_3
+            || mParent.mVersion == ID3_V2_4) {
+        id->setTo(mParent.mFrames[mOffset].mID);
     } else {
         CHECK(mParent.mVersion == ID3_V1 || mParent.mVersion == ID3_V1_1);
 
@@ -482,8 +586,6 @@ void ID3::Iterator::getstring(String8 *id, bool otherdata) const {
         return;
     }
 
-    uint8_t encoding = *frameData;
-
     if (mParent.mVersion == ID3_V1 || mParent.mVersion == ID3_V1_1) {
         if (mOffset == 126 || mOffset == 127) {
             // Special treatment for the track number and genre.
@@ -498,6 +600,13 @@ void ID3::Iterator::getstring(String8 *id, bool otherdata) const {
         return;
     }
 
+    if (mFrameSize <= getHeaderLength()) {
+        // Not even the encoding byte.
+        return;
+    }
+
+    uint8_t encoding = *frameData;
+
     size_t n = mFrameSize - getHeaderLength() - 1;
     if (otherdata) {
         // skip past the encoding, language, and the 0 separator
@@ -588,97 +697,30 @@ void ID3::Iterator::findFrame() {
         mFrameData = NULL;
         mFrameSize = 0;
 
-        if (mParent.mVersion == ID3_V2_2) {
-            if (mOffset + 6 > mParent.mSize) {
-                return;
-            }
-
-            if (!memcmp(&mParent.mData[mOffset], "\0\0\0", 3)) {
-                return;
-            }
-
-            mFrameSize =
-                (mParent.mData[mOffset + 3] << 16)
-                | (mParent.mData[mOffset + 4] << 8)
-                | mParent.mData[mOffset + 5];
-
-            mFrameSize += 6;
-
-            if (mOffset + mFrameSize > mParent.mSize) {
-                ALOGV("partial frame at offset %d (size = %d, bytes-remaining = %d)",
-                     mOffset, mFrameSize, mParent.mSize - mOffset - 6);
-                return;
-            }
-
-            mFrameData = &mParent.mData[mOffset + 6];
-
-            if (!mID) {
-                break;
-            }
-
-            char id[4];
-            memcpy(id, &mParent.mData[mOffset], 3);
-            id[3] = '\0';
-
-            if (!strcmp(id, mID)) {
-                break;
-            }
-        } else if (mParent.mVersion == ID3_V2_3
+        if (mParent.mVersion == ID3_V2_2
+                || mParent.mVersion == ID3_V2_3
                 || mParent.mVersion == ID3_V2_4) {
-            if (mOffset + 10 > mParent.mSize) {
+            if (mOffset >= mParent.mFrames.size()) {
                 return;
             }
 
-            if (!memcmp(&mParent.mData[mOffset], "\0\0\0\0", 4)) {
-                return;
-            }
+            const Frame &frame = mParent.mFrames[mOffset];
 
-            size_t baseSize;
-            if (mParent.mVersion == ID3_V2_4) {
-                if (!ParseSyncsafeInteger(
-                            &mParent.mData[mOffset + 4], &baseSize)) {
-                    return;
-                }
-            } else {
-                baseSize = U32_AT(&mParent.mData[mOffset + 4]);
-            }
-
-            mFrameSize = 10 + baseSize;
-
-            if (mOffset + mFrameSize > mParent.mSize) {
-                ALOGV("partial frame at offset %d (size = %d, bytes-remaining = %d)",
-                     mOffset, mFrameSize, mParent.mSize - mOffset - 10);
-                return;
-            }
-
-            uint16_t flags = U16_AT(&mParent.mData[mOffset + 8]);
-
-            if ((mParent.mVersion == ID3_V2_4 && (flags & 0x000c))
-                || (mParent.mVersion == ID3_V2_3 && (flags & 0x00c0))) {
-                // Compression or encryption are not supported at this time.
-                // Per-frame unsynchronization and data-length indicator
-                // have already been taken care of.
+            if (!mID || !strcmp(frame.mID, mID)) {
+                size_t size;
+                const uint8_t *data = mParent.loadFrame(frame, &size);
 
-                ALOGV("Skipping unsupported frame (compression, encryption "
-                     "or per-frame unsynchronization flagged");
-
-                mOffset += mFrameSize;
-                continue;
-            }
-
-            mFrameData = &mParent.mData[mOffset + 10];
+                if (data != NULL) {
+                    mFrameData = data;
+                    mFrameSize = getHeaderLength() + size;
+                    break;
+                }
 
-            if (!mID) {
-                break;
+                ALOGV("Skipping unreadable frame '%s'", frame.mID);
             }
 
-            char id[5];
-            memcpy(id, &mParent.mData[mOffset], 4);
-            id[4] = '\0';
-
-            if (!strcmp(id, mID)) {
-                break;
-            }
+            ++mOffset;
+            continue;
         } else {
             CHECK(mParent.mVersion == ID3_V1 || mParent.mVersion == ID3_V1_1);
 
@@ -731,20 +773,95 @@ void ID3::Iterator::findFrame() {
     }
 }
 
-static size_t StringSize(const uint8_t *start, uint8_t encoding) {
+// Size of the string at start including its null termination, or 0 if it
+// isn't terminated within size bytes.
+static size_t StringSize(const uint8_t *start, size_t size, uint8_t encoding) {
     if (encoding == 0x00 || encoding == 0x03) {
         // ISO 8859-1 or UTF-8
-        return strlen((const char *)start) + 1;
+        const void *end = memchr(start, '\0', size);
+        return end != NULL ? (const uint8_t *)end - start + 1 : 0;
     }
 
     // UCS-2
     size_t n = 0;
-    while (start[n] != '\0' || start[n + 1] != '\0') {
+    while (n + 1 < size) {
+        if (start[n] == '\0' && start[n + 1] == '\0') {
+            // Add size of null termination.
+            return n + 2;
+        }
         n += 2;
     }
 
-    // Add size of null termination.
-    return n + 2;
+    return 0;
+}
+
+// Finds the picture in the first size bytes of an APIC or PIC frame,
+// returns false if they end before the picture starts.
+static bool ParseAlbumArtHeader(
+        const uint8_t *data, size_t size, bool isV2_2,
+        size_t *headerLength, String8 *mime) {
+    if (size < 1) {
+        return false;
+    }
+
+    uint8_t encoding = data[0];
+
+    if (!isV2_2) {
+        size_t mimeLen = StringSize(&data[1], size - 1, 0x00);
+        if (mimeLen == 0 || 2 + mimeLen > size) {
+            return false;
+        }
+
+        mime->setTo((const char *)&data[1]);
+
+#if 0
+        uint8_t picType = data[1 + mimeLen];
+        if (picType != 0x03) {
+            // Front Cover Art
+            return false;
+        }
+#endif
+
+        size_t descLen =
+            StringSize(&data[2 + mimeLen], size - 2 - mimeLen, encoding);
+
+        if (descLen == 0) {
+            return false;
+        }
+
+        *headerLength = 2 + mimeLen + descLen;
+        return true;
+    }
+
+    if (size < 5) {
+        return false;
+    }
+
+    if (!memcmp(&data[1], "PNG", 3)) {
+        mime->setTo("image/png");
+    } else if (!memcmp(&data[1], "JPG", 3)) {
+        mime->setTo("image/jpeg");
+    } else if (!memcmp(&data[1], "-->", 3)) {
+        mime->setTo("text/plain");
+    } else {
+        return false;
+    }
+
+#if 0
+    uint8_t picType = data[4];
+    if (picType != 0x03) {
+        // Front Cover Art
+        return false;
+    }
+#endif
+
+    size_t descLen = StringSize(&data[5], size - 5, encoding);
+    if (descLen == 0) {
+        return false;
+    }
+
+    *headerLength = 5 + descLen;
+    return true;
 }
 
 const void *
@@ -752,64 +869,78 @@ ID3::getAlbumArt(size_t *length, String8 *mime) const {
     *length = 0;
     mime->setTo("");
 
-    Iterator it(
-            *this,
-            (mVersion == ID3_V2_3 || mVersion == ID3_V2_4) ? "APIC" : "PIC");
+    if (mVersion != ID3_V2_2
+            && mVersion != ID3_V2_3
+            && mVersion != ID3_V2_4) {
+        return NULL;
+    }
 
-    while (!it.done()) {
-        size_t size;
-        const uint8_t *data = it.getData(&size);
+    const char *id = (mVersion == ID3_V2_2) ? "PIC" : "APIC";
 
-        if (mVersion == ID3_V2_3 || mVersion == ID3_V2_4) {
-            uint8_t encoding = data[0];
-            mime->setTo((const char *)&data[1]);
-            size_t mimeLen = strlen((const char *)&data[1]) + 1;
+    size_t index = 0;
+    while (index < mFrames.size() && strcmp(mFrames[index].mID, id)) {
+        ++index;
+    }
 
-            uint8_t picType = data[1 + mimeLen];
-#if 0
-            if (picType != 0x03) {
-                // Front Cover Art
-                it.next();
-                continue;
-            }
-#endif
+    if (index == mFrames.size()) {
+        return NULL;
+    }
 
-            size_t descLen = StringSize(&data[2 + mimeLen], encoding);
+    const Frame &frame = mFrames[index];
+    size_t headerLength;
 
-            *length = size - 2 - mimeLen - descLen;
+    if (mData == NULL && frame.mData == NULL && !(frame.mFlags & 3)) {
+        // The picture is stored as is, read the frame's header fields and
+        // then the picture straight into its own buffer.
 
-            return &data[2 + mimeLen + descLen];
-        } else {
-            uint8_t encoding = data[0];
-
-            if (!memcmp(&data[1], "PNG", 3)) {
-                mime->setTo("image/png");
-            } else if (!memcmp(&data[1], "JPG", 3)) {
-                mime->setTo("image/jpeg");
-            } else if (!memcmp(&data[1], "-->", 3)) {
-                mime->setTo("text/plain");
-            } else {
-                return NULL;
-            }
+        uint8_t header[kAlbumArtHeaderSize];
+        size_t headerSize =
+            frame.mSize < kAlbumArtHeaderSize
+                ? frame.mSize : kAlbumArtHeaderSize;
 
-#if 0
-            uint8_t picType = data[4];
-            if (picType != 0x03) {
-                // Front Cover Art
-                it.next();
-                continue;
+        if (readTag(frame.mOffset, header, headerSize)
+                && ParseAlbumArtHeader(
+                    header, headerSize, mVersion == ID3_V2_2,
+                    &headerLength, mime)) {
+            size_t artSize = frame.mSize - headerLength;
+
+            if (mAlbumArt) {
+                free(mAlbumArt);
             }
-#endif
+            mAlbumArt = (uint8_t *)malloc(artSize > 0 ? artSize : 1);
 
-            size_t descLen = StringSize(&data[5], encoding);
+            if (mAlbumArt == NULL
+                    || !readTag(frame.mOffset + headerLength,
+                                mAlbumArt, artSize)) {
+                mime->setTo("");
+                return NULL;
+            }
 
-            *length = size - 5 - descLen;
+            *length = artSize;
+            return mAlbumArt;
+        }
 
-            return &data[5 + descLen];
+        if (headerSize == frame.mSize) {
+            mime->setTo("");
+            return NULL;
         }
+
+        // Unusually long description, look at the whole frame.
     }
 
-    return NULL;
+    size_t size;
+    const uint8_t *data = loadFrame(frame, &size);
+
+    if (data == NULL
+            || !ParseAlbumArtHeader(
+                data, size, mVersion == ID3_V2_2, &headerLength, mime)) {
+        mime->setTo("");
+        return NULL;
+    }
+
+    *length = size - headerLength;
+
+    return &data[headerLength];
 }
 
 bool ID3::parseV1(const sp<DataSource> &source) {
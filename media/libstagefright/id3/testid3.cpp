@@ -17,9 +17,11 @@
 #include "../include/ID3.h"
 
 #include <sys/stat.h>
+#include <sys/time.h>
 
 #include <ctype.h>
 #include <dirent.h>
+#include <unistd.h>
 
 #include <binder/ProcessState.h>
 #include <media/stagefright/FileSource.h>
@@ -68,7 +70,54 @@ static void hexdump(const void *_data, size_t size) {
     }
 }
 
+static bool gBenchmark = false;
+static size_t gNumFiles = 0;
+static int64_t gTitleUs = 0;
+static int64_t gAlbumArtUs = 0;
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+// Times what a media scan asks of a tag, the title alone and the title
+// plus the album art.
+static void benchmarkFile(const char *path) {
+    sp<FileSource> file = new FileSource(path);
+    CHECK_EQ(file->initCheck(), (status_t)OK);
+
+    int64_t startUs = getNowUs();
+    {
+        ID3 tag(file);
+        ID3::Iterator it(tag, "TIT2");
+        if (it.done()) {
+            ID3::Iterator it2(tag, "TT2");
+        }
+    }
+    gTitleUs += getNowUs() - startUs;
+
+    startUs = getNowUs();
+    {
+        ID3 tag(file);
+        ID3::Iterator it(tag, "TIT2");
+
+        size_t dataSize;
+        String8 mime;
+        tag.getAlbumArt(&dataSize, &mime);
+    }
+    gAlbumArtUs += getNowUs() - startUs;
+
+    ++gNumFiles;
+}
+
 void scanFile(const char *path) {
+    if (gBenchmark) {
+        benchmarkFile(path);
+        return;
+    }
+
     sp<FileSource> file = new FileSource(path);
     CHECK_EQ(file->initCheck(), (status_t)OK);
 
@@ -156,9 +205,33 @@ int main(int argc, char **argv) {
 
     DataSource::RegisterDefaultSniffers();
 
-    for (int i = 1; i < argc; ++i) {
+    int res;
+    while ((res = getopt(argc, argv, "b")) >= 0) {
+        switch (res) {
+            case 'b':
+                gBenchmark = true;
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-b] <file or directory> ...\n",
+                        argv[0]);
+                fprintf(stderr, "       -b time tag parsing instead of "
+                                "dumping tags\n");
+                return 1;
+        }
+    }
+
+    for (int i = optind; i < argc; ++i) {
         scan(argv[i]);
     }
 
+    if (gBenchmark && gNumFiles > 0) {
+        printf("%zu files, title %.2f ms/file, title and album art "
+               "%.2f ms/file\n",
+               gNumFiles,
+               gTitleUs / 1E3 / gNumFiles,
+               gAlbumArtUs / 1E3 / gNumFiles);
+    }
+
     return 0;
 }
@@ -19,6 +19,7 @@
 #define ID3_H_
 
 #include <utils/RefBase.h>
+#include <utils/Vector.h>
 
 namespace android {
 
@@ -42,6 +43,8 @@ struct ID3 {
 
     Version version() const;
 
+    // Only the picture itself is read from the source, straight into a
+    // buffer owned by this object, the rest of the frame is skipped.
     const void *getAlbumArt(size_t *length, String8 *mime) const;
 
     struct Iterator {
@@ -57,6 +60,9 @@ struct ID3 {
     private:
         const ID3 &mParent;
         char *mID;
+
+        // Offset of the current field into an ID3v1 tag, index of the
+        // current frame in the frame index otherwise.
         size_t mOffset;
 
         const uint8_t *mFrameData;
@@ -72,16 +78,42 @@ struct ID3 {
     };
 
 private:
+    // An ID3v2 frame, located from its header alone. The payload is only
+    // read, and per-frame unsynchronization only removed, on first access.
+    struct Frame {
+        char mID[5];
+        size_t mOffset;
+        size_t mSize;
+        uint16_t mFlags;
+
+        mutable uint8_t *mData;
+        mutable size_t mDataSize;
+    };
+
     bool mIsValid;
+    sp<DataSource> mSource;
+
+    // The complete tag, for ID3v1 tags and for ID3v2.2/2.3 tags that are
+    // unsynchronized as a whole. NULL otherwise.
     uint8_t *mData;
     size_t mSize;
+
+    // The start of the tag, which usually holds all the text frames.
+    uint8_t *mPrefetch;
+    size_t mPrefetchSize;
+
     size_t mFirstFrameOffset;
     Version mVersion;
+    Vector<Frame> mFrames;
+
+    mutable uint8_t *mAlbumArt;
 
     bool parseV1(const sp<DataSource> &source);
     bool parseV2(const sp<DataSource> &source);
-    void removeUnsynchronization();
-    bool removeUnsynchronizationV2_4(bool iTunesHack);
+    void clear();
+    bool readTag(size_t offset, void *data, size_t size) const;
+    bool buildFrameIndex(bool iTunesHack);
+    const uint8_t *loadFrame(const Frame &frame, size_t *size) const;
 
     static bool ParseSyncsafeInteger(const uint8_t encoded[4], size_t *x);
 
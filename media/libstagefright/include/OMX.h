@@ -109,8 +109,13 @@ public:
             const char *parameter_name,
             OMX_INDEXTYPE *index);
 
+    virtual status_t setBufferRing(
+            node_id node, const sp<OMXBufferRing> &ring);
+
     virtual void binderDied(const wp<IBinder> &the_late_who);
 
+    virtual status_t dump(int fd, const Vector<String16> &args);
+
     OMX_ERRORTYPE OnEvent(
             node_id node,
             OMX_IN OMX_EVENTTYPE eEvent,
@@ -143,6 +148,7 @@ private:
 
     node_id makeNodeID(OMXNodeInstance *instance);
     OMXNodeInstance *findInstance(node_id node);
+    OMXNodeInstance *findInstanceAfterRequests(node_id node);
     sp<CallbackDispatcher> findDispatcher(node_id node);
 
     void invalidateNodeID_l(node_id node);
@@ -26,6 +26,7 @@
 namespace android {
 
 class IOMXObserver;
+struct OMXBufferRing;
 struct OMXMaster;
 struct GraphicBufferSource;
 
@@ -96,7 +97,13 @@ struct OMXNodeInstance {
     status_t getExtensionIndex(
             const char *parameterName, OMX_INDEXTYPE *index);
 
-    void onMessage(const omx_message &msg);
+    status_t setBufferRing(const sp<OMXBufferRing> &ring);
+
+    // Carries out the fillBuffer()/emptyBuffer() requests queued in the
+    // buffer ring so far.
+    void processBufferRequests();
+
+    void onMessages(const List<omx_message> &messages);
     void onObserverDied(OMXMaster *master);
     void onGetHandleFailed();
     void onEvent(OMX_EVENTTYPE event, OMX_U32 arg1, OMX_U32 arg2);
@@ -104,6 +111,9 @@ struct OMXNodeInstance {
     static OMX_CALLBACKTYPE kCallbacks;
 
 private:
+    // Returns false for the messages the observer must not see.
+    bool handleMessage(const omx_message &msg);
+
     Mutex mLock;
 
     OMX *mOwner;
@@ -118,6 +128,17 @@ private:
     // Access this through getGraphicBufferSource().
     sp<GraphicBufferSource> mGraphicBufferSource;
 
+    struct BufferRingThread;
+
+    // Lock only covers mBufferRing and mBufferRingThread, for the same
+    // reason as mGraphicBufferSourceLock.
+    Mutex mBufferRingLock;
+    sp<OMXBufferRing> mBufferRing;
+    sp<BufferRingThread> mBufferRingThread;
+
+    // Held while the requests of the ring are carried out, so that they
+    // run one at a time and in order.
+    Mutex mBufferRequestLock;
 
     struct ActiveBuffer {
         OMX_U32 mPortIndex;
@@ -156,6 +177,11 @@ private:
     sp<GraphicBufferSource> getGraphicBufferSource();
     void setGraphicBufferSource(const sp<GraphicBufferSource>& bufferSource);
 
+    sp<OMXBufferRing> getBufferRing();
+    void stopBufferRing();
+    void postMessages(
+            const sp<OMXBufferRing> &ring, const List<omx_message> &messages);
+
     OMXNodeInstance(const OMXNodeInstance &);
     OMXNodeInstance &operator=(const OMXNodeInstance &);
 };
@@ -19,6 +19,7 @@
 #define SIMPLE_SOFT_OMX_COMPONENT_H_
 
 #include "SoftOMXComponent.h"
+#include "SoftOMXScheduler.h"
 
 #include <media/stagefright/foundation/AHandlerReflector.h>
 #include <utils/RefBase.h>
@@ -36,6 +37,7 @@ struct SimpleSoftOMXComponent : public SoftOMXComponent {
             OMX_PTR appData,
             OMX_COMPONENTTYPE **component);
 
+    virtual void setScheduler(const sp<SoftOMXScheduler> &scheduler);
     virtual void prepareForDestruction();
 
     void onMessageReceived(const sp<AMessage> &msg);
@@ -74,6 +76,16 @@ protected:
     virtual void onReset();
     void onPortFlush2(OMX_U32 portIndex, bool sendFlushComplete);
 
+    // Called once the client has registered a buffer through useBuffer()
+    // or allocateBuffer(), and before freeBuffer() deletes it. Components
+    // that keep using buffer memory while the client owns the buffer, e.g.
+    // decoders decoding into output buffers, must stop doing so in
+    // onBufferRemoved().
+    virtual void onBufferAdded(
+            OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header);
+    virtual void onBufferRemoved(
+            OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header);
+
     PortInfo *editPortInfo(OMX_U32 portIndex);
 
 private:
@@ -88,6 +100,10 @@ private:
     sp<ALooper> mLooper;
     sp<AHandlerReflector<SimpleSoftOMXComponent> > mHandler;
 
+    // Set if the component runs on a shared scheduler instead of mLooper.
+    sp<SoftOMXScheduler> mScheduler;
+    int32_t mSchedulerId;
+
     OMX_STATETYPE mState;
     OMX_STATETYPE mTargetState;
 
@@ -130,6 +146,8 @@ private:
 
     virtual OMX_ERRORTYPE getState(OMX_STATETYPE *state);
 
+    void postMessage(const sp<AMessage> &msg);
+
     void onSendCommand(OMX_COMMANDTYPE cmd, OMX_U32 param);
     void onChangeState(OMX_STATETYPE state);
     void onPortEnable(OMX_U32 portIndex, bool enable);
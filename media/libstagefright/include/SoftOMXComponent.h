@@ -26,6 +26,8 @@
 
 namespace android {
 
+struct SoftOMXScheduler;
+
 struct SoftOMXComponent : public RefBase {
     SoftOMXComponent(
             const char *name,
@@ -38,6 +40,11 @@ struct SoftOMXComponent : public RefBase {
     void setLibHandle(void *libHandle);
     void *libHandle() const;
 
+    // Called by the plugin once, before the component is handed out.
+    // Components that run on a thread of their own use the shared
+    // |scheduler| instead if it is non-NULL.
+    virtual void setScheduler(const sp<SoftOMXScheduler> &scheduler) {}
+
     virtual void prepareForDestruction() {}
 
 protected:
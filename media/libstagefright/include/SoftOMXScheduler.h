@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOFT_OMX_SCHEDULER_H_
+
+#define SOFT_OMX_SCHEDULER_H_
+
+#include <media/stagefright/foundation/ABase.h>
+#include <media/stagefright/foundation/AString.h>
+#include <utils/KeyedVector.h>
+#include <utils/List.h>
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+struct AMessage;
+struct SimpleSoftOMXComponent;
+
+// Runs the messages of many software components on a fixed set of worker
+// threads instead of one looper thread per component.
+//
+// The messages of a component are delivered one at a time and in the order
+// they were posted, just like on a looper. A component with pending
+// messages is queued on the worker that ran it last, to keep its codec
+// state in that core's caches, and idle workers steal queued components
+// from busy ones. A component runs at most kMaxMessagesPerRun messages
+// before it goes to the back of the queue again, so one busy component
+// can't starve the others.
+struct SoftOMXScheduler : public RefBase {
+    // Starts |numWorkers| worker threads. If |pinToCores| is set, worker i
+    // is bound to online core i modulo the number of cores.
+    SoftOMXScheduler(size_t numWorkers, bool pinToCores);
+
+    size_t numWorkers() const { return mWorkers.size(); }
+
+    int32_t registerComponent(
+            SimpleSoftOMXComponent *component, const char *name);
+
+    // Waits until no message of the component is running and drops the
+    // messages still pending for it.
+    void unregisterComponent(int32_t id);
+
+    void post(int32_t id, const sp<AMessage> &msg);
+
+    // Prints message counts and worker thread CPU time per component.
+    void dump(int fd) const;
+
+protected:
+    virtual ~SoftOMXScheduler();
+
+private:
+    enum {
+        kMaxMessagesPerRun = 4,
+    };
+
+    struct Component {
+        SimpleSoftOMXComponent *mComponent;
+        AString mName;
+        List<sp<AMessage> > mMessages;
+
+        size_t mWorker;
+        bool mQueued;
+        bool mRunning;
+        bool mRemoved;
+
+        int64_t mCpuTimeUs;
+        int64_t mWaitTimeUs;
+        uint64_t mNumMessages;
+        uint64_t mNumRuns;
+        uint64_t mNumSteals;
+        int64_t mQueuedAtUs;
+    };
+
+    struct Worker : public Thread {
+        Worker(SoftOMXScheduler *scheduler, size_t index, int core)
+            : Thread(false /* canCallJava */),
+              mScheduler(scheduler),
+              mIndex(index),
+              mCore(core) {
+        }
+
+    private:
+        SoftOMXScheduler *mScheduler;
+        size_t mIndex;
+        int mCore;
+
+        virtual status_t readyToRun();
+
+        virtual bool threadLoop() {
+            return mScheduler->workerLoop(mIndex);
+        }
+    };
+
+    mutable Mutex mLock;
+    Condition mWorkAvailable;
+    Condition mComponentIdle;
+    bool mQuit;
+    bool mPinToCores;
+
+    Vector<sp<Worker> > mWorkers;
+
+    // One run queue per worker.
+    Vector<List<Component *> > mRunQueues;
+
+    KeyedVector<int32_t, Component *> mComponents;
+    int32_t mNextId;
+
+    // Totals of the components that have been unregistered.
+    int64_t mRetiredCpuTimeUs;
+    uint64_t mRetiredNumMessages;
+    size_t mNumRetired;
+
+    void schedule_l(Component *component, size_t worker);
+    Component *dequeue_l(size_t worker);
+
+    bool workerLoop(size_t worker);
+
+    DISALLOW_EVIL_CONSTRUCTORS(SoftOMXScheduler);
+};
+
+}  // namespace android
+
+#endif  // SOFT_OMX_SCHEDULER_H_
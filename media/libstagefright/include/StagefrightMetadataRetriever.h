@@ -27,6 +27,8 @@ namespace android {
 
 struct DataSource;
 class MediaExtractor;
+struct MediaSource;
+class MetaData;
 
 struct StagefrightMetadataRetriever : public MediaMetadataRetrieverInterface {
     StagefrightMetadataRetriever();
@@ -39,6 +41,21 @@ struct StagefrightMetadataRetriever : public MediaMetadataRetrieverInterface {
     virtual status_t setDataSource(int fd, int64_t offset, int64_t length);
 
     virtual VideoFrame *getFrameAtTime(int64_t timeUs, int option);
+
+    virtual VideoFrame *getFrameAtTime(
+            int64_t timeUs, int option, const VideoFrameOptions &frameOptions);
+
+    // Extracts one frame for each of the ascending |timesUs| with a single
+    // decoder instance. Times that land on the frame returned for the
+    // previous time share it. With OPTION_CLOSEST the decoder only seeks if
+    // the sync sample before the time lies past its position, otherwise it
+    // decodes on. |frames| receives one entry per time, NULL where no
+    // frame could be extracted; the caller owns the frames.
+    virtual status_t getFramesAtTimes(
+            const Vector<int64_t> &timesUs, int option,
+            const VideoFrameOptions &frameOptions,
+            Vector<VideoFrame *> *frames);
+
     virtual MediaAlbumArt *extractAlbumArt();
     virtual const char *extractMetadata(int keyCode);
 
@@ -53,6 +70,11 @@ private:
 
     void parseMetaData();
 
+    status_t findVideoTrack(sp<MetaData> *trackMeta, size_t *trackIndex);
+
+    sp<MediaSource> createProbe(
+            size_t trackIndex, sp<MediaExtractor> *extractor);
+
     StagefrightMetadataRetriever(const StagefrightMetadataRetriever &);
 
     StagefrightMetadataRetriever &operator=(
@@ -970,6 +970,14 @@ sp<MetaData> MatroskaExtractor::getMetaData() {
             kKeyMIMEType,
             mIsWebm ? "video/webm" : MEDIA_MIMETYPE_CONTAINER_MATROSKA);
 
+    if (mSegment != NULL) {
+        const mkvparser::SegmentInfo *info = mSegment->GetInfo();
+        const char *title = info != NULL ? info->GetTitleAsUTF8() : NULL;
+        if (title != NULL && title[0] != '\0') {
+            meta->setCString(kKeyTitle, title);
+        }
+    }
+
     return meta;
 }
 
@@ -75,7 +75,7 @@ private:
 
     sp<CallbackDispatcherThread> mThread;
 
-    void dispatch(const omx_message &msg);
+    void dispatch(const List<omx_message> &messages);
 
     CallbackDispatcher(const CallbackDispatcher &);
     CallbackDispatcher &operator=(const CallbackDispatcher &);
@@ -113,17 +113,17 @@ void OMX::CallbackDispatcher::post(const omx_message &msg) {
     mQueueChanged.signal();
 }
 
-void OMX::CallbackDispatcher::dispatch(const omx_message &msg) {
+void OMX::CallbackDispatcher::dispatch(const List<omx_message> &messages) {
     if (mOwner == NULL) {
         ALOGV("Would have dispatched a message to a node that's already gone.");
         return;
     }
-    mOwner->onMessage(msg);
+    mOwner->onMessages(messages);
 }
 
 bool OMX::CallbackDispatcher::loop() {
     for (;;) {
-        omx_message msg;
+        List<omx_message> messages;
 
         {
             Mutex::Autolock autoLock(mLock);
@@ -135,11 +135,15 @@ bool OMX::CallbackDispatcher::loop() {
                 break;
             }
 
-            msg = *mQueue.begin();
-            mQueue.erase(mQueue.begin());
+            // Everything posted since the last dispatch goes out together;
+            // a component typically returns an input and an output buffer
+            // back to back, which then costs the observer one transaction,
+            // or one wakeup if the node has a buffer ring.
+            messages = mQueue;
+            mQueue.clear();
         }
 
-        dispatch(msg);
+        dispatch(messages);
     }
 
     return false;
@@ -163,6 +167,11 @@ OMX::~OMX() {
     mMaster = NULL;
 }
 
+status_t OMX::dump(int fd, const Vector<String16> & /* args */) {
+    mMaster->dump(fd);
+    return OK;
+}
+
 void OMX::binderDied(const wp<IBinder> &the_late_who) {
     OMXNodeInstance *instance;
 
@@ -279,7 +288,7 @@ status_t OMX::freeNode(node_id node) {
 
 status_t OMX::sendCommand(
         node_id node, OMX_COMMANDTYPE cmd, OMX_S32 param) {
-    return findInstance(node)->sendCommand(cmd, param);
+    return findInstanceAfterRequests(node)->sendCommand(cmd, param);
 }
 
 status_t OMX::getParameter(
@@ -292,7 +301,7 @@ status_t OMX::getParameter(
 status_t OMX::setParameter(
         node_id node, OMX_INDEXTYPE index,
         const void *params, size_t size) {
-    return findInstance(node)->setParameter(
+    return findInstanceAfterRequests(node)->setParameter(
             index, params, size);
 }
 
@@ -306,7 +315,7 @@ status_t OMX::getConfig(
 status_t OMX::setConfig(
         node_id node, OMX_INDEXTYPE index,
         const void *params, size_t size) {
-    return findInstance(node)->setConfig(
+    return findInstanceAfterRequests(node)->setConfig(
             index, params, size);
 }
 
@@ -353,7 +362,7 @@ status_t OMX::createInputSurface(
 }
 
 status_t OMX::signalEndOfInputStream(node_id node) {
-    return findInstance(node)->signalEndOfInputStream();
+    return findInstanceAfterRequests(node)->signalEndOfInputStream();
 }
 
 status_t OMX::allocateBuffer(
@@ -371,12 +380,12 @@ status_t OMX::allocateBufferWithBackup(
 }
 
 status_t OMX::freeBuffer(node_id node, OMX_U32 port_index, buffer_id buffer) {
-    return findInstance(node)->freeBuffer(
+    return findInstanceAfterRequests(node)->freeBuffer(
             port_index, buffer);
 }
 
 status_t OMX::fillBuffer(node_id node, buffer_id buffer) {
-    return findInstance(node)->fillBuffer(buffer);
+    return findInstanceAfterRequests(node)->fillBuffer(buffer);
 }
 
 status_t OMX::emptyBuffer(
@@ -384,7 +393,7 @@ status_t OMX::emptyBuffer(
         buffer_id buffer,
         OMX_U32 range_offset, OMX_U32 range_length,
         OMX_U32 flags, OMX_TICKS timestamp) {
-    return findInstance(node)->emptyBuffer(
+    return findInstanceAfterRequests(node)->emptyBuffer(
             buffer, range_offset, range_length, flags, timestamp);
 }
 
@@ -396,6 +405,11 @@ status_t OMX::getExtensionIndex(
             parameter_name, index);
 }
 
+status_t OMX::setBufferRing(
+        node_id node, const sp<OMXBufferRing> &ring) {
+    return findInstance(node)->setBufferRing(ring);
+}
+
 OMX_ERRORTYPE OMX::OnEvent(
         node_id node,
         OMX_IN OMX_EVENTTYPE eEvent,
@@ -470,6 +484,16 @@ OMXNodeInstance *OMX::findInstance(node_id node) {
     return index < 0 ? NULL : mNodeIDToInstance.valueAt(index);
 }
 
+OMXNodeInstance *OMX::findInstanceAfterRequests(node_id node) {
+    OMXNodeInstance *instance = findInstance(node);
+
+    // Whatever the client queued in the buffer ring before making this
+    // call goes first, as it would have through binder.
+    instance->processBufferRequests();
+
+    return instance;
+}
+
 sp<OMX::CallbackDispatcher> OMX::findDispatcher(node_id node) {
     Mutex::Autolock autoLock(mLock);
 
@@ -29,9 +29,10 @@
 namespace android {
 
 OMXMaster::OMXMaster()
-    : mVendorLibHandle(NULL) {
+    : mVendorLibHandle(NULL),
+      mSoftPlugin(new SoftOMXPlugin) {
     addVendorPlugin();
-    addPlugin(new SoftOMXPlugin);
+    addPlugin(mSoftPlugin);
 }
 
 OMXMaster::~OMXMaster() {
@@ -119,6 +120,7 @@ void OMXMaster::clearPlugins() {
     }
 
     mPlugins.clear();
+    mSoftPlugin = NULL;
 }
 
 OMX_ERRORTYPE OMXMaster::makeComponentInstance(
@@ -202,4 +204,12 @@ OMX_ERRORTYPE OMXMaster::getRolesOfComponent(
     return plugin->getRolesOfComponent(name, roles);
 }
 
+void OMXMaster::dump(int fd) {
+    Mutex::Autolock autoLock(mLock);
+
+    if (mSoftPlugin != NULL) {
+        mSoftPlugin->dump(fd);
+    }
+}
+
 }  // namespace android
@@ -27,6 +27,8 @@
 
 namespace android {
 
+struct SoftOMXPlugin;
+
 struct OMXMaster : public OMXPluginBase {
     OMXMaster();
     virtual ~OMXMaster();
@@ -49,6 +51,8 @@ struct OMXMaster : public OMXPluginBase {
             const char *name,
             Vector<String8> *roles);
 
+    void dump(int fd);
+
 private:
     Mutex mLock;
     List<OMXPluginBase *> mPlugins;
@@ -57,6 +61,9 @@ private:
 
     void *mVendorLibHandle;
 
+    // Owned by mPlugins.
+    SoftOMXPlugin *mSoftPlugin;
+
     void addVendorPlugin();
     void addPlugin(const char *libname);
     void addPlugin(OMXPluginBase *plugin);
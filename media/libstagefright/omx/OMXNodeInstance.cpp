@@ -27,11 +27,15 @@
 #include <binder/IMemory.h>
 #include <gui/BufferQueue.h>
 #include <HardwareAPI.h>
+#include <media/OMXBufferRing.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/MediaErrors.h>
 
 static const OMX_U32 kPortIndexInput = 0;
 
+// How long to wait for the client to make room in a full buffer ring.
+static const int64_t kBufferRingFullDelayUs = 1000ll;
+
 namespace android {
 
 struct BufferMeta {
@@ -80,6 +84,39 @@ private:
     BufferMeta &operator=(const BufferMeta &);
 };
 
+// Carries out the requests of the buffer ring whenever the client
+// signals it.
+struct OMXNodeInstance::BufferRingThread : public Thread {
+    BufferRingThread(
+            OMXNodeInstance *instance, const sp<OMXBufferRing> &ring)
+        : mInstance(instance),
+          mRing(ring) {
+    }
+
+    void stop() {
+        requestExit();
+        mRing->signalRequests();
+        join();
+    }
+
+private:
+    OMXNodeInstance *mInstance;
+    sp<OMXBufferRing> mRing;
+
+    virtual bool threadLoop() {
+        if (mRing->waitForRequests() != OK || exitPending()) {
+            return false;
+        }
+
+        mInstance->processBufferRequests();
+
+        return true;
+    }
+
+    BufferRingThread(const BufferRingThread &);
+    BufferRingThread &operator=(const BufferRingThread &);
+};
+
 // static
 OMX_CALLBACKTYPE OMXNodeInstance::kCallbacks = {
     &OnEvent, &OnEmptyBufferDone, &OnFillBufferDone
@@ -115,6 +152,11 @@ void OMXNodeInstance::setGraphicBufferSource(
     mGraphicBufferSource = bufferSource;
 }
 
+sp<OMXBufferRing> OMXNodeInstance::getBufferRing() {
+    Mutex::Autolock autoLock(mBufferRingLock);
+    return mBufferRing;
+}
+
 OMX *OMXNodeInstance::owner() {
     return mOwner;
 }
@@ -152,6 +194,9 @@ status_t OMXNodeInstance::freeNode(OMXMaster *master) {
     // does not expect them.
     mDying = true;
 
+    // Whatever the client still queued is moot now.
+    stopBufferRing();
+
     OMX_STATETYPE state;
     CHECK_EQ(OMX_GetState(mHandle, &state), OMX_ErrorNone);
     switch (state) {
@@ -774,7 +819,96 @@ status_t OMXNodeInstance::getExtensionIndex(
     return StatusFromOMXError(err);
 }
 
-void OMXNodeInstance::onMessage(const omx_message &msg) {
+status_t OMXNodeInstance::setBufferRing(const sp<OMXBufferRing> &ring) {
+    Mutex::Autolock autoLock(mBufferRingLock);
+
+    if (mBufferRing != NULL) {
+        return INVALID_OPERATION;
+    }
+
+    sp<BufferRingThread> thread = new BufferRingThread(this, ring);
+    status_t err = thread->run("OMXBufferRing", ANDROID_PRIORITY_FOREGROUND);
+    if (err != OK) {
+        return err;
+    }
+
+    mBufferRing = ring;
+    mBufferRingThread = thread;
+
+    return OK;
+}
+
+void OMXNodeInstance::stopBufferRing() {
+    sp<BufferRingThread> thread;
+    {
+        Mutex::Autolock autoLock(mBufferRingLock);
+        thread = mBufferRingThread;
+        mBufferRingThread.clear();
+        mBufferRing.clear();
+    }
+
+    if (thread != NULL) {
+        thread->stop();
+    }
+}
+
+void OMXNodeInstance::processBufferRequests() {
+    sp<OMXBufferRing> ring = getBufferRing();
+    if (ring == NULL) {
+        return;
+    }
+
+    Mutex::Autolock autoLock(mBufferRequestLock);
+
+    OMXBufferRing::Request request;
+    while (ring->readRequest(&request)) {
+        status_t err;
+        switch (request.type) {
+            case OMXBufferRing::Request::EMPTY_BUFFER:
+                err = emptyBuffer(
+                        request.buffer,
+                        request.range_offset, request.range_length,
+                        request.flags, request.timestamp);
+                break;
+
+            case OMXBufferRing::Request::FILL_BUFFER:
+                err = fillBuffer(request.buffer);
+                break;
+
+            default:
+                err = BAD_VALUE;
+                break;
+        }
+
+        // The client no longer waits for the result, so it hears about a
+        // failure the way it hears about a component error.
+        if (err != OK && !mDying) {
+            ALOGE("buffer request %d failed: %d", request.type, err);
+            mOwner->OnEvent(
+                    mNodeID, OMX_EventError, OMX_ErrorUndefined, 0, NULL);
+        }
+    }
+}
+
+void OMXNodeInstance::postMessages(
+        const sp<OMXBufferRing> &ring, const List<omx_message> &messages) {
+    for (List<omx_message>::const_iterator it = messages.begin();
+            it != messages.end(); ++it) {
+        // The client empties the ring on a thread of its own, so it only
+        // stays full while the observer is busy.
+        while (!ring->postMessage(*it)) {
+            if (mDying) {
+                return;
+            }
+            ring->signalMessages();
+            usleep(kBufferRingFullDelayUs);
+        }
+    }
+
+    ring->signalMessages();
+}
+
+bool OMXNodeInstance::handleMessage(const omx_message &msg) {
     if (msg.type == omx_message::FILL_BUFFER_DONE) {
         OMX_BUFFERHEADERTYPE *buffer =
             static_cast<OMX_BUFFERHEADERTYPE *>(
@@ -799,11 +933,32 @@ void OMXNodeInstance::onMessage(const omx_message &msg) {
                         msg.u.buffer_data.buffer);
 
             bufferSource->codecBufferEmptied(buffer);
-            return;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void OMXNodeInstance::onMessages(const List<omx_message> &messages) {
+    List<omx_message> forward;
+    for (List<omx_message>::const_iterator it = messages.begin();
+            it != messages.end(); ++it) {
+        if (handleMessage(*it)) {
+            forward.push_back(*it);
         }
     }
 
-    mObserver->onMessage(msg);
+    if (forward.empty()) {
+        return;
+    }
+
+    sp<OMXBufferRing> ring = getBufferRing();
+    if (ring != NULL) {
+        postMessages(ring, forward);
+    } else {
+        mObserver->onMessages(forward);
+    }
 }
 
 void OMXNodeInstance::onObserverDied(OMXMaster *master) {
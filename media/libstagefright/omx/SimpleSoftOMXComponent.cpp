@@ -32,11 +32,24 @@ SimpleSoftOMXComponent::SimpleSoftOMXComponent(
         OMX_PTR appData,
         OMX_COMPONENTTYPE **component)
     : SoftOMXComponent(name, callbacks, appData, component),
-      mLooper(new ALooper),
       mHandler(new AHandlerReflector<SimpleSoftOMXComponent>(this)),
+      mSchedulerId(0),
       mState(OMX_StateLoaded),
       mTargetState(OMX_StateLoaded) {
-    mLooper->setName(name);
+}
+
+void SimpleSoftOMXComponent::setScheduler(
+        const sp<SoftOMXScheduler> &scheduler) {
+    CHECK(mLooper == NULL && mScheduler == NULL);
+
+    if (scheduler != NULL) {
+        mScheduler = scheduler;
+        mSchedulerId = mScheduler->registerComponent(this, name());
+        return;
+    }
+
+    mLooper = new ALooper;
+    mLooper->setName(name());
     mLooper->registerHandler(mHandler);
 
     mLooper->start(
@@ -50,10 +63,24 @@ void SimpleSoftOMXComponent::prepareForDestruction() {
     // object. Make sure those are flushed before returning so that
     // a subsequent dlunload() does not pull out the rug from under us.
 
+    if (mScheduler != NULL) {
+        mScheduler->unregisterComponent(mSchedulerId);
+        mScheduler.clear();
+        return;
+    }
+
     mLooper->unregisterHandler(mHandler->id());
     mLooper->stop();
 }
 
+void SimpleSoftOMXComponent::postMessage(const sp<AMessage> &msg) {
+    if (mScheduler != NULL) {
+        mScheduler->post(mSchedulerId, msg);
+    } else {
+        msg->post();
+    }
+}
+
 OMX_ERRORTYPE SimpleSoftOMXComponent::sendCommand(
         OMX_COMMANDTYPE cmd, OMX_U32 param, OMX_PTR data) {
     CHECK(data == NULL);
@@ -61,7 +88,7 @@ OMX_ERRORTYPE SimpleSoftOMXComponent::sendCommand(
     sp<AMessage> msg = new AMessage(kWhatSendCommand, mHandler->id());
     msg->setInt32("cmd", cmd);
     msg->setInt32("param", param);
-    msg->post();
+    postMessage(msg);
 
     return OMX_ErrorNone;
 }
@@ -227,6 +254,8 @@ OMX_ERRORTYPE SimpleSoftOMXComponent::useBuffer(
     buffer->mHeader = *header;
     buffer->mOwnedByUs = false;
 
+    onBufferAdded(portIndex, *header);
+
     if (port->mBuffers.size() == port->mDef.nBufferCountActual) {
         port->mDef.bPopulated = OMX_TRUE;
         checkTransitions();
@@ -279,6 +308,8 @@ OMX_ERRORTYPE SimpleSoftOMXComponent::freeBuffer(
         if (buffer->mHeader == header) {
             CHECK(!buffer->mOwnedByUs);
 
+            onBufferRemoved(portIndex, header);
+
             if (header->pPlatformPrivate != NULL) {
                 // This buffer's data was allocated by us.
                 CHECK(header->pPlatformPrivate == header->pBuffer);
@@ -309,7 +340,7 @@ OMX_ERRORTYPE SimpleSoftOMXComponent::emptyThisBuffer(
         OMX_BUFFERHEADERTYPE *buffer) {
     sp<AMessage> msg = new AMessage(kWhatEmptyThisBuffer, mHandler->id());
     msg->setPointer("header", buffer);
-    msg->post();
+    postMessage(msg);
 
     return OMX_ErrorNone;
 }
@@ -318,7 +349,7 @@ OMX_ERRORTYPE SimpleSoftOMXComponent::fillThisBuffer(
         OMX_BUFFERHEADERTYPE *buffer) {
     sp<AMessage> msg = new AMessage(kWhatFillThisBuffer, mHandler->id());
     msg->setPointer("header", buffer);
-    msg->post();
+    postMessage(msg);
 
     return OMX_ErrorNone;
 }
@@ -645,6 +676,14 @@ void SimpleSoftOMXComponent::onPortEnableCompleted(
         OMX_U32 portIndex, bool enabled) {
 }
 
+void SimpleSoftOMXComponent::onBufferAdded(
+        OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header) {
+}
+
+void SimpleSoftOMXComponent::onBufferRemoved(
+        OMX_U32 portIndex, OMX_BUFFERHEADERTYPE *header) {
+}
+
 List<SimpleSoftOMXComponent::BufferInfo *> &
 SimpleSoftOMXComponent::getPortQueue(OMX_U32 portIndex) {
     CHECK_LT(portIndex, mPorts.size());
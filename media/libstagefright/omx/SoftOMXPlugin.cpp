@@ -40,10 +40,13 @@
 #include "SoftOMXPlugin.h"
 #include "include/SoftOMXComponent.h"
 
+#include <cutils/properties.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AString.h>
 
 #include <dlfcn.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 namespace android {
 
@@ -84,6 +87,32 @@ static const size_t kNumComponents =
     sizeof(kComponents) / sizeof(kComponents[0]);
 
 SoftOMXPlugin::SoftOMXPlugin() {
+    // media.stagefright.omx.workers is the number of threads all software
+    // components share, or "auto" for one per online core. The workers are
+    // pinned to cores unless media.stagefright.omx.pinworkers is 0.
+    char value[PROPERTY_VALUE_MAX];
+    if (!property_get("media.stagefright.omx.workers", value, NULL)) {
+        return;
+    }
+
+    long numWorkers;
+    if (!strcmp(value, "auto")) {
+        numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+    } else {
+        numWorkers = strtol(value, NULL, 10);
+    }
+
+    if (numWorkers <= 0) {
+        return;
+    }
+
+    bool pinToCores = true;
+    if (property_get("media.stagefright.omx.pinworkers", value, NULL)
+            && (!strcmp(value, "0") || !strcasecmp(value, "false"))) {
+        pinToCores = false;
+    }
+
+    mScheduler = new SoftOMXScheduler(numWorkers, pinToCores);
 }
 
 OMX_ERRORTYPE SoftOMXPlugin::makeComponentInstance(
@@ -147,6 +176,7 @@ OMX_ERRORTYPE SoftOMXPlugin::makeComponentInstance(
 
         codec->incStrong(this);
         codec->setLibHandle(libHandle);
+        codec->setScheduler(mScheduler);
 
         return OMX_ErrorNone;
     }
@@ -204,4 +234,10 @@ OMX_ERRORTYPE SoftOMXPlugin::getRolesOfComponent(
     return OMX_ErrorInvalidComponentName;
 }
 
+void SoftOMXPlugin::dump(int fd) const {
+    if (mScheduler != NULL) {
+        mScheduler->dump(fd);
+    }
+}
+
 }  // namespace android
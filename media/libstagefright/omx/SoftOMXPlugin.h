@@ -18,6 +18,8 @@
 
 #define SOFT_OMX_PLUGIN_H_
 
+#include "include/SoftOMXScheduler.h"
+
 #include <media/stagefright/foundation/ABase.h>
 #include <OMXPluginBase.h>
 
@@ -44,7 +46,13 @@ struct SoftOMXPlugin : public OMXPluginBase {
             const char *name,
             Vector<String8> *roles);
 
+    void dump(int fd) const;
+
 private:
+    // Shared by all components if media.stagefright.omx.workers is set,
+    // otherwise every component runs on a looper of its own.
+    sp<SoftOMXScheduler> mScheduler;
+
     DISALLOW_EVIL_CONSTRUCTORS(SoftOMXPlugin);
 };
 
@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SoftOMXScheduler"
+#include <utils/Log.h>
+
+#include "include/SoftOMXScheduler.h"
+#include "include/SimpleSoftOMXComponent.h"
+
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace android {
+
+static int64_t GetThreadCpuTimeUs() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+
+    return ts.tv_sec * 1000000ll + ts.tv_nsec / 1000;
+}
+
+status_t SoftOMXScheduler::Worker::readyToRun() {
+    if (mCore < 0) {
+        return OK;
+    }
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(mCore, &cpuSet);
+
+    if (sched_setaffinity(gettid(), sizeof(cpuSet), &cpuSet) != 0) {
+        ALOGW("Unable to pin worker %zu to core %d", mIndex, mCore);
+    }
+
+    return OK;
+}
+
+SoftOMXScheduler::SoftOMXScheduler(size_t numWorkers, bool pinToCores)
+    : mQuit(false),
+      mPinToCores(pinToCores),
+      mNextId(1),
+      mRetiredCpuTimeUs(0),
+      mRetiredNumMessages(0),
+      mNumRetired(0) {
+    CHECK_GT(numWorkers, 0u);
+
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numCores < 1) {
+        numCores = 1;
+    }
+
+    // Workers only touch their run queues with mLock held, but the queues
+    // must exist before the first worker looks at them.
+    Mutex::Autolock autoLock(mLock);
+
+    mRunQueues.insertAt(List<Component *>(), 0, numWorkers);
+
+    for (size_t i = 0; i < numWorkers; ++i) {
+        sp<Worker> worker =
+            new Worker(this, i, pinToCores ? (int)(i % numCores) : -1);
+
+        if (worker->run("SoftOMXWorker", ANDROID_PRIORITY_FOREGROUND) != OK) {
+            ALOGW("Failed to start soft OMX worker %zu.", i);
+            break;
+        }
+
+        mWorkers.push(worker);
+    }
+
+    // There's always at least one worker to fall back to.
+    CHECK(!mWorkers.isEmpty());
+
+    mRunQueues.removeItemsAt(mWorkers.size(), numWorkers - mWorkers.size());
+
+    ALOGI("Running soft OMX components on %zu workers%s",
+          mWorkers.size(), pinToCores ? ", pinned to cores" : "");
+}
+
+SoftOMXScheduler::~SoftOMXScheduler() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        CHECK(mComponents.isEmpty());
+
+        mQuit = true;
+        mWorkAvailable.broadcast();
+    }
+
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        mWorkers.editItemAt(i)->requestExitAndWait();
+    }
+}
+
+int32_t SoftOMXScheduler::registerComponent(
+        SimpleSoftOMXComponent *component, const char *name) {
+    Mutex::Autolock autoLock(mLock);
+
+    int32_t id = mNextId++;
+
+    Component *entry = new Component;
+    entry->mComponent = component;
+    entry->mName = name;
+    entry->mWorker = id % mWorkers.size();
+    entry->mQueued = false;
+    entry->mRunning = false;
+    entry->mRemoved = false;
+    entry->mCpuTimeUs = 0;
+    entry->mWaitTimeUs = 0;
+    entry->mNumMessages = 0;
+    entry->mNumRuns = 0;
+    entry->mNumSteals = 0;
+    entry->mQueuedAtUs = 0;
+
+    mComponents.add(id, entry);
+
+    return id;
+}
+
+void SoftOMXScheduler::unregisterComponent(int32_t id) {
+    Mutex::Autolock autoLock(mLock);
+
+    ssize_t index = mComponents.indexOfKey(id);
+    CHECK_GE(index, 0);
+
+    Component *entry = mComponents.valueAt(index);
+    mComponents.removeItemsAt(index);
+
+    entry->mRemoved = true;
+    entry->mMessages.clear();
+
+    while (entry->mRunning) {
+        mComponentIdle.wait(mLock);
+    }
+
+    if (entry->mQueued) {
+        List<Component *> *queue = &mRunQueues.editItemAt(entry->mWorker);
+        for (List<Component *>::iterator it = queue->begin();
+                it != queue->end(); ++it) {
+            if (*it == entry) {
+                queue->erase(it);
+                break;
+            }
+        }
+        entry->mQueued = false;
+    }
+
+    mRetiredCpuTimeUs += entry->mCpuTimeUs;
+    mRetiredNumMessages += entry->mNumMessages;
+    ++mNumRetired;
+
+    delete entry;
+    entry = NULL;
+}
+
+void SoftOMXScheduler::post(int32_t id, const sp<AMessage> &msg) {
+    Mutex::Autolock autoLock(mLock);
+
+    ssize_t index = mComponents.indexOfKey(id);
+    if (index < 0) {
+        ALOGW("Dropping message for unregistered component %d", id);
+        return;
+    }
+
+    Component *entry = mComponents.valueAt(index);
+    entry->mMessages.push_back(msg);
+
+    // A running component is requeued by its worker once it's done.
+    if (!entry->mQueued && !entry->mRunning) {
+        schedule_l(entry, entry->mWorker);
+    }
+}
+
+void SoftOMXScheduler::schedule_l(Component *component, size_t worker) {
+    component->mWorker = worker;
+    component->mQueued = true;
+    component->mQueuedAtUs = ALooper::GetNowUs();
+
+    mRunQueues.editItemAt(worker).push_back(component);
+
+    // Any idle worker will do, the one the component belongs to isn't
+    // necessarily idle.
+    mWorkAvailable.signal();
+}
+
+SoftOMXScheduler::Component *SoftOMXScheduler::dequeue_l(size_t worker) {
+    List<Component *> *queue = &mRunQueues.editItemAt(worker);
+
+    if (!queue->empty()) {
+        Component *component = *queue->begin();
+        queue->erase(queue->begin());
+        return component;
+    }
+
+    // Steal from the back of the longest queue, leaving the components
+    // that have waited longest to their own worker.
+    size_t victim = worker;
+    size_t victimSize = 0;
+    for (size_t i = 0; i < mRunQueues.size(); ++i) {
+        size_t size = mRunQueues.itemAt(i).size();
+        if (size > victimSize) {
+            victim = i;
+            victimSize = size;
+        }
+    }
+
+    if (victimSize == 0) {
+        return NULL;
+    }
+
+    queue = &mRunQueues.editItemAt(victim);
+
+    List<Component *>::iterator it = queue->end();
+    --it;
+
+    Component *component = *it;
+    queue->erase(it);
+
+    ++component->mNumSteals;
+
+    return component;
+}
+
+bool SoftOMXScheduler::workerLoop(size_t worker) {
+    Mutex::Autolock autoLock(mLock);
+
+    Component *component;
+    while (!mQuit && (component = dequeue_l(worker)) == NULL) {
+        mWorkAvailable.wait(mLock);
+    }
+
+    if (mQuit) {
+        return false;
+    }
+
+    component->mQueued = false;
+    component->mRunning = true;
+    component->mWorker = worker;
+    component->mWaitTimeUs += ALooper::GetNowUs() - component->mQueuedAtUs;
+    ++component->mNumRuns;
+
+    for (size_t i = 0; i < kMaxMessagesPerRun; ++i) {
+        if (component->mRemoved || component->mMessages.empty()) {
+            break;
+        }
+
+        sp<AMessage> msg = *component->mMessages.begin();
+        component->mMessages.erase(component->mMessages.begin());
+
+        mLock.unlock();
+
+        int64_t startUs = GetThreadCpuTimeUs();
+        component->mComponent->onMessageReceived(msg);
+        int64_t cpuTimeUs = GetThreadCpuTimeUs() - startUs;
+
+        msg.clear();
+
+        mLock.lock();
+
+        component->mCpuTimeUs += cpuTimeUs;
+        ++component->mNumMessages;
+    }
+
+    component->mRunning = false;
+
+    if (component->mRemoved) {
+        mComponentIdle.broadcast();
+    } else if (!component->mMessages.empty()) {
+        // Behind whatever else became runnable on this worker meanwhile.
+        schedule_l(component, worker);
+    }
+
+    return true;
+}
+
+void SoftOMXScheduler::dump(int fd) const {
+    Mutex::Autolock autoLock(mLock);
+
+    AString result = StringPrintf(
+            " Soft OMX scheduler: %zu workers%s\n",
+            mWorkers.size(), mPinToCores ? ", pinned to cores" : "");
+
+    result.append(StringPrintf(
+            "  %-32s %10s %8s %8s %10s %10s %7s\n",
+            "component", "messages", "runs", "steals",
+            "cpu (ms)", "wait (ms)", "pending"));
+
+    for (size_t i = 0; i < mComponents.size(); ++i) {
+        const Component *entry = mComponents.valueAt(i);
+
+        result.append(StringPrintf(
+                "  %-32s %10llu %8llu %8llu %10lld %10lld %7zu\n",
+                entry->mName.c_str(),
+                entry->mNumMessages,
+                entry->mNumRuns,
+                entry->mNumSteals,
+                entry->mCpuTimeUs / 1000,
+                entry->mWaitTimeUs / 1000,
+                entry->mMessages.size()));
+    }
+
+    for (size_t i = 0; i < mRunQueues.size(); ++i) {
+        result.append(StringPrintf(
+                "  worker %zu: %zu runnable\n", i, mRunQueues.itemAt(i).size()));
+    }
+
+    result.append(StringPrintf(
+            "  %zu released components: %llu messages, %lld ms cpu\n\n",
+            mNumRetired, mRetiredNumMessages, mRetiredCpuTimeUs / 1000));
+
+    write(fd, result.c_str(), result.size());
+}
+
+}  // namespace android
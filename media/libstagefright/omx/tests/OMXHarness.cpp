@@ -19,15 +19,19 @@
 #include <utils/Log.h>
 
 #include "OMXHarness.h"
+#include "include/OMX.h"
 
+#include <sys/resource.h>
 #include <sys/time.h>
 
 #include <binder/ProcessState.h>
 #include <binder/IServiceManager.h>
 #include <binder/MemoryDealer.h>
 #include <media/IMediaPlayerService.h>
+#include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/DataSource.h>
 #include <media/stagefright/MediaBuffer.h>
 #include <media/stagefright/MediaDefs.h>
@@ -36,14 +40,17 @@
 #include <media/stagefright/MediaSource.h>
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/OMXCodec.h>
+#include <media/stagefright/Utils.h>
+#include <utils/KeyedVector.h>
 
 #define DEFAULT_TIMEOUT         500000
 
 namespace android {
 
-Harness::Harness()
-    : mInitCheck(NO_INIT) {
-    mInitCheck = initOMX();
+Harness::Harness(bool localOMX)
+    : mInitCheck(NO_INIT),
+      mNumCallbacks(0) {
+    mInitCheck = initOMX(localOMX);
 }
 
 Harness::~Harness() {
@@ -53,7 +60,12 @@ status_t Harness::initCheck() const {
     return mInitCheck;
 }
 
-status_t Harness::initOMX() {
+status_t Harness::initOMX(bool localOMX) {
+    if (localOMX) {
+        mOMX = new OMX;
+        return OK;
+    }
+
     sp<IServiceManager> sm = defaultServiceManager();
     sp<IBinder> binder = sm->getService(String16("media.player"));
     sp<IMediaPlayerService> service = interface_cast<IMediaPlayerService>(binder);
@@ -66,6 +78,17 @@ void Harness::onMessage(const omx_message &msg) {
     Mutex::Autolock autoLock(mLock);
     mMessageQueue.push_back(msg);
     mMessageAddedCondition.signal();
+    ++mNumCallbacks;
+}
+
+void Harness::onMessages(const List<omx_message> &messages) {
+    Mutex::Autolock autoLock(mLock);
+    for (List<omx_message>::const_iterator it = messages.begin();
+            it != messages.end(); ++it) {
+        mMessageQueue.push_back(*it);
+    }
+    mMessageAddedCondition.signal();
+    ++mNumCallbacks;
 }
 
 status_t Harness::dequeueMessageForNode(
@@ -461,6 +484,8 @@ static const char *GetMimeFromComponentRole(const char *componentRole) {
         { "audio_decoder.vorbis", "audio/vorbis" },
         { "audio_decoder.g711alaw", MEDIA_MIMETYPE_AUDIO_G711_ALAW },
         { "audio_decoder.g711mlaw", MEDIA_MIMETYPE_AUDIO_G711_MLAW },
+        { "audio_decoder.gsm", MEDIA_MIMETYPE_AUDIO_MSGSM },
+        { "audio_decoder.raw", MEDIA_MIMETYPE_AUDIO_RAW },
     };
 
     for (size_t i = 0; i < sizeof(kRoleToMime) / sizeof(kRoleToMime[0]); ++i) {
@@ -779,23 +804,837 @@ status_t Harness::testAll() {
     return OK;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Timeout after which a component that neither returns a buffer nor sends an
+// event is considered stuck.
+#define BENCHMARK_TIMEOUT       5000000
+
+Harness::BenchmarkParams::BenchmarkParams()
+    : mRepeat(1),
+      mSampleRate(44100),
+      mChannelCount(2),
+      mWidth(352),
+      mHeight(288),
+      mFrameRate(30),
+      mBitrate(0),
+      mRealtime(false),
+      mResultsPath(NULL) {
+}
+
+namespace {
+
+struct AccessUnit {
+    sp<ABuffer> mData;
+    int64_t mTimeUs;
+    OMX_U32 mFlags;
+};
+
+}  // namespace
+
+static bool IsEncoderRole(const char *componentRole) {
+    return !strncmp(componentRole, "audio_encoder.", 14)
+        || !strncmp(componentRole, "video_encoder.", 14);
+}
+
+static bool IsVideoRole(const char *componentRole) {
+    return !strncmp(componentRole, "video_", 6);
+}
+
+template<class T>
+static void InitOMXParams(T *params) {
+    memset(params, 0, sizeof(T));
+    params->nSize = sizeof(T);
+    params->nVersion.s.nVersionMajor = 1;
+    params->nVersion.s.nVersionMinor = 0;
+    params->nVersion.s.nRevision = 0;
+    params->nVersion.s.nStep = 0;
+}
+
+static void AddCodecConfig(
+        const sp<AMessage> &format, const char *name,
+        Vector<AccessUnit> *accessUnits) {
+    sp<ABuffer> csd;
+    if (format->findBuffer(name, &csd)) {
+        AccessUnit au;
+        au.mData = csd;
+        au.mTimeUs = 0;
+        au.mFlags = OMX_BUFFERFLAG_CODECCONFIG;
+        accessUnits->push(au);
+    }
+}
+
+// Reads all the access units of the first track the decoder can take, so that
+// the extractor does not run while the component is timed.
+static status_t ExtractAccessUnits(
+        const char *path, const char *componentRole,
+        sp<AMessage> *format, Vector<AccessUnit> *accessUnits,
+        int64_t *durationUs) {
+    sp<MediaExtractor> extractor = CreateExtractorFromURI(path);
+    if (extractor == NULL) {
+        printf("  * Unable to open '%s'\n", path);
+        return ERROR_UNSUPPORTED;
+    }
+
+    const char *mime = GetMimeFromComponentRole(componentRole);
+    const char *kind = IsVideoRole(componentRole) ? "video/" : "audio/";
+
+    sp<MediaSource> source;
+    for (size_t i = 0; i < extractor->countTracks(); ++i) {
+        sp<MetaData> meta = extractor->getTrackMetaData(i);
+
+        const char *trackMime;
+        CHECK(meta->findCString(kKeyMIMEType, &trackMime));
+
+        if (mime != NULL ? !strcasecmp(trackMime, mime)
+                : !strncasecmp(trackMime, kind, 6)) {
+            source = extractor->getTrack(i);
+            break;
+        }
+    }
+
+    if (source == NULL) {
+        printf("  * '%s' has no track for role %s\n", path, componentRole);
+        return ERROR_UNSUPPORTED;
+    }
+
+    status_t err = convertMetaDataToMessage(source->getFormat(), format);
+    if (err != OK) {
+        return err;
+    }
+
+    AddCodecConfig(*format, "csd-0", accessUnits);
+    AddCodecConfig(*format, "csd-1", accessUnits);
+
+    CHECK_EQ(source->start(), (status_t)OK);
+
+    int64_t firstTimeUs = -1;
+    int64_t lastTimeUs = 0;
+    size_t numFrames = 0;
+    for (;;) {
+        MediaBuffer *buffer;
+        err = source->read(&buffer);
+        if (err == INFO_FORMAT_CHANGED) {
+            continue;
+        } else if (err != OK) {
+            break;
+        }
+
+        AccessUnit au;
+        au.mData = new ABuffer(buffer->range_length());
+        memcpy(au.mData->data(),
+               (const uint8_t *)buffer->data() + buffer->range_offset(),
+               buffer->range_length());
+        CHECK(buffer->meta_data()->findInt64(kKeyTime, &au.mTimeUs));
+        au.mFlags = 0;
+        accessUnits->push(au);
+
+        buffer->release();
+        buffer = NULL;
+
+        if (firstTimeUs < 0) {
+            firstTimeUs = au.mTimeUs;
+        }
+        lastTimeUs = au.mTimeUs;
+        ++numFrames;
+    }
+
+    source->stop();
+
+    if (numFrames == 0) {
+        printf("  * No access units in '%s'\n", path);
+        return ERROR_MALFORMED;
+    }
+
+    // Used to shift the timestamps of the repeated passes; one more frame so
+    // that the first frame of a pass does not get the time of the last one.
+    *durationUs = lastTimeUs - firstTimeUs;
+    *durationUs += (numFrames > 1) ? *durationUs / (numFrames - 1) : 1;
+
+    return OK;
+}
+
+// Splits raw 16 bit PCM or YUV420 planar frames into input buffers.
+static status_t ReadRawInput(
+        const char *path, bool video, size_t bufferSize,
+        const Harness::BenchmarkParams &params,
+        Vector<AccessUnit> *accessUnits, int64_t *durationUs) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("  * Unable to open '%s'\n", path);
+        return ERROR_UNSUPPORTED;
+    }
+
+    size_t unitSize;
+    if (video) {
+        unitSize = params.mWidth * params.mHeight * 3 / 2;
+    } else {
+        size_t frameSize = params.mChannelCount * sizeof(int16_t);
+        unitSize = bufferSize / frameSize * frameSize;
+    }
+
+    int64_t timeUs = 0;
+    size_t offset = 0;
+    for (;;) {
+        sp<ABuffer> data = new ABuffer(unitSize);
+        size_t n = fread(data->data(), 1, unitSize, file);
+        if (n == 0 || (video && n < unitSize)) {
+            break;
+        }
+        data->setRange(0, n);
+
+        AccessUnit au;
+        au.mData = data;
+        au.mTimeUs = timeUs;
+        au.mFlags = 0;
+        accessUnits->push(au);
+
+        if (video) {
+            timeUs = (int64_t)accessUnits->size() * 1000000ll / params.mFrameRate;
+        } else {
+            offset += n;
+            timeUs = (int64_t)(offset / (params.mChannelCount * sizeof(int16_t)))
+                * 1000000ll / params.mSampleRate;
+        }
+    }
+    fclose(file);
+
+    if (accessUnits->isEmpty()) {
+        printf("  * No input in '%s'\n", path);
+        return ERROR_MALFORMED;
+    }
+
+    *durationUs = timeUs;
+
+    return OK;
+}
+
+status_t Harness::configurePortsForBenchmark(
+        IOMX::node_id node, const char *componentRole,
+        const sp<AMessage> &format, const BenchmarkParams &params,
+        size_t maxInputSize) {
+    OMX_PARAM_PORTDEFINITIONTYPE def;
+    status_t err = getPortDefinition(node, 0, &def);
+    EXPECT_SUCCESS(err, "getPortDefinition(input)");
+
+    bool encoder = IsEncoderRole(componentRole);
+    bool video = IsVideoRole(componentRole);
+
+    int32_t sampleRate = params.mSampleRate;
+    int32_t channelCount = params.mChannelCount;
+    int32_t width = params.mWidth;
+    int32_t height = params.mHeight;
+    if (!encoder) {
+        if (video) {
+            CHECK(format->findInt32("width", &width));
+            CHECK(format->findInt32("height", &height));
+        } else {
+            CHECK(format->findInt32("sample-rate", &sampleRate));
+            CHECK(format->findInt32("channel-count", &channelCount));
+        }
+    }
+
+    if (video) {
+        def.format.video.nFrameWidth = width;
+        def.format.video.nFrameHeight = height;
+        if (encoder) {
+            def.format.video.nStride = width;
+            def.format.video.nSliceHeight = height;
+            def.format.video.xFramerate = params.mFrameRate << 16;
+            def.format.video.eColorFormat = OMX_COLOR_FormatYUV420Planar;
+            maxInputSize = width * height * 3 / 2;
+        }
+    }
+    if (def.nBufferSize < maxInputSize) {
+        def.nBufferSize = maxInputSize;
+    }
+    err = mOMX->setParameter(
+            node, OMX_IndexParamPortDefinition, &def, sizeof(def));
+    EXPECT_SUCCESS(err, "setParameter(input port definition)");
+
+    if (video && encoder) {
+        err = getPortDefinition(node, 1, &def);
+        EXPECT_SUCCESS(err, "getPortDefinition(output)");
+
+        def.format.video.nFrameWidth = width;
+        def.format.video.nFrameHeight = height;
+        if (params.mBitrate > 0) {
+            def.format.video.nBitrate = params.mBitrate;
+        }
+        err = mOMX->setParameter(
+                node, OMX_IndexParamPortDefinition, &def, sizeof(def));
+        EXPECT_SUCCESS(err, "setParameter(output port definition)");
+
+        if (params.mBitrate > 0) {
+            OMX_VIDEO_PARAM_BITRATETYPE bitrate;
+            InitOMXParams(&bitrate);
+            bitrate.nPortIndex = 1;
+            if (mOMX->getParameter(node, OMX_IndexParamVideoBitrate,
+                        &bitrate, sizeof(bitrate)) == OK) {
+                bitrate.eControlRate = OMX_Video_ControlRateVariable;
+                bitrate.nTargetBitrate = params.mBitrate;
+                mOMX->setParameter(node, OMX_IndexParamVideoBitrate,
+                        &bitrate, sizeof(bitrate));
+            }
+        }
+    } else if (!video) {
+        // Encoders take PCM, and so do the raw and G.711 decoders; the
+        // latter also need to know the layout of the file.
+        if (encoder || !strncmp(componentRole, "audio_decoder.g711", 18)
+                || !strcmp(componentRole, "audio_decoder.raw")) {
+            OMX_AUDIO_PARAM_PCMMODETYPE pcm;
+            InitOMXParams(&pcm);
+            pcm.nPortIndex = 0;
+            err = mOMX->getParameter(
+                    node, OMX_IndexParamAudioPcm, &pcm, sizeof(pcm));
+            EXPECT_SUCCESS(err, "getParameter(pcm)");
+
+            pcm.nChannels = channelCount;
+            pcm.nSamplingRate = sampleRate;
+            if (encoder) {
+                pcm.eNumData = OMX_NumericalDataSigned;
+                pcm.bInterleaved = OMX_TRUE;
+                pcm.nBitPerSample = 16;
+                pcm.ePCMMode = OMX_AUDIO_PCMModeLinear;
+            }
+            err = mOMX->setParameter(
+                    node, OMX_IndexParamAudioPcm, &pcm, sizeof(pcm));
+            EXPECT_SUCCESS(err, "setParameter(pcm)");
+        }
+
+        OMX_AUDIO_PARAM_AACPROFILETYPE aac;
+        InitOMXParams(&aac);
+        aac.nPortIndex = encoder ? 1 : 0;
+        if (!strcmp(componentRole + 14, "aac")
+                && mOMX->getParameter(node, OMX_IndexParamAudioAac,
+                    &aac, sizeof(aac)) == OK) {
+            int32_t isADTS;
+            aac.nChannels = channelCount;
+            aac.nSampleRate = sampleRate;
+            if (encoder) {
+                aac.nBitRate = params.mBitrate > 0 ? params.mBitrate : 128000;
+                aac.eAACProfile = OMX_AUDIO_AACObjectLC;
+                aac.eAACStreamFormat = OMX_AUDIO_AACStreamFormatMP4FF;
+            } else if (format->findInt32("is-adts", &isADTS) && isADTS) {
+                aac.eAACStreamFormat = OMX_AUDIO_AACStreamFormatMP4ADTS;
+            } else {
+                aac.eAACStreamFormat = OMX_AUDIO_AACStreamFormatMP4FF;
+            }
+            err = mOMX->setParameter(node, OMX_IndexParamAudioAac,
+                    &aac, sizeof(aac));
+            EXPECT_SUCCESS(err, "setParameter(aac)");
+        }
+    }
+
+    return OK;
+}
+
+// Gives the output port buffers of the new size after the component reported
+// OMX_EventPortSettingsChanged.
+status_t Harness::reconfigureOutputPort(
+        IOMX::node_id node,
+        sp<MemoryDealer> *outputDealer,
+        Vector<Buffer> *inputBuffers,
+        Vector<Buffer> *outputBuffers) {
+    status_t err = mOMX->sendCommand(node, OMX_CommandPortDisable, 1);
+    EXPECT_SUCCESS(err, "sendCommand(disable-output-port)");
+
+    omx_message msg;
+    for (;;) {
+        bool busy = false;
+        for (size_t i = 0; i < outputBuffers->size(); ++i) {
+            if ((*outputBuffers)[i].mFlags & kBufferBusy) {
+                busy = true;
+                break;
+            }
+        }
+        if (!busy) {
+            break;
+        }
+
+        err = dequeueMessageForNodeIgnoringBuffers(
+                node, inputBuffers, outputBuffers, &msg, BENCHMARK_TIMEOUT);
+        EXPECT(err == OK,
+               "Component did not return the output buffers after the "
+               "output port was disabled.");
+    }
+
+    for (size_t i = 0; i < outputBuffers->size(); ++i) {
+        err = mOMX->freeBuffer(node, 1, (*outputBuffers)[i].mID);
+        EXPECT_SUCCESS(err, "freeBuffer");
+    }
+    outputBuffers->clear();
+
+    err = dequeueMessageForNodeIgnoringBuffers(
+            node, inputBuffers, outputBuffers, &msg, BENCHMARK_TIMEOUT);
+    EXPECT(err == OK
+            && msg.type == omx_message::EVENT
+            && msg.u.event_data.event == OMX_EventCmdComplete
+            && msg.u.event_data.data1 == OMX_CommandPortDisable
+            && msg.u.event_data.data2 == 1,
+           "Component did not properly disable the output port.");
+
+    err = mOMX->sendCommand(node, OMX_CommandPortEnable, 1);
+    EXPECT_SUCCESS(err, "sendCommand(enable-output-port)");
+
+    OMX_PARAM_PORTDEFINITIONTYPE def;
+    err = getPortDefinition(node, 1, &def);
+    EXPECT_SUCCESS(err, "getPortDefinition(output)");
+
+    *outputDealer = new MemoryDealer(
+            def.nBufferCountActual * (def.nBufferSize + 4096), "OMXHarness");
+    err = allocatePortBuffers(*outputDealer, node, 1, outputBuffers);
+    EXPECT_SUCCESS(err, "allocatePortBuffers(output)");
+
+    err = dequeueMessageForNodeIgnoringBuffers(
+            node, inputBuffers, outputBuffers, &msg, BENCHMARK_TIMEOUT);
+    EXPECT(err == OK
+            && msg.type == omx_message::EVENT
+            && msg.u.event_data.event == OMX_EventCmdComplete
+            && msg.u.event_data.data1 == OMX_CommandPortEnable
+            && msg.u.event_data.data2 == 1,
+           "Component did not properly enable the output port.");
+
+    return OK;
+}
+
+static int64_t CpuTimeUs() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (int64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ll
+        + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static long PeakResidentKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static int CompareInt64(const int64_t *a, const int64_t *b) {
+    return (*a < *b) ? -1 : (*a > *b);
+}
+
+struct LatencyStats {
+    int64_t mP50, mP90, mP99, mMax;
+    size_t mCount;
+};
+
+static LatencyStats GetLatencyStats(Vector<int64_t> *latencies) {
+    LatencyStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.mCount = latencies->size();
+    if (stats.mCount > 0) {
+        latencies->sort(CompareInt64);
+        stats.mP50 = (*latencies)[stats.mCount * 50 / 100];
+        stats.mP90 = (*latencies)[stats.mCount * 90 / 100];
+        stats.mP99 = (*latencies)[stats.mCount * 99 / 100];
+        stats.mMax = (*latencies)[stats.mCount - 1];
+    }
+    return stats;
+}
+
+static void PrintLatencyStats(FILE *out, const LatencyStats &stats) {
+    fprintf(out, "{\"count\":%zu,\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,"
+            "\"max\":%lld}",
+            stats.mCount, stats.mP50, stats.mP90, stats.mP99, stats.mMax);
+}
+
+status_t Harness::benchmark(
+        const char *componentName, const char *componentRole,
+        const char *path, const BenchmarkParams &params) {
+    printf("benchmarking %s [%s] with %s\n", componentName, componentRole, path);
+
+    bool encoder = IsEncoderRole(componentRole);
+    bool video = IsVideoRole(componentRole);
+
+    Vector<AccessUnit> accessUnits;
+    sp<AMessage> format = new AMessage;
+    int64_t passDurationUs = 0;
+    size_t maxInputSize = 0;
+    status_t err;
+
+    if (!encoder) {
+        err = ExtractAccessUnits(
+                path, componentRole, &format, &accessUnits, &passDurationUs);
+        if (err != OK) {
+            return err;
+        }
+
+        for (size_t i = 0; i < accessUnits.size(); ++i) {
+            if (accessUnits[i].mData->size() > maxInputSize) {
+                maxInputSize = accessUnits[i].mData->size();
+            }
+        }
+    }
+
+    IOMX::node_id node;
+    err = mOMX->allocateNode(componentName, this, &node);
+    EXPECT_SUCCESS(err, "allocateNode");
+
+    NodeReaper reaper(this, node);
+
+    err = setRole(node, componentRole);
+    EXPECT_SUCCESS(err, "setRole");
+
+    err = configurePortsForBenchmark(
+            node, componentRole, format, params, maxInputSize);
+    if (err != OK) {
+        return err;
+    }
+
+    OMX_PARAM_PORTDEFINITIONTYPE inputDef, outputDef;
+    err = getPortDefinition(node, 0, &inputDef);
+    EXPECT_SUCCESS(err, "getPortDefinition(input)");
+    err = getPortDefinition(node, 1, &outputDef);
+    EXPECT_SUCCESS(err, "getPortDefinition(output)");
+
+    if (encoder) {
+        err = ReadRawInput(path, video, inputDef.nBufferSize, params,
+                &accessUnits, &passDurationUs);
+        if (err != OK) {
+            return err;
+        }
+    }
+
+    err = mOMX->sendCommand(node, OMX_CommandStateSet, OMX_StateIdle);
+    EXPECT_SUCCESS(err, "sendCommand(go-to-Idle)");
+
+    sp<MemoryDealer> inputDealer = new MemoryDealer(
+            inputDef.nBufferCountActual * (inputDef.nBufferSize + 4096),
+            "OMXHarness");
+    sp<MemoryDealer> outputDealer = new MemoryDealer(
+            outputDef.nBufferCountActual * (outputDef.nBufferSize + 4096),
+            "OMXHarness");
+
+    Vector<Buffer> inputBuffers;
+    err = allocatePortBuffers(inputDealer, node, 0, &inputBuffers);
+    EXPECT_SUCCESS(err, "allocatePortBuffers(input)");
+
+    Vector<Buffer> outputBuffers;
+    err = allocatePortBuffers(outputDealer, node, 1, &outputBuffers);
+    EXPECT_SUCCESS(err, "allocatePortBuffers(output)");
+
+    omx_message msg;
+    err = dequeueMessageForNode(node, &msg, BENCHMARK_TIMEOUT);
+    EXPECT(err == OK
+            && msg.type == omx_message::EVENT
+            && msg.u.event_data.event == OMX_EventCmdComplete
+            && msg.u.event_data.data2 == OMX_StateIdle,
+           "Component did not transition to idle state.");
+
+    err = mOMX->sendCommand(node, OMX_CommandStateSet, OMX_StateExecuting);
+    EXPECT_SUCCESS(err, "sendCommand(go-to-Executing)");
+
+    err = dequeueMessageForNode(node, &msg, BENCHMARK_TIMEOUT);
+    EXPECT(err == OK
+            && msg.type == omx_message::EVENT
+            && msg.u.event_data.event == OMX_EventCmdComplete
+            && msg.u.event_data.data2 == OMX_StateExecuting,
+           "Component did not transition to executing state.");
+
+    // Time at which each input buffer was queued, and for each queued
+    // timestamp the time its input buffer was queued.
+    Vector<int64_t> queuedAtUs;
+    queuedAtUs.insertAt(0ll, 0, inputBuffers.size());
+    KeyedVector<int64_t, int64_t> pendingTimestamps;
+
+    Vector<int64_t> inputLatencies;
+    Vector<int64_t> outputLatencies;
+
+    size_t numInputs = 0;
+    size_t numOutputs = 0;
+    uint64_t outputBytes = 0;
+    size_t next = 0;
+    size_t total = accessUnits.size() * params.mRepeat;
+    int64_t lastTimeUs = 0;
+    bool inputEOS = false;
+    bool outputEOS = false;
+
+    int64_t startCpuUs = CpuTimeUs();
+    int64_t startUs = ALooper::GetNowUs();
+
+    {
+        Mutex::Autolock autoLock(mLock);
+        mNumCallbacks = 0;
+    }
+
+    // With mRealtime, the first access unit of the media timeline is queued
+    // at startUs and the others no earlier than their timestamps say.
+    int64_t baseTimeUs = -1;
+
+    while (!outputEOS) {
+        int64_t waitUs = BENCHMARK_TIMEOUT;
+
+        for (size_t i = 0; i < inputBuffers.size() && !inputEOS; ++i) {
+            if (inputBuffers[i].mFlags & kBufferBusy) {
+                continue;
+            }
+
+            // The codec config data is only sent with the first pass.
+            size_t pass = next / accessUnits.size();
+            while (next < total && pass > 0
+                    && (accessUnits[next % accessUnits.size()].mFlags
+                        & OMX_BUFFERFLAG_CODECCONFIG)) {
+                ++next;
+            }
+
+            int64_t nowUs = ALooper::GetNowUs();
+            if (next < total) {
+                const AccessUnit &au = accessUnits[next % accessUnits.size()];
+                EXPECT(au.mData->size() <= inputBuffers[i].mMemory->size(),
+                       "Access unit larger than the input buffers.");
+
+                int64_t timeUs = au.mTimeUs + pass * passDurationUs;
+                if (params.mRealtime
+                        && !(au.mFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+                    if (baseTimeUs < 0) {
+                        baseTimeUs = timeUs;
+                    }
+                    int64_t dueUs = startUs + timeUs - baseTimeUs;
+                    if (dueUs > nowUs) {
+                        waitUs = dueUs - nowUs;
+                        break;
+                    }
+                }
+
+                memcpy(inputBuffers[i].mMemory->pointer(),
+                       au.mData->data(), au.mData->size());
+
+                err = mOMX->emptyBuffer(
+                        node, inputBuffers[i].mID, 0, au.mData->size(),
+                        au.mFlags, timeUs);
+                EXPECT_SUCCESS(err, "emptyBuffer");
+
+                if (!(au.mFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+                    pendingTimestamps.add(timeUs, nowUs);
+                    lastTimeUs = timeUs;
+                }
+                ++numInputs;
+                ++next;
+            } else {
+                err = mOMX->emptyBuffer(
+                        node, inputBuffers[i].mID, 0, 0,
+                        OMX_BUFFERFLAG_EOS, lastTimeUs);
+                EXPECT_SUCCESS(err, "emptyBuffer(EOS)");
+                inputEOS = true;
+            }
+
+            inputBuffers.editItemAt(i).mFlags |= kBufferBusy;
+            queuedAtUs.editItemAt(i) = nowUs;
+        }
+
+        for (size_t i = 0; i < outputBuffers.size(); ++i) {
+            if (outputBuffers[i].mFlags & kBufferBusy) {
+                continue;
+            }
+
+            err = mOMX->fillBuffer(node, outputBuffers[i].mID);
+            EXPECT_SUCCESS(err, "fillBuffer");
+            outputBuffers.editItemAt(i).mFlags |= kBufferBusy;
+        }
+
+        err = dequeueMessageForNode(node, &msg, waitUs);
+        if (err == TIMED_OUT && waitUs < BENCHMARK_TIMEOUT) {
+            // Time to queue the next input.
+            continue;
+        }
+        EXPECT(err == OK, "Component stopped returning buffers.");
+
+        int64_t nowUs = ALooper::GetNowUs();
+        switch (msg.type) {
+            case omx_message::EMPTY_BUFFER_DONE:
+            {
+                for (size_t i = 0; i < inputBuffers.size(); ++i) {
+                    if (inputBuffers[i].mID == msg.u.buffer_data.buffer) {
+                        inputBuffers.editItemAt(i).mFlags &= ~kBufferBusy;
+                        inputLatencies.push(nowUs - queuedAtUs[i]);
+                        break;
+                    }
+                }
+                break;
+            }
+
+            case omx_message::FILL_BUFFER_DONE:
+            {
+                for (size_t i = 0; i < outputBuffers.size(); ++i) {
+                    if (outputBuffers[i].mID
+                            == msg.u.extended_buffer_data.buffer) {
+                        outputBuffers.editItemAt(i).mFlags &= ~kBufferBusy;
+                        break;
+                    }
+                }
+
+                if (msg.u.extended_buffer_data.range_length > 0) {
+                    ++numOutputs;
+                    outputBytes += msg.u.extended_buffer_data.range_length;
+
+                    // Only outputs that carry the timestamp of an input give a
+                    // latency; decoders that split or merge frames may not.
+                    ssize_t index = pendingTimestamps.indexOfKey(
+                            msg.u.extended_buffer_data.timestamp);
+                    if (index >= 0) {
+                        outputLatencies.push(
+                                nowUs - pendingTimestamps.valueAt(index));
+                        pendingTimestamps.removeItemsAt(index);
+                    }
+                }
+
+                if (msg.u.extended_buffer_data.flags & OMX_BUFFERFLAG_EOS) {
+                    outputEOS = true;
+                }
+                break;
+            }
+
+            case omx_message::EVENT:
+            {
+                if (msg.u.event_data.event == OMX_EventPortSettingsChanged
+                        && msg.u.event_data.data1 == 1
+                        && (msg.u.event_data.data2 == 0
+                            || msg.u.event_data.data2
+                                == OMX_IndexParamPortDefinition)) {
+                    err = reconfigureOutputPort(
+                            node, &outputDealer, &inputBuffers, &outputBuffers);
+                    if (err != OK) {
+                        return err;
+                    }
+                } else {
+                    EXPECT(msg.u.event_data.event != OMX_EventError,
+                           "Component signalled an error.");
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    int64_t wallUs = ALooper::GetNowUs() - startUs;
+    int64_t cpuUs = CpuTimeUs() - startCpuUs;
+    long peakKb = PeakResidentKb();
+
+    size_t numCallbacks;
+    {
+        Mutex::Autolock autoLock(mLock);
+        numCallbacks = mNumCallbacks;
+    }
+
+    LatencyStats inputStats = GetLatencyStats(&inputLatencies);
+    LatencyStats outputStats = GetLatencyStats(&outputLatencies);
+
+    int64_t mediaUs = passDurationUs * params.mRepeat;
+    double seconds = wallUs / 1E6;
+
+    printf("  %zu input buffers, %zu output buffers in %.3f secs\n",
+           numInputs, numOutputs, seconds);
+    printf("  %.1f frames/sec, %.1fx realtime, cpu %.3f secs (%.0f%%), "
+           "peak rss %ld KB\n",
+           numOutputs / seconds, mediaUs / (double)wallUs, cpuUs / 1E6,
+           100.0 * cpuUs / wallUs, peakKb);
+    printf("  %zu observer callbacks, %.2f per output buffer\n",
+           numCallbacks,
+           numOutputs > 0 ? numCallbacks / (double)numOutputs : 0.0);
+    printf("  input latency (us): p50 %lld p90 %lld p99 %lld max %lld\n",
+           inputStats.mP50, inputStats.mP90, inputStats.mP99,
+           inputStats.mMax);
+    printf("  output latency (us): p50 %lld p90 %lld p99 %lld max %lld "
+           "(%zu outputs matched)\n",
+           outputStats.mP50, outputStats.mP90, outputStats.mP99,
+           outputStats.mMax, outputStats.mCount);
+
+    if (params.mResultsPath != NULL) {
+        FILE *out = fopen(params.mResultsPath, "a");
+        EXPECT(out != NULL, "Unable to open the results file.");
+
+        fprintf(out, "{\"component\":\"%s\",\"role\":\"%s\",\"input\":\"%s\","
+                "\"repeat\":%d,\"input_buffers\":%zu,\"output_buffers\":%zu,"
+                "\"output_bytes\":%llu,\"media_us\":%lld,\"wall_us\":%lld,"
+                "\"cpu_us\":%lld,\"frames_per_sec\":%.2f,\"realtime\":%.2f,"
+                "\"peak_rss_kb\":%ld,\"realtime_input\":%s,\"callbacks\":%zu,"
+                "\"input_latency_us\":",
+                componentName, componentRole, path, params.mRepeat,
+                numInputs, numOutputs, (unsigned long long)outputBytes,
+                mediaUs, wallUs, cpuUs, numOutputs / seconds,
+                mediaUs / (double)wallUs, peakKb,
+                params.mRealtime ? "true" : "false", numCallbacks);
+        PrintLatencyStats(out, inputStats);
+        fprintf(out, ",\"output_latency_us\":");
+        PrintLatencyStats(out, outputStats);
+        fprintf(out, "}\n");
+        fclose(out);
+    }
+
+    // freeNode() takes the component back to the loaded state.
+    return OK;
+}
+
 }  // namespace android
 
 static void usage(const char *me) {
     fprintf(stderr, "usage: %s\n"
                     "  -h(elp)  Show this information\n"
                     "  -s(eed)  Set the random seed\n"
+                    "  -l(ocal) Run the components in this process\n"
+                    "  -b(enchmark) file  Time the component on file\n"
+                    "  -n repeat  Number of passes over the file\n"
+                    "  -o(utput) file  Append the results as JSON to file\n"
+                    "  -r(ealtime)  Queue the input at the rate of the "
+                    "media, to measure latency instead of throughput\n"
+                    "  -p key=value  sample-rate, channel-count, width, "
+                    "height, frame-rate or bitrate of the raw input of "
+                    "encoders\n"
                     "    [ component role ]\n\n"
                     "When launched without specifying a specific component "
                     "and role, tool will test all available OMX components "
                     "in all their supported roles. To determine available "
                     "component names, use \"stagefright -l\"\n"
                     "It's also a good idea to run a separate \"adb logcat\""
-                    " for additional debug and progress information.", me);
+                    " for additional debug and progress information.\n\n"
+                    "With -b the component runs in this process on the "
+                    "access units of file, or on raw 16 bit PCM or YUV420 "
+                    "planar frames for encoders, and frames/sec, latency, "
+                    "CPU time and peak memory are reported.\n", me);
 
     exit(0);
 }
 
+static bool ParseBenchmarkParam(
+        const char *arg, android::Harness::BenchmarkParams *params) {
+    const char *eq = strchr(arg, '=');
+    if (eq == NULL) {
+        return false;
+    }
+
+    char *end;
+    long value = strtol(eq + 1, &end, 10);
+    if (*end != '\0' || end == eq + 1 || value <= 0) {
+        return false;
+    }
+
+    struct {
+        const char *mKey;
+        int32_t *mValue;
+    } kParams[] = {
+        { "sample-rate", &params->mSampleRate },
+        { "channel-count", &params->mChannelCount },
+        { "width", &params->mWidth },
+        { "height", &params->mHeight },
+        { "frame-rate", &params->mFrameRate },
+        { "bitrate", &params->mBitrate },
+    };
+
+    for (size_t i = 0; i < sizeof(kParams) / sizeof(kParams[0]); ++i) {
+        if (strlen(kParams[i].mKey) == (size_t)(eq - arg)
+                && !strncmp(arg, kParams[i].mKey, eq - arg)) {
+            *kParams[i].mValue = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 int main(int argc, char **argv) {
     using namespace android;
 
@@ -805,10 +1644,57 @@ int main(int argc, char **argv) {
     const char *me = argv[0];
 
     unsigned long seed = 0xdeadbeef;
+    bool localOMX = false;
+    const char *benchmarkPath = NULL;
+    Harness::BenchmarkParams params;
 
     int res;
-    while ((res = getopt(argc, argv, "hs:")) >= 0) {
+    while ((res = getopt(argc, argv, "hs:lb:n:o:p:r")) >= 0) {
         switch (res) {
+            case 'l':
+            {
+                localOMX = true;
+                break;
+            }
+
+            case 'b':
+            {
+                benchmarkPath = optarg;
+                localOMX = true;
+                break;
+            }
+
+            case 'n':
+            {
+                params.mRepeat = atoi(optarg);
+                if (params.mRepeat < 1) {
+                    fprintf(stderr, "Malformed repeat count.\n");
+                    return 1;
+                }
+                break;
+            }
+
+            case 'r':
+            {
+                params.mRealtime = true;
+                break;
+            }
+
+            case 'o':
+            {
+                params.mResultsPath = optarg;
+                break;
+            }
+
+            case 'p':
+            {
+                if (!ParseBenchmarkParam(optarg, &params)) {
+                    fprintf(stderr, "Malformed parameter '%s'.\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+
             case 's':
             {
                 char *end;
@@ -840,12 +1726,24 @@ int main(int argc, char **argv) {
     argc -= optind;
     argv += optind;
 
+    if (benchmarkPath != NULL) {
+        if (argc != 2) {
+            usage(me);
+        }
+
+        sp<Harness> h = new Harness(true /* localOMX */);
+        CHECK_EQ(h->initCheck(), (status_t)OK);
+
+        return h->benchmark(argv[0], argv[1], benchmarkPath, params) == OK
+            ? 0 : 1;
+    }
+
     printf("To reproduce the conditions for this test, launch "
            "with \"%s -s %lu\"\n", me, seed);
 
     srand(seed);
 
-    sp<Harness> h = new Harness;
+    sp<Harness> h = new Harness(localOMX);
     CHECK_EQ(h->initCheck(), (status_t)OK);
 
     if (argc == 0) {
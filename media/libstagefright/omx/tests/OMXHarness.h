@@ -27,6 +27,8 @@
 
 namespace android {
 
+struct ABuffer;
+struct AMessage;
 class MemoryDealer;
 
 struct Harness : public BnOMXObserver {
@@ -39,7 +41,31 @@ struct Harness : public BnOMXObserver {
         uint32_t mFlags;
     };
 
-    Harness();
+    // What benchmark() feeds the component. The sample rate, channel count,
+    // size, frame rate and bitrate describe the raw input of encoders;
+    // decoders take them from the file.
+    struct BenchmarkParams {
+        BenchmarkParams();
+
+        int32_t mRepeat;
+        int32_t mSampleRate;
+        int32_t mChannelCount;
+        int32_t mWidth;
+        int32_t mHeight;
+        int32_t mFrameRate;
+        int32_t mBitrate;
+
+        // Queue the input no faster than its timestamps, e.g. 60 frames/sec
+        // of video, rather than as fast as the component takes it.
+        bool mRealtime;
+
+        // If not NULL, one JSON object per run is appended to this file.
+        const char *mResultsPath;
+    };
+
+    // With localOMX the components run in this process instead of in
+    // mediaserver.
+    Harness(bool localOMX = false);
 
     status_t initCheck() const;
 
@@ -74,7 +100,12 @@ struct Harness : public BnOMXObserver {
 
     status_t testAll();
 
+    status_t benchmark(
+            const char *componentName, const char *componentRole,
+            const char *path, const BenchmarkParams &params);
+
     virtual void onMessage(const omx_message &msg);
+    virtual void onMessages(const List<omx_message> &messages);
 
 protected:
     virtual ~Harness();
@@ -88,8 +119,20 @@ private:
     sp<IOMX> mOMX;
     List<omx_message> mMessageQueue;
     Condition mMessageAddedCondition;
+    size_t mNumCallbacks;
+
+    status_t initOMX(bool localOMX);
 
-    status_t initOMX();
+    status_t configurePortsForBenchmark(
+            IOMX::node_id node, const char *componentRole,
+            const sp<AMessage> &format, const BenchmarkParams &params,
+            size_t maxInputSize);
+
+    status_t reconfigureOutputPort(
+            IOMX::node_id node,
+            sp<MemoryDealer> *outputDealer,
+            Vector<Buffer> *inputBuffers,
+            Vector<Buffer> *outputBuffers);
 
     bool handleBufferMessage(
             const omx_message &msg,
@@ -567,24 +567,65 @@ void ARTPWriter::sendBye() {
     send(buffer, true /* isRTCP */);
 }
 
-void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
-    // 12 bytes RTP header + 2 bytes for the FU-indicator and FU-header.
-    CHECK_GE(kMaxPacketSize, 12u + 2u);
+// Returns the first 4-byte start code in [data, data + size), or
+// data + size if there is none.
+static const uint8_t *findStartCode(const uint8_t *data, size_t size) {
+    const uint8_t *end = data + size;
+    const uint8_t *ptr = data + 3;
+
+    while (ptr < end) {
+        ptr = (const uint8_t *)memchr(ptr, 0x01, end - ptr);
+        if (ptr == NULL) {
+            break;
+        }
+        if (ptr[-1] == 0x00 && ptr[-2] == 0x00 && ptr[-3] == 0x00) {
+            return ptr - 3;
+        }
+        ++ptr;
+    }
+
+    return end;
+}
 
+void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
     int64_t timeUs;
     CHECK(mediaBuf->meta_data()->findInt64(kKeyTime, &timeUs));
 
     uint32_t rtpTime = mRTPTimeBase + (timeUs * 9 / 100ll);
 
+    // The leading start code is already gone, the NAL units after the
+    // first one, e.g. further slices of the picture, still have theirs.
     const uint8_t *mediaData =
         (const uint8_t *)mediaBuf->data() + mediaBuf->range_offset();
+    const uint8_t *end = mediaData + mediaBuf->range_length();
+
+    while (mediaData < end) {
+        const uint8_t *next = findStartCode(mediaData, end - mediaData);
+        if (next > mediaData) {
+            sendAVCNALUnit(rtpTime, mediaData, next - mediaData, next == end);
+        }
+        mediaData = (next < end) ? next + 4 : end;
+    }
+
+    mLastRTPTime = rtpTime;
+    mLastNTPTime = GetNowNTP();
+}
+
+void ARTPWriter::sendAVCNALUnit(
+        uint32_t rtpTime, const uint8_t *mediaData, size_t mediaSize,
+        bool lastNALUnit) {
+    // 12 bytes RTP header + 2 bytes for the FU-indicator and FU-header.
+    CHECK_GE(kMaxPacketSize, 12u + 2u);
+
+    // Only the last packet of the access unit carries the M-bit.
+    uint8_t marker = lastNALUnit ? (1 << 7) : 0x00;
 
     sp<ABuffer> buffer = new ABuffer(kMaxPacketSize);
-    if (mediaBuf->range_length() + 12 <= buffer->capacity()) {
+    if (mediaSize + 12 <= buffer->capacity()) {
         // The data fits into a single packet
         uint8_t *data = buffer->data();
         data[0] = 0x80;
-        data[1] = (1 << 7) | PT;  // M-bit
+        data[1] = marker | PT;  // M-bit
         data[2] = (mSeqNo >> 8) & 0xff;
         data[3] = mSeqNo & 0xff;
         data[4] = rtpTime >> 24;
@@ -596,10 +637,9 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
         data[10] = (mSourceID >> 8) & 0xff;
         data[11] = mSourceID & 0xff;
 
-        memcpy(&data[12],
-               mediaData, mediaBuf->range_length());
+        memcpy(&data[12], mediaData, mediaSize);
 
-        buffer->setRange(0, mediaBuf->range_length() + 12);
+        buffer->setRange(0, mediaSize + 12);
 
         send(buffer, false /* isRTCP */);
 
@@ -613,8 +653,8 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
         size_t offset = 1;
 
         bool firstPacket = true;
-        while (offset < mediaBuf->range_length()) {
-            size_t size = mediaBuf->range_length() - offset;
+        while (offset < mediaSize) {
+            size_t size = mediaSize - offset;
             bool lastPacket = true;
             if (size + 12 + 2 > buffer->capacity()) {
                 lastPacket = false;
@@ -623,7 +663,7 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
 
             uint8_t *data = buffer->data();
             data[0] = 0x80;
-            data[1] = (lastPacket ? (1 << 7) : 0x00) | PT;  // M-bit
+            data[1] = (lastPacket ? marker : 0x00) | PT;  // M-bit
             data[2] = (mSeqNo >> 8) & 0xff;
             data[3] = mSeqNo & 0xff;
             data[4] = rtpTime >> 24;
@@ -658,9 +698,6 @@ void ARTPWriter::sendAVCData(MediaBuffer *mediaBuf) {
             offset += size;
         }
     }
-
-    mLastRTPTime = rtpTime;
-    mLastNTPTime = GetNowNTP();
 }
 
 void ARTPWriter::sendH263Data(MediaBuffer *mediaBuf) {
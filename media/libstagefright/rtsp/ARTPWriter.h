@@ -115,6 +115,9 @@ private:
 
     void sendBye();
     void sendAVCData(MediaBuffer *mediaBuf);
+    void sendAVCNALUnit(
+            uint32_t rtpTime, const uint8_t *mediaData, size_t mediaSize,
+            bool lastNALUnit);
     void sendH263Data(MediaBuffer *mediaBuf);
     void sendAMRData(MediaBuffer *mediaBuf);
 
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ColorConverter_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <media/stagefright/ColorConverter.h>
+#include <media/stagefright/MediaErrors.h>
+
+namespace android {
+
+// Wide enough for the vector kernels to run on each row, plus a tail that
+// the scalar code converts.
+static const size_t kWidth = 38;
+static const size_t kHeight = 6;
+
+static const OMX_COLOR_FORMATTYPE kSrcFormats[] = {
+    OMX_COLOR_FormatYUV420Planar,
+    OMX_COLOR_FormatCbYCrY,
+    OMX_QCOM_COLOR_FormatYVU420SemiPlanar,
+    OMX_COLOR_FormatYUV420SemiPlanar,
+    OMX_TI_COLOR_FormatYUV420PackedSemiPlanar,
+};
+
+static const OMX_COLOR_FORMATTYPE kDstFormats[] = {
+    OMX_COLOR_Format16bitRGB565,
+    OMX_COLOR_Format32BitRGBA8888,
+    OMX_COLOR_Format32bitBGRA8888,
+};
+
+// Distinct samples everywhere, with U and V far enough apart that decoding
+// them in the wrong order, or writing R and B in the wrong order, changes
+// the output.
+static uint8_t lumaAt(size_t x, size_t y) {
+    return 16 + (x * 37 + y * 101) % 220;
+}
+
+static uint8_t uAt(size_t x, size_t y) {
+    return 40 + (x * 53 + y * 29) % 80;
+}
+
+static uint8_t vAt(size_t x, size_t y) {
+    return 140 + (x * 31 + y * 67) % 100;
+}
+
+static unsigned clip(signed x) {
+    return (x < 0) ? 0 : (x > 255) ? 255 : (unsigned)x;
+}
+
+// Builds a kWidth x kHeight frame in |format|. The chroma of pixel (x, y)
+// is that of (x / 2, y / 2) for every format, CbYCrY repeating it on both
+// rows.
+static void makeSource(OMX_COLOR_FORMATTYPE format, uint8_t *bits) {
+    const size_t lumaSize = kWidth * kHeight;
+
+    for (size_t y = 0; y < kHeight; ++y) {
+        for (size_t x = 0; x < kWidth; ++x) {
+            uint8_t luma = lumaAt(x, y);
+            uint8_t u = uAt(x / 2, y / 2);
+            uint8_t v = vAt(x / 2, y / 2);
+
+            switch (format) {
+                case OMX_COLOR_FormatYUV420Planar:
+                    bits[y * kWidth + x] = luma;
+                    bits[lumaSize + (y / 2) * (kWidth / 2) + x / 2] = u;
+                    bits[lumaSize + lumaSize / 4
+                        + (y / 2) * (kWidth / 2) + x / 2] = v;
+                    break;
+
+                case OMX_COLOR_FormatCbYCrY:
+                {
+                    uint8_t *pair = bits + (y * kWidth + (x & ~1)) * 2;
+                    pair[0] = u;
+                    pair[2] = v;
+                    pair[(x & 1) ? 3 : 1] = luma;
+                    break;
+                }
+
+                case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
+                case OMX_COLOR_FormatYUV420SemiPlanar:
+                case OMX_TI_COLOR_FormatYUV420PackedSemiPlanar:
+                {
+                    bool vFirst =
+                        (format == OMX_QCOM_COLOR_FormatYVU420SemiPlanar);
+
+                    uint8_t *pair =
+                        bits + lumaSize + (y / 2) * kWidth + (x & ~1);
+
+                    bits[y * kWidth + x] = luma;
+                    pair[0] = vFirst ? v : u;
+                    pair[1] = vFirst ? u : v;
+                    break;
+                }
+
+                default:
+                    FAIL() << "unexpected source format " << format;
+            }
+        }
+    }
+}
+
+static void expectedPixel(
+        OMX_COLOR_FORMATTYPE format, size_t x, size_t y, uint8_t *out) {
+    signed luma = ((signed)lumaAt(x, y) - 16) * 298;
+    signed u = (signed)uAt(x / 2, y / 2) - 128;
+    signed v = (signed)vAt(x / 2, y / 2) - 128;
+
+    unsigned r = clip((luma + v * 409) / 256);
+    unsigned g = clip((luma - v * 208 - u * 100) / 256);
+    unsigned b = clip((luma + u * 517) / 256);
+
+    switch (format) {
+        case OMX_COLOR_Format16bitRGB565:
+        {
+            uint16_t rgb = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+            memcpy(out, &rgb, sizeof(rgb));
+            break;
+        }
+
+        case OMX_COLOR_Format32BitRGBA8888:
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            out[3] = 0xff;
+            break;
+
+        case OMX_COLOR_Format32bitBGRA8888:
+            out[0] = b;
+            out[1] = g;
+            out[2] = r;
+            out[3] = 0xff;
+            break;
+
+        default:
+            FAIL() << "unexpected destination format " << format;
+    }
+}
+
+TEST(ColorConverterTest, PixelValuesForEachFormatPair) {
+    // CbYCrY needs the most.
+    uint8_t src[kWidth * kHeight * 2];
+    uint8_t dst[kWidth * kHeight * 4];
+
+    for (size_t i = 0; i < sizeof(kSrcFormats) / sizeof(kSrcFormats[0]); ++i) {
+        memset(src, 0, sizeof(src));
+        makeSource(kSrcFormats[i], src);
+
+        for (size_t j = 0;
+                j < sizeof(kDstFormats) / sizeof(kDstFormats[0]); ++j) {
+            SCOPED_TRACE(testing::Message()
+                    << "source 0x" << std::hex << kSrcFormats[i]
+                    << " destination 0x" << kDstFormats[j]);
+
+            ColorConverter converter(kSrcFormats[i], kDstFormats[j]);
+            ASSERT_TRUE(converter.isValid());
+
+            size_t bpp = (kDstFormats[j] == OMX_COLOR_Format16bitRGB565)
+                ? 2 : 4;
+
+            memset(dst, 0, sizeof(dst));
+            ASSERT_EQ((status_t)OK, converter.convert(
+                        src, kWidth, kHeight,
+                        0, 0, kWidth - 1, kHeight - 1,
+                        dst, kWidth, kHeight,
+                        0, 0, kWidth - 1, kHeight - 1));
+
+            for (size_t y = 0; y < kHeight; ++y) {
+                for (size_t x = 0; x < kWidth; ++x) {
+                    uint8_t expected[4];
+                    expectedPixel(kDstFormats[j], x, y, expected);
+
+                    const uint8_t *actual = dst + (y * kWidth + x) * bpp;
+                    for (size_t k = 0; k < bpp; ++k) {
+                        ASSERT_EQ(expected[k], actual[k])
+                            << "pixel (" << std::dec << x << ", " << y
+                            << ") byte " << k;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A uniform frame stays uniform when downscaled, so the scaled path can be
+// checked against the same expected values.
+TEST(ColorConverterTest, ScaledUniformFrame) {
+    uint8_t src[kWidth * kHeight * 2];
+    uint8_t dst[kWidth * kHeight * 4];
+
+    const uint8_t kY = 120, kU = 70, kV = 200;
+
+    for (size_t j = 0; j < sizeof(kDstFormats) / sizeof(kDstFormats[0]); ++j) {
+        SCOPED_TRACE(testing::Message()
+                << "destination 0x" << std::hex << kDstFormats[j]);
+
+        // NV21: interleaved chroma with V first.
+        memset(src, kY, kWidth * kHeight);
+        for (size_t i = 0; i < kWidth * kHeight / 2; i += 2) {
+            src[kWidth * kHeight + i] = kV;
+            src[kWidth * kHeight + i + 1] = kU;
+        }
+
+        ColorConverter converter(
+                OMX_QCOM_COLOR_FormatYVU420SemiPlanar, kDstFormats[j]);
+        ASSERT_TRUE(converter.isValid());
+
+        size_t dstWidth = kWidth / 3;
+        size_t dstHeight = kHeight / 2;
+        size_t bpp = (kDstFormats[j] == OMX_COLOR_Format16bitRGB565) ? 2 : 4;
+
+        ASSERT_EQ((status_t)OK, converter.convert(
+                    src, kWidth, kHeight,
+                    0, 0, kWidth - 1, kHeight - 1,
+                    dst, dstWidth, dstHeight,
+                    0, 0, dstWidth - 1, dstHeight - 1));
+
+        signed luma = ((signed)kY - 16) * 298;
+        signed u = (signed)kU - 128;
+        signed v = (signed)kV - 128;
+
+        unsigned r = clip((luma + v * 409) / 256);
+        unsigned g = clip((luma - v * 208 - u * 100) / 256);
+        unsigned b = clip((luma + u * 517) / 256);
+
+        uint8_t expected[4];
+        if (bpp == 2) {
+            uint16_t rgb = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+            memcpy(expected, &rgb, sizeof(rgb));
+        } else if (kDstFormats[j] == OMX_COLOR_Format32BitRGBA8888) {
+            expected[0] = r;
+            expected[1] = g;
+            expected[2] = b;
+            expected[3] = 0xff;
+        } else {
+            expected[0] = b;
+            expected[1] = g;
+            expected[2] = r;
+            expected[3] = 0xff;
+        }
+
+        for (size_t i = 0; i < dstWidth * dstHeight; ++i) {
+            for (size_t k = 0; k < bpp; ++k) {
+                ASSERT_EQ(expected[k], dst[i * bpp + k])
+                    << "pixel " << std::dec << i << " byte " << k;
+            }
+        }
+    }
+}
+
+}  // namespace android
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ID3_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <media/stagefright/DataSource.h>
+#include <media/stagefright/MediaErrors.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+#include "include/ID3.h"
+
+namespace android {
+
+struct BufferSource : public DataSource {
+    BufferSource(const Vector<uint8_t> &data)
+        : mData(data) {
+    }
+
+    virtual status_t initCheck() const {
+        return OK;
+    }
+
+    virtual ssize_t readAt(off64_t offset, void *data, size_t size) {
+        if (offset < 0 || offset >= (off64_t)mData.size()) {
+            return 0;
+        }
+        if (size > mData.size() - offset) {
+            size = mData.size() - offset;
+        }
+        memcpy(data, mData.array() + offset, size);
+        return size;
+    }
+
+    virtual status_t getSize(off64_t *size) {
+        *size = mData.size();
+        return OK;
+    }
+
+private:
+    Vector<uint8_t> mData;
+};
+
+// Builds an ID3v2 tag of the given major version, frame by frame.
+struct TagBuilder {
+    TagBuilder(uint8_t version)
+        : mVersion(version) {
+    }
+
+    void addFrame(const char *id, const void *payload, size_t size) {
+        size_t idLength = (mVersion == 2) ? 3 : 4;
+        mFrames.appendArray((const uint8_t *)id, idLength);
+        if (mVersion == 2) {
+            mFrames.push(size >> 16);
+            mFrames.push(size >> 8);
+            mFrames.push(size);
+        } else {
+            // These sizes are the same plain and syncsafe.
+            mFrames.push(0);
+            mFrames.push(0);
+            mFrames.push(size >> 7);
+            mFrames.push(size & 0x7f);
+            mFrames.push(0);    // flags
+            mFrames.push(0);
+        }
+        if (size > 0) {
+            mFrames.appendArray((const uint8_t *)payload, size);
+        }
+    }
+
+    void addText(const char *id, const char *text) {
+        Vector<uint8_t> payload;
+        payload.push(0);    // ISO 8859-1
+        payload.appendArray((const uint8_t *)text, strlen(text));
+        addFrame(id, payload.array(), payload.size());
+    }
+
+    sp<DataSource> source() const {
+        Vector<uint8_t> tag;
+        const uint8_t header[] = {
+            'I', 'D', '3', mVersion, 0, 0,
+            0, 0, (uint8_t)(mFrames.size() >> 7), (uint8_t)(mFrames.size() & 0x7f),
+        };
+        tag.appendArray(header, sizeof(header));
+        tag.appendVector(mFrames);
+
+        // Some audio after the tag.
+        for (size_t i = 0; i < 64; ++i) {
+            tag.push(0xff);
+        }
+
+        return new BufferSource(tag);
+    }
+
+private:
+    uint8_t mVersion;
+    Vector<uint8_t> mFrames;
+};
+
+static void expectString(const ID3 &id3, const char *id, const char *expected) {
+    ID3::Iterator it(id3, id);
+    ASSERT_FALSE(it.done()) << id;
+
+    String8 s;
+    it.getString(&s);
+    EXPECT_STREQ(expected, s.string()) << id;
+}
+
+// A frame whose size is 0 has no encoding byte, its string is empty and
+// the frames after it are still found.
+TEST(ID3Test, ZeroSizeTextFrame) {
+    const uint8_t versions[] = { 2, 3, 4 };
+
+    for (size_t i = 0; i < sizeof(versions); ++i) {
+        SCOPED_TRACE(testing::Message() << "version 2." << (int)versions[i]);
+
+        bool v22 = (versions[i] == 2);
+
+        TagBuilder builder(versions[i]);
+        builder.addFrame(v22 ? "TT2" : "TIT2", NULL, 0);
+        builder.addFrame(v22 ? "COM" : "COMM", NULL, 0);
+        builder.addText(v22 ? "TP1" : "TPE1", "Artist");
+
+        ID3 id3(builder.source());
+        ASSERT_TRUE(id3.isValid());
+
+        expectString(id3, v22 ? "TT2" : "TIT2", "");
+        expectString(id3, v22 ? "TP1" : "TPE1", "Artist");
+
+        ID3::Iterator it(id3, v22 ? "COM" : "COMM");
+        ASSERT_FALSE(it.done());
+
+        String8 s, ss;
+        it.getString(&s, &ss);
+        EXPECT_STREQ("", s.string());
+        EXPECT_STREQ("", ss.string());
+
+        size_t length;
+        it.getData(&length);
+        EXPECT_EQ(0u, length);
+    }
+}
+
+// Only the encoding byte: the smallest frame that has one.
+TEST(ID3Test, EncodingOnlyTextFrame) {
+    TagBuilder builder(3);
+    builder.addText("TIT2", "");
+    builder.addText("TALB", "Album");
+
+    ID3 id3(builder.source());
+    ASSERT_TRUE(id3.isValid());
+
+    expectString(id3, "TIT2", "");
+    expectString(id3, "TALB", "Album");
+}
+
+}  // namespace android
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "MediaCodecList_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <media/stagefright/MediaCodecList.h>
+#include <media/stagefright/MediaErrors.h>
+
+namespace android {
+
+static const char *kXmlFile = "/data/local/tmp/MediaCodecList_test.xml";
+static const char *kCacheFile = "/data/local/tmp/MediaCodecList_test.cache";
+
+static const char *kXml =
+    "<MediaCodecs>\n"
+    "    <Decoders>\n"
+    "        <MediaCodec name=\"OMX.test.avc.decoder\" type=\"video/avc\" />\n"
+    "        <MediaCodec name=\"OMX.test.mpeg4.decoder\">\n"
+    "            <Type name=\"video/mp4v-es\" />\n"
+    "            <Type name=\"video/3gpp\" />\n"
+    "        </MediaCodec>\n"
+    "    </Decoders>\n"
+    "    <Encoders>\n"
+    "        <MediaCodec name=\"OMX.test.avc.encoder\" type=\"video/avc\">\n"
+    "            <Quirk name=\"requires-allocate-on-input-ports\" />\n"
+    "        </MediaCodec>\n"
+    "    </Encoders>\n"
+    "</MediaCodecs>\n";
+
+struct MediaCodecListTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        unlink(kCacheFile);
+        writeXml(kXml);
+    }
+
+    virtual void TearDown() {
+        unlink(kXmlFile);
+        unlink(kCacheFile);
+    }
+
+    static void writeXml(const char *xml) {
+        FILE *file = fopen(kXmlFile, "w");
+        ASSERT_TRUE(file != NULL);
+        fputs(xml, file);
+        fclose(file);
+    }
+
+    static MediaCodecList *create() {
+        return new MediaCodecList(kXmlFile, kCacheFile);
+    }
+
+    static void destroy(MediaCodecList *list) {
+        delete list;
+    }
+
+    static status_t initCheck(const MediaCodecList *list) {
+        return list->initCheck();
+    }
+
+    // Stands for a capabilities query, which needs the component.
+    static void addCaps(MediaCodecList *list, const char *key) {
+        MediaCodecList::Capabilities caps;
+        MediaCodecList::ProfileLevel profileLevel;
+        profileLevel.mProfile = 8;
+        profileLevel.mLevel = 2048;
+        caps.mProfileLevels.push(profileLevel);
+        caps.mColorFormats.push(19);
+        caps.mColorFormats.push(21);
+
+        Mutex::Autolock autoLock(list->mCapsLock);
+        list->mCaps.add(AString(key), caps);
+        list->saveCache_l();
+    }
+
+    static bool hasCaps(const MediaCodecList *list, const char *key) {
+        Mutex::Autolock autoLock(list->mCapsLock);
+        ssize_t index = list->mCaps.indexOfKey(AString(key));
+        if (index < 0) {
+            return false;
+        }
+
+        const MediaCodecList::Capabilities &caps = list->mCaps.valueAt(index);
+        return caps.mProfileLevels.size() == 1
+            && caps.mProfileLevels[0].mProfile == 8u
+            && caps.mProfileLevels[0].mLevel == 2048u
+            && caps.mColorFormats.size() == 2
+            && caps.mColorFormats[0] == 19u
+            && caps.mColorFormats[1] == 21u;
+    }
+
+    static void expectSameCodecs(
+            const MediaCodecList *a, const MediaCodecList *b) {
+        ASSERT_EQ(a->countCodecs(), b->countCodecs());
+        for (size_t i = 0; i < a->countCodecs(); ++i) {
+            EXPECT_STREQ(a->getCodecName(i), b->getCodecName(i));
+            EXPECT_EQ(a->isEncoder(i), b->isEncoder(i));
+            EXPECT_EQ(a->codecHasQuirk(i, "requires-allocate-on-input-ports"),
+                      b->codecHasQuirk(i, "requires-allocate-on-input-ports"));
+
+            Vector<AString> typesA, typesB;
+            ASSERT_EQ((status_t)OK, a->getSupportedTypes(i, &typesA));
+            ASSERT_EQ((status_t)OK, b->getSupportedTypes(i, &typesB));
+            ASSERT_EQ(typesA.size(), typesB.size());
+            for (size_t j = 0; j < typesA.size(); ++j) {
+                EXPECT_STREQ(typesA[j].c_str(), typesB[j].c_str());
+            }
+        }
+    }
+};
+
+TEST_F(MediaCodecListTest, ReloadsSavedCache) {
+    MediaCodecList *parsed = create();
+    ASSERT_EQ((status_t)OK, initCheck(parsed));
+    ASSERT_EQ(0, access(kCacheFile, R_OK));
+
+    // Only the cache can bring these back.
+    addCaps(parsed, "OMX.test.avc.decoder/video/avc");
+
+    MediaCodecList *cached = create();
+    ASSERT_EQ((status_t)OK, initCheck(cached));
+    EXPECT_TRUE(hasCaps(cached, "OMX.test.avc.decoder/video/avc"));
+    expectSameCodecs(parsed, cached);
+
+    EXPECT_EQ(0, cached->findCodecByType("video/avc", false));
+    EXPECT_EQ(2, cached->findCodecByType("video/avc", true));
+    EXPECT_EQ(1, cached->findCodecByType("video/3gpp", false));
+    EXPECT_EQ(1, cached->findCodecByName("OMX.test.mpeg4.decoder"));
+    EXPECT_TRUE(cached->codecHasQuirk(2, "requires-allocate-on-input-ports"));
+
+    destroy(cached);
+    destroy(parsed);
+}
+
+TEST_F(MediaCodecListTest, IgnoresStaleCache) {
+    MediaCodecList *parsed = create();
+    ASSERT_EQ((status_t)OK, initCheck(parsed));
+    addCaps(parsed, "OMX.test.avc.decoder/video/avc");
+    destroy(parsed);
+
+    // A different size makes the stamp differ within the same second.
+    AString xml(kXml);
+    xml.append("\n");
+    writeXml(xml.c_str());
+
+    MediaCodecList *reparsed = create();
+    ASSERT_EQ((status_t)OK, initCheck(reparsed));
+    EXPECT_FALSE(hasCaps(reparsed, "OMX.test.avc.decoder/video/avc"));
+    EXPECT_EQ(1, reparsed->findCodecByName("OMX.test.mpeg4.decoder"));
+    destroy(reparsed);
+}
+
+TEST_F(MediaCodecListTest, IgnoresTruncatedCache) {
+    MediaCodecList *parsed = create();
+    ASSERT_EQ((status_t)OK, initCheck(parsed));
+    addCaps(parsed, "OMX.test.avc.decoder/video/avc");
+    destroy(parsed);
+
+    ASSERT_EQ(0, truncate(kCacheFile, 64));
+
+    MediaCodecList *reparsed = create();
+    ASSERT_EQ((status_t)OK, initCheck(reparsed));
+    EXPECT_FALSE(hasCaps(reparsed, "OMX.test.avc.decoder/video/avc"));
+    EXPECT_EQ(0, reparsed->findCodecByType("video/avc", false));
+    destroy(reparsed);
+}
+
+}  // namespace android
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OMXBufferRing_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <binder/IMemory.h>
+#include <media/OMXBufferRing.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+static OMXBufferRing::Request makeRequest(int32_t i) {
+    OMXBufferRing::Request request;
+    request.type = (i & 1)
+        ? OMXBufferRing::Request::FILL_BUFFER
+        : OMXBufferRing::Request::EMPTY_BUFFER;
+    request.buffer = (IOMX::buffer_id)(intptr_t)(i + 1);
+    request.range_offset = i;
+    request.range_length = 2 * i;
+    request.flags = 0;
+    request.timestamp = 1000ll * i;
+    return request;
+}
+
+static omx_message makeMessage(int32_t i) {
+    omx_message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = omx_message::FILL_BUFFER_DONE;
+    msg.node = (IOMX::node_id)1;
+    msg.u.extended_buffer_data.buffer = (IOMX::buffer_id)(intptr_t)(i + 1);
+    msg.u.extended_buffer_data.range_length = i;
+    msg.u.extended_buffer_data.timestamp = 1000ll * i;
+    return msg;
+}
+
+// What the node sees of a ring the client made.
+static sp<OMXBufferRing> attach(const sp<OMXBufferRing> &ring) {
+    return new OMXBufferRing(
+            ring->memory(), dup(ring->requestFd()), dup(ring->messageFd()));
+}
+
+TEST(OMXBufferRingTest, CarriesRequestsAndMessagesInOrder) {
+    sp<OMXBufferRing> client = OMXBufferRing::Create();
+    ASSERT_TRUE(client != NULL);
+    sp<OMXBufferRing> node = attach(client);
+    ASSERT_EQ((status_t)OK, node->initCheck());
+
+    // More than fit at once, so that the indices wrap around.
+    for (int32_t round = 0; round < 5; ++round) {
+        for (int32_t i = 0; i < OMXBufferRing::kNumRequests; ++i) {
+            ASSERT_TRUE(client->postRequest(makeRequest(round + i)));
+        }
+        EXPECT_FALSE(client->postRequest(makeRequest(0)));
+
+        for (int32_t i = 0; i < OMXBufferRing::kNumRequests; ++i) {
+            OMXBufferRing::Request request;
+            OMXBufferRing::Request expected = makeRequest(round + i);
+            ASSERT_TRUE(node->readRequest(&request));
+            EXPECT_EQ(expected.type, request.type);
+            EXPECT_EQ(expected.buffer, request.buffer);
+            EXPECT_EQ(expected.range_offset, request.range_offset);
+            EXPECT_EQ(expected.range_length, request.range_length);
+            EXPECT_EQ(expected.timestamp, request.timestamp);
+        }
+
+        OMXBufferRing::Request request;
+        EXPECT_FALSE(node->readRequest(&request));
+    }
+
+    for (int32_t round = 0; round < 5; ++round) {
+        for (int32_t i = 0; i < OMXBufferRing::kNumMessages; ++i) {
+            ASSERT_TRUE(node->postMessage(makeMessage(round + i)));
+        }
+        EXPECT_FALSE(node->postMessage(makeMessage(0)));
+
+        for (int32_t i = 0; i < OMXBufferRing::kNumMessages; ++i) {
+            omx_message msg;
+            omx_message expected = makeMessage(round + i);
+            ASSERT_TRUE(client->readMessage(&msg));
+            EXPECT_EQ(0, memcmp(&msg, &expected, sizeof(msg)));
+        }
+
+        omx_message msg;
+        EXPECT_FALSE(client->readMessage(&msg));
+    }
+}
+
+TEST(OMXBufferRingTest, SignalsWakeTheReader) {
+    sp<OMXBufferRing> client = OMXBufferRing::Create();
+    ASSERT_TRUE(client != NULL);
+    sp<OMXBufferRing> node = attach(client);
+
+    // Signals add up until the reader waits, one wait takes them all.
+    client->postRequest(makeRequest(0));
+    client->signalRequests();
+    client->postRequest(makeRequest(1));
+    client->signalRequests();
+    EXPECT_EQ((status_t)OK, node->waitForRequests());
+
+    OMXBufferRing::Request request;
+    EXPECT_TRUE(node->readRequest(&request));
+    EXPECT_TRUE(node->readRequest(&request));
+    EXPECT_FALSE(node->readRequest(&request));
+
+    node->signalMessages();
+    EXPECT_EQ((status_t)OK, client->waitForMessages());
+}
+
+// Whatever the other process writes to the indices, the reader stays
+// within the queue.
+TEST(OMXBufferRingTest, RejectsCorruptIndices) {
+    sp<OMXBufferRing> client = OMXBufferRing::Create();
+    ASSERT_TRUE(client != NULL);
+
+    // The request queue's indices come first in the shared memory.
+    volatile int32_t *indices = (volatile int32_t *)client->memory()->pointer();
+    indices[1] = indices[0] + OMXBufferRing::kNumRequests + 1;
+
+    OMXBufferRing::Request request;
+    EXPECT_FALSE(client->readRequest(&request));
+}
+
+// Not a pass/fail test: a node in another process returns each request as
+// a message, and the client queues one request per frame at 60 frames/sec,
+// the way a decoder is fed during playback. Prints the round trip times.
+TEST(OMXBufferRingTest, RoundTripLatencyAt60Fps) {
+    static const int kNumFrames = 300;
+    static const nsecs_t kFrameDurationNs = 1000000000ll / 60;
+
+    sp<OMXBufferRing> client = OMXBufferRing::Create();
+    ASSERT_TRUE(client != NULL);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        for (int i = 0; i < kNumFrames;) {
+            if (client->waitForRequests() != OK) {
+                _exit(1);
+            }
+            OMXBufferRing::Request request;
+            while (client->readRequest(&request)) {
+                client->postMessage(makeMessage(request.range_offset));
+                ++i;
+            }
+            client->signalMessages();
+        }
+        _exit(0);
+    }
+
+    Vector<nsecs_t> latencies;
+    nsecs_t nextFrameNs = systemTime();
+    for (int i = 0; i < kNumFrames; ++i) {
+        nextFrameNs += kFrameDurationNs;
+        nsecs_t nowNs = systemTime();
+        if (nextFrameNs > nowNs) {
+            usleep((nextFrameNs - nowNs) / 1000);
+        }
+
+        nsecs_t startNs = systemTime();
+        ASSERT_TRUE(client->postRequest(makeRequest(i)));
+        client->signalRequests();
+
+        omx_message msg;
+        while (!client->readMessage(&msg)) {
+            ASSERT_EQ((status_t)OK, client->waitForMessages());
+        }
+        latencies.push(systemTime() - startNs);
+        EXPECT_EQ((OMX_U32)i, msg.u.extended_buffer_data.range_length);
+    }
+
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    nsecs_t *begin = latencies.editArray();
+    nsecs_t *end = begin + latencies.size();
+    std::sort(begin, end);
+    printf("round trip (us): p50 %lld p90 %lld p99 %lld max %lld\n",
+           (long long)begin[latencies.size() / 2] / 1000,
+           (long long)begin[latencies.size() * 9 / 10] / 1000,
+           (long long)begin[latencies.size() * 99 / 100] / 1000,
+           (long long)end[-1] / 1000);
+}
+
+}  // namespace android
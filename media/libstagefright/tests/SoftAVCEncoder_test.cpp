@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SoftAVCEncoder_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <binder/ProcessState.h>
+#include <cutils/properties.h>
+#include <media/stagefright/foundation/ABase.h>
+#include <media/stagefright/MediaBuffer.h>
+#include <media/stagefright/MediaBufferGroup.h>
+#include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/MediaErrors.h>
+#include <media/stagefright/MediaSource.h>
+#include <media/stagefright/MetaData.h>
+#include <media/stagefright/OMXClient.h>
+#include <media/stagefright/OMXCodec.h>
+#include <utils/Timers.h>
+
+#include <OMX_Video.h>
+
+namespace android {
+
+static const int kWidth = 640;
+static const int kHeight = 480;
+static const int kFrameRate = 30;
+static const int kNumFrames = 60;
+
+// A moving pattern, so that every frame has something to encode.
+struct PatternSource : public MediaSource {
+    PatternSource(int numFrames)
+        : mMaxNumFrames(numFrames),
+          mSize((kWidth * kHeight * 3) / 2),
+          mNumFramesOutput(0) {
+        mGroup.add_buffer(new MediaBuffer(mSize));
+    }
+
+    virtual sp<MetaData> getFormat() {
+        sp<MetaData> meta = new MetaData;
+        meta->setInt32(kKeyWidth, kWidth);
+        meta->setInt32(kKeyHeight, kHeight);
+        meta->setInt32(kKeyColorFormat, OMX_COLOR_FormatYUV420Planar);
+        meta->setCString(kKeyMIMEType, MEDIA_MIMETYPE_VIDEO_RAW);
+        return meta;
+    }
+
+    virtual status_t start(MetaData *params) {
+        mNumFramesOutput = 0;
+        return OK;
+    }
+
+    virtual status_t stop() {
+        return OK;
+    }
+
+    virtual status_t read(
+            MediaBuffer **buffer, const MediaSource::ReadOptions *options) {
+        if (mNumFramesOutput == mMaxNumFrames) {
+            return ERROR_END_OF_STREAM;
+        }
+
+        status_t err = mGroup.acquire_buffer(buffer);
+        if (err != OK) {
+            return err;
+        }
+
+        uint8_t *data = (uint8_t *)(*buffer)->data();
+        int shift = mNumFramesOutput * 3;
+        for (int y = 0; y < kHeight; ++y) {
+            for (int x = 0; x < kWidth; ++x) {
+                data[y * kWidth + x] =
+                    (uint8_t)(((x + shift) * (y + 1)) / 7 ^ (y * 5));
+            }
+        }
+        memset(&data[kWidth * kHeight], 128, kWidth * kHeight / 2);
+
+        (*buffer)->set_range(0, mSize);
+        (*buffer)->meta_data()->clear();
+        (*buffer)->meta_data()->setInt64(
+                kKeyTime, (mNumFramesOutput * 1000000ll) / kFrameRate);
+        ++mNumFramesOutput;
+
+        return OK;
+    }
+
+protected:
+    virtual ~PatternSource() {}
+
+private:
+    MediaBufferGroup mGroup;
+    int mMaxNumFrames;
+    size_t mSize;
+    int mNumFramesOutput;
+
+    DISALLOW_EVIL_CONSTRUCTORS(PatternSource);
+};
+
+struct SoftAVCEncoderTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        ProcessState::self()->startThreadPool();
+        ASSERT_EQ((status_t)OK, mClient.connect());
+    }
+
+    virtual void TearDown() {
+        property_set("media.stagefright.avcenc.slices", "");
+        mClient.disconnect();
+    }
+
+    sp<MediaSource> createEncoder(int numSlices, int numFrames) {
+        char value[PROPERTY_VALUE_MAX];
+        snprintf(value, sizeof(value), "%d", numSlices);
+        property_set("media.stagefright.avcenc.slices", value);
+
+        sp<MetaData> meta = new MetaData;
+        meta->setCString(kKeyMIMEType, MEDIA_MIMETYPE_VIDEO_AVC);
+        meta->setInt32(kKeyWidth, kWidth);
+        meta->setInt32(kKeyHeight, kHeight);
+        meta->setInt32(kKeyFrameRate, kFrameRate);
+        meta->setInt32(kKeyBitRate, 2000000);
+        meta->setInt32(kKeyStride, kWidth);
+        meta->setInt32(kKeySliceHeight, kHeight);
+        meta->setInt32(kKeyIFramesInterval, 1);
+        meta->setInt32(kKeyColorFormat, OMX_COLOR_FormatYUV420Planar);
+
+        return OMXCodec::Create(
+                mClient.interface(), meta, true /* createEncoder */,
+                new PatternSource(numFrames), "OMX.google.h264.encoder");
+    }
+
+    OMXClient mClient;
+};
+
+// Counts the slices in an output buffer, which must be NAL units each
+// after a 4-byte start code. Returns -1 if the buffer is not like that.
+static int countSlices(const uint8_t *data, size_t size) {
+    if (size < 5 || memcmp(data, "\x00\x00\x00\x01", 4)) {
+        return -1;
+    }
+
+    int numSlices = 0;
+    for (size_t i = 0; i + 4 < size; ++i) {
+        if (!memcmp(&data[i], "\x00\x00\x00\x01", 4)) {
+            unsigned nalType = data[i + 4] & 0x1f;
+            if (nalType == 1 || nalType == 5) {
+                ++numSlices;
+            }
+        }
+    }
+    return numSlices;
+}
+
+// Every picture comes out in the same format whether it has one slice
+// or several: all of its slices, each after a start code.
+TEST_F(SoftAVCEncoderTest, StartCodeBeforeEverySlice) {
+    const int sliceCounts[] = { 1, 4 };
+
+    for (size_t i = 0; i < sizeof(sliceCounts) / sizeof(sliceCounts[0]); ++i) {
+        SCOPED_TRACE(testing::Message() << sliceCounts[i] << " slice(s)");
+
+        sp<MediaSource> encoder = createEncoder(sliceCounts[i], 10);
+        ASSERT_TRUE(encoder != NULL);
+        ASSERT_EQ((status_t)OK, encoder->start());
+
+        int numPictures = 0;
+        MediaBuffer *buffer;
+        while (encoder->read(&buffer) == OK) {
+            int32_t isCodecConfig;
+            if (!buffer->meta_data()->findInt32(kKeyIsCodecConfig, &isCodecConfig)
+                    || !isCodecConfig) {
+                EXPECT_EQ(sliceCounts[i], countSlices(
+                        (const uint8_t *)buffer->data() + buffer->range_offset(),
+                        buffer->range_length()));
+                ++numPictures;
+            }
+            buffer->release();
+        }
+        // Rate control may skip a picture, never all of them.
+        EXPECT_GT(numPictures, 0);
+
+        EXPECT_EQ((status_t)OK, encoder->stop());
+    }
+}
+
+// Not a pass/fail test: prints how long a frame takes with one slice
+// and with one slice per worker thread.
+TEST_F(SoftAVCEncoderTest, EncodeTime) {
+    const int sliceCounts[] = { 1, 2, 4 };
+
+    for (size_t i = 0; i < sizeof(sliceCounts) / sizeof(sliceCounts[0]); ++i) {
+        sp<MediaSource> encoder = createEncoder(sliceCounts[i], kNumFrames);
+        ASSERT_TRUE(encoder != NULL);
+        ASSERT_EQ((status_t)OK, encoder->start());
+
+        int64_t startUs = systemTime() / 1000;
+        size_t numBytes = 0;
+        MediaBuffer *buffer;
+        while (encoder->read(&buffer) == OK) {
+            numBytes += buffer->range_length();
+            buffer->release();
+        }
+        int64_t elapsedUs = systemTime() / 1000 - startUs;
+
+        EXPECT_EQ((status_t)OK, encoder->stop());
+
+        printf("%d slice(s): %.2f ms/frame, %zu bytes\n",
+               sliceCounts[i], elapsedUs / 1000.0 / kNumFrames, numBytes);
+    }
+}
+
+}  // namespace android
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "StagefrightMediaScanner_test"
+#include <utils/Log.h>
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <media/mediascanner.h>
+#include <media/stagefright/MediaDefs.h>
+#include <media/stagefright/StagefrightMediaScanner.h>
+#include <utils/KeyedVector.h>
+#include <utils/String8.h>
+
+namespace android {
+
+static const char *kWavFile = "/data/local/tmp/StagefrightMediaScanner_test.wav";
+static const char *kMp3File = "/data/local/tmp/StagefrightMediaScanner_test.mp3";
+
+// Records what the scanner reports.
+struct TagClient : public MediaScannerClient {
+    virtual status_t scanFile(const char *path, long long lastModified,
+            long long fileSize, bool isDirectory, bool noMedia) {
+        return OK;
+    }
+
+    virtual status_t handleStringTag(const char *name, const char *value) {
+        mTags.add(String8(name), String8(value));
+        return OK;
+    }
+
+    virtual status_t setMimeType(const char *mimeType) {
+        mMimeType.setTo(mimeType);
+        return OK;
+    }
+
+    String8 mMimeType;
+    KeyedVector<String8, String8> mTags;
+};
+
+// Tells whether the scanner had to go through the media server.
+struct TestScanner : public StagefrightMediaScanner {
+    TestScanner()
+        : mUsedRetriever(false) {
+    }
+
+    bool mUsedRetriever;
+
+protected:
+    virtual MediaScanResult processFileWithRetriever(
+            const char *path, MediaScannerClient &client) {
+        mUsedRetriever = true;
+        return MEDIA_SCAN_RESULT_SKIPPED;
+    }
+};
+
+static void writeLE(FILE *file, uint32_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        fputc((value >> (8 * i)) & 0xff, file);
+    }
+}
+
+// One second of 8 kHz mono 16 bit silence.
+static void writeWav(const char *path) {
+    static const uint32_t kDataSize = 8000 * 2;
+
+    FILE *file = fopen(path, "w");
+    ASSERT_TRUE(file != NULL);
+
+    fputs("RIFF", file);
+    writeLE(file, 4 + 8 + 16 + 8 + kDataSize, 4);
+    fputs("WAVE", file);
+
+    fputs("fmt ", file);
+    writeLE(file, 16, 4);
+    writeLE(file, 1, 2);            // PCM
+    writeLE(file, 1, 2);            // channels
+    writeLE(file, 8000, 4);         // sample rate
+    writeLE(file, 8000 * 2, 4);     // byte rate
+    writeLE(file, 2, 2);            // block align
+    writeLE(file, 16, 2);           // bits per sample
+
+    fputs("data", file);
+    writeLE(file, kDataSize, 4);
+    for (size_t i = 0; i < kDataSize; ++i) {
+        fputc(0, file);
+    }
+
+    fclose(file);
+}
+
+struct StagefrightMediaScannerTest : public ::testing::Test {
+protected:
+    virtual void TearDown() {
+        unlink(kWavFile);
+        unlink(kMp3File);
+    }
+};
+
+// The constructor registers the sniffers, so a container the extractors
+// know is described without a MediaMetadataRetriever.
+TEST_F(StagefrightMediaScannerTest, ReadsContainerMetadataInProcess) {
+    writeWav(kWavFile);
+
+    TestScanner scanner;
+    TagClient client;
+    EXPECT_EQ(MEDIA_SCAN_RESULT_OK,
+              scanner.processFile(kWavFile, NULL, client));
+    EXPECT_FALSE(scanner.mUsedRetriever);
+
+    EXPECT_STREQ(MEDIA_MIMETYPE_CONTAINER_WAV, client.mMimeType.string());
+    ASSERT_GE(client.mTags.indexOfKey(String8("duration")), 0);
+    EXPECT_STREQ("1000", client.mTags.valueFor(String8("duration")).string());
+}
+
+// Files no extractor recognizes still go to the retriever.
+TEST_F(StagefrightMediaScannerTest, FallsBackToRetriever) {
+    FILE *file = fopen(kMp3File, "w");
+    ASSERT_TRUE(file != NULL);
+    fputs("not an mp3 file", file);
+    fclose(file);
+
+    TestScanner scanner;
+    TagClient client;
+    scanner.processFile(kMp3File, NULL, client);
+    EXPECT_TRUE(scanner.mUsedRetriever);
+}
+
+}  // namespace android
@@ -47,6 +47,7 @@ LOCAL_SRC_FILES:=               \
     AudioResampler.cpp.arm      \
     AudioPolicyService.cpp      \
     ServiceUtilities.cpp        \
+    TimingHistogram.cpp         \
     AudioResamplerCubic.cpp.arm \
     AudioResamplerSinc.cpp.arm
 
@@ -143,4 +144,45 @@ LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_EXECUTABLE)
 
+#
+# build control block proxy benchmark
+#
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:=               \
+    test-track-proxy.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+    libcutils \
+    libutils \
+    liblog \
+    libmedia
+
+LOCAL_MODULE:= test-track-proxy
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+#
+# build end to end latency benchmark, see audio-hal-stub
+#
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:=               \
+    test-audio-latency.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+    libcutils \
+    libutils \
+    liblog \
+    libbinder \
+    libmedia
+
+LOCAL_MODULE:= test-audio-latency
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
 include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -129,6 +129,9 @@ class AudioFlinger :
 public:
     static const char* getServiceName() { return "media.audio_flinger"; }
 
+    // from the last "screen_state" parameter, read without lock
+    static bool             isScreenOff() { return mScreenState & 1; }
+
     virtual     status_t    dump(int fd, const Vector<String16>& args);
 
     // IAudioFlinger interface, in binder opcode order
@@ -29,6 +29,7 @@
 #include <binder/IPCThreadState.h>
 #include <utils/String16.h>
 #include <utils/threads.h>
+#include "AudioFlinger.h"
 #include "AudioPolicyService.h"
 #include "ServiceUtilities.h"
 #include <hardware_legacy/power.h>
@@ -216,6 +217,22 @@ audio_policy_forced_cfg_t AudioPolicyService::getForceUse(audio_policy_force_use
     return mpAudioPolicy->get_force_use(mpAudioPolicy, usage);
 }
 
+// While the screen is off nobody is waiting on the latency of music, so linear PCM music goes to
+// the deep buffer output even if the player did not ask for it. Flags the caller set are kept.
+static audio_output_flags_t routeOutputFlags(audio_stream_type_t stream,
+                                             audio_format_t format,
+                                             audio_output_flags_t flags)
+{
+    if (stream != AUDIO_STREAM_MUSIC || !audio_is_linear_pcm(format) ||
+            (flags & (AUDIO_OUTPUT_FLAG_DIRECT | AUDIO_OUTPUT_FLAG_FAST))) {
+        return flags;
+    }
+    if (AudioFlinger::isScreenOff()) {
+        return (audio_output_flags_t)(flags | AUDIO_OUTPUT_FLAG_DEEP_BUFFER);
+    }
+    return flags;
+}
+
 audio_io_handle_t AudioPolicyService::getOutput(audio_stream_type_t stream,
                                     uint32_t samplingRate,
                                     audio_format_t format,
@@ -227,8 +244,17 @@ audio_io_handle_t AudioPolicyService::getOutput(audio_stream_type_t stream,
     }
     ALOGV("getOutput()");
     Mutex::Autolock _l(mLock);
-    return mpAudioPolicy->get_output(mpAudioPolicy, stream, samplingRate, format, channelMask,
-                                        flags);
+    audio_output_flags_t routedFlags = routeOutputFlags(stream, format, flags);
+    audio_io_handle_t output = mpAudioPolicy->get_output(mpAudioPolicy, stream, samplingRate,
+                                                         format, channelMask, routedFlags);
+    if (output == 0 && routedFlags != flags) {
+        // the policy has no output for the routed flags, e.g. no deep buffer output on this
+        // platform: give the caller what it asked for
+        ALOGV("getOutput() no output for flags %#x, falling back to %#x", routedFlags, flags);
+        output = mpAudioPolicy->get_output(mpAudioPolicy, stream, samplingRate, format,
+                                           channelMask, flags);
+    }
+    return output;
 }
 
 status_t AudioPolicyService::startOutput(audio_io_handle_t output,
@@ -78,9 +78,9 @@ bool FastMixer::threadLoop()
     long warmupNs = 0;      // warmup complete when write cycle is greater than to this value
     FastMixerDumpState dummyDumpState, *dumpState = &dummyDumpState;
     bool ignoreNextOverrun = true;  // used to ignore initial overrun and first after an underrun
-#ifdef FAST_MIXER_STATISTICS
     struct timespec oldLoad = {0, 0};    // previous value of clock_gettime(CLOCK_THREAD_CPUTIME_ID)
     bool oldLoadValid = false;  // whether oldLoad is valid
+#ifdef FAST_MIXER_STATISTICS
     uint32_t bounds = 0;
     bool full = false;      // whether we have collected at least kSamplingN samples
 #ifdef CPU_FREQUENCY_STATISTICS
@@ -242,6 +242,10 @@ bool FastMixer::threadLoop()
                     overrunNs = (frameCount * 500000000LL) / sampleRate;    // 0.50
                     forceNs = (frameCount * 950000000LL) / sampleRate;      // 0.95
                     warmupNs = (frameCount * 500000000LL) / sampleRate;     // 0.50
+                    dumpState->mCycleHistogram.reset();
+                    dumpState->mLoadHistogram.reset();
+                    dumpState->mJitterHistogram.reset();
+                    dumpState->mUnderrunHistogram.reset();
                 } else {
                     periodNs = 0;
                     underrunNs = 0;
@@ -505,6 +509,7 @@ bool FastMixer::threadLoop()
                     ALOGV("underrun: time since last cycle %d.%03ld sec",
                             (int) sec, nsec / 1000000L);
                     dumpState->mUnderruns++;
+                    dumpState->mUnderrunHistogram.record(sec * 1000000000LL + nsec - periodNs);
                     ignoreNextOverrun = true;
                 } else if (nsec < overrunNs) {
                     if (ignoreNextOverrun) {
@@ -526,23 +531,16 @@ bool FastMixer::threadLoop()
                     ignoreNextOverrun = false;
                 }
               }
-#ifdef FAST_MIXER_STATISTICS
               if (isWarm) {
-                // advance the FIFO queue bounds
-                size_t i = bounds & (FastMixerDumpState::kSamplingN - 1);
-                bounds = (bounds & 0xFFFF0000) | ((bounds + 1) & 0xFFFF);
-                if (full) {
-                    bounds += 0x10000;
-                } else if (!(bounds & (FastMixerDumpState::kSamplingN - 1))) {
-                    full = true;
-                }
                 // compute the delta value of clock_gettime(CLOCK_MONOTONIC)
+                int64_t cycleNs = sec * 1000000000LL + nsec;
                 uint32_t monotonicNs = nsec;
                 if (sec > 0 && sec < 4) {
                     monotonicNs += sec * 1000000000;
                 }
                 // compute the raw CPU load = delta value of clock_gettime(CLOCK_THREAD_CPUTIME_ID)
                 uint32_t loadNs = 0;
+                bool loadValid = false;
                 struct timespec newLoad;
                 rc = clock_gettime(CLOCK_THREAD_CPUTIME_ID, &newLoad);
                 if (rc == 0) {
@@ -557,12 +555,28 @@ bool FastMixer::threadLoop()
                         if (sec > 0 && sec < 4) {
                             loadNs += sec * 1000000000;
                         }
+                        loadValid = true;
                     } else {
                         // first time through the loop
                         oldLoadValid = true;
                     }
                     oldLoad = newLoad;
                 }
+                dumpState->mCycleHistogram.record(cycleNs);
+                if (loadValid) {
+                    dumpState->mLoadHistogram.record(loadNs);
+                }
+                dumpState->mJitterHistogram.record(
+                        cycleNs > periodNs ? cycleNs - periodNs : periodNs - cycleNs);
+#ifdef FAST_MIXER_STATISTICS
+                // advance the FIFO queue bounds
+                size_t i = bounds & (FastMixerDumpState::kSamplingN - 1);
+                bounds = (bounds & 0xFFFF0000) | ((bounds + 1) & 0xFFFF);
+                if (full) {
+                    bounds += 0x10000;
+                } else if (!(bounds & (FastMixerDumpState::kSamplingN - 1))) {
+                    full = true;
+                }
 #ifdef CPU_FREQUENCY_STATISTICS
                 // get the absolute value of CPU clock frequency in kHz
                 int cpuNum = sched_getcpu();
@@ -582,8 +596,8 @@ bool FastMixer::threadLoop()
                 dumpState->mBounds = bounds;
                 ATRACE_INT("cycle_ms", monotonicNs / 1000000);
                 ATRACE_INT("load_us", loadNs / 1000);
-              }
 #endif
+              }
             } else {
                 // first time through the loop
                 oldTsValid = true;
@@ -686,6 +700,16 @@ void FastMixerDumpState::dump(int fd)
                  mNumTracks, mWriteErrors, mUnderruns, mOverruns,
                  mSampleRate, mFrameCount, measuredWarmupMs, mWarmupCycles,
                  mixPeriodSec * 1e3);
+    char summary[128];
+    fdprintf(fd, "Histograms since the mix period was configured:\n");
+    mCycleHistogram.summarize(summary, sizeof(summary));
+    fdprintf(fd, "  wall clock time per mix cycle: %s\n", summary);
+    mLoadHistogram.summarize(summary, sizeof(summary));
+    fdprintf(fd, "  raw CPU load per mix cycle: %s\n", summary);
+    mJitterHistogram.summarize(summary, sizeof(summary));
+    fdprintf(fd, "  jitter of the mix cycle: %s\n", summary);
+    mUnderrunHistogram.summarize(summary, sizeof(summary));
+    fdprintf(fd, "  mix cycle beyond the mix period, per underrun: %s\n", summary);
 #ifdef FAST_MIXER_STATISTICS
     // find the interval of valid samples
     uint32_t bounds = mBounds;
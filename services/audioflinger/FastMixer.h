@@ -24,6 +24,7 @@ extern "C" {
 }
 #include "StateQueue.h"
 #include "FastMixerState.h"
+#include "TimingHistogram.h"
 
 namespace android {
 
@@ -104,6 +105,12 @@ struct FastMixerDumpState {
     uint32_t mTrackMask;        // mask of active tracks
     FastTrackDump   mTracks[FastMixerState::kMaxFastTracks];
 
+    // Always collected once warm, since the mix period was last configured.
+    TimingHistogram mCycleHistogram;    // wall clock time per mix cycle
+    TimingHistogram mLoadHistogram;     // thread CPU time per mix cycle
+    TimingHistogram mJitterHistogram;   // difference between the cycle time and the mix period
+    TimingHistogram mUnderrunHistogram; // for each underrun, how much longer than the mix period
+
 #ifdef FAST_MIXER_STATISTICS
     // Recently collected samples of per-cycle monotonic time, thread CPU time, and CPU frequency.
     // kSamplingN is the size of the sampling frame, and must be a power of 2 <= 0x8000.
@@ -73,6 +73,7 @@
 #include "FastMixer.h"
 #include "ServiceUtilities.h"
 #include "SchedulingPolicyService.h"
+#include "TimingHistogram.h"
 
 #undef ADD_BATTERY_DATA
 
@@ -134,6 +135,18 @@ static const nsecs_t kWarningThrottleNs = seconds(5);
 // RecordThread loop sleep time upon application overrun or audio HAL read error
 static const int kRecordThreadSleepUs = 5000;
 
+// how often the timing histograms of the mixer and record threads go to media.log
+static const nsecs_t kHistogramLogPeriodNs = seconds(60);
+
+// the thread mutex must be held, as for any use of the thread's NBLog::Writer
+static void logHistogram(NBLog::Writer *writer, const char *name,
+        const TimingHistogram& histogram)
+{
+    char summary[128];
+    histogram.summarize(summary, sizeof(summary));
+    writer->logf("%s %s", name, summary);
+}
+
 // maximum time to wait for setParameters to complete
 static const nsecs_t kSetParametersTimeoutNs = seconds(2);
 
@@ -1410,6 +1423,13 @@ uint32_t AudioFlinger::PlaybackThread::correctLatency_l(uint32_t latency) const
     return latency;
 }
 
+void AudioFlinger::PlaybackThread::logHistograms_l()
+{
+    mNBLogWriter->logTimestamp();
+    logHistogram(mNBLogWriter.get(), "write", mWriteHistogram);
+    logHistogram(mNBLogWriter.get(), "write cycle", mWriteCycleHistogram);
+}
+
 uint32_t AudioFlinger::PlaybackThread::latency() const
 {
     Mutex::Autolock _l(mLock);
@@ -2034,6 +2054,7 @@ if (mType == MIXER) {
 #endif
     // MIXER
     nsecs_t lastWarning = 0;
+    nsecs_t lastWriteEnd = 0;
 
     // DUPLICATING
     // FIXME could this be made local to while loop?
@@ -2055,6 +2076,9 @@ if (mType == MIXER) {
     // So if you need to log when mutex is unlocked, set logString to a non-NULL string,
     // and then that string will be logged at the next convenient opportunity.
     const char *logString = NULL;
+    // likewise for the timing histograms of the MIXER
+    nsecs_t lastHistogramLog = systemTime();
+    bool logHistograms = false;
 
     while (!exitPending())
     {
@@ -2074,6 +2098,11 @@ if (mType == MIXER) {
                 logString = NULL;
             }
 
+            if (logHistograms) {
+                logHistograms_l();
+                logHistograms = false;
+            }
+
             if (checkForNewParameters_l()) {
                 cacheParameters_l();
             }
@@ -2196,6 +2225,15 @@ if (mType == MIXER) {
             // write blocked detection
             nsecs_t now = systemTime();
             nsecs_t delta = now - mLastWriteTime;
+            if (!mStandby) {
+                mWriteHistogram.record(delta);
+                mWriteCycleHistogram.record(now - lastWriteEnd);
+            }
+            lastWriteEnd = now;
+            if (now - lastHistogramLog >= kHistogramLogPeriodNs) {
+                lastHistogramLog = now;
+                logHistograms = true;
+            }
             if (!mStandby && delta > maxPeriod) {
                 mNumDelayedWrites++;
                 if ((now - lastWarning) > kWarningThrottleNs) {
@@ -2258,6 +2296,7 @@ AudioFlinger::MixerThread::MixerThread(const sp<AudioFlinger>& audioFlinger, Aud
         audio_io_handle_t id, audio_devices_t device, type_t type)
     :   PlaybackThread(audioFlinger, output, id, device, type),
         // mAudioMixer below
+        mDirectPcmCandidate(NULL), mNumMixes(0), mNumDirectPcmMixes(0),
         // mFastMixer below
         mFastMixerFutex(0)
         // mOutputSink below
@@ -2455,6 +2494,22 @@ uint32_t AudioFlinger::MixerThread::correctLatency_l(uint32_t latency) const
     return latency;
 }
 
+void AudioFlinger::MixerThread::logHistograms_l()
+{
+    PlaybackThread::logHistograms_l();
+    if (mFastMixer != NULL) {
+        // the fast mixer only records, as it must not format or log; see FastMixerDumpState
+        TimingHistogram histogram = mFastMixerDumpState.mCycleHistogram;
+        logHistogram(mNBLogWriter.get(), "fast cycle", histogram);
+        histogram = mFastMixerDumpState.mLoadHistogram;
+        logHistogram(mNBLogWriter.get(), "fast load", histogram);
+        histogram = mFastMixerDumpState.mJitterHistogram;
+        logHistogram(mNBLogWriter.get(), "fast jitter", histogram);
+        histogram = mFastMixerDumpState.mUnderrunHistogram;
+        logHistogram(mNBLogWriter.get(), "fast underrun", histogram);
+    }
+}
+
 void AudioFlinger::MixerThread::threadLoop_removeTracks(const Vector< sp<Track> >& tracksToRemove)
 {
     PlaybackThread::threadLoop_removeTracks(tracksToRemove);
@@ -2548,7 +2603,15 @@ void AudioFlinger::MixerThread::threadLoop_mix()
     }
 
     // mix buffers...
-    mAudioMixer->process(pts);
+    if (mDirectPcmTrack != 0) {
+        copyDirectPcm(pts);
+        mNumDirectPcmMixes++;
+        // the last reference to a track must not be dropped with the thread lock held
+        mDirectPcmTrack.clear();
+    } else {
+        mAudioMixer->process(pts);
+    }
+    mNumMixes++;
     // increase sleep time progressively when application underrun condition clears.
     // Only increase sleep time if the mixer is ready for two consecutive times to avoid
     // that a steady state of alternating ready/not ready conditions keeps the sleep time
@@ -2561,6 +2624,30 @@ void AudioFlinger::MixerThread::threadLoop_mix()
     //TODO: delay standby when effects have a tail
 }
 
+void AudioFlinger::MixerThread::copyDirectPcm(int64_t pts)
+{
+    int16_t *out = mMixBuffer;
+    size_t framesLeft = mNormalFrameCount;
+
+    while (framesLeft > 0) {
+        AudioBufferProvider::Buffer buffer;
+        buffer.frameCount = framesLeft;
+        mDirectPcmTrack->getNextBuffer(&buffer, pts);
+        if (buffer.raw == NULL) {
+            break;
+        }
+        memcpy(out, buffer.raw, buffer.frameCount * mFrameSize);
+        out += buffer.frameCount * mChannelCount;
+        framesLeft -= buffer.frameCount;
+        mDirectPcmTrack->releaseBuffer(&buffer);
+    }
+
+    // like the mixer, play silence for what the track could not provide
+    if (framesLeft > 0) {
+        memset(out, 0, framesLeft * mFrameSize);
+    }
+}
+
 void AudioFlinger::MixerThread::threadLoop_sleepTime()
 {
     // If no tracks are ready, sleep once for the duration of an output
@@ -2603,6 +2690,8 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
     // counts only _active_ fast tracks
     size_t fastTracks = 0;
     uint32_t resetMask = 0; // bit mask of fast tracks that need to be reset
+    // the ready track that could be copied rather than mixed, see copyDirectPcm()
+    sp<Track> directPcmTrack;
 
     float masterVolume = mMasterVolume;
     bool masterMute = mMasterMute;
@@ -2687,6 +2776,9 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
             // or stopped which can occur when flush() is called while active
             if (!(track->isStopping() || track->isPausing() || track->isStopped())) {
                 track->mUnderrunCount += recentUnderruns;
+                if (recentUnderruns > 0) {
+                    track->mServerProxy->setUnderrunCount(track->mUnderrunCount);
+                }
             }
 
             // This is similar to the state machine for normal tracks,
@@ -2983,6 +3075,15 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
                 AudioMixer::RESAMPLE,
                 AudioMixer::SAMPLE_RATE,
                 (void *)reqSampleRate);
+
+            if ((mOutputFlags & AUDIO_OUTPUT_FLAG_DEEP_BUFFER) && mChannelCount == FCC_2 &&
+                    chain == 0 && track->auxBuffer() == NULL && !track->isTimedTrack() &&
+                    vl == MAX_GAIN_INT && vr == MAX_GAIN_INT && va == 0 &&
+                    track->format() == AUDIO_FORMAT_PCM_16_BIT &&
+                    track->channelMask() == AUDIO_CHANNEL_OUT_STEREO &&
+                    reqSampleRate == mSampleRate) {
+                directPcmTrack = t;
+            }
             mAudioMixer->setParameter(
                 name,
                 AudioMixer::TRACK,
@@ -3028,6 +3129,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
                 }
             } else {
                 track->mUnderrunCount++;
+                track->mServerProxy->setUnderrunCount(track->mUnderrunCount);
                 // No buffers for this track. Give it a few chances to
                 // fill a buffer, then remove it from active list.
                 if (--(track->mRetryCount) <= 0) {
@@ -3130,6 +3232,14 @@ track_is_ready: ;
     if (fastTracks > 0) {
         mixerStatus = MIXER_TRACKS_READY;
     }
+
+    // Only copy a track that was already eligible during the previous round, so that the mixer
+    // has no volume ramp left to apply to it.
+    if (mixerStatus == MIXER_TRACKS_READY && mixedTracks == 1 && fastTracks == 0 &&
+            directPcmTrack != 0 && directPcmTrack.get() == mDirectPcmCandidate) {
+        mDirectPcmTrack = directPcmTrack;
+    }
+    mDirectPcmCandidate = directPcmTrack.get();
 #ifdef DOLBY_DAP_QDSP
     if (!computePreGain)
         return mixerStatus;
@@ -3335,6 +3445,18 @@ void AudioFlinger::MixerThread::dumpInternals(int fd, const Vector<String16>& ar
 
     snprintf(buffer, SIZE, "AudioMixer tracks: %08x\n", mAudioMixer->trackNames());
     result.append(buffer);
+    snprintf(buffer, SIZE, "direct PCM mixes: %u of %u\n", mNumDirectPcmMixes, mNumMixes);
+    result.append(buffer);
+    // non-atomic copies, as for the fast mixer dump state below
+    char summary[128];
+    TimingHistogram histogram = mWriteHistogram;
+    histogram.summarize(summary, sizeof(summary));
+    snprintf(buffer, SIZE, "time in write: %s\n", summary);
+    result.append(buffer);
+    histogram = mWriteCycleHistogram;
+    histogram.summarize(summary, sizeof(summary));
+    snprintf(buffer, SIZE, "time between writes: %s\n", summary);
+    result.append(buffer);
     write(fd, result.string(), result.size());
 
     // Make a non-atomic copy of fast mixer dump state so it won't change underneath us
@@ -3874,9 +3996,10 @@ AudioFlinger::RecordThread::RecordThread(const sp<AudioFlinger>& audioFlinger,
     mInput(input), mResampler(NULL), mRsmpOutBuffer(NULL), mRsmpInBuffer(NULL),
     // mRsmpInIndex and mInputBytes set by readInputParameters()
     mReqChannelCount(getInputChannelCount(channelMask)),
-    mReqSampleRate(sampleRate)
+    mReqSampleRate(sampleRate),
     // mBytesRead is only meaningful while active, and so is cleared in start()
     // (but might be better to also clear here for dump?)
+    mLastReadTime(0)
 #ifdef TEE_SINK
     , mTeeSink(teeSink)
 #endif
@@ -3914,6 +4037,7 @@ bool AudioFlinger::RecordThread::threadLoop()
     Vector< sp<EffectChain> > effectChains;
 
     nsecs_t lastWarning = 0;
+    nsecs_t lastHistogramLog = systemTime();
 
     inputStandBy();
     acquireWakeLock();
@@ -3929,6 +4053,12 @@ bool AudioFlinger::RecordThread::threadLoop()
         { // scope for mLock
             Mutex::Autolock _l(mLock);
             checkForNewParameters_l();
+            if (mLastReadTime - lastHistogramLog >= kHistogramLogPeriodNs) {
+                lastHistogramLog = mLastReadTime;
+                mNBLogWriter->logTimestamp();
+                logHistogram(mNBLogWriter.get(), "read", mReadHistogram);
+                logHistogram(mNBLogWriter.get(), "read cycle", mReadCycleHistogram);
+            }
             if (mActiveTrack == 0 && mConfigEvents.isEmpty()) {
                 standby();
 
@@ -4014,6 +4144,7 @@ bool AudioFlinger::RecordThread::threadLoop()
                         }
                         if (framesOut && mFrameCount == mRsmpInIndex) {
                             void *readInto;
+                            nsecs_t readStart = systemTime();
 #ifdef QCOM_HARDWARE
                             int InputBytes;
                             if (( framesOut != mFrameCount) &&
@@ -4051,6 +4182,7 @@ bool AudioFlinger::RecordThread::threadLoop()
                             mBytesRead = mInput->stream->read(mInput->stream, readInto,
                                     mInputBytes);
 #endif
+                            recordReadTime(readStart);
                             if (mBytesRead <= 0) {
                                 if ((mBytesRead < 0) && (mActiveTrack->mState == TrackBase::ACTIVE))
                                 {
@@ -4162,6 +4294,17 @@ void AudioFlinger::RecordThread::standby()
 void AudioFlinger::RecordThread::inputStandBy()
 {
     mInput->stream->common.standby(&mInput->stream->common);
+    mLastReadTime = 0;
+}
+
+void AudioFlinger::RecordThread::recordReadTime(nsecs_t readStart)
+{
+    nsecs_t now = systemTime();
+    mReadHistogram.record(now - readStart);
+    if (mLastReadTime != 0) {
+        mReadCycleHistogram.record(now - mLastReadTime);
+    }
+    mLastReadTime = now;
 }
 
 sp<AudioFlinger::RecordThread::RecordTrack>  AudioFlinger::RecordThread::createRecordTrack_l(
@@ -4418,6 +4561,17 @@ void AudioFlinger::RecordThread::dumpInternals(int fd, const Vector<String16>& a
         result.append("No active record client\n");
     }
 
+    // non-atomic copies, the thread updates them without a lock
+    char summary[128];
+    TimingHistogram histogram = mReadHistogram;
+    histogram.summarize(summary, sizeof(summary));
+    snprintf(buffer, SIZE, "time in read: %s\n", summary);
+    result.append(buffer);
+    histogram = mReadCycleHistogram;
+    histogram.summarize(summary, sizeof(summary));
+    snprintf(buffer, SIZE, "time between reads: %s\n", summary);
+    result.append(buffer);
+
     write(fd, result.string(), result.size());
 
     dumpBase(fd, args);
@@ -4459,7 +4613,9 @@ status_t AudioFlinger::RecordThread::getNextBuffer(AudioBufferProvider::Buffer*
     int channelCount;
 
     if (framesReady == 0) {
+        nsecs_t readStart = systemTime();
         mBytesRead = mInput->stream->read(mInput->stream, mRsmpInBuffer, mInputBytes);
+        recordReadTime(readStart);
         if (mBytesRead <= 0) {
             if ((mBytesRead < 0) && (mActiveTrack->mState == TrackBase::ACTIVE)) {
                 ALOGE("RecordThread::getNextBuffer() Error reading audio input");
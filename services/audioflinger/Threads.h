@@ -483,6 +483,9 @@ protected:
 
     virtual     uint32_t    correctLatency_l(uint32_t latency) const;
 
+    // Timing histograms to media.log, every kHistogramLogPeriodNs from threadLoop()
+    virtual     void        logHistograms_l();
+
 private:
 
     friend class AudioFlinger;      // for numerous
@@ -510,6 +513,10 @@ private:
     int                             mNumWrites;
     int                             mNumDelayedWrites;
     bool                            mInWrite;
+    // Always collected by mixer threads, see MixerThread::dumpInternals() and the media.log
+    // of the thread
+    TimingHistogram                 mWriteHistogram;    // time blocked in write()
+    TimingHistogram                 mWriteCycleHistogram;   // between ends of writes
     // cache the flags here. Based on falgs type of output(normal/direct) to be open
     // is decided  in createtrack_l()
     audio_output_flags_t            mOutputFlags;
@@ -598,9 +605,20 @@ protected:
     virtual     void        threadLoop_sleepTime();
     virtual     void        threadLoop_removeTracks(const Vector< sp<Track> >& tracksToRemove);
     virtual     uint32_t    correctLatency_l(uint32_t latency) const;
+    virtual     void        logHistograms_l();
 
                 AudioMixer* mAudioMixer;    // normal mixer
 private:
+                // Direct PCM: on a deep buffer output, a lone track that needs neither resampling,
+                // gain nor effects is copied into the mix buffer instead of going through the
+                // AudioMixer. Set by prepareTracks_l(), used and cleared by threadLoop_mix().
+                void        copyDirectPcm(int64_t pts);
+                sp<Track>   mDirectPcmTrack;
+                // the track that was eligible during the previous round, never dereferenced
+                const Track* mDirectPcmCandidate;
+                uint32_t    mNumMixes;
+                uint32_t    mNumDirectPcmMixes;
+
                 // one-time initialization, no locks required
                 FastMixer*  mFastMixer;         // non-NULL if there is also a fast mixer
                 sp<AudioWatchdog> mAudioWatchdog; // non-0 if there is an audio watchdog thread
@@ -792,6 +810,9 @@ private:
             // Call the HAL standby method unconditionally, and don't change mStandby flag
             void inputStandBy();
 
+            // Record the time of a read() from the HAL that started at readStart
+            void recordReadTime(nsecs_t readStart);
+
             AudioStreamIn                       *mInput;
             SortedVector < sp<RecordTrack> >    mTracks;
             // mActiveTrack has dual roles:  it indicates the current active track, and
@@ -806,6 +827,10 @@ private:
             const uint32_t                      mReqChannelCount;
             const uint32_t                      mReqSampleRate;
             ssize_t                             mBytesRead;
+            // Always collected, see dumpInternals() and the media.log of the thread
+            TimingHistogram                     mReadHistogram;     // time blocked in read()
+            TimingHistogram                     mReadCycleHistogram; // between ends of reads
+            nsecs_t                             mLastReadTime;      // 0 after standby
             // sync event triggering actual audio capture. Frames read before this event will
             // be dropped and therefore not read by the application.
             sp<SyncEvent>                       mSyncStartEvent;
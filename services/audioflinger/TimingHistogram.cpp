@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "TimingHistogram.h"
+
+namespace android {
+
+void TimingHistogram::reset()
+{
+    memset(mCounts, 0, sizeof(mCounts));
+    mCount = 0;
+    mMaxUs = 0;
+}
+
+// static
+uint32_t TimingHistogram::bucketEnd(uint32_t index)
+{
+    if (index < kSubBuckets) {
+        return index;
+    }
+    uint32_t shift = index / kSubBuckets - 1;
+    uint32_t start = (kSubBuckets + index % kSubBuckets) << shift;
+    return start + (1 << shift) - 1;
+}
+
+uint32_t TimingHistogram::percentile(double fraction) const
+{
+    // the counts may be updated while we read them: use their own total
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < kNumBuckets; ++i) {
+        total += mCounts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) (fraction * total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kNumBuckets; ++i) {
+        seen += mCounts[i];
+        if (seen >= rank) {
+            uint32_t end = bucketEnd(i);
+            return end < mMaxUs ? end : mMaxUs;
+        }
+    }
+    return mMaxUs;
+}
+
+void TimingHistogram::summarize(char *buffer, size_t size) const
+{
+    snprintf(buffer, size, "n=%u p50=%u p90=%u p99=%u p99.9=%u max=%u us",
+            mCount, percentile(0.5), percentile(0.9), percentile(0.99), percentile(0.999),
+            mMaxUs);
+}
+
+}   // namespace android
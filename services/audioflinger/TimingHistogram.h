@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_TIMING_HISTOGRAM_H
+#define ANDROID_AUDIO_TIMING_HISTOGRAM_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace android {
+
+// A histogram of durations, cheap enough to be recorded on every cycle of the audio threads
+// for as long as they run, so that percentiles and not only averages are available from a
+// production device. Recording is a few shifts and an increment: no lock, allocation or system
+// call, and so it can be done from the fast mixer.
+//
+// The buckets are those of an HDR histogram with one significant hex digit: one per
+// microsecond below 16 us, then each power of 2 is split into 16 buckets, so a percentile is
+// reported within 1/16 of its value. Values of kMaxUs and above count in the last bucket.
+//
+// Like FastMixerDumpState, it is written by one thread and read by others without a lock or
+// barrier. Readers should take a copy, which may be slightly inconsistent.
+struct TimingHistogram {
+    static const uint32_t kSubBucketBits = 4;
+    static const uint32_t kSubBuckets = 1 << kSubBucketBits;
+    static const uint32_t kMaxBits = 22;
+    static const uint32_t kMaxUs = (1 << kMaxBits) - 1;     // ~4.2 s
+    static const uint32_t kNumBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    TimingHistogram() { reset(); }
+
+    void reset();
+
+    void record(int64_t ns) {
+        uint32_t us = ns <= 0 ? 0 : ns >= (int64_t) kMaxUs * 1000 ? kMaxUs : (uint32_t) (ns / 1000);
+        mCounts[bucket(us)]++;
+        mCount++;
+        if (us > mMaxUs) {
+            mMaxUs = us;
+        }
+    }
+
+    uint32_t count() const { return mCount; }
+
+    // The value in microseconds that fraction (0 to 1) of the samples are below, rounded up
+    // to the end of its bucket. 0 if there are no samples.
+    uint32_t percentile(double fraction) const;
+
+    // Writes "n=<count> p50=<us> p90=<us> p99=<us> p99.9=<us> max=<us> us" to buffer.
+    void summarize(char *buffer, size_t size) const;
+
+    uint32_t mCounts[kNumBuckets];
+    uint32_t mCount;
+    uint32_t mMaxUs;
+
+private:
+    static uint32_t bucket(uint32_t us) {
+        if (us < kSubBuckets) {
+            return us;
+        }
+        uint32_t shift = (31 - __builtin_clz(us)) - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + (us >> shift) - kSubBuckets;
+    }
+
+    static uint32_t bucketEnd(uint32_t index);
+};
+
+}   // namespace android
+
+#endif  // ANDROID_AUDIO_TIMING_HISTOGRAM_H
@@ -0,0 +1,18 @@
+LOCAL_PATH := $(call my-dir)
+
+# Stub audio HAL for measuring AudioFlinger latency without hardware,
+# see audio_hw.c
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := audio.stub.default
+LOCAL_MODULE_PATH := $(TARGET_OUT_SHARED_LIBRARIES)/hw
+
+LOCAL_SRC_FILES := \
+    audio_hw.c
+
+LOCAL_SHARED_LIBRARIES := liblog libcutils
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_SHARED_LIBRARY)
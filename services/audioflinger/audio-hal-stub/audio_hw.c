@@ -0,0 +1,941 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* An audio HAL without hardware, for measuring AudioFlinger itself.
+ *
+ * Output streams consume data at the real rate of their sample rate, paced
+ * on CLOCK_MONOTONIC, and input streams produce it at the real rate. What
+ * the primary output plays is looped back to the inputs, in time: a read
+ * returns the frames that were playing while it was being captured, so a
+ * signal played through AudioTrack comes back in AudioRecord after the
+ * actual latency of the AudioFlinger paths.
+ *
+ * The timing of a real device is approximated with:
+ *   periods    frames are queued up to this many periods before write()
+ *              blocks, which is the latency the HAL adds on output
+ *   burst      the queue drains this many periods at a time, like a DSP
+ *              pulling large buffers, so write() returns in bursts
+ *   jitter_us  each blocking call is made up to this much later, at random
+ *
+ * These come from the audio.stub.* properties when the device is opened and
+ * can be changed with the stub_* parameters at any time. A write() made after
+ * the queue ran out counts as an underrun, a read() made too late to keep up
+ * with the capture as an overrun; both are returned by get_parameters().
+ *
+ * To use it, name the module of the primary output "stub" in audio_policy.conf.
+ */
+
+#define LOG_TAG "audio_hw_stub"
+//#define LOG_NDEBUG 0
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <cutils/log.h>
+#include <cutils/properties.h>
+#include <cutils/str_parms.h>
+
+#include <hardware/hardware.h>
+#include <system/audio.h>
+#include <hardware/audio.h>
+
+#define DEFAULT_SAMPLE_RATE     48000
+#define DEFAULT_PERIOD_FRAMES   240
+#define DEFAULT_PERIODS         2
+#define DEFAULT_BURST           1
+#define DEFAULT_JITTER_US       0
+
+/* frames of playback kept for the inputs, a power of 2 */
+#define LOOPBACK_FRAMES         65536
+
+#define NSECS_PER_SEC           1000000000LL
+
+struct stub_audio_device {
+    struct audio_hw_device device;
+
+    pthread_mutex_t lock;
+
+    uint32_t sample_rate;
+    uint32_t period_frames;
+    uint32_t periods;
+    uint32_t burst;
+    uint32_t jitter_us;
+    bool mic_mute;
+
+    /* The first channel of the primary output, by the frame at which it
+     * plays, counted in frames of loopback_rate since CLOCK_MONOTONIC 0.
+     * Holds the frames before loopback_end that were played or are queued. */
+    int16_t loopback[LOOPBACK_FRAMES];
+    int64_t loopback_end;
+    uint32_t loopback_rate;
+    struct stub_stream_out *loopback_out;
+
+    uint32_t underruns;
+    uint32_t overruns;
+};
+
+struct stub_stream_out {
+    struct audio_stream_out stream;
+    struct stub_audio_device *dev;
+
+    pthread_mutex_t lock;
+    uint32_t sample_rate;
+    audio_channel_mask_t channel_mask;
+    uint32_t period_frames;
+    bool standby;
+
+    /* when the first frame written since start_ns plays, and its loopback
+     * frame */
+    int64_t start_ns;
+    int64_t start_frame;
+    uint64_t frames_written;
+    /* frames played before start_ns */
+    uint64_t frames_played;
+};
+
+struct stub_stream_in {
+    struct audio_stream_in stream;
+    struct stub_audio_device *dev;
+
+    pthread_mutex_t lock;
+    uint32_t sample_rate;
+    audio_channel_mask_t channel_mask;
+    uint32_t period_frames;
+    bool standby;
+
+    /* when the first frame read since start_ns was captured, and its
+     * frame at sample_rate */
+    int64_t start_ns;
+    int64_t start_frame;
+    uint64_t frames_read;
+};
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSECS_PER_SEC + ts.tv_nsec;
+}
+
+static int64_t frames_to_ns(uint64_t frames, uint32_t rate)
+{
+    return (int64_t)(frames * NSECS_PER_SEC / rate);
+}
+
+/* the frame of a stream at rate playing or captured at time ns */
+static int64_t ns_to_frames(int64_t ns, uint32_t rate)
+{
+    return ns / 1000 * rate / 1000000;
+}
+
+static void sleep_until(int64_t deadline_ns, uint32_t jitter_us)
+{
+    struct timespec ts;
+    int64_t delay_ns;
+
+    if (jitter_us > 0)
+        deadline_ns += (int64_t)(lrand48() % jitter_us) * 1000;
+
+    delay_ns = deadline_ns - now_ns();
+    if (delay_ns <= 0)
+        return;
+
+    ts.tv_sec = delay_ns / NSECS_PER_SEC;
+    ts.tv_nsec = delay_ns % NSECS_PER_SEC;
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR)
+        ;
+}
+
+static uint32_t property_get_uint(const char *key, uint32_t default_value)
+{
+    char value[PROPERTY_VALUE_MAX];
+    int n;
+
+    if (property_get(key, value, NULL) <= 0)
+        return default_value;
+
+    n = atoi(value);
+    return n > 0 ? (uint32_t)n : default_value;
+}
+
+/* called with dev->lock held */
+static void loopback_write_l(struct stub_audio_device *adev, int64_t frame,
+                             const int16_t *buffer, size_t frames, int channels)
+{
+    size_t i;
+
+    /* silence for what was not played since the last write */
+    if (frame > adev->loopback_end) {
+        int64_t gap = frame - adev->loopback_end;
+
+        if (gap > LOOPBACK_FRAMES)
+            gap = LOOPBACK_FRAMES;
+        for (i = 0; i < (size_t)gap; i++)
+            adev->loopback[(frame - gap + i) & (LOOPBACK_FRAMES - 1)] = 0;
+    }
+
+    for (i = 0; i < frames; i++)
+        adev->loopback[(frame + i) & (LOOPBACK_FRAMES - 1)] = buffer[i * channels];
+
+    if (frame + (int64_t)frames > adev->loopback_end)
+        adev->loopback_end = frame + frames;
+}
+
+/* called with dev->lock held */
+static int16_t loopback_read_l(struct stub_audio_device *adev, int64_t frame)
+{
+    if (frame >= adev->loopback_end || frame < adev->loopback_end - LOOPBACK_FRAMES)
+        return 0;
+
+    return adev->loopback[frame & (LOOPBACK_FRAMES - 1)];
+}
+
+/* audio_stream_out */
+
+static uint32_t out_get_sample_rate(const struct audio_stream *stream)
+{
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+
+    return out->sample_rate;
+}
+
+static int out_set_sample_rate(struct audio_stream *stream, uint32_t rate)
+{
+    return -ENOSYS;
+}
+
+static size_t out_get_buffer_size(const struct audio_stream *stream)
+{
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+
+    return out->period_frames * audio_stream_frame_size(stream);
+}
+
+static audio_channel_mask_t out_get_channels(const struct audio_stream *stream)
+{
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+
+    return out->channel_mask;
+}
+
+static audio_format_t out_get_format(const struct audio_stream *stream)
+{
+    return AUDIO_FORMAT_PCM_16_BIT;
+}
+
+static int out_set_format(struct audio_stream *stream, audio_format_t format)
+{
+    return -ENOSYS;
+}
+
+static int out_standby(struct audio_stream *stream)
+{
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+    int64_t played;
+
+    pthread_mutex_lock(&out->lock);
+    if (!out->standby) {
+        /* the queue is dropped */
+        played = (now_ns() - out->start_ns) * out->sample_rate / NSECS_PER_SEC;
+        if (played < 0)
+            played = 0;
+        if ((uint64_t)played > out->frames_written)
+            played = out->frames_written;
+        out->frames_played += played;
+        out->standby = true;
+    }
+    pthread_mutex_unlock(&out->lock);
+
+    return 0;
+}
+
+static int out_dump(const struct audio_stream *stream, int fd)
+{
+    return 0;
+}
+
+static int out_set_parameters(struct audio_stream *stream, const char *kvpairs)
+{
+    return 0;
+}
+
+static char *out_get_parameters(const struct audio_stream *stream, const char *keys)
+{
+    return strdup("");
+}
+
+static uint32_t out_get_latency(const struct audio_stream_out *stream)
+{
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+    uint32_t periods;
+
+    pthread_mutex_lock(&out->dev->lock);
+    periods = out->dev->periods;
+    pthread_mutex_unlock(&out->dev->lock);
+
+    return (uint32_t)((uint64_t)periods * out->period_frames * 1000 / out->sample_rate);
+}
+
+static int out_set_volume(struct audio_stream_out *stream, float left, float right)
+{
+    return 0;
+}
+
+static ssize_t out_write(struct audio_stream_out *stream, const void *buffer, size_t bytes)
+{
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+    struct stub_audio_device *adev = out->dev;
+    size_t frame_size = audio_stream_frame_size(&stream->common);
+    size_t frames = bytes / frame_size;
+    uint32_t periods, burst, jitter_us;
+    int64_t now, first_ns, wake_ns, burst_ns;
+    uint64_t queue_frames;
+
+    pthread_mutex_lock(&out->lock);
+
+    pthread_mutex_lock(&adev->lock);
+    periods = adev->periods;
+    burst = adev->burst;
+    jitter_us = adev->jitter_us;
+    pthread_mutex_unlock(&adev->lock);
+
+    now = now_ns();
+    if (out->standby) {
+        out->start_ns = now;
+        out->start_frame = ns_to_frames(now, out->sample_rate);
+        out->frames_written = 0;
+        out->standby = false;
+    }
+
+    /* The queue ran out before this write: what was queued has played, and
+     * this write starts a new timeline. */
+    first_ns = out->start_ns + frames_to_ns(out->frames_written, out->sample_rate);
+    if (first_ns < now) {
+        if (out->frames_written > 0) {
+            pthread_mutex_lock(&adev->lock);
+            adev->underruns++;
+            pthread_mutex_unlock(&adev->lock);
+            ALOGV("out_write underrun, %lld us late", (long long)(now - first_ns) / 1000);
+        }
+        out->frames_played += out->frames_written;
+        out->start_ns = now;
+        out->start_frame = ns_to_frames(now, out->sample_rate);
+        out->frames_written = 0;
+    }
+
+    pthread_mutex_lock(&adev->lock);
+    if (adev->loopback_out == out) {
+        loopback_write_l(adev, out->start_frame + out->frames_written,
+                         (const int16_t *)buffer, frames,
+                         popcount(out->channel_mask));
+    }
+    pthread_mutex_unlock(&adev->lock);
+
+    out->frames_written += frames;
+
+    /* Return once no more than the queue is left to play, at the end of a
+     * burst. */
+    queue_frames = (uint64_t)periods * out->period_frames;
+    if (out->frames_written > queue_frames) {
+        wake_ns = out->start_ns
+                + frames_to_ns(out->frames_written - queue_frames, out->sample_rate);
+        if (burst > 1) {
+            burst_ns = frames_to_ns((uint64_t)burst * out->period_frames, out->sample_rate);
+            wake_ns = out->start_ns
+                    + (wake_ns - out->start_ns + burst_ns - 1) / burst_ns * burst_ns;
+        }
+        pthread_mutex_unlock(&out->lock);
+        sleep_until(wake_ns, jitter_us);
+    } else {
+        pthread_mutex_unlock(&out->lock);
+    }
+
+    return bytes;
+}
+
+static int out_get_render_position(const struct audio_stream_out *stream, uint32_t *dsp_frames)
+{
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+    int64_t played = 0;
+
+    pthread_mutex_lock(&out->lock);
+    if (!out->standby) {
+        played = (now_ns() - out->start_ns) * out->sample_rate / NSECS_PER_SEC;
+        if (played < 0)
+            played = 0;
+        if ((uint64_t)played > out->frames_written)
+            played = out->frames_written;
+    }
+    *dsp_frames = (uint32_t)(out->frames_played + played);
+    pthread_mutex_unlock(&out->lock);
+
+    return 0;
+}
+
+static int out_add_audio_effect(const struct audio_stream *stream, effect_handle_t effect)
+{
+    return 0;
+}
+
+static int out_remove_audio_effect(const struct audio_stream *stream, effect_handle_t effect)
+{
+    return 0;
+}
+
+static int out_get_next_write_timestamp(const struct audio_stream_out *stream,
+                                        int64_t *timestamp)
+{
+    return -EINVAL;
+}
+
+/* audio_stream_in */
+
+static uint32_t in_get_sample_rate(const struct audio_stream *stream)
+{
+    struct stub_stream_in *in = (struct stub_stream_in *)stream;
+
+    return in->sample_rate;
+}
+
+static int in_set_sample_rate(struct audio_stream *stream, uint32_t rate)
+{
+    return -ENOSYS;
+}
+
+static size_t in_get_buffer_size(const struct audio_stream *stream)
+{
+    struct stub_stream_in *in = (struct stub_stream_in *)stream;
+
+    return in->period_frames * audio_stream_frame_size(stream);
+}
+
+static audio_channel_mask_t in_get_channels(const struct audio_stream *stream)
+{
+    struct stub_stream_in *in = (struct stub_stream_in *)stream;
+
+    return in->channel_mask;
+}
+
+static audio_format_t in_get_format(const struct audio_stream *stream)
+{
+    return AUDIO_FORMAT_PCM_16_BIT;
+}
+
+static int in_set_format(struct audio_stream *stream, audio_format_t format)
+{
+    return -ENOSYS;
+}
+
+static int in_standby(struct audio_stream *stream)
+{
+    struct stub_stream_in *in = (struct stub_stream_in *)stream;
+
+    pthread_mutex_lock(&in->lock);
+    in->standby = true;
+    pthread_mutex_unlock(&in->lock);
+
+    return 0;
+}
+
+static int in_dump(const struct audio_stream *stream, int fd)
+{
+    return 0;
+}
+
+static int in_set_parameters(struct audio_stream *stream, const char *kvpairs)
+{
+    return 0;
+}
+
+static char *in_get_parameters(const struct audio_stream *stream, const char *keys)
+{
+    return strdup("");
+}
+
+static int in_set_gain(struct audio_stream_in *stream, float gain)
+{
+    return 0;
+}
+
+static ssize_t in_read(struct audio_stream_in *stream, void *buffer, size_t bytes)
+{
+    struct stub_stream_in *in = (struct stub_stream_in *)stream;
+    struct stub_audio_device *adev = in->dev;
+    size_t frame_size = audio_stream_frame_size(&stream->common);
+    size_t frames = bytes / frame_size;
+    int channels = popcount(in->channel_mask);
+    int16_t *samples = (int16_t *)buffer;
+    uint32_t periods, jitter_us;
+    int64_t now, end_ns, first_frame, out_frame;
+    uint32_t out_rate;
+    size_t i;
+    int c;
+
+    pthread_mutex_lock(&in->lock);
+
+    pthread_mutex_lock(&adev->lock);
+    periods = adev->periods;
+    jitter_us = adev->jitter_us;
+    pthread_mutex_unlock(&adev->lock);
+
+    now = now_ns();
+    if (in->standby) {
+        in->start_ns = now;
+        in->start_frame = ns_to_frames(now, in->sample_rate);
+        in->frames_read = 0;
+        in->standby = false;
+    }
+
+    /* The capture has gone further than the queue holds: the oldest frames
+     * are lost, and this read returns the most recent ones. */
+    end_ns = in->start_ns + frames_to_ns(in->frames_read + frames, in->sample_rate);
+    if (now - end_ns > frames_to_ns((uint64_t)periods * in->period_frames, in->sample_rate)) {
+        pthread_mutex_lock(&adev->lock);
+        adev->overruns++;
+        pthread_mutex_unlock(&adev->lock);
+        ALOGV("in_read overrun, %lld us late", (long long)(now - end_ns) / 1000);
+        in->start_ns = now - frames_to_ns(in->frames_read + frames, in->sample_rate);
+        in->start_frame = ns_to_frames(in->start_ns, in->sample_rate);
+        end_ns = now;
+    }
+    first_frame = in->start_frame + in->frames_read;
+    in->frames_read += frames;
+
+    pthread_mutex_unlock(&in->lock);
+
+    sleep_until(end_ns, jitter_us);
+
+    pthread_mutex_lock(&adev->lock);
+    out_rate = adev->loopback_rate;
+    for (i = 0; i < frames; i++) {
+        int16_t sample = 0;
+
+        if (out_rate != 0 && !adev->mic_mute) {
+            out_frame = (first_frame + (int64_t)i) * out_rate / in->sample_rate;
+            sample = loopback_read_l(adev, out_frame);
+        }
+        for (c = 0; c < channels; c++)
+            samples[i * channels + c] = sample;
+    }
+    pthread_mutex_unlock(&adev->lock);
+
+    return bytes;
+}
+
+static uint32_t in_get_input_frames_lost(struct audio_stream_in *stream)
+{
+    return 0;
+}
+
+static int in_add_audio_effect(const struct audio_stream *stream, effect_handle_t effect)
+{
+    return 0;
+}
+
+static int in_remove_audio_effect(const struct audio_stream *stream, effect_handle_t effect)
+{
+    return 0;
+}
+
+/* audio_hw_device */
+
+static int adev_open_output_stream(struct audio_hw_device *dev,
+                                   audio_io_handle_t handle,
+                                   audio_devices_t devices,
+                                   audio_output_flags_t flags,
+                                   struct audio_config *config,
+                                   struct audio_stream_out **stream_out)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+    struct stub_stream_out *out;
+
+    /* whatever AudioFlinger mixes to */
+    if ((config->format != AUDIO_FORMAT_DEFAULT && config->format != AUDIO_FORMAT_PCM_16_BIT) ||
+            (config->channel_mask != 0 && config->channel_mask != AUDIO_CHANNEL_OUT_STEREO)) {
+        config->format = AUDIO_FORMAT_PCM_16_BIT;
+        config->channel_mask = AUDIO_CHANNEL_OUT_STEREO;
+        return -EINVAL;
+    }
+
+    out = (struct stub_stream_out *)calloc(1, sizeof(struct stub_stream_out));
+    if (!out)
+        return -ENOMEM;
+
+    out->stream.common.get_sample_rate = out_get_sample_rate;
+    out->stream.common.set_sample_rate = out_set_sample_rate;
+    out->stream.common.get_buffer_size = out_get_buffer_size;
+    out->stream.common.get_channels = out_get_channels;
+    out->stream.common.get_format = out_get_format;
+    out->stream.common.set_format = out_set_format;
+    out->stream.common.standby = out_standby;
+    out->stream.common.dump = out_dump;
+    out->stream.common.set_parameters = out_set_parameters;
+    out->stream.common.get_parameters = out_get_parameters;
+    out->stream.common.add_audio_effect = out_add_audio_effect;
+    out->stream.common.remove_audio_effect = out_remove_audio_effect;
+    out->stream.get_latency = out_get_latency;
+    out->stream.set_volume = out_set_volume;
+    out->stream.write = out_write;
+    out->stream.get_render_position = out_get_render_position;
+    out->stream.get_next_write_timestamp = out_get_next_write_timestamp;
+
+    pthread_mutex_init(&out->lock, NULL);
+    out->dev = adev;
+    out->sample_rate = config->sample_rate != 0 ? config->sample_rate : adev->sample_rate;
+    out->channel_mask = AUDIO_CHANNEL_OUT_STEREO;
+    out->standby = true;
+
+    pthread_mutex_lock(&adev->lock);
+    out->period_frames = adev->period_frames;
+    /* the inputs hear the primary output, or the first one opened */
+    if (adev->loopback_out == NULL || (flags & AUDIO_OUTPUT_FLAG_PRIMARY)) {
+        adev->loopback_out = out;
+        adev->loopback_rate = out->sample_rate;
+        adev->loopback_end = 0;
+    }
+    pthread_mutex_unlock(&adev->lock);
+
+    config->format = AUDIO_FORMAT_PCM_16_BIT;
+    config->channel_mask = out->channel_mask;
+    config->sample_rate = out->sample_rate;
+
+    ALOGV("adev_open_output_stream rate %u period %u flags %#x",
+          out->sample_rate, out->period_frames, flags);
+
+    *stream_out = &out->stream;
+    return 0;
+}
+
+static void adev_close_output_stream(struct audio_hw_device *dev,
+                                     struct audio_stream_out *stream)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+    struct stub_stream_out *out = (struct stub_stream_out *)stream;
+
+    pthread_mutex_lock(&adev->lock);
+    if (adev->loopback_out == out) {
+        adev->loopback_out = NULL;
+        adev->loopback_rate = 0;
+    }
+    pthread_mutex_unlock(&adev->lock);
+
+    pthread_mutex_destroy(&out->lock);
+    free(out);
+}
+
+static int adev_set_parameters(struct audio_hw_device *dev, const char *kvpairs)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+    struct str_parms *parms;
+    int value;
+
+    parms = str_parms_create_str(kvpairs);
+
+    pthread_mutex_lock(&adev->lock);
+    if (str_parms_get_int(parms, "stub_jitter_us", &value) >= 0 && value >= 0)
+        adev->jitter_us = value;
+    if (str_parms_get_int(parms, "stub_periods", &value) >= 0 && value > 0)
+        adev->periods = value;
+    if (str_parms_get_int(parms, "stub_burst", &value) >= 0 && value > 0)
+        adev->burst = value;
+    /* for the streams opened after this */
+    if (str_parms_get_int(parms, "stub_period_frames", &value) >= 0 && value > 0)
+        adev->period_frames = value;
+    pthread_mutex_unlock(&adev->lock);
+
+    str_parms_destroy(parms);
+    return 0;
+}
+
+static char *adev_get_parameters(const struct audio_hw_device *dev, const char *keys)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+    struct str_parms *query = str_parms_create_str(keys);
+    struct str_parms *reply = str_parms_create();
+    char *str;
+
+    pthread_mutex_lock(&adev->lock);
+    if (str_parms_has_key(query, "stub_underruns"))
+        str_parms_add_int(reply, "stub_underruns", adev->underruns);
+    if (str_parms_has_key(query, "stub_overruns"))
+        str_parms_add_int(reply, "stub_overruns", adev->overruns);
+    if (str_parms_has_key(query, "stub_jitter_us"))
+        str_parms_add_int(reply, "stub_jitter_us", adev->jitter_us);
+    if (str_parms_has_key(query, "stub_periods"))
+        str_parms_add_int(reply, "stub_periods", adev->periods);
+    if (str_parms_has_key(query, "stub_burst"))
+        str_parms_add_int(reply, "stub_burst", adev->burst);
+    if (str_parms_has_key(query, "stub_period_frames"))
+        str_parms_add_int(reply, "stub_period_frames", adev->period_frames);
+    pthread_mutex_unlock(&adev->lock);
+
+    str = str_parms_to_str(reply);
+    str_parms_destroy(query);
+    str_parms_destroy(reply);
+    return str;
+}
+
+static int adev_init_check(const struct audio_hw_device *dev)
+{
+    return 0;
+}
+
+static uint32_t adev_get_supported_devices(const struct audio_hw_device *dev)
+{
+    return (/* OUT */
+            AUDIO_DEVICE_OUT_EARPIECE |
+            AUDIO_DEVICE_OUT_SPEAKER |
+            AUDIO_DEVICE_OUT_WIRED_HEADSET |
+            AUDIO_DEVICE_OUT_WIRED_HEADPHONE |
+            AUDIO_DEVICE_OUT_DEFAULT |
+            /* IN */
+            AUDIO_DEVICE_IN_BUILTIN_MIC |
+            AUDIO_DEVICE_IN_WIRED_HEADSET |
+            AUDIO_DEVICE_IN_DEFAULT);
+}
+
+static int adev_set_voice_volume(struct audio_hw_device *dev, float volume)
+{
+    return 0;
+}
+
+static int adev_set_master_volume(struct audio_hw_device *dev, float volume)
+{
+    return -ENOSYS;
+}
+
+static int adev_get_master_volume(struct audio_hw_device *dev, float *volume)
+{
+    return -ENOSYS;
+}
+
+static int adev_set_master_mute(struct audio_hw_device *dev, bool muted)
+{
+    return -ENOSYS;
+}
+
+static int adev_get_master_mute(struct audio_hw_device *dev, bool *muted)
+{
+    return -ENOSYS;
+}
+
+static int adev_set_mode(struct audio_hw_device *dev, audio_mode_t mode)
+{
+    return 0;
+}
+
+static int adev_set_mic_mute(struct audio_hw_device *dev, bool state)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+
+    pthread_mutex_lock(&adev->lock);
+    adev->mic_mute = state;
+    pthread_mutex_unlock(&adev->lock);
+
+    return 0;
+}
+
+static int adev_get_mic_mute(const struct audio_hw_device *dev, bool *state)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+
+    pthread_mutex_lock(&adev->lock);
+    *state = adev->mic_mute;
+    pthread_mutex_unlock(&adev->lock);
+
+    return 0;
+}
+
+static size_t adev_get_input_buffer_size(const struct audio_hw_device *dev,
+                                         const struct audio_config *config)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+    uint32_t period_frames;
+
+    pthread_mutex_lock(&adev->lock);
+    period_frames = adev->period_frames;
+    pthread_mutex_unlock(&adev->lock);
+
+    return period_frames * popcount(config->channel_mask) * sizeof(int16_t);
+}
+
+static int adev_open_input_stream(struct audio_hw_device *dev,
+                                  audio_io_handle_t handle,
+                                  audio_devices_t devices,
+                                  struct audio_config *config,
+                                  struct audio_stream_in **stream_in)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)dev;
+    struct stub_stream_in *in;
+
+    if ((config->format != AUDIO_FORMAT_DEFAULT && config->format != AUDIO_FORMAT_PCM_16_BIT) ||
+            (config->channel_mask != AUDIO_CHANNEL_IN_MONO &&
+             config->channel_mask != AUDIO_CHANNEL_IN_STEREO)) {
+        config->format = AUDIO_FORMAT_PCM_16_BIT;
+        config->channel_mask = AUDIO_CHANNEL_IN_MONO;
+        return -EINVAL;
+    }
+
+    in = (struct stub_stream_in *)calloc(1, sizeof(struct stub_stream_in));
+    if (!in)
+        return -ENOMEM;
+
+    in->stream.common.get_sample_rate = in_get_sample_rate;
+    in->stream.common.set_sample_rate = in_set_sample_rate;
+    in->stream.common.get_buffer_size = in_get_buffer_size;
+    in->stream.common.get_channels = in_get_channels;
+    in->stream.common.get_format = in_get_format;
+    in->stream.common.set_format = in_set_format;
+    in->stream.common.standby = in_standby;
+    in->stream.common.dump = in_dump;
+    in->stream.common.set_parameters = in_set_parameters;
+    in->stream.common.get_parameters = in_get_parameters;
+    in->stream.common.add_audio_effect = in_add_audio_effect;
+    in->stream.common.remove_audio_effect = in_remove_audio_effect;
+    in->stream.set_gain = in_set_gain;
+    in->stream.read = in_read;
+    in->stream.get_input_frames_lost = in_get_input_frames_lost;
+
+    pthread_mutex_init(&in->lock, NULL);
+    in->dev = adev;
+    in->sample_rate = config->sample_rate != 0 ? config->sample_rate : adev->sample_rate;
+    in->channel_mask = config->channel_mask;
+    in->standby = true;
+
+    pthread_mutex_lock(&adev->lock);
+    in->period_frames = adev->period_frames;
+    pthread_mutex_unlock(&adev->lock);
+
+    config->format = AUDIO_FORMAT_PCM_16_BIT;
+    config->sample_rate = in->sample_rate;
+
+    ALOGV("adev_open_input_stream rate %u period %u channels %#x",
+          in->sample_rate, in->period_frames, in->channel_mask);
+
+    *stream_in = &in->stream;
+    return 0;
+}
+
+static void adev_close_input_stream(struct audio_hw_device *dev,
+                                    struct audio_stream_in *stream)
+{
+    struct stub_stream_in *in = (struct stub_stream_in *)stream;
+
+    pthread_mutex_destroy(&in->lock);
+    free(in);
+}
+
+static int adev_dump(const audio_hw_device_t *device, int fd)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)device;
+    char buffer[256];
+
+    pthread_mutex_lock(&adev->lock);
+    snprintf(buffer, sizeof(buffer),
+             "stub audio HAL: period %u frames, %u periods, burst %u, jitter %u us, "
+             "underruns %u, overruns %u\n",
+             adev->period_frames, adev->periods, adev->burst, adev->jitter_us,
+             adev->underruns, adev->overruns);
+    pthread_mutex_unlock(&adev->lock);
+
+    write(fd, buffer, strlen(buffer));
+    return 0;
+}
+
+static int adev_close(hw_device_t *device)
+{
+    struct stub_audio_device *adev = (struct stub_audio_device *)device;
+
+    pthread_mutex_destroy(&adev->lock);
+    free(adev);
+    return 0;
+}
+
+static int adev_open(const hw_module_t* module, const char* name,
+                     hw_device_t** device)
+{
+    struct stub_audio_device *adev;
+
+    if (strcmp(name, AUDIO_HARDWARE_INTERFACE) != 0)
+        return -EINVAL;
+
+    adev = calloc(1, sizeof(struct stub_audio_device));
+    if (!adev)
+        return -ENOMEM;
+
+    adev->device.common.tag = HARDWARE_DEVICE_TAG;
+    adev->device.common.version = AUDIO_DEVICE_API_VERSION_CURRENT;
+    adev->device.common.module = (struct hw_module_t *) module;
+    adev->device.common.close = adev_close;
+
+    adev->device.init_check = adev_init_check;
+    adev->device.get_supported_devices = adev_get_supported_devices;
+    adev->device.set_voice_volume = adev_set_voice_volume;
+    adev->device.set_master_volume = adev_set_master_volume;
+    adev->device.get_master_volume = adev_get_master_volume;
+    adev->device.set_master_mute = adev_set_master_mute;
+    adev->device.get_master_mute = adev_get_master_mute;
+    adev->device.set_mode = adev_set_mode;
+    adev->device.set_mic_mute = adev_set_mic_mute;
+    adev->device.get_mic_mute = adev_get_mic_mute;
+    adev->device.set_parameters = adev_set_parameters;
+    adev->device.get_parameters = adev_get_parameters;
+    adev->device.get_input_buffer_size = adev_get_input_buffer_size;
+    adev->device.open_output_stream = adev_open_output_stream;
+    adev->device.close_output_stream = adev_close_output_stream;
+    adev->device.open_input_stream = adev_open_input_stream;
+    adev->device.close_input_stream = adev_close_input_stream;
+    adev->device.dump = adev_dump;
+
+    pthread_mutex_init(&adev->lock, NULL);
+    adev->sample_rate = property_get_uint("audio.stub.sample_rate", DEFAULT_SAMPLE_RATE);
+    adev->period_frames = property_get_uint("audio.stub.period_frames", DEFAULT_PERIOD_FRAMES);
+    adev->periods = property_get_uint("audio.stub.periods", DEFAULT_PERIODS);
+    adev->burst = property_get_uint("audio.stub.burst", DEFAULT_BURST);
+    adev->jitter_us = property_get_uint("audio.stub.jitter_us", DEFAULT_JITTER_US);
+
+    ALOGI("stub audio HAL: %u Hz, period %u frames, %u periods, burst %u, jitter %u us",
+          adev->sample_rate, adev->period_frames, adev->periods, adev->burst,
+          adev->jitter_us);
+
+    *device = &adev->device.common;
+
+    return 0;
+}
+
+static struct hw_module_methods_t hal_module_methods = {
+    .open = adev_open,
+};
+
+struct audio_module HAL_MODULE_INFO_SYM = {
+    .common = {
+        .tag = HARDWARE_MODULE_TAG,
+        .module_api_version = AUDIO_MODULE_API_VERSION_0_1,
+        .hal_api_version = HARDWARE_HAL_API_VERSION,
+        .id = AUDIO_HARDWARE_MODULE_ID,
+        .name = "Stub audio HW HAL for latency measurements",
+        .author = "The Android Open Source Project",
+        .methods = &hal_module_methods,
+    },
+};
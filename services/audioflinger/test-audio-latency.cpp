@@ -0,0 +1,547 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Plays a click at regular intervals with AudioTrack, records with AudioRecord, and measures
+// the time from writing each click to reading it back. Meant to run against the stub audio HAL
+// (audio-hal-stub), which loops the primary output back to the inputs in time, so that what
+// is measured is AudioFlinger and the client libraries. Also reports the underruns seen by the
+// track, the FastMixer and the watchdog, and the CPU time used by each mediaserver thread.
+
+#include <binder/IBinder.h>
+#include <binder/IServiceManager.h>
+#include <binder/ProcessState.h>
+#include <media/AudioRecord.h>
+#include <media/AudioSystem.h>
+#include <media/AudioTrack.h>
+#include <utils/KeyedVector.h>
+#include <utils/List.h>
+#include <utils/String8.h>
+#include <utils/String16.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+#include <utils/threads.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace android;
+
+static const int16_t kClickAmplitude = 16384;
+static const size_t kClickFrames = 48;
+// Clicks not back after this long are counted as lost.
+static const nsecs_t kClickTimeout = seconds(2);
+
+struct Options {
+    uint32_t sampleRate;
+    size_t periodFrames;        // per write() and read()
+    size_t trackFrames;         // 0 for the minimum
+    audio_output_flags_t flags;
+    uint32_t intervalMs;        // between clicks
+    uint32_t durationSec;
+    uint32_t reportSec;         // 0 for no intermediate reports
+    int16_t threshold;
+};
+
+struct Bench {
+    Options mOptions;
+
+    sp<AudioTrack> mTrack;
+    sp<AudioRecord> mRecord;
+
+    Mutex mLock;
+    List<nsecs_t> mPendingClicks;   // write times, oldest first
+    Vector<nsecs_t> mLatencies;
+    size_t mLostClicks;
+    size_t mSpuriousClicks;
+    volatile bool mExit;
+
+    void player() {
+        const size_t frames = mOptions.periodFrames;
+        const uint64_t intervalFrames = (uint64_t)mOptions.sampleRate * mOptions.intervalMs / 1000;
+        int16_t *buffer = new int16_t[frames * 2];
+        uint64_t position = 0;
+        uint64_t nextClick = intervalFrames;
+
+        while (!mExit) {
+            // A click starts at the beginning of a buffer, so that it is written when
+            // the write() returns.
+            bool click = position + frames > nextClick;
+            memset(buffer, 0, frames * 2 * sizeof(int16_t));
+            if (click) {
+                for (size_t i = 0; i < kClickFrames && i < frames; ++i) {
+                    buffer[i * 2] = buffer[i * 2 + 1] = kClickAmplitude;
+                }
+                nextClick += intervalFrames;
+            }
+
+            ssize_t written = mTrack->write(buffer, frames * 2 * sizeof(int16_t));
+            nsecs_t now = systemTime();
+            if (written < 0) {
+                fprintf(stderr, "AudioTrack::write() failed: %d\n", (int) written);
+                break;
+            }
+
+            if (click) {
+                Mutex::Autolock _l(mLock);
+                mPendingClicks.push_back(now);
+            }
+            position += frames;
+        }
+
+        delete[] buffer;
+    }
+
+    void recorder() {
+        const size_t frames = mOptions.periodFrames;
+        int16_t *buffer = new int16_t[frames];
+        // Samples since the last one over the threshold, a click is a loud sample after
+        // at least half an interval of silence.
+        const uint64_t quietFrames = (uint64_t)mOptions.sampleRate * mOptions.intervalMs / 2000;
+        uint64_t quiet = 0;
+
+        while (!mExit) {
+            ssize_t read = mRecord->read(buffer, frames * sizeof(int16_t));
+            nsecs_t now = systemTime();
+            if (read < 0) {
+                fprintf(stderr, "AudioRecord::read() failed: %d\n", (int) read);
+                break;
+            }
+
+            size_t n = read / sizeof(int16_t);
+            for (size_t i = 0; i < n; ++i) {
+                int16_t sample = buffer[i];
+                if (sample < mOptions.threshold && sample > -mOptions.threshold) {
+                    ++quiet;
+                    continue;
+                }
+                if (quiet >= quietFrames) {
+                    // the read returns when its last frame is captured
+                    nsecs_t detected = now - (nsecs_t)(n - i) * 1000000000LL / mOptions.sampleRate;
+                    onClick(detected);
+                }
+                quiet = 0;
+            }
+            expireClicks(now);
+        }
+
+        delete[] buffer;
+    }
+
+    void onClick(nsecs_t detected) {
+        Mutex::Autolock _l(mLock);
+        if (mPendingClicks.empty() || *mPendingClicks.begin() > detected) {
+            ++mSpuriousClicks;
+            return;
+        }
+        mLatencies.push(detected - *mPendingClicks.begin());
+        mPendingClicks.erase(mPendingClicks.begin());
+    }
+
+    void expireClicks(nsecs_t now) {
+        Mutex::Autolock _l(mLock);
+        while (!mPendingClicks.empty() && now - *mPendingClicks.begin() > kClickTimeout) {
+            ++mLostClicks;
+            mPendingClicks.erase(mPendingClicks.begin());
+        }
+    }
+
+    static void *PlayerWrapper(void *me) {
+        static_cast<Bench *>(me)->player();
+        return NULL;
+    }
+
+    static void *RecorderWrapper(void *me) {
+        static_cast<Bench *>(me)->recorder();
+        return NULL;
+    }
+};
+
+// CPU time of each thread of a process, in clock ticks, by tid.
+struct ThreadTimes {
+    String8 mName;
+    unsigned long long mTicks;
+};
+
+static pid_t findProcess(const char *name)
+{
+    DIR *proc = opendir("/proc");
+    if (proc == NULL) {
+        return -1;
+    }
+
+    pid_t pid = -1;
+    struct dirent *entry;
+    while (pid < 0 && (entry = readdir(proc)) != NULL) {
+        pid_t candidate = atoi(entry->d_name);
+        if (candidate <= 0) {
+            continue;
+        }
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%d/cmdline", candidate);
+        char cmdline[256];
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+        ssize_t n = read(fd, cmdline, sizeof(cmdline) - 1);
+        close(fd);
+        if (n > 0) {
+            cmdline[n] = '\0';
+            const char *base = strrchr(cmdline, '/');
+            if (strcmp(base != NULL ? base + 1 : cmdline, name) == 0) {
+                pid = candidate;
+            }
+        }
+    }
+
+    closedir(proc);
+    return pid;
+}
+
+static void getThreadTimes(pid_t pid, KeyedVector<pid_t, ThreadTimes> *times)
+{
+    times->clear();
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    DIR *task = opendir(path);
+    if (task == NULL) {
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(task)) != NULL) {
+        pid_t tid = atoi(entry->d_name);
+        if (tid <= 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", pid, tid);
+        char stat[512];
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+        ssize_t n = read(fd, stat, sizeof(stat) - 1);
+        close(fd);
+        if (n <= 0) {
+            continue;
+        }
+        stat[n] = '\0';
+
+        // "tid (comm) state ppid ... utime stime ...", comm may contain spaces
+        char *lparen = strchr(stat, '(');
+        char *rparen = strrchr(stat, ')');
+        if (lparen == NULL || rparen == NULL || rparen < lparen) {
+            continue;
+        }
+        unsigned long long utime, stime;
+        if (sscanf(rparen + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                &utime, &stime) != 2) {
+            continue;
+        }
+
+        ThreadTimes t;
+        t.mName.setTo(lparen + 1, rparen - lparen - 1);
+        t.mTicks = utime + stime;
+        times->add(tid, t);
+    }
+
+    closedir(task);
+}
+
+// Returns what AudioFlinger dumps, as dumpsys media.audio_flinger does.
+static String8 dumpAudioFlinger()
+{
+    static const char *kDumpFile = "/data/local/tmp/test-audio-latency.dump";
+
+    sp<IBinder> binder = defaultServiceManager()->checkService(String16("media.audio_flinger"));
+    if (binder == 0) {
+        return String8();
+    }
+
+    int fd = open(kDumpFile, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        return String8();
+    }
+    unlink(kDumpFile);
+
+    Vector<String16> args;
+    binder->dump(fd, args);
+
+    String8 dump;
+    lseek(fd, 0, SEEK_SET);
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        dump.append(buffer, n);
+    }
+    close(fd);
+
+    return dump;
+}
+
+// Sums the counts following each occurrence of prefix.
+static unsigned long long sumCounts(const String8 &dump, const char *prefix)
+{
+    unsigned long long sum = 0;
+    const char *s = dump.string();
+    while ((s = strstr(s, prefix)) != NULL) {
+        s += strlen(prefix);
+        sum += strtoull(s, NULL, 10);
+    }
+    return sum;
+}
+
+struct Underruns {
+    unsigned long long mFastMixer;
+    unsigned long long mWatchdog;
+};
+
+static Underruns getUnderruns()
+{
+    String8 dump = dumpAudioFlinger();
+    Underruns underruns;
+    // "writeErrors=%u underruns=%u", the FastMixer's
+    underruns.mFastMixer = 0;
+    const char *s = dump.string();
+    while ((s = strstr(s, "writeErrors=")) != NULL) {
+        s = strstr(s, "underruns=");
+        if (s == NULL) {
+            break;
+        }
+        s += strlen("underruns=");
+        underruns.mFastMixer += strtoull(s, NULL, 10);
+    }
+    underruns.mWatchdog = sumCounts(dump, "Watchdog: underruns=");
+    return underruns;
+}
+
+static int compareNsecs(const void *a, const void *b)
+{
+    nsecs_t x = *(const nsecs_t *)a;
+    nsecs_t y = *(const nsecs_t *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void printLatencies(Bench &bench, nsecs_t elapsed)
+{
+    Vector<nsecs_t> latencies;
+    size_t lost, spurious;
+    {
+        Mutex::Autolock _l(bench.mLock);
+        latencies = bench.mLatencies;
+        lost = bench.mLostClicks;
+        spurious = bench.mSpuriousClicks;
+    }
+
+    printf("%.0f s: ", elapsed / 1e9);
+    size_t n = latencies.size();
+    if (n == 0) {
+        printf("no clicks back, lost %zu\n", lost);
+        return;
+    }
+
+    nsecs_t *l = latencies.editArray();
+    qsort(l, n, sizeof(nsecs_t), compareNsecs);
+    nsecs_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += l[i];
+    }
+    printf("%zu clicks, latency min %.2f avg %.2f p50 %.2f p99 %.2f max %.2f ms, "
+            "lost %zu, spurious %zu, track underruns %u\n",
+            n, l[0] / 1e6, sum / 1e6 / n, l[n / 2] / 1e6, l[n * 99 / 100] / 1e6,
+            l[n - 1] / 1e6, lost, spurious, bench.mTrack->getUnderrunCount());
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-r sampleRate] [-p periodFrames] [-b trackFrames] [-F]\n"
+                    "       [-i intervalMs] [-d durationSec] [-R reportSec] [-t threshold]\n",
+                    name);
+    fprintf(stderr, "    -r    sample rate of the track and the record (default 48000)\n");
+    fprintf(stderr, "    -p    frames per write and read (default 240)\n");
+    fprintf(stderr, "    -b    track buffer size in frames (default minimum)\n");
+    fprintf(stderr, "    -F    ask for a fast track\n");
+    fprintf(stderr, "    -i    time between clicks (default 500 ms)\n");
+    fprintf(stderr, "    -d    duration (default 600 s)\n");
+    fprintf(stderr, "    -R    report every so many seconds, 0 for the end only (default 60)\n");
+    fprintf(stderr, "    -t    detection threshold (default 8192)\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *progname = argv[0];
+
+    Options options;
+    options.sampleRate = 48000;
+    options.periodFrames = 240;
+    options.trackFrames = 0;
+    options.flags = AUDIO_OUTPUT_FLAG_NONE;
+    options.intervalMs = 500;
+    options.durationSec = 600;
+    options.reportSec = 60;
+    options.threshold = 8192;
+
+    int ch;
+    while ((ch = getopt(argc, argv, "r:p:b:Fi:d:R:t:h")) != -1) {
+        switch (ch) {
+        case 'r':
+            options.sampleRate = atoi(optarg);
+            break;
+        case 'p':
+            options.periodFrames = atoi(optarg);
+            break;
+        case 'b':
+            options.trackFrames = atoi(optarg);
+            break;
+        case 'F':
+            options.flags = AUDIO_OUTPUT_FLAG_FAST;
+            break;
+        case 'i':
+            options.intervalMs = atoi(optarg);
+            break;
+        case 'd':
+            options.durationSec = atoi(optarg);
+            break;
+        case 'R':
+            options.reportSec = atoi(optarg);
+            break;
+        case 't':
+            options.threshold = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            usage(progname);
+            return -1;
+        }
+    }
+
+    if (options.sampleRate == 0 || options.periodFrames == 0 || options.intervalMs == 0
+            || options.durationSec == 0 || options.threshold <= 0
+            || (uint64_t)options.sampleRate * options.intervalMs / 1000 < 2 * options.periodFrames) {
+        usage(progname);
+        return -1;
+    }
+
+    ProcessState::self()->startThreadPool();
+
+    Bench bench;
+    bench.mOptions = options;
+    bench.mLostClicks = 0;
+    bench.mSpuriousClicks = 0;
+    bench.mExit = false;
+
+    bench.mTrack = new AudioTrack(AUDIO_STREAM_MUSIC, options.sampleRate, AUDIO_FORMAT_PCM_16_BIT,
+            AUDIO_CHANNEL_OUT_STEREO, options.trackFrames, options.flags);
+    if (bench.mTrack->initCheck() != NO_ERROR) {
+        fprintf(stderr, "unable to create the AudioTrack\n");
+        return 1;
+    }
+    bench.mRecord = new AudioRecord(AUDIO_SOURCE_MIC, options.sampleRate,
+            AUDIO_FORMAT_PCM_16_BIT, AUDIO_CHANNEL_IN_MONO);
+    if (bench.mRecord->initCheck() != NO_ERROR) {
+        fprintf(stderr, "unable to create the AudioRecord\n");
+        return 1;
+    }
+
+    pid_t mediaserver = findProcess("mediaserver");
+    KeyedVector<pid_t, ThreadTimes> startTimes;
+    getThreadTimes(mediaserver, &startTimes);
+    Underruns startUnderruns = getUnderruns();
+
+    printf("track of %u frames, latency %u ms%s, record of %zu frames, %zu frames per period\n",
+            bench.mTrack->frameCount(), bench.mTrack->latency(),
+            options.flags & AUDIO_OUTPUT_FLAG_FAST ? ", fast" : "",
+            bench.mRecord->frameCount(), options.periodFrames);
+
+    bench.mRecord->start();
+    bench.mTrack->start();
+
+    nsecs_t start = systemTime();
+
+    pthread_t player;
+    if (pthread_create(&player, NULL, Bench::PlayerWrapper, &bench) != 0) {
+        fprintf(stderr, "unable to create the player thread\n");
+        return 1;
+    }
+
+    pthread_t recorder;
+    if (pthread_create(&recorder, NULL, Bench::RecorderWrapper, &bench) != 0) {
+        fprintf(stderr, "unable to create the recorder thread\n");
+        bench.mExit = true;
+        pthread_join(player, NULL);
+        return 1;
+    }
+
+    nsecs_t end = start + seconds(options.durationSec);
+    nsecs_t nextReport = options.reportSec > 0 ? start + seconds(options.reportSec) : end;
+    for (;;) {
+        nsecs_t now = systemTime();
+        if (now >= end) {
+            break;
+        }
+        nsecs_t wake = nextReport < end ? nextReport : end;
+        usleep((wake - now) / 1000);
+        if (systemTime() >= nextReport && nextReport < end) {
+            printLatencies(bench, systemTime() - start);
+            nextReport += seconds(options.reportSec);
+        }
+    }
+
+    bench.mExit = true;
+    pthread_join(player, NULL);
+    pthread_join(recorder, NULL);
+    bench.mTrack->stop();
+    bench.mRecord->stop();
+
+    nsecs_t elapsed = systemTime() - start;
+
+    Underruns endUnderruns = getUnderruns();
+    KeyedVector<pid_t, ThreadTimes> endTimes;
+    getThreadTimes(mediaserver, &endTimes);
+
+    printLatencies(bench, elapsed);
+    printf("underruns: FastMixer %llu, watchdog %llu\n",
+            endUnderruns.mFastMixer - startUnderruns.mFastMixer,
+            endUnderruns.mWatchdog - startUnderruns.mWatchdog);
+
+    String8 hal = AudioSystem::getParameters(0, String8("stub_underruns;stub_overruns"));
+    if (!hal.isEmpty()) {
+        printf("stub audio HAL: %s\n", hal.string());
+    }
+
+    if (mediaserver < 0) {
+        printf("mediaserver not found, no CPU usage\n");
+        return 0;
+    }
+    long ticksPerSec = sysconf(_SC_CLK_TCK);
+    printf("mediaserver (%d) threads over %.0f s:\n", mediaserver, elapsed / 1e9);
+    for (size_t i = 0; i < endTimes.size(); ++i) {
+        const ThreadTimes &t = endTimes.valueAt(i);
+        ssize_t index = startTimes.indexOfKey(endTimes.keyAt(i));
+        unsigned long long ticks = t.mTicks - (index >= 0 ? startTimes.valueAt(index).mTicks : 0);
+        if (ticks == 0) {
+            continue;
+        }
+        printf("  %5d %-16s %6.2f%% CPU\n", endTimes.keyAt(i), t.mName.string(),
+                ticks * 100.0 / ticksPerSec / (elapsed / 1e9));
+    }
+
+    return 0;
+}
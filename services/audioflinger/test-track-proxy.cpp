@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2013 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs an AudioTrackClientProxy and a ServerProxy on the same control block in one process,
+// one thread each, and measures how long a period takes from being released by the client
+// to being seen by the server.
+
+#include <private/media/AudioTrackShared.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <new>
+
+using namespace android;
+
+static const size_t kFrameSize = 4;     // stereo 16-bit
+
+struct Options {
+    size_t frameCount;          // size of the track buffer
+    size_t periodFrames;        // what the server consumes at a time
+    size_t periodsPerRelease;   // what the client fills before releasing
+    size_t numPeriods;
+    useconds_t serverSleepUs;   // 0: the server spins
+};
+
+struct Bench {
+    Options mOptions;
+
+    audio_track_cblk_t *mCblk;
+    void *mBuffers;
+    AudioTrackClientProxy *mClientProxy;
+    ServerProxy *mServerProxy;
+
+    // client side
+    size_t mClientWaits;
+
+    // server side
+    Vector<nsecs_t> mLatencies;
+    size_t mServerEmpty;
+
+    // Frames "offset" within the buffer, as the shared buffer wraps at frameCount.
+    void *frames(uint32_t offset, uint32_t base) const {
+        return (int8_t *)mBuffers + ((offset - base) % mOptions.frameCount) * kFrameSize;
+    }
+
+    void client() {
+        const size_t releaseFrames = mOptions.periodFrames * mOptions.periodsPerRelease;
+        size_t numReleases = mOptions.numPeriods / mOptions.periodsPerRelease;
+
+        for (size_t i = 0; i < numReleases; ++i) {
+            mCblk->lock.lock();
+            while (mClientProxy->framesAvailable_l() < releaseFrames) {
+                ++mClientWaits;
+                mCblk->waitServer_l(seconds(1));
+            }
+            mCblk->lock.unlock();
+
+            // The first frames of each period carry the time the period was released.
+            uint32_t u = mCblk->user;
+            nsecs_t now = systemTime();
+            for (size_t j = 0; j < mOptions.periodsPerRelease; ++j) {
+                memcpy(frames(u + j * mOptions.periodFrames, mCblk->userBase), &now, sizeof(now));
+            }
+
+            mClientProxy->stepUser(releaseFrames);
+        }
+    }
+
+    void server() {
+        size_t numPeriods =
+                mOptions.numPeriods / mOptions.periodsPerRelease * mOptions.periodsPerRelease;
+
+        while (mLatencies.size() < numPeriods) {
+            if (mServerProxy->framesReady() < mOptions.periodFrames) {
+                ++mServerEmpty;
+                if (mOptions.serverSleepUs > 0) {
+                    usleep(mOptions.serverSleepUs);
+                } else {
+                    sched_yield();
+                }
+                continue;
+            }
+
+            nsecs_t releaseTime;
+            memcpy(&releaseTime, frames(mCblk->server, mCblk->serverBase), sizeof(releaseTime));
+            mLatencies.push(systemTime() - releaseTime);
+
+            mServerProxy->step(mOptions.periodFrames);
+        }
+    }
+
+    static void *ClientWrapper(void *me) {
+        static_cast<Bench *>(me)->client();
+        return NULL;
+    }
+};
+
+static int compareNsecs(const void *a, const void *b)
+{
+    nsecs_t x = *(const nsecs_t *)a;
+    nsecs_t y = *(const nsecs_t *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-f frameCount] [-p periodFrames] [-b periodsPerRelease]\n"
+                    "       [-n periods] [-s serverSleepUs]\n", name);
+    fprintf(stderr, "    -f    track buffer size in frames (default 1024)\n");
+    fprintf(stderr, "    -p    frames consumed by the server at a time (default 256)\n");
+    fprintf(stderr, "    -b    periods filled by the client before releasing them (default 1)\n");
+    fprintf(stderr, "    -n    number of periods (default 100000)\n");
+    fprintf(stderr, "    -s    server sleep when the buffer is empty, 0 to spin (default 0)\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *progname = argv[0];
+
+    Options options;
+    options.frameCount = 1024;
+    options.periodFrames = 256;
+    options.periodsPerRelease = 1;
+    options.numPeriods = 100000;
+    options.serverSleepUs = 0;
+
+    int ch;
+    while ((ch = getopt(argc, argv, "f:p:b:n:s:h")) != -1) {
+        switch (ch) {
+        case 'f':
+            options.frameCount = atoi(optarg);
+            break;
+        case 'p':
+            options.periodFrames = atoi(optarg);
+            break;
+        case 'b':
+            options.periodsPerRelease = atoi(optarg);
+            break;
+        case 'n':
+            options.numPeriods = atoi(optarg);
+            break;
+        case 's':
+            options.serverSleepUs = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            usage(progname);
+            return -1;
+        }
+    }
+
+    // periods must hold the timestamp and not straddle the end of the buffer
+    if (options.periodFrames * kFrameSize < sizeof(nsecs_t) || options.periodsPerRelease == 0
+            || options.frameCount % options.periodFrames != 0
+            || options.periodFrames * options.periodsPerRelease > options.frameCount
+            || options.numPeriods < options.periodsPerRelease) {
+        usage(progname);
+        return -1;
+    }
+
+    size_t size = sizeof(audio_track_cblk_t) + options.frameCount * kFrameSize;
+    void *memory = calloc(1, size);
+    if (memory == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    Bench bench;
+    bench.mOptions = options;
+    bench.mCblk = new (memory) audio_track_cblk_t();
+    bench.mCblk->bufferTimeoutMs = MAX_RUN_TIMEOUT_MS;
+    bench.mBuffers = (int8_t *)memory + sizeof(audio_track_cblk_t);
+    bench.mClientProxy = new AudioTrackClientProxy(
+            bench.mCblk, bench.mBuffers, options.frameCount, kFrameSize);
+    bench.mServerProxy = new ServerProxy(
+            bench.mCblk, bench.mBuffers, options.frameCount, kFrameSize, true /*isOut*/);
+    bench.mClientWaits = 0;
+    bench.mServerEmpty = 0;
+
+    nsecs_t start = systemTime();
+
+    pthread_t client;
+    if (pthread_create(&client, NULL, Bench::ClientWrapper, &bench) != 0) {
+        fprintf(stderr, "unable to create the client thread\n");
+        return 1;
+    }
+    bench.server();
+    pthread_join(client, NULL);
+
+    nsecs_t elapsed = systemTime() - start;
+
+    size_t numPeriods = bench.mLatencies.size();
+    nsecs_t *latencies = bench.mLatencies.editArray();
+    qsort(latencies, numPeriods, sizeof(nsecs_t), compareNsecs);
+
+    printf("%zu periods of %zu frames, %zu per release, buffer of %zu frames\n",
+            numPeriods, options.periodFrames, options.periodsPerRelease, options.frameCount);
+    printf("%.1f periods/s, %.0f ns per period\n",
+            numPeriods * 1e9 / elapsed, (double) elapsed / numPeriods);
+    printf("release to server latency: p50 %lld ns, p99 %lld ns, max %lld ns\n",
+            (long long) latencies[numPeriods / 2],
+            (long long) latencies[numPeriods * 99 / 100],
+            (long long) latencies[numPeriods - 1]);
+    printf("client waits %zu, server found the buffer empty %zu times\n",
+            bench.mClientWaits, bench.mServerEmpty);
+
+    delete bench.mClientProxy;
+    delete bench.mServerProxy;
+    bench.mCblk->~audio_track_cblk_t();
+    free(memory);
+
+    return 0;
+}